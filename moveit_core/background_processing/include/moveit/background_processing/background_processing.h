@@ -39,6 +39,8 @@
 
 #include <deque>
 #include <string>
+#include <vector>
+#include <atomic>
 #include <boost/thread.hpp>
 #include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
@@ -52,8 +54,13 @@ namespace moveit
 namespace tools
 {
 /** \brief This class provides simple API for executing background
-    jobs. A queue of jobs is created and the specified jobs are
-    executed in order, one at a time. */
+    jobs. Jobs are queued with a priority and executed by the
+    process-wide TaskScheduler; at most \e thread_count jobs of one
+    instance run concurrently (one by default, in which case jobs
+    still execute one at a time). Higher priority jobs always run
+    before queued lower priority ones, so long-running work does not
+    delay interactive updates; jobs of equal priority run in the order
+    they were added. */
 class BackgroundProcessing : private boost::noncopyable
 {
 public:
@@ -68,6 +75,45 @@ public:
     COMPLETE
   };
 
+  /** \brief Priorities for queued jobs */
+  enum JobPriority
+  {
+    /// Long-running work that can wait for everything else (e.g., planning)
+    PRIORITY_LOW = 0,
+    /// The priority jobs are queued at when none is specified
+    PRIORITY_DEFAULT = 1,
+    /// Interactive updates that should not wait behind queued work
+    PRIORITY_HIGH = 2
+  };
+
+  /** \brief Handle for cancelling a queued job. Cancelling a job that
+      has not started yet removes it from the queue (triggering a
+      REMOVE event when a worker would have picked it up); a job that
+      is already running is not interrupted, but may poll \ref
+      JobToken::isCancelled itself if it captured its token. */
+  class JobToken
+  {
+  public:
+    JobToken() : cancelled_(false)
+    {
+    }
+
+    void cancel()
+    {
+      cancelled_ = true;
+    }
+
+    bool isCancelled() const
+    {
+      return cancelled_;
+    }
+
+  private:
+    std::atomic<bool> cancelled_;
+  };
+
+  typedef std::shared_ptr<JobToken> JobTokenPtr;
+
   /** \brief The signature for callback triggered when job events take place: the event that took place and the name of
    * the job */
   typedef boost::function<void(JobEvent, const std::string&)> JobUpdateCallback;
@@ -75,16 +121,25 @@ public:
   /** \brief The signature for job callbacks */
   typedef boost::function<void()> JobCallback;
 
-  /** \brief Constructor. The background thread is activated automatically. */
-  BackgroundProcessing();
+  /** \brief Constructor. Jobs run on the shared TaskScheduler pool,
+      with at most \e thread_count of them in flight for this
+      instance. The default of one preserves the original behaviour of
+      never executing two jobs concurrently; only allow more if the
+      jobs that will be queued are safe to run in parallel. */
+  BackgroundProcessing(unsigned int thread_count = 1);
 
-  /** \brief Finishes currently executing job, clears the remaining queue. */
+  /** \brief Finishes currently executing jobs, clears the remaining queue. */
   ~BackgroundProcessing();
 
-  /** \brief Add a job to the queue of jobs to execute. A name is also specifies for the job */
+  /** \brief Add a job to the queue of jobs to execute, at default priority. A name is also specified for the job */
   void addJob(const JobCallback& job, const std::string& name);
 
-  /** \brief Get the size of the queue of jobs (includes currently processed job). */
+  /** \brief Add a job to the queue of jobs to execute, at the
+      specified priority. Returns a token that can be used to cancel
+      the job while it is still queued. */
+  JobTokenPtr addJob(const JobCallback& job, const std::string& name, JobPriority priority);
+
+  /** \brief Get the size of the queue of jobs (includes currently processed jobs). */
   std::size_t getJobCount() const;
 
   /** \brief Clear the queue of jobs */
@@ -97,19 +152,36 @@ public:
   void clearJobUpdateEvent();
 
 private:
-  std::unique_ptr<boost::thread> processing_thread_;
+  /** \brief A queued job, together with its name and cancellation token */
+  struct Job
+  {
+    JobCallback fn_;
+    std::string name_;
+    JobTokenPtr token_;
+  };
+
+  /// Maximum number of jobs of this instance in flight on the shared scheduler
+  unsigned int thread_count_;
   bool run_processing_thread_;
 
   mutable boost::mutex action_lock_;
-  boost::condition_variable new_action_condition_;
-  std::deque<JobCallback> actions_;
-  std::deque<std::string> action_names_;
+  /// Signalled when a drain task of this instance finishes
+  boost::condition_variable idle_condition_;
+  /// One FIFO queue per priority level, indexed by JobPriority
+  std::vector<std::deque<Job>> queues_;
 
   JobUpdateCallback queue_change_event_;
 
-  bool processing_;
+  unsigned int processing_;
+  /// Number of drain tasks of this instance submitted to the scheduler and not yet finished
+  unsigned int active_drains_;
+
+  /** \brief Submit a drain task to the shared scheduler if fewer than thread_count_ are active.
+      Must be called with action_lock_ held. */
+  void maybeStartDrain(JobPriority priority);
 
-  void processingThread();
+  /** \brief Runs queued jobs, highest priority first, until the queue is empty; executed on the scheduler */
+  void drainQueue();
 };
 }
 }
@@ -35,75 +35,117 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/background_processing/background_processing.h>
+#include <moveit/utils/task_scheduler.h>
 #include <ros/console.h>
 
 namespace moveit
 {
 namespace tools
 {
-BackgroundProcessing::BackgroundProcessing()
+static const std::string TASK_SUBSYSTEM = "background_processing";
+
+BackgroundProcessing::BackgroundProcessing(unsigned int thread_count)
 {
-  // spin a thread that will process user events
   run_processing_thread_ = true;
-  processing_ = false;
-  processing_thread_.reset(new boost::thread(boost::bind(&BackgroundProcessing::processingThread, this)));
+  processing_ = 0;
+  active_drains_ = 0;
+  queues_.resize(PRIORITY_HIGH + 1);
+  thread_count_ = thread_count > 0 ? thread_count : 1;
 }
 
 BackgroundProcessing::~BackgroundProcessing()
 {
+  boost::unique_lock<boost::mutex> ulock(action_lock_);
   run_processing_thread_ = false;
-  new_action_condition_.notify_all();
-  processing_thread_->join();
+  // wait for all drain tasks of this instance; a job that is already executing finishes first
+  while (active_drains_ > 0)
+    idle_condition_.wait(ulock);
+}
+
+void BackgroundProcessing::maybeStartDrain(JobPriority priority)
+{
+  if (!run_processing_thread_ || active_drains_ >= thread_count_)
+    return;
+  active_drains_++;
+  TaskScheduler::getInstance().submit(boost::bind(&BackgroundProcessing::drainQueue, this), TASK_SUBSYSTEM,
+                                      static_cast<TaskScheduler::TaskPriority>(priority));
 }
 
-void BackgroundProcessing::processingThread()
+void BackgroundProcessing::drainQueue()
 {
   boost::unique_lock<boost::mutex> ulock(action_lock_);
 
   while (run_processing_thread_)
   {
-    while (actions_.empty() && run_processing_thread_)
-      new_action_condition_.wait(ulock);
+    // take the oldest job of the highest non-empty priority
+    Job job;
+    bool have_job = false;
+    for (int p = static_cast<int>(queues_.size()) - 1; p >= 0 && !have_job; --p)
+      if (!queues_[p].empty())
+      {
+        job = queues_[p].front();
+        queues_[p].pop_front();
+        have_job = true;
+      }
+    if (!have_job)
+      break;
 
-    while (!actions_.empty())
+    if (job.token_ && job.token_->isCancelled())
     {
-      JobCallback fn = actions_.front();
-      std::string action_name = action_names_.front();
-      actions_.pop_front();
-      action_names_.pop_front();
-      processing_ = true;
-
-      // make sure we are unlocked while we process the event
+      // drop cancelled jobs without executing them
       action_lock_.unlock();
-      try
-      {
-        ROS_DEBUG_NAMED("background_processing", "Begin executing '%s'", action_name.c_str());
-        fn();
-        ROS_DEBUG_NAMED("background_processing", "Done executing '%s'", action_name.c_str());
-      }
-      catch (std::exception& ex)
-      {
-        ROS_ERROR_NAMED("background_processing", "Exception caught while processing action '%s': %s",
-                        action_name.c_str(), ex.what());
-      }
-      processing_ = false;
       if (queue_change_event_)
-        queue_change_event_(COMPLETE, action_name);
+        queue_change_event_(REMOVE, job.name_);
       action_lock_.lock();
+      continue;
     }
+
+    processing_++;
+
+    // make sure we are unlocked while we process the event
+    action_lock_.unlock();
+    try
+    {
+      ROS_DEBUG_NAMED("background_processing", "Begin executing '%s'", job.name_.c_str());
+      job.fn_();
+      ROS_DEBUG_NAMED("background_processing", "Done executing '%s'", job.name_.c_str());
+    }
+    catch (std::exception& ex)
+    {
+      ROS_ERROR_NAMED("background_processing", "Exception caught while processing action '%s': %s", job.name_.c_str(),
+                      ex.what());
+    }
+    if (queue_change_event_)
+      queue_change_event_(COMPLETE, job.name_);
+    action_lock_.lock();
+    processing_--;
   }
+
+  active_drains_--;
+  idle_condition_.notify_all();
 }
 
 void BackgroundProcessing::addJob(const boost::function<void()>& job, const std::string& name)
 {
+  addJob(job, name, PRIORITY_DEFAULT);
+}
+
+BackgroundProcessing::JobTokenPtr BackgroundProcessing::addJob(const boost::function<void()>& job,
+                                                               const std::string& name, JobPriority priority)
+{
+  JobTokenPtr token(new JobToken());
   {
     boost::mutex::scoped_lock _(action_lock_);
-    actions_.push_back(job);
-    action_names_.push_back(name);
-    new_action_condition_.notify_all();
+    Job j;
+    j.fn_ = job;
+    j.name_ = name;
+    j.token_ = token;
+    queues_[priority].push_back(j);
+    maybeStartDrain(priority);
   }
   if (queue_change_event_)
     queue_change_event_(ADD, name);
+  return token;
 }
 
 void BackgroundProcessing::clear()
@@ -112,9 +154,13 @@ void BackgroundProcessing::clear()
   std::deque<std::string> removed;
   {
     boost::mutex::scoped_lock _(action_lock_);
-    update = !actions_.empty();
-    actions_.clear();
-    action_names_.swap(removed);
+    for (std::deque<Job>& queue : queues_)
+    {
+      update = update || !queue.empty();
+      for (const Job& job : queue)
+        removed.push_back(job.name_);
+      queue.clear();
+    }
   }
   if (update && queue_change_event_)
     for (std::deque<std::string>::iterator it = removed.begin(); it != removed.end(); ++it)
@@ -124,7 +170,10 @@ void BackgroundProcessing::clear()
 std::size_t BackgroundProcessing::getJobCount() const
 {
   boost::mutex::scoped_lock _(action_lock_);
-  return actions_.size() + (processing_ ? 1 : 0);
+  std::size_t count = processing_;
+  for (const std::deque<Job>& queue : queues_)
+    count += queue.size();
+  return count;
 }
 
 void BackgroundProcessing::setJobUpdateEvent(const JobUpdateCallback& event)
@@ -139,4 +188,4 @@ void BackgroundProcessing::clearJobUpdateEvent()
 }
 
 }  // end of namespace tools
-}  // end of namespace moveit
\ No newline at end of file
+}  // end of namespace moveit
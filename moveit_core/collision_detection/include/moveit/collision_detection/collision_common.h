@@ -168,6 +168,54 @@ struct CollisionResult
 
   /** \brief When costs are computed, the individual cost sources are  */
   std::set<CostSource> cost_sources;
+
+  /** \brief Preallocated flat contact storage. When non-empty, collision checking stores contacts
+      here instead of allocating map nodes and vectors in \e contacts; the first \e contact_count
+      slots are valid. The slots (including the string capacity of the body names) survive clear(),
+      so a result reused across checks reaches a steady state where contact reporting does not touch
+      the heap. Size it with enableFlatContacts(). */
+  std::vector<Contact> flat_contacts;
+
+  /** \brief Preallocate \e capacity flat contact slots and route contacts into them instead of the
+      \e contacts map. Use a capacity matching CollisionRequest::max_contacts; pass 0 to return to
+      the map representation. */
+  void enableFlatContacts(std::size_t capacity)
+  {
+    flat_contacts.resize(capacity);
+  }
+
+  bool flatContactsEnabled() const
+  {
+    return !flat_contacts.empty();
+  }
+
+  /** \brief Number of stored flat contacts involving the given (unordered) pair of bodies */
+  std::size_t flatContactCount(const std::string& body_name_1, const std::string& body_name_2) const
+  {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < contact_count && i < flat_contacts.size(); ++i)
+      if ((flat_contacts[i].body_name_1 == body_name_1 && flat_contacts[i].body_name_2 == body_name_2) ||
+          (flat_contacts[i].body_name_1 == body_name_2 && flat_contacts[i].body_name_2 == body_name_1))
+        count++;
+    return count;
+  }
+
+  /** \brief Copy \e contact into the next free flat slot, reusing the slot's string capacity.
+      Returns false if all slots are in use; the caller should then stop collecting contacts. */
+  bool addFlatContact(const Contact& contact)
+  {
+    if (contact_count >= flat_contacts.size())
+      return false;
+    Contact& slot = flat_contacts[contact_count];
+    slot.pos = contact.pos;
+    slot.normal = contact.normal;
+    slot.depth = contact.depth;
+    slot.body_name_1 = contact.body_name_1;
+    slot.body_type_1 = contact.body_type_1;
+    slot.body_name_2 = contact.body_name_2;
+    slot.body_type_2 = contact.body_type_2;
+    return true;
+  }
 };
 
 /** \brief Representation of a collision checking request */
@@ -41,7 +41,11 @@
 #include <moveit/macros/class_forward.h>
 #include <moveit_msgs/AllowedCollisionMatrix.h>
 #include <boost/function.hpp>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <map>
@@ -95,6 +99,9 @@ public:
   /** @brief Copy constructor */
   AllowedCollisionMatrix(const AllowedCollisionMatrix& acm);
 
+  /** @brief Copy assignment */
+  AllowedCollisionMatrix& operator=(const AllowedCollisionMatrix& acm);
+
   /** @brief Get the type of the allowed collision between two elements. Return true if the entry is included in the
    * collision matrix.
    * Return false if the entry is not found.
@@ -271,11 +278,38 @@ public:
   void print(std::ostream& out) const;
 
 private:
+  /** @brief Resolve the collision type for a pair of elements directly from the string-keyed maps,
+   *  applying the default-entry precedence rules. Used to (re)build the compiled representation
+   *  and kept as the reference implementation of the lookup semantics. */
+  bool lookupAllowedCollision(const std::string& name1, const std::string& name2,
+                              AllowedCollision::Type& allowed_collision) const;
+
+  /** @brief Rebuild the compiled representation: intern all known names to integer ids and store
+   *  the fully resolved collision type for every id pair in a dense matrix. Thread-safe; only the
+   *  first caller after a mutation performs the rebuild. */
+  void compile() const;
+
+  /** @brief Mark the compiled representation as stale; called by all mutating member functions */
+  void invalidateCompiled()
+  {
+    compiled_valid_.store(false, std::memory_order_release);
+  }
+
   std::map<std::string, std::map<std::string, AllowedCollision::Type> > entries_;
   std::map<std::string, std::map<std::string, DecideContactFn> > allowed_contacts_;
 
   std::map<std::string, AllowedCollision::Type> default_entries_;
   std::map<std::string, DecideContactFn> default_allowed_contacts_;
+
+  // Compiled representation used by getAllowedCollision(): names interned to dense ids and one
+  // byte per id pair holding the resolved AllowedCollision::Type (or no-entry marker). This turns
+  // the two red-black-tree string searches per narrowphase callback into two hash lookups and an
+  // array read. Rebuilt lazily after mutations; reads are lock-free once the matrix is compiled.
+  mutable std::unordered_map<std::string, std::size_t> compiled_ids_;
+  mutable std::vector<std::uint8_t> compiled_types_;
+  mutable std::size_t compiled_size_ = 0;
+  mutable std::atomic<bool> compiled_valid_{ false };
+  mutable std::mutex compiled_lock_;
 };
 }
 
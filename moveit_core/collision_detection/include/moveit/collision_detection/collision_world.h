@@ -155,6 +155,24 @@ public:
                                    const robot_state::RobotState& state1, const robot_state::RobotState& state2,
                                    const AllowedCollisionMatrix& acm) const = 0;
 
+  /** \brief Check whether the robot model is in collision with the world for a batch of states.
+   *  Backends can override this to share broadphase setup and transform buffers across the
+   *  whole batch; the default implementation simply loops over checkRobotCollision().
+   *  All states must have updated collision body transforms.
+   *  @param req A CollisionRequest object that is applied to every state
+   *  @param results One CollisionResult per state; resized to match \e states
+   *  @robot robot The collision model for the robot
+   *  @param states The kinematic states for which checks are being made
+   *  @param acm The allowed collision matrix
+   *  @param stop_at_first_collision If true, remaining states are not checked once a
+   *         colliding state is found (their results stay cleared)
+   *  @return The index of the first state in collision, or \e states.size() if none is */
+  virtual std::size_t checkRobotCollisionBatch(const CollisionRequest& req, std::vector<CollisionResult>& results,
+                                               const CollisionRobot& robot,
+                                               const std::vector<const robot_state::RobotState*>& states,
+                                               const AllowedCollisionMatrix& acm,
+                                               bool stop_at_first_collision = false) const;
+
   /** \brief Check whether a given set of objects is in collision with objects from another world.
    *  Any contacts are considered.
    *  @param req A CollisionRequest object that encapsulates the collision request
@@ -0,0 +1,147 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_COLLISION_DETECTION_SELF_COLLISION_CERTIFICATE_CACHE_
+#define MOVEIT_COLLISION_DETECTION_SELF_COLLISION_CERTIFICATE_CACHE_
+
+#include <moveit/collision_detection/collision_robot.h>
+
+namespace collision_detection
+{
+MOVEIT_CLASS_FORWARD(SelfCollisionCertificateCache);
+
+/** \brief Posture-indexed cache of self-collision clearance certificates
+ *  for one joint model group.
+ *
+ *  Self-collision outcomes depend only on the joint values, not on the
+ *  world, so a state known to be self-collision free with clearance \e c
+ *  certifies every nearby state whose joint-space displacement cannot
+ *  close a gap of \e c.  The cache stores such certificates, indexed by
+ *  a kd-tree over the group's variables, and lets a collision checker
+ *  skip the narrowphase self-check whenever a queried state falls
+ *  inside a certified ball.  Certificates never produce false negatives
+ *  for states outside all balls - the checker simply falls back to the
+ *  full check.
+ *
+ *  The joint-space ball radii are conservative: each variable is scaled
+ *  by an upper bound on how far any collision body can move per unit
+ *  change of that variable (the robot's maximum extent for angular
+ *  variables, one for translational ones), doubled because both bodies
+ *  of a colliding pair move.
+ *
+ *  Training samples random states of the group and records the
+ *  self-collision clearance reported by the supplied collision robot.
+ *  Certificates are only valid for queries using the same allowed
+ *  collision matrix (or a more permissive one) as the one trained with,
+ *  and for the link padding and scaling in effect at training time. */
+class SelfCollisionCertificateCache
+{
+public:
+  SelfCollisionCertificateCache(const robot_model::RobotModelConstPtr& robot_model, const std::string& group_name);
+
+  /** \brief The group the certificates were built for */
+  const std::string& getGroupName() const
+  {
+    return group_name_;
+  }
+
+  /** \brief Sample \e samples random states of the group, check each for
+   *  self collision with \e robot under \e acm, and store a certificate
+   *  for every collision-free state whose clearance exceeds
+   *  \e min_clearance.  Intended to be run offline; rebuilds the kd-tree
+   *  when done. */
+  void train(const CollisionRobot& robot, const AllowedCollisionMatrix& acm, unsigned int samples,
+             double min_clearance = 0.02);
+
+  /** \brief Record a certificate for \e state, known to be self-collision
+   *  free with at least \e clearance of separation between all checked
+   *  body pairs.  Rebuilds the kd-tree, so prefer \ref train for bulk
+   *  insertion. */
+  void addCertificate(const robot_state::RobotState& state, double clearance);
+
+  /** \brief Returns true if \e state lies within the certified ball of
+   *  some stored certificate and is therefore provably self-collision
+   *  free; false means unknown, not in collision. */
+  bool isCertifiedFree(const robot_state::RobotState& state) const;
+
+  std::size_t getNumCertificates() const
+  {
+    return certificates_.size();
+  }
+
+private:
+  /** \brief A self-collision free sample; joint values are pre-scaled by
+   *  the per-variable motion bounds so that the certified ball is simply
+   *  the set of scaled points within L1 distance \e clearance_ */
+  struct Certificate
+  {
+    std::vector<double> scaled_values_;
+    double clearance_;
+  };
+
+  /** \brief kd-tree node over the certificates; the splitting dimension
+   *  is the tree depth modulo the number of variables */
+  struct Node
+  {
+    int certificate_;
+    int left_;
+    int right_;
+    double subtree_max_clearance_; /**< \brief Largest clearance in this subtree, used for pruning */
+  };
+
+  /** \brief Copies the group's variables from \e state and applies the
+   *  per-variable motion bound scaling */
+  void scaleVariables(const robot_state::RobotState& state, std::vector<double>& scaled) const;
+
+  int buildTree(std::vector<int>& order, int start, int end, int depth);
+  void rebuildTree();
+  bool queryTree(int node_index, int depth, const std::vector<double>& scaled) const;
+
+  robot_model::RobotModelConstPtr robot_model_;
+  std::string group_name_;
+  const robot_model::JointModelGroup* jmg_;
+
+  /** \brief Per-variable bound on collision body motion per unit change,
+   *  already doubled for the pair of moving bodies */
+  std::vector<double> motion_factors_;
+  /** \brief Scaled wrap-around period per variable; zero for non-continuous variables */
+  std::vector<double> periods_;
+
+  std::vector<Certificate> certificates_;
+  std::vector<Node> nodes_;
+  int root_;
+};
+}
+
+#endif
@@ -39,7 +39,10 @@
 
 #include <moveit/macros/class_forward.h>
 
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 #include <map>
 #include <memory>
@@ -105,6 +108,23 @@ public:
      *
      * @copydetails shapes_ */
     EigenSTL::vector_Isometry3d shape_poses_;
+
+    /** \brief Time stamps of the waypoints of an optional pose track
+     * predicting the motion of this object (e.g. an object on a conveyor).
+     *
+     * Each waypoint pose in pose_track_poses_ is a world-frame transform
+     * applied to all of shape_poses_, using the same convention as
+     * World::moveObject(): at time pose_track_times_[i] the predicted pose
+     * of shape j is pose_track_poses_[i] * shape_poses_[j]. The track only
+     * affects time-parameterized collision queries; shape_poses_ always
+     * holds the current poses. Empty for static objects. Times must be
+     * strictly increasing. */
+    std::vector<double> pose_track_times_;
+
+    /** \brief The poses of the corresponding entries in pose_track_times_.
+     *
+     * @copydetails pose_track_times_ */
+    EigenSTL::vector_Isometry3d pose_track_poses_;
   };
 
   /** \brief Get the list of Object ids */
@@ -160,6 +180,23 @@ public:
   /** \brief Move all shapes in an object according to the given transform specified in world frame */
   bool moveObject(const std::string& id, const Eigen::Isometry3d& transform);
 
+  /** \brief Attach a timed pose track to an object; see Object::pose_track_times_
+   * for the waypoint semantics. Passing empty vectors clears the track.
+   * Returns true on success and false if the object does not exist, the
+   * number of times and poses differ, or the times are not strictly
+   * increasing. */
+  bool setObjectPoseTrack(const std::string& id, const std::vector<double>& times,
+                          const EigenSTL::vector_Isometry3d& poses);
+
+  /** \brief Evaluate the pose track of \e obj at \e time: the world-frame
+   * transform to apply to the object's current shape poses. Interpolates
+   * linearly in translation and spherically in rotation between waypoints;
+   * before the first waypoint the first pose is returned, past the last
+   * waypoint the translation is extrapolated at the velocity of the last
+   * segment with the last orientation held. Returns identity if the object
+   * carries no track. */
+  static Eigen::Isometry3d interpolatePoseTrack(const Object& obj, double time);
+
   /** \brief Remove shape from object.
    * Shape equality is verified by comparing pointers. Ownership of the
    * object is renounced (i.e. object is deleted if no external references
@@ -244,10 +281,45 @@ public:
    * Used which switching from one world to another. */
   void notifyObserverAllObjects(const ObserverHandle observer_handle, Action action) const;
 
+  /** \brief Monotonic counter advanced whenever objects or shapes are added
+   * to or removed from the world. Together with getPoseEpoch() this gives
+   * caches built on top of the world a cheap validity test: the world is
+   * unchanged if and only if both epochs still match the values recorded
+   * when the cache was filled. Safe to read from other threads. */
+  std::uint64_t getGeometryEpoch() const
+  {
+    return geometry_epoch_.load(std::memory_order_relaxed);
+  }
+
+  /** \brief Monotonic counter advanced whenever shapes move without the set
+   * of shapes changing. Shape additions and removals advance the geometry
+   * epoch instead, so cache validity tests must compare both epochs.
+   * Safe to read from other threads. */
+  std::uint64_t getPoseEpoch() const
+  {
+    return pose_epoch_.load(std::memory_order_relaxed);
+  }
+
+  /** \brief Defer observer notifications until the matching call to
+   * flushNotifications(). Deferred changes to the same object are merged,
+   * so observers see at most one callback per changed object per batch
+   * instead of one per modifying call. Calls may be nested; notifications
+   * are delivered when the outermost defer is flushed. The epoch counters
+   * advance immediately, independent of deferral. */
+  void deferNotifications();
+
+  /** \brief Deliver the notifications collected since the matching
+   * deferNotifications() call. */
+  void flushNotifications();
+
 private:
-  /** notify all observers of a change */
+  /** record a change: advance the epoch counters and notify all observers,
+   * or queue the notification if notifications are deferred */
   void notify(const ObjectConstPtr&, Action);
 
+  /** invoke the observer callbacks for a change */
+  void notifyObservers(const ObjectConstPtr&, Action);
+
   /** send notification of change to all objects. */
   void notifyAll(Action action);
 
@@ -273,6 +345,15 @@ private:
     ObserverCallbackFn callback_;
   };
   std::vector<Observer*> observers_;
+
+  /* change counters behind getGeometryEpoch() / getPoseEpoch() */
+  std::atomic<std::uint64_t> geometry_epoch_;
+  std::atomic<std::uint64_t> pose_epoch_;
+
+  /* nesting depth of deferNotifications() calls and the notifications
+   * collected while deferred, in the order the objects were first changed */
+  int deferred_notifications_depth_;
+  std::vector<std::pair<ObjectConstPtr, int>> deferred_notifications_;
 };
 }
 
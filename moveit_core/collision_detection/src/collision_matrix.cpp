@@ -40,6 +40,9 @@
 
 namespace collision_detection
 {
+// marker stored in the compiled matrix for pairs that have no entry and no applicable default
+static const std::uint8_t NO_COMPILED_ENTRY = 0xFF;
+
 AllowedCollisionMatrix::AllowedCollisionMatrix()
 {
 }
@@ -81,6 +84,16 @@ AllowedCollisionMatrix::AllowedCollisionMatrix(const AllowedCollisionMatrix& acm
   default_allowed_contacts_ = acm.default_allowed_contacts_;
 }
 
+AllowedCollisionMatrix& AllowedCollisionMatrix::operator=(const AllowedCollisionMatrix& acm)
+{
+  entries_ = acm.entries_;
+  allowed_contacts_ = acm.allowed_contacts_;
+  default_entries_ = acm.default_entries_;
+  default_allowed_contacts_ = acm.default_allowed_contacts_;
+  invalidateCompiled();
+  return *this;
+}
+
 bool AllowedCollisionMatrix::getEntry(const std::string& name1, const std::string& name2, DecideContactFn& fn) const
 {
   auto it1 = allowed_contacts_.find(name1);
@@ -140,12 +153,14 @@ void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::strin
     if (jt != it->second.end())
       it->second.erase(jt);
   }
+  invalidateCompiled();
 }
 
 void AllowedCollisionMatrix::setEntry(const std::string& name1, const std::string& name2, const DecideContactFn& fn)
 {
   entries_[name1][name2] = entries_[name2][name1] = AllowedCollision::CONDITIONAL;
   allowed_contacts_[name1][name2] = allowed_contacts_[name2][name1] = fn;
+  invalidateCompiled();
 }
 
 void AllowedCollisionMatrix::removeEntry(const std::string& name)
@@ -156,6 +171,7 @@ void AllowedCollisionMatrix::removeEntry(const std::string& name)
     entry.second.erase(name);
   for (auto& allowed_contact : allowed_contacts_)
     allowed_contact.second.erase(name);
+  invalidateCompiled();
 }
 
 void AllowedCollisionMatrix::removeEntry(const std::string& name1, const std::string& name2)
@@ -189,6 +205,7 @@ void AllowedCollisionMatrix::removeEntry(const std::string& name1, const std::st
     if (jt != it->second.end())
       it->second.erase(jt);
   }
+  invalidateCompiled();
 }
 
 void AllowedCollisionMatrix::setEntry(const std::string& name, const std::vector<std::string>& other_names,
@@ -223,6 +240,7 @@ void AllowedCollisionMatrix::setEntry(bool allowed)
   for (auto& entry : entries_)
     for (auto& it2 : entry.second)
       it2.second = v;
+  invalidateCompiled();
 }
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, bool allowed)
@@ -230,12 +248,14 @@ void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, bool allow
   const AllowedCollision::Type v = allowed ? AllowedCollision::ALWAYS : AllowedCollision::NEVER;
   default_entries_[name] = v;
   default_allowed_contacts_.erase(name);
+  invalidateCompiled();
 }
 
 void AllowedCollisionMatrix::setDefaultEntry(const std::string& name, const DecideContactFn& fn)
 {
   default_entries_[name] = AllowedCollision::CONDITIONAL;
   default_allowed_contacts_[name] = fn;
+  invalidateCompiled();
 }
 
 bool AllowedCollisionMatrix::getDefaultEntry(const std::string& name, AllowedCollision::Type& allowed_collision) const
@@ -284,8 +304,8 @@ bool AllowedCollisionMatrix::getAllowedCollision(const std::string& name1, const
   }
 }
 
-bool AllowedCollisionMatrix::getAllowedCollision(const std::string& name1, const std::string& name2,
-                                                 AllowedCollision::Type& allowed_collision) const
+bool AllowedCollisionMatrix::lookupAllowedCollision(const std::string& name1, const std::string& name2,
+                                                    AllowedCollision::Type& allowed_collision) const
 {
   AllowedCollision::Type t1, t2;
   bool found1 = getDefaultEntry(name1, t1);
@@ -314,12 +334,59 @@ bool AllowedCollisionMatrix::getAllowedCollision(const std::string& name1, const
   }
 }
 
+void AllowedCollisionMatrix::compile() const
+{
+  std::lock_guard<std::mutex> guard(compiled_lock_);
+  if (compiled_valid_.load(std::memory_order_relaxed))
+    return;  // another thread rebuilt the compiled matrix while we waited for the lock
+
+  compiled_ids_.clear();
+  for (const auto& entry : entries_)
+    compiled_ids_.emplace(entry.first, compiled_ids_.size());
+  for (const auto& entry : default_entries_)
+    compiled_ids_.emplace(entry.first, compiled_ids_.size());
+
+  const std::size_t n = compiled_ids_.size();
+  compiled_size_ = n;
+  compiled_types_.assign(n * n, NO_COMPILED_ENTRY);
+  for (const auto& e1 : compiled_ids_)
+    for (const auto& e2 : compiled_ids_)
+    {
+      AllowedCollision::Type type;
+      if (lookupAllowedCollision(e1.first, e2.first, type))
+        compiled_types_[e1.second * n + e2.second] = static_cast<std::uint8_t>(type);
+    }
+  compiled_valid_.store(true, std::memory_order_release);
+}
+
+bool AllowedCollisionMatrix::getAllowedCollision(const std::string& name1, const std::string& name2,
+                                                 AllowedCollision::Type& allowed_collision) const
+{
+  if (!compiled_valid_.load(std::memory_order_acquire))
+    compile();
+
+  // every name with an entry or a default is interned; unknown names cannot have an allowed
+  // collision type, so two hash lookups and an array read answer the query
+  auto it1 = compiled_ids_.find(name1);
+  if (it1 == compiled_ids_.end())
+    return false;
+  auto it2 = compiled_ids_.find(name2);
+  if (it2 == compiled_ids_.end())
+    return false;
+  const std::uint8_t t = compiled_types_[it1->second * compiled_size_ + it2->second];
+  if (t == NO_COMPILED_ENTRY)
+    return false;
+  allowed_collision = static_cast<AllowedCollision::Type>(t);
+  return true;
+}
+
 void AllowedCollisionMatrix::clear()
 {
   entries_.clear();
   allowed_contacts_.clear();
   default_entries_.clear();
   default_allowed_contacts_.clear();
+  invalidateCompiled();
 }
 
 void AllowedCollisionMatrix::getAllEntryNames(std::vector<std::string>& names) const
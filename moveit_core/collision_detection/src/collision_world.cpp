@@ -84,6 +84,30 @@ void CollisionWorld::checkCollision(const CollisionRequest& req, CollisionResult
     checkRobotCollision(req, res, robot, state1, state2, acm);
 }
 
+std::size_t CollisionWorld::checkRobotCollisionBatch(const CollisionRequest& req,
+                                                     std::vector<CollisionResult>& results,
+                                                     const CollisionRobot& robot,
+                                                     const std::vector<const robot_state::RobotState*>& states,
+                                                     const AllowedCollisionMatrix& acm,
+                                                     bool stop_at_first_collision) const
+{
+  results.resize(states.size());
+  std::size_t first_collision = states.size();
+  for (std::size_t i = 0; i < states.size(); ++i)
+  {
+    results[i].clear();
+    checkRobotCollision(req, results[i], robot, *states[i], acm);
+    if (results[i].collision)
+    {
+      if (first_collision == states.size())
+        first_collision = i;
+      if (stop_at_first_collision)
+        break;
+    }
+  }
+  return first_collision;
+}
+
 void CollisionWorld::setWorld(const WorldPtr& world)
 {
   world_ = world;
@@ -0,0 +1,246 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/collision_detection/self_collision_certificate_cache.h>
+#include <moveit/robot_model/revolute_joint_model.h>
+#include <random_numbers/random_numbers.h>
+#include <ros/console.h>
+#include <algorithm>
+#include <cmath>
+
+namespace collision_detection
+{
+SelfCollisionCertificateCache::SelfCollisionCertificateCache(const robot_model::RobotModelConstPtr& robot_model,
+                                                             const std::string& group_name)
+  : robot_model_(robot_model), group_name_(group_name), jmg_(robot_model->getJointModelGroup(group_name)), root_(-1)
+{
+  if (!jmg_)
+  {
+    ROS_ERROR_NAMED("collision_detection", "Group '%s' not found in model; certificate cache will stay empty",
+                    group_name.c_str());
+    return;
+  }
+
+  // a variable change of dq moves every point of a collision body by at most
+  // dq times the robot's maximum extent for angular variables and by dq for
+  // translational ones; the factor two accounts for both bodies of a pair
+  // moving towards each other
+  const double angular_bound = 2.0 * robot_model_->getMaximumExtent();
+  motion_factors_.reserve(jmg_->getVariableCount());
+  periods_.reserve(jmg_->getVariableCount());
+  for (const robot_model::JointModel* jm : jmg_->getJointModels())
+  {
+    if (jm->getVariableCount() == 0)
+      continue;
+    switch (jm->getType())
+    {
+      case robot_model::JointModel::REVOLUTE:
+      {
+        motion_factors_.push_back(angular_bound);
+        bool continuous = static_cast<const robot_model::RevoluteJointModel*>(jm)->isContinuous();
+        periods_.push_back(continuous ? 2.0 * M_PI * angular_bound : 0.0);
+        break;
+      }
+      case robot_model::JointModel::PRISMATIC:
+        motion_factors_.push_back(2.0);
+        periods_.push_back(0.0);
+        break;
+      case robot_model::JointModel::PLANAR:
+        // x, y translation then the yaw angle
+        motion_factors_.push_back(2.0);
+        motion_factors_.push_back(2.0);
+        motion_factors_.push_back(angular_bound);
+        periods_.push_back(0.0);
+        periods_.push_back(0.0);
+        periods_.push_back(2.0 * M_PI * angular_bound);
+        break;
+      default:
+        // floating and anything unanticipated: bound every variable by the
+        // angular factor, which dominates the translational one whenever the
+        // robot is larger than half a meter
+        for (std::size_t i = 0; i < jm->getVariableCount(); ++i)
+        {
+          motion_factors_.push_back(std::max(2.0, angular_bound));
+          periods_.push_back(0.0);
+        }
+        break;
+    }
+  }
+}
+
+void SelfCollisionCertificateCache::scaleVariables(const robot_state::RobotState& state,
+                                                   std::vector<double>& scaled) const
+{
+  state.copyJointGroupPositions(jmg_, scaled);
+  for (std::size_t i = 0; i < scaled.size(); ++i)
+    scaled[i] *= motion_factors_[i];
+}
+
+void SelfCollisionCertificateCache::train(const CollisionRobot& robot, const AllowedCollisionMatrix& acm,
+                                          unsigned int samples, double min_clearance)
+{
+  if (!jmg_)
+    return;
+
+  robot_state::RobotState state(robot_model_);
+  state.setToDefaultValues();
+  random_numbers::RandomNumberGenerator rng;
+
+  CollisionRequest req;
+  req.group_name = group_name_;
+  req.distance = true;
+
+  unsigned int added = 0;
+  for (unsigned int i = 0; i < samples; ++i)
+  {
+    state.setToRandomPositions(jmg_, rng);
+    state.update();
+
+    CollisionResult res;
+    robot.checkSelfCollision(req, res, state, acm);
+    if (res.collision || !(res.distance > min_clearance) || !std::isfinite(res.distance))
+      continue;
+
+    Certificate certificate;
+    certificate.scaled_values_.resize(jmg_->getVariableCount());
+    scaleVariables(state, certificate.scaled_values_);
+    certificate.clearance_ = res.distance;
+    certificates_.push_back(certificate);
+    added++;
+  }
+  rebuildTree();
+
+  ROS_DEBUG_NAMED("collision_detection", "Certificate cache for group '%s' kept %u of %u sampled states",
+                  group_name_.c_str(), added, samples);
+}
+
+void SelfCollisionCertificateCache::addCertificate(const robot_state::RobotState& state, double clearance)
+{
+  if (!jmg_ || clearance <= 0.0)
+    return;
+
+  Certificate certificate;
+  certificate.scaled_values_.resize(jmg_->getVariableCount());
+  scaleVariables(state, certificate.scaled_values_);
+  certificate.clearance_ = clearance;
+  certificates_.push_back(certificate);
+  rebuildTree();
+}
+
+int SelfCollisionCertificateCache::buildTree(std::vector<int>& order, int start, int end, int depth)
+{
+  if (start >= end)
+    return -1;
+
+  int dim = depth % static_cast<int>(motion_factors_.size());
+  int mid = (start + end) / 2;
+  std::nth_element(order.begin() + start, order.begin() + mid, order.begin() + end, [this, dim](int a, int b) {
+    return certificates_[a].scaled_values_[dim] < certificates_[b].scaled_values_[dim];
+  });
+
+  int node_index = nodes_.size();
+  Node node;
+  node.certificate_ = order[mid];
+  node.left_ = -1;
+  node.right_ = -1;
+  node.subtree_max_clearance_ = certificates_[order[mid]].clearance_;
+  nodes_.push_back(node);
+
+  int left = buildTree(order, start, mid, depth + 1);
+  int right = buildTree(order, mid + 1, end, depth + 1);
+  nodes_[node_index].left_ = left;
+  nodes_[node_index].right_ = right;
+  if (left >= 0)
+    nodes_[node_index].subtree_max_clearance_ =
+        std::max(nodes_[node_index].subtree_max_clearance_, nodes_[left].subtree_max_clearance_);
+  if (right >= 0)
+    nodes_[node_index].subtree_max_clearance_ =
+        std::max(nodes_[node_index].subtree_max_clearance_, nodes_[right].subtree_max_clearance_);
+  return node_index;
+}
+
+void SelfCollisionCertificateCache::rebuildTree()
+{
+  nodes_.clear();
+  nodes_.reserve(certificates_.size());
+  std::vector<int> order(certificates_.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  root_ = buildTree(order, 0, static_cast<int>(order.size()), 0);
+}
+
+bool SelfCollisionCertificateCache::queryTree(int node_index, int depth, const std::vector<double>& scaled) const
+{
+  if (node_index < 0)
+    return false;
+
+  const Node& node = nodes_[node_index];
+  const Certificate& certificate = certificates_[node.certificate_];
+
+  double dist = 0.0;
+  for (std::size_t i = 0; i < scaled.size() && dist < certificate.clearance_; ++i)
+  {
+    double diff = fabs(scaled[i] - certificate.scaled_values_[i]);
+    if (periods_[i] > 0.0 && diff > 0.5 * periods_[i])
+      diff = periods_[i] - diff;
+    dist += diff;
+  }
+  if (dist < certificate.clearance_)
+    return true;
+
+  int dim = depth % static_cast<int>(scaled.size());
+  double delta = scaled[dim] - certificate.scaled_values_[dim];
+  int near_child = delta < 0.0 ? node.left_ : node.right_;
+  int far_child = delta < 0.0 ? node.right_ : node.left_;
+
+  if (queryTree(near_child, depth + 1, scaled))
+    return true;
+
+  // the far subtree can only hold a certifying ball if some certificate in it
+  // reaches across the splitting plane; wrap-around dimensions cannot be
+  // pruned this way
+  if (far_child >= 0 && (periods_[dim] > 0.0 || fabs(delta) < nodes_[far_child].subtree_max_clearance_))
+    return queryTree(far_child, depth + 1, scaled);
+  return false;
+}
+
+bool SelfCollisionCertificateCache::isCertifiedFree(const robot_state::RobotState& state) const
+{
+  if (root_ < 0)
+    return false;
+  std::vector<double> scaled(motion_factors_.size());
+  scaleVariables(state, scaled);
+  return queryTree(root_, 0, scaled);
+}
+}
@@ -36,14 +36,16 @@
 
 #include <moveit/collision_detection/world.h>
 #include <ros/console.h>
+#include <algorithm>
 
 namespace collision_detection
 {
-World::World()
+World::World() : geometry_epoch_(0), pose_epoch_(0), deferred_notifications_depth_(0)
 {
 }
 
 World::World(const World& other)
+  : geometry_epoch_(other.getGeometryEpoch()), pose_epoch_(other.getPoseEpoch()), deferred_notifications_depth_(0)
 {
   objects_ = other.objects_;
 }
@@ -171,6 +173,67 @@ bool World::moveObject(const std::string& id, const Eigen::Isometry3d& transform
   return true;
 }
 
+bool World::setObjectPoseTrack(const std::string& id, const std::vector<double>& times,
+                               const EigenSTL::vector_Isometry3d& poses)
+{
+  if (times.size() != poses.size())
+  {
+    ROS_ERROR_NAMED("collision_detection", "Number of pose track times and poses do not match for object '%s'. "
+                                           "Not setting the pose track.",
+                    id.c_str());
+    return false;
+  }
+  for (std::size_t i = 1; i < times.size(); ++i)
+    if (times[i] <= times[i - 1])
+    {
+      ROS_ERROR_NAMED("collision_detection", "Pose track times for object '%s' must be strictly increasing. "
+                                             "Not setting the pose track.",
+                      id.c_str());
+      return false;
+    }
+
+  auto it = objects_.find(id);
+  if (it == objects_.end())
+    return false;
+  ensureUnique(it->second);
+  it->second->pose_track_times_ = times;
+  it->second->pose_track_poses_ = poses;
+
+  // a changed track changes what time-parameterized queries report, which is
+  // the same class of change as moving the object
+  notify(it->second, MOVE_SHAPE);
+  return true;
+}
+
+Eigen::Isometry3d World::interpolatePoseTrack(const Object& obj, double time)
+{
+  const std::vector<double>& times = obj.pose_track_times_;
+  const EigenSTL::vector_Isometry3d& poses = obj.pose_track_poses_;
+  if (times.empty())
+    return Eigen::Isometry3d::Identity();
+  if (time <= times.front())
+    return poses.front();
+  if (time >= times.back())
+  {
+    const std::size_t n = times.size();
+    if (n == 1)
+      return poses.back();
+    // extrapolate the translation at the velocity of the last segment; hold the last orientation
+    Eigen::Isometry3d result = poses[n - 1];
+    result.translation() += (poses[n - 1].translation() - poses[n - 2].translation()) *
+                            ((time - times[n - 1]) / (times[n - 1] - times[n - 2]));
+    return result;
+  }
+
+  const std::size_t seg = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+  const double s = (time - times[seg - 1]) / (times[seg] - times[seg - 1]);
+  const Eigen::Quaterniond q0(poses[seg - 1].linear());
+  const Eigen::Quaterniond q1(poses[seg].linear());
+  Eigen::Isometry3d result(q0.slerp(s, q1));
+  result.translation() = (1.0 - s) * poses[seg - 1].translation() + s * poses[seg].translation();
+  return result;
+}
+
 bool World::removeShapeFromObject(const std::string& id, const shapes::ShapeConstPtr& shape)
 {
   auto it = objects_.find(id);
@@ -244,11 +307,76 @@ void World::notifyAll(Action action)
 }
 
 void World::notify(const ObjectConstPtr& obj, Action action)
+{
+  // the epochs advance immediately, even while notifications are deferred,
+  // so caches keyed on them never see a stale world as current
+  if (action & MOVE_SHAPE)
+    pose_epoch_.fetch_add(1, std::memory_order_relaxed);
+  if (action & (CREATE | DESTROY | ADD_SHAPE | REMOVE_SHAPE))
+    geometry_epoch_.fetch_add(1, std::memory_order_relaxed);
+
+  if (deferred_notifications_depth_ > 0)
+  {
+    // merge with the most recent pending notification for this object, so
+    // observers get one callback per object when the batch is flushed
+    for (std::vector<std::pair<ObjectConstPtr, int>>::reverse_iterator it = deferred_notifications_.rbegin();
+         it != deferred_notifications_.rend(); ++it)
+      if (it->first->id_ == obj->id_)
+      {
+        if (it->second & DESTROY)
+          break;  // object is being recreated after a destroy; keep the callbacks separate
+        if (action & DESTROY)
+        {
+          if (it->second & CREATE)
+          {
+            // created and destroyed within the batch; observers never need to hear about it
+            deferred_notifications_.erase(std::next(it).base());
+            return;
+          }
+          // a destroy supersedes the modifications recorded so far
+          it->second = DESTROY;
+        }
+        else
+          it->second |= static_cast<int>(ActionBits(action));
+        it->first = obj;
+        return;
+      }
+    deferred_notifications_.push_back(std::make_pair(obj, static_cast<int>(ActionBits(action))));
+    return;
+  }
+
+  notifyObservers(obj, action);
+}
+
+void World::notifyObservers(const ObjectConstPtr& obj, Action action)
 {
   for (std::vector<Observer*>::const_iterator obs = observers_.begin(); obs != observers_.end(); ++obs)
     (*obs)->callback_(obj, action);
 }
 
+void World::deferNotifications()
+{
+  ++deferred_notifications_depth_;
+}
+
+void World::flushNotifications()
+{
+  if (deferred_notifications_depth_ == 0)
+  {
+    ROS_ERROR_NAMED("collision_detection", "flushNotifications() called without a matching deferNotifications()");
+    return;
+  }
+  if (--deferred_notifications_depth_ > 0)
+    return;
+
+  // deliver through a local copy so that observer callbacks modifying the
+  // world do not invalidate the iteration
+  std::vector<std::pair<ObjectConstPtr, int>> pending;
+  pending.swap(deferred_notifications_);
+  for (std::size_t i = 0; i < pending.size(); ++i)
+    notifyObservers(pending[i].first, Action(pending[i].second));
+}
+
 void World::notifyObserverAllObjects(const ObserverHandle observer_handle, Action action) const
 {
   for (auto observer : observers_)
@@ -365,6 +365,112 @@ TEST(World, TrackChanges)
   EXPECT_EQ(4, ta3.cnt_);
 }
 
+TEST(World, EpochsAndDeferredNotifications)
+{
+  collision_detection::World world;
+
+  shapes::ShapePtr ball(new shapes::Sphere(1.0));
+  shapes::ShapePtr box(new shapes::Box(1, 2, 3));
+
+  // additions and removals advance the geometry epoch, moves the pose epoch
+  std::uint64_t geom = world.getGeometryEpoch();
+  std::uint64_t pose = world.getPoseEpoch();
+
+  world.addToObject("ball", ball, Eigen::Isometry3d::Identity());
+  EXPECT_GT(world.getGeometryEpoch(), geom);
+  EXPECT_EQ(world.getPoseEpoch(), pose);
+
+  geom = world.getGeometryEpoch();
+  EXPECT_TRUE(world.moveShapeInObject("ball", ball, Eigen::Isometry3d(Eigen::Translation3d(0, 0, 1))));
+  EXPECT_EQ(world.getGeometryEpoch(), geom);
+  EXPECT_GT(world.getPoseEpoch(), pose);
+
+  pose = world.getPoseEpoch();
+  EXPECT_TRUE(world.removeObject("ball"));
+  EXPECT_GT(world.getGeometryEpoch(), geom);
+  EXPECT_EQ(world.getPoseEpoch(), pose);
+
+  // deferred changes to one object are merged into a single notification
+  TestAction ta;
+  collision_detection::World::ObserverHandle observer_ta;
+  observer_ta = world.addObserver(boost::bind(TrackChangesNotify, &ta, _1, _2));
+
+  geom = world.getGeometryEpoch();
+  world.deferNotifications();
+  world.addToObject("obj1", ball, Eigen::Isometry3d::Identity());
+  world.addToObject("obj1", box, Eigen::Isometry3d::Identity());
+  EXPECT_TRUE(world.moveShapeInObject("obj1", ball, Eigen::Isometry3d(Eigen::Translation3d(0, 0, 2))));
+  EXPECT_EQ(0, ta.cnt_);
+  // the epochs advance immediately, even while notifications are deferred
+  EXPECT_GT(world.getGeometryEpoch(), geom);
+  world.flushNotifications();
+
+  EXPECT_EQ(1, ta.cnt_);
+  EXPECT_EQ("obj1", ta.obj_.id_);
+  EXPECT_EQ(collision_detection::World::CREATE | collision_detection::World::ADD_SHAPE |
+                collision_detection::World::MOVE_SHAPE,
+            ta.action_);
+  ta.reset();
+
+  // an object created and destroyed within a batch is never reported
+  world.deferNotifications();
+  world.addToObject("obj2", box, Eigen::Isometry3d::Identity());
+  EXPECT_TRUE(world.removeObject("obj2"));
+  EXPECT_TRUE(world.removeObject("obj1"));
+  world.flushNotifications();
+
+  EXPECT_EQ(1, ta.cnt_);
+  EXPECT_EQ("obj1", ta.obj_.id_);
+  EXPECT_EQ(collision_detection::World::DESTROY, ta.action_);
+
+  world.removeObserver(observer_ta);
+}
+
+TEST(World, PoseTrack)
+{
+  collision_detection::World world;
+
+  shapes::ShapePtr ball(new shapes::Sphere(1.0));
+  world.addToObject("ball", ball, Eigen::Isometry3d::Identity());
+
+  std::vector<double> times;
+  EigenSTL::vector_Isometry3d poses;
+  times.push_back(0.0);
+  times.push_back(1.0);
+  poses.push_back(Eigen::Isometry3d::Identity());
+  poses.push_back(Eigen::Isometry3d(Eigen::Translation3d(2, 0, 0)));
+
+  // malformed tracks and unknown objects are rejected
+  EXPECT_FALSE(world.setObjectPoseTrack("missing", times, poses));
+  std::vector<double> bad_times(1, 0.0);
+  EXPECT_FALSE(world.setObjectPoseTrack("ball", bad_times, poses));
+  bad_times.push_back(0.0);
+  EXPECT_FALSE(world.setObjectPoseTrack("ball", bad_times, poses));
+
+  EXPECT_TRUE(world.setObjectPoseTrack("ball", times, poses));
+  collision_detection::World::ObjectConstPtr obj = world.getObject("ball");
+  ASSERT_TRUE(bool(obj));
+  EXPECT_EQ(2u, obj->pose_track_times_.size());
+
+  // before the first waypoint the first pose holds; in between translation interpolates
+  // linearly; past the last waypoint the last segment's velocity extrapolates
+  Eigen::Isometry3d tf = collision_detection::World::interpolatePoseTrack(*obj, -1.0);
+  EXPECT_NEAR(0.0, tf.translation().x(), 1e-12);
+  tf = collision_detection::World::interpolatePoseTrack(*obj, 0.5);
+  EXPECT_NEAR(1.0, tf.translation().x(), 1e-12);
+  tf = collision_detection::World::interpolatePoseTrack(*obj, 2.0);
+  EXPECT_NEAR(4.0, tf.translation().x(), 1e-12);
+
+  // the track does not change the current shape poses
+  EXPECT_NEAR(0.0, obj->shape_poses_[0].translation().x(), 1e-12);
+
+  // an empty track clears; objects without a track evaluate to identity
+  EXPECT_TRUE(world.setObjectPoseTrack("ball", std::vector<double>(), EigenSTL::vector_Isometry3d()));
+  obj = world.getObject("ball");
+  tf = collision_detection::World::interpolatePoseTrack(*obj, 0.5);
+  EXPECT_TRUE(tf.isApprox(Eigen::Isometry3d::Identity()));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -52,13 +52,21 @@
 #include <fcl/distance.h>
 #endif
 
+#include <array>
+#include <map>
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace collision_detection
 {
 MOVEIT_STRUCT_FORWARD(CollisionGeometryData);
 
+/// World-frame axis-aligned box of a coarse occupied octomap region: min x,y,z then max x,y,z
+typedef std::array<double, 6> OctomapCoarseBox;
+/// The coarse occupied boxes of each octomap object, keyed by its FCL collision geometry
+typedef std::map<const fcl::CollisionGeometryd*, std::vector<OctomapCoarseBox> > OctomapCoarseBoxMap;
+
 struct CollisionGeometryData
 {
   CollisionGeometryData(const robot_model::LinkModel* link, int index) : type(BodyTypes::ROBOT_LINK), shape_index(index)
@@ -124,12 +132,13 @@ struct CollisionGeometryData
 
 struct CollisionData
 {
-  CollisionData() : req_(NULL), active_components_only_(NULL), res_(NULL), acm_(NULL), done_(false)
+  CollisionData()
+    : req_(NULL), active_components_only_(NULL), res_(NULL), acm_(NULL), octomap_coarse_boxes_(NULL), done_(false)
   {
   }
 
   CollisionData(const CollisionRequest* req, CollisionResult* res, const AllowedCollisionMatrix* acm)
-    : req_(req), active_components_only_(NULL), res_(res), acm_(acm), done_(false)
+    : req_(req), active_components_only_(NULL), res_(res), acm_(acm), octomap_coarse_boxes_(NULL), done_(false)
   {
   }
 
@@ -154,6 +163,11 @@ struct CollisionData
   /// The user specified collision matrix (may be NULL)
   const AllowedCollisionMatrix* acm_;
 
+  /// Coarse occupied boxes of the octomap objects in the queried world (may be NULL). When one
+  /// object of a candidate pair is an octomap, collisionCallback() skips the octree traversal if
+  /// the other object's AABB misses every coarse occupied box of that map.
+  const OctomapCoarseBoxMap* octomap_coarse_boxes_;
+
   /// Flag indicating whether collision checking is complete
   bool done_;
 };
@@ -38,6 +38,10 @@
 #define MOVEIT_COLLISION_DETECTION_FCL_COLLISION_ROBOT_
 
 #include <moveit/collision_detection_fcl/collision_common.h>
+#include <moveit/collision_detection/self_collision_certificate_cache.h>
+
+#include <memory>
+#include <mutex>
 
 namespace collision_detection
 {
@@ -80,7 +84,28 @@ public:
   void distanceOther(const DistanceRequest& req, DistanceResult& res, const robot_state::RobotState& state,
                      const CollisionRobot& other_robot, const robot_state::RobotState& other_state) const override;
 
+  /** \brief Enable (or disable) the persistent self-collision broadphase.
+      When enabled, the robot's collision objects live in one reusable
+      fcl::DynamicAABBTreeCollisionManager whose AABBs are updated in place (refit) from each
+      queried RobotState, instead of allocating a manager and re-registering all objects per
+      check. Successive planner states move little, so refitting is much cheaper than a rebuild.
+      Queries on this object are serialized through a mutex while the mode is active. */
+  void setPersistentBroadphase(bool flag);
+
+  /** \brief Use \e cache to answer boolean self-collision queries without
+      running the narrowphase whenever the queried state falls inside a
+      certified ball of a known self-collision-free sample. The cache only
+      applies to queries for its group that request neither contacts, cost
+      nor distance, and must have been trained with the same allowed
+      collision matrix and padding the queries use. Pass an empty pointer
+      to disable. */
+  void setSelfCollisionCertificateCache(const SelfCollisionCertificateCacheConstPtr& cache);
+
 protected:
+  /** \brief Refit the persistent broadphase manager to \e state, (re)creating it if needed;
+      attached bodies are re-registered on every call since their geometry may change.
+      Must be called with persistent_lock_ held. */
+  void updatePersistentBroadPhase(const robot_state::RobotState& state) const;
   void updatedPaddingOrScaling(const std::vector<std::string>& links) override;
   void constructFCLObject(const robot_state::RobotState& state, FCLObject& fcl_obj) const;
   void allocSelfCollisionBroadPhase(const robot_state::RobotState& state, FCLManager& manager) const;
@@ -94,6 +119,14 @@ protected:
 
   std::vector<FCLGeometryConstPtr> geoms_;
   std::vector<FCLCollisionObjectConstPtr> fcl_objs_;
+
+  bool use_persistent_broadphase_ = false;
+  mutable std::shared_ptr<fcl::BroadPhaseCollisionManagerd> persistent_manager_;
+  mutable FCLObject persistent_object_;           // per-link objects registered once, refit per query
+  mutable FCLObject persistent_attached_object_;  // attached body objects, rebuilt per query
+  mutable std::mutex persistent_lock_;
+
+  SelfCollisionCertificateCacheConstPtr self_collision_certificate_cache_;
 };
 }
 
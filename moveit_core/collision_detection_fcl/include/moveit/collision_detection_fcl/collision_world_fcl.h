@@ -46,7 +46,9 @@
 #include <fcl/broadphase/broadphase.h>
 #endif
 
+#include <Eigen/Geometry>
 #include <memory>
+#include <mutex>
 
 namespace collision_detection
 {
@@ -67,11 +69,26 @@ public:
   void checkRobotCollision(const CollisionRequest& req, CollisionResult& res, const CollisionRobot& robot,
                            const robot_state::RobotState& state1, const robot_state::RobotState& state2,
                            const AllowedCollisionMatrix& acm) const override;
+  std::size_t checkRobotCollisionBatch(const CollisionRequest& req, std::vector<CollisionResult>& results,
+                                       const CollisionRobot& robot,
+                                       const std::vector<const robot_state::RobotState*>& states,
+                                       const AllowedCollisionMatrix& acm,
+                                       bool stop_at_first_collision = false) const override;
   void checkWorldCollision(const CollisionRequest& req, CollisionResult& res,
                            const CollisionWorld& other_world) const override;
   void checkWorldCollision(const CollisionRequest& req, CollisionResult& res, const CollisionWorld& other_world,
                            const AllowedCollisionMatrix& acm) const override;
 
+  /** \brief Check robot-vs-world collision for a state at a predicted point in time. World objects
+      carrying a pose track (see World::Object::pose_track_times_) are checked at the pose the track
+      extrapolates to for \e time; objects without a track are checked at their current pose. This
+      lets a single plan account for predictably moving obstacles (e.g. conveyor objects) instead of
+      replanning on every pose update. The broadphase manager holds the current poses, so this query
+      runs pairwise with an AABB cull; only collisions are computed, not distances. */
+  void checkRobotCollisionAtTime(const CollisionRequest& req, CollisionResult& res, const CollisionRobot& robot,
+                                 const robot_state::RobotState& state, const AllowedCollisionMatrix& acm,
+                                 double time) const;
+
   void distanceRobot(const DistanceRequest& req, DistanceResult& res, const CollisionRobot& robot,
                      const robot_state::RobotState& state) const override;
 
@@ -79,18 +96,68 @@ public:
 
   void setWorld(const WorldPtr& world) override;
 
+  /** \brief Enable (or disable) conservative caching of per-link distance queries. When enabled,
+      distanceRobot() remembers each link body's last queried transform and its distance to the
+      world. A subsequent query skips a link when its cached distance minus the maximum possible
+      body displacement since then still exceeds DistanceRequest::distance_threshold, reporting the
+      conservative bound instead. Intended for high-rate queries with small state deltas; only
+      applies to GLOBAL queries without nearest-point reporting. Cache entries are invalidated by
+      any world change. */
+  void setDistanceCacheEnabled(bool flag);
+
 protected:
   void checkWorldCollisionHelper(const CollisionRequest& req, CollisionResult& res, const CollisionWorld& other_world,
                                  const AllowedCollisionMatrix* acm) const;
+  /** \brief Continuous (swept) robot-vs-world check between two states using FCL's conservative
+      advancement, parallelized across the robot's collision objects. Only a binary collision answer
+      is produced; contacts and cost sources are not computed for continuous checks. */
+  void checkRobotCollisionHelperCCD(const CollisionRequest& req, CollisionResult& res, const CollisionRobot& robot,
+                                    const robot_state::RobotState& state1, const robot_state::RobotState& state2,
+                                    const AllowedCollisionMatrix* acm) const;
   void checkRobotCollisionHelper(const CollisionRequest& req, CollisionResult& res, const CollisionRobot& robot,
                                  const robot_state::RobotState& state, const AllowedCollisionMatrix* acm) const;
 
   void constructFCLObject(const World::Object* obj, FCLObject& fcl_obj) const;
   void updateFCLObject(const std::string& id);
 
+  /** \brief Refit the existing broadphase entries of a moved object in place. Returns false if the
+      object is unknown or its FCL objects do not match the shapes one to one, in which case the
+      caller must fall back to a full rebuild via updateFCLObject(). */
+  bool moveFCLObject(const World::Object* obj);
+
+  /** \brief Rebuild the coarse occupied boxes for the octomap shapes of \e obj (a no-op for
+      objects without octomap shapes). The boxes are the world-frame AABBs of the occupied
+      octree nodes a few levels above the leaves, built once per octomap update and used by
+      collisionCallback() to skip octree traversals for robot links far from occupied space. */
+  void rebuildOctomapCoarseBoxes(const World::Object* obj);
+
+  /** \brief Drop the coarse occupied boxes recorded for object \e id */
+  void clearOctomapCoarseBoxes(const std::string& id);
+
   std::unique_ptr<fcl::BroadPhaseCollisionManagerd> manager_;
   std::map<std::string, FCLObject> fcl_objs_;
 
+  /// coarse occupied boxes per octomap object geometry, plus the geometries recorded per
+  /// object id so the entries can be dropped when the object changes or goes away
+  OctomapCoarseBoxMap octomap_coarse_boxes_;
+  std::map<std::string, std::vector<const fcl::CollisionGeometryd*> > octomap_geometry_by_id_;
+
+  struct DistanceCacheEntry
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Eigen::Isometry3d tf;         // transform of the link body at the time of the query
+    double distance;              // distance to the world computed for that transform
+    unsigned int world_version;   // world change counter the entry is valid for
+  };
+  using DistanceCacheMap =
+      std::map<std::pair<std::string, int>, DistanceCacheEntry, std::less<std::pair<std::string, int>>,
+               Eigen::aligned_allocator<std::pair<const std::pair<std::string, int>, DistanceCacheEntry>>>;
+
+  bool use_distance_cache_ = false;
+  unsigned int world_version_ = 0;
+  mutable DistanceCacheMap distance_cache_;
+  mutable std::mutex distance_cache_lock_;
+
 private:
   void initialize();
   void notifyObjectChange(const ObjectConstPtr& obj, World::Action action);
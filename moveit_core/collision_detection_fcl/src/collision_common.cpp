@@ -37,6 +37,7 @@
 #include <moveit/collision_detection_fcl/collision_common.h>
 #include <geometric_shapes/shapes.h>
 #include <moveit/collision_detection_fcl/fcl_compat.h>
+#include <moveit/profiler/profiler.h>
 
 #if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
 #include <fcl/geometry/bvh/BVH_model.h>
@@ -48,6 +49,7 @@
 #endif
 
 #include <boost/thread/mutex.hpp>
+#include <cstdint>
 #include <memory>
 
 namespace collision_detection
@@ -64,6 +66,37 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
   if (cd1->sameObject(*cd2))
     return false;
 
+  // coarse occupancy prefilter for octomap objects: the octomap's own AABB spans the whole
+  // map, so nearly every pair involving it survives the broadphase; skip the (expensive)
+  // octree traversal when the other object misses every coarse occupied region of the map
+  if (cdata->octomap_coarse_boxes_ && !cdata->octomap_coarse_boxes_->empty())
+  {
+    const fcl::CollisionObjectd* other = nullptr;
+    OctomapCoarseBoxMap::const_iterator boxes = cdata->octomap_coarse_boxes_->find(o1->collisionGeometry().get());
+    if (boxes != cdata->octomap_coarse_boxes_->end())
+      other = o2;
+    else
+    {
+      boxes = cdata->octomap_coarse_boxes_->find(o2->collisionGeometry().get());
+      if (boxes != cdata->octomap_coarse_boxes_->end())
+        other = o1;
+    }
+    if (other)
+    {
+      const auto& aabb = other->getAABB();
+      bool overlap = false;
+      for (const OctomapCoarseBox& box : boxes->second)
+        if (aabb.min_[0] <= box[3] && box[0] <= aabb.max_[0] && aabb.min_[1] <= box[4] && box[1] <= aabb.max_[1] &&
+            aabb.min_[2] <= box[5] && box[2] <= aabb.max_[2])
+        {
+          overlap = true;
+          break;
+        }
+      if (!overlap)
+        return false;
+    }
+  }
+
   // If active components are specified
   if (cdata->active_components_only_)
   {
@@ -151,13 +184,19 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
     ROS_DEBUG_NAMED("collision_detection.fcl", "Actually checking collisions between %s and %s", cd1->getID().c_str(),
                     cd2->getID().c_str());
 
+  // this pair made it past all the filters and will be narrowphase-tested below
+  if (moveit::tools::Profiler::Running())
+    moveit::tools::Profiler::Event("CollisionFCL.narrowphasePair");
+
   // see if we need to compute a contact
   std::size_t want_contact_count = 0;
   if (cdata->req_->contacts)
     if (cdata->res_->contact_count < cdata->req_->max_contacts)
     {
       std::size_t have;
-      if (cd1->getID() < cd2->getID())
+      if (cdata->res_->flatContactsEnabled())
+        have = cdata->res_->flatContactCount(cd1->getID(), cd2->getID());
+      else if (cd1->getID() < cd2->getID())
       {
         std::pair<std::string, std::string> cp(cd1->getID(), cd2->getID());
         have = cdata->res_->contacts.find(cp) != cdata->res_->contacts.end() ? cdata->res_->contacts[cp].size() : 0;
@@ -203,7 +242,10 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
           if (want_contact_count > 0)
           {
             --want_contact_count;
-            cdata->res_->contacts[pc].push_back(c);
+            if (cdata->res_->flatContactsEnabled())
+              cdata->res_->addFlatContact(c);
+            else
+              cdata->res_->contacts[pc].push_back(c);
             cdata->res_->contact_count++;
             if (cdata->req_->verbose)
               ROS_INFO_NAMED("collision_detection.fcl",
@@ -277,7 +319,10 @@ bool collisionCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, voi
         {
           Contact c;
           fcl2contact(col_result.getContact(i), c);
-          cdata->res_->contacts[pc].push_back(c);
+          if (cdata->res_->flatContactsEnabled())
+            cdata->res_->addFlatContact(c);
+          else
+            cdata->res_->contacts[pc].push_back(c);
           cdata->res_->contact_count++;
         }
       }
@@ -395,6 +440,50 @@ struct FCLShapeCache
   boost::mutex lock_;
 };
 
+/* Built BVH models for mesh shapes, keyed by a hash of the mesh content. The shape cache above is
+   keyed by shape instance, so an identical mesh arriving as a new Shape instance (e.g. the same
+   object re-published through scene diffs) misses it and would trigger a fresh BVH construction.
+   Copying an already built model only duplicates its arrays, which is much cheaper than refitting
+   the hierarchy for large meshes. Entries are weak pointers; the models stay alive as long as some
+   FCLGeometry still uses them. */
+template <typename BV>
+struct MeshBVHCache
+{
+  MeshBVHCache() : clean_count_(0)
+  {
+  }
+
+  std::map<std::uint64_t, std::weak_ptr<const fcl::BVHModel<BV>>> map_;
+  unsigned int clean_count_;
+  boost::mutex lock_;
+};
+
+template <typename BV>
+MeshBVHCache<BV>& getMeshBVHCache()
+{
+  static MeshBVHCache<BV> cache;
+  return cache;
+}
+
+/* FNV-1a hash over the mesh vertex and triangle buffers */
+std::uint64_t hashMeshContent(const shapes::Mesh* mesh)
+{
+  std::uint64_t h = 0xcbf29ce484222325ULL;
+  auto mix = [&h](const void* data, std::size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      h ^= bytes[i];
+      h *= 0x100000001b3ULL;
+    }
+  };
+  mix(&mesh->vertex_count, sizeof(mesh->vertex_count));
+  mix(&mesh->triangle_count, sizeof(mesh->triangle_count));
+  mix(mesh->vertices, 3 * mesh->vertex_count * sizeof(double));
+  mix(mesh->triangles, 3 * mesh->triangle_count * sizeof(unsigned int));
+  return h;
+}
+
 bool distanceCallback(fcl::CollisionObjectd* o1, fcl::CollisionObjectd* o2, void* data, double& min_dist)
 {
   DistanceData* cdata = reinterpret_cast<DistanceData*>(data);
@@ -762,6 +851,8 @@ FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape,
   }
 
   fcl::CollisionGeometryd* cg_g = nullptr;
+  std::uint64_t mesh_hash = 0;
+  bool new_mesh_model = false;
   if (shape->type == shapes::PLANE)  // shapes that directly produce CollisionGeometry
   {
     // handle cases individually
@@ -808,24 +899,42 @@ FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape,
       break;
       case shapes::MESH:
       {
-        auto g = new fcl::BVHModel<BV>();
         const shapes::Mesh* mesh = static_cast<const shapes::Mesh*>(shape.get());
         if (mesh->vertex_count > 0 && mesh->triangle_count > 0)
         {
-          std::vector<fcl::Triangle> tri_indices(mesh->triangle_count);
-          for (unsigned int i = 0; i < mesh->triangle_count; ++i)
-            tri_indices[i] =
-                fcl::Triangle(mesh->triangles[3 * i], mesh->triangles[3 * i + 1], mesh->triangles[3 * i + 2]);
-
-          std::vector<fcl::Vector3d> points(mesh->vertex_count);
-          for (unsigned int i = 0; i < mesh->vertex_count; ++i)
-            points[i] = fcl::Vector3d(mesh->vertices[3 * i], mesh->vertices[3 * i + 1], mesh->vertices[3 * i + 2]);
-
-          g->beginModel();
-          g->addSubModel(points, tri_indices);
-          g->endModel();
+          // identical mesh content may already have a built model in the content-hashed cache
+          mesh_hash = hashMeshContent(mesh);
+          MeshBVHCache<BV>& mesh_cache = getMeshBVHCache<BV>();
+          std::shared_ptr<const fcl::BVHModel<BV>> cached_model;
+          {
+            boost::mutex::scoped_lock slock(mesh_cache.lock_);
+            auto cache_it = mesh_cache.map_.find(mesh_hash);
+            if (cache_it != mesh_cache.map_.end())
+              cached_model = cache_it->second.lock();
+          }
+          if (cached_model)
+            cg_g = new fcl::BVHModel<BV>(*cached_model);
+          else
+          {
+            auto g = new fcl::BVHModel<BV>();
+            std::vector<fcl::Triangle> tri_indices(mesh->triangle_count);
+            for (unsigned int i = 0; i < mesh->triangle_count; ++i)
+              tri_indices[i] =
+                  fcl::Triangle(mesh->triangles[3 * i], mesh->triangles[3 * i + 1], mesh->triangles[3 * i + 2]);
+
+            std::vector<fcl::Vector3d> points(mesh->vertex_count);
+            for (unsigned int i = 0; i < mesh->vertex_count; ++i)
+              points[i] = fcl::Vector3d(mesh->vertices[3 * i], mesh->vertices[3 * i + 1], mesh->vertices[3 * i + 2]);
+
+            g->beginModel();
+            g->addSubModel(points, tri_indices);
+            g->endModel();
+            cg_g = g;
+            new_mesh_model = true;
+          }
         }
-        cg_g = g;
+        else
+          cg_g = new fcl::BVHModel<BV>();
       }
       break;
       case shapes::OCTREE:
@@ -844,6 +953,23 @@ FCLGeometryConstPtr createCollisionGeometry(const shapes::ShapeConstPtr& shape,
   {
     cg_g->computeLocalAABB();
     FCLGeometryConstPtr res(new FCLGeometry(cg_g, data, shape_index));
+    if (new_mesh_model)
+    {
+      // publish the built model for reuse by identical meshes; it stays alive through the
+      // shared pointer held by the FCLGeometry we just created
+      MeshBVHCache<BV>& mesh_cache = getMeshBVHCache<BV>();
+      boost::mutex::scoped_lock slock(mesh_cache.lock_);
+      mesh_cache.map_[mesh_hash] = std::static_pointer_cast<const fcl::BVHModel<BV>>(res->collision_geometry_);
+      if (++mesh_cache.clean_count_ > FCLShapeCache::MAX_CLEAN_COUNT)
+      {
+        mesh_cache.clean_count_ = 0;
+        for (auto it = mesh_cache.map_.begin(); it != mesh_cache.map_.end();)
+          if (it->second.expired())
+            it = mesh_cache.map_.erase(it);
+          else
+            ++it;
+      }
+    }
     boost::mutex::scoped_lock slock(cache.lock_);
     cache.map_[wptr] = res;
     cache.bumpUseCount();
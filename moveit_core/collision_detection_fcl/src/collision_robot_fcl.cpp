@@ -77,6 +77,9 @@ CollisionRobotFCL::CollisionRobotFCL(const CollisionRobotFCL& other) : Collision
 {
   geoms_ = other.geoms_;
   fcl_objs_ = other.fcl_objs_;
+  // the persistent broadphase itself is not shared; each copy refits its own manager
+  use_persistent_broadphase_ = other.use_persistent_broadphase_;
+  self_collision_certificate_cache_ = other.self_collision_certificate_cache_;
 }
 
 void CollisionRobotFCL::getAttachedBodyObjects(const robot_state::AttachedBody* ab,
@@ -129,6 +132,83 @@ void CollisionRobotFCL::constructFCLObject(const robot_state::RobotState& state,
   }
 }
 
+void CollisionRobotFCL::setSelfCollisionCertificateCache(const SelfCollisionCertificateCacheConstPtr& cache)
+{
+  self_collision_certificate_cache_ = cache;
+}
+
+void CollisionRobotFCL::setPersistentBroadphase(bool flag)
+{
+  std::lock_guard<std::mutex> guard(persistent_lock_);
+  use_persistent_broadphase_ = flag;
+  if (!flag)
+  {
+    persistent_manager_.reset();
+    persistent_object_.clear();
+    persistent_attached_object_.clear();
+  }
+}
+
+void CollisionRobotFCL::updatePersistentBroadPhase(const robot_state::RobotState& state) const
+{
+  fcl::Transform3d fcl_tf;
+  if (!persistent_manager_)
+  {
+    persistent_manager_.reset(new fcl::DynamicAABBTreeCollisionManagerd());
+    persistent_object_.clear();
+    for (std::size_t i = 0; i < geoms_.size(); ++i)
+      if (geoms_[i] && geoms_[i]->collision_geometry_)
+      {
+        transform2fcl(state.getCollisionBodyTransform(geoms_[i]->collision_geometry_data_->ptr.link,
+                                                      geoms_[i]->collision_geometry_data_->shape_index),
+                      fcl_tf);
+        auto coll_obj = new fcl::CollisionObjectd(*fcl_objs_[i]);
+        coll_obj->setTransform(fcl_tf);
+        coll_obj->computeAABB();
+        persistent_object_.collision_objects_.push_back(FCLCollisionObjectPtr(coll_obj));
+      }
+    persistent_object_.registerTo(persistent_manager_.get());
+  }
+  else
+  {
+    // move the registered objects in place and refit the tree; successive planner states
+    // differ little, so this is much cheaper than re-registering everything
+    std::size_t obj_index = 0;
+    for (std::size_t i = 0; i < geoms_.size(); ++i)
+      if (geoms_[i] && geoms_[i]->collision_geometry_)
+      {
+        transform2fcl(state.getCollisionBodyTransform(geoms_[i]->collision_geometry_data_->ptr.link,
+                                                      geoms_[i]->collision_geometry_data_->shape_index),
+                      fcl_tf);
+        fcl::CollisionObjectd* coll_obj = persistent_object_.collision_objects_[obj_index++].get();
+        coll_obj->setTransform(fcl_tf);
+        coll_obj->computeAABB();
+      }
+    persistent_manager_->update();
+  }
+
+  // attached bodies may change between queries, so they are re-registered every time
+  persistent_attached_object_.unregisterFrom(persistent_manager_.get());
+  persistent_attached_object_.clear();
+  std::vector<const robot_state::AttachedBody*> ab;
+  state.getAttachedBodies(ab);
+  for (auto& body : ab)
+  {
+    std::vector<FCLGeometryConstPtr> objs;
+    getAttachedBodyObjects(body, objs);
+    const EigenSTL::vector_Isometry3d& ab_t = body->getGlobalCollisionBodyTransforms();
+    for (std::size_t k = 0; k < objs.size(); ++k)
+      if (objs[k]->collision_geometry_)
+      {
+        transform2fcl(ab_t[k], fcl_tf);
+        persistent_attached_object_.collision_objects_.push_back(
+            FCLCollisionObjectPtr(new fcl::CollisionObjectd(objs[k]->collision_geometry_, fcl_tf)));
+        persistent_attached_object_.collision_geometry_.push_back(objs[k]);
+      }
+  }
+  persistent_attached_object_.registerTo(persistent_manager_.get());
+}
+
 void CollisionRobotFCL::allocSelfCollisionBroadPhase(const robot_state::RobotState& state, FCLManager& manager) const
 {
   auto m = new fcl::DynamicAABBTreeCollisionManagerd();
@@ -170,11 +250,30 @@ void CollisionRobotFCL::checkSelfCollisionHelper(const CollisionRequest& req, Co
                                                  const robot_state::RobotState& state,
                                                  const AllowedCollisionMatrix* acm) const
 {
-  FCLManager manager;
-  allocSelfCollisionBroadPhase(state, manager);
-  CollisionData cd(&req, &res, acm);
-  cd.enableGroup(getRobotModel());
-  manager.manager_->collide(&cd, &collisionCallback);
+  // a boolean query whose state lies within a certified clearance ball of a
+  // known self-collision-free posture cannot be in self collision, so the
+  // narrowphase check can be skipped
+  if (self_collision_certificate_cache_ && !req.contacts && !req.distance && !req.cost &&
+      req.group_name == self_collision_certificate_cache_->getGroupName() &&
+      self_collision_certificate_cache_->isCertifiedFree(state))
+    return;
+
+  if (use_persistent_broadphase_)
+  {
+    std::lock_guard<std::mutex> guard(persistent_lock_);
+    updatePersistentBroadPhase(state);
+    CollisionData cd(&req, &res, acm);
+    cd.enableGroup(getRobotModel());
+    persistent_manager_->collide(&cd, &collisionCallback);
+  }
+  else
+  {
+    FCLManager manager;
+    allocSelfCollisionBroadPhase(state, manager);
+    CollisionData cd(&req, &res, acm);
+    cd.enableGroup(getRobotModel());
+    manager.manager_->collide(&cd, &collisionCallback);
+  }
   if (req.distance)
   {
     DistanceRequest dreq;
@@ -276,6 +375,12 @@ void CollisionRobotFCL::updatedPaddingOrScaling(const std::vector<std::string>&
     else
       ROS_ERROR_NAMED("collision_detection.fcl", "Updating padding or scaling for unknown link: '%s'", link.c_str());
   }
+
+  // the persistent broadphase references the old geometry; force a rebuild on the next query
+  std::lock_guard<std::mutex> guard(persistent_lock_);
+  persistent_manager_.reset();
+  persistent_object_.clear();
+  persistent_attached_object_.clear();
 }
 
 void CollisionRobotFCL::distanceSelf(const DistanceRequest& req, DistanceResult& res,
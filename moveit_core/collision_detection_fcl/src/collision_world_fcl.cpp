@@ -37,20 +37,27 @@
 #include <moveit/collision_detection_fcl/collision_world_fcl.h>
 #include <moveit/collision_detection_fcl/collision_detector_allocator_fcl.h>
 #include <moveit/collision_detection_fcl/fcl_compat.h>
+#include <geometric_shapes/shapes.h>
+#include <octomap/octomap.h>
 
 #if (MOVEIT_FCL_VERSION >= FCL_VERSION_CHECK(0, 6, 0))
 #include <fcl/geometry/geometric_shape_to_BVH_model.h>
 #include <fcl/narrowphase/detail/traversal/collision/bvh_collision_traversal_node.h>
 #include <fcl/narrowphase/detail/traversal/collision_node.h>
 #include <fcl/broadphase/broadphase_dynamic_AABB_tree.h>
+#include <fcl/narrowphase/continuous_collision.h>
 #else
 #include <fcl/shape/geometric_shape_to_BVH_model.h>
 #include <fcl/traversal/traversal_node_bvhs.h>
 #include <fcl/traversal/traversal_node_setup.h>
 #include <fcl/collision_node.h>
+#include <fcl/continuous_collision.h>
 #endif
 
 #include <boost/bind.hpp>
+#include <atomic>
+#include <limits>
+#include <thread>
 
 namespace collision_detection
 {
@@ -89,6 +96,11 @@ CollisionWorldFCL::CollisionWorldFCL(const CollisionWorldFCL& other, const World
     fcl_obj.second.registerTo(manager_.get());
   // manager_->update();
 
+  // the copied FCL objects share their geometries with the source world, so the coarse
+  // occupied boxes keyed on those geometries stay valid
+  octomap_coarse_boxes_ = other.octomap_coarse_boxes_;
+  octomap_geometry_by_id_ = other.octomap_geometry_by_id_;
+
   // request notifications about changes to new world
   observer_handle_ = getWorld()->addObserver(boost::bind(&CollisionWorldFCL::notifyObjectChange, this, _1, _2));
 }
@@ -115,7 +127,7 @@ void CollisionWorldFCL::checkRobotCollision(const CollisionRequest& req, Collisi
                                             const CollisionRobot& robot, const robot_state::RobotState& state1,
                                             const robot_state::RobotState& state2) const
 {
-  ROS_ERROR_NAMED("collision_detection.fcl", "FCL continuous collision checking not yet implemented");
+  checkRobotCollisionHelperCCD(req, res, robot, state1, state2, nullptr);
 }
 
 void CollisionWorldFCL::checkRobotCollision(const CollisionRequest& req, CollisionResult& res,
@@ -123,7 +135,162 @@ void CollisionWorldFCL::checkRobotCollision(const CollisionRequest& req, Collisi
                                             const robot_state::RobotState& state2,
                                             const AllowedCollisionMatrix& acm) const
 {
-  ROS_ERROR_NAMED("collision_detection.fcl", "FCL continuous collision checking not yet implemented");
+  checkRobotCollisionHelperCCD(req, res, robot, state1, state2, &acm);
+}
+
+void CollisionWorldFCL::checkRobotCollisionHelperCCD(const CollisionRequest& req, CollisionResult& res,
+                                                     const CollisionRobot& robot,
+                                                     const robot_state::RobotState& state1,
+                                                     const robot_state::RobotState& state2,
+                                                     const AllowedCollisionMatrix* acm) const
+{
+  const CollisionRobotFCL& robot_fcl = dynamic_cast<const CollisionRobotFCL&>(robot);
+
+  // per-object begin poses come from state1; the objects built from state2 supply the end poses
+  FCLObject fcl_obj_beg, fcl_obj_end;
+  robot_fcl.constructFCLObject(state1, fcl_obj_beg);
+  robot_fcl.constructFCLObject(state2, fcl_obj_end);
+  if (fcl_obj_beg.collision_objects_.size() != fcl_obj_end.collision_objects_.size())
+  {
+    ROS_ERROR_NAMED("collision_detection.fcl", "Robot collision geometry differs between the two states; "
+                                               "continuous collision checking requires matching attached bodies");
+    return;
+  }
+
+  // collect the static world objects once; the broadphase managers do not support swept queries
+  std::vector<const fcl::CollisionObjectd*> world_objects;
+  for (const std::pair<const std::string, FCLObject>& fcl_obj : fcl_objs_)
+    for (const FCLCollisionObjectConstPtr& collision_object : fcl_obj.second.collision_objects_)
+      world_objects.push_back(collision_object.get());
+
+  const std::size_t n_robot_objects = fcl_obj_beg.collision_objects_.size();
+  if (n_robot_objects == 0 || world_objects.empty())
+    return;
+
+  fcl::ContinuousCollisionRequestd ccd_req;
+  ccd_req.ccd_motion_type = fcl::CCDM_LINEAR;
+  ccd_req.ccd_solver_type = fcl::CCDC_CONSERVATIVE_ADVANCEMENT;
+
+  std::size_t n_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  if (n_threads > n_robot_objects)
+    n_threads = n_robot_objects;
+
+  std::atomic<bool> collision_found(false);
+  auto check_range = [&](std::size_t lo, std::size_t hi) {
+    for (std::size_t i = lo; i < hi && !collision_found.load(std::memory_order_relaxed); ++i)
+    {
+      const fcl::CollisionObjectd* robot_object = fcl_obj_beg.collision_objects_[i].get();
+      const fcl::Transform3d& robot_tf_end = fcl_obj_end.collision_objects_[i]->getTransform();
+      const CollisionGeometryData* cd1 =
+          static_cast<const CollisionGeometryData*>(robot_object->collisionGeometry()->getUserData());
+      for (const fcl::CollisionObjectd* world_object : world_objects)
+      {
+        if (collision_found.load(std::memory_order_relaxed))
+          break;
+        const CollisionGeometryData* cd2 =
+            static_cast<const CollisionGeometryData*>(world_object->collisionGeometry()->getUserData());
+        if (acm)
+        {
+          AllowedCollision::Type type;
+          if (acm->getAllowedCollision(cd1->getID(), cd2->getID(), type) && type == AllowedCollision::ALWAYS)
+            continue;
+        }
+        fcl::ContinuousCollisionResultd ccd_res;
+        fcl::continuousCollide(robot_object, robot_tf_end, world_object, world_object->getTransform(), ccd_req,
+                               ccd_res);
+        if (ccd_res.is_collide)
+        {
+          if (req.verbose)
+            ROS_INFO_NAMED("collision_detection.fcl", "Swept collision between '%s' and '%s' at motion time %f",
+                           cd1->getID().c_str(), cd2->getID().c_str(), ccd_res.time_of_contact);
+          collision_found.store(true, std::memory_order_relaxed);
+          break;
+        }
+      }
+    }
+  };
+
+  if (n_threads == 1)
+    check_range(0, n_robot_objects);
+  else
+  {
+    std::vector<std::thread> workers;
+    workers.reserve(n_threads);
+    for (std::size_t t = 0; t < n_threads; ++t)
+      workers.emplace_back(check_range, t * n_robot_objects / n_threads, (t + 1) * n_robot_objects / n_threads);
+    for (std::thread& worker : workers)
+      worker.join();
+  }
+
+  if (collision_found.load())
+    res.collision = true;
+}
+
+std::size_t CollisionWorldFCL::checkRobotCollisionBatch(const CollisionRequest& req,
+                                                        std::vector<CollisionResult>& results,
+                                                        const CollisionRobot& robot,
+                                                        const std::vector<const robot_state::RobotState*>& states,
+                                                        const AllowedCollisionMatrix& acm,
+                                                        bool stop_at_first_collision) const
+{
+  const CollisionRobotFCL& robot_fcl = dynamic_cast<const CollisionRobotFCL&>(robot);
+  results.resize(states.size());
+
+  // The set of per-link collision objects is the same for every state; construct it once and only
+  // update the transforms between states. Attached bodies can differ per state, so whenever a state
+  // carries attached bodies we fall back to a full construction for that state.
+  FCLObject fcl_obj;
+  bool flat_valid = false;
+  fcl::Transform3d fcl_tf;
+
+  std::size_t first_collision = states.size();
+  for (std::size_t s = 0; s < states.size(); ++s)
+  {
+    const robot_state::RobotState& state = *states[s];
+    std::vector<const robot_state::AttachedBody*> ab;
+    state.getAttachedBodies(ab);
+    if (!ab.empty())
+    {
+      fcl_obj.clear();
+      robot_fcl.constructFCLObject(state, fcl_obj);
+      flat_valid = false;
+    }
+    else if (!flat_valid)
+    {
+      fcl_obj.clear();
+      robot_fcl.constructFCLObject(state, fcl_obj);
+      flat_valid = true;
+    }
+    else
+    {
+      std::size_t pos = 0;
+      for (std::size_t i = 0; i < robot_fcl.geoms_.size(); ++i)
+        if (robot_fcl.geoms_[i] && robot_fcl.geoms_[i]->collision_geometry_)
+        {
+          transform2fcl(state.getCollisionBodyTransform(robot_fcl.geoms_[i]->collision_geometry_data_->ptr.link,
+                                                        robot_fcl.geoms_[i]->collision_geometry_data_->shape_index),
+                        fcl_tf);
+          fcl_obj.collision_objects_[pos]->setTransform(fcl_tf);
+          fcl_obj.collision_objects_[pos]->computeAABB();
+          ++pos;
+        }
+    }
+
+    results[s].clear();
+    CollisionData cd(&req, &results[s], &acm);
+    cd.enableGroup(robot.getRobotModel());
+    for (std::size_t i = 0; !cd.done_ && i < fcl_obj.collision_objects_.size(); ++i)
+      manager_->collide(fcl_obj.collision_objects_[i].get(), &cd, &collisionCallback);
+
+    if (results[s].collision)
+    {
+      if (first_collision == states.size())
+        first_collision = s;
+      if (stop_at_first_collision)
+        break;
+    }
+  }
+  return first_collision;
 }
 
 void CollisionWorldFCL::checkRobotCollisionHelper(const CollisionRequest& req, CollisionResult& res,
@@ -136,6 +303,8 @@ void CollisionWorldFCL::checkRobotCollisionHelper(const CollisionRequest& req, C
 
   CollisionData cd(&req, &res, acm);
   cd.enableGroup(robot.getRobotModel());
+  if (!octomap_coarse_boxes_.empty())
+    cd.octomap_coarse_boxes_ = &octomap_coarse_boxes_;
   for (std::size_t i = 0; !cd.done_ && i < fcl_obj.collision_objects_.size(); ++i)
     manager_->collide(fcl_obj.collision_objects_[i].get(), &cd, &collisionCallback);
 
@@ -152,6 +321,61 @@ void CollisionWorldFCL::checkRobotCollisionHelper(const CollisionRequest& req, C
   }
 }
 
+void CollisionWorldFCL::checkRobotCollisionAtTime(const CollisionRequest& req, CollisionResult& res,
+                                                  const CollisionRobot& robot, const robot_state::RobotState& state,
+                                                  const AllowedCollisionMatrix& acm, double time) const
+{
+  const CollisionRobotFCL& robot_fcl = dynamic_cast<const CollisionRobotFCL&>(robot);
+  FCLObject fcl_obj;
+  robot_fcl.constructFCLObject(state, fcl_obj);
+
+  // the broadphase manager holds every object at its current pose, so it cannot answer a
+  // time-parameterized query; collect the world objects explicitly, rebuilding those with a
+  // pose track at the pose the track gives for the requested time
+  FCLObject moved_objects;
+  std::vector<fcl::CollisionObjectd*> world_objects;
+  for (const std::pair<const std::string, FCLObject>& fcl_obj_entry : fcl_objs_)
+  {
+    auto world_it = getWorld()->find(fcl_obj_entry.first);
+    const World::Object* obj = world_it != getWorld()->end() ? world_it->second.get() : nullptr;
+    if (obj && !obj->pose_track_times_.empty())
+    {
+      const Eigen::Isometry3d delta = World::interpolatePoseTrack(*obj, time);
+      for (std::size_t i = 0; i < obj->shapes_.size(); ++i)
+      {
+        FCLGeometryConstPtr g = createCollisionGeometry(obj->shapes_[i], obj);
+        if (g)
+        {
+          auto co = new fcl::CollisionObjectd(g->collision_geometry_, transform2fcl(delta * obj->shape_poses_[i]));
+          moved_objects.collision_objects_.push_back(FCLCollisionObjectPtr(co));
+          moved_objects.collision_geometry_.push_back(g);
+          world_objects.push_back(co);
+        }
+      }
+    }
+    else
+      for (const FCLCollisionObjectPtr& collision_object : fcl_obj_entry.second.collision_objects_)
+        world_objects.push_back(collision_object.get());
+  }
+
+  CollisionData cd(&req, &res, &acm);
+  cd.enableGroup(robot.getRobotModel());
+  if (!octomap_coarse_boxes_.empty())
+    cd.octomap_coarse_boxes_ = &octomap_coarse_boxes_;
+  for (std::size_t i = 0; !cd.done_ && i < fcl_obj.collision_objects_.size(); ++i)
+  {
+    fcl::CollisionObjectd* robot_object = fcl_obj.collision_objects_[i].get();
+    for (fcl::CollisionObjectd* world_object : world_objects)
+    {
+      if (cd.done_)
+        break;
+      // replicate the AABB culling the broadphase manager would do
+      if (robot_object->getAABB().overlap(world_object->getAABB()))
+        collisionCallback(robot_object, world_object, &cd);
+    }
+  }
+}
+
 void CollisionWorldFCL::checkWorldCollision(const CollisionRequest& req, CollisionResult& res,
                                             const CollisionWorld& other_world) const
 {
@@ -207,6 +431,7 @@ void CollisionWorldFCL::updateFCLObject(const std::string& id)
     jt->second.unregisterFrom(manager_.get());
     jt->second.clear();
   }
+  clearOctomapCoarseBoxes(id);
 
   // check to see if we have this object
   auto it = getWorld()->find(id);
@@ -223,6 +448,7 @@ void CollisionWorldFCL::updateFCLObject(const std::string& id)
       constructFCLObject(it->second.get(), fcl_objs_[id]);
       fcl_objs_[id].registerTo(manager_.get());
     }
+    rebuildOctomapCoarseBoxes(it->second.get());
   }
   else
   {
@@ -233,6 +459,82 @@ void CollisionWorldFCL::updateFCLObject(const std::string& id)
   // manager_->update();
 }
 
+void CollisionWorldFCL::rebuildOctomapCoarseBoxes(const World::Object* obj)
+{
+  for (std::size_t i = 0; i < obj->shapes_.size(); ++i)
+  {
+    if (obj->shapes_[i]->type != shapes::OCTOMAP)
+      continue;
+    // the geometry cache returns the same geometry constructFCLObject() stored, so the
+    // boxes end up keyed on the pointer collisionCallback() will see
+    FCLGeometryConstPtr g = createCollisionGeometry(obj->shapes_[i], obj);
+    if (!g || !g->collision_geometry_)
+      continue;
+    const std::shared_ptr<const octomap::OcTree>& tree =
+        static_cast<const shapes::OcTree*>(obj->shapes_[i].get())->octree;
+    std::vector<OctomapCoarseBox>& boxes = octomap_coarse_boxes_[g->collision_geometry_.get()];
+    octomap_geometry_by_id_[obj->id_].push_back(g->collision_geometry_.get());
+    boxes.clear();
+    if (!tree)
+      continue;
+
+    // four levels above the leaves: each box covers a 16^3-leaf block, coarse enough to
+    // keep the list short and fine enough to separate links from unoccupied space
+    const unsigned int coarse_depth = tree->getTreeDepth() > 4 ? tree->getTreeDepth() - 4 : 1;
+    const Eigen::Isometry3d& pose = obj->shape_poses_[i];
+    for (octomap::OcTree::leaf_iterator leaf = tree->begin_leafs(coarse_depth), end = tree->end_leafs(); leaf != end;
+         ++leaf)
+    {
+      if (!tree->isNodeOccupied(*leaf))
+        continue;
+      const double half = leaf.getSize() / 2.0;
+      const octomap::point3d center = leaf.getCoordinate();
+      Eigen::Vector3d bmin = Eigen::Vector3d::Constant(std::numeric_limits<double>::infinity());
+      Eigen::Vector3d bmax = -bmin;
+      for (int corner = 0; corner < 8; ++corner)
+      {
+        const Eigen::Vector3d p = pose * Eigen::Vector3d(center.x() + ((corner & 1) ? half : -half),
+                                                         center.y() + ((corner & 2) ? half : -half),
+                                                         center.z() + ((corner & 4) ? half : -half));
+        bmin = bmin.cwiseMin(p);
+        bmax = bmax.cwiseMax(p);
+      }
+      boxes.push_back({ { bmin.x(), bmin.y(), bmin.z(), bmax.x(), bmax.y(), bmax.z() } });
+    }
+  }
+}
+
+void CollisionWorldFCL::clearOctomapCoarseBoxes(const std::string& id)
+{
+  auto it = octomap_geometry_by_id_.find(id);
+  if (it == octomap_geometry_by_id_.end())
+    return;
+  for (const fcl::CollisionGeometryd* geometry : it->second)
+    octomap_coarse_boxes_.erase(geometry);
+  octomap_geometry_by_id_.erase(it);
+}
+
+bool CollisionWorldFCL::moveFCLObject(const World::Object* obj)
+{
+  auto it = fcl_objs_.find(obj->id_);
+  if (it == fcl_objs_.end())
+    return false;
+
+  FCLObject& fcl_obj = it->second;
+  // constructFCLObject() creates one collision object per shape; a size mismatch means some
+  // geometry failed to convert, so let the caller rebuild from scratch
+  if (fcl_obj.collision_objects_.size() != obj->shapes_.size())
+    return false;
+
+  for (std::size_t i = 0; i < obj->shapes_.size(); ++i)
+  {
+    fcl_obj.collision_objects_[i]->setTransform(transform2fcl(obj->shape_poses_[i]));
+    fcl_obj.collision_objects_[i]->computeAABB();
+    manager_->update(fcl_obj.collision_objects_[i].get());
+  }
+  return true;
+}
+
 void CollisionWorldFCL::setWorld(const WorldPtr& world)
 {
   if (world == getWorld())
@@ -244,7 +546,10 @@ void CollisionWorldFCL::setWorld(const WorldPtr& world)
   // clear out objects from old world
   manager_->clear();
   fcl_objs_.clear();
+  octomap_coarse_boxes_.clear();
+  octomap_geometry_by_id_.clear();
   cleanCollisionGeometryCache();
+  ++world_version_;
 
   CollisionWorld::setWorld(world);
 
@@ -255,8 +560,19 @@ void CollisionWorldFCL::setWorld(const WorldPtr& world)
   getWorld()->notifyObserverAllObjects(observer_handle_, World::CREATE);
 }
 
+void CollisionWorldFCL::setDistanceCacheEnabled(bool flag)
+{
+  std::lock_guard<std::mutex> guard(distance_cache_lock_);
+  use_distance_cache_ = flag;
+  if (!flag)
+    distance_cache_.clear();
+}
+
 void CollisionWorldFCL::notifyObjectChange(const ObjectConstPtr& obj, World::Action action)
 {
+  // any world change invalidates cached distance results
+  ++world_version_;
+
   if (action == World::DESTROY)
   {
     auto it = fcl_objs_.find(obj->id_);
@@ -266,8 +582,20 @@ void CollisionWorldFCL::notifyObjectChange(const ObjectConstPtr& obj, World::Act
       it->second.clear();
       fcl_objs_.erase(it);
     }
+    clearOctomapCoarseBoxes(obj->id_);
     cleanCollisionGeometryCache();
   }
+  else if (action == World::MOVE_SHAPE && moveFCLObject(obj.get()))
+  {
+    // moved-only objects keep their FCL objects and refit the broadphase entries in place,
+    // avoiding the unregister/reconstruct/register churn of a full update
+    if (octomap_geometry_by_id_.count(obj->id_))
+    {
+      // the coarse boxes are stored in the world frame, so a moved octomap needs them refit
+      clearOctomapCoarseBoxes(obj->id_);
+      rebuildOctomapCoarseBoxes(obj.get());
+    }
+  }
   else
   {
     updateFCLObject(obj->id_);
@@ -283,6 +611,66 @@ void CollisionWorldFCL::distanceRobot(const DistanceRequest& req, DistanceResult
   FCLObject fcl_obj;
   robot_fcl.constructFCLObject(state, fcl_obj);
 
+  if (use_distance_cache_ && req.type == DistanceRequestType::GLOBAL && !req.enable_nearest_points)
+  {
+    std::lock_guard<std::mutex> guard(distance_cache_lock_);
+
+    // per-link bodies come first in the FCL object, in geoms_ order
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < robot_fcl.geoms_.size(); ++i)
+    {
+      if (!robot_fcl.geoms_[i] || !robot_fcl.geoms_[i]->collision_geometry_)
+        continue;
+      const CollisionGeometryData* cgd = robot_fcl.geoms_[i]->collision_geometry_data_.get();
+      const Eigen::Isometry3d& tf = state.getCollisionBodyTransform(cgd->ptr.link, cgd->shape_index);
+      const std::pair<std::string, int> key(cgd->getID(), cgd->shape_index);
+
+      bool skip = false;
+      auto cache_it = distance_cache_.find(key);
+      if (cache_it != distance_cache_.end() && cache_it->second.world_version == world_version_)
+      {
+        // bound how far any point of the body can have moved since the cached query: translation
+        // plus rotation angle times the radius of the geometry's bounding sphere
+        const DistanceCacheEntry& entry = cache_it->second;
+        const double radius = robot_fcl.geoms_[i]->collision_geometry_->aabb_radius;
+        const double displacement =
+            (tf.translation() - entry.tf.translation()).norm() +
+            Eigen::AngleAxisd(tf.rotation().transpose() * entry.tf.rotation()).angle() * radius;
+        const double lower_bound = entry.distance - displacement;
+        if (lower_bound > req.distance_threshold)
+        {
+          // the body cannot have come within the threshold; report the conservative bound
+          if (lower_bound < res.minimum_distance.distance)
+            res.minimum_distance.distance = lower_bound;
+          skip = true;
+        }
+      }
+      if (!skip)
+      {
+        DistanceResult body_res;
+        DistanceData body_drd(&req, &body_res);
+        manager_->distance(fcl_obj.collision_objects_[pos].get(), &body_drd, &distanceCallback);
+
+        DistanceCacheEntry& entry = distance_cache_[key];
+        entry.tf = tf;
+        entry.distance = body_res.minimum_distance.distance;
+        entry.world_version = world_version_;
+
+        if (body_res.collision)
+          res.collision = true;
+        if (body_res.minimum_distance.distance < res.minimum_distance.distance)
+          res.minimum_distance = body_res.minimum_distance;
+      }
+      ++pos;
+    }
+
+    // attached body objects follow the link bodies; their geometry changes too often to cache
+    DistanceData drd(&req, &res);
+    for (std::size_t i = pos; !drd.done && i < fcl_obj.collision_objects_.size(); ++i)
+      manager_->distance(fcl_obj.collision_objects_[i].get(), &drd, &distanceCallback);
+    return;
+  }
+
   DistanceData drd(&req, &res);
   for (std::size_t i = 0; !drd.done && i < fcl_obj.collision_objects_.size(); ++i)
     manager_->distance(fcl_obj.collision_objects_[i].get(), &drd, &distanceCallback);
@@ -38,7 +38,9 @@
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/collision_detection_fcl/collision_world_fcl.h>
 #include <moveit/collision_detection_fcl/collision_robot_fcl.h>
+#include <moveit/collision_detection/self_collision_certificate_cache.h>
 #include <moveit/utils/robot_model_test_utils.h>
+#include <random_numbers/random_numbers.h>
 
 #include <urdf_parser/urdf_parser.h>
 #include <geometric_shapes/shape_operations.h>
@@ -543,6 +545,50 @@ TEST_F(FclCollisionDetectionTester, TestChangingShapeSize)
   }
 }
 
+TEST_F(FclCollisionDetectionTester, SelfCollisionCertificateCache)
+{
+  auto cache = std::make_shared<collision_detection::SelfCollisionCertificateCache>(robot_model_, "right_arm");
+  cache->train(*crobot_, *acm_, 50);
+
+  robot_state::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.update();
+
+  collision_detection::CollisionRequest req;
+  req.group_name = "right_arm";
+  collision_detection::CollisionResult res;
+  crobot_->checkSelfCollision(req, res, robot_state, *acm_);
+  ASSERT_FALSE(res.collision);
+
+  // the default state was just checked free; a certificate for it must cover it
+  cache->addCertificate(robot_state, 0.05);
+  EXPECT_TRUE(cache->isCertifiedFree(robot_state));
+
+  // every state the cache certifies must also pass the full self check
+  // performed with the same allowed collision matrix
+  random_numbers::RandomNumberGenerator rng(42);
+  const robot_model::JointModelGroup* jmg = robot_model_->getJointModelGroup("right_arm");
+  for (unsigned int i = 0; i < 100; i++)
+  {
+    robot_state.setToRandomPositions(jmg, rng);
+    robot_state.update();
+    if (!cache->isCertifiedFree(robot_state))
+      continue;
+    collision_detection::CollisionResult sampled_res;
+    crobot_->checkSelfCollision(req, sampled_res, robot_state, *acm_);
+    EXPECT_FALSE(sampled_res.collision);
+  }
+
+  // a checker with the cache installed still reports certified states as free
+  DefaultCRobotType crobot_cached(dynamic_cast<DefaultCRobotType&>(*crobot_));
+  crobot_cached.setSelfCollisionCertificateCache(cache);
+  robot_state.setToDefaultValues();
+  robot_state.update();
+  collision_detection::CollisionResult cached_res;
+  crobot_cached.checkSelfCollision(req, cached_res, robot_state, *acm_);
+  EXPECT_FALSE(cached_res.collision);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -216,6 +216,22 @@ bool getCollisionSphereCollision(const distance_field::DistanceField* distance_f
                                  const EigenSTL::vector_Vector3d& sphere_centers, double maximum_value,
                                  double tolerance, unsigned int num_coll, std::vector<unsigned int>& colls);
 
+/** Scalar type used for the bulk relative-frame storage of body decompositions (sphere centers
+    and interior collision points). Defining MOVEIT_COLLISION_FLOAT32 at build time (see the
+    option in moveit_core) narrows this storage to single precision, roughly halving the memory
+    of the shared decomposition cache. Poses are still applied in double precision, only the
+    storage is narrowed, so the error is bounded by the float mantissa (below a micrometer at
+    workspace scale) and is negligible next to the decomposition resolution. Since the flag
+    changes types in this public header, it must be set consistently for every package that
+    includes it. */
+#ifdef MOVEIT_COLLISION_FLOAT32
+typedef float DecompositionScalar;
+#else
+typedef double DecompositionScalar;
+#endif
+typedef Eigen::Matrix<DecompositionScalar, 3, 1> DecompositionPoint;
+typedef std::vector<DecompositionPoint, Eigen::aligned_allocator<DecompositionPoint>> DecompositionPointVector;
+
 // forward declaration required for friending apparently
 class BodyDecompositionVector;
 
@@ -242,6 +258,9 @@ public:
     // new_collision_spheres.size() << std::endl;
     collision_spheres_ = new_collision_spheres;
     relative_cylinder_pose_ = new_relative_cylinder_pose;
+    relative_sphere_centers_.resize(collision_spheres_.size());
+    for (unsigned int i = 0; i < collision_spheres_.size(); i++)
+      relative_sphere_centers_[i] = collision_spheres_[i].relative_vec_.cast<DecompositionScalar>();
   }
 
   const std::vector<CollisionSphere>& getCollisionSpheres() const
@@ -249,16 +268,28 @@ public:
     return collision_spheres_;
   }
 
+  /** \brief The relative sphere centers as a contiguous array, kept in
+   *  step with \ref getCollisionSpheres so posed decompositions can
+   *  transform all centers in one batched matrix product. */
+  const DecompositionPointVector& getRelativeSphereCenters() const
+  {
+    return relative_sphere_centers_;
+  }
+
   const std::vector<double>& getSphereRadii() const
   {
     return sphere_radii_;
   }
 
-  const EigenSTL::vector_Vector3d& getCollisionPoints() const
+  const DecompositionPointVector& getCollisionPoints() const
   {
     return relative_collision_points_;
   }
 
+  /** \brief Copy the relative collision points into \e points in double precision (a plain copy
+   *  when the storage scalar is double) */
+  void getCollisionPoints(EigenSTL::vector_Vector3d& points) const;
+
   const bodies::Body* getBody(unsigned int i) const
   {
     return bodies_.getBody(i);
@@ -289,9 +320,17 @@ protected:
   bodies::BoundingSphere relative_bounding_sphere_;
   std::vector<double> sphere_radii_;
   std::vector<CollisionSphere> collision_spheres_;
-  EigenSTL::vector_Vector3d relative_collision_points_;
+  DecompositionPointVector relative_sphere_centers_;
+  DecompositionPointVector relative_collision_points_;
 };
 
+/** The posed decomposition keeps two levels: the bounding sphere is
+ *  transformed eagerly on every \ref updatePose, while the full sphere
+ *  set and the collision points are only transformed when they are
+ *  first queried for the current pose.  Checks that reject a body pair
+ *  on the bounding spheres therefore never pay for posing the
+ *  fine-grained spheres.  Refinement mutates cached state, so the
+ *  first query for a new pose must come from a single thread. */
 class PosedBodySphereDecomposition
 {
 public:
@@ -306,11 +345,15 @@ public:
 
   const EigenSTL::vector_Vector3d& getSphereCenters() const
   {
+    if (sphere_centers_dirty_)
+      refineSphereCenters();
     return sphere_centers_;
   }
 
   const EigenSTL::vector_Vector3d& getCollisionPoints() const
   {
+    if (collision_points_dirty_)
+      refineCollisionPoints();
     return posed_collision_points_;
   }
 
@@ -328,15 +371,25 @@ public:
     return body_decomposition_->getRelativeBoundingSphere().radius;
   }
 
-  // assumed to be in reference frame, updates the pose of the body,
-  // the collision spheres, and the posed collision points
+  // assumed to be in reference frame; poses the bounding sphere and
+  // marks the collision spheres and collision points for lazy refinement
   void updatePose(const Eigen::Isometry3d& linkTransform);
 
 protected:
+  /** \brief Applies the stored pose to all relative sphere centers in
+   *  one batched matrix product */
+  void refineSphereCenters() const;
+
+  /** \brief Applies the stored pose to the relative collision points */
+  void refineCollisionPoints() const;
+
   BodyDecompositionConstPtr body_decomposition_;
+  Eigen::Isometry3d pose_;
   Eigen::Vector3d posed_bounding_sphere_center_;
-  EigenSTL::vector_Vector3d posed_collision_points_;
-  EigenSTL::vector_Vector3d sphere_centers_;
+  mutable EigenSTL::vector_Vector3d posed_collision_points_;
+  mutable EigenSTL::vector_Vector3d sphere_centers_;
+  mutable bool sphere_centers_dirty_;
+  mutable bool collision_points_dirty_;
 };
 
 class PosedBodyPointDecomposition
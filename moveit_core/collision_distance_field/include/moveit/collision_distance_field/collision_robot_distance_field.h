@@ -43,6 +43,7 @@
 #include <moveit/collision_distance_field/collision_common_distance_field.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 namespace collision_detection
 {
@@ -260,6 +261,17 @@ protected:
   std::map<std::string, std::map<std::string, bool>> in_group_update_map_;
   std::map<std::string, GroupStateRepresentationPtr> pregenerated_group_state_representation_map_;
 
+  /** group state representations handed out by earlier checks, kept per
+   * thread and per group so that a caller who does not thread its own
+   * GroupStateRepresentation through repeated checks still reuses the posed
+   * decompositions instead of copying them from the pregenerated template on
+   * every call.  A cached representation is only reused while its
+   * DistanceFieldCacheEntry is still the current one; the lock only guards
+   * the map structure, each representation itself is thread-private. */
+  mutable boost::mutex gsr_cache_lock_;
+  mutable std::map<boost::thread::id, std::map<std::string, GroupStateRepresentationPtr>>
+      group_state_representation_cache_;
+
   planning_scene::PlanningScenePtr planning_scene_;
 };
 }
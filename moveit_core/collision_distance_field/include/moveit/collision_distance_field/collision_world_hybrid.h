@@ -65,6 +65,12 @@ public:
   {
   }
 
+  /** \brief Checks self, intra-group and environment collisions against the
+   *  distance fields in a single pass, updating the group state
+   *  representation (the sphere transform pass) only once.  Prefer this over
+   *  pairing CollisionRobotHybrid::checkSelfCollisionDistanceField with
+   *  checkRobotCollisionDistanceField, which pays for the transform pass
+   *  twice. */
   void checkCollisionDistanceField(const CollisionRequest& req, CollisionResult& res, const CollisionRobot& robot,
                                    const robot_state::RobotState& state) const;
 
@@ -137,16 +137,26 @@ bool collision_detection::getCollisionSphereGradients(const distance_field::Dist
 {
   // assumes gradient is properly initialized
 
+  // evaluate the distance field for all sphere centers in one batch; this lets the
+  // field hoist its per-query setup out of the loop and vectorize the lookups
+  std::size_t num_spheres = sphere_list.size();
+  std::vector<double> distances(num_spheres);
+  std::vector<double> gradients_x(num_spheres);
+  std::vector<double> gradients_y(num_spheres);
+  std::vector<double> gradients_z(num_spheres);
+  std::vector<unsigned char> bounds(num_spheres);
+  distance_field->getDistancesAndGradients(sphere_centers.data(), num_spheres, distances.data(), gradients_x.data(),
+                                           gradients_y.data(), gradients_z.data(), bounds.data());
+
   bool in_collision = false;
   for (unsigned int i = 0; i < sphere_list.size(); i++)
   {
-    Eigen::Vector3d p = sphere_centers[i];
-    Eigen::Vector3d grad;
-    bool in_bounds;
-    double dist = distance_field->getDistanceGradient(p.x(), p.y(), p.z(), grad.x(), grad.y(), grad.z(), in_bounds);
-    if (!in_bounds && grad.norm() > EPSILON)
+    Eigen::Vector3d grad(gradients_x[i], gradients_y[i], gradients_z[i]);
+    double dist = distances[i];
+    if (!bounds[i] && grad.norm() > EPSILON)
     {
-      ROS_DEBUG("Collision sphere point is out of bounds %lf, %lf, %lf", p.x(), p.y(), p.z());
+      ROS_DEBUG("Collision sphere point is out of bounds %lf, %lf, %lf", sphere_centers[i].x(), sphere_centers[i].y(),
+                sphere_centers[i].z());
       return true;
     }
 
@@ -298,14 +308,17 @@ void collision_detection::BodyDecomposition::init(const std::vector<shapes::Shap
     collision_spheres_.insert(collision_spheres_.end(), body_spheres.begin(), body_spheres.end());
 
     distance_field::findInternalPointsConvex(*bodies_.getBody(i), resolution, body_collision_points);
-    relative_collision_points_.insert(relative_collision_points_.end(), body_collision_points.begin(),
-                                      body_collision_points.end());
+    relative_collision_points_.reserve(relative_collision_points_.size() + body_collision_points.size());
+    for (unsigned int j = 0; j < body_collision_points.size(); j++)
+      relative_collision_points_.push_back(body_collision_points[j].cast<DecompositionScalar>());
   }
 
   sphere_radii_.resize(collision_spheres_.size());
+  relative_sphere_centers_.resize(collision_spheres_.size());
   for (unsigned int i = 0; i < collision_spheres_.size(); i++)
   {
     sphere_radii_[i] = collision_spheres_[i].radius_;
+    relative_sphere_centers_[i] = collision_spheres_[i].relative_vec_.cast<DecompositionScalar>();
   }
 
   // computing bounding sphere
@@ -325,11 +338,18 @@ collision_detection::BodyDecomposition::~BodyDecomposition()
   bodies_.clear();
 }
 
+void collision_detection::BodyDecomposition::getCollisionPoints(EigenSTL::vector_Vector3d& points) const
+{
+  points.resize(relative_collision_points_.size());
+  for (unsigned int i = 0; i < relative_collision_points_.size(); i++)
+    points[i] = relative_collision_points_[i].cast<double>();
+}
+
 collision_detection::PosedBodyPointDecomposition::PosedBodyPointDecomposition(
     const BodyDecompositionConstPtr& body_decomposition)
   : body_decomposition_(body_decomposition)
 {
-  posed_collision_points_ = body_decomposition_->getCollisionPoints();
+  body_decomposition_->getCollisionPoints(posed_collision_points_);
 }
 
 collision_detection::PosedBodyPointDecomposition::PosedBodyPointDecomposition(
@@ -356,11 +376,12 @@ void collision_detection::PosedBodyPointDecomposition::updatePose(const Eigen::I
 {
   if (body_decomposition_)
   {
-    posed_collision_points_.resize(body_decomposition_->getCollisionPoints().size());
+    const DecompositionPointVector& relative_points = body_decomposition_->getCollisionPoints();
+    posed_collision_points_.resize(relative_points.size());
 
-    for (unsigned int i = 0; i < body_decomposition_->getCollisionPoints().size(); i++)
+    for (unsigned int i = 0; i < relative_points.size(); i++)
     {
-      posed_collision_points_[i] = trans * body_decomposition_->getCollisionPoints()[i];
+      posed_collision_points_[i] = trans * relative_points[i].cast<double>();
     }
   }
 }
@@ -376,22 +397,46 @@ collision_detection::PosedBodySphereDecomposition::PosedBodySphereDecomposition(
 
 void collision_detection::PosedBodySphereDecomposition::updatePose(const Eigen::Isometry3d& trans)
 {
-  // updating sphere centers
+  // only the coarse level is posed here; the fine-grained spheres and the
+  // collision points are refined when a check actually gets past the
+  // bounding sphere and asks for them
+  pose_ = trans;
   posed_bounding_sphere_center_ = trans * body_decomposition_->getRelativeBoundingSphere().center;
-  for (unsigned int i = 0; i < body_decomposition_->getCollisionSpheres().size(); i++)
+  sphere_centers_dirty_ = true;
+  collision_points_dirty_ = !body_decomposition_->getCollisionPoints().empty();
+}
+
+void collision_detection::PosedBodySphereDecomposition::refineSphereCenters() const
+{
+  const DecompositionPointVector& relative_centers = body_decomposition_->getRelativeSphereCenters();
+  sphere_centers_.resize(relative_centers.size());
+  if (!relative_centers.empty())
   {
-    sphere_centers_[i] = trans * body_decomposition_->getCollisionSpheres()[i].relative_vec_;
+    // the centers are contiguous, so all of them rotate in one matrix product; the product runs in
+    // double precision regardless of the storage scalar
+    Eigen::Map<const Eigen::Matrix<DecompositionScalar, 3, Eigen::Dynamic>> relative(relative_centers[0].data(), 3,
+                                                                                     relative_centers.size());
+    Eigen::Map<Eigen::Matrix<double, 3, Eigen::Dynamic>> posed(sphere_centers_[0].data(), 3, sphere_centers_.size());
+    posed.noalias() = pose_.linear() * relative.cast<double>();
+    posed.colwise() += pose_.translation();
   }
+  sphere_centers_dirty_ = false;
+}
 
-  // updating collision points
-  if (!body_decomposition_->getCollisionPoints().empty())
+void collision_detection::PosedBodySphereDecomposition::refineCollisionPoints() const
+{
+  const DecompositionPointVector& relative_points = body_decomposition_->getCollisionPoints();
+  posed_collision_points_.resize(relative_points.size());
+  if (!relative_points.empty())
   {
-    posed_collision_points_.resize(body_decomposition_->getCollisionPoints().size());
-    for (unsigned int i = 0; i < body_decomposition_->getCollisionPoints().size(); i++)
-    {
-      posed_collision_points_[i] = trans * body_decomposition_->getCollisionPoints()[i];
-    }
+    Eigen::Map<const Eigen::Matrix<DecompositionScalar, 3, Eigen::Dynamic>> relative(relative_points[0].data(), 3,
+                                                                                     relative_points.size());
+    Eigen::Map<Eigen::Matrix<double, 3, Eigen::Dynamic>> posed(posed_collision_points_[0].data(), 3,
+                                                               posed_collision_points_.size());
+    posed.noalias() = pose_.linear() * relative.cast<double>();
+    posed.colwise() += pose_.translation();
   }
+  collision_points_dirty_ = false;
 }
 
 bool collision_detection::doBoundingSpheresIntersect(const PosedBodySphereDecompositionConstPtr& p1,
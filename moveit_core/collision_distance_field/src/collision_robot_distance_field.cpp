@@ -46,6 +46,11 @@ namespace collision_detection
 {
 const double EPSILON = 0.001f;
 
+// Minimum number of bodies in a group state before the per-body sphere checks
+// are spread across OpenMP threads; below this the serial loop is cheaper than
+// starting a parallel region
+const int MIN_PARALLEL_CHECK_BODIES = 8;
+
 CollisionRobotDistanceField::CollisionRobotDistanceField(const robot_model::RobotModelConstPtr& robot_model)
   : CollisionRobot(robot_model)
 {
@@ -148,7 +153,34 @@ void CollisionRobotDistanceField::generateCollisionCheckingStructures(
     (const_cast<CollisionRobotDistanceField*>(this))->distance_field_cache_entry_ = new_dfce;
     dfce = new_dfce;
   }
+
+  // When the caller did not bring its own representation, reuse the one this
+  // thread used for its last check of the group.  That is only valid while
+  // the cache entry it was generated against is still current -- a changed
+  // entry means different links, attached bodies or acm, so the
+  // representation is rebuilt and replaces the cached one.
+  if (!gsr)
+  {
+    boost::mutex::scoped_lock slock(gsr_cache_lock_);
+    const GroupStateRepresentationPtr& cached =
+        group_state_representation_cache_[boost::this_thread::get_id()][group_name];
+    if (cached && cached->dfce_ == dfce)
+    {
+      gsr = cached;
+    }
+  }
+  if (gsr)
+  {
+    // same refresh a caller-supplied representation gets: new link and
+    // attached body poses plus cleared gradient scratch
+    updateGroupStateRepresentationState(state, gsr);
+    return;
+  }
+
   getGroupStateRepresentation(dfce, state, gsr);
+
+  boost::mutex::scoped_lock slock(gsr_cache_lock_);
+  group_state_representation_cache_[boost::this_thread::get_id()][group_name] = gsr;
 }
 
 void CollisionRobotDistanceField::checkSelfCollisionHelper(const collision_detection::CollisionRequest& req,
@@ -250,6 +282,53 @@ bool CollisionRobotDistanceField::getSelfCollisions(const collision_detection::C
                                                     collision_detection::CollisionResult& res,
                                                     GroupStateRepresentationPtr& gsr) const
 {
+  const int num_bodies = gsr->dfce_->link_names_.size() + gsr->dfce_->attached_body_names_.size();
+
+  // Each body's spheres are checked against the shared distance field with
+  // read-only queries, so for large groups a boolean check can spread the
+  // bodies across threads.  The contact path stays serial since it appends to
+  // the result as it goes.
+  if (!req.contacts && num_bodies >= MIN_PARALLEL_CHECK_BODIES)
+  {
+    bool in_collision = false;
+#pragma omp parallel for reduction(|| : in_collision)
+    for (int i = 0; i < num_bodies; i++)
+    {
+      bool is_link = i < static_cast<int>(gsr->dfce_->link_names_.size());
+      if ((is_link && !gsr->dfce_->link_has_geometry_[i]) || !gsr->dfce_->self_collision_enabled_[i])
+        continue;
+      const std::vector<CollisionSphere>* collision_spheres_1;
+      const EigenSTL::vector_Vector3d* sphere_centers_1;
+
+      if (is_link)
+      {
+        collision_spheres_1 = &(gsr->link_body_decompositions_[i]->getCollisionSpheres());
+        sphere_centers_1 = &(gsr->link_body_decompositions_[i]->getSphereCenters());
+      }
+      else
+      {
+        collision_spheres_1 =
+            &(gsr->attached_body_decompositions_[i - gsr->dfce_->link_names_.size()]->getCollisionSpheres());
+        sphere_centers_1 =
+            &(gsr->attached_body_decompositions_[i - gsr->dfce_->link_names_.size()]->getSphereCenters());
+      }
+
+      bool coll = getCollisionSphereCollision(gsr->dfce_->distance_field_.get(), *collision_spheres_1,
+                                              *sphere_centers_1, max_propogation_distance_, collision_tolerance_);
+      if (coll && is_link)
+      {
+        ROS_DEBUG("Link %s in self collision", gsr->dfce_->link_names_[i].c_str());
+      }
+      in_collision = in_collision || coll;
+    }
+    if (in_collision)
+    {
+      res.collision = true;
+      return true;
+    }
+    return false;
+  }
+
   for (unsigned int i = 0; i < gsr->dfce_->link_names_.size() + gsr->dfce_->attached_body_names_.size(); i++)
   {
     bool is_link = i < gsr->dfce_->link_names_.size();
@@ -330,11 +409,15 @@ bool CollisionRobotDistanceField::getSelfCollisions(const collision_detection::C
 bool CollisionRobotDistanceField::getSelfProximityGradients(GroupStateRepresentationPtr& gsr) const
 {
   bool in_collision = false;
+  const int num_links = gsr->dfce_->link_names_.size();
 
-  for (unsigned int i = 0; i < gsr->dfce_->link_names_.size(); i++)
+// Each link reads the other links' posed distance fields and writes only its
+// own gradient entry, so the links can be processed independently
+#pragma omp parallel for reduction(|| : in_collision) if (num_links >= MIN_PARALLEL_CHECK_BODIES)
+  for (int i = 0; i < num_links; i++)
   {
     const std::string& link_name = gsr->dfce_->link_names_[i];
-    bool is_link = i < gsr->dfce_->link_names_.size();
+    bool is_link = i < num_links;
     if ((is_link && !gsr->dfce_->link_has_geometry_[i]) || !gsr->dfce_->self_collision_enabled_[i])
     {
       continue;
@@ -1180,9 +1263,11 @@ void CollisionRobotDistanceField::getGroupStateRepresentation(const DistanceFiel
 
         gsr->link_distance_fields_.push_back(PosedDistanceFieldPtr(new PosedDistanceField(
             link_size, link_origin, resolution_, max_propogation_distance_, use_signed_distance_field_)));
-        gsr->link_distance_fields_.back()->addPointsToField(link_bd->getCollisionPoints());
+        EigenSTL::vector_Vector3d link_points;
+        link_bd->getCollisionPoints(link_points);
+        gsr->link_distance_fields_.back()->addPointsToField(link_points);
         ROS_DEBUG_STREAM("Created PosedDistanceField for link " << dfce->link_names_[i] << " with "
-                                                                << link_bd->getCollisionPoints().size() << " points");
+                                                                << link_points.size() << " points");
 
         gsr->link_body_decompositions_.back()->updatePose(state.getFrameTransform(ls->getName()));
         gsr->link_distance_fields_.back()->updatePose(state.getFrameTransform(ls->getName()));
@@ -43,6 +43,11 @@
 
 namespace collision_detection
 {
+// Minimum number of bodies in a group state before the per-body sphere checks
+// are spread across OpenMP threads; below this the serial loop is cheaper than
+// starting a parallel region
+const int MIN_PARALLEL_CHECK_BODIES = 8;
+
 CollisionWorldDistanceField::~CollisionWorldDistanceField()
 {
   getWorld()->removeObserver(observer_handle_);
@@ -329,6 +334,49 @@ bool CollisionWorldDistanceField::getEnvironmentCollisions(
     const CollisionRequest& req, CollisionResult& res, const distance_field::DistanceFieldConstPtr& env_distance_field,
     GroupStateRepresentationPtr& gsr) const
 {
+  const int num_bodies = gsr->dfce_->link_names_.size() + gsr->dfce_->attached_body_names_.size();
+
+  // For large groups a boolean check only issues read-only queries against the
+  // environment distance field, so the bodies can be checked across threads;
+  // the contact path stays serial since it appends to the result as it goes
+  if (!req.contacts && num_bodies >= MIN_PARALLEL_CHECK_BODIES)
+  {
+    bool in_collision = false;
+#pragma omp parallel for reduction(|| : in_collision)
+    for (int i = 0; i < num_bodies; i++)
+    {
+      bool is_link = i < static_cast<int>(gsr->dfce_->link_names_.size());
+      if (is_link && !gsr->dfce_->link_has_geometry_[i])
+        continue;
+
+      const std::vector<CollisionSphere>* collision_spheres_1;
+      const EigenSTL::vector_Vector3d* sphere_centers_1;
+
+      if (is_link)
+      {
+        collision_spheres_1 = &(gsr->link_body_decompositions_[i]->getCollisionSpheres());
+        sphere_centers_1 = &(gsr->link_body_decompositions_[i]->getSphereCenters());
+      }
+      else
+      {
+        collision_spheres_1 =
+            &(gsr->attached_body_decompositions_[i - gsr->dfce_->link_names_.size()]->getCollisionSpheres());
+        sphere_centers_1 =
+            &(gsr->attached_body_decompositions_[i - gsr->dfce_->link_names_.size()]->getSphereCenters());
+      }
+
+      bool coll = getCollisionSphereCollision(env_distance_field.get(), *collision_spheres_1, *sphere_centers_1,
+                                              max_propogation_distance_, collision_tolerance_);
+      in_collision = in_collision || coll;
+    }
+    if (in_collision)
+    {
+      res.collision = true;
+      return true;
+    }
+    return false;
+  }
+
   for (unsigned int i = 0; i < gsr->dfce_->link_names_.size() + gsr->dfce_->attached_body_names_.size(); i++)
   {
     bool is_link = i < gsr->dfce_->link_names_.size();
@@ -413,9 +461,14 @@ bool CollisionWorldDistanceField::getEnvironmentProximityGradients(
     const distance_field::DistanceFieldConstPtr& env_distance_field, GroupStateRepresentationPtr& gsr) const
 {
   bool in_collision = false;
-  for (unsigned int i = 0; i < gsr->dfce_->link_names_.size(); i++)
+  const int num_links = gsr->dfce_->link_names_.size();
+
+// Each link only reads the environment distance field and writes its own
+// gradient entry, so the links can be processed independently
+#pragma omp parallel for reduction(|| : in_collision) if (num_links >= MIN_PARALLEL_CHECK_BODIES)
+  for (int i = 0; i < num_links; i++)
   {
-    bool is_link = i < gsr->dfce_->link_names_.size();
+    bool is_link = i < num_links;
 
     if (is_link && !gsr->dfce_->link_has_geometry_[i])
     {
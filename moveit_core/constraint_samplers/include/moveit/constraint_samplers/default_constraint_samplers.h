@@ -38,6 +38,7 @@
 #define MOVEIT_CONSTRAINT_SAMPLERS_DEFAULT_CONSTRAINT_SAMPLERS_
 
 #include <moveit/constraint_samplers/constraint_sampler.h>
+#include <moveit/robot_state/robot_state_pool.h>
 #include <moveit/macros/class_forward.h>
 #include <random_numbers/random_numbers.h>
 
@@ -381,6 +382,34 @@ public:
     ik_timeout_ = timeout;
   }
 
+  /**
+   * \brief Gets the number of candidate poses drawn per sampling attempt
+   *
+   * @return The sample batch size
+   */
+  unsigned int getSampleBatchSize() const
+  {
+    return sample_batch_size_;
+  }
+
+  /**
+   * \brief Sets the number of candidate poses drawn per sampling attempt.
+   *
+   * When larger than one, each attempt samples this many poses from the
+   * constraint region at once, ranks them by distance to the pose the
+   * constrained link has in the reference state and runs IK on the
+   * closest candidates first, seeding the closest one with the reference
+   * state. Since every candidate already satisfies the pose constraints,
+   * this ordering tends to need fewer IK calls than sampling one pose at
+   * a time. The default of 1 keeps the one-pose-per-attempt behavior.
+   *
+   * @param batch_size The number of candidate poses per attempt; values of 0 are treated as 1
+   */
+  void setSampleBatchSize(unsigned int batch_size)
+  {
+    sample_batch_size_ = batch_size == 0 ? 1 : batch_size;
+  }
+
   /**
    * \brief Gets the position constraint associated with this sampler.
    *
@@ -524,6 +553,11 @@ protected:
   bool need_eef_to_ik_tip_transform_; /**< \brief True if the tip frame of the inverse kinematic is different than the
                                         frame of the end effector */
   Eigen::Isometry3d eef_to_ik_tip_transform_; /**< \brief Holds the transformation from end effector to IK tip frame */
+  robot_state::RobotStatePoolPtr state_pool_;  /**< \brief Pool of scratch states used when sampling poses by FK */
+  unsigned int sample_batch_size_ = 1; /**< \brief Number of candidate poses drawn per sampling attempt */
+  std::vector<double> ik_seed_;        /**< \brief Scratch buffer reused across callIK invocations */
+  std::vector<double> ik_vals_;        /**< \brief Scratch buffer reused across callIK invocations */
+  std::vector<double> ik_sol_;         /**< \brief Scratch buffer reused across callIK invocations */
 };
 }
 
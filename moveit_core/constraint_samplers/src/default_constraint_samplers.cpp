@@ -37,6 +37,7 @@
 #include <moveit/constraint_samplers/default_constraint_samplers.h>
 #include <set>
 #include <cassert>
+#include <algorithm>
 #include <boost/bind.hpp>
 
 namespace constraint_samplers
@@ -455,10 +456,12 @@ bool IKConstraintSampler::samplePose(Eigen::Vector3d& pos, Eigen::Quaterniond& q
   }
   else
   {
-    // do FK for rand state
-    robot_state::RobotState temp_state(ks);
-    temp_state.setToRandomPositions(jmg_);
-    pos = temp_state.getGlobalLinkTransform(sampling_pose_.orientation_constraint_->getLinkModel()).translation();
+    // do FK for rand state; use a pooled scratch state to avoid allocating state buffers per sample
+    if (!state_pool_)
+      state_pool_.reset(new robot_state::RobotStatePool(scene_->getRobotModel()));
+    robot_state::RobotStatePtr temp_state = state_pool_->getState(ks);
+    temp_state->setToRandomPositions(jmg_);
+    pos = temp_state->getGlobalLinkTransform(sampling_pose_.orientation_constraint_->getLinkModel()).translation();
   }
 
   if (sampling_pose_.orientation_constraint_)
@@ -506,6 +509,10 @@ bool IKConstraintSampler::samplePose(Eigen::Vector3d& pos, Eigen::Quaterniond& q
 
 namespace
 {
+// weight, in meters per radian, used to combine translational and angular
+// distance when ranking batched pose candidates
+const double ORIENTATION_DISTANCE_WEIGHT = 0.1;
+
 void samplingIkCallbackFnAdapter(robot_state::RobotState* state, const robot_model::JointModelGroup* jmg,
                                  const robot_state::GroupStateValidityCallbackFn& constraint,
                                  const geometry_msgs::Pose& /*unused*/, const std::vector<double>& ik_sol,
@@ -542,49 +549,98 @@ bool IKConstraintSampler::sampleHelper(robot_state::RobotState& state, const rob
     adapted_ik_validity_callback =
         boost::bind(&samplingIkCallbackFnAdapter, &state, jmg_, group_state_validity_callback_, _1, _2, _3);
 
-  for (unsigned int a = 0; a < max_attempts; ++a)
+  // in batched mode we rank candidates against the pose the constrained link has in the reference state:
+  // every candidate already satisfies the pose constraints, so the candidate closest to the seed pose is
+  // the one most likely to yield an IK solution
+  const unsigned int batch_size = std::min(std::max(sample_batch_size_, 1u), std::max(max_attempts, 1u));
+  const bool rank_candidates = batch_size > 1 && !reference_state.dirtyLinkTransforms();
+  Eigen::Isometry3d seed_tip_pose = Eigen::Isometry3d::Identity();
+  std::vector<double> seed_values;
+  if (rank_candidates)
   {
-    // sample a point in the constraint region
-    Eigen::Vector3d point;
-    Eigen::Quaterniond quat;
-    if (!samplePose(point, quat, reference_state, max_attempts))
-    {
-      if (verbose_)
-        ROS_INFO_NAMED("constraint_samplers", "IK constraint sampler was unable to produce a pose to run IK for");
-      return false;
-    }
+    const moveit::core::LinkModel* lm = sampling_pose_.position_constraint_ ?
+                                            sampling_pose_.position_constraint_->getLinkModel() :
+                                            sampling_pose_.orientation_constraint_->getLinkModel();
+    seed_tip_pose = reference_state.getGlobalLinkTransform(lm);
+    reference_state.copyJointGroupPositions(jmg_, seed_values);
+  }
+
+  EigenSTL::vector_Vector3d points(batch_size);
+  std::vector<Eigen::Quaterniond, Eigen::aligned_allocator<Eigen::Quaterniond>> quats(batch_size);
+  std::vector<std::size_t> order(batch_size);
+
+  for (unsigned int a = 0; a < max_attempts;)
+  {
+    // sample a batch of points in the constraint region
+    const unsigned int batch = std::min(batch_size, max_attempts - a);
+    for (unsigned int i = 0; i < batch; ++i)
+      if (!samplePose(points[i], quats[i], reference_state, max_attempts))
+      {
+        if (verbose_)
+          ROS_INFO_NAMED("constraint_samplers", "IK constraint sampler was unable to produce a pose to run IK for");
+        return false;
+      }
 
-    // we now have the transform we wish to perform IK for, in the planning frame
-    if (transform_ik_)
+    for (unsigned int i = 0; i < batch; ++i)
+      order[i] = i;
+    if (rank_candidates && batch > 1)
     {
-      // we need to convert this transform to the frame expected by the IK solver
-      // both the planning frame and the frame for the IK are assumed to be robot links
-      Eigen::Isometry3d ikq(Eigen::Translation3d(point) * quat);
-      ikq = reference_state.getFrameTransform(ik_frame_).inverse() * ikq;
-      point = ikq.translation();
-      quat = Eigen::Quaterniond(ikq.rotation());
+      const Eigen::Vector3d seed_position = seed_tip_pose.translation();
+      const Eigen::Quaterniond seed_orientation(seed_tip_pose.rotation());
+      std::sort(order.begin(), order.begin() + batch, [&](std::size_t u, std::size_t v) {
+        return (points[u] - seed_position).norm() +
+                   ORIENTATION_DISTANCE_WEIGHT * quats[u].angularDistance(seed_orientation) <
+               (points[v] - seed_position).norm() +
+                   ORIENTATION_DISTANCE_WEIGHT * quats[v].angularDistance(seed_orientation);
+      });
     }
 
-    if (need_eef_to_ik_tip_transform_)
+    for (unsigned int i = 0; i < batch; ++i, ++a)
     {
-      // After sampling the pose needs to be transformed to the ik chain tip
-      Eigen::Isometry3d ikq(Eigen::Translation3d(point) * quat);
-      ikq = ikq * eef_to_ik_tip_transform_;
-      point = ikq.translation();
-      quat = Eigen::Quaterniond(ikq.rotation());
-    }
+      Eigen::Vector3d point = points[order[i]];
+      Eigen::Quaterniond quat = quats[order[i]];
+
+      // we now have the transform we wish to perform IK for, in the planning frame
+      if (transform_ik_)
+      {
+        // we need to convert this transform to the frame expected by the IK solver
+        // both the planning frame and the frame for the IK are assumed to be robot links
+        Eigen::Isometry3d ikq(Eigen::Translation3d(point) * quat);
+        ikq = reference_state.getFrameTransform(ik_frame_).inverse() * ikq;
+        point = ikq.translation();
+        quat = Eigen::Quaterniond(ikq.rotation());
+      }
 
-    geometry_msgs::Pose ik_query;
-    ik_query.position.x = point.x();
-    ik_query.position.y = point.y();
-    ik_query.position.z = point.z();
-    ik_query.orientation.x = quat.x();
-    ik_query.orientation.y = quat.y();
-    ik_query.orientation.z = quat.z();
-    ik_query.orientation.w = quat.w();
-
-    if (callIK(ik_query, adapted_ik_validity_callback, ik_timeout_, state, project && a == 0))
-      return true;
+      if (need_eef_to_ik_tip_transform_)
+      {
+        // After sampling the pose needs to be transformed to the ik chain tip
+        Eigen::Isometry3d ikq(Eigen::Translation3d(point) * quat);
+        ikq = ikq * eef_to_ik_tip_transform_;
+        point = ikq.translation();
+        quat = Eigen::Quaterniond(ikq.rotation());
+      }
+
+      geometry_msgs::Pose ik_query;
+      ik_query.position.x = point.x();
+      ik_query.position.y = point.y();
+      ik_query.position.z = point.z();
+      ik_query.orientation.x = quat.x();
+      ik_query.orientation.y = quat.y();
+      ik_query.orientation.z = quat.z();
+      ik_query.orientation.w = quat.w();
+
+      bool use_as_seed = project && a == 0;
+      if (!use_as_seed && rank_candidates && i == 0)
+      {
+        // seed the most promising candidate of each batch with the reference state; the remaining
+        // candidates keep random seeds so repeated calls still produce diverse samples
+        state.setJointGroupPositions(jmg_, seed_values);
+        use_as_seed = true;
+      }
+
+      if (callIK(ik_query, adapted_ik_validity_callback, ik_timeout_, state, use_as_seed))
+        return true;
+    }
   }
   return false;
 }
@@ -608,31 +664,31 @@ bool IKConstraintSampler::callIK(const geometry_msgs::Pose& ik_query,
                                  double timeout, robot_state::RobotState& state, bool use_as_seed)
 {
   const std::vector<unsigned int>& ik_joint_bijection = jmg_->getKinematicsSolverJointBijection();
-  std::vector<double> seed(ik_joint_bijection.size(), 0.0);
-  std::vector<double> vals;
+  ik_seed_.resize(ik_joint_bijection.size());
 
   if (use_as_seed)
-    state.copyJointGroupPositions(jmg_, vals);
+    state.copyJointGroupPositions(jmg_, ik_vals_);
   else
     // sample a seed value
-    jmg_->getVariableRandomPositions(random_number_generator_, vals);
+    jmg_->getVariableRandomPositions(random_number_generator_, ik_vals_);
 
-  assert(vals.size() == ik_joint_bijection.size());
+  assert(ik_vals_.size() == ik_joint_bijection.size());
   for (std::size_t i = 0; i < ik_joint_bijection.size(); ++i)
-    seed[i] = vals[ik_joint_bijection[i]];
+    ik_seed_[i] = ik_vals_[ik_joint_bijection[i]];
 
-  std::vector<double> ik_sol;
+  ik_sol_.clear();
   moveit_msgs::MoveItErrorCodes error;
 
   if (adapted_ik_validity_callback ?
-          kb_->searchPositionIK(ik_query, seed, timeout, ik_sol, adapted_ik_validity_callback, error) :
-          kb_->searchPositionIK(ik_query, seed, timeout, ik_sol, error))
+          kb_->searchPositionIK(ik_query, ik_seed_, timeout, ik_sol_, adapted_ik_validity_callback, error) :
+          kb_->searchPositionIK(ik_query, ik_seed_, timeout, ik_sol_, error))
   {
-    assert(ik_sol.size() == ik_joint_bijection.size());
-    std::vector<double> solution(ik_joint_bijection.size());
+    assert(ik_sol_.size() == ik_joint_bijection.size());
+    // reuse the scratch buffer to hold the solution in group variable order
+    ik_vals_.resize(ik_joint_bijection.size());
     for (std::size_t i = 0; i < ik_joint_bijection.size(); ++i)
-      solution[ik_joint_bijection[i]] = ik_sol[i];
-    state.setJointGroupPositions(jmg_, solution);
+      ik_vals_[ik_joint_bijection[i]] = ik_sol_[i];
+    state.setJointGroupPositions(jmg_, ik_vals_);
 
     return validate(state);
   }
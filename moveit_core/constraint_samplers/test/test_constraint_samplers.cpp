@@ -434,6 +434,18 @@ TEST_F(LoadPlanningModelsPr2, IKConstraintsSamplerValid)
     EXPECT_TRUE(iks3.sample(ks, ks_const, 100));
     EXPECT_TRUE(oc.decide(ks).satisfied);
   }
+
+  // batched candidate generation must produce samples that satisfy the same constraints
+  constraint_samplers::IKConstraintSampler iks4(ps_, "left_arm");
+  EXPECT_TRUE(iks4.configure(constraint_samplers::IKSamplingPose(pc, oc)));
+  iks4.setSampleBatchSize(8);
+  EXPECT_EQ(8u, iks4.getSampleBatchSize());
+  for (int t = 0; t < 100; ++t)
+  {
+    EXPECT_TRUE(iks4.sample(ks, ks_const, 100));
+    EXPECT_TRUE(pc.decide(ks).satisfied);
+    EXPECT_TRUE(oc.decide(ks).satisfied);
+  }
 }
 
 TEST_F(LoadPlanningModelsPr2, UnionConstraintSampler)
@@ -41,6 +41,7 @@
 #include <string>
 #include <moveit_msgs/RobotTrajectory.h>
 #include <moveit/macros/class_forward.h>
+#include <boost/function.hpp>
 
 /// Namespace for the base class of a MoveIt! controller manager
 namespace moveit_controller_manager
@@ -129,6 +130,37 @@ public:
    * there is no execution in progress, this function is a no-op and returns true. */
   virtual bool cancelExecution() = 0;
 
+  /** \brief Change the speed of the trajectory this controller is currently executing, by re-timing its remaining
+   * part in flight. \e scaling is a velocity multiplier relative to the trajectory as it was passed to
+   * sendTrajectory(). Return false if the controller cannot re-time in flight (the default), in which case the
+   * caller has to stop, re-parameterize and resend. If there is no execution in progress, controllers that do
+   * support re-timing treat this as a no-op and return true. */
+  virtual bool setVelocityScaling(double /* scaling */)
+  {
+    return false;
+  }
+
+  /** \brief Signature of the callbacks registered with registerProgressCallback(). The argument is the fraction of
+   * the trajectory's time parameterization covered when the callback fired. */
+  typedef boost::function<void(double)> ProgressCallback;
+
+  /** \brief Fraction in [0, 1] of the time parameterization of the currently executed trajectory that the controller
+   * has covered, according to its feedback. Return a negative value when the controller provides no progress
+   * feedback (the default). */
+  virtual double getExecutionProgress()
+  {
+    return -1.0;
+  }
+
+  /** \brief Ask for \e callback to be fired the first time the currently executed trajectory reaches \e fraction of
+   * its time parameterization. The callback is invoked from the thread that processes controller feedback, so it
+   * fires as soon as the controller reports crossing the fraction, without polling. Registrations are cleared by the
+   * next sendTrajectory() call. Return false if the controller provides no progress feedback (the default). */
+  virtual bool registerProgressCallback(double /* fraction */, const ProgressCallback& /* callback */)
+  {
+    return false;
+  }
+
   /** \brief Wait for the current execution to complete, or until the timeout is reached. Return true if the execution
    * is complete (whether successful or not). Return false if timeout was reached. If timeout is 0 (default argument),
    * wait until the execution is complete (no timeout). */
@@ -40,6 +40,7 @@
 #include <moveit/macros/class_forward.h>
 #include <moveit/macros/deprecation.h>
 #include <moveit/distance_field/voxel_grid.h>
+#include <cstddef>
 #include <vector>
 #include <list>
 #include <visualization_msgs/Marker.h>
@@ -207,7 +208,7 @@ public:
    *
    * @param [in] octree The octree to add to the distance field
    */
-  void addOcTreeToField(const octomap::OcTree* octree);
+  virtual void addOcTreeToField(const octomap::OcTree* octree);
 
   /**
    * \brief Moves the shape in the distance field from the old pose to
@@ -324,6 +325,28 @@ public:
    */
   double getDistanceGradient(double x, double y, double z, double& gradient_x, double& gradient_y, double& gradient_z,
                              bool& in_bounds) const;
+
+  /**
+   * \brief Batched version of \ref getDistanceGradient for a
+   * contiguous array of query points, writing the results into
+   * structure-of-arrays output buffers, each of which must hold at
+   * least count entries.  The semantics per point are identical to
+   * \ref getDistanceGradient.  The default implementation simply loops
+   * over the points; derived classes may override it with an
+   * implementation that evaluates the batch more efficiently.
+   *
+   * @param [in] points The query points, in world coordinates
+   * @param [in] count The number of query points
+   * @param [out] distances The distance to the closest occupied cell for each point
+   * @param [out] gradients_x The X components of the gradients
+   * @param [out] gradients_y The Y components of the gradients
+   * @param [out] gradients_z The Z components of the gradients
+   * @param [out] in_bounds Per point, non-zero if the point is valid for gradient purposes
+   */
+  virtual void getDistancesAndGradients(const Eigen::Vector3d* points, std::size_t count, double* distances,
+                                        double* gradients_x, double* gradients_y, double* gradients_z,
+                                        unsigned char* in_bounds) const;
+
   /**
    * \brief Gets the distance to the closest obstacle at the given
    * integer cell location. The particulars of this function are
@@ -37,7 +37,7 @@
 #ifndef MOVEIT_DISTANCE_FIELD_PROPAGATION_DISTANCE_FIELD_
 #define MOVEIT_DISTANCE_FIELD_PROPAGATION_DISTANCE_FIELD_
 
-#include <moveit/distance_field/voxel_grid.h>
+#include <moveit/distance_field/sparse_voxel_grid.h>
 #include <moveit/distance_field/distance_field.h>
 #include <vector>
 #include <list>
@@ -72,7 +72,7 @@ struct compareEigen_Vector3i
 
 /**
  * \brief Structure that holds voxel information for the
- * DistanceField.  Will be used in VoxelGrid.
+ * DistanceField.  Will be used in SparseVoxelGrid.
  */
 struct PropDistanceFieldVoxel
 {
@@ -110,6 +110,12 @@ struct PropDistanceFieldVoxel
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+/** \brief The grid holding the propagation voxels.  Bricks use the
+ *  Morton in-brick layout, since the propagation sweeps read the 27
+ *  neighbors of every frontier cell and Z-order keeps those loads in
+ *  far fewer cache lines than row order; see \ref BrickLayout. */
+typedef SparseVoxelGrid<PropDistanceFieldVoxel, BRICK_LAYOUT_MORTON> PropDistanceFieldGrid;
+
 /**
  * \brief A DistanceField implementation that uses a vector
  * propagation method.  Distances propagate outward from occupied
@@ -119,7 +125,10 @@ struct PropDistanceFieldVoxel
  * this maximum distance from the nearest cell will have maximum
  * distance measurements.
  *
- * This class uses a \ref VoxelGrid to hold all data.  One important
+ * This class uses a \ref SparseVoxelGrid to hold all data, so only
+ * the bricks of the volume that have been touched by propagation
+ * consume memory; large stretches of free space at maximum distance
+ * cost nothing.  One important
  * decision that must be made on construction is whether or not to
  * create a signed version of the distance field.  If the distance
  * field is unsigned, it means that the minumum obstacle distance is
@@ -240,6 +249,21 @@ public:
    */
   void addPointsToField(const EigenSTL::vector_Vector3d& points) override;
 
+  /**
+   * \brief Adds the occupied leaves of an octree directly to the
+   * distance field, without materializing an intermediate point list.
+   *
+   * The octree leaf iterator is walked once, restricted to the extent
+   * of the field.  Each occupied leaf marks the range of grid cells
+   * covered by its depth-scaled size in a single pass, so a coarse
+   * leaf costs one range operation instead of one point per covered
+   * cell.  Distances are then propagated once for all newly occupied
+   * cells, exactly as \ref addPointsToField would.
+   *
+   * @param [in] octree The octree whose occupied leaves are added
+   */
+  void addOcTreeToField(const octomap::OcTree* octree) override;
+
   /**
    * \brief Remove a set of obstacle points from the distance field,
    * updating distance values accordingly.
@@ -327,6 +351,17 @@ public:
    */
   double getDistance(int x, int y, int z) const override;
 
+  /**
+   * \brief Batched version of \ref DistanceField::getDistanceGradient
+   * that reads the voxel grid directly, avoiding the per-point virtual
+   * calls of the generic implementation and keeping the loop simple
+   * enough for the compiler to vectorize.  See the base class for the
+   * full semantics.
+   */
+  void getDistancesAndGradients(const Eigen::Vector3d* points, std::size_t count, double* distances,
+                                double* gradients_x, double* gradients_y, double* gradients_z,
+                                unsigned char* in_bounds) const override;
+
   bool isCellValid(int x, int y, int z) const override;
   int getXNumCells() const override;
   int getYNumCells() const override;
@@ -389,7 +424,9 @@ public:
    */
   const PropDistanceFieldVoxel& getCell(int x, int y, int z) const
   {
-    return voxel_grid_->getCell(x, y, z);
+    // go through a const reference so the read does not materialize a brick
+    const PropDistanceFieldGrid& grid = *voxel_grid_;
+    return grid.getCell(x, y, z);
   }
 
   /**
@@ -412,19 +449,20 @@ public:
    */
   const PropDistanceFieldVoxel* getNearestCell(int x, int y, int z, double& dist, Eigen::Vector3i& pos) const
   {
-    const PropDistanceFieldVoxel* cell = &voxel_grid_->getCell(x, y, z);
+    const PropDistanceFieldGrid& grid = *voxel_grid_;
+    const PropDistanceFieldVoxel* cell = &grid.getCell(x, y, z);
     if (cell->distance_square_ > 0)
     {
       dist = sqrt_table_[cell->distance_square_];
       pos = cell->closest_point_;
-      const PropDistanceFieldVoxel* ncell = &voxel_grid_->getCell(pos.x(), pos.y(), pos.z());
+      const PropDistanceFieldVoxel* ncell = &grid.getCell(pos.x(), pos.y(), pos.z());
       return ncell == cell ? NULL : ncell;
     }
     if (cell->negative_distance_square_ > 0)
     {
       dist = -sqrt_table_[cell->negative_distance_square_];
       pos = cell->closest_negative_point_;
-      const PropDistanceFieldVoxel* ncell = &voxel_grid_->getCell(pos.x(), pos.y(), pos.z());
+      const PropDistanceFieldVoxel* ncell = &grid.getCell(pos.x(), pos.y(), pos.z());
       return ncell == cell ? NULL : ncell;
     }
     dist = 0.0;
@@ -488,6 +526,29 @@ private:
    */
   void propagateNegative();
 
+  /**
+   * \brief Propagates positive and negative distance in one fused
+   * sweep over the distance bands.  Both wavefronts expand band by
+   * band, so processing the positive and the negative frontier of
+   * each band back to back walks the cells around the obstacle
+   * surface once instead of sweeping the full frontier separately per
+   * sign.  Clears both bucket queues.  Requires \ref
+   * propagate_negative_.
+   */
+  void propagateBoth();
+
+  /**
+   * \brief Processes one bucket of the positive wavefront; cells
+   * pushed into higher buckets extend last_bucket.
+   */
+  void propagatePositiveBucket(int bucket, int& last_bucket);
+
+  /**
+   * \brief Processes one bucket of the negative wavefront; cells
+   * pushed into higher buckets extend last_bucket.
+   */
+  void propagateNegativeBucket(int bucket, int& last_bucket);
+
   /**
    * \brief Determines distance based on actual voxel data
    *
@@ -552,7 +613,7 @@ private:
 
   bool propagate_negative_; /**< \brief Whether or not to propagate negative distances */
 
-  VoxelGrid<PropDistanceFieldVoxel>::Ptr voxel_grid_; /**< \brief Actual container for distance data */
+  PropDistanceFieldGrid::Ptr voxel_grid_; /**< \brief Actual container for distance data */
 
   /// \brief Structure used to hold propagation frontier
   std::vector<EigenSTL::vector_Vector3i> bucket_queue_; /**< \brief Data member that holds points from which to
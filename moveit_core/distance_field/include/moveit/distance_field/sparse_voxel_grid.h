@@ -0,0 +1,577 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2009, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_DISTANCE_FIELD_SPARSE_VOXEL_GRID_
+#define MOVEIT_DISTANCE_FIELD_SPARSE_VOXEL_GRID_
+
+#include <moveit/distance_field/voxel_grid.h>
+#include <moveit/utils/memory_arena.h>
+#include <functional>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace distance_field
+{
+/**
+ * \brief In-brick cell addressing policies for \ref SparseVoxelGrid.
+ */
+enum BrickLayout
+{
+  /** \brief Cells of a brick are stored in x-major rows, as in \ref VoxelGrid */
+  BRICK_LAYOUT_LINEAR,
+  /** \brief Cells of a brick are stored along a Morton (Z-order)
+   *  curve, so cells that are close in space stay close in memory.
+   *  This keeps the scattered 27-neighbor loads of the distance
+   *  propagation sweeps within far fewer cache lines than row order. */
+  BRICK_LAYOUT_MORTON
+};
+
+/**
+ * \brief Spreads the lower bits of \e v so that bit i moves to bit
+ * 3*i, producing one component of a Morton (Z-order) code.  This is
+ * the shift-and-mask form of what the BMI2 pdep instruction computes;
+ * at brick-sized operands it compiles to a handful of ALU operations,
+ * which keeps the grid portable instead of requiring an intrinsic.
+ */
+inline std::size_t mortonSpread3(unsigned int v)
+{
+  std::size_t s = v & 0x3FF;
+  s = (s | (s << 16)) & 0x030000FF;
+  s = (s | (s << 8)) & 0x0300F00F;
+  s = (s | (s << 4)) & 0x030C30C3;
+  s = (s | (s << 2)) & 0x09249249;
+  return s;
+}
+
+/**
+ * \brief SparseVoxelGrid holds a 3D, axis-aligned set of data at a
+ * given resolution, mirroring the query interface of \ref VoxelGrid
+ * but storing the data in lazily allocated cubic bricks.
+ *
+ * Cells that have never been written are not stored at all - reading
+ * them returns the default object supplied at construction, and a
+ * brick is materialized only when one of its cells is accessed for
+ * writing.  For fields where most of the volume keeps its default
+ * value (e.g. free space at maximum distance), this reduces the
+ * memory footprint by orders of magnitude and keeps the working set
+ * of the propagation loops close to the cells that actually changed.
+ *
+ * Since some cell defaults may depend on the cell location (e.g. a
+ * cell's closest unoccupied cell being itself), a cell initializer
+ * can be registered through \ref setCellInitializer; it is invoked
+ * for every cell of a brick when the brick is materialized.
+ *
+ * The layout template parameter selects how cells are addressed
+ * within a brick; see \ref BrickLayout.  Code whose access pattern is
+ * dominated by spatial neighborhood sweeps should prefer
+ * BRICK_LAYOUT_MORTON.
+ */
+template <typename T, BrickLayout layout = BRICK_LAYOUT_LINEAR>
+class SparseVoxelGrid
+{
+public:
+  MOVEIT_DECLARE_PTR_MEMBER(SparseVoxelGrid);
+
+  /** \brief Function invoked for each cell of a newly materialized brick, after
+   *  the cell has been set to the default object */
+  typedef std::function<void(int, int, int, T&)> CellInitializer;
+
+  /**
+   * \brief Constructor for the SparseVoxelGrid.
+   *
+   * Takes the same volume parameters as \ref VoxelGrid.  All cells
+   * initially hold the default object; no brick storage is allocated
+   * until cells are written.
+   *
+   * @param [in] size_x Size of the X axis in meters
+   * @param [in] size_y Size of the Y axis in meters
+   * @param [in] size_z Size of the Z axis in meters
+   *
+   * @param [in] resolution Resolution of a single cell in meters
+   *
+   * @param [in] origin_x Minimum point along the X axis of the volume
+   * @param [in] origin_y Minimum point along the Y axis of the volume
+   * @param [in] origin_z Minimum point along the Z axis of the volume
+   *
+   * @param [in] default_object The object held by all cells that have
+   * never been written, and returned for queries that are not valid
+   *
+   * @param [in] brick_edge Edge length of a cubic brick in cells;
+   * rounded up to the next power of two
+   */
+  SparseVoxelGrid(double size_x, double size_y, double size_z, double resolution, double origin_x, double origin_y,
+                  double origin_z, T default_object, int brick_edge = 16);
+
+  /**
+   * \brief Registers the function applied to the cells of a brick
+   * when the brick is materialized; see \ref CellInitializer.  Only
+   * affects bricks materialized after the call.
+   */
+  void setCellInitializer(const CellInitializer& cell_initializer);
+
+  /**
+   * \brief Operator that gets the value of the given location (x, y,
+   * z), with the same semantics as \ref VoxelGrid::operator().
+   *
+   * @param [in] x X component of the desired location
+   * @param [in] y Y component of the desired location
+   * @param [in] z Z component of the desired location
+   *
+   * @return The data stored at that location, or the default object
+   * if the location is not valid or was never written.
+   */
+  const T& operator()(double x, double y, double z) const;
+  const T& operator()(const Eigen::Vector3d& pos) const;
+
+  /**
+   * \brief Gives the value of the given cell in the discretized voxel
+   * grid space, with the same addressing as \ref VoxelGrid::getCell.
+   *
+   * The non-const overloads materialize the brick holding the cell if
+   * necessary.  If x,y,z is invalid then corruption and/or SEGFAULTS
+   * will occur.
+   *
+   * @param [in] x The X index of the desired cell
+   * @param [in] y The Y index of the desired cell
+   * @param [in] z The Z index of the desired cell
+   *
+   * @return The data in the indicated cell
+   */
+  T& getCell(int x, int y, int z);
+  T& getCell(const Eigen::Vector3i& pos);
+  const T& getCell(int x, int y, int z) const;
+  const T& getCell(const Eigen::Vector3i& pos) const;
+
+  /**
+   * \brief Sets the value of the given cell, materializing its brick
+   * if necessary.  If the arguments do not indicate a valid cell,
+   * corruption and/or SEGFAULTS will occur.
+   *
+   * @param [in] x The X index of the desired cell
+   * @param [in] y The Y index of the desired cell
+   * @param [in] z The Z index of the desired cell
+   * @param [out] obj The data to place into the given cell
+   */
+  void setCell(int x, int y, int z, const T& obj);
+  void setCell(const Eigen::Vector3i& pos, const T& obj);
+
+  /**
+   * \brief Drops all materialized bricks and sets the default object,
+   * returning every cell to the (initializer-adjusted) default state
+   * without touching per-cell storage.
+   *
+   * @param [in] initial The new default object
+   */
+  void reset(const T& initial);
+
+  /**
+   * \brief Gets the size in arbitrary units of the indicated dimension
+   *
+   * @param [in] dim The dimension for the query
+   *
+   * @return The size in meters
+   */
+  double getSize(Dimension dim) const;
+
+  /**
+   * \brief Gets the resolution in arbitrary consistent units
+   *
+   * @return The resolution in meters
+   */
+  double getResolution() const;
+
+  /**
+   * \brief Gets the origin (miniumum point) of the indicated dimension
+   *
+   * @param [in] dim The dimension for the query
+   *
+   * @return The indicated axis origin
+   */
+  double getOrigin(Dimension dim) const;
+
+  /**
+   * \brief Gets the number of cells in the indicated dimension
+   *
+   * @param [in] dim The dimension for the query
+   *
+   * @return The number of cells for the indicated dimension
+   */
+  int getNumCells(Dimension dim) const;
+
+  /**
+   * \brief Converts from an set of integer indices to a world
+   * location given the origin and resolution parameters; no validity
+   * check, as in \ref VoxelGrid::gridToWorld.
+   *
+   * @param [in] x The integer X location
+   * @param [in] y The integer Y location
+   * @param [in] z The integer Z location
+   * @param [out] world_x The computed world X location
+   * @param [out] world_y The computed world Y location
+   * @param [out] world_z The computed world Z location
+   */
+  void gridToWorld(int x, int y, int z, double& world_x, double& world_y, double& world_z) const;
+
+  /**
+   * \brief Converts from a world location to a set of integer
+   * indices, with the same semantics as \ref VoxelGrid::worldToGrid.
+   *
+   * @param [in] world_x The world X location
+   * @param [in] world_y The world Y location
+   * @param [in] world_z The world Z location
+   * @param [out] x The computed integer X location
+   * @param [out] y The computed integer Y location
+   * @param [out] z The computed integer Z location
+   *
+   * @return True if all the world values result in integer indices
+   * that pass a validity check; otherwise False.
+   */
+  bool worldToGrid(double world_x, double world_y, double world_z, int& x, int& y, int& z) const;
+
+  /**
+   * \brief Checks if the given cell in integer coordinates is within the voxel grid
+   *
+   * @param [in] x The integer X location
+   * @param [in] y The integer Y location
+   * @param [in] z The integer Z location
+   *
+   * @return True if the cell lies within the voxel grid; otherwise False.
+   */
+  bool isCellValid(int x, int y, int z) const;
+  bool isCellValid(const Eigen::Vector3i& pos) const;
+
+  /**
+   * \brief The total number of bricks covering the grid
+   */
+  std::size_t getNumBricks() const;
+
+  /**
+   * \brief The number of bricks currently materialized; the memory
+   * footprint of the grid is proportional to this
+   */
+  std::size_t getNumAllocatedBricks() const;
+
+protected:
+  /**
+   * \brief Gets the index of the brick holding the given cell, with
+   * no validity check
+   */
+  std::size_t brickRef(int x, int y, int z) const;
+
+  /**
+   * \brief Gets the index of the given cell within its brick, with no
+   * validity check
+   */
+  std::size_t cellRef(int x, int y, int z) const;
+
+  /**
+   * \brief Allocates and initializes the brick with the given index
+   * if it is not materialized yet, and returns its cell array
+   */
+  T* materializeBrick(std::size_t brick_index, int x, int y, int z);
+
+  T default_object_;     /**< \brief The object held by all unwritten cells and returned for invalid queries */
+  double size_[3];       /**< \brief The size of each dimension in meters (in Dimension order) */
+  double resolution_;    /**< \brief The resolution of each dimension in meters */
+  double oo_resolution_; /**< \brief 1.0/resolution_ */
+  double origin_[3];     /**< \brief The origin (minumum point) of each dimension in meters (in Dimension order) */
+  double origin_minus_[3]; /**< \brief origin - 0.5*resolution */
+  int num_cells_[3];       /**< \brief The number of cells in each dimension (in Dimension order) */
+
+  int brick_shift_;     /**< \brief log2 of the brick edge length in cells */
+  int brick_mask_;      /**< \brief Bit mask extracting the in-brick coordinate of a cell index */
+  int num_bricks_[3];   /**< \brief The number of bricks in each dimension (in Dimension order) */
+  int brick_stride1_;   /**< \brief The brick index step between consecutive X bricks */
+  int brick_stride2_;   /**< \brief The brick index step between consecutive Y bricks given an X */
+  int cells_per_brick_; /**< \brief The number of cells held by one brick */
+
+  /**
+   * \brief Destroys a brick's cells and returns their block to the arena
+   */
+  struct BrickDeleter
+  {
+    BrickDeleter() : arena_(NULL), count_(0)
+    {
+    }
+    BrickDeleter(moveit::tools::MemoryArena* arena, std::size_t count) : arena_(arena), count_(count)
+    {
+    }
+    void operator()(T* cells) const
+    {
+      for (std::size_t i = 0; i < count_; ++i)
+        cells[i].~T();
+      arena_->deallocate(cells);
+    }
+    moveit::tools::MemoryArena* arena_;
+    std::size_t count_;
+  };
+
+  /** \brief Prefaulted, huge-page backed storage for the brick cell arrays.
+      Declared before bricks_ so the bricks are returned before the arena
+      releases its slabs. */
+  std::unique_ptr<moveit::tools::MemoryArena> brick_arena_;
+  /** \brief Brick cell arrays; empty entries hold the default object */
+  std::vector<std::unique_ptr<T[], BrickDeleter>> bricks_;
+  std::size_t num_allocated_bricks_; /**< \brief The number of materialized bricks */
+  CellInitializer cell_initializer_; /**< \brief Applied to each cell when its brick is materialized */
+};
+
+//////////////////////////// template function definitions follow //////////////////
+
+template <typename T, BrickLayout layout>
+SparseVoxelGrid<T, layout>::SparseVoxelGrid(double size_x, double size_y, double size_z, double resolution, double origin_x,
+                                    double origin_y, double origin_z, T default_object, int brick_edge)
+  : default_object_(default_object), num_allocated_bricks_(0)
+{
+  size_[DIM_X] = size_x;
+  size_[DIM_Y] = size_y;
+  size_[DIM_Z] = size_z;
+  origin_[DIM_X] = origin_x;
+  origin_[DIM_Y] = origin_y;
+  origin_[DIM_Z] = origin_z;
+  origin_minus_[DIM_X] = origin_x - 0.5 * resolution;
+  origin_minus_[DIM_Y] = origin_y - 0.5 * resolution;
+  origin_minus_[DIM_Z] = origin_z - 0.5 * resolution;
+  resolution_ = resolution;
+  oo_resolution_ = 1.0 / resolution_;
+
+  brick_shift_ = 0;
+  while ((1 << brick_shift_) < brick_edge)
+    brick_shift_++;
+  brick_mask_ = (1 << brick_shift_) - 1;
+  cells_per_brick_ = 1 << (3 * brick_shift_);
+
+  std::size_t total_bricks = 1;
+  for (int i = DIM_X; i <= DIM_Z; ++i)
+  {
+    num_cells_[i] = size_[i] * oo_resolution_;
+    num_bricks_[i] = (num_cells_[i] + brick_mask_) >> brick_shift_;
+    total_bricks *= num_bricks_[i];
+  }
+  brick_stride1_ = num_bricks_[DIM_Y] * num_bricks_[DIM_Z];
+  brick_stride2_ = num_bricks_[DIM_Z];
+
+  brick_arena_.reset(new moveit::tools::MemoryArena(cells_per_brick_ * sizeof(T)));
+  bricks_.resize(total_bricks);
+}
+
+template <typename T, BrickLayout layout>
+void SparseVoxelGrid<T, layout>::setCellInitializer(const CellInitializer& cell_initializer)
+{
+  cell_initializer_ = cell_initializer;
+}
+
+template <typename T, BrickLayout layout>
+inline std::size_t SparseVoxelGrid<T, layout>::brickRef(int x, int y, int z) const
+{
+  return (x >> brick_shift_) * brick_stride1_ + (y >> brick_shift_) * brick_stride2_ + (z >> brick_shift_);
+}
+
+template <typename T, BrickLayout layout>
+inline std::size_t SparseVoxelGrid<T, layout>::cellRef(int x, int y, int z) const
+{
+  if (layout == BRICK_LAYOUT_MORTON)
+    return (mortonSpread3(x & brick_mask_) << 2) | (mortonSpread3(y & brick_mask_) << 1) |
+           mortonSpread3(z & brick_mask_);
+  return ((((x & brick_mask_) << brick_shift_) + (y & brick_mask_)) << brick_shift_) + (z & brick_mask_);
+}
+
+template <typename T, BrickLayout layout>
+T* SparseVoxelGrid<T, layout>::materializeBrick(std::size_t brick_index, int x, int y, int z)
+{
+  T* cells = static_cast<T*>(brick_arena_->allocate());
+  for (int i = 0; i < cells_per_brick_; ++i)
+    new (cells + i) T();
+  bricks_[brick_index] =
+      std::unique_ptr<T[], BrickDeleter>(cells, BrickDeleter(brick_arena_.get(), cells_per_brick_));
+  num_allocated_bricks_++;
+
+  int base_x = (x >> brick_shift_) << brick_shift_;
+  int base_y = (y >> brick_shift_) << brick_shift_;
+  int base_z = (z >> brick_shift_) << brick_shift_;
+  for (int cx = 0; cx <= brick_mask_; cx++)
+  {
+    for (int cy = 0; cy <= brick_mask_; cy++)
+    {
+      for (int cz = 0; cz <= brick_mask_; cz++)
+      {
+        T& cell = cells[cellRef(cx, cy, cz)];
+        cell = default_object_;
+        if (cell_initializer_)
+          cell_initializer_(base_x + cx, base_y + cy, base_z + cz, cell);
+      }
+    }
+  }
+  return cells;
+}
+
+template <typename T, BrickLayout layout>
+inline const T& SparseVoxelGrid<T, layout>::operator()(double x, double y, double z) const
+{
+  int cell_x = int(floor((x - origin_minus_[DIM_X]) * oo_resolution_));
+  int cell_y = int(floor((y - origin_minus_[DIM_Y]) * oo_resolution_));
+  int cell_z = int(floor((z - origin_minus_[DIM_Z]) * oo_resolution_));
+  if (!isCellValid(cell_x, cell_y, cell_z))
+    return default_object_;
+  return getCell(cell_x, cell_y, cell_z);
+}
+
+template <typename T, BrickLayout layout>
+inline const T& SparseVoxelGrid<T, layout>::operator()(const Eigen::Vector3d& pos) const
+{
+  return this->operator()(pos.x(), pos.y(), pos.z());
+}
+
+template <typename T, BrickLayout layout>
+inline T& SparseVoxelGrid<T, layout>::getCell(int x, int y, int z)
+{
+  std::size_t brick_index = brickRef(x, y, z);
+  T* cells = bricks_[brick_index].get();
+  if (!cells)
+    cells = materializeBrick(brick_index, x, y, z);
+  return cells[cellRef(x, y, z)];
+}
+
+template <typename T, BrickLayout layout>
+inline T& SparseVoxelGrid<T, layout>::getCell(const Eigen::Vector3i& pos)
+{
+  return getCell(pos.x(), pos.y(), pos.z());
+}
+
+template <typename T, BrickLayout layout>
+inline const T& SparseVoxelGrid<T, layout>::getCell(int x, int y, int z) const
+{
+  const T* cells = bricks_[brickRef(x, y, z)].get();
+  if (!cells)
+    return default_object_;
+  return cells[cellRef(x, y, z)];
+}
+
+template <typename T, BrickLayout layout>
+inline const T& SparseVoxelGrid<T, layout>::getCell(const Eigen::Vector3i& pos) const
+{
+  return getCell(pos.x(), pos.y(), pos.z());
+}
+
+template <typename T, BrickLayout layout>
+inline void SparseVoxelGrid<T, layout>::setCell(int x, int y, int z, const T& obj)
+{
+  getCell(x, y, z) = obj;
+}
+
+template <typename T, BrickLayout layout>
+inline void SparseVoxelGrid<T, layout>::setCell(const Eigen::Vector3i& pos, const T& obj)
+{
+  getCell(pos.x(), pos.y(), pos.z()) = obj;
+}
+
+template <typename T, BrickLayout layout>
+void SparseVoxelGrid<T, layout>::reset(const T& initial)
+{
+  default_object_ = initial;
+  for (std::size_t i = 0; i < bricks_.size(); ++i)
+    bricks_[i].reset();
+  num_allocated_bricks_ = 0;
+}
+
+template <typename T, BrickLayout layout>
+inline double SparseVoxelGrid<T, layout>::getSize(Dimension dim) const
+{
+  return size_[dim];
+}
+
+template <typename T, BrickLayout layout>
+inline double SparseVoxelGrid<T, layout>::getResolution() const
+{
+  return resolution_;
+}
+
+template <typename T, BrickLayout layout>
+inline double SparseVoxelGrid<T, layout>::getOrigin(Dimension dim) const
+{
+  return origin_[dim];
+}
+
+template <typename T, BrickLayout layout>
+inline int SparseVoxelGrid<T, layout>::getNumCells(Dimension dim) const
+{
+  return num_cells_[dim];
+}
+
+template <typename T, BrickLayout layout>
+inline void SparseVoxelGrid<T, layout>::gridToWorld(int x, int y, int z, double& world_x, double& world_y,
+                                            double& world_z) const
+{
+  world_x = origin_[DIM_X] + resolution_ * (double(x));
+  world_y = origin_[DIM_Y] + resolution_ * (double(y));
+  world_z = origin_[DIM_Z] + resolution_ * (double(z));
+}
+
+template <typename T, BrickLayout layout>
+inline bool SparseVoxelGrid<T, layout>::worldToGrid(double world_x, double world_y, double world_z, int& x, int& y,
+                                            int& z) const
+{
+  x = int(floor((world_x - origin_minus_[DIM_X]) * oo_resolution_));
+  y = int(floor((world_y - origin_minus_[DIM_Y]) * oo_resolution_));
+  z = int(floor((world_z - origin_minus_[DIM_Z]) * oo_resolution_));
+  return isCellValid(x, y, z);
+}
+
+template <typename T, BrickLayout layout>
+inline bool SparseVoxelGrid<T, layout>::isCellValid(int x, int y, int z) const
+{
+  return (x >= 0 && x < num_cells_[DIM_X] && y >= 0 && y < num_cells_[DIM_Y] && z >= 0 && z < num_cells_[DIM_Z]);
+}
+
+template <typename T, BrickLayout layout>
+inline bool SparseVoxelGrid<T, layout>::isCellValid(const Eigen::Vector3i& pos) const
+{
+  return isCellValid(pos.x(), pos.y(), pos.z());
+}
+
+template <typename T, BrickLayout layout>
+inline std::size_t SparseVoxelGrid<T, layout>::getNumBricks() const
+{
+  return bricks_.size();
+}
+
+template <typename T, BrickLayout layout>
+inline std::size_t SparseVoxelGrid<T, layout>::getNumAllocatedBricks() const
+{
+  return num_allocated_bricks_;
+}
+}
+
+#endif
@@ -0,0 +1,215 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2009, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_DISTANCE_FIELD_TIERED_PROPAGATION_DISTANCE_FIELD_
+#define MOVEIT_DISTANCE_FIELD_TIERED_PROPAGATION_DISTANCE_FIELD_
+
+#include <moveit/distance_field/propagation_distance_field.h>
+#include <memory>
+#include <set>
+
+namespace distance_field
+{
+/**
+ * \brief A two-tier DistanceField built from a pair of \ref
+ * PropagationDistanceField instances: a coarse field covering the
+ * entire workspace, and a fine field covering a movable focus region
+ * (typically a box around the robot).
+ *
+ * Large workspaces at fine resolutions make each obstacle update
+ * expensive, although the fine resolution is only needed where the
+ * robot can actually reach during the current request.  This field
+ * keeps the full workspace at a resolution coarsened by an integer
+ * factor, and maintains full resolution only inside the focus region.
+ * World-coordinate distance and gradient queries are answered by the
+ * fine field when the query falls inside the focus region and by the
+ * coarse field otherwise.  The grid-index interface exposes the fine
+ * resolution over the whole workspace so that \ref
+ * DistanceField::getDistanceGradient produces fine-resolution central
+ * differences near the robot.
+ *
+ * Until \ref setFocusRegion is called, all queries resolve on the
+ * coarse tier.  Moving the focus region rebuilds the fine field from
+ * the obstacle points added so far, so it should be done once per
+ * planning request rather than per query.
+ */
+class TieredPropagationDistanceField : public DistanceField
+{
+public:
+  /**
+   * \brief Constructor, with the same semantics as the corresponding
+   * \ref PropagationDistanceField constructor.  The resolution is the
+   * fine resolution used inside the focus region; the workspace-wide
+   * coarse field uses resolution times coarse_resolution_factor.
+   *
+   * @param [in] size_x The X dimension in meters of the volume to represent
+   * @param [in] size_y The Y dimension in meters of the volume to represent
+   * @param [in] size_z The Z dimension in meters of the volume to represent
+   * @param [in] resolution The fine resolution in meters of the volume
+   * @param [in] origin_x The minimum X point of the volume
+   * @param [in] origin_y The minimum Y point of the volume
+   * @param [in] origin_z The minimum Z point of the volume
+   * @param [in] max_distance The maximum distance to which to propagate distance values
+   * @param [in] coarse_resolution_factor Integer factor (at least 1) by which the
+   * workspace-wide field is coarsened relative to the fine resolution
+   * @param [in] propagate_negative_distances Whether or not to propagate negative
+   * distances; see \ref PropagationDistanceField
+   */
+  TieredPropagationDistanceField(double size_x, double size_y, double size_z, double resolution, double origin_x,
+                                 double origin_y, double origin_z, double max_distance,
+                                 int coarse_resolution_factor = 4, bool propagate_negative_distances = false);
+
+  /**
+   * \brief Empty destructor
+   */
+  ~TieredPropagationDistanceField() override
+  {
+  }
+
+  /**
+   * \brief Sets the focus region in which queries are answered at the
+   * fine resolution, rebuilding the fine field from the obstacle
+   * points added so far.  The region is clamped to the workspace.  The
+   * fine field is allocated with a margin of max_distance around the
+   * region so that obstacles just outside it still contribute correct
+   * distances inside.
+   *
+   * @param [in] min_corner The minimum world coordinates of the focus region
+   * @param [in] max_corner The maximum world coordinates of the focus region
+   */
+  void setFocusRegion(const Eigen::Vector3d& min_corner, const Eigen::Vector3d& max_corner);
+
+  /**
+   * \brief Whether a focus region has been set
+   */
+  bool hasFocusRegion() const
+  {
+    return has_focus_;
+  }
+
+  /**
+   * \brief Whether the given world coordinates fall inside the focus region
+   */
+  bool isInFocusRegion(double x, double y, double z) const;
+
+  void addPointsToField(const EigenSTL::vector_Vector3d& points) override;
+  void removePointsFromField(const EigenSTL::vector_Vector3d& points) override;
+  void updatePointsInField(const EigenSTL::vector_Vector3d& old_points,
+                           const EigenSTL::vector_Vector3d& new_points) override;
+  void reset() override;
+
+  /**
+   * \brief Get the distance at the given world coordinates from the
+   * fine field if inside the focus region, and from the coarse field
+   * otherwise.
+   */
+  double getDistance(double x, double y, double z) const override;
+
+  /**
+   * \brief Get the distance for the given index in the workspace-wide
+   * fine-resolution index space.  The cell center is resolved through
+   * \ref getDistance(double, double, double), so the value comes from
+   * whichever tier covers that location.
+   */
+  double getDistance(int x, int y, int z) const override;
+
+  bool isCellValid(int x, int y, int z) const override;
+  int getXNumCells() const override;
+  int getYNumCells() const override;
+  int getZNumCells() const override;
+  bool gridToWorld(int x, int y, int z, double& world_x, double& world_y, double& world_z) const override;
+  bool worldToGrid(double world_x, double world_y, double world_z, int& x, int& y, int& z) const override;
+
+  /**
+   * \brief Stream serialization is not supported for the tiered field;
+   * the stream format is defined by the single-grid fields.  Always
+   * returns false.
+   */
+  bool writeToStream(std::ostream& stream) const override;
+
+  /**
+   * \brief Stream deserialization is not supported for the tiered
+   * field; see \ref writeToStream.  Always returns false.
+   */
+  bool readFromStream(std::istream& stream) override;
+
+  double getUninitializedDistance() const override
+  {
+    return max_distance_;
+  }
+
+  /**
+   * \brief The workspace-wide coarse tier
+   */
+  const PropagationDistanceField* getCoarseField() const
+  {
+    return coarse_field_.get();
+  }
+
+  /**
+   * \brief The fine tier covering the focus region, or NULL if no
+   * focus region has been set
+   */
+  const PropagationDistanceField* getFineField() const
+  {
+    return fine_field_.get();
+  }
+
+private:
+  /** Typedef for set of integer indices */
+  typedef std::set<Eigen::Vector3i, compareEigen_Vector3i, Eigen::aligned_allocator<Eigen::Vector3i>> VoxelSet;
+
+  /**
+   * \brief Rebuilds the fine field over the current focus region and
+   * re-adds the stored obstacle cells that can influence it.
+   */
+  void rebuildFineField();
+
+  double max_distance_;           /**< \brief Holds maximum distance  */
+  int coarse_resolution_factor_;  /**< \brief Coarsening factor of the workspace-wide tier */
+  bool propagate_negative_;       /**< \brief Whether or not to propagate negative distances */
+
+  std::shared_ptr<PropagationDistanceField> coarse_field_; /**< \brief Workspace-wide coarse tier */
+  std::shared_ptr<PropagationDistanceField> fine_field_;   /**< \brief Fine tier over the focus region, may be NULL */
+
+  bool has_focus_;            /**< \brief Whether a focus region has been set */
+  Eigen::Vector3d focus_min_; /**< \brief Minimum corner of the focus region */
+  Eigen::Vector3d focus_max_; /**< \brief Maximum corner of the focus region */
+
+  VoxelSet obstacle_cells_; /**< \brief Obstacle cells in the fine-resolution index space, kept so the
+                                 fine field can be rebuilt when the focus region moves */
+};
+}
+
+#endif
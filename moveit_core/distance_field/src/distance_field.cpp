@@ -85,6 +85,19 @@ double DistanceField::getDistanceGradient(double x, double y, double z, double&
   return getDistance(gx, gy, gz);
 }
 
+void DistanceField::getDistancesAndGradients(const Eigen::Vector3d* points, std::size_t count, double* distances,
+                                             double* gradients_x, double* gradients_y, double* gradients_z,
+                                             unsigned char* in_bounds) const
+{
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    bool point_in_bounds = false;
+    distances[i] = getDistanceGradient(points[i].x(), points[i].y(), points[i].z(), gradients_x[i], gradients_y[i],
+                                       gradients_z[i], point_in_bounds);
+    in_bounds[i] = point_in_bounds;
+  }
+}
+
 void DistanceField::getIsoSurfaceMarkers(double min_distance, double max_distance, const std::string& frame_id,
                                          const ros::Time stamp, visualization_msgs::Marker& inf_marker) const
 {
@@ -218,6 +231,18 @@ bool DistanceField::getShapePoints(const shapes::Shape* shape, const Eigen::Isom
 
 void DistanceField::addShapeToField(const shapes::Shape* shape, const Eigen::Isometry3d& pose)
 {
+  if (shape->type == shapes::OCTREE)
+  {
+    const shapes::OcTree* oc = dynamic_cast<const shapes::OcTree*>(shape);
+    if (!oc)
+    {
+      ROS_ERROR_NAMED("distance_field", "Problem dynamic casting shape that claims to be OcTree");
+      return;
+    }
+    // let derived fields that integrate octrees directly skip the intermediate point list
+    addOcTreeToField(oc->octree.get());
+    return;
+  }
   EigenSTL::vector_Vector3d point_vec;
   getShapePoints(shape, pose, &point_vec);
   addPointsToField(point_vec);
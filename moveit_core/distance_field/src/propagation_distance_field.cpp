@@ -35,11 +35,13 @@
 /* Author: Mrinal Kalakrishnan, Ken Anderson */
 
 #include <moveit/distance_field/propagation_distance_field.h>
+#include <moveit/macros/cpu_dispatch.h>
 #include <visualization_msgs/Marker.h>
 #include <ros/console.h>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/copy.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
+#include <algorithm>
 
 namespace distance_field
 {
@@ -76,8 +78,18 @@ PropagationDistanceField::PropagationDistanceField(std::istream& is, double max_
 void PropagationDistanceField::initialize()
 {
   max_distance_sq_ = ceil(max_distance_ / resolution_) * ceil(max_distance_ / resolution_);
-  voxel_grid_.reset(new VoxelGrid<PropDistanceFieldVoxel>(size_x_, size_y_, size_z_, resolution_, origin_x_, origin_y_,
-                                                          origin_z_, PropDistanceFieldVoxel(max_distance_sq_, 0)));
+  voxel_grid_.reset(new PropDistanceFieldGrid(
+      size_x_, size_y_, size_z_, resolution_, origin_x_, origin_y_, origin_z_,
+      PropDistanceFieldVoxel(max_distance_sq_, 0)));
+  // unwritten cells must behave like the post-reset state of the old dense
+  // grid: free space at maximum distance whose closest unoccupied cell is
+  // itself.  The per-cell part is applied when a brick is first written to.
+  voxel_grid_->setCellInitializer([](int x, int y, int z, PropDistanceFieldVoxel& voxel) {
+    voxel.closest_negative_point_.x() = x;
+    voxel.closest_negative_point_.y() = y;
+    voxel.closest_negative_point_.z() = z;
+    voxel.negative_distance_square_ = 0;
+  });
 
   initNeighborhoods();
 
@@ -203,6 +215,54 @@ void PropagationDistanceField::addPointsToField(const EigenSTL::vector_Vector3d&
   addNewObstacleVoxels(voxel_points);
 }
 
+void PropagationDistanceField::addOcTreeToField(const octomap::OcTree* octree)
+{
+  // field extent in world coordinates, used to restrict the leaf traversal
+  double min_x, min_y, min_z;
+  gridToWorld(0, 0, 0, min_x, min_y, min_z);
+  double max_x, max_y, max_z;
+  gridToWorld(getXNumCells(), getYNumCells(), getZNumCells(), max_x, max_y, max_z);
+
+  EigenSTL::vector_Vector3i voxel_points;
+  for (octomap::OcTree::leaf_bbx_iterator it = octree->begin_leafs_bbx(octomap::point3d(min_x, min_y, min_z),
+                                                                       octomap::point3d(max_x, max_y, max_z)),
+                                          end = octree->end_leafs_bbx();
+       it != end; ++it)
+  {
+    if (!octree->isNodeOccupied(*it))
+      continue;
+
+    if (it.getSize() <= resolution_)
+    {
+      // a leaf at or below the field resolution marks the single cell containing its center
+      Eigen::Vector3i voxel_loc;
+      if (worldToGrid(it.getX(), it.getY(), it.getZ(), voxel_loc.x(), voxel_loc.y(), voxel_loc.z()) &&
+          voxel_grid_->getCell(voxel_loc.x(), voxel_loc.y(), voxel_loc.z()).distance_square_ > 0)
+        voxel_points.push_back(voxel_loc);
+      continue;
+    }
+
+    // mark the cell range covered by the leaf at its depth-scaled size in one pass, so a
+    // coarse leaf costs one range operation instead of one point per covered cell.  The
+    // extent is expanded exactly as \ref DistanceField::getOcTreePoints expands it, so the
+    // marked cells match what the point-based path would produce for the same leaf.
+    double ceil_val = ceil(it.getSize() / resolution_) * resolution_ / 2.0;
+    int min_cell_x = std::max(voxel_grid_->getCellFromLocation(DIM_X, it.getX() - ceil_val), 0);
+    int min_cell_y = std::max(voxel_grid_->getCellFromLocation(DIM_Y, it.getY() - ceil_val), 0);
+    int min_cell_z = std::max(voxel_grid_->getCellFromLocation(DIM_Z, it.getZ() - ceil_val), 0);
+    int max_cell_x = std::min(voxel_grid_->getCellFromLocation(DIM_X, it.getX() + ceil_val), getXNumCells() - 1);
+    int max_cell_y = std::min(voxel_grid_->getCellFromLocation(DIM_Y, it.getY() + ceil_val), getYNumCells() - 1);
+    int max_cell_z = std::min(voxel_grid_->getCellFromLocation(DIM_Z, it.getZ() + ceil_val), getZNumCells() - 1);
+
+    for (int x = min_cell_x; x <= max_cell_x; ++x)
+      for (int y = min_cell_y; y <= max_cell_y; ++y)
+        for (int z = min_cell_z; z <= max_cell_z; ++z)
+          if (voxel_grid_->getCell(x, y, z).distance_square_ > 0)
+            voxel_points.push_back(Eigen::Vector3i(x, y, z));
+  }
+  addNewObstacleVoxels(voxel_points);
+}
+
 void PropagationDistanceField::removePointsFromField(const EigenSTL::vector_Vector3d& points)
 {
   EigenSTL::vector_Vector3i voxel_points;
@@ -233,7 +293,9 @@ void PropagationDistanceField::addNewObstacleVoxels(const EigenSTL::vector_Vecto
   EigenSTL::vector_Vector3i negative_stack;
   if (propagate_negative_)
   {
-    negative_stack.reserve(getXNumCells() * getYNumCells() * getZNumCells());
+    // the stack grows on demand; reserving the full grid here makes every
+    // incremental update pay for a grid-sized allocation
+    negative_stack.reserve(voxel_points.size());
     negative_bucket_queue_[0].reserve(voxel_points.size());
   }
 
@@ -254,9 +316,11 @@ void PropagationDistanceField::addNewObstacleVoxels(const EigenSTL::vector_Vecto
       negative_stack.push_back(loc);
     }
   }
-  propagatePositive();
-
-  if (propagate_negative_)
+  if (!propagate_negative_)
+  {
+    propagatePositive();
+  }
+  else
   {
     while (!negative_stack.empty())
     {
@@ -304,7 +368,8 @@ void PropagationDistanceField::addNewObstacleVoxels(const EigenSTL::vector_Vecto
         }
       }
     }
-    propagateNegative();
+    // both seed sets are complete; expand the two wavefronts in one fused sweep
+    propagateBoth();
   }
 }
 
@@ -315,11 +380,13 @@ void PropagationDistanceField::removeObstacleVoxels(const EigenSTL::vector_Vecto
   EigenSTL::vector_Vector3i negative_stack;
   int initial_update_direction = getDirectionNumber(0, 0, 0);
 
-  stack.reserve(getXNumCells() * getYNumCells() * getZNumCells());
+  // the stacks grow on demand; reserving the full grid here makes every
+  // incremental update pay for a grid-sized allocation
+  stack.reserve(voxel_points.size());
   bucket_queue_[0].reserve(voxel_points.size());
   if (propagate_negative_)
   {
-    negative_stack.reserve(getXNumCells() * getYNumCells() * getZNumCells());
+    negative_stack.reserve(voxel_points.size());
     negative_bucket_queue_[0].reserve(voxel_points.size());
   }
 
@@ -387,151 +454,163 @@ void PropagationDistanceField::removeObstacleVoxels(const EigenSTL::vector_Vecto
       }
     }
   }
-  propagatePositive();
-
   if (propagate_negative_)
-  {
-    propagateNegative();
-  }
+    propagateBoth();
+  else
+    propagatePositive();
 }
 
 void PropagationDistanceField::propagatePositive()
 {
-  // now process the queue:
-  for (unsigned int i = 0; i < bucket_queue_.size(); ++i)
+  // Changed cells are seeded into bucket 0 and propagation only ever pushes into
+  // higher buckets, so walking the queue up to the highest bucket that was actually
+  // filled is enough - buckets beyond it are still empty from the previous update.
+  int last_bucket = 0;
+  for (int i = 0; i <= last_bucket; ++i)
+    propagatePositiveBucket(i, last_bucket);
+}
+
+void PropagationDistanceField::propagatePositiveBucket(int bucket, int& last_bucket)
+{
+  EigenSTL::vector_Vector3i::iterator list_it = bucket_queue_[bucket].begin();
+  EigenSTL::vector_Vector3i::iterator list_end = bucket_queue_[bucket].end();
+  for (; list_it != list_end; ++list_it)
   {
-    EigenSTL::vector_Vector3i::iterator list_it = bucket_queue_[i].begin();
-    EigenSTL::vector_Vector3i::iterator list_end = bucket_queue_[i].end();
-    for (; list_it != list_end; ++list_it)
+    const Eigen::Vector3i& loc = *list_it;
+    PropDistanceFieldVoxel* vptr = &voxel_grid_->getCell(loc.x(), loc.y(), loc.z());
+
+    // select the neighborhood list based on the update direction:
+    EigenSTL::vector_Vector3i* neighborhood;
+    int d = bucket;
+    if (d > 1)
+      d = 1;
+
+    // This will never happen.  update_direction_ is always set before voxel is added to bucket queue.
+    if (vptr->update_direction_ < 0 || vptr->update_direction_ > 26)
     {
-      const Eigen::Vector3i& loc = *list_it;
-      PropDistanceFieldVoxel* vptr = &voxel_grid_->getCell(loc.x(), loc.y(), loc.z());
+      ROS_ERROR_NAMED("distance_field", "PROGRAMMING ERROR: Invalid update direction detected: %d",
+                      vptr->update_direction_);
+      continue;
+    }
 
-      // select the neighborhood list based on the update direction:
-      EigenSTL::vector_Vector3i* neighborhood;
-      int d = i;
-      if (d > 1)
-        d = 1;
+    neighborhood = &neighborhoods_[d][vptr->update_direction_];
 
-      // This will never happen.  update_direction_ is always set before voxel is added to bucket queue.
-      if (vptr->update_direction_ < 0 || vptr->update_direction_ > 26)
-      {
-        ROS_ERROR_NAMED("distance_field", "PROGRAMMING ERROR: Invalid update direction detected: %d",
-                        vptr->update_direction_);
+    for (unsigned int n = 0; n < neighborhood->size(); n++)
+    {
+      Eigen::Vector3i diff = (*neighborhood)[n];
+      Eigen::Vector3i nloc(loc.x() + diff.x(), loc.y() + diff.y(), loc.z() + diff.z());
+      if (!isCellValid(nloc.x(), nloc.y(), nloc.z()))
         continue;
-      }
 
-      neighborhood = &neighborhoods_[d][vptr->update_direction_];
+      // the real update code:
+      // calculate the neighbor's new distance based on my closest filled voxel:
+      PropDistanceFieldVoxel* neighbor = &voxel_grid_->getCell(nloc.x(), nloc.y(), nloc.z());
+      int new_distance_sq = eucDistSq(vptr->closest_point_, nloc);
+      if (new_distance_sq > max_distance_sq_)
+        continue;
 
-      for (unsigned int n = 0; n < neighborhood->size(); n++)
+      if (new_distance_sq < neighbor->distance_square_)
       {
-        Eigen::Vector3i diff = (*neighborhood)[n];
-        Eigen::Vector3i nloc(loc.x() + diff.x(), loc.y() + diff.y(), loc.z() + diff.z());
-        if (!isCellValid(nloc.x(), nloc.y(), nloc.z()))
-          continue;
-
-        // the real update code:
-        // calculate the neighbor's new distance based on my closest filled voxel:
-        PropDistanceFieldVoxel* neighbor = &voxel_grid_->getCell(nloc.x(), nloc.y(), nloc.z());
-        int new_distance_sq = eucDistSq(vptr->closest_point_, nloc);
-        if (new_distance_sq > max_distance_sq_)
-          continue;
-
-        if (new_distance_sq < neighbor->distance_square_)
-        {
-          // update the neighboring voxel
-          neighbor->distance_square_ = new_distance_sq;
-          neighbor->closest_point_ = vptr->closest_point_;
-          neighbor->update_direction_ = getDirectionNumber(diff.x(), diff.y(), diff.z());
-
-          // and put it in the queue:
-          bucket_queue_[new_distance_sq].push_back(nloc);
-        }
+        // update the neighboring voxel
+        neighbor->distance_square_ = new_distance_sq;
+        neighbor->closest_point_ = vptr->closest_point_;
+        neighbor->update_direction_ = getDirectionNumber(diff.x(), diff.y(), diff.z());
+
+        // and put it in the queue:
+        bucket_queue_[new_distance_sq].push_back(nloc);
+        if (new_distance_sq > last_bucket)
+          last_bucket = new_distance_sq;
       }
     }
-    bucket_queue_[i].clear();
   }
+  bucket_queue_[bucket].clear();
 }
 
 void PropagationDistanceField::propagateNegative()
 {
-  // now process the queue:
-  for (unsigned int i = 0; i < negative_bucket_queue_.size(); ++i)
+  // see propagatePositive() - only walk the buckets that were actually filled
+  int last_bucket = 0;
+  for (int i = 0; i <= last_bucket; ++i)
+    propagateNegativeBucket(i, last_bucket);
+}
+
+void PropagationDistanceField::propagateBoth()
+{
+  // fused signed propagation: both wavefronts expand band by band, so processing
+  // the positive and the negative frontier of each distance band back to back
+  // walks the cells around the obstacle surface once while they are warm in the
+  // cache, instead of sweeping the full frontier separately per sign
+  int last_bucket = 0;
+  for (int i = 0; i <= last_bucket; ++i)
+  {
+    propagatePositiveBucket(i, last_bucket);
+    propagateNegativeBucket(i, last_bucket);
+  }
+}
+
+void PropagationDistanceField::propagateNegativeBucket(int bucket, int& last_bucket)
+{
+  EigenSTL::vector_Vector3i::iterator list_it = negative_bucket_queue_[bucket].begin();
+  EigenSTL::vector_Vector3i::iterator list_end = negative_bucket_queue_[bucket].end();
+  for (; list_it != list_end; ++list_it)
   {
-    EigenSTL::vector_Vector3i::iterator list_it = negative_bucket_queue_[i].begin();
-    EigenSTL::vector_Vector3i::iterator list_end = negative_bucket_queue_[i].end();
-    for (; list_it != list_end; ++list_it)
+    const Eigen::Vector3i& loc = *list_it;
+    PropDistanceFieldVoxel* vptr = &voxel_grid_->getCell(loc.x(), loc.y(), loc.z());
+
+    // select the neighborhood list based on the update direction:
+    EigenSTL::vector_Vector3i* neighborhood;
+    int d = bucket;
+    if (d > 1)
+      d = 1;
+
+    // This will never happen.  negative_update_direction_ is always set before voxel is added to
+    // negative_bucket_queue_.
+    if (vptr->negative_update_direction_ < 0 || vptr->negative_update_direction_ > 26)
     {
-      const Eigen::Vector3i& loc = *list_it;
-      PropDistanceFieldVoxel* vptr = &voxel_grid_->getCell(loc.x(), loc.y(), loc.z());
-
-      // select the neighborhood list based on the update direction:
-      EigenSTL::vector_Vector3i* neighborhood;
-      int d = i;
-      if (d > 1)
-        d = 1;
-
-      // This will never happen.  negative_update_direction_ is always set before voxel is added to
-      // negative_bucket_queue_.
-      if (vptr->negative_update_direction_ < 0 || vptr->negative_update_direction_ > 26)
-      {
-        ROS_ERROR_NAMED("distance_field", "PROGRAMMING ERROR: Invalid update direction detected: %d",
-                        vptr->update_direction_);
+      ROS_ERROR_NAMED("distance_field", "PROGRAMMING ERROR: Invalid update direction detected: %d",
+                      vptr->update_direction_);
+      continue;
+    }
+
+    neighborhood = &neighborhoods_[d][vptr->negative_update_direction_];
+
+    for (unsigned int n = 0; n < neighborhood->size(); n++)
+    {
+      Eigen::Vector3i diff = (*neighborhood)[n];
+      Eigen::Vector3i nloc(loc.x() + diff.x(), loc.y() + diff.y(), loc.z() + diff.z());
+      if (!isCellValid(nloc.x(), nloc.y(), nloc.z()))
         continue;
-      }
 
-      neighborhood = &neighborhoods_[d][vptr->negative_update_direction_];
+      // the real update code:
+      // calculate the neighbor's new distance based on my closest filled voxel:
+      PropDistanceFieldVoxel* neighbor = &voxel_grid_->getCell(nloc.x(), nloc.y(), nloc.z());
+      int new_distance_sq = eucDistSq(vptr->closest_negative_point_, nloc);
+      if (new_distance_sq > max_distance_sq_)
+        continue;
 
-      for (unsigned int n = 0; n < neighborhood->size(); n++)
+      if (new_distance_sq < neighbor->negative_distance_square_)
       {
-        Eigen::Vector3i diff = (*neighborhood)[n];
-        Eigen::Vector3i nloc(loc.x() + diff.x(), loc.y() + diff.y(), loc.z() + diff.z());
-        if (!isCellValid(nloc.x(), nloc.y(), nloc.z()))
-          continue;
-
-        // the real update code:
-        // calculate the neighbor's new distance based on my closest filled voxel:
-        PropDistanceFieldVoxel* neighbor = &voxel_grid_->getCell(nloc.x(), nloc.y(), nloc.z());
-        int new_distance_sq = eucDistSq(vptr->closest_negative_point_, nloc);
-        if (new_distance_sq > max_distance_sq_)
-          continue;
-        // std::cout << "Looking at " << nloc.x() << " " << nloc.y() << " " << nloc.z() << " " << new_distance_sq << " "
-        // << neighbor->negative_distance_square_ << std::endl;
-        if (new_distance_sq < neighbor->negative_distance_square_)
-        {
-          // std::cout << "Updating " << nloc.x() << " " << nloc.y() << " " << nloc.z() << " " << new_distance_sq <<
-          // std::endl;
-          // update the neighboring voxel
-          neighbor->negative_distance_square_ = new_distance_sq;
-          neighbor->closest_negative_point_ = vptr->closest_negative_point_;
-          neighbor->negative_update_direction_ = getDirectionNumber(diff.x(), diff.y(), diff.z());
-
-          // and put it in the queue:
-          negative_bucket_queue_[new_distance_sq].push_back(nloc);
-        }
+        // update the neighboring voxel
+        neighbor->negative_distance_square_ = new_distance_sq;
+        neighbor->closest_negative_point_ = vptr->closest_negative_point_;
+        neighbor->negative_update_direction_ = getDirectionNumber(diff.x(), diff.y(), diff.z());
+
+        // and put it in the queue:
+        negative_bucket_queue_[new_distance_sq].push_back(nloc);
+        if (new_distance_sq > last_bucket)
+          last_bucket = new_distance_sq;
       }
     }
-    negative_bucket_queue_[i].clear();
   }
+  negative_bucket_queue_[bucket].clear();
 }
 
 void PropagationDistanceField::reset()
 {
+  // dropping the sparse grid's bricks restores every cell to the default
+  // free-space state in one step; the per-cell negative distance seeds are
+  // filled in by the cell initializer whenever a brick is next written to
   voxel_grid_->reset(PropDistanceFieldVoxel(max_distance_sq_, 0));
-  for (int x = 0; x < getXNumCells(); x++)
-  {
-    for (int y = 0; y < getYNumCells(); y++)
-    {
-      for (int z = 0; z < getZNumCells(); z++)
-      {
-        PropDistanceFieldVoxel& voxel = voxel_grid_->getCell(x, y, z);
-        voxel.closest_negative_point_.x() = x;
-        voxel.closest_negative_point_.y() = y;
-        voxel.closest_negative_point_.z() = z;
-        voxel.negative_distance_square_ = 0;
-      }
-    }
-  }
   // object_voxel_locations_.clear();
 }
 
@@ -610,7 +689,65 @@ double PropagationDistanceField::getDistance(double x, double y, double z) const
 
 double PropagationDistanceField::getDistance(int x, int y, int z) const
 {
-  return getDistance(voxel_grid_->getCell(x, y, z));
+  return getDistance(getCell(x, y, z));
+}
+
+namespace
+{
+/* Loop body of getDistancesAndGradients(), kept a free function with all state passed in
+   so MOVEIT_CPU_CLONES can emit per-ISA versions of it; the runtime linker binds the
+   widest one the CPU supports. */
+MOVEIT_CPU_CLONES
+void batchDistanceGradientKernel(const PropDistanceFieldGrid& grid, const double* sqrt_table, double origin_x,
+                                 double origin_y, double origin_z, double inv_resolution, double inv_twice_resolution,
+                                 double max_distance, int num_x, int num_y, int num_z, const Eigen::Vector3d* points,
+                                 std::size_t count, double* distances, double* gradients_x, double* gradients_y,
+                                 double* gradients_z, unsigned char* in_bounds)
+{
+  auto cell_distance = [sqrt_table, &grid](int x, int y, int z) {
+    const PropDistanceFieldVoxel& cell = grid.getCell(x, y, z);
+    return sqrt_table[cell.distance_square_] - sqrt_table[cell.negative_distance_square_];
+  };
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    int gx = int(floor((points[i].x() - origin_x) * inv_resolution + 0.5));
+    int gy = int(floor((points[i].y() - origin_y) * inv_resolution + 0.5));
+    int gz = int(floor((points[i].z() - origin_z) * inv_resolution + 0.5));
+
+    // we need extra padding of 1 to get gradients
+    if (gx < 1 || gy < 1 || gz < 1 || gx >= num_x - 1 || gy >= num_y - 1 || gz >= num_z - 1)
+    {
+      distances[i] = max_distance;
+      gradients_x[i] = 0.0;
+      gradients_y[i] = 0.0;
+      gradients_z[i] = 0.0;
+      in_bounds[i] = 0;
+      continue;
+    }
+
+    distances[i] = cell_distance(gx, gy, gz);
+    gradients_x[i] = (cell_distance(gx + 1, gy, gz) - cell_distance(gx - 1, gy, gz)) * inv_twice_resolution;
+    gradients_y[i] = (cell_distance(gx, gy + 1, gz) - cell_distance(gx, gy - 1, gz)) * inv_twice_resolution;
+    gradients_z[i] = (cell_distance(gx, gy, gz + 1) - cell_distance(gx, gy, gz - 1)) * inv_twice_resolution;
+    in_bounds[i] = 1;
+  }
+}
+}  // namespace
+
+void PropagationDistanceField::getDistancesAndGradients(const Eigen::Vector3d* points, std::size_t count,
+                                                        double* distances, double* gradients_x, double* gradients_y,
+                                                        double* gradients_z, unsigned char* in_bounds) const
+{
+  // Batched equivalent of DistanceField::getDistanceGradient.  The grid parameters
+  // are hoisted out of the loop and the cell values are read straight from the
+  // voxel grid and sqrt table, so the iterations are independent and free of
+  // virtual dispatch; with structure-of-arrays outputs this lets the compiler
+  // vectorize the surrounding collision checking loops.
+  batchDistanceGradientKernel(*voxel_grid_, &sqrt_table_[0], origin_x_, origin_y_, origin_z_, 1.0 / resolution_,
+                              inv_twice_resolution_, max_distance_, voxel_grid_->getNumCells(DIM_X),
+                              voxel_grid_->getNumCells(DIM_Y), voxel_grid_->getNumCells(DIM_Z), points, count,
+                              distances, gradients_x, gradients_y, gradients_z, in_bounds);
 }
 
 bool PropagationDistanceField::isCellValid(int x, int y, int z) const
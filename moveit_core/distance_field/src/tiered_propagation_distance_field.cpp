@@ -0,0 +1,245 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2009, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/distance_field/tiered_propagation_distance_field.h>
+#include <ros/console.h>
+#include <algorithm>
+
+namespace distance_field
+{
+TieredPropagationDistanceField::TieredPropagationDistanceField(double size_x, double size_y, double size_z,
+                                                               double resolution, double origin_x, double origin_y,
+                                                               double origin_z, double max_distance,
+                                                               int coarse_resolution_factor,
+                                                               bool propagate_negative_distances)
+  : DistanceField(size_x, size_y, size_z, resolution, origin_x, origin_y, origin_z)
+  , max_distance_(max_distance)
+  , coarse_resolution_factor_(std::max(1, coarse_resolution_factor))
+  , propagate_negative_(propagate_negative_distances)
+  , has_focus_(false)
+  , focus_min_(0.0, 0.0, 0.0)
+  , focus_max_(0.0, 0.0, 0.0)
+{
+  coarse_field_.reset(new PropagationDistanceField(size_x, size_y, size_z, resolution * coarse_resolution_factor_,
+                                                   origin_x, origin_y, origin_z, max_distance,
+                                                   propagate_negative_distances));
+}
+
+void TieredPropagationDistanceField::setFocusRegion(const Eigen::Vector3d& min_corner, const Eigen::Vector3d& max_corner)
+{
+  Eigen::Vector3d origin(origin_x_, origin_y_, origin_z_);
+  Eigen::Vector3d workspace_max = origin + Eigen::Vector3d(size_x_, size_y_, size_z_);
+
+  focus_min_ = min_corner.cwiseMax(origin);
+  focus_max_ = max_corner.cwiseMin(workspace_max);
+  has_focus_ = true;
+
+  rebuildFineField();
+}
+
+void TieredPropagationDistanceField::rebuildFineField()
+{
+  // allocate the fine field with a max_distance margin around the focus region so
+  // that obstacles just outside it still produce correct distances inside, then
+  // snap the box to the fine-resolution grid of the workspace
+  Eigen::Vector3d origin(origin_x_, origin_y_, origin_z_);
+  Eigen::Vector3d workspace_max = origin + Eigen::Vector3d(size_x_, size_y_, size_z_);
+  Eigen::Vector3d expanded_min = (focus_min_ - Eigen::Vector3d::Constant(max_distance_)).cwiseMax(origin);
+  Eigen::Vector3d expanded_max = (focus_max_ + Eigen::Vector3d::Constant(max_distance_)).cwiseMin(workspace_max);
+
+  Eigen::Vector3d fine_origin;
+  Eigen::Vector3d fine_size;
+  for (int i = 0; i < 3; i++)
+  {
+    fine_origin(i) = origin(i) + floor((expanded_min(i) - origin(i)) / resolution_) * resolution_;
+    fine_size(i) = ceil((expanded_max(i) - fine_origin(i)) / resolution_) * resolution_;
+  }
+
+  fine_field_.reset(new PropagationDistanceField(fine_size.x(), fine_size.y(), fine_size.z(), resolution_,
+                                                 fine_origin.x(), fine_origin.y(), fine_origin.z(), max_distance_,
+                                                 propagate_negative_));
+
+  // re-add the stored obstacle cells that fall inside the fine field; the field
+  // itself drops the points outside its bounds
+  EigenSTL::vector_Vector3d points;
+  for (VoxelSet::const_iterator it = obstacle_cells_.begin(); it != obstacle_cells_.end(); ++it)
+  {
+    double world_x, world_y, world_z;
+    gridToWorld(it->x(), it->y(), it->z(), world_x, world_y, world_z);
+    if (world_x >= expanded_min.x() && world_x <= expanded_max.x() && world_y >= expanded_min.y() &&
+        world_y <= expanded_max.y() && world_z >= expanded_min.z() && world_z <= expanded_max.z())
+    {
+      points.push_back(Eigen::Vector3d(world_x, world_y, world_z));
+    }
+  }
+  fine_field_->addPointsToField(points);
+}
+
+bool TieredPropagationDistanceField::isInFocusRegion(double x, double y, double z) const
+{
+  return has_focus_ && x >= focus_min_.x() && x <= focus_max_.x() && y >= focus_min_.y() && y <= focus_max_.y() &&
+         z >= focus_min_.z() && z <= focus_max_.z();
+}
+
+void TieredPropagationDistanceField::addPointsToField(const EigenSTL::vector_Vector3d& points)
+{
+  for (unsigned int i = 0; i < points.size(); i++)
+  {
+    Eigen::Vector3i voxel_loc;
+    if (worldToGrid(points[i].x(), points[i].y(), points[i].z(), voxel_loc.x(), voxel_loc.y(), voxel_loc.z()))
+    {
+      obstacle_cells_.insert(voxel_loc);
+    }
+  }
+
+  coarse_field_->addPointsToField(points);
+  if (fine_field_)
+    fine_field_->addPointsToField(points);
+}
+
+void TieredPropagationDistanceField::removePointsFromField(const EigenSTL::vector_Vector3d& points)
+{
+  for (unsigned int i = 0; i < points.size(); i++)
+  {
+    Eigen::Vector3i voxel_loc;
+    if (worldToGrid(points[i].x(), points[i].y(), points[i].z(), voxel_loc.x(), voxel_loc.y(), voxel_loc.z()))
+    {
+      obstacle_cells_.erase(voxel_loc);
+    }
+  }
+
+  coarse_field_->removePointsFromField(points);
+  if (fine_field_)
+    fine_field_->removePointsFromField(points);
+}
+
+void TieredPropagationDistanceField::updatePointsInField(const EigenSTL::vector_Vector3d& old_points,
+                                                         const EigenSTL::vector_Vector3d& new_points)
+{
+  for (unsigned int i = 0; i < old_points.size(); i++)
+  {
+    Eigen::Vector3i voxel_loc;
+    if (worldToGrid(old_points[i].x(), old_points[i].y(), old_points[i].z(), voxel_loc.x(), voxel_loc.y(),
+                    voxel_loc.z()))
+    {
+      obstacle_cells_.erase(voxel_loc);
+    }
+  }
+  for (unsigned int i = 0; i < new_points.size(); i++)
+  {
+    Eigen::Vector3i voxel_loc;
+    if (worldToGrid(new_points[i].x(), new_points[i].y(), new_points[i].z(), voxel_loc.x(), voxel_loc.y(),
+                    voxel_loc.z()))
+    {
+      obstacle_cells_.insert(voxel_loc);
+    }
+  }
+
+  coarse_field_->updatePointsInField(old_points, new_points);
+  if (fine_field_)
+    fine_field_->updatePointsInField(old_points, new_points);
+}
+
+void TieredPropagationDistanceField::reset()
+{
+  obstacle_cells_.clear();
+  coarse_field_->reset();
+  if (fine_field_)
+    fine_field_->reset();
+}
+
+double TieredPropagationDistanceField::getDistance(double x, double y, double z) const
+{
+  if (isInFocusRegion(x, y, z))
+    return fine_field_->getDistance(x, y, z);
+  return coarse_field_->getDistance(x, y, z);
+}
+
+double TieredPropagationDistanceField::getDistance(int x, int y, int z) const
+{
+  double world_x, world_y, world_z;
+  gridToWorld(x, y, z, world_x, world_y, world_z);
+  return getDistance(world_x, world_y, world_z);
+}
+
+bool TieredPropagationDistanceField::isCellValid(int x, int y, int z) const
+{
+  return x >= 0 && x < getXNumCells() && y >= 0 && y < getYNumCells() && z >= 0 && z < getZNumCells();
+}
+
+int TieredPropagationDistanceField::getXNumCells() const
+{
+  return static_cast<int>(size_x_ / resolution_);
+}
+
+int TieredPropagationDistanceField::getYNumCells() const
+{
+  return static_cast<int>(size_y_ / resolution_);
+}
+
+int TieredPropagationDistanceField::getZNumCells() const
+{
+  return static_cast<int>(size_z_ / resolution_);
+}
+
+bool TieredPropagationDistanceField::gridToWorld(int x, int y, int z, double& world_x, double& world_y,
+                                                 double& world_z) const
+{
+  world_x = origin_x_ + resolution_ * x;
+  world_y = origin_y_ + resolution_ * y;
+  world_z = origin_z_ + resolution_ * z;
+  return true;
+}
+
+bool TieredPropagationDistanceField::worldToGrid(double world_x, double world_y, double world_z, int& x, int& y,
+                                                 int& z) const
+{
+  x = static_cast<int>(floor((world_x - origin_x_) / resolution_ + 0.5));
+  y = static_cast<int>(floor((world_y - origin_y_) / resolution_ + 0.5));
+  z = static_cast<int>(floor((world_z - origin_z_) / resolution_ + 0.5));
+  return isCellValid(x, y, z);
+}
+
+bool TieredPropagationDistanceField::writeToStream(std::ostream& /*stream*/) const
+{
+  ROS_WARN_NAMED("distance_field", "Stream serialization is not supported for TieredPropagationDistanceField");
+  return false;
+}
+
+bool TieredPropagationDistanceField::readFromStream(std::istream& /*stream*/)
+{
+  ROS_WARN_NAMED("distance_field", "Stream deserialization is not supported for TieredPropagationDistanceField");
+  return false;
+}
+}
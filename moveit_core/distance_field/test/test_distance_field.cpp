@@ -38,6 +38,7 @@
 
 #include <moveit/distance_field/voxel_grid.h>
 #include <moveit/distance_field/propagation_distance_field.h>
+#include <moveit/distance_field/tiered_propagation_distance_field.h>
 #include <moveit/distance_field/find_internal_points.h>
 #include <geometric_shapes/body_operations.h>
 #include <tf2_eigen/tf2_eigen.h>
@@ -929,6 +930,98 @@ TEST(TestSignedPropagationDistanceField, TestReadWrite)
   EXPECT_FALSE(areDistanceFieldsDistancesEqual(df, df3));
 }
 
+TEST(TestSignedPropagationDistanceField, TestBatchGradients)
+{
+  PropagationDistanceField df(width, height, depth, resolution, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, max_dist, true);
+
+  EigenSTL::vector_Vector3d points;
+  points.push_back(point1);
+  points.push_back(POINT2);
+  points.push_back(POINT3);
+  df.addPointsToField(points);
+
+  // sample a mix of in-bounds, boundary and out-of-bounds query points
+  EigenSTL::vector_Vector3d queries;
+  for (double x = -0.15; x <= width + 0.15; x += resolution)
+  {
+    for (double y = 0.05; y < height; y += 2 * resolution)
+    {
+      for (double z = 0.05; z < depth; z += 2 * resolution)
+      {
+        queries.push_back(Eigen::Vector3d(x, y, z));
+      }
+    }
+  }
+
+  std::vector<double> distances(queries.size());
+  std::vector<double> gradients_x(queries.size());
+  std::vector<double> gradients_y(queries.size());
+  std::vector<double> gradients_z(queries.size());
+  std::vector<unsigned char> bounds(queries.size());
+  df.getDistancesAndGradients(queries.data(), queries.size(), distances.data(), gradients_x.data(), gradients_y.data(),
+                              gradients_z.data(), bounds.data());
+
+  for (unsigned int i = 0; i < queries.size(); i++)
+  {
+    double gx, gy, gz;
+    bool in_bounds;
+    double dist = df.getDistanceGradient(queries[i].x(), queries[i].y(), queries[i].z(), gx, gy, gz, in_bounds);
+    ASSERT_NEAR(distances[i], dist, .0001) << i;
+    ASSERT_NEAR(gradients_x[i], gx, .0001) << i;
+    ASSERT_NEAR(gradients_y[i], gy, .0001) << i;
+    ASSERT_NEAR(gradients_z[i], gz, .0001) << i;
+    ASSERT_EQ(bounds[i] != 0, in_bounds) << i;
+  }
+}
+
+TEST(TestTieredPropagationDistanceField, TestFocusRegion)
+{
+  TieredPropagationDistanceField tdf(width, height, depth, resolution, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, max_dist, 2);
+  PropagationDistanceField df(width, height, depth, resolution, ORIGIN_X, ORIGIN_Y, ORIGIN_Z, max_dist);
+
+  EigenSTL::vector_Vector3d points;
+  points.push_back(point1);
+  points.push_back(POINT2);
+  tdf.addPointsToField(points);
+  df.addPointsToField(points);
+
+  // without a focus region everything resolves on the coarse tier
+  EXPECT_FALSE(tdf.hasFocusRegion());
+  EXPECT_TRUE(tdf.getFineField() == nullptr);
+
+  tdf.setFocusRegion(Eigen::Vector3d(0.0, 0.0, 0.0), Eigen::Vector3d(0.5, 0.5, 0.5));
+  EXPECT_TRUE(tdf.hasFocusRegion());
+  ASSERT_TRUE(tdf.getFineField() != nullptr);
+  EXPECT_TRUE(tdf.isInFocusRegion(0.25, 0.25, 0.25));
+  EXPECT_FALSE(tdf.isInFocusRegion(0.75, 0.25, 0.25));
+
+  // inside the focus region the tiered field matches a single fine-resolution field,
+  // including for obstacles added after the region was set
+  EigenSTL::vector_Vector3d more_points;
+  more_points.push_back(POINT3);
+  tdf.addPointsToField(more_points);
+  df.addPointsToField(more_points);
+
+  for (double x = 0.05; x < 0.5; x += resolution)
+  {
+    for (double y = 0.05; y < 0.5; y += resolution)
+    {
+      for (double z = 0.05; z < 0.5; z += resolution)
+      {
+        ASSERT_NEAR(tdf.getDistance(x, y, z), df.getDistance(x, y, z), .0001) << x << " " << y << " " << z;
+      }
+    }
+  }
+
+  // removal propagates into both tiers
+  tdf.removePointsFromField(more_points);
+  df.removePointsFromField(more_points);
+  for (double x = 0.05; x < 0.5; x += resolution)
+  {
+    ASSERT_NEAR(tdf.getDistance(x, 0.05, 0.05), df.getDistance(x, 0.05, 0.05), .0001) << x;
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -37,6 +37,7 @@
 #include <gtest/gtest.h>
 
 #include <moveit/distance_field/voxel_grid.h>
+#include <moveit/distance_field/sparse_voxel_grid.h>
 #include <ros/ros.h>
 
 using namespace distance_field;
@@ -95,6 +96,111 @@ TEST(TestVoxelGrid, TestReadWrite)
       }
 }
 
+TEST(TestSparseVoxelGrid, TestReadWrite)
+{
+  int def = -100;
+  SparseVoxelGrid<int> svg(0.32, 0.32, 0.32, 0.01, 0, 0, 0, def, 4);
+
+  int numX = svg.getNumCells(DIM_X);
+  int numY = svg.getNumCells(DIM_Y);
+  int numZ = svg.getNumCells(DIM_Z);
+
+  // Check dimensions
+  EXPECT_EQ(numX, 32);
+  EXPECT_EQ(numY, 32);
+  EXPECT_EQ(numZ, 32);
+
+  // Const reads of unwritten cells return the default without allocating
+  const SparseVoxelGrid<int>& const_svg = svg;
+  for (int x = 0; x < numX; x++)
+    for (int y = 0; y < numY; y++)
+      for (int z = 0; z < numZ; z++)
+        EXPECT_EQ(const_svg.getCell(x, y, z), def);
+  EXPECT_EQ(svg.getNumAllocatedBricks(), 0u);
+
+  // Invalid locations also return the default
+  EXPECT_EQ(svg(-1.0, 0.0, 0.0), def);
+  EXPECT_EQ(svg(0.0, 0.0, 1.0), def);
+
+  // The cell initializer is applied to each cell of a materialized brick
+  svg.setCellInitializer([](int x, int y, int z, int& cell) { cell = x + y + z; });
+
+  // Writing a single cell materializes exactly one brick
+  svg.setCell(1, 2, 3, 42);
+  EXPECT_EQ(svg.getNumAllocatedBricks(), 1u);
+  EXPECT_EQ(const_svg.getCell(1, 2, 3), 42);
+
+  // The rest of the brick holds initializer values, cells outside it the default
+  EXPECT_EQ(const_svg.getCell(0, 0, 0), 0);
+  EXPECT_EQ(const_svg.getCell(3, 3, 3), 9);
+  EXPECT_EQ(const_svg.getCell(4, 0, 0), def);
+  EXPECT_EQ(const_svg.getCell(31, 31, 31), def);
+
+  // Writes round trip across brick boundaries
+  int i = 0;
+  for (int x = 0; x < numX; x++)
+    for (int y = 0; y < numY; y++)
+      for (int z = 0; z < numZ; z++)
+      {
+        svg.getCell(x, y, z) = i;
+        i++;
+      }
+  EXPECT_EQ(svg.getNumAllocatedBricks(), svg.getNumBricks());
+
+  i = 0;
+  for (int x = 0; x < numX; x++)
+    for (int y = 0; y < numY; y++)
+      for (int z = 0; z < numZ; z++)
+      {
+        EXPECT_EQ(i, const_svg.getCell(x, y, z));
+        i++;
+      }
+
+  // Reset drops all bricks and installs a new default
+  svg.reset(7);
+  EXPECT_EQ(svg.getNumAllocatedBricks(), 0u);
+  EXPECT_EQ(const_svg.getCell(10, 10, 10), 7);
+}
+
+TEST(TestSparseVoxelGrid, TestMortonLayout)
+{
+  // the Morton spread maps bit i to bit 3*i
+  EXPECT_EQ(mortonSpread3(0u), 0u);
+  EXPECT_EQ(mortonSpread3(1u), 1u);
+  EXPECT_EQ(mortonSpread3(2u), 8u);
+  EXPECT_EQ(mortonSpread3(3u), 9u);
+  EXPECT_EQ(mortonSpread3(0x3FFu), 0x9249249u);
+
+  int def = -100;
+  SparseVoxelGrid<int, BRICK_LAYOUT_MORTON> svg(0.32, 0.32, 0.32, 0.01, 0, 0, 0, def, 4);
+  const SparseVoxelGrid<int, BRICK_LAYOUT_MORTON>& const_svg = svg;
+
+  // the initializer sees grid coordinates, independent of the in-brick layout
+  svg.setCellInitializer([](int x, int y, int z, int& cell) { cell = x * 10000 + y * 100 + z; });
+  svg.setCell(1, 2, 3, 42);
+  EXPECT_EQ(svg.getNumAllocatedBricks(), 1u);
+  EXPECT_EQ(const_svg.getCell(1, 2, 3), 42);
+  EXPECT_EQ(const_svg.getCell(3, 1, 2), 30102);
+
+  // writes round trip with the same addressing as the linear layout
+  int i = 0;
+  for (int x = 0; x < svg.getNumCells(DIM_X); x++)
+    for (int y = 0; y < svg.getNumCells(DIM_Y); y++)
+      for (int z = 0; z < svg.getNumCells(DIM_Z); z++)
+      {
+        svg.getCell(x, y, z) = i;
+        i++;
+      }
+  i = 0;
+  for (int x = 0; x < svg.getNumCells(DIM_X); x++)
+    for (int y = 0; y < svg.getNumCells(DIM_Y); y++)
+      for (int z = 0; z < svg.getNumCells(DIM_Z); z++)
+      {
+        EXPECT_EQ(i, const_svg.getCell(x, y, z));
+        i++;
+      }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -89,6 +89,27 @@ public:
                   const std::vector<double>& joint_accelerations, const std::vector<geometry_msgs::Wrench>& wrenches,
                   std::vector<double>& torques) const;
 
+  /**
+   * @brief Run inverse dynamics over a whole trajectory and report the peak torque seen at each
+   * joint. All KDL workspaces are allocated once up front and the waypoints are distributed across
+   * the process-wide task scheduler, with one inverse dynamics solver per worker; this is much
+   * cheaper than calling getTorques() per waypoint when screening long trajectories against torque
+   * limits. The same external wrenches are applied at every waypoint (e.g. a payload attached to
+   * the last link).
+   * @param joint_angles Joint angles, one entry per waypoint;
+   * each entry must have size = number of joints in the group
+   * @param joint_velocities The joint velocities at each waypoint
+   * @param joint_accelerations The joint accelerations at each waypoint
+   * @param wrenches External wrenches acting on the links of the robot
+   * this must have size = number of links in the group
+   * @param peak_torques The largest absolute torque computed for each joint over all waypoints
+   * @return False if any of the input vectors are of the wrong size or inverse dynamics fails
+   */
+  bool getPeakTorques(const std::vector<std::vector<double>>& joint_angles,
+                      const std::vector<std::vector<double>>& joint_velocities,
+                      const std::vector<std::vector<double>>& joint_accelerations,
+                      const std::vector<geometry_msgs::Wrench>& wrenches, std::vector<double>& peak_torques) const;
+
   /**
    * @brief Get the maximum payload for this group (in kg). Payload is
    * the weight that this group can hold when the weight is attached to the origin
@@ -148,7 +169,8 @@ private:
   unsigned int num_joints_, num_segments_;  // number of joints in group, number of segments in group
   std::vector<double> max_torques_;         // vector of max torques
 
-  double gravity_;  // Norm of the gravity vector passed in initialize()
+  double gravity_;            // Norm of the gravity vector passed in initialize()
+  KDL::Vector kdl_gravity_;   // Gravity vector used to construct per-worker inverse dynamics solvers
 };
 }
 #endif
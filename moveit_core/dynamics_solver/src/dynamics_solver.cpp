@@ -35,6 +35,8 @@
 /* Author: Sachin Chitta */
 
 #include <moveit/dynamics_solver/dynamics_solver.h>
+#include <moveit/utils/task_scheduler.h>
+#include <algorithm>
 
 // KDL
 #include <kdl/jntarray.hpp>
@@ -136,6 +138,7 @@ DynamicsSolver::DynamicsSolver(const robot_model::RobotModelConstPtr& robot_mode
   KDL::Vector gravity(gravity_vector.x, gravity_vector.y,
                       gravity_vector.z);  // \todo Not sure if KDL expects the negative of this (Sachin)
   gravity_ = gravity.Norm();
+  kdl_gravity_ = gravity;
   ROS_DEBUG_NAMED("dynamics_solver", "Gravity norm set to %f", gravity_);
 
   chain_id_solver_.reset(new KDL::ChainIdSolver_RNE(kdl_chain_, gravity));
@@ -211,6 +214,119 @@ bool DynamicsSolver::getTorques(const std::vector<double>& joint_angles, const s
   return true;
 }
 
+bool DynamicsSolver::getPeakTorques(const std::vector<std::vector<double>>& joint_angles,
+                                    const std::vector<std::vector<double>>& joint_velocities,
+                                    const std::vector<std::vector<double>>& joint_accelerations,
+                                    const std::vector<geometry_msgs::Wrench>& wrenches,
+                                    std::vector<double>& peak_torques) const
+{
+  if (!joint_model_group_)
+  {
+    ROS_DEBUG_NAMED("dynamics_solver", "Did not construct DynamicsSolver object properly. "
+                                       "Check error logs.");
+    return false;
+  }
+  const std::size_t num_waypoints = joint_angles.size();
+  if (joint_velocities.size() != num_waypoints || joint_accelerations.size() != num_waypoints)
+  {
+    ROS_ERROR_NAMED("dynamics_solver", "Joint velocities and accelerations should have one entry per waypoint");
+    return false;
+  }
+  for (std::size_t i = 0; i < num_waypoints; ++i)
+    if (joint_angles[i].size() != num_joints_ || joint_velocities[i].size() != num_joints_ ||
+        joint_accelerations[i].size() != num_joints_)
+    {
+      ROS_ERROR_NAMED("dynamics_solver", "Waypoint %zu vectors should be size %d", i, num_joints_);
+      return false;
+    }
+  if (wrenches.size() != num_segments_)
+  {
+    ROS_ERROR_NAMED("dynamics_solver", "Wrenches vector should be size %d", num_segments_);
+    return false;
+  }
+
+  peak_torques.assign(num_joints_, 0.0);
+  if (num_waypoints == 0)
+    return true;
+
+  KDL::Wrenches kdl_wrenches(num_segments_);
+  for (unsigned int i = 0; i < num_segments_; ++i)
+  {
+    kdl_wrenches[i](0) = wrenches[i].force.x;
+    kdl_wrenches[i](1) = wrenches[i].force.y;
+    kdl_wrenches[i](2) = wrenches[i].force.z;
+
+    kdl_wrenches[i](3) = wrenches[i].torque.x;
+    kdl_wrenches[i](4) = wrenches[i].torque.y;
+    kdl_wrenches[i](5) = wrenches[i].torque.z;
+  }
+
+  moveit::tools::TaskScheduler& scheduler = moveit::tools::TaskScheduler::getInstance();
+  std::size_t n_threads = std::min<std::size_t>(scheduler.getThreadCount(), num_waypoints);
+
+  // The recursive Newton-Euler solver keeps internal state, so every range gets its own solver
+  // instance; all KDL workspaces are allocated once per range instead of once per waypoint
+  std::vector<std::vector<double>> range_peaks(std::max<std::size_t>(n_threads, 1));
+  std::vector<char> range_ok(range_peaks.size(), 1);
+  auto evaluate_range = [this, &joint_angles, &joint_velocities, &joint_accelerations, &kdl_wrenches, &range_peaks,
+                         &range_ok](std::size_t range, std::size_t lo, std::size_t hi) {
+    KDL::ChainIdSolver_RNE solver(kdl_chain_, kdl_gravity_);
+    KDL::JntArray kdl_angles(num_joints_), kdl_velocities(num_joints_), kdl_accelerations(num_joints_),
+        kdl_torques(num_joints_);
+    std::vector<double>& peaks = range_peaks[range];
+    peaks.assign(num_joints_, 0.0);
+    for (std::size_t i = lo; i < hi; ++i)
+    {
+      for (unsigned int j = 0; j < num_joints_; ++j)
+      {
+        kdl_angles(j) = joint_angles[i][j];
+        kdl_velocities(j) = joint_velocities[i][j];
+        kdl_accelerations(j) = joint_accelerations[i][j];
+      }
+      if (solver.CartToJnt(kdl_angles, kdl_velocities, kdl_accelerations, kdl_wrenches, kdl_torques) < 0)
+      {
+        range_ok[range] = 0;
+        return;
+      }
+      for (unsigned int j = 0; j < num_joints_; ++j)
+        peaks[j] = std::max(peaks[j], fabs(kdl_torques(j)));
+    }
+  };
+
+  if (n_threads <= 1 || num_waypoints < 2 * n_threads)
+  {
+    evaluate_range(0, 0, num_waypoints);
+    if (!range_ok[0])
+    {
+      ROS_ERROR_NAMED("dynamics_solver", "Something went wrong computing torques");
+      return false;
+    }
+    peak_torques = range_peaks[0];
+    return true;
+  }
+
+  moveit::tools::TaskScheduler::TaskGroup task_group(scheduler);
+  for (std::size_t t = 0; t < n_threads; ++t)
+  {
+    const std::size_t lo = t * num_waypoints / n_threads;
+    const std::size_t hi = (t + 1) * num_waypoints / n_threads;
+    scheduler.submit(task_group, [evaluate_range, t, lo, hi] { evaluate_range(t, lo, hi); }, "dynamics_solver");
+  }
+  task_group.wait();
+
+  for (std::size_t t = 0; t < n_threads; ++t)
+  {
+    if (!range_ok[t])
+    {
+      ROS_ERROR_NAMED("dynamics_solver", "Something went wrong computing torques");
+      return false;
+    }
+    for (unsigned int j = 0; j < num_joints_; ++j)
+      peak_torques[j] = std::max(peak_torques[j], range_peaks[t][j]);
+  }
+  return true;
+}
+
 bool DynamicsSolver::getMaxPayload(const std::vector<double>& joint_angles, double& payload,
                                    unsigned int& joint_saturated) const
 {
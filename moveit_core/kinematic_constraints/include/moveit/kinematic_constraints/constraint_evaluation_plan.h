@@ -0,0 +1,115 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_KINEMATIC_CONSTRAINTS_CONSTRAINT_EVALUATION_PLAN_
+#define MOVEIT_KINEMATIC_CONSTRAINTS_CONSTRAINT_EVALUATION_PLAN_
+
+#include <moveit/kinematic_constraints/kinematic_constraint.h>
+
+namespace kinematic_constraints
+{
+MOVEIT_CLASS_FORWARD(ConstraintEvaluationPlan);
+
+/**
+ * \brief A flattened evaluation plan compiled from a KinematicConstraintSet.
+ *
+ * Compiling reorders the constraints of the set cheapest-first (joint
+ * constraints, then fixed-frame pose constraints, then mobile-frame pose
+ * constraints, then visibility constraints) so that \ref satisfied can
+ * reject a state after evaluating as few expensive constraints as
+ * possible. For constraints expressed in a mobile frame, the frame name
+ * is resolved to a link of the robot once at compile time, and position
+ * constraint regions are cloned once into the plan, so evaluation does
+ * neither string frame lookups nor per-call allocation.
+ *
+ * The cloned constraint regions are reused as scratch space by every
+ * evaluation, so a plan must not be shared between threads; compile one
+ * plan per thread instead. The KinematicConstraintSet the plan was
+ * compiled from must outlive the plan.
+ */
+class ConstraintEvaluationPlan
+{
+public:
+  ConstraintEvaluationPlan()
+  {
+  }
+
+  /** \brief Flatten \e constraint_set into this plan, replacing any previously compiled plan */
+  void compile(const KinematicConstraintSet& constraint_set);
+
+  /** \brief Evaluate the compiled constraints cheapest-first, stopping at the first violated one.
+      Equivalent to decide(state).satisfied, but does not compute the total constraint distance. */
+  bool satisfied(const robot_state::RobotState& state) const;
+
+  /** \brief Evaluate all compiled constraints; returns the same result as
+      KinematicConstraintSet::decide on the set the plan was compiled from */
+  ConstraintEvaluationResult decide(const robot_state::RobotState& state) const;
+
+  /** \brief Get the number of evaluation steps in the plan */
+  std::size_t getStepCount() const
+  {
+    return steps_.size();
+  }
+
+private:
+  /** \brief How a single constraint is evaluated by the plan */
+  enum StepType
+  {
+    /// Evaluate by calling KinematicConstraint::decide; used for constraints that are
+    /// already free of string lookups and allocations (and as a general fallback)
+    GENERIC,
+    /// Mobile-frame position constraint with a prebound frame link and pre-cloned regions
+    POSITION_MOBILE,
+    /// Mobile-frame orientation constraint with a prebound frame link
+    ORIENTATION_MOBILE
+  };
+
+  struct Step
+  {
+    StepType type_;
+    /// The constraint this step evaluates; shared with the constraint set
+    KinematicConstraintConstPtr constraint_;
+    /// The robot link the mobile reference frame resolved to
+    const robot_model::LinkModel* frame_link_;
+    /// Scratch clones of the constraint regions, posed in place on every evaluation
+    std::vector<bodies::BodyPtr> scratch_regions_;
+  };
+
+  ConstraintEvaluationResult evaluateStep(const Step& step, const robot_state::RobotState& state) const;
+
+  std::vector<Step> steps_;
+};
+}
+
+#endif
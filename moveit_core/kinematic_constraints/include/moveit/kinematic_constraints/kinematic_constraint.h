@@ -613,6 +613,17 @@ public:
     return constraint_region_;
   }
 
+  /**
+   * \brief Returns the poses of all the constraint regions, in the reference frame
+   *
+   *
+   * @return The constraint region poses
+   */
+  const EigenSTL::vector_Isometry3d& getConstraintRegionPoses() const
+  {
+    return constraint_region_pose_;
+  }
+
   /**
    * \brief Returns the reference frame
    *
@@ -1042,6 +1053,28 @@ public:
     return all_constraints_;
   }
 
+  /**
+   * \brief Get the constraint objects in the set, in the order they were added
+   *
+   *
+   * @return The constraint objects
+   */
+  const std::vector<KinematicConstraintPtr>& getKinematicConstraints() const
+  {
+    return kinematic_constraints_;
+  }
+
+  /**
+   * \brief Get the robot model the constraints are evaluated for
+   *
+   *
+   * @return The robot model
+   */
+  const robot_model::RobotModelConstPtr& getRobotModel() const
+  {
+    return robot_model_;
+  }
+
   /**
    * \brief Returns whether or not there are any constraints in the set
    *
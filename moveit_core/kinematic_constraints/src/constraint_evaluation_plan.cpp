@@ -0,0 +1,200 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/kinematic_constraints/constraint_evaluation_plan.h>
+#include <boost/math/constants/constants.hpp>
+#include <algorithm>
+
+namespace kinematic_constraints
+{
+namespace
+{
+// relative evaluation cost of a constraint, used to order the plan cheapest-first
+int evaluationCost(const KinematicConstraint& constraint, bool mobile_frame)
+{
+  switch (constraint.getType())
+  {
+    case KinematicConstraint::JOINT_CONSTRAINT:
+      return 0;
+    case KinematicConstraint::POSITION_CONSTRAINT:
+    case KinematicConstraint::ORIENTATION_CONSTRAINT:
+      return mobile_frame ? 2 : 1;
+    default:
+      // visibility constraints run a collision check
+      return 3;
+  }
+}
+
+// resolve a mobile reference frame to a link of the robot, the way
+// RobotState::getFrameTransform would; returns NULL if the frame is not a link
+// (e.g. an attached body), in which case the constraint is evaluated generically
+const robot_model::LinkModel* resolveFrameLink(const robot_model::RobotModelConstPtr& robot_model,
+                                               const std::string& frame_id)
+{
+  if (!frame_id.empty() && frame_id[0] == '/')
+    return resolveFrameLink(robot_model, frame_id.substr(1));
+  if (robot_model->hasLinkModel(frame_id))
+    return robot_model->getLinkModel(frame_id);
+  return nullptr;
+}
+}
+
+void ConstraintEvaluationPlan::compile(const KinematicConstraintSet& constraint_set)
+{
+  steps_.clear();
+  const std::vector<KinematicConstraintPtr>& constraints = constraint_set.getKinematicConstraints();
+  steps_.reserve(constraints.size());
+  std::vector<int> costs;
+  costs.reserve(constraints.size());
+
+  for (const KinematicConstraintPtr& constraint : constraints)
+  {
+    Step step;
+    step.type_ = GENERIC;
+    step.constraint_ = constraint;
+    step.frame_link_ = nullptr;
+
+    bool mobile_frame = false;
+    if (constraint->getType() == KinematicConstraint::POSITION_CONSTRAINT)
+    {
+      const PositionConstraint* pc = static_cast<const PositionConstraint*>(constraint.get());
+      mobile_frame = pc->mobileReferenceFrame();
+      if (mobile_frame)
+      {
+        step.frame_link_ = resolveFrameLink(constraint_set.getRobotModel(), pc->getReferenceFrame());
+        if (step.frame_link_)
+        {
+          // clone the constraint regions once, so evaluation can pose them in
+          // place instead of cloning per call
+          const std::vector<bodies::BodyPtr>& regions = pc->getConstraintRegions();
+          step.scratch_regions_.reserve(regions.size());
+          for (const bodies::BodyPtr& region : regions)
+            step.scratch_regions_.push_back(region->cloneAt(region->getPose()));
+          step.type_ = POSITION_MOBILE;
+        }
+      }
+    }
+    else if (constraint->getType() == KinematicConstraint::ORIENTATION_CONSTRAINT)
+    {
+      const OrientationConstraint* oc = static_cast<const OrientationConstraint*>(constraint.get());
+      mobile_frame = oc->mobileReferenceFrame();
+      if (mobile_frame)
+      {
+        step.frame_link_ = resolveFrameLink(constraint_set.getRobotModel(), oc->getReferenceFrame());
+        if (step.frame_link_)
+          step.type_ = ORIENTATION_MOBILE;
+      }
+    }
+
+    costs.push_back(evaluationCost(*constraint, mobile_frame));
+    steps_.push_back(std::move(step));
+  }
+
+  // order cheapest-first, keeping the original order among constraints of equal cost
+  std::vector<std::size_t> order(steps_.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&costs](std::size_t a, std::size_t b) { return costs[a] < costs[b]; });
+  std::vector<Step> ordered;
+  ordered.reserve(steps_.size());
+  for (std::size_t i : order)
+    ordered.push_back(std::move(steps_[i]));
+  steps_.swap(ordered);
+}
+
+ConstraintEvaluationResult ConstraintEvaluationPlan::evaluateStep(const Step& step,
+                                                                  const robot_state::RobotState& state) const
+{
+  switch (step.type_)
+  {
+    case POSITION_MOBILE:
+    {
+      const PositionConstraint* pc = static_cast<const PositionConstraint*>(step.constraint_.get());
+      Eigen::Vector3d pt = state.getGlobalLinkTransform(pc->getLinkModel()) * pc->getLinkOffset();
+      // the frame transform is the same for all regions, so look it up once
+      const Eigen::Isometry3d& frame_transform = state.getGlobalLinkTransform(step.frame_link_);
+      const EigenSTL::vector_Isometry3d& poses = pc->getConstraintRegionPoses();
+      for (std::size_t i = 0; i < step.scratch_regions_.size(); ++i)
+      {
+        Eigen::Isometry3d tmp = frame_transform * poses[i];
+        step.scratch_regions_[i]->setPose(tmp);
+        bool result = step.scratch_regions_[i]->containsPoint(pt);
+        if (result || (i + 1 == step.scratch_regions_.size()))
+          return ConstraintEvaluationResult(result, pc->getConstraintWeight() * (tmp.translation() - pt).norm());
+      }
+      return ConstraintEvaluationResult(false, 0.0);
+    }
+    case ORIENTATION_MOBILE:
+    {
+      const OrientationConstraint* oc = static_cast<const OrientationConstraint*>(step.constraint_.get());
+      Eigen::Matrix3d tmp =
+          state.getGlobalLinkTransform(step.frame_link_).rotation() * oc->getDesiredRotationMatrix();
+      Eigen::Isometry3d diff(tmp.transpose() * state.getGlobalLinkTransform(oc->getLinkModel()).rotation());
+      // 0,1,2 corresponds to XYZ, the convention used in sampling constraints
+      Eigen::Vector3d xyz = diff.rotation().eulerAngles(0, 1, 2);
+      xyz(0) = std::min(fabs(xyz(0)), boost::math::constants::pi<double>() - fabs(xyz(0)));
+      xyz(1) = std::min(fabs(xyz(1)), boost::math::constants::pi<double>() - fabs(xyz(1)));
+      xyz(2) = std::min(fabs(xyz(2)), boost::math::constants::pi<double>() - fabs(xyz(2)));
+      bool result = xyz(2) < oc->getZAxisTolerance() + std::numeric_limits<double>::epsilon() &&
+                    xyz(1) < oc->getYAxisTolerance() + std::numeric_limits<double>::epsilon() &&
+                    xyz(0) < oc->getXAxisTolerance() + std::numeric_limits<double>::epsilon();
+      return ConstraintEvaluationResult(result, oc->getConstraintWeight() * (xyz(0) + xyz(1) + xyz(2)));
+    }
+    default:
+      return step.constraint_->decide(state);
+  }
+}
+
+bool ConstraintEvaluationPlan::satisfied(const robot_state::RobotState& state) const
+{
+  for (const Step& step : steps_)
+    if (!evaluateStep(step, state).satisfied)
+      return false;
+  return true;
+}
+
+ConstraintEvaluationResult ConstraintEvaluationPlan::decide(const robot_state::RobotState& state) const
+{
+  ConstraintEvaluationResult res(true, 0.0);
+  for (const Step& step : steps_)
+  {
+    ConstraintEvaluationResult r = evaluateStep(step, state);
+    if (!r.satisfied)
+      res.satisfied = false;
+    res.distance += r.distance;
+  }
+  return res;
+}
+}  // end of namespace kinematic_constraints
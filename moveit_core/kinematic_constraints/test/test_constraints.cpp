@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan, E. Gil Jones */
 
 #include <moveit/kinematic_constraints/kinematic_constraint.h>
+#include <moveit/kinematic_constraints/constraint_evaluation_plan.h>
 #include <gtest/gtest.h>
 #include <urdf_parser/urdf_parser.h>
 #include <fstream>
@@ -924,6 +925,83 @@ TEST_F(LoadPlanningModelsPr2, TestKinematicConstraintSetEquality)
   EXPECT_TRUE(kcs2.equal(kcs, .1));
 }
 
+TEST_F(LoadPlanningModelsPr2, TestConstraintEvaluationPlan)
+{
+  robot_state::RobotState robot_state(robot_model_);
+  robot_state.setToDefaultValues();
+  robot_state.update();
+  robot_state::Transforms tf(robot_model_->getModelFrame());
+
+  kinematic_constraints::KinematicConstraintSet kcs(robot_model_);
+
+  moveit_msgs::JointConstraint jcm;
+  jcm.joint_name = "head_pan_joint";
+  jcm.position = 0.4;
+  jcm.tolerance_above = 0.1;
+  jcm.tolerance_below = 0.05;
+  jcm.weight = 1.0;
+  std::vector<moveit_msgs::JointConstraint> jcv;
+  jcv.push_back(jcm);
+  EXPECT_TRUE(kcs.add(jcv));
+
+  // a position constraint in a mobile frame, so the plan prebinds the frame link
+  moveit_msgs::PositionConstraint pcm;
+  pcm.link_name = "l_wrist_roll_link";
+  pcm.target_point_offset.x = 0;
+  pcm.target_point_offset.y = 0;
+  pcm.target_point_offset.z = 0;
+  pcm.constraint_region.primitives.resize(1);
+  pcm.constraint_region.primitives[0].type = shape_msgs::SolidPrimitive::SPHERE;
+  pcm.constraint_region.primitives[0].dimensions.resize(1);
+  pcm.constraint_region.primitives[0].dimensions[0] = 0.38 * 2.0;
+  pcm.header.frame_id = "r_wrist_roll_link";
+  pcm.constraint_region.primitive_poses.resize(1);
+  pcm.constraint_region.primitive_poses[0].position.x = 0.0;
+  pcm.constraint_region.primitive_poses[0].position.y = 0.6;
+  pcm.constraint_region.primitive_poses[0].position.z = 0.0;
+  pcm.constraint_region.primitive_poses[0].orientation.w = 1.0;
+  pcm.weight = 1.0;
+  std::vector<moveit_msgs::PositionConstraint> pcv;
+  pcv.push_back(pcm);
+  EXPECT_TRUE(kcs.add(pcv, tf));
+
+  // an orientation constraint in a mobile frame
+  moveit_msgs::OrientationConstraint ocm;
+  ocm.link_name = "l_wrist_roll_link";
+  ocm.header.frame_id = "r_wrist_roll_link";
+  ocm.orientation.w = 1.0;
+  ocm.absolute_x_axis_tolerance = 0.5;
+  ocm.absolute_y_axis_tolerance = 0.5;
+  ocm.absolute_z_axis_tolerance = 3.15;
+  ocm.weight = 1.0;
+  std::vector<moveit_msgs::OrientationConstraint> ocv;
+  ocv.push_back(ocm);
+  EXPECT_TRUE(kcs.add(ocv, tf));
+
+  kinematic_constraints::ConstraintEvaluationPlan plan;
+  plan.compile(kcs);
+  EXPECT_EQ(3u, plan.getStepCount());
+
+  // the plan must agree with the set in a variety of states
+  std::map<std::string, double> jvals;
+  const double pan_values[] = { 0.0, 0.41, 0.51 };
+  const double shoulder_values[] = { -0.4, 0.0, 0.4 };
+  for (double pan : pan_values)
+    for (double shoulder : shoulder_values)
+    {
+      jvals["head_pan_joint"] = pan;
+      jvals["l_shoulder_pan_joint"] = shoulder;
+      robot_state.setVariablePositions(jvals);
+      robot_state.update();
+
+      kinematic_constraints::ConstraintEvaluationResult expected = kcs.decide(robot_state);
+      kinematic_constraints::ConstraintEvaluationResult actual = plan.decide(robot_state);
+      EXPECT_EQ(expected.satisfied, actual.satisfied);
+      EXPECT_NEAR(expected.distance, actual.distance, 1e-9);
+      EXPECT_EQ(expected.satisfied, plan.satisfied(robot_state));
+    }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -102,6 +102,19 @@ enum KinematicError
 }
 typedef KinematicErrors::KinematicError KinematicError;
 
+/** @brief Signature for a cheap validity pre-filter run on candidate IK solutions before the expensive
+    state validity callback. The solution is given in the order expected by the joint model group. Return
+    false to reject the candidate; the solver then continues searching without the full validity check
+    ever running. The state passed in has not yet been updated with the candidate values. */
+typedef boost::function<bool(moveit::core::RobotState* state, const moveit::core::JointModelGroup* group,
+                             const double* solution)>
+    IKSolutionPrefilterFn;
+
+/** @brief Signature for a cheap feasibility pre-filter run on each IK query pose (expressed in the solver
+    base frame) before the solver is invoked. Return false to fail the query immediately, e.g. when a
+    workspace reachability map shows the pose cannot be reached by any configuration. */
+typedef boost::function<bool(const geometry_msgs::Pose& pose)> IKPosePrefilterFn;
+
 /**
  * @struct KinematicsQueryOptions
  * @brief A set of options for the kinematics solver
@@ -112,6 +125,7 @@ struct KinematicsQueryOptions
     : lock_redundant_joints(false)
     , return_approximate_solution(false)
     , discretization_method(DiscretizationMethods::NO_DISCRETIZATION)
+    , joint_limit_margin(0.0)
   {
   }
 
@@ -119,6 +133,13 @@ struct KinematicsQueryOptions
   bool return_approximate_solution;           /**<  KinematicsQueryOptions#return_approximate_solution. */
   DiscretizationMethod discretization_method; /**< Enumeration value that indicates the method for discretizing the
                                                  redundant. joints KinematicsQueryOptions#discretization_method. */
+  double joint_limit_margin;                  /**< If positive, candidate solutions closer than this margin to any
+                                                 position limit are rejected before the validity callback runs.
+                                                 0 (the default) disables the check. */
+  IKSolutionPrefilterFn solution_prefilter;   /**< Optional cheap pre-filter run on every candidate solution before
+                                                 the expensive validity callback. */
+  IKPosePrefilterFn pose_prefilter;           /**< Optional cheap pre-filter run on every query pose before the
+                                                 solver is invoked. */
 };
 
 /*
@@ -321,6 +342,26 @@ public:
     return false;
   }
 
+  /**
+   * @brief Solve a batch of independent IK queries, each consisting of one desired pose for the tip link and one seed
+   * state.
+   *
+   * This default implementation calls searchPositionIK() once per query. Solvers may override it to share solver
+   * workspace between the queries of a batch or to exploit locality between them.
+   *
+   * @param ik_poses the desired pose of the tip link, one per query
+   * @param ik_seed_states an initial guess solution for each query
+   * @param timeout The amount of time (in seconds) available to the solver for each query
+   * @param solutions the solution vector for each query; the entries of failed queries are left empty
+   * @param error_codes an error code for each query, encoding the reason for its failure or success
+   * @return True if a valid solution was found for at least one query
+   */
+  virtual bool searchPositionIKBatch(
+      const std::vector<geometry_msgs::Pose>& ik_poses, const std::vector<std::vector<double> >& ik_seed_states,
+      double timeout, std::vector<std::vector<double> >& solutions,
+      std::vector<moveit_msgs::MoveItErrorCodes>& error_codes,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const;
+
   /**
    * @brief Given a set of joint angles and a set of links, compute their pose
    * @param link_names A set of links for which FK needs to be computed
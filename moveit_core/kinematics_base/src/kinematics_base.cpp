@@ -48,6 +48,33 @@ static void noDeleter(const moveit::core::RobotModel*)
 {
 }
 
+bool KinematicsBase::searchPositionIKBatch(const std::vector<geometry_msgs::Pose>& ik_poses,
+                                           const std::vector<std::vector<double> >& ik_seed_states, double timeout,
+                                           std::vector<std::vector<double> >& solutions,
+                                           std::vector<moveit_msgs::MoveItErrorCodes>& error_codes,
+                                           const kinematics::KinematicsQueryOptions& options) const
+{
+  if (ik_poses.size() != ik_seed_states.size())
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Number of seed states (%zu) does not match number of poses (%zu)", ik_seed_states.size(),
+                    ik_poses.size());
+    return false;
+  }
+
+  solutions.resize(ik_poses.size());
+  error_codes.resize(ik_poses.size());
+  bool any_solved = false;
+  for (std::size_t i = 0; i < ik_poses.size(); ++i)
+  {
+    solutions[i].clear();
+    if (searchPositionIK(ik_poses[i], ik_seed_states[i], timeout, solutions[i], error_codes[i], options))
+      any_solved = true;
+    else
+      solutions[i].clear();
+  }
+  return any_solved;
+}
+
 void KinematicsBase::storeValues(const moveit::core::RobotModel& robot_model, const std::string& group_name,
                                  const std::string& base_frame, const std::vector<std::string>& tip_frames,
                                  double search_discretization)
@@ -0,0 +1,132 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Author: Sachin Chitta */
+
+#ifndef MOVEIT_KINEMATICS_CONSTRAINT_AWARE_
+#define MOVEIT_KINEMATICS_CONSTRAINT_AWARE_
+
+#include <moveit_msgs/GetConstraintAwarePositionIK.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/kinematics_constraint_aware/kinematics_request_response.h>
+
+namespace kinematics_constraint_aware
+{
+MOVEIT_CLASS_FORWARD(KinematicsConstraintAware);
+
+/** @brief Constraint-aware inverse kinematics for a group.
+ *
+ * A solve explores several IK seeds in parallel: one worker starts from the
+ * requested seed state, the others from random configurations, and each
+ * candidate solution is validated against the constraints of the request
+ * (evaluated through a per-thread compiled constraint plan) and, optionally,
+ * collision with the planning scene. Valid solutions are collected in a
+ * priority queue ordered by distance to the seed state; the first valid
+ * solution terminates the search early and the best solution found by then
+ * is returned. */
+class KinematicsConstraintAware
+{
+public:
+  /** @brief Construct a solver for a group
+   * @param robot_model An instance of a robot model
+   * @param group_name The name of the group to configure this solver for
+   */
+  KinematicsConstraintAware(const robot_model::RobotModelConstPtr& robot_model, const std::string& group_name);
+
+  /** @brief Solve the constraint-aware IK problem
+   * @param planning_scene A const reference to the planning scene
+   * @param request A const reference to the kinematics request
+   * @param response The solution (if it exists)
+   * @return False if group_name is invalid or ik fails
+   */
+  bool getIK(const planning_scene::PlanningSceneConstPtr& planning_scene,
+             const kinematics_constraint_aware::KinematicsRequest& request,
+             kinematics_constraint_aware::KinematicsResponse& response) const;
+
+  /** @brief Solve the constraint-aware IK problem specified as a service request
+   * @param planning_scene A const reference to the planning scene
+   * @param request A const reference to the kinematics service request
+   * @param response The solution (if it exists)
+   * @return False if group_name is invalid or ik fails
+   */
+  bool getIK(const planning_scene::PlanningSceneConstPtr& planning_scene,
+             const moveit_msgs::GetConstraintAwarePositionIK::Request& request,
+             moveit_msgs::GetConstraintAwarePositionIK::Response& response) const;
+
+  const std::string& getGroupName() const
+  {
+    return group_name_;
+  }
+
+  const robot_model::RobotModelConstPtr& getRobotModel() const
+  {
+    return robot_model_;
+  }
+
+  /** @brief Set the number of seed worker threads used by a solve (0 selects the hardware concurrency) */
+  void setNumThreads(unsigned int num_threads)
+  {
+    num_threads_ = num_threads;
+  }
+
+  unsigned int getNumThreads() const
+  {
+    return num_threads_;
+  }
+
+private:
+  /** @brief Transform the requested poses to \e target_frame, resolving the pose headers with the scene */
+  EigenSTL::vector_Isometry3d transformPoses(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                             const robot_state::RobotState& kinematic_state,
+                                             const std::vector<geometry_msgs::PoseStamped>& poses,
+                                             const std::string& target_frame) const;
+
+  bool convertServiceRequest(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                             const moveit_msgs::GetConstraintAwarePositionIK::Request& request,
+                             kinematics_constraint_aware::KinematicsRequest& kinematics_request,
+                             kinematics_constraint_aware::KinematicsResponse& kinematics_response) const;
+
+  robot_model::RobotModelConstPtr robot_model_;
+
+  const robot_model::JointModelGroup* joint_model_group_;
+
+  std::string group_name_;
+
+  unsigned int num_threads_;
+};
+}
+
+#endif
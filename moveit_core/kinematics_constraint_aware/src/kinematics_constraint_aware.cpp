@@ -0,0 +1,360 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Author: Sachin Chitta */
+
+#include <moveit/kinematics_constraint_aware/kinematics_constraint_aware.h>
+#include <moveit/kinematic_constraints/constraint_evaluation_plan.h>
+#include <moveit/robot_state/conversions.h>
+#include <tf2_eigen/tf2_eigen.h>
+#include <ros/console.h>
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace kinematics_constraint_aware
+{
+static const std::string LOGNAME = "kinematics_constraint_aware";
+
+// the time budget used when the request does not specify one
+static const double DEFAULT_TIMEOUT = 1.0;
+
+// workers solve in slices of this length so they can notice early termination
+static const double SEED_TIMEOUT_SLICE = 0.05;
+
+namespace
+{
+struct Solution
+{
+  double distance_to_seed_;
+  std::vector<double> positions_;
+
+  bool operator>(const Solution& other) const
+  {
+    return distance_to_seed_ > other.distance_to_seed_;
+  }
+};
+}
+
+KinematicsConstraintAware::KinematicsConstraintAware(const robot_model::RobotModelConstPtr& robot_model,
+                                                     const std::string& group_name)
+  : robot_model_(robot_model), joint_model_group_(NULL), group_name_(group_name), num_threads_(0)
+{
+  if (!robot_model_->hasJointModelGroup(group_name))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "The group %s does not exist", group_name.c_str());
+    return;
+  }
+  joint_model_group_ = robot_model_->getJointModelGroup(group_name);
+  if (!joint_model_group_->getSolverInstance())
+  {
+    // groups without their own solver are usable if all their sub-groups can solve IK
+    const std::vector<std::string>& sub_groups_names = joint_model_group_->getSubgroupNames();
+    if (sub_groups_names.empty())
+    {
+      ROS_ERROR_NAMED(LOGNAME, "No kinematics solver instance defined for group %s", group_name.c_str());
+      joint_model_group_ = NULL;
+      return;
+    }
+    for (std::size_t i = 0; i < sub_groups_names.size(); ++i)
+      if (!robot_model_->getJointModelGroup(sub_groups_names[i])->getSolverInstance())
+      {
+        ROS_ERROR_NAMED(LOGNAME, "No kinematics solver instance defined for group %s (needed for group %s)",
+                        sub_groups_names[i].c_str(), group_name.c_str());
+        joint_model_group_ = NULL;
+        return;
+      }
+  }
+}
+
+bool KinematicsConstraintAware::getIK(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                      const kinematics_constraint_aware::KinematicsRequest& request,
+                                      kinematics_constraint_aware::KinematicsResponse& response) const
+{
+  if (!joint_model_group_)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "This solver has not been constructed properly");
+    return false;
+  }
+
+  if (!planning_scene)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Planning scene must be allocated");
+    return false;
+  }
+
+  if (request.group_name_ != group_name_)
+  {
+    response.error_code_.val = response.error_code_.INVALID_GROUP_NAME;
+    return false;
+  }
+
+  if (request.pose_stamped_vector_.empty())
+  {
+    ROS_ERROR_NAMED(LOGNAME, "No goal poses specified");
+    response.error_code_.val = response.error_code_.INVALID_GOAL_CONSTRAINTS;
+    return false;
+  }
+
+  if (!request.ik_link_names_.empty() && request.ik_link_names_.size() != request.pose_stamped_vector_.size())
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Number of ik_link_names in request: %d must match number of poses: %d or must be zero",
+                    (int)request.ik_link_names_.size(), (int)request.pose_stamped_vector_.size());
+    response.error_code_.val = response.error_code_.INVALID_LINK_NAME;
+    return false;
+  }
+
+  if (request.ik_link_names_.empty() && request.pose_stamped_vector_.size() > 1)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Requests with multiple poses must name the ik links the poses are for");
+    response.error_code_.val = response.error_code_.INVALID_LINK_NAME;
+    return false;
+  }
+
+  if (!response.solution_)
+    response.solution_.reset(new robot_state::RobotState(planning_scene->getCurrentState()));
+
+  const robot_state::RobotState& seed_state =
+      request.robot_state_ ? *request.robot_state_ : planning_scene->getCurrentState();
+
+  // Transform the requests to the base frame of the kinematic model
+  EigenSTL::vector_Isometry3d goals =
+      transformPoses(planning_scene, seed_state, request.pose_stamped_vector_, robot_model_->getModelFrame());
+
+  double timeout = request.timeout_.toSec();
+  if (timeout <= 0.0)
+    timeout = DEFAULT_TIMEOUT;
+  const ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(timeout);
+
+  unsigned int n_threads = num_threads_;
+  if (n_threads == 0)
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  // valid solutions, best (closest to the seed state) on top
+  std::priority_queue<Solution, std::vector<Solution>, std::greater<Solution> > solutions;
+  std::mutex solutions_lock;
+  std::atomic<bool> found(false);
+
+  // the broadphase managers of the scene are not safe for concurrent queries, so candidate
+  // solutions (which are rare compared to IK iterations) are collision checked one at a time
+  std::mutex collision_lock;
+
+  auto seed_worker = [&](unsigned int worker_index) {
+    robot_state::RobotState state(seed_state);
+
+    // compiled constraint plans hold per-evaluation scratch space, so each worker compiles its own
+    kinematic_constraints::ConstraintEvaluationPlan constraint_plan;
+    bool have_constraints = false;
+    if (request.constraints_)
+    {
+      constraint_plan.compile(*request.constraints_);
+      have_constraints = constraint_plan.getStepCount() > 0;
+    }
+
+    robot_state::GroupStateValidityCallbackFn validity_fn = [&](robot_state::RobotState* solution_state,
+                                                                const robot_model::JointModelGroup* group,
+                                                                const double* joint_group_variable_values) {
+      solution_state->setJointGroupPositions(group, joint_group_variable_values);
+      solution_state->update();
+
+      if (have_constraints && !constraint_plan.satisfied(*solution_state))
+        return false;
+
+      if (request.check_for_collisions_)
+      {
+        collision_detection::CollisionRequest collision_request;
+        collision_detection::CollisionResult collision_result;
+        collision_request.group_name = group_name_;
+        std::lock_guard<std::mutex> slock(collision_lock);
+        planning_scene->checkCollision(collision_request, collision_result, *solution_state);
+        if (collision_result.collision)
+          return false;
+      }
+
+      if (request.constraint_callback_ &&
+          !request.constraint_callback_(solution_state, group, joint_group_variable_values))
+        return false;
+
+      return true;
+    };
+
+    bool first_iteration = true;
+    while (!found.load(std::memory_order_relaxed))
+    {
+      const double time_left = (deadline - ros::WallTime::now()).toSec();
+      if (time_left <= 0.0)
+        break;
+
+      // the first worker starts at the requested seed; everything else explores random seeds
+      if (worker_index == 0 && first_iteration)
+        state = seed_state;
+      else
+        state.setToRandomPositions(joint_model_group_);
+      first_iteration = false;
+
+      bool solved;
+      if (request.ik_link_names_.empty())
+        solved = state.setFromIK(joint_model_group_, goals[0], 1, std::min(time_left, SEED_TIMEOUT_SLICE), validity_fn);
+      else
+        solved = state.setFromIK(joint_model_group_, goals, request.ik_link_names_, 1,
+                                 std::min(time_left, SEED_TIMEOUT_SLICE), validity_fn);
+
+      if (solved)
+      {
+        Solution solution;
+        solution.distance_to_seed_ = state.distance(seed_state, joint_model_group_);
+        state.copyJointGroupPositions(joint_model_group_, solution.positions_);
+        std::lock_guard<std::mutex> slock(solutions_lock);
+        solutions.push(solution);
+        found.store(true, std::memory_order_relaxed);
+        break;
+      }
+    }
+  };
+
+  if (n_threads == 1)
+    seed_worker(0);
+  else
+  {
+    std::vector<std::thread> workers;
+    workers.reserve(n_threads);
+    for (unsigned int t = 0; t < n_threads; ++t)
+      workers.emplace_back(seed_worker, t);
+    for (std::size_t t = 0; t < workers.size(); ++t)
+      workers[t].join();
+  }
+
+  if (solutions.empty())
+  {
+    response.error_code_.val = response.error_code_.NO_IK_SOLUTION;
+    response.result_ = false;
+    return false;
+  }
+
+  response.solution_->setJointGroupPositions(joint_model_group_, solutions.top().positions_);
+  response.solution_->update();
+  response.error_code_.val = response.error_code_.SUCCESS;
+  response.result_ = true;
+  return true;
+}
+
+bool KinematicsConstraintAware::getIK(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                      const moveit_msgs::GetConstraintAwarePositionIK::Request& request,
+                                      moveit_msgs::GetConstraintAwarePositionIK::Response& response) const
+{
+  if (!joint_model_group_)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "This solver has not been constructed properly");
+    return false;
+  }
+
+  if (!planning_scene)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Planning scene must be allocated");
+    return false;
+  }
+
+  kinematics_constraint_aware::KinematicsRequest kinematics_request;
+  kinematics_constraint_aware::KinematicsResponse kinematics_response;
+
+  if (!convertServiceRequest(planning_scene, request, kinematics_request, kinematics_response))
+  {
+    response.error_code = kinematics_response.error_code_;
+    return false;
+  }
+
+  bool result = getIK(planning_scene, kinematics_request, kinematics_response);
+  response.error_code = kinematics_response.error_code_;
+  if (kinematics_response.solution_)
+    robot_state::robotStateToRobotStateMsg(*kinematics_response.solution_, response.solution);
+  return result;
+}
+
+bool KinematicsConstraintAware::convertServiceRequest(
+    const planning_scene::PlanningSceneConstPtr& planning_scene,
+    const moveit_msgs::GetConstraintAwarePositionIK::Request& request,
+    kinematics_constraint_aware::KinematicsRequest& kinematics_request,
+    kinematics_constraint_aware::KinematicsResponse& kinematics_response) const
+{
+  if (request.ik_request.group_name != group_name_)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "This kinematics solver does not support requests for group: %s",
+                    request.ik_request.group_name.c_str());
+    kinematics_response.error_code_.val = kinematics_response.error_code_.INVALID_GROUP_NAME;
+    return false;
+  }
+
+  if (request.ik_request.ik_link_names.empty() && request.ik_request.ik_link_name != "")
+    kinematics_request.ik_link_names_.push_back(request.ik_request.ik_link_name);
+  else
+    kinematics_request.ik_link_names_ = request.ik_request.ik_link_names;
+
+  if (request.ik_request.pose_stamped_vector.empty())
+    kinematics_request.pose_stamped_vector_.push_back(request.ik_request.pose_stamped);
+  else
+    kinematics_request.pose_stamped_vector_ = request.ik_request.pose_stamped_vector;
+
+  kinematics_request.robot_state_.reset(new robot_state::RobotState(planning_scene->getCurrentState()));
+  robot_state::robotStateMsgToRobotState(request.ik_request.robot_state, *kinematics_request.robot_state_);
+  kinematics_request.constraints_.reset(new kinematic_constraints::KinematicConstraintSet(robot_model_));
+  kinematics_request.constraints_->add(request.constraints, planning_scene->getTransforms());
+  kinematics_request.timeout_ = request.ik_request.timeout;
+  kinematics_request.group_name_ = request.ik_request.group_name;
+  kinematics_request.check_for_collisions_ = true;
+
+  kinematics_response.solution_.reset(new robot_state::RobotState(planning_scene->getCurrentState()));
+
+  return true;
+}
+
+EigenSTL::vector_Isometry3d KinematicsConstraintAware::transformPoses(
+    const planning_scene::PlanningSceneConstPtr& planning_scene, const robot_state::RobotState& kinematic_state,
+    const std::vector<geometry_msgs::PoseStamped>& poses, const std::string& target_frame) const
+{
+  Eigen::Isometry3d eigen_pose;
+  EigenSTL::vector_Isometry3d result(poses.size());
+  bool target_frame_is_root_frame = (target_frame == kinematic_state.getRobotModel()->getModelFrame());
+  for (std::size_t i = 0; i < poses.size(); ++i)
+  {
+    tf2::fromMsg(poses[i].pose, eigen_pose);
+    eigen_pose = planning_scene->getFrameTransform(kinematic_state, poses[i].header.frame_id) * eigen_pose;
+    if (!target_frame_is_root_frame)
+      eigen_pose = planning_scene->getFrameTransform(kinematic_state, target_frame).inverse() * eigen_pose;
+    result[i] = eigen_pose;
+  }
+  return result;
+}
+}
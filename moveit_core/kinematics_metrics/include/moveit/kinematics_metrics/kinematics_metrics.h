@@ -79,6 +79,50 @@ public:
                               const robot_model::JointModelGroup* joint_model_group, double& manipulability_index,
                               bool translation = false) const;
 
+  /**
+   * @brief Get the manipulability for a given group without computing singular values.
+   * sqrt(det(JJ^T)) is obtained through a Cholesky factorization of the smaller Gram matrix of the
+   * Jacobian, which is considerably cheaper than the SVD behind getManipulabilityIndex() and yields
+   * the same value, except that rank-deficient configurations report exactly 0 instead of a tiny
+   * product of singular values. Use this where the exact singular values are not needed.
+   * @param state Complete kinematic state for the robot
+   * @param group_name The group name (e.g. "arm")
+   * @param manipulability_index The computed manipulability = sqrt(det(JJ^T))
+   * @return False if the group was not found
+   */
+  bool getManipulabilityIndexCholesky(const robot_state::RobotState& state, const std::string& group_name,
+                                      double& manipulability_index, bool translation = false) const;
+
+  /**
+   * @brief Get the manipulability for a given group without computing singular values.
+   * @copydetails getManipulabilityIndexCholesky(const robot_state::RobotState&, const std::string&, double&, bool)
+   * const
+   * @param state Complete kinematic state for the robot
+   * @param joint_model_group A pointer to the desired joint model group
+   * @param manipulability_index The computed manipulability = sqrt(det(JJ^T))
+   * @return False if the group was not found
+   */
+  bool getManipulabilityIndexCholesky(const robot_state::RobotState& state,
+                                      const robot_model::JointModelGroup* joint_model_group,
+                                      double& manipulability_index, bool translation = false) const;
+
+  /**
+   * @brief Evaluate the manipulability index for a batch of states, distributing the states across
+   * the process-wide task scheduler. Each worker reuses a single Jacobian workspace for its whole
+   * range instead of allocating one per state. All states must already be updated
+   * (RobotState::update()); states whose Jacobian cannot be computed report a manipulability of 0.
+   * @param states The states to evaluate
+   * @param joint_model_group A pointer to the desired joint model group
+   * @param manipulability_indices The computed manipulability, one entry per input state
+   * @param translation Whether to consider only the translation part of the Jacobian
+   * @param use_cholesky Compute sqrt(det(JJ^T)) by Cholesky factorization instead of singular values
+   * @return False if the group was not found
+   */
+  bool getManipulabilityIndex(const std::vector<robot_state::RobotState>& states,
+                              const robot_model::JointModelGroup* joint_model_group,
+                              std::vector<double>& manipulability_indices, bool translation = false,
+                              bool use_cholesky = true) const;
+
   /**
    * @brief Get the (translation) manipulability ellipsoid for a given group at a given joint configuration
    * @param state Complete kinematic state for the robot
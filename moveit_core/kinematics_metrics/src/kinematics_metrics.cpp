@@ -35,12 +35,46 @@
 /* Author: Sachin Chitta */
 
 #include <moveit/kinematics_metrics/kinematics_metrics.h>
+#include <moveit/utils/task_scheduler.h>
 #include <Eigen/Dense>
 #include <Eigen/Eigenvalues>
 #include <boost/math/constants/constants.hpp>
+#include <algorithm>
 
 namespace kinematics_metrics
 {
+namespace
+{
+/** sqrt(det(JJ^T)) via a Cholesky factorization of the smaller Gram matrix of the Jacobian; equal
+    to the product of the singular values, but without computing them. Rank-deficient Jacobians
+    (singular configurations) yield 0. */
+double manipulabilityFromGram(const Eigen::Ref<const Eigen::MatrixXd>& jacobian)
+{
+  Eigen::MatrixXd gram;
+  if (jacobian.cols() < jacobian.rows())
+    gram.noalias() = jacobian.transpose() * jacobian;
+  else
+    gram.noalias() = jacobian * jacobian.transpose();
+  Eigen::LLT<Eigen::MatrixXd> llt(gram);
+  if (llt.info() != Eigen::Success)
+    return 0.0;
+  // sqrt(det(G)) is the product of the diagonal of the Cholesky factor
+  return llt.matrixLLT().diagonal().prod();
+}
+
+/** the index as getManipulabilityIndex() computes it: the product of the singular values for
+    Jacobians with fewer than 6 columns, sqrt(det(JJ^T)) otherwise */
+double manipulabilityFromSingularValues(const Eigen::Ref<const Eigen::MatrixXd>& jacobian)
+{
+  if (jacobian.cols() < 6)
+  {
+    Eigen::JacobiSVD<Eigen::MatrixXd> svdsolver(jacobian);
+    return svdsolver.singularValues().prod();
+  }
+  return sqrt((jacobian * jacobian.transpose()).determinant());
+}
+}  // namespace
+
 double KinematicsMetrics::getJointLimitsPenalty(const robot_state::RobotState& state,
                                                 const robot_model::JointModelGroup* joint_model_group) const
 {
@@ -162,6 +196,94 @@ bool KinematicsMetrics::getManipulabilityIndex(const robot_state::RobotState& st
   return true;
 }
 
+bool KinematicsMetrics::getManipulabilityIndexCholesky(const robot_state::RobotState& state,
+                                                       const std::string& group_name, double& manipulability_index,
+                                                       bool translation) const
+{
+  const robot_model::JointModelGroup* joint_model_group = robot_model_->getJointModelGroup(group_name);
+  if (joint_model_group)
+    return getManipulabilityIndexCholesky(state, joint_model_group, manipulability_index, translation);
+  else
+    return false;
+}
+
+bool KinematicsMetrics::getManipulabilityIndexCholesky(const robot_state::RobotState& state,
+                                                       const robot_model::JointModelGroup* joint_model_group,
+                                                       double& manipulability_index, bool translation) const
+{
+  // state.getJacobian() only works for chain groups.
+  if (!joint_model_group->isChain())
+  {
+    return false;
+  }
+
+  Eigen::MatrixXd jacobian = state.getJacobian(joint_model_group);
+  double penalty = getJointLimitsPenalty(state, joint_model_group);
+  if (translation)
+    manipulability_index = penalty * manipulabilityFromGram(jacobian.topLeftCorner(3, jacobian.cols()));
+  else
+    manipulability_index = penalty * manipulabilityFromGram(jacobian);
+  return true;
+}
+
+bool KinematicsMetrics::getManipulabilityIndex(const std::vector<robot_state::RobotState>& states,
+                                               const robot_model::JointModelGroup* joint_model_group,
+                                               std::vector<double>& manipulability_indices, bool translation,
+                                               bool use_cholesky) const
+{
+  // state.getJacobian() only works for chain groups.
+  if (!joint_model_group || !joint_model_group->isChain())
+  {
+    return false;
+  }
+
+  manipulability_indices.assign(states.size(), 0.0);
+  if (states.empty())
+    return true;
+
+  const robot_model::LinkModel* tip = joint_model_group->getLinkModels().back();
+
+  moveit::tools::TaskScheduler& scheduler = moveit::tools::TaskScheduler::getInstance();
+  std::size_t n_threads = std::min<std::size_t>(scheduler.getThreadCount(), states.size());
+
+  // evaluate one range of states per worker; each worker reuses a single
+  // Jacobian workspace for its whole range
+  auto evaluate_range = [this, &states, &manipulability_indices, joint_model_group, tip, translation,
+                         use_cholesky](std::size_t lo, std::size_t hi) {
+    Eigen::MatrixXd jacobian;
+    for (std::size_t i = lo; i < hi; ++i)
+    {
+      if (!states[i].getJacobian(joint_model_group, tip, Eigen::Vector3d::Zero(), jacobian))
+        continue;
+      double penalty = getJointLimitsPenalty(states[i], joint_model_group);
+      double index;
+      if (translation)
+        index = use_cholesky ? manipulabilityFromGram(jacobian.topLeftCorner(3, jacobian.cols())) :
+                               manipulabilityFromSingularValues(jacobian.topLeftCorner(3, jacobian.cols()));
+      else
+        index = use_cholesky ? manipulabilityFromGram(jacobian) : manipulabilityFromSingularValues(jacobian);
+      manipulability_indices[i] = penalty * index;
+    }
+  };
+
+  // very short batches are not worth the per-task setup
+  if (n_threads <= 1 || states.size() < 2 * n_threads)
+  {
+    evaluate_range(0, states.size());
+    return true;
+  }
+
+  moveit::tools::TaskScheduler::TaskGroup task_group(scheduler);
+  for (std::size_t t = 0; t < n_threads; ++t)
+  {
+    const std::size_t lo = t * states.size() / n_threads;
+    const std::size_t hi = (t + 1) * states.size() / n_threads;
+    scheduler.submit(task_group, [evaluate_range, lo, hi] { evaluate_range(lo, hi); }, "kinematics_metrics");
+  }
+  task_group.wait();
+  return true;
+}
+
 bool KinematicsMetrics::getManipulabilityEllipsoid(const robot_state::RobotState& state, const std::string& group_name,
                                                    Eigen::MatrixXcd& eigen_values,
                                                    Eigen::MatrixXcd& eigen_vectors) const
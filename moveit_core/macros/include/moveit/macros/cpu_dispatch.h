@@ -0,0 +1,95 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_MACROS_CPU_DISPATCH_
+#define MOVEIT_MACROS_CPU_DISPATCH_
+
+/** \def MOVEIT_CPU_CLONES
+    Marks a function for x86 function multiversioning: the compiler emits
+    AVX-512, AVX2 and baseline clones of the function body and the dynamic
+    linker binds the best one for the running CPU, so a single binary uses
+    wide vectors where the fleet hardware has them. Only useful on functions
+    whose body the compiler auto-vectorizes (plain loops over arrays);
+    explicitly written intrinsics, and Eigen's, pick their instruction set at
+    preprocessing time and are not affected. Expands to nothing on compilers
+    or targets without multiversioning support. */
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__ELF__)
+#define MOVEIT_CPU_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define MOVEIT_CPU_CLONES /* Nothing */
+#endif
+
+namespace moveit
+{
+namespace tools
+{
+/** \brief Cached runtime CPU feature queries, for dispatch sites that select
+    between hand-written kernel variants instead of using \ref MOVEIT_CPU_CLONES.
+    Always false on non-x86 targets. */
+inline bool cpuSupportsAvx2()
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+inline bool cpuSupportsAvx512f()
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+  static const bool supported = __builtin_cpu_supports("avx512f");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+/** \brief Pick the widest implementation the running CPU supports; pass nullptr
+    for variants that do not exist at a given site. */
+template <typename FnPtr>
+FnPtr selectCpuVariant(FnPtr baseline, FnPtr avx2, FnPtr avx512)
+{
+  if (avx512 && cpuSupportsAvx512f())
+    return avx512;
+  if (avx2 && cpuSupportsAvx2())
+    return avx2;
+  return baseline;
+}
+}
+}
+
+#endif
@@ -55,6 +55,7 @@
 #include <boost/noncopyable.hpp>
 #include <boost/function.hpp>
 #include <boost/concept_check.hpp>
+#include <cstdint>
 #include <memory>
 
 /** \brief This namespace includes the central class for representing planning contexts */
@@ -129,6 +130,17 @@ public:
    * has the diffs specified by \e msg applied. */
   PlanningScenePtr diff(const moveit_msgs::PlanningScene& msg) const;
 
+  /** \brief Return a child scene narrowed to the world objects that \e group can possibly reach.
+   *
+   *  The reachable workspace is bounded conservatively by a sphere centered at the group's root
+   *  link (at the current state) with radius getMaximumExtent() of the group plus \e margin;
+   *  objects whose bounding sphere cannot intersect it are removed from the child world. For
+   *  short motions in large scenes this keeps the collision broadphase from paying for objects
+   *  that can never collide with the group. Collision checks against the narrowed scene are
+   *  only meaningful for states of \e group; checks involving other parts of the robot may miss
+   *  the removed objects. */
+  PlanningScenePtr createNarrowedScene(const std::string& group, double margin = 0.1) const;
+
   /** \brief Get the parent scene (whith respect to which the diffs are maintained). This may be empty */
   const PlanningSceneConstPtr& getParent() const
   {
@@ -690,6 +702,17 @@ public:
   /** \brief Load the geometry of the planning scene from a stream at a certain location using offset*/
   bool loadGeometryFromStream(std::istream& in, const Eigen::Isometry3d& offset);
 
+  /** \brief Save the geometry of the planning scene to a stream in a compact binary format.
+      Mesh vertex and triangle buffers are written as single raw blocks instead of being marshalled
+      element by element, which makes snapshots of mesh-heavy scenes considerably faster and smaller
+      than the moveit_msgs round-trip. The octomap is not included, as with saveGeometryToStream(). */
+  bool saveBinary(std::ostream& out) const;
+
+  /** \brief Load scene geometry previously written by saveBinary(). Mesh buffers are read directly
+      into the allocated shape storage. Objects are added to the current world; call
+      removeAllCollisionObjects() first for snapshot (replace) semantics. */
+  bool loadBinary(std::istream& in);
+
   /** \brief Fill the message \e scene with the differences between this instance of PlanningScene with respect to the
      parent.
       If there is no parent, everything is considered to be a diff and the function behaves like getPlanningSceneMsg()
@@ -709,6 +732,12 @@ public:
    * requested object*/
   bool getCollisionObjectMsg(moveit_msgs::CollisionObject& collision_obj, const std::string& ns) const;
 
+  /** \brief Construct a pose-only MOVE message (\e collision_object) for the requested object, carrying its current
+     shape poses but no geometry. Returns false if the object does not exist or its shapes are not laid out so that a
+     receiver can re-associate the poses (see processCollisionObjectMsg()); in that case a full message should be sent
+     instead */
+  bool getCollisionObjectMoveMsg(moveit_msgs::CollisionObject& collision_obj, const std::string& ns) const;
+
   /** \brief Construct a vector of messages (\e collision_objects) with the collision object data for all objects in
    * planning_scene */
   void getCollisionObjectMsgs(std::vector<moveit_msgs::CollisionObject>& collision_objs) const;
@@ -746,6 +775,26 @@ public:
   bool processCollisionObjectMsg(const moveit_msgs::CollisionObject& object);
   bool processAttachedCollisionObjectMsg(const moveit_msgs::AttachedCollisionObject& object);
 
+  /** \brief Fidelity at which meshes received through processCollisionObjectMsg() are ingested into the world */
+  enum MeshFidelity
+  {
+    MESH_FIDELITY_FULL,       ///< keep meshes at the resolution they arrive with (the default)
+    MESH_FIDELITY_DECIMATED,  ///< reduce meshes to the configured triangle budget
+    MESH_FIDELITY_CONVEX_HULL  ///< replace meshes by their convex hull
+  };
+
+  /** \brief Set the fidelity at which collision meshes are ingested by processCollisionObjectMsg(). Meshes arriving
+      from CAD at full resolution make every collision check pay for triangles that contribute nothing to clearance
+      decisions; simplifying them once at ingest time is much cheaper than checking against them repeatedly.
+      \e target_triangles is the triangle budget used by MESH_FIDELITY_DECIMATED. Simplified meshes are cached by
+      content hash, so re-sending the same mesh (or attaching it to several objects) does not repeat the work.
+      Only affects objects added after the call. */
+  void setMeshSimplification(MeshFidelity fidelity, std::size_t target_triangles = 5000);
+
+  /** \brief Override the mesh ingest fidelity of setMeshSimplification() for the object with the given id,
+      e.g. to keep a part that is grasped at full resolution while static cell geometry is decimated */
+  void setObjectMeshFidelity(const std::string& object_id, MeshFidelity fidelity);
+
   bool processPlanningSceneWorldMsg(const moveit_msgs::PlanningSceneWorld& world);
 
   void processOctomapMsg(const octomap_msgs::OctomapWithPose& map);
@@ -927,6 +976,19 @@ public:
   bool isPathValid(const robot_trajectory::RobotTrajectory& trajectory, const std::string& group = "",
                    bool verbose = false, std::vector<std::size_t>* invalid_index = NULL) const;
 
+  /** \brief Check if a given path is valid, distributing the waypoints over \e n_threads worker threads
+   *  (0 selects the hardware concurrency). Each thread validates a contiguous range of waypoints with its
+   *  own CollisionRobot/CollisionWorld instances allocated from the active collision detector, since the
+   *  collision structures are not safe for concurrent queries. Validation stops early once a waypoint is
+   *  known to be invalid; the smallest invalid waypoint index is reported in \e first_invalid_index (set
+   *  to the waypoint count if the path is valid). Falls back to the serial isPathValid() when a state
+   *  feasibility predicate is installed, as user predicates are not required to be thread-safe. */
+  bool isPathValidParallel(const robot_trajectory::RobotTrajectory& trajectory,
+                           const moveit_msgs::Constraints& path_constraints,
+                           const std::vector<moveit_msgs::Constraints>& goal_constraints,
+                           const std::string& group = "", unsigned int n_threads = 0,
+                           std::size_t* first_invalid_index = NULL) const;
+
   /** \brief Get the top \e max_costs cost sources for a specified trajectory. The resulting costs are stored in \e
    * costs */
   void getCostSources(const robot_trajectory::RobotTrajectory& trajectory, std::size_t max_costs,
@@ -981,6 +1043,11 @@ private:
   bool processCollisionObjectRemove(const moveit_msgs::CollisionObject& object);
   bool processCollisionObjectMove(const moveit_msgs::CollisionObject& object);
 
+  /* Apply the mesh ingest fidelity policy to a shape about to enter the world on behalf of the object with the
+     given id. Non-mesh shapes and MESH_FIDELITY_FULL pass through unchanged; simplified variants are served from
+     a cache keyed by mesh content hash, fidelity and triangle budget. */
+  shapes::ShapeConstPtr simplifyMeshForIngest(const std::string& object_id, const shapes::ShapeConstPtr& shape);
+
   MOVEIT_STRUCT_FORWARD(CollisionDetector);
 
   /* \brief A set of compatible collision detectors */
@@ -1049,6 +1116,67 @@ private:
 
   // a map of object types
   std::unique_ptr<ObjectTypeMap> object_types_;
+
+  // fidelity policy for meshes ingested through processCollisionObjectMsg(), with per-object overrides,
+  // and the cache of already simplified meshes (keyed by content hash mixed with fidelity and budget)
+  MeshFidelity default_mesh_fidelity_ = MESH_FIDELITY_FULL;
+  std::size_t mesh_triangle_budget_ = 5000;
+  std::map<std::string, MeshFidelity> object_mesh_fidelity_;
+  std::map<std::uint64_t, shapes::ShapeConstPtr> simplified_mesh_cache_;
+};
+
+MOVEIT_CLASS_FORWARD(CollisionQuerySession);
+
+/** \brief Pre-resolved collision checking context for one scene snapshot.
+
+    PlanningScene::checkCollision() re-derives the active collision world, the padded and
+    unpadded collision robot and the allowed collision matrix on every call. When thousands of
+    checks are issued against an unchanging scene (state validity checking during a solve), that
+    per-call scaffolding is pure overhead. A session resolves all of it once at construction,
+    copies the allowed collision matrix and pins the scene snapshot it was created from, so the
+    resolved instances stay valid for the lifetime of the session.
+
+    The session is immutable after construction and may be shared by concurrent planner threads,
+    just like the const scene itself. Changes made to the scene after construction are NOT picked
+    up; create a new session after modifying the scene. */
+class CollisionQuerySession
+{
+public:
+  /** \brief Resolve the active collision checkers and allowed collision matrix of \e scene */
+  CollisionQuerySession(const PlanningSceneConstPtr& scene);
+
+  /** \brief Equivalent of PlanningScene::checkCollision(): check \e state against the world with
+      the padded robot, then for self collision with the unpadded robot */
+  void checkCollision(const collision_detection::CollisionRequest& req, collision_detection::CollisionResult& res,
+                      const robot_state::RobotState& robot_state) const;
+
+  /** \brief Equivalent of PlanningScene::checkCollisionUnpadded() */
+  void checkCollisionUnpadded(const collision_detection::CollisionRequest& req,
+                              collision_detection::CollisionResult& res,
+                              const robot_state::RobotState& robot_state) const;
+
+  /** \brief Equivalent of PlanningScene::checkSelfCollision() (unpadded robot) */
+  void checkSelfCollision(const collision_detection::CollisionRequest& req, collision_detection::CollisionResult& res,
+                          const robot_state::RobotState& robot_state) const;
+
+  /** \brief The allowed collision matrix the session was resolved with */
+  const collision_detection::AllowedCollisionMatrix& getAllowedCollisionMatrix() const
+  {
+    return acm_;
+  }
+
+  /** \brief The scene snapshot this session pins */
+  const PlanningSceneConstPtr& getPlanningScene() const
+  {
+    return scene_;
+  }
+
+private:
+  PlanningSceneConstPtr scene_;
+  collision_detection::CollisionWorldConstPtr world_;
+  collision_detection::CollisionRobotConstPtr robot_;
+  collision_detection::CollisionRobotConstPtr robot_unpadded_;
+  collision_detection::AllowedCollisionMatrix acm_;
 };
 }
 
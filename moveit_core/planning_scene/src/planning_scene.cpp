@@ -37,16 +37,27 @@
 #include <boost/algorithm/string.hpp>
 #include <moveit/planning_scene/planning_scene.h>
 #include <moveit/collision_detection_fcl/collision_detector_allocator_fcl.h>
+#include <geometric_shapes/bodies.h>
+#include <geometric_shapes/mesh_operations.h>
 #include <geometric_shapes/shape_operations.h>
 #include <moveit/collision_detection/collision_tools.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/exceptions/exceptions.h>
 #include <moveit/robot_state/attached_body.h>
+#include <moveit/profiler/profiler.h>
+#include <moveit/utils/lexical_casts.h>
+#include <moveit/utils/task_scheduler.h>
 #include <octomap_msgs/conversions.h>
 #include <tf2_eigen/tf2_eigen.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <set>
+#include <thread>
 
 namespace planning_scene
 {
@@ -243,6 +254,50 @@ PlanningScenePtr PlanningScene::diff(const moveit_msgs::PlanningScene& msg) cons
   return result;
 }
 
+PlanningScenePtr PlanningScene::createNarrowedScene(const std::string& group, double margin) const
+{
+  PlanningScenePtr narrowed = diff();
+  const robot_model::JointModelGroup* jmg = getRobotModel()->getJointModelGroup(group);
+  if (!jmg)
+    return narrowed;
+
+  // conservative bound on the workspace the group can reach: a sphere centered at the group's
+  // root link with the maximum extent the joint limits allow, plus the requested margin
+  Eigen::Vector3d center = Eigen::Vector3d::Zero();
+  const robot_model::JointModel* root_joint = jmg->getCommonRoot();
+  if (root_joint && root_joint->getParentLinkModel())
+  {
+    const robot_model::LinkModel* root_link = root_joint->getParentLinkModel();
+    center = getCurrentState().dirtyLinkTransforms() ?
+                 narrowed->getCurrentStateNonConst().getGlobalLinkTransform(root_link).translation() :
+                 getCurrentState().getGlobalLinkTransform(root_link).translation();
+  }
+  const double reach = jmg->getMaximumExtent() + margin;
+
+  // drop every object whose bounding sphere cannot intersect the reachable sphere
+  const std::vector<std::string> ids = getWorld()->getObjectIds();
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < ids.size(); ++i)
+  {
+    collision_detection::World::ObjectConstPtr obj = getWorld()->getObject(ids[i]);
+    if (!obj)
+      continue;
+    bool reachable = false;
+    for (std::size_t j = 0; j < obj->shapes_.size() && !reachable; ++j)
+    {
+      const Eigen::Vector3d extents = shapes::computeShapeExtents(obj->shapes_[j].get());
+      reachable = (obj->shape_poses_[j].translation() - center).norm() <= 0.5 * extents.norm() + reach;
+    }
+    if (reachable)
+      ++kept;
+    else
+      narrowed->getWorldNonConst()->removeObject(ids[i]);
+  }
+  ROS_DEBUG_NAMED(LOGNAME, "Narrowed scene for group '%s' keeps %zu of %zu objects (reach bound %lf m)",
+                  group.c_str(), kept, ids.size(), reach);
+  return narrowed;
+}
+
 void PlanningScene::CollisionDetector::copyPadding(const PlanningScene::CollisionDetector& src)
 {
   if (!crobot_)
@@ -525,6 +580,8 @@ void PlanningScene::checkCollision(const collision_detection::CollisionRequest&
                                    collision_detection::CollisionResult& res,
                                    const robot_state::RobotState& robot_state) const
 {
+  moveit::tools::Profiler::ScopedBlock prof_block("PlanningScene::checkCollision");
+
   // check collision with the world using the padded version
   getCollisionWorld()->checkRobotCollision(req, res, *getCollisionRobot(), robot_state, getAllowedCollisionMatrix());
 
@@ -549,6 +606,8 @@ void PlanningScene::checkCollision(const collision_detection::CollisionRequest&
                                    const robot_state::RobotState& robot_state,
                                    const collision_detection::AllowedCollisionMatrix& acm) const
 {
+  moveit::tools::Profiler::ScopedBlock prof_block("PlanningScene::checkCollision");
+
   // check collision with the world using the padded version
   getCollisionWorld()->checkRobotCollision(req, res, *getCollisionRobot(), robot_state, acm);
 
@@ -765,6 +824,13 @@ void PlanningScene::getPlanningSceneDiffMsg(moveit_msgs::PlanningScene& scene_ms
         co.operation = moveit_msgs::CollisionObject::REMOVE;
         scene_msg.world.collision_objects.push_back(co);
       }
+      else if (it->second == collision_detection::World::MOVE_SHAPE)
+      {
+        // only poses changed; send a pose-only MOVE instead of re-sending the geometry
+        scene_msg.world.collision_objects.emplace_back();
+        if (!getCollisionObjectMoveMsg(scene_msg.world.collision_objects.back(), it->first))
+          getCollisionObjectMsg(scene_msg.world.collision_objects.back(), it->first);
+      }
       else
       {
         scene_msg.world.collision_objects.emplace_back();
@@ -842,6 +908,54 @@ bool PlanningScene::getCollisionObjectMsg(moveit_msgs::CollisionObject& collisio
   return true;
 }
 
+bool PlanningScene::getCollisionObjectMoveMsg(moveit_msgs::CollisionObject& collision_obj,
+                                              const std::string& ns) const
+{
+  collision_obj.header.frame_id = getPlanningFrame();
+  collision_obj.id = ns;
+  collision_obj.operation = moveit_msgs::CollisionObject::MOVE;
+  collision_detection::CollisionWorld::ObjectConstPtr obj = world_->getObject(ns);
+  if (!obj)
+    return false;
+  // a MOVE message carries no geometry; the receiver re-associates the poses with the shapes it
+  // already has by concatenating the primitive, mesh and plane pose arrays in that order, so the
+  // poses can only be sent this way when the shapes of the object are grouped that way (which is
+  // how processCollisionObjectMsg() lays out objects constructed from messages)
+  int category = 0;  // 0 = primitive, 1 = mesh, 2 = plane
+  for (std::size_t j = 0; j < obj->shapes_.size(); ++j)
+  {
+    int shape_category;
+    switch (obj->shapes_[j]->type)
+    {
+      case shapes::SPHERE:
+      case shapes::BOX:
+      case shapes::CYLINDER:
+      case shapes::CONE:
+        shape_category = 0;
+        break;
+      case shapes::MESH:
+        shape_category = 1;
+        break;
+      case shapes::PLANE:
+        shape_category = 2;
+        break;
+      default:
+        return false;
+    }
+    if (shape_category < category)
+      return false;
+    category = shape_category;
+    geometry_msgs::Pose p = tf2::toMsg(obj->shape_poses_[j]);
+    if (shape_category == 0)
+      collision_obj.primitive_poses.push_back(p);
+    else if (shape_category == 1)
+      collision_obj.mesh_poses.push_back(p);
+    else
+      collision_obj.plane_poses.push_back(p);
+  }
+  return true;
+}
+
 void PlanningScene::getCollisionObjectMsgs(std::vector<moveit_msgs::CollisionObject>& collision_objs) const
 {
   collision_objs.clear();
@@ -1017,14 +1131,20 @@ void PlanningScene::saveGeometryToStream(std::ostream& out) const
         for (std::size_t j = 0; j < obj->shapes_.size(); ++j)
         {
           shapes::saveAsText(obj->shapes_[j].get(), out);
-          out << obj->shape_poses_[j].translation().x() << " " << obj->shape_poses_[j].translation().y() << " "
-              << obj->shape_poses_[j].translation().z() << std::endl;
+          // format through the locale-agnostic bulk kernels; the stream's own locale must not
+          // leak into the scene file
+          const double translation[3] = { obj->shape_poses_[j].translation().x(),
+                                          obj->shape_poses_[j].translation().y(),
+                                          obj->shape_poses_[j].translation().z() };
+          out << moveit::core::toString(translation, 3) << std::endl;
           Eigen::Quaterniond r(obj->shape_poses_[j].rotation());
-          out << r.x() << " " << r.y() << " " << r.z() << " " << r.w() << std::endl;
+          const double rotation[4] = { r.x(), r.y(), r.z(), r.w() };
+          out << moveit::core::toString(rotation, 4) << std::endl;
           if (hasObjectColor(ns[i]))
           {
             const std_msgs::ColorRGBA& c = getObjectColor(ns[i]);
-            out << c.r << " " << c.g << " " << c.b << " " << c.a << std::endl;
+            const double color[4] = { c.r, c.g, c.b, c.a };
+            out << moveit::core::toString(color, 4) << std::endl;
           }
           else
             out << "0 0 0 0" << std::endl;
@@ -1124,6 +1244,263 @@ bool PlanningScene::loadGeometryFromStream(std::istream& in, const Eigen::Isomet
   } while (true);
 }
 
+namespace
+{
+// binary scene snapshot format: magic + version header, then length-prefixed sections.
+// mesh vertex/triangle buffers are written as single raw blocks.
+const std::uint32_t BINARY_SCENE_MAGIC = 0x4d564253;  // 'MVBS'
+const std::uint32_t BINARY_SCENE_VERSION = 1;
+
+template <typename T>
+void writeBinary(std::ostream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeBinaryString(std::ostream& out, const std::string& s)
+{
+  writeBinary(out, static_cast<std::uint32_t>(s.size()));
+  out.write(s.data(), s.size());
+}
+
+template <typename T>
+bool readBinary(std::istream& in, T& value)
+{
+  in.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return !in.fail();
+}
+
+bool readBinaryString(std::istream& in, std::string& s)
+{
+  std::uint32_t size;
+  if (!readBinary(in, size))
+    return false;
+  s.resize(size);
+  in.read(&s[0], size);
+  return !in.fail();
+}
+
+bool writeBinaryShape(std::ostream& out, const shapes::Shape* shape)
+{
+  writeBinary(out, static_cast<std::uint32_t>(shape->type));
+  switch (shape->type)
+  {
+    case shapes::SPHERE:
+      writeBinary(out, static_cast<const shapes::Sphere*>(shape)->radius);
+      return true;
+    case shapes::BOX:
+      out.write(reinterpret_cast<const char*>(static_cast<const shapes::Box*>(shape)->size), 3 * sizeof(double));
+      return true;
+    case shapes::CYLINDER:
+      writeBinary(out, static_cast<const shapes::Cylinder*>(shape)->radius);
+      writeBinary(out, static_cast<const shapes::Cylinder*>(shape)->length);
+      return true;
+    case shapes::CONE:
+      writeBinary(out, static_cast<const shapes::Cone*>(shape)->radius);
+      writeBinary(out, static_cast<const shapes::Cone*>(shape)->length);
+      return true;
+    case shapes::PLANE:
+      writeBinary(out, static_cast<const shapes::Plane*>(shape)->a);
+      writeBinary(out, static_cast<const shapes::Plane*>(shape)->b);
+      writeBinary(out, static_cast<const shapes::Plane*>(shape)->c);
+      writeBinary(out, static_cast<const shapes::Plane*>(shape)->d);
+      return true;
+    case shapes::MESH:
+    {
+      const shapes::Mesh* mesh = static_cast<const shapes::Mesh*>(shape);
+      writeBinary(out, mesh->vertex_count);
+      writeBinary(out, mesh->triangle_count);
+      out.write(reinterpret_cast<const char*>(mesh->vertices), 3 * mesh->vertex_count * sizeof(double));
+      out.write(reinterpret_cast<const char*>(mesh->triangles), 3 * mesh->triangle_count * sizeof(unsigned int));
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+shapes::Shape* readBinaryShape(std::istream& in)
+{
+  std::uint32_t type;
+  if (!readBinary(in, type))
+    return nullptr;
+  switch (type)
+  {
+    case shapes::SPHERE:
+    {
+      double radius;
+      if (!readBinary(in, radius))
+        return nullptr;
+      return new shapes::Sphere(radius);
+    }
+    case shapes::BOX:
+    {
+      double size[3];
+      in.read(reinterpret_cast<char*>(size), sizeof(size));
+      if (in.fail())
+        return nullptr;
+      return new shapes::Box(size[0], size[1], size[2]);
+    }
+    case shapes::CYLINDER:
+    {
+      double radius, length;
+      if (!readBinary(in, radius) || !readBinary(in, length))
+        return nullptr;
+      return new shapes::Cylinder(radius, length);
+    }
+    case shapes::CONE:
+    {
+      double radius, length;
+      if (!readBinary(in, radius) || !readBinary(in, length))
+        return nullptr;
+      return new shapes::Cone(radius, length);
+    }
+    case shapes::PLANE:
+    {
+      double a, b, c, d;
+      if (!readBinary(in, a) || !readBinary(in, b) || !readBinary(in, c) || !readBinary(in, d))
+        return nullptr;
+      return new shapes::Plane(a, b, c, d);
+    }
+    case shapes::MESH:
+    {
+      unsigned int vertex_count, triangle_count;
+      if (!readBinary(in, vertex_count) || !readBinary(in, triangle_count))
+        return nullptr;
+      // read the buffers directly into the storage allocated by the mesh
+      std::unique_ptr<shapes::Mesh> mesh(new shapes::Mesh(vertex_count, triangle_count));
+      in.read(reinterpret_cast<char*>(mesh->vertices), 3 * vertex_count * sizeof(double));
+      in.read(reinterpret_cast<char*>(mesh->triangles), 3 * triangle_count * sizeof(unsigned int));
+      if (in.fail())
+        return nullptr;
+      mesh->computeTriangleNormals();
+      mesh->computeVertexNormals();
+      return mesh.release();
+    }
+    default:
+      return nullptr;
+  }
+}
+}  // namespace
+
+bool PlanningScene::saveBinary(std::ostream& out) const
+{
+  writeBinary(out, BINARY_SCENE_MAGIC);
+  writeBinary(out, BINARY_SCENE_VERSION);
+  writeBinaryString(out, name_);
+
+  const std::vector<std::string>& object_ids = world_->getObjectIds();
+  std::uint32_t object_count = 0;
+  for (const std::string& object_id : object_ids)
+    if (object_id != OCTOMAP_NS && world_->getObject(object_id))
+      ++object_count;
+  writeBinary(out, object_count);
+
+  for (const std::string& object_id : object_ids)
+  {
+    if (object_id == OCTOMAP_NS)
+      continue;
+    collision_detection::CollisionWorld::ObjectConstPtr obj = world_->getObject(object_id);
+    if (!obj)
+      continue;
+    writeBinaryString(out, object_id);
+
+    std_msgs::ColorRGBA color;
+    const bool has_color = hasObjectColor(object_id);
+    if (has_color)
+      color = getObjectColor(object_id);
+    writeBinary(out, static_cast<std::uint8_t>(has_color));
+    if (has_color)
+    {
+      writeBinary(out, color.r);
+      writeBinary(out, color.g);
+      writeBinary(out, color.b);
+      writeBinary(out, color.a);
+    }
+
+    writeBinary(out, static_cast<std::uint32_t>(obj->shapes_.size()));
+    for (std::size_t j = 0; j < obj->shapes_.size(); ++j)
+    {
+      if (!writeBinaryShape(out, obj->shapes_[j].get()))
+      {
+        ROS_ERROR_NAMED(LOGNAME, "Cannot serialize shape of type %d in object '%s'", (int)obj->shapes_[j]->type,
+                        object_id.c_str());
+        return false;
+      }
+      const Eigen::Isometry3d& pose = obj->shape_poses_[j];
+      double t[3] = { pose.translation().x(), pose.translation().y(), pose.translation().z() };
+      Eigen::Quaterniond r(pose.rotation());
+      double q[4] = { r.x(), r.y(), r.z(), r.w() };
+      out.write(reinterpret_cast<const char*>(t), sizeof(t));
+      out.write(reinterpret_cast<const char*>(q), sizeof(q));
+    }
+  }
+  return out.good();
+}
+
+bool PlanningScene::loadBinary(std::istream& in)
+{
+  std::uint32_t magic, version;
+  if (!readBinary(in, magic) || magic != BINARY_SCENE_MAGIC)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Input stream does not contain a binary scene snapshot");
+    return false;
+  }
+  if (!readBinary(in, version) || version != BINARY_SCENE_VERSION)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Unsupported binary scene snapshot version");
+    return false;
+  }
+  if (!readBinaryString(in, name_))
+    return false;
+
+  std::uint32_t object_count;
+  if (!readBinary(in, object_count))
+    return false;
+  for (std::uint32_t i = 0; i < object_count; ++i)
+  {
+    std::string object_id;
+    if (!readBinaryString(in, object_id))
+      return false;
+
+    std::uint8_t has_color;
+    if (!readBinary(in, has_color))
+      return false;
+    if (has_color)
+    {
+      std_msgs::ColorRGBA color;
+      if (!readBinary(in, color.r) || !readBinary(in, color.g) || !readBinary(in, color.b) ||
+          !readBinary(in, color.a))
+        return false;
+      setObjectColor(object_id, color);
+    }
+
+    std::uint32_t shape_count;
+    if (!readBinary(in, shape_count))
+      return false;
+    for (std::uint32_t j = 0; j < shape_count; ++j)
+    {
+      shapes::Shape* s = readBinaryShape(in);
+      if (!s)
+      {
+        ROS_ERROR_NAMED(LOGNAME, "Failed to load shape from binary scene snapshot");
+        return false;
+      }
+      double t[3], q[4];
+      in.read(reinterpret_cast<char*>(t), sizeof(t));
+      in.read(reinterpret_cast<char*>(q), sizeof(q));
+      if (in.fail())
+      {
+        delete s;
+        return false;
+      }
+      Eigen::Isometry3d pose = Eigen::Translation3d(t[0], t[1], t[2]) * Eigen::Quaterniond(q[3], q[0], q[1], q[2]);
+      world_->addToObject(object_id, shapes::ShapePtr(s), pose);
+    }
+  }
+  return true;
+}
+
 void PlanningScene::setCurrentState(const moveit_msgs::RobotState& state)
 {
   // The attached bodies will be processed separately by processAttachedCollisionObjectMsgs
@@ -1280,9 +1657,12 @@ bool PlanningScene::setPlanningSceneDiffMsg(const moveit_msgs::PlanningScene& sc
   for (std::size_t i = 0; i < scene_msg.object_colors.size(); ++i)
     setObjectColor(scene_msg.object_colors[i].id, scene_msg.object_colors[i].color);
 
-  // process collision object updates
+  // process collision object updates; observers are notified once per
+  // changed object rather than once per message
+  world_->deferNotifications();
   for (std::size_t i = 0; i < scene_msg.world.collision_objects.size(); ++i)
     result &= processCollisionObjectMsg(scene_msg.world.collision_objects[i]);
+  world_->flushNotifications();
 
   // if an octomap was specified, replace the one we have with that one
   if (!scene_msg.world.octomap.octomap.data.empty())
@@ -1327,9 +1707,12 @@ bool PlanningScene::setPlanningSceneMsg(const moveit_msgs::PlanningScene& scene_
 bool PlanningScene::processPlanningSceneWorldMsg(const moveit_msgs::PlanningSceneWorld& world)
 {
   bool result = true;
+  // deliver one merged notification per changed object for the whole update
+  world_->deferNotifications();
   for (std::size_t i = 0; i < world.collision_objects.size(); ++i)
     result &= processCollisionObjectMsg(world.collision_objects[i]);
   processOctomapMsg(world.octomap);
+  world_->flushNotifications();
   return result;
 }
 
@@ -1712,6 +2095,165 @@ bool PlanningScene::processCollisionObjectMsg(const moveit_msgs::CollisionObject
   return false;
 }
 
+namespace
+{
+// FNV-1a over the raw vertex and triangle data of a mesh
+std::uint64_t hashMeshContent(const shapes::Mesh& mesh)
+{
+  std::uint64_t h = 0xcbf29ce484222325ULL;
+  auto mix = [&h](const unsigned char* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      h ^= data[i];
+      h *= 0x100000001b3ULL;
+    }
+  };
+  mix(reinterpret_cast<const unsigned char*>(mesh.vertices), mesh.vertex_count * 3 * sizeof(double));
+  mix(reinterpret_cast<const unsigned char*>(mesh.triangles), mesh.triangle_count * 3 * sizeof(unsigned int));
+  return h;
+}
+
+// Collapse the vertices of \e mesh onto a regular grid with \e cells cells along the longest extent of
+// its bounding box and drop the triangles that degenerate (classic vertex clustering decimation)
+shapes::Mesh* clusterMeshVertices(const shapes::Mesh& mesh, unsigned int cells)
+{
+  Eigen::Vector3d min_pt = Eigen::Vector3d::Constant(std::numeric_limits<double>::max());
+  Eigen::Vector3d max_pt = Eigen::Vector3d::Constant(-std::numeric_limits<double>::max());
+  for (unsigned int i = 0; i < mesh.vertex_count; ++i)
+    for (int a = 0; a < 3; ++a)
+    {
+      min_pt[a] = std::min(min_pt[a], mesh.vertices[3 * i + a]);
+      max_pt[a] = std::max(max_pt[a], mesh.vertices[3 * i + a]);
+    }
+  const double longest = (max_pt - min_pt).maxCoeff();
+  if (longest <= std::numeric_limits<double>::epsilon())
+    return nullptr;
+  const double cell_size = longest / cells;
+
+  // assign each vertex to the cluster of its grid cell; the cluster position is the mean of its vertices
+  std::map<std::uint64_t, unsigned int> cluster_of_cell;
+  std::vector<unsigned int> cluster_of_vertex(mesh.vertex_count);
+  EigenSTL::vector_Vector3d cluster_sum;
+  std::vector<unsigned int> cluster_size;
+  for (unsigned int i = 0; i < mesh.vertex_count; ++i)
+  {
+    const Eigen::Vector3d v(mesh.vertices[3 * i], mesh.vertices[3 * i + 1], mesh.vertices[3 * i + 2]);
+    std::uint64_t key = 0;
+    for (int a = 0; a < 3; ++a)
+      key = (key << 21) | std::min<std::uint64_t>(cells - 1, static_cast<std::uint64_t>((v[a] - min_pt[a]) / cell_size));
+    std::pair<std::map<std::uint64_t, unsigned int>::iterator, bool> inserted =
+        cluster_of_cell.insert(std::make_pair(key, static_cast<unsigned int>(cluster_sum.size())));
+    if (inserted.second)
+    {
+      cluster_sum.push_back(Eigen::Vector3d::Zero());
+      cluster_size.push_back(0);
+    }
+    cluster_of_vertex[i] = inserted.first->second;
+    cluster_sum[inserted.first->second] += v;
+    ++cluster_size[inserted.first->second];
+  }
+  EigenSTL::vector_Vector3d vertices(cluster_sum.size());
+  for (std::size_t i = 0; i < cluster_sum.size(); ++i)
+    vertices[i] = cluster_sum[i] / cluster_size[i];
+
+  std::set<std::array<unsigned int, 3> > seen;
+  std::vector<unsigned int> triangles;
+  for (unsigned int i = 0; i < mesh.triangle_count; ++i)
+  {
+    const unsigned int a = cluster_of_vertex[mesh.triangles[3 * i]];
+    const unsigned int b = cluster_of_vertex[mesh.triangles[3 * i + 1]];
+    const unsigned int c = cluster_of_vertex[mesh.triangles[3 * i + 2]];
+    if (a == b || b == c || a == c)
+      continue;
+    std::array<unsigned int, 3> id = { { a, b, c } };
+    std::sort(id.begin(), id.end());
+    if (!seen.insert(id).second)
+      continue;
+    triangles.push_back(a);
+    triangles.push_back(b);
+    triangles.push_back(c);
+  }
+  if (triangles.empty())
+    return nullptr;
+  return shapes::createMeshFromVertices(vertices, triangles);
+}
+
+// the finest clustering resolution whose output fits the triangle budget (the coarsest one wins
+// when even that exceeds the budget)
+shapes::Mesh* decimateMesh(const shapes::Mesh& mesh, std::size_t target_triangles)
+{
+  static const unsigned int RESOLUTIONS[] = { 128, 96, 64, 48, 32, 24, 16, 12, 8 };
+  for (std::size_t r = 0; r < sizeof(RESOLUTIONS) / sizeof(RESOLUTIONS[0]); ++r)
+  {
+    shapes::Mesh* m = clusterMeshVertices(mesh, RESOLUTIONS[r]);
+    if (!m)
+      continue;
+    if (m->triangle_count <= target_triangles || RESOLUTIONS[r] == 8)
+      return m;
+    delete m;
+  }
+  return nullptr;
+}
+}  // namespace
+
+void PlanningScene::setMeshSimplification(MeshFidelity fidelity, std::size_t target_triangles)
+{
+  default_mesh_fidelity_ = fidelity;
+  if (target_triangles > 0)
+    mesh_triangle_budget_ = target_triangles;
+}
+
+void PlanningScene::setObjectMeshFidelity(const std::string& object_id, MeshFidelity fidelity)
+{
+  object_mesh_fidelity_[object_id] = fidelity;
+}
+
+shapes::ShapeConstPtr PlanningScene::simplifyMeshForIngest(const std::string& object_id,
+                                                           const shapes::ShapeConstPtr& shape)
+{
+  MeshFidelity fidelity = default_mesh_fidelity_;
+  std::map<std::string, MeshFidelity>::const_iterator policy = object_mesh_fidelity_.find(object_id);
+  if (policy != object_mesh_fidelity_.end())
+    fidelity = policy->second;
+  if (fidelity == MESH_FIDELITY_FULL || shape->type != shapes::MESH)
+    return shape;
+
+  const shapes::Mesh* mesh = static_cast<const shapes::Mesh*>(shape.get());
+  if (mesh->triangle_count == 0 ||
+      (fidelity == MESH_FIDELITY_DECIMATED && mesh->triangle_count <= mesh_triangle_budget_))
+    return shape;
+
+  std::uint64_t key = hashMeshContent(*mesh);
+  key ^= 0x9e3779b97f4a7c15ULL * (static_cast<std::uint64_t>(fidelity) + 1);
+  if (fidelity == MESH_FIDELITY_DECIMATED)
+    key ^= 0xc2b2ae3d27d4eb4fULL * static_cast<std::uint64_t>(mesh_triangle_budget_);
+  std::map<std::uint64_t, shapes::ShapeConstPtr>::const_iterator cached = simplified_mesh_cache_.find(key);
+  if (cached != simplified_mesh_cache_.end())
+    return cached->second;
+
+  shapes::Mesh* simplified = nullptr;
+  if (fidelity == MESH_FIDELITY_CONVEX_HULL)
+  {
+    bodies::ConvexMesh hull(mesh);
+    if (!hull.getTriangles().empty())
+      simplified = shapes::createMeshFromVertices(hull.getVertices(), hull.getTriangles());
+  }
+  else
+    simplified = decimateMesh(*mesh, mesh_triangle_budget_);
+
+  if (!simplified || simplified->triangle_count == 0 || simplified->triangle_count >= mesh->triangle_count)
+  {
+    delete simplified;
+    return shape;  // simplification did not pay off; ingest the mesh as received
+  }
+
+  ROS_DEBUG_NAMED(LOGNAME, "Simplified collision mesh of object '%s' from %u to %u triangles", object_id.c_str(),
+                  mesh->triangle_count, simplified->triangle_count);
+  shapes::ShapeConstPtr result(simplified);
+  simplified_mesh_cache_[key] = result;
+  return result;
+}
+
 bool PlanningScene::processCollisionObjectAdd(const moveit_msgs::CollisionObject& object)
 {
   if (object.primitives.empty() && object.meshes.empty() && object.planes.empty())
@@ -1762,7 +2304,8 @@ bool PlanningScene::processCollisionObjectAdd(const moveit_msgs::CollisionObject
     {
       Eigen::Isometry3d object_pose;
       tf2::fromMsg(object.mesh_poses[i], object_pose);
-      world_->addToObject(object.id, shapes::ShapeConstPtr(s), object_frame_transform * object_pose);
+      world_->addToObject(object.id, simplifyMeshForIngest(object.id, shapes::ShapeConstPtr(s)),
+                          object_frame_transform * object_pose);
     }
   }
   for (std::size_t i = 0; i < object.planes.size(); ++i)
@@ -1829,8 +2372,28 @@ bool PlanningScene::processCollisionObjectMove(const moveit_msgs::CollisionObjec
     {
       std::vector<shapes::ShapeConstPtr> shapes = obj->shapes_;
       obj.reset();
-      world_->removeObject(object.id);
-      world_->addToObject(object.id, shapes, new_poses);
+      // move the shapes in place when possible, so that observers see MOVE_SHAPE instead of the
+      // object being destroyed and re-created, and chained scene monitors can forward pose-only
+      // diffs; moveShapeInObject() matches shapes by pointer, so fall back to re-creating the
+      // object if the same shape instance appears more than once
+      bool shapes_unique = true;
+      for (std::size_t i = 0; i < shapes.size() && shapes_unique; ++i)
+        for (std::size_t j = i + 1; j < shapes.size(); ++j)
+          if (shapes[i] == shapes[j])
+          {
+            shapes_unique = false;
+            break;
+          }
+      if (shapes_unique)
+      {
+        for (std::size_t i = 0; i < shapes.size(); ++i)
+          world_->moveShapeInObject(object.id, shapes[i], new_poses[i]);
+      }
+      else
+      {
+        world_->removeObject(object.id);
+        world_->addToObject(object.id, shapes, new_poses);
+      }
     }
     else
     {
@@ -2216,6 +2779,99 @@ bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& traject
   return result;
 }
 
+bool PlanningScene::isPathValidParallel(const robot_trajectory::RobotTrajectory& trajectory,
+                                        const moveit_msgs::Constraints& path_constraints,
+                                        const std::vector<moveit_msgs::Constraints>& goal_constraints,
+                                        const std::string& group, unsigned int n_threads,
+                                        std::size_t* first_invalid_index) const
+{
+  const std::size_t n_wp = trajectory.getWayPointCount();
+  if (n_threads == 0)
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+  if (n_threads > n_wp)
+    n_threads = n_wp > 0 ? n_wp : 1;
+
+  // user feasibility predicates are not required to be thread-safe, and very short paths are not
+  // worth the per-thread setup; both cases use the serial validator
+  if (state_feasibility_ || n_threads == 1 || n_wp < 2 * n_threads)
+  {
+    std::vector<std::size_t> invalid;
+    bool valid = isPathValid(trajectory, path_constraints, goal_constraints, group, false, &invalid);
+    if (first_invalid_index)
+      *first_invalid_index = invalid.empty() ? n_wp : invalid.front();
+    return valid;
+  }
+
+  const collision_detection::AllowedCollisionMatrix& acm = getAllowedCollisionMatrix();
+  std::atomic<std::size_t> first_invalid(n_wp);
+  moveit::tools::TaskScheduler& scheduler = moveit::tools::TaskScheduler::getInstance();
+  moveit::tools::TaskScheduler::TaskGroup task_group(scheduler);
+  for (unsigned int t = 0; t < n_threads; ++t)
+  {
+    const std::size_t lo = t * n_wp / n_threads;
+    const std::size_t hi = (t + 1) * n_wp / n_threads;
+    scheduler.submit(task_group, [this, &trajectory, &path_constraints, &group, &acm, &first_invalid, lo, hi] {
+      // per-thread collision structures; the broadphase managers are not safe for concurrent queries
+      collision_detection::CollisionRobotConstPtr crobot =
+          active_collision_->alloc_->allocateRobot(getCollisionRobot());
+      collision_detection::CollisionRobotConstPtr crobot_unpadded =
+          active_collision_->alloc_->allocateRobot(getCollisionRobotUnpadded());
+      collision_detection::CollisionWorldConstPtr cworld =
+          active_collision_->alloc_->allocateWorld(getCollisionWorld(), world_);
+      kinematic_constraints::KinematicConstraintSet ks(getRobotModel());
+      ks.add(path_constraints, getTransforms());
+
+      for (std::size_t i = lo; i < hi; ++i)
+      {
+        // stop once an earlier waypoint is already known to be invalid
+        if (first_invalid.load(std::memory_order_relaxed) <= i)
+          break;
+
+        const robot_state::RobotState& st = trajectory.getWayPoint(i);
+        collision_detection::CollisionRequest req;
+        req.group_name = group;
+        collision_detection::CollisionResult res;
+        cworld->checkRobotCollision(req, res, *crobot, st, acm);
+        if (!res.collision)
+          crobot_unpadded->checkSelfCollision(req, res, st, acm);
+
+        bool this_state_valid = !res.collision;
+        if (this_state_valid && !ks.empty() && !ks.decide(st).satisfied)
+          this_state_valid = false;
+
+        if (!this_state_valid)
+        {
+          std::size_t expected = first_invalid.load();
+          while (i < expected && !first_invalid.compare_exchange_weak(expected, i))
+            ;
+          break;
+        }
+      }
+    }, "planning_scene");
+  }
+  task_group.wait();
+
+  std::size_t invalid = first_invalid.load();
+  if (invalid == n_wp && n_wp > 0 && !goal_constraints.empty())
+  {
+    // as in the serial validator, the goal constraints apply to the last waypoint only
+    const robot_state::RobotState& last = trajectory.getWayPoint(n_wp - 1);
+    bool found = false;
+    for (const moveit_msgs::Constraints& goal_constraint : goal_constraints)
+      if (isStateConstrained(last, goal_constraint))
+      {
+        found = true;
+        break;
+      }
+    if (!found)
+      invalid = n_wp - 1;
+  }
+
+  if (first_invalid_index)
+    *first_invalid_index = invalid;
+  return invalid == n_wp;
+}
+
 bool PlanningScene::isPathValid(const robot_trajectory::RobotTrajectory& trajectory,
                                 const moveit_msgs::Constraints& path_constraints,
                                 const moveit_msgs::Constraints& goal_constraints, const std::string& group,
@@ -2323,4 +2979,42 @@ void PlanningScene::printKnownObjects(std::ostream& out) const
   out << "-----------------------------------------\n";
 }
 
+CollisionQuerySession::CollisionQuerySession(const PlanningSceneConstPtr& scene)
+  : scene_(scene)
+  , world_(scene->getCollisionWorld())
+  , robot_(scene->getCollisionRobot())
+  , robot_unpadded_(scene->getCollisionRobotUnpadded())
+  , acm_(scene->getAllowedCollisionMatrix())
+{
+}
+
+void CollisionQuerySession::checkCollision(const collision_detection::CollisionRequest& req,
+                                           collision_detection::CollisionResult& res,
+                                           const robot_state::RobotState& robot_state) const
+{
+  // check collision with the world using the padded version
+  world_->checkRobotCollision(req, res, *robot_, robot_state, acm_);
+
+  // do self-collision checking with the unpadded version of the robot
+  if (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts))
+    robot_unpadded_->checkSelfCollision(req, res, robot_state, acm_);
+}
+
+void CollisionQuerySession::checkCollisionUnpadded(const collision_detection::CollisionRequest& req,
+                                                   collision_detection::CollisionResult& res,
+                                                   const robot_state::RobotState& robot_state) const
+{
+  world_->checkRobotCollision(req, res, *robot_unpadded_, robot_state, acm_);
+
+  if (!res.collision || (req.contacts && res.contacts.size() < req.max_contacts))
+    robot_unpadded_->checkSelfCollision(req, res, robot_state, acm_);
+}
+
+void CollisionQuerySession::checkSelfCollision(const collision_detection::CollisionRequest& req,
+                                               collision_detection::CollisionResult& res,
+                                               const robot_state::RobotState& robot_state) const
+{
+  robot_unpadded_->checkSelfCollision(req, res, robot_state, acm_);
+}
+
 }  // end of namespace planning_scene
@@ -0,0 +1,199 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2026, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+// Micro-benchmarks for the moveit_core hot paths: forward kinematics updates, Jacobian computation,
+// collision checking and trajectory time parameterization. The results are written as JSON (to the
+// file given as the first argument, or to stdout) so that runs can be diffed between releases.
+
+#include <moveit_resources/config.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/trajectory_processing/iterative_time_parameterization.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <geometric_shapes/shapes.h>
+#include <boost/function.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+const std::string MODEL_NAME = "pr2_description";
+const std::string GROUP_NAME = "right_arm";  // 7-DOF chain of a dual-arm robot
+const unsigned int RANDOM_SEED = 42;
+
+struct BenchmarkRecord
+{
+  std::string name;
+  std::size_t iterations;
+  double total_seconds;
+};
+
+// time the given kernel for the requested number of iterations
+BenchmarkRecord measure(const std::string& name, std::size_t iterations, const boost::function<void()>& kernel)
+{
+  BenchmarkRecord record;
+  record.name = name;
+  record.iterations = iterations;
+  std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i)
+    kernel();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  record.total_seconds = elapsed.count();
+  std::cerr << name << ": " << iterations << " iterations, " << elapsed.count() * 1000. << "ms total, "
+            << elapsed.count() / (double)iterations * 1e6 << "us per iteration" << std::endl;
+  return record;
+}
+
+void writeJSON(std::ostream& out, const std::vector<BenchmarkRecord>& records)
+{
+  out << "{\n";
+  out << "  \"model\": \"" << MODEL_NAME << "\",\n";
+  out << "  \"group\": \"" << GROUP_NAME << "\",\n";
+  out << "  \"benchmarks\": [\n";
+  for (std::size_t i = 0; i < records.size(); ++i)
+  {
+    out << "    {\"name\": \"" << records[i].name << "\", \"iterations\": " << records[i].iterations
+        << ", \"total_seconds\": " << records[i].total_seconds
+        << ", \"mean_microseconds\": " << records[i].total_seconds / (double)records[i].iterations * 1e6 << "}"
+        << (i + 1 < records.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n";
+  out << "}\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel(MODEL_NAME);
+  if (!model)
+  {
+    std::cerr << "Failed to load robot model '" << MODEL_NAME << "'" << std::endl;
+    return 1;
+  }
+  const robot_model::JointModelGroup* group = model->getJointModelGroup(GROUP_NAME);
+  if (!group)
+  {
+    std::cerr << "Robot model has no group '" << GROUP_NAME << "'" << std::endl;
+    return 1;
+  }
+
+  planning_scene::PlanningScene scene(model);
+  // a cluttered table-top-like world for the world collision benchmark
+  for (int i = 0; i < 5; ++i)
+  {
+    Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+    pose.translation() = Eigen::Vector3d(0.7, -0.5 + 0.25 * i, 0.8);
+    scene.getWorldNonConst()->addToObject("box" + std::to_string(i),
+                                          shapes::ShapeConstPtr(new shapes::Box(0.1, 0.1, 0.3)), pose);
+  }
+
+  // states are drawn with a fixed seed outside the timed loops, so runs are comparable and only the
+  // kernels themselves are measured
+  random_numbers::RandomNumberGenerator rng(RANDOM_SEED);
+  const std::size_t num_states = 256;
+  std::vector<std::vector<double> > group_positions(num_states);
+  std::vector<robot_state::RobotStatePtr> states;
+  for (std::size_t i = 0; i < num_states; ++i)
+  {
+    robot_state::RobotStatePtr state(new robot_state::RobotState(model));
+    state->setToDefaultValues();
+    state->setToRandomPositions(group, rng);
+    state->update();
+    states.push_back(state);
+    state->copyJointGroupPositions(group, group_positions[i]);
+  }
+
+  std::vector<BenchmarkRecord> records;
+  robot_state::RobotState work_state(model);
+  work_state.setToDefaultValues();
+  work_state.update();
+
+  // forward kinematics: write new joint positions for the group and update the affected transforms
+  std::size_t index = 0;
+  records.push_back(measure("robot_state_update", 100000, [&] {
+    work_state.setJointGroupPositions(group, group_positions[index]);
+    work_state.update();
+    index = (index + 1) % num_states;
+  }));
+
+  // Jacobian of the group tip with respect to the group joints
+  Eigen::Vector3d reference_point(0.0, 0.0, 0.0);
+  Eigen::MatrixXd jacobian;
+  index = 0;
+  records.push_back(measure("jacobian", 100000, [&] {
+    jacobian = states[index]->getJacobian(group, reference_point);
+    index = (index + 1) % num_states;
+  }));
+
+  // self collision and robot-world collision checks through the FCL plugin
+  collision_detection::CollisionRequest req;
+  index = 0;
+  records.push_back(measure("collision_self", 10000, [&] {
+    collision_detection::CollisionResult res;
+    scene.checkSelfCollision(req, res, *states[index]);
+    index = (index + 1) % num_states;
+  }));
+  index = 0;
+  records.push_back(measure("collision_world", 10000, [&] {
+    collision_detection::CollisionResult res;
+    scene.checkCollision(req, res, *states[index]);
+    index = (index + 1) % num_states;
+  }));
+
+  // time parameterization of a fixed random trajectory; the trajectory is re-stamped in place, which
+  // is the steady-state cost of the algorithm
+  robot_trajectory::RobotTrajectory trajectory(model, group->getName());
+  for (std::size_t i = 0; i < 50; ++i)
+    trajectory.addSuffixWayPoint(*states[i % num_states], 0.0);
+  trajectory_processing::IterativeParabolicTimeParameterization time_param;
+  records.push_back(measure("time_parameterization", 1000, [&] { time_param.computeTimeStamps(trajectory); }));
+
+  if (argc > 1)
+  {
+    std::ofstream out(argv[1]);
+    if (!out)
+    {
+      std::cerr << "Failed to open '" << argv[1] << "' for benchmark output" << std::endl;
+      return 1;
+    }
+    writeJSON(out, records);
+    std::cerr << "Benchmark results saved to '" << argv[1] << "'" << std::endl;
+  }
+  else
+    writeJSON(std::cout, records);
+
+  return 0;
+}
@@ -37,6 +37,7 @@
 #include <gtest/gtest.h>
 #include <moveit/planning_scene/planning_scene.h>
 #include <urdf_parser/urdf_parser.h>
+#include <cmath>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -127,6 +128,38 @@ TEST(PlanningScene, LoadRestoreDiff)
   EXPECT_EQ(ps->getWorld()->size(), 2u);
 }
 
+TEST(PlanningScene, MoveObjectDiff)
+{
+  urdf::ModelInterfaceSharedPtr urdf_model;
+  loadRobotModel(urdf_model);
+  srdf::ModelSharedPtr srdf_model(new srdf::Model());
+
+  planning_scene::PlanningScenePtr ps(new planning_scene::PlanningScene(urdf_model, srdf_model));
+
+  Eigen::Isometry3d id = Eigen::Isometry3d::Identity();
+  ps->getWorldNonConst()->addToObject("sphere", shapes::ShapeConstPtr(new shapes::Sphere(0.4)), id);
+
+  planning_scene::PlanningScenePtr next = ps->diff();
+  Eigen::Isometry3d moved = Eigen::Isometry3d(Eigen::Translation3d(1.0, 0.0, 0.0));
+  EXPECT_TRUE(next->getWorldNonConst()->moveObject("sphere", moved));
+
+  // an object whose shapes only moved should be published as a pose-only MOVE diff
+  moveit_msgs::PlanningScene ps_msg;
+  next->getPlanningSceneDiffMsg(ps_msg);
+  ASSERT_EQ(ps_msg.world.collision_objects.size(), 1u);
+  const moveit_msgs::CollisionObject& co = ps_msg.world.collision_objects[0];
+  EXPECT_EQ(co.operation, moveit_msgs::CollisionObject::MOVE);
+  EXPECT_TRUE(co.primitives.empty());
+  ASSERT_EQ(co.primitive_poses.size(), 1u);
+  EXPECT_NEAR(co.primitive_poses[0].position.x, 1.0, 1e-12);
+
+  // applying the MOVE diff to the parent scene moves the object without re-sending geometry
+  EXPECT_TRUE(ps->processCollisionObjectMsg(co));
+  collision_detection::World::ObjectConstPtr obj = ps->getWorld()->getObject("sphere");
+  ASSERT_EQ(obj->shape_poses_.size(), 1u);
+  EXPECT_NEAR(obj->shape_poses_[0].translation().x(), 1.0, 1e-12);
+}
+
 TEST(PlanningScene, MakeAttachedDiff)
 {
   srdf::ModelSharedPtr srdf_model(new srdf::Model());
@@ -223,6 +256,102 @@ TEST(PlanningScene, loadBadSceneGeometry)
   EXPECT_FALSE(ps->loadGeometryFromStream(malformed_scene_geometry));
 }
 
+TEST(PlanningScene, NarrowedScene)
+{
+  srdf::ModelSharedPtr srdf_model(new srdf::Model());
+  urdf::ModelInterfaceSharedPtr urdf_model;
+  loadRobotModels(urdf_model, srdf_model);
+  planning_scene::PlanningScenePtr ps(new planning_scene::PlanningScene(urdf_model, srdf_model));
+
+  ps->getWorldNonConst()->addToObject("near_box", shapes::ShapeConstPtr(new shapes::Box(0.1, 0.1, 0.1)),
+                                      Eigen::Isometry3d(Eigen::Translation3d(0.7, -0.3, 0.8)));
+  ps->getWorldNonConst()->addToObject("far_box", shapes::ShapeConstPtr(new shapes::Box(0.1, 0.1, 0.1)),
+                                      Eigen::Isometry3d(Eigen::Translation3d(50.0, 0.0, 0.8)));
+
+  planning_scene::PlanningScenePtr narrowed = ps->createNarrowedScene("right_arm");
+  ASSERT_TRUE(narrowed != nullptr);
+  EXPECT_TRUE(narrowed->getWorld()->hasObject("near_box"));
+  EXPECT_FALSE(narrowed->getWorld()->hasObject("far_box"));
+
+  // the parent scene keeps all objects
+  EXPECT_TRUE(ps->getWorld()->hasObject("far_box"));
+  EXPECT_TRUE(ps->getWorld()->hasObject("near_box"));
+}
+
+TEST(PlanningScene, MeshSimplification)
+{
+  urdf::ModelInterfaceSharedPtr urdf_model;
+  loadRobotModel(urdf_model);
+  srdf::ModelSharedPtr srdf_model(new srdf::Model());
+  planning_scene::PlanningScene ps(urdf_model, srdf_model);
+
+  // a dense UV sphere mesh, the kind of geometry CAD exports produce
+  shape_msgs::Mesh mesh;
+  const int rings = 40, sectors = 40;
+  for (int r = 0; r <= rings; ++r)
+    for (int s = 0; s < sectors; ++s)
+    {
+      const double phi = M_PI * r / rings, theta = 2.0 * M_PI * s / sectors;
+      geometry_msgs::Point p;
+      p.x = std::sin(phi) * std::cos(theta);
+      p.y = std::sin(phi) * std::sin(theta);
+      p.z = std::cos(phi);
+      mesh.vertices.push_back(p);
+    }
+  for (int r = 0; r < rings; ++r)
+    for (int s = 0; s < sectors; ++s)
+    {
+      const int s1 = (s + 1) % sectors;
+      shape_msgs::MeshTriangle t1, t2;
+      t1.vertex_indices[0] = r * sectors + s;
+      t1.vertex_indices[1] = (r + 1) * sectors + s;
+      t1.vertex_indices[2] = (r + 1) * sectors + s1;
+      t2.vertex_indices[0] = r * sectors + s;
+      t2.vertex_indices[1] = (r + 1) * sectors + s1;
+      t2.vertex_indices[2] = r * sectors + s1;
+      mesh.triangles.push_back(t1);
+      mesh.triangles.push_back(t2);
+    }
+  const unsigned int full_triangle_count = mesh.triangles.size();
+
+  moveit_msgs::CollisionObject co;
+  co.id = "cad_part";
+  co.header.frame_id = ps.getPlanningFrame();
+  co.operation = moveit_msgs::CollisionObject::ADD;
+  co.meshes.push_back(mesh);
+  co.mesh_poses.push_back(geometry_msgs::Pose());
+  co.mesh_poses[0].orientation.w = 1.0;
+
+  // the default policy keeps the mesh as received
+  ASSERT_TRUE(ps.processCollisionObjectMsg(co));
+  const shapes::Mesh* ingested =
+      static_cast<const shapes::Mesh*>(ps.getWorld()->getObject("cad_part")->shapes_[0].get());
+  EXPECT_EQ(ingested->triangle_count, full_triangle_count);
+
+  // decimation respects the triangle budget
+  ps.setMeshSimplification(planning_scene::PlanningScene::MESH_FIDELITY_DECIMATED, 500);
+  ASSERT_TRUE(ps.processCollisionObjectMsg(co));
+  ingested = static_cast<const shapes::Mesh*>(ps.getWorld()->getObject("cad_part")->shapes_[0].get());
+  EXPECT_LE(ingested->triangle_count, 500u);
+  EXPECT_GT(ingested->triangle_count, 0u);
+
+  // the simplified mesh is cached by content: a second object with the same mesh shares it
+  moveit_msgs::CollisionObject co_copy = co;
+  co_copy.id = "cad_part_copy";
+  ASSERT_TRUE(ps.processCollisionObjectMsg(co_copy));
+  EXPECT_EQ(ps.getWorld()->getObject("cad_part")->shapes_[0].get(),
+            ps.getWorld()->getObject("cad_part_copy")->shapes_[0].get());
+
+  // a per-object override keeps selected objects at full resolution
+  ps.setObjectMeshFidelity("grasped_part", planning_scene::PlanningScene::MESH_FIDELITY_FULL);
+  moveit_msgs::CollisionObject co_grasped = co;
+  co_grasped.id = "grasped_part";
+  ASSERT_TRUE(ps.processCollisionObjectMsg(co_grasped));
+  EXPECT_EQ(static_cast<const shapes::Mesh*>(ps.getWorld()->getObject("grasped_part")->shapes_[0].get())
+                ->triangle_count,
+            full_triangle_count);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -57,6 +57,11 @@
 #include <map>
 #include <string>
 #include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include <boost/thread.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -131,7 +136,7 @@ public:
   /** \brief Destructor */
   ~Profiler(void)
   {
-    if (printOnDestroy_ && !data_.empty())
+    if (printOnDestroy_ && (!data_.empty() || !thread_logs_.empty()))
       status();
   }
 
@@ -222,10 +227,29 @@ public:
       events to the console (using msg::Console) */
   void console(void);
 
+  /** \brief Export the recorded begin/end markers in chrome://tracing JSON format. The output can be
+      loaded in chrome://tracing or https://ui.perfetto.dev to inspect a timeline per thread. */
+  static void DumpChromeTrace(std::ostream& out = std::cout)
+  {
+    instance().dumpChromeTrace(out);
+  }
+
+  /** \brief Export the recorded begin/end markers in chrome://tracing JSON format */
+  void dumpChromeTrace(std::ostream& out = std::cout);
+
+  /** \brief Retrieve the event counts recorded since the last clear, summed over all threads */
+  static void GetEventCounts(std::map<std::string, unsigned long int>& events)
+  {
+    instance().getEventCounts(events);
+  }
+
+  /** \brief Retrieve the event counts recorded since the last clear, summed over all threads */
+  void getEventCounts(std::map<std::string, unsigned long int>& events);
+
   /** \brief Check if the profiler is counting time or not */
   bool running(void) const
   {
-    return running_;
+    return running_.load(std::memory_order_relaxed);
   }
 
   /** \brief Check if the profiler is counting time or not */
@@ -303,12 +327,45 @@ private:
     std::map<std::string, TimeInfo> time;
   };
 
+  /** \brief A single begin or end marker recorded on the hot path */
+  struct MarkerEvent
+  {
+    /** \brief Interned name of the block this marker belongs to */
+    unsigned int name_id;
+
+    /** \brief True for a begin marker, false for an end marker */
+    bool begin;
+
+    /** \brief Time stamp in microseconds since an arbitrary (steady clock) epoch */
+    std::uint64_t stamp;
+  };
+
+  /** \brief Buffer of markers recorded by one thread. The buffer has its own mutex, which is
+      uncontended while recording and only shared with the thread flushing the markers. */
+  struct ThreadLog
+  {
+    boost::mutex lock;
+    std::vector<MarkerEvent> markers;
+  };
+
+  /** \brief Get the calling thread's marker buffer, registering it on first use */
+  ThreadLog* threadLog(void);
+
+  /** \brief Map a block name to a small integer id, caching the mapping per thread */
+  unsigned int internName(const std::string& name);
+
+  /** \brief Aggregate the markers of one thread into the per-name timing statistics */
+  void replayThreadLog(const ThreadLog& log, PerThread& data) const;
+
   void printThreadInfo(std::ostream& out, const PerThread& data);
 
   boost::mutex lock_;
   std::map<boost::thread::id, PerThread> data_;
+  std::vector<std::pair<boost::thread::id, std::shared_ptr<ThreadLog> > > thread_logs_;
+  std::unordered_map<std::string, unsigned int> name_ids_;
+  std::vector<std::string> names_;
   TimeInfo tinfo_;
-  bool running_;
+  std::atomic<bool> running_;
   bool printOnDestroy_;
 };
 }
@@ -316,6 +373,7 @@ private:
 
 #else
 
+#include <map>
 #include <string>
 #include <iostream>
 
@@ -434,6 +492,24 @@ public:
   {
   }
 
+  static void DumpChromeTrace(std::ostream& = std::cout)
+  {
+  }
+
+  void dumpChromeTrace(std::ostream& = std::cout)
+  {
+  }
+
+  static void GetEventCounts(std::map<std::string, unsigned long int>& events)
+  {
+    events.clear();
+  }
+
+  void getEventCounts(std::map<std::string, unsigned long int>& events)
+  {
+    events.clear();
+  }
+
   bool running(void) const
   {
     return false;
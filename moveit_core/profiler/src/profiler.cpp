@@ -40,6 +40,7 @@
 #include <ros/console.h>
 #include <vector>
 #include <algorithm>
+#include <chrono>
 #include <sstream>
 
 namespace moveit
@@ -78,6 +79,11 @@ void Profiler::clear()
 {
   lock_.lock();
   data_.clear();
+  for (std::size_t i = 0; i < thread_logs_.size(); ++i)
+  {
+    boost::mutex::scoped_lock slock(thread_logs_[i].second->lock);
+    thread_logs_[i].second->markers.clear();
+  }
   tinfo_ = TimeInfo();
   if (running_)
     tinfo_.set();
@@ -91,6 +97,17 @@ void Profiler::event(const std::string& name, const unsigned int times)
   lock_.unlock();
 }
 
+void Profiler::getEventCounts(std::map<std::string, unsigned long int>& events)
+{
+  events.clear();
+  lock_.lock();
+  for (std::map<boost::thread::id, PerThread>::const_iterator it = data_.begin(); it != data_.end(); ++it)
+    for (std::map<std::string, unsigned long int>::const_iterator iev = it->second.events.begin();
+         iev != it->second.events.end(); ++iev)
+      events[iev->first] += iev->second;
+  lock_.unlock();
+}
+
 void Profiler::average(const std::string& name, const double value)
 {
   lock_.lock();
@@ -101,18 +118,99 @@ void Profiler::average(const std::string& name, const double value)
   lock_.unlock();
 }
 
+namespace
+{
+inline std::uint64_t now_microseconds()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}
+
+Profiler::ThreadLog* Profiler::threadLog()
+{
+  // cache the buffer pointer per thread and per profiler instance, so the registry
+  // lock is only taken the first time a thread records a marker
+  thread_local std::map<const Profiler*, ThreadLog*> logs;
+  ThreadLog*& log = logs[this];
+  if (!log)
+  {
+    std::shared_ptr<ThreadLog> new_log(new ThreadLog());
+    boost::mutex::scoped_lock slock(lock_);
+    thread_logs_.push_back(std::make_pair(boost::this_thread::get_id(), new_log));
+    log = new_log.get();
+  }
+  return log;
+}
+
+unsigned int Profiler::internName(const std::string& name)
+{
+  // per-thread cache of the global name table, so repeated markers hash a string
+  // locally instead of taking the registry lock
+  thread_local std::map<const Profiler*, std::unordered_map<std::string, unsigned int> > caches;
+  std::unordered_map<std::string, unsigned int>& cache = caches[this];
+  std::unordered_map<std::string, unsigned int>::const_iterator it = cache.find(name);
+  if (it != cache.end())
+    return it->second;
+  boost::mutex::scoped_lock slock(lock_);
+  std::pair<std::unordered_map<std::string, unsigned int>::iterator, bool> inserted =
+      name_ids_.insert(std::make_pair(name, static_cast<unsigned int>(names_.size())));
+  if (inserted.second)
+    names_.push_back(name);
+  cache[name] = inserted.first->second;
+  return inserted.first->second;
+}
+
 void Profiler::begin(const std::string& name)
 {
-  lock_.lock();
-  data_[boost::this_thread::get_id()].time[name].set();
-  lock_.unlock();
+  if (!running_.load(std::memory_order_relaxed))
+    return;
+  MarkerEvent ev;
+  ev.name_id = internName(name);
+  ev.begin = true;
+  ev.stamp = now_microseconds();
+  ThreadLog* log = threadLog();
+  boost::mutex::scoped_lock slock(log->lock);
+  log->markers.push_back(ev);
 }
 
 void Profiler::end(const std::string& name)
 {
-  lock_.lock();
-  data_[boost::this_thread::get_id()].time[name].update();
-  lock_.unlock();
+  if (!running_.load(std::memory_order_relaxed))
+    return;
+  MarkerEvent ev;
+  ev.name_id = internName(name);
+  ev.begin = false;
+  ev.stamp = now_microseconds();
+  ThreadLog* log = threadLog();
+  boost::mutex::scoped_lock slock(log->lock);
+  log->markers.push_back(ev);
+}
+
+void Profiler::replayThreadLog(const ThreadLog& log, PerThread& data) const
+{
+  std::map<unsigned int, std::uint64_t> open;
+  for (std::size_t i = 0; i < log.markers.size(); ++i)
+  {
+    const MarkerEvent& ev = log.markers[i];
+    if (ev.begin)
+      open[ev.name_id] = ev.stamp;
+    else
+    {
+      std::map<unsigned int, std::uint64_t>::iterator it = open.find(ev.name_id);
+      if (it == open.end())
+        continue;  // end marker without a matching begin (e.g. profiler started mid-block)
+      TimeInfo& t = data.time[names_[ev.name_id]];
+      const boost::posix_time::time_duration dt = boost::posix_time::microseconds(ev.stamp - it->second);
+      if (dt > t.longest)
+        t.longest = dt;
+      if (dt < t.shortest)
+        t.shortest = dt;
+      t.total = t.total + dt;
+      ++t.parts;
+      open.erase(it);
+    }
+  }
 }
 
 namespace
@@ -129,13 +227,21 @@ void Profiler::status(std::ostream& out, bool merge)
   lock_.lock();
   printOnDestroy_ = false;
 
+  // combine the aggregated events and averages with the buffered begin/end markers
+  std::map<boost::thread::id, PerThread> data = data_;
+  for (std::size_t i = 0; i < thread_logs_.size(); ++i)
+  {
+    boost::mutex::scoped_lock slock(thread_logs_[i].second->lock);
+    replayThreadLog(*thread_logs_[i].second, data[thread_logs_[i].first]);
+  }
+
   out << std::endl;
   out << " *** Profiling statistics. Total counted time : " << to_seconds(tinfo_.total) << " seconds" << std::endl;
 
   if (merge)
   {
     PerThread combined;
-    for (std::map<boost::thread::id, PerThread>::const_iterator it = data_.begin(); it != data_.end(); ++it)
+    for (std::map<boost::thread::id, PerThread>::const_iterator it = data.begin(); it != data.end(); ++it)
     {
       for (std::map<std::string, unsigned long int>::const_iterator iev = it->second.events.begin();
            iev != it->second.events.end(); ++iev)
@@ -162,7 +268,7 @@ void Profiler::status(std::ostream& out, bool merge)
     printThreadInfo(out, combined);
   }
   else
-    for (std::map<boost::thread::id, PerThread>::const_iterator it = data_.begin(); it != data_.end(); ++it)
+    for (std::map<boost::thread::id, PerThread>::const_iterator it = data.begin(); it != data.end(); ++it)
     {
       out << "Thread " << it->first << ":" << std::endl;
       printThreadInfo(out, it->second);
@@ -178,6 +284,35 @@ void Profiler::console()
   ROS_INFO_STREAM_NAMED("profiler", ss.str());
 }
 
+void Profiler::dumpChromeTrace(std::ostream& out)
+{
+  boost::mutex::scoped_lock slock(lock_);
+  out << "[\n";
+  bool first = true;
+  for (std::size_t i = 0; i < thread_logs_.size(); ++i)
+  {
+    boost::mutex::scoped_lock log_lock(thread_logs_[i].second->lock);
+    const std::vector<MarkerEvent>& markers = thread_logs_[i].second->markers;
+    for (std::size_t j = 0; j < markers.size(); ++j)
+    {
+      if (!first)
+        out << ",\n";
+      first = false;
+      out << "{\"name\":\"";
+      const std::string& name = names_[markers[j].name_id];
+      for (std::size_t k = 0; k < name.size(); ++k)
+      {
+        if (name[k] == '"' || name[k] == '\\')
+          out << '\\';
+        out << name[k];
+      }
+      out << "\",\"cat\":\"moveit\",\"ph\":\"" << (markers[j].begin ? 'B' : 'E') << "\",\"ts\":" << markers[j].stamp
+          << ",\"pid\":0,\"tid\":" << i << "}";
+    }
+  }
+  out << "\n]\n";
+}
+
 /// @cond IGNORE
 namespace
 {
@@ -133,9 +133,23 @@ public:
   /** \brief Check if a joint is part of this group */
   bool hasJointModel(const std::string& joint) const;
 
+  /** \brief Check if a joint is part of this group, by pointer. This is a constant-time table
+      lookup, suitable for hot loops (e.g. Jacobian computation) */
+  bool hasJointModel(const JointModel* joint) const
+  {
+    return joint_in_group_[joint->getJointIndex()] != 0;
+  }
+
   /** \brief Check if a link is part of this group */
   bool hasLinkModel(const std::string& link) const;
 
+  /** \brief Check if a link is part of this group, by pointer. This is a constant-time table
+      lookup, suitable for hot loops */
+  bool hasLinkModel(const LinkModel* link) const
+  {
+    return link_in_group_[link->getLinkIndex()] != 0;
+  }
+
   /** \brief Get a joint by its name. Throw an exception if the joint is not part of this group. */
   const JointModel* getJointModel(const std::string& joint) const;
 
@@ -284,6 +298,21 @@ public:
     return updated_link_model_name_set_.find(name) != updated_link_model_name_set_.end();
   }
 
+  /** \brief Same as isLinkUpdated(const std::string&), but by pointer; a constant-time table
+      lookup instead of a set search */
+  bool isLinkUpdated(const LinkModel* link) const
+  {
+    return link_updated_by_group_[link->getLinkIndex()] != 0;
+  }
+
+  /** \brief Get LinkModel::getLinkIndex() for each link of getUpdatedLinkModels(), in the same
+      (update) order. This is the flat link indexing the SoA FK engine uses, so group-scoped FK
+      consumers can walk the update order without touching LinkModel instances */
+  const std::vector<int>& getUpdatedLinkIndexList() const
+  {
+    return updated_link_index_list_;
+  }
+
   /** \brief Get the index locations in the complete robot state for all the variables in this group */
   const std::vector<int>& getVariableIndexList() const
   {
@@ -293,6 +322,13 @@ public:
   /** \brief Get the index of a variable within the group. Return -1 on error. */
   int getVariableGroupIndex(const std::string& variable) const;
 
+  /** \brief Get the group index of the first variable of \e joint. Return -1 if the joint is not
+      part of this group or has no variables. Constant-time table lookup, for use in hot loops */
+  int getVariableGroupIndex(const JointModel* joint) const
+  {
+    return joint_variable_group_index_[joint->getJointIndex()];
+  }
+
   /** \brief Get the names of the known default states (as specified in the SRDF) */
   const std::vector<std::string>& getDefaultStateNames() const
   {
@@ -379,6 +415,23 @@ public:
                                         const JointBoundsVector& active_joint_bounds, const double* near,
                                         const std::vector<double>& distances) const;
 
+  /** \brief Sample \e n_states complete group states in one call. \e values must have room for
+      n_states * getVariableCount() doubles, one state after the other. Variables of single-DOF
+      revolute and prismatic joints are filled from flat bounds arrays using a batched xoshiro
+      generator seeded from \e rng (runs stay reproducible for a fixed seed, but the sequence
+      differs from the one-joint-at-a-time sampler); planar and floating joints fall back to the
+      per-joint samplers. Mimic joints are updated for every state. Uses the default variable
+      bounds of the model. */
+  void getVariableRandomPositionsBatch(random_numbers::RandomNumberGenerator& rng, double* values,
+                                       std::size_t n_states) const;
+
+  /** \brief Batched version of getVariableRandomPositionsNearBy(): sample \e n_states group
+      states at most \e distance away from \e near (a single shared center state), with clamping
+      to the default variable bounds done in the same flat pass. See
+      getVariableRandomPositionsBatch() for the storage layout and sampling details. */
+  void getVariableRandomPositionsNearByBatch(random_numbers::RandomNumberGenerator& rng, double* values,
+                                             std::size_t n_states, const double* near, double distance) const;
+
   bool enforcePositionBounds(double* state) const
   {
     return enforcePositionBounds(state, active_joint_models_bounds_);
@@ -689,6 +742,43 @@ protected:
    * this group) */
   std::set<std::string> updated_link_model_with_geometry_name_set_;
 
+  /** \brief For each joint of the parent model (indexed by JointModel::getJointIndex()), whether
+      the joint is part of this group. Flattened for constant-time membership tests */
+  std::vector<unsigned char> joint_in_group_;
+
+  /** \brief For each link of the parent model (indexed by LinkModel::getLinkIndex()), whether
+      the link is part of this group */
+  std::vector<unsigned char> link_in_group_;
+
+  /** \brief For each link of the parent model (indexed by LinkModel::getLinkIndex()), whether
+      the link is in updated_link_model_set_ */
+  std::vector<unsigned char> link_updated_by_group_;
+
+  /** \brief For each joint of the parent model (indexed by JointModel::getJointIndex()), the
+      group index of the joint's first variable, or -1 if the joint is not part of this group or
+      has no variables */
+  std::vector<int> joint_variable_group_index_;
+
+  /** \brief LinkModel::getLinkIndex() of every entry of updated_link_model_vector_, in the same
+      (update) order; matches the flat link indexing of the SoA FK engine */
+  std::vector<int> updated_link_index_list_;
+
+  /** \brief Group variable index of every variable owned by a single-DOF revolute or prismatic
+      joint; these can be sampled straight from the flat bounds arrays below */
+  std::vector<int> simple_sample_variable_index_;
+
+  /** \brief Lower/upper position bound for each entry of simple_sample_variable_index_ */
+  std::vector<double> simple_sample_min_;
+  std::vector<double> simple_sample_max_;
+
+  /** \brief Whether each entry of simple_sample_variable_index_ belongs to a continuous joint
+      (near-by sampling wraps instead of clamping for those) */
+  std::vector<unsigned char> simple_sample_continuous_;
+
+  /** \brief Indices (into active_joint_model_vector_) of active joints not covered by the flat
+      sampling arrays (planar, floating); these use the per-joint samplers */
+  std::vector<std::size_t> complex_sample_joint_index_;
+
   /** \brief The number of variables necessary to describe this group of joints */
   unsigned int variable_count_;
 
@@ -53,6 +53,7 @@
 
 #include <Eigen/Geometry>
 #include <iostream>
+#include <mutex>
 
 /** \brief Main namespace for MoveIt! */
 namespace moveit
@@ -61,6 +62,7 @@ namespace moveit
 namespace core
 {
 MOVEIT_CLASS_FORWARD(RobotModel);
+MOVEIT_CLASS_FORWARD(SoAFkEngine);
 
 /** \brief Definition of a kinematic model. This class is not thread
     safe, however multiple instances can be created */
@@ -435,6 +437,62 @@ public:
   /// A map of known kinematics solvers (associated to their group name)
   void setKinematicsAllocators(const std::map<std::string, SolverAllocatorFn>& allocators);
 
+  /** \brief Enable (or disable) the structure-of-arrays FK engine for this model.
+      When enabled, RobotState uses a linear sweep over flat per-link arrays instead of the
+      pointer-based tree walk whenever all link transforms need to be recomputed. */
+  void setSoAFkEnabled(bool flag);
+
+  /** \brief Get the structure-of-arrays FK engine, or NULL if it is not enabled */
+  const SoAFkEngine* getSoAFkEngine() const
+  {
+    return soa_fk_engine_.get();
+  }
+
+  /** \brief Compute the global link transforms for \e n_states states stored back-to-back in
+      \e variable_positions (stride = getVariableCount(); mimic variables must be filled in).
+      \e global_link_transforms receives getLinkModelCount() transforms per state, back-to-back.
+      This amortizes per-call overhead for callers that evaluate FK for many sampled states
+      (e.g. state validity checking in sampling-based planners). The SoA FK engine is built
+      lazily on first use if it has not been enabled explicitly. */
+  void computeTransformsBatch(const double* variable_positions, std::size_t n_states,
+                              Eigen::Isometry3d* global_link_transforms) const;
+
+  /** \brief Precomputed cut of the kinematic tree used for parallel forward kinematics:
+      a serial prefix of links running from the root to the first significant branching point,
+      followed by the roots of the subtrees hanging off that prefix. No subtree root is an
+      ancestor of another, so once the prefix transforms are known the subtrees can be updated
+      concurrently. For models that are a single chain the list of subtree roots is empty. */
+  struct FkPartition
+  {
+    /** \brief Links whose transforms must be computed serially (in this order) before the subtrees */
+    std::vector<const LinkModel*> prefix_links_;
+
+    /** \brief Joints rooting the pairwise independent subtrees below the prefix */
+    std::vector<const JointModel*> subtree_roots_;
+  };
+
+  /** \brief Get the partition of the kinematic tree for parallel forward kinematics */
+  const FkPartition& getFkPartition() const
+  {
+    return fk_partition_;
+  }
+
+  /** \brief Enable (or disable) parallel forward kinematics for states of this model.
+      When enabled, full-state link transform updates fan the subtrees of the FK partition
+      out over the process-wide task scheduler. Updates then block on the scheduler, so only
+      enable this for models updated from threads that can tolerate that (in particular, not
+      while holding locks that queued tasks may also take). Disabled by default. */
+  void setParallelFkEnabled(bool flag)
+  {
+    parallel_fk_enabled_ = flag;
+  }
+
+  /** \brief Whether parallel forward kinematics is enabled for states of this model */
+  bool isParallelFkEnabled() const
+  {
+    return parallel_fk_enabled_;
+  }
+
 protected:
   /** \brief Get the transforms between link and all its rigidly attached descendants */
   void computeFixedTransforms(const LinkModel* link, const Eigen::Isometry3d& transform,
@@ -527,6 +585,12 @@ protected:
    */
   std::vector<int> common_joint_roots_;
 
+  /** \brief The partition of the tree into a serial prefix and independent subtrees (see getFkPartition()) */
+  FkPartition fk_partition_;
+
+  /** \brief Whether states of this model update their link transforms in parallel (see setParallelFkEnabled()) */
+  bool parallel_fk_enabled_;
+
   // INDEXING
 
   /** \brief The names of the DOF that make up this state (this is just a sequence of joint variable names; not
@@ -569,6 +633,14 @@ protected:
   /** \brief The array of end-effectors, in alphabetical order */
   std::vector<const JointModelGroup*> end_effectors_;
 
+  /** \brief Optional structure-of-arrays FK engine (see setSoAFkEnabled()); mutable so that
+      computeTransformsBatch() can build it lazily on a const model */
+  mutable SoAFkEngineConstPtr soa_fk_engine_;
+
+  /** \brief Guards soa_fk_engine_ against concurrent creation and destruction; batched FK is
+      called from multiple threads and may race setSoAFkEnabled() */
+  mutable std::mutex soa_fk_lock_;
+
   /** \brief Given an URDF model and a SRDF model, build a full kinematic model */
   void buildModel(const urdf::ModelInterface& urdf_model, const srdf::Model& srdf_model);
 
@@ -596,6 +668,9 @@ protected:
   /** \brief For every pair of joints, pre-compute the common roots of the joints */
   void computeCommonRoots();
 
+  /** \brief Compute the serial prefix / independent subtrees partition used for parallel FK */
+  void computeFkPartition();
+
   /** \brief (This function is mostly intended for internal use). Given a parent link, build up (recursively),
       the kinematic model by walking  down the tree*/
   JointModel* buildRecursive(LinkModel* parent, const urdf::Link* link, const srdf::Model& srdf_model);
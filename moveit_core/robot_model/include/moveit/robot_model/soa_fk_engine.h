@@ -0,0 +1,130 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt Team.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Author: MoveIt Team */
+
+#ifndef MOVEIT_CORE_ROBOT_MODEL_SOA_FK_ENGINE_
+#define MOVEIT_CORE_ROBOT_MODEL_SOA_FK_ENGINE_
+
+#include <moveit/macros/class_forward.h>
+#include <eigen_stl_containers/eigen_stl_containers.h>
+#include <Eigen/Geometry>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+class RobotModel;
+class JointModel;
+
+MOVEIT_CLASS_FORWARD(SoAFkEngine);
+
+/** \brief Forward kinematics engine that stores the per-link data needed by the FK sweep
+    (parent indices, joint origins, joint axes, variable indices) in contiguous arrays laid
+    out in kinematic-tree order.
+
+    The regular FK update in RobotState walks LinkModel pointers and dispatches virtually on
+    the joint type for every link. When many FK evaluations are performed per second (e.g.
+    collision-checked sampling-based planning), the pointer chasing and dispatch dominate.
+    This engine flattens the kinematic tree once at construction so that computing all global
+    link transforms is a single linear pass over flat arrays.
+
+    The engine is owned by RobotModel (see RobotModel::setSoAFkEnabled()) and is picked up
+    transparently by RobotState when all link transforms need to be recomputed. */
+class SoAFkEngine
+{
+public:
+  /** \brief Flatten the kinematic tree of \e model into SoA buffers */
+  SoAFkEngine(const RobotModel& model);
+
+  /** \brief Compute the global transforms of all links in tree order.
+      \e variable_positions must hold all model variables (mimic values included);
+      \e global_link_transforms must have room for RobotModel::getLinkModelCount() transforms */
+  void computeTransforms(const double* variable_positions, Eigen::Isometry3d* global_link_transforms) const;
+
+  /** \brief Compute global link transforms for \e n_states states in one call.
+      \e variable_positions holds the states back-to-back (stride = number of model variables);
+      \e global_link_transforms receives the per-state transforms back-to-back
+      (stride = RobotModel::getLinkModelCount()). Evaluating many states in one call amortizes
+      per-call overhead and allows prefetching the next state's variables while the current
+      state is being processed. */
+  void computeTransformsBatch(const double* variable_positions, std::size_t n_states,
+                              Eigen::Isometry3d* global_link_transforms) const;
+
+  std::size_t getLinkCount() const
+  {
+    return parent_link_index_.size();
+  }
+
+private:
+  /** \brief Compact classification of the joint preceding each link, so the FK sweep can
+      inline the common single-DOF cases and only fall back to virtual dispatch for
+      planar/floating joints */
+  enum JointKind : unsigned char
+  {
+    KIND_FIXED = 0,
+    KIND_REVOLUTE,
+    KIND_PRISMATIC,
+    KIND_GENERIC
+  };
+
+  /// Index of the parent link for each link (-1 for the root link), in tree order
+  std::vector<int> parent_link_index_;
+
+  /// Index of the first state variable of the parent joint of each link
+  std::vector<int> first_variable_index_;
+
+  /// Classification of the parent joint of each link
+  std::vector<unsigned char> joint_kind_;
+
+  /// Whether the joint origin transform of each link is the identity
+  std::vector<unsigned char> origin_identity_;
+
+  /// Joint origin transform of each link (constant part of the local transform)
+  EigenSTL::vector_Isometry3d joint_origin_;
+
+  /// Joint axis for revolute/prismatic parent joints (unused entries are zero)
+  EigenSTL::vector_Vector3d joint_axis_;
+
+  /// Parent joint of each link; only dereferenced for KIND_GENERIC joints
+  std::vector<const JointModel*> parent_joint_;
+
+  /// Number of variables of the model; the per-state stride for computeTransformsBatch()
+  std::size_t variable_count_;
+};
+}  // namespace core
+}  // namespace moveit
+
+#endif
@@ -40,7 +40,11 @@
 #include <moveit/robot_model/revolute_joint_model.h>
 #include <moveit/exceptions/exceptions.h>
 #include <boost/lexical_cast.hpp>
+#include <boost/math/constants/constants.hpp>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include "order_robot_model_items.inc"
 
 namespace moveit
@@ -243,6 +247,48 @@ JointModelGroup::JointModelGroup(const std::string& group_name, const srdf::Mode
   for (std::size_t i = 0; i < updated_link_model_with_geometry_vector_.size(); ++i)
     updated_link_model_with_geometry_name_vector_.push_back(updated_link_model_with_geometry_vector_[i]->getName());
 
+  // build flattened membership and index tables so hot queries (Jacobian loops, collision
+  // filtering) resolve joints and links in constant time instead of through maps or sets
+  joint_in_group_.resize(parent_model->getJointModelCount(), 0);
+  joint_variable_group_index_.resize(parent_model->getJointModelCount(), -1);
+  for (std::size_t i = 0; i < joint_model_vector_.size(); ++i)
+  {
+    joint_in_group_[joint_model_vector_[i]->getJointIndex()] = 1;
+    if (joint_model_vector_[i]->getVariableCount() > 0)
+      joint_variable_group_index_[joint_model_vector_[i]->getJointIndex()] =
+          joint_variables_index_map_[joint_model_vector_[i]->getName()];
+  }
+  link_in_group_.resize(parent_model->getLinkModelCount(), 0);
+  for (std::size_t i = 0; i < link_model_vector_.size(); ++i)
+    link_in_group_[link_model_vector_[i]->getLinkIndex()] = 1;
+  link_updated_by_group_.resize(parent_model->getLinkModelCount(), 0);
+  updated_link_index_list_.reserve(updated_link_model_vector_.size());
+  for (std::size_t i = 0; i < updated_link_model_vector_.size(); ++i)
+  {
+    link_updated_by_group_[updated_link_model_vector_[i]->getLinkIndex()] = 1;
+    updated_link_index_list_.push_back(updated_link_model_vector_[i]->getLinkIndex());
+  }
+
+  // precompile flat bounds arrays for batched sampling; single-DOF revolute and prismatic
+  // joints can be sampled without virtual dispatch, the rest keeps the per-joint samplers
+  for (std::size_t i = 0; i < active_joint_model_vector_.size(); ++i)
+  {
+    const JointModel* jm = active_joint_model_vector_[i];
+    if (jm->getType() == JointModel::REVOLUTE || jm->getType() == JointModel::PRISMATIC)
+    {
+      const VariableBounds& b = jm->getVariableBounds()[0];
+      simple_sample_variable_index_.push_back(active_joint_model_start_index_[i]);
+      simple_sample_min_.push_back(b.min_position_);
+      simple_sample_max_.push_back(b.max_position_);
+      simple_sample_continuous_.push_back(jm->getType() == JointModel::REVOLUTE &&
+                                                  static_cast<const RevoluteJointModel*>(jm)->isContinuous() ?
+                                              1 :
+                                              0);
+    }
+    else
+      complex_sample_joint_index_.push_back(i);
+  }
+
   // check if this group should actually be a chain
   if (joint_roots_.size() == 1 && !active_joint_model_vector_.empty())
   {
@@ -309,6 +355,103 @@ const JointModel* JointModelGroup::getJointModel(const std::string& name) const
   return it->second;
 }
 
+namespace
+{
+/** xoshiro256+ generator for bulk uniform doubles. Sampling-based planners draw millions of
+    group states per plan; generating the uniforms in a tight, inlineable loop is much cheaper
+    than going through the distribution machinery behind RandomNumberGenerator per variable.
+    Seeded from the caller's generator, so runs stay reproducible for a fixed seed. */
+struct BatchRandom
+{
+  explicit BatchRandom(random_numbers::RandomNumberGenerator& rng)
+  {
+    for (int i = 0; i < 4; ++i)
+      s_[i] = (static_cast<std::uint64_t>(rng.uniformInteger(0, std::numeric_limits<int>::max())) << 32) ^
+              static_cast<std::uint64_t>(rng.uniformInteger(0, std::numeric_limits<int>::max()));
+    s_[0] |= 1;  // avoid the all-zero state
+  }
+
+  std::uint64_t next()
+  {
+    const std::uint64_t result = s_[0] + s_[3];
+    const std::uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = (s_[3] << 45) | (s_[3] >> 19);
+    return result;
+  }
+
+  /// Uniform double in [0, 1), using the upper 53 bits
+  double uniform01()
+  {
+    return (next() >> 11) * (1.0 / 9007199254740992.0);  // 2^-53
+  }
+
+  std::uint64_t s_[4];
+};
+}
+
+void JointModelGroup::getVariableRandomPositionsBatch(random_numbers::RandomNumberGenerator& rng, double* values,
+                                                      std::size_t n_states) const
+{
+  BatchRandom brng(rng);
+  for (std::size_t s = 0; s < n_states; ++s)
+  {
+    double* state = values + s * variable_count_;
+    for (std::size_t k = 0; k < simple_sample_variable_index_.size(); ++k)
+      state[simple_sample_variable_index_[k]] =
+          simple_sample_min_[k] + brng.uniform01() * (simple_sample_max_[k] - simple_sample_min_[k]);
+    for (std::size_t j = 0; j < complex_sample_joint_index_.size(); ++j)
+    {
+      const std::size_t i = complex_sample_joint_index_[j];
+      active_joint_model_vector_[i]->getVariableRandomPositions(rng, state + active_joint_model_start_index_[i],
+                                                                *active_joint_models_bounds_[i]);
+    }
+    updateMimicJoints(state);
+  }
+}
+
+void JointModelGroup::getVariableRandomPositionsNearByBatch(random_numbers::RandomNumberGenerator& rng, double* values,
+                                                            std::size_t n_states, const double* near,
+                                                            double distance) const
+{
+  BatchRandom brng(rng);
+  for (std::size_t s = 0; s < n_states; ++s)
+  {
+    double* state = values + s * variable_count_;
+    for (std::size_t k = 0; k < simple_sample_variable_index_.size(); ++k)
+    {
+      const int vi = simple_sample_variable_index_[k];
+      if (simple_sample_continuous_[k])
+      {
+        // continuous joints wrap instead of clamping, matching the per-joint near-by sampler
+        double v = near[vi] - distance + brng.uniform01() * 2.0 * distance;
+        v = fmod(v + boost::math::constants::pi<double>(), 2.0 * boost::math::constants::pi<double>());
+        if (v < 0.0)
+          v += 2.0 * boost::math::constants::pi<double>();
+        state[vi] = v - boost::math::constants::pi<double>();
+      }
+      else
+      {
+        const double lo = std::max(simple_sample_min_[k], near[vi] - distance);
+        const double hi = std::min(simple_sample_max_[k], near[vi] + distance);
+        state[vi] = lo + brng.uniform01() * (hi - lo);
+      }
+    }
+    for (std::size_t j = 0; j < complex_sample_joint_index_.size(); ++j)
+    {
+      const std::size_t i = complex_sample_joint_index_[j];
+      active_joint_model_vector_[i]->getVariableRandomPositionsNearBy(
+          rng, state + active_joint_model_start_index_[i], *active_joint_models_bounds_[i],
+          near + active_joint_model_start_index_[i], distance);
+    }
+    updateMimicJoints(state);
+  }
+}
+
 void JointModelGroup::getVariableRandomPositions(random_numbers::RandomNumberGenerator& rng, double* values,
                                                  const JointBoundsVector& active_joint_bounds) const
 {
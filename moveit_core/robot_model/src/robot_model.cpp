@@ -36,6 +36,7 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_model/soa_fk_engine.h>
 #include <geometric_shapes/shape_operations.h>
 #include <boost/math/constants/constants.hpp>
 #include <moveit/profiler/profiler.h>
@@ -55,6 +56,7 @@ const std::string LOGNAME = "robot_model";
 RobotModel::RobotModel(const urdf::ModelInterfaceSharedPtr& urdf_model, const srdf::ModelConstSharedPtr& srdf_model)
 {
   root_joint_ = nullptr;
+  parallel_fk_enabled_ = false;
   urdf_ = urdf_model;
   srdf_ = srdf_model;
   buildModel(*urdf_model, *srdf_model);
@@ -245,6 +247,77 @@ void RobotModel::computeDescendants()
   }
 }
 
+void RobotModel::computeFkPartition()
+{
+  fk_partition_.prefix_links_.clear();
+  fk_partition_.subtree_roots_.clear();
+  if (!root_joint_)
+    return;
+
+  // walk down the single-child chain from the root; the first link with several child joints
+  // is where independent subtrees begin
+  const JointModel* joint = root_joint_;
+  const LinkModel* branch_link = nullptr;
+  while (joint)
+  {
+    const LinkModel* link = joint->getChildLinkModel();
+    if (!link)
+      return;
+    fk_partition_.prefix_links_.push_back(link);
+    const std::vector<const JointModel*>& children = link->getChildJointModels();
+    if (children.empty())
+      return;  // the whole model is one chain; there is nothing to update in parallel
+    if (children.size() > 1)
+    {
+      branch_link = link;
+      break;
+    }
+    joint = children[0];
+  }
+
+  std::vector<const JointModel*> roots(branch_link->getChildJointModels());
+
+  // a subtree holding most of the remaining links would serialize the join; keep absorbing
+  // links from a dominant subtree into the prefix until it branches or stops dominating
+  bool refined = true;
+  while (refined)
+  {
+    refined = false;
+    const std::size_t remaining = link_model_vector_.size() - fk_partition_.prefix_links_.size();
+    for (std::size_t i = 0; i < roots.size(); ++i)
+      if (roots[i]->getDescendantLinkModels().size() * 2 > remaining)
+      {
+        const LinkModel* link = roots[i]->getChildLinkModel();
+        if (!link || link->getChildJointModels().empty())
+          break;
+        fk_partition_.prefix_links_.push_back(link);
+        const std::vector<const JointModel*>& children = link->getChildJointModels();
+        roots[i] = children[0];
+        roots.insert(roots.end(), children.begin() + 1, children.end());
+        refined = true;
+        break;
+      }
+  }
+
+  // the descendant lists also follow mimic relations, so a subtree may reach into a sibling
+  // branch; the partition is only usable when the prefix and the subtrees tile the link set
+  // exactly (every link computed once), so verify that and fall back to serial otherwise
+  std::vector<unsigned char> covered(link_model_vector_.size(), 0);
+  for (std::size_t i = 0; i < fk_partition_.prefix_links_.size(); ++i)
+    covered[fk_partition_.prefix_links_[i]->getLinkIndex()] = 1;
+  for (std::size_t i = 0; i < roots.size(); ++i)
+    for (const LinkModel* link : roots[i]->getDescendantLinkModels())
+    {
+      if (covered[link->getLinkIndex()])
+        return;  // overlap; leave subtree_roots_ empty
+      covered[link->getLinkIndex()] = 1;
+    }
+  if (std::find(covered.begin(), covered.end(), 0) != covered.end())
+    return;  // some link is not reached from the partition
+
+  fk_partition_.subtree_roots_.swap(roots);
+}
+
 void RobotModel::buildJointInfo()
 {
   moveit::tools::Profiler::ScopedStart prof_start;
@@ -317,6 +390,7 @@ void RobotModel::buildJointInfo()
 
   computeDescendants();
   computeCommonRoots();  // must be called _after_ list of descendants was computed
+  computeFkPartition();  // needs the per-joint descendant link lists
 }
 
 void RobotModel::buildGroupStates(const srdf::Model& srdf_model)
@@ -1266,6 +1340,33 @@ void RobotModel::interpolate(const double* from, const double* to, double t, dou
   updateMimicJoints(state);
 }
 
+void RobotModel::setSoAFkEnabled(bool flag)
+{
+  std::lock_guard<std::mutex> slock(soa_fk_lock_);
+  if (flag)
+  {
+    if (!soa_fk_engine_)
+      soa_fk_engine_.reset(new SoAFkEngine(*this));
+  }
+  else
+    soa_fk_engine_.reset();
+}
+
+void RobotModel::computeTransformsBatch(const double* variable_positions, std::size_t n_states,
+                                        Eigen::Isometry3d* global_link_transforms) const
+{
+  // hold a reference for the duration of the batch, so a concurrent setSoAFkEnabled(false)
+  // cannot destroy the engine mid-computation
+  SoAFkEngineConstPtr engine;
+  {
+    std::lock_guard<std::mutex> slock(soa_fk_lock_);
+    if (!soa_fk_engine_)
+      soa_fk_engine_.reset(new SoAFkEngine(*this));
+    engine = soa_fk_engine_;
+  }
+  engine->computeTransformsBatch(variable_positions, n_states, global_link_transforms);
+}
+
 void RobotModel::setKinematicsAllocators(const std::map<std::string, SolverAllocatorFn>& allocators)
 {
   // we first set all the "simple" allocators -- where a group has one IK solver
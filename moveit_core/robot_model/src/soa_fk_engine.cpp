@@ -0,0 +1,152 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt Team.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Author: MoveIt Team */
+
+#include <moveit/robot_model/soa_fk_engine.h>
+#include <moveit/robot_model/robot_model.h>
+#include <moveit/robot_model/revolute_joint_model.h>
+#include <moveit/robot_model/prismatic_joint_model.h>
+
+namespace moveit
+{
+namespace core
+{
+SoAFkEngine::SoAFkEngine(const RobotModel& model) : variable_count_(model.getVariableCount())
+{
+  const std::vector<const LinkModel*>& links = model.getLinkModels();
+  const std::size_t n = links.size();
+  parent_link_index_.resize(n);
+  first_variable_index_.resize(n);
+  joint_kind_.resize(n);
+  origin_identity_.resize(n);
+  joint_origin_.resize(n);
+  joint_axis_.resize(n, Eigen::Vector3d::Zero());
+  parent_joint_.resize(n);
+
+  // link_model_vector_ is ordered so that parents always precede their children,
+  // which makes a simple forward sweep over these arrays a valid FK update
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const LinkModel* link = links[i];
+    const JointModel* joint = link->getParentJointModel();
+    const LinkModel* parent = link->getParentLinkModel();
+    parent_link_index_[i] = parent ? parent->getLinkIndex() : -1;
+    first_variable_index_[i] = joint->getFirstVariableIndex();
+    origin_identity_[i] = link->jointOriginTransformIsIdentity() ? 1 : 0;
+    joint_origin_[i] = link->getJointOriginTransform();
+    parent_joint_[i] = joint;
+    switch (joint->getType())
+    {
+      case JointModel::FIXED:
+        joint_kind_[i] = KIND_FIXED;
+        break;
+      case JointModel::REVOLUTE:
+        joint_kind_[i] = KIND_REVOLUTE;
+        joint_axis_[i] = static_cast<const RevoluteJointModel*>(joint)->getAxis();
+        break;
+      case JointModel::PRISMATIC:
+        joint_kind_[i] = KIND_PRISMATIC;
+        joint_axis_[i] = static_cast<const PrismaticJointModel*>(joint)->getAxis();
+        break;
+      default:
+        joint_kind_[i] = KIND_GENERIC;
+        break;
+    }
+  }
+}
+
+void SoAFkEngine::computeTransforms(const double* variable_positions,
+                                    Eigen::Isometry3d* global_link_transforms) const
+{
+  static const Eigen::Isometry3d IDENTITY = Eigen::Isometry3d::Identity();
+  for (std::size_t i = 0, n = parent_link_index_.size(); i < n; ++i)
+  {
+    const int parent = parent_link_index_[i];
+    const Eigen::Isometry3d& parent_t = parent < 0 ? IDENTITY : global_link_transforms[parent];
+    Eigen::Isometry3d& t = global_link_transforms[i];
+    switch (joint_kind_[i])
+    {
+      case KIND_FIXED:
+        t.affine().noalias() = parent_t.affine() * joint_origin_[i].matrix();
+        break;
+      case KIND_REVOLUTE:
+      {
+        Eigen::Isometry3d local(Eigen::AngleAxisd(variable_positions[first_variable_index_[i]], joint_axis_[i]));
+        if (origin_identity_[i])
+          t.affine().noalias() = parent_t.affine() * local.matrix();
+        else
+          t.affine().noalias() = parent_t.affine() * joint_origin_[i].matrix() * local.matrix();
+        break;
+      }
+      case KIND_PRISMATIC:
+      {
+        Eigen::Isometry3d local(
+            Eigen::Translation3d(joint_axis_[i] * variable_positions[first_variable_index_[i]]));
+        if (origin_identity_[i])
+          t.affine().noalias() = parent_t.affine() * local.matrix();
+        else
+          t.affine().noalias() = parent_t.affine() * joint_origin_[i].matrix() * local.matrix();
+        break;
+      }
+      default:  // KIND_GENERIC: planar and floating joints keep the virtual path
+      {
+        Eigen::Isometry3d local;
+        parent_joint_[i]->computeTransform(variable_positions + first_variable_index_[i], local);
+        if (origin_identity_[i])
+          t.affine().noalias() = parent_t.affine() * local.matrix();
+        else
+          t.affine().noalias() = parent_t.affine() * joint_origin_[i].matrix() * local.matrix();
+        break;
+      }
+    }
+  }
+}
+
+void SoAFkEngine::computeTransformsBatch(const double* variable_positions, std::size_t n_states,
+                                         Eigen::Isometry3d* global_link_transforms) const
+{
+  const std::size_t link_count = parent_link_index_.size();
+  for (std::size_t s = 0; s < n_states; ++s)
+  {
+#if defined(__GNUC__)
+    // bring the next state's variables into cache while this state is being processed
+    if (s + 1 < n_states)
+      __builtin_prefetch(variable_positions + (s + 1) * variable_count_);
+#endif
+    computeTransforms(variable_positions + s * variable_count_, global_link_transforms + s * link_count);
+  }
+}
+}  // namespace core
+}  // namespace moveit
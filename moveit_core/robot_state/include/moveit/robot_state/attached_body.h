@@ -110,9 +110,19 @@ public:
     return attach_trans_;
   }
 
-  /** \brief Get the global transforms for the collision bodies */
+  /** \brief Get the global transforms for the collision bodies.
+      These are computed lazily: if the parent link moved since the last access,
+      the transforms are refreshed first. As with the lazily updated transforms
+      of RobotState, the first access after an update should not happen
+      concurrently from multiple threads. */
   const EigenSTL::vector_Isometry3d& getGlobalCollisionBodyTransforms() const
   {
+    if (global_transforms_dirty_)
+    {
+      for (std::size_t i = 0; i < global_collision_body_transforms_.size(); ++i)
+        global_collision_body_transforms_[i] = parent_link_global_transform_ * attach_trans_[i];
+      global_transforms_dirty_ = false;
+    }
     return global_collision_body_transforms_;
   }
 
@@ -122,11 +132,13 @@ public:
   /** \brief Set the scale for the shapes of this attached object */
   void setScale(double scale);
 
-  /** \brief Recompute global_collision_body_transform given the transform of the parent link*/
+  /** \brief Record the transform of the parent link. The global collision body transforms are
+      not recomputed here; that happens on the next call to getGlobalCollisionBodyTransforms(),
+      so state updates that never query the attached body do not pay for the products. */
   void computeTransform(const Eigen::Isometry3d& parent_link_global_transform)
   {
-    for (std::size_t i = 0; i < global_collision_body_transforms_.size(); ++i)
-      global_collision_body_transforms_[i] = parent_link_global_transform * attach_trans_[i];
+    parent_link_global_transform_ = parent_link_global_transform;
+    global_transforms_dirty_ = true;
   }
 
 private:
@@ -149,8 +161,15 @@ private:
       the configuration of a gripper holding an object */
   trajectory_msgs::JointTrajectory detach_posture_;
 
-  /** \brief The global transforms for these attached bodies (computed by forward kinematics) */
-  EigenSTL::vector_Isometry3d global_collision_body_transforms_;
+  /** \brief The global transforms for these attached bodies (computed by forward kinematics);
+      refreshed lazily in getGlobalCollisionBodyTransforms() */
+  mutable EigenSTL::vector_Isometry3d global_collision_body_transforms_;
+
+  /** \brief The last recorded global transform of the parent link */
+  Eigen::Isometry3d parent_link_global_transform_;
+
+  /** \brief True if the parent link moved since global_collision_body_transforms_ was computed */
+  mutable bool global_transforms_dirty_;
 };
 }
 }
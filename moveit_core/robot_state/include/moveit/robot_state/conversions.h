@@ -84,6 +84,35 @@ bool robotStateMsgToRobotState(const moveit_msgs::RobotState& robot_state, Robot
 void robotStateToRobotStateMsg(const RobotState& state, moveit_msgs::RobotState& robot_state,
                                bool copy_attached_bodies = true);
 
+/**
+ * @brief Options controlling how a MoveIt! robot state is converted to a RobotState message
+ */
+struct RobotStateMsgOptions
+{
+  RobotStateMsgOptions() : copy_attached_bodies(true), reuse_unchanged_attached_bodies(false)
+  {
+  }
+
+  /** Flag to include attached objects in robot state copy */
+  bool copy_attached_bodies;
+
+  /** Keep the attached collision objects already present in the output message instead of
+      re-serializing the geometry when they still describe the state's attached bodies (same ids,
+      link names, shape and touch link counts, in the same order). This is intended for high-rate
+      publishers that reuse one message; it assumes the message content is not modified between
+      calls. */
+  bool reuse_unchanged_attached_bodies;
+};
+
+/**
+ * @brief Convert a MoveIt! robot state to a robot state message
+ * @param state The input MoveIt! robot state object
+ * @param robot_state The resultant RobotState *message
+ * @param options Conversion options; high-rate publishers can skip re-serializing unchanged attached bodies
+ */
+void robotStateToRobotStateMsg(const RobotState& state, moveit_msgs::RobotState& robot_state,
+                               const RobotStateMsgOptions& options);
+
 /**
  * @brief Convert AttachedBodies to AttachedCollisionObjects
  * @param attached_bodies The input MoveIt! attached body objects
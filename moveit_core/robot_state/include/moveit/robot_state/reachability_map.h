@@ -0,0 +1,145 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_CORE_ROBOT_STATE_REACHABILITY_MAP_
+#define MOVEIT_CORE_ROBOT_STATE_REACHABILITY_MAP_
+
+#include <moveit/robot_state/robot_state.h>
+#include <Eigen/Geometry>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+MOVEIT_CLASS_FORWARD(ReachabilityMap);
+
+/** \brief A precomputed occupancy map over the workspace of a planning group, recording which tip
+    positions (and coarse tip orientations) the group can reach. The map is built offline by
+    sampling the configuration space of the group and marking the voxel containing each forward
+    kinematics solution; at query time an unmarked voxel proves a pose goal unreachable before any
+    planning time is spent on it. Queries are conservative: a pose is only rejected if neither its
+    voxel nor any neighboring voxel was reached by a sample, so sampling sparsity and quantization
+    do not cause false rejections. Positions are expressed in the model frame of the robot.
+
+    Maps can be saved to disk and loaded back; load() maps the file into memory read-only, so
+    large maps cost no load time and their pages are shared between processes. */
+class ReachabilityMap
+{
+public:
+  /// Number of coarse orientation buckets kept per voxel (octants of the tip frame z axis)
+  static const unsigned int ORIENTATION_BUCKETS = 8;
+
+  ReachabilityMap();
+  ~ReachabilityMap();
+
+  ReachabilityMap(const ReachabilityMap&) = delete;
+  ReachabilityMap& operator=(const ReachabilityMap&) = delete;
+
+  /** \brief Build the map for \e group by sampling \e samples random configurations and recording
+      the position and orientation of \e tip_link at \e resolution (voxel edge length, in meters).
+      If \e tip_link is empty, the last link of the group is used. The extent of the grid is
+      derived from the maximum extent of the group. Returns false if the group or link is not
+      found. */
+  bool build(const robot_model::RobotModelConstPtr& model, const std::string& group,
+             const std::string& tip_link = "", double resolution = 0.05, unsigned int samples = 1000000);
+
+  /** \brief True if a sampled configuration placed the tip in (or next to) the voxel of
+      \e position */
+  bool isPositionReachable(const Eigen::Vector3d& position) const;
+
+  /** \brief True if a sampled configuration placed the tip in (or next to) the voxel of
+      \e position with an orientation in the same bucket as \e orientation */
+  bool isPoseReachable(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation) const;
+
+  /** \brief Save the map to \e filename. Returns false on I/O failure. */
+  bool save(const std::string& filename) const;
+
+  /** \brief Load a map saved with save(), mapping the file into memory read-only. Returns false
+      if the file cannot be mapped or is not a valid map. */
+  bool load(const std::string& filename);
+
+  bool isLoaded() const
+  {
+    return cells_ != nullptr;
+  }
+
+  const std::string& getGroupName() const
+  {
+    return group_;
+  }
+
+  const std::string& getTipLink() const
+  {
+    return tip_link_;
+  }
+
+  double getResolution() const
+  {
+    return resolution_;
+  }
+
+  /// Fraction of voxels reached by at least one sample
+  double getOccupancy() const;
+
+private:
+  /// The bucket (octant) of the z axis of \e orientation
+  static unsigned int orientationBucket(const Eigen::Quaterniond& orientation);
+
+  /// The cell of \e position, or nullptr when the position lies outside the grid
+  const std::uint8_t* cellAt(const Eigen::Vector3d& position) const;
+
+  void freeMap();
+
+  std::string group_;
+  std::string tip_link_;
+  double resolution_;
+  double origin_[3];
+  std::uint32_t dims_[3];
+
+  /// per-voxel bitmask of reached orientation buckets; points into cells_storage_ for built maps
+  /// and into the mapped file for loaded ones
+  const std::uint8_t* cells_;
+  std::vector<std::uint8_t> cells_storage_;
+
+  /// base address and length of the mapped file, when the map was loaded with load()
+  void* mapped_base_;
+  std::size_t mapped_length_;
+};
+}  // namespace core
+}  // namespace moveit
+
+#endif
@@ -46,6 +46,7 @@
 #include <std_msgs/ColorRGBA.h>
 #include <geometry_msgs/Twist.h>
 #include <cassert>
+#include <cstdint>
 
 #include <boost/assert.hpp>
 
@@ -1036,6 +1037,39 @@ as the new values that correspond to the group */
                  const GroupStateValidityCallbackFn& constraint = GroupStateValidityCallbackFn(),
                  const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions());
 
+  /** \brief Scratch buffers reused across setFromIK() calls. Code that solves IK in tight
+      loops (e.g. grasp filtering) can hold one of these per thread and pass it to the
+      corresponding setFromIK() overload so that the query, seed and solution vectors are
+      allocated once and reused instead of being rebuilt on every call. */
+  struct IKQueryContext
+  {
+    EigenSTL::vector_Isometry3d poses;
+    std::vector<std::string> tips;
+    std::vector<std::vector<double> > consistency_limit_sets;
+    std::vector<geometry_msgs::Pose> ik_queries;
+    std::vector<bool> tip_frames_used;
+    std::vector<double> consistency_limits;
+    std::vector<double> seed;
+    std::vector<double> initial_values;
+    std::vector<double> random_values;
+    std::vector<double> ik_sol;
+    std::vector<double> solution;
+  };
+
+  /** \brief Variant of setFromIK() for a single Eigen pose that draws all temporary vectors
+      from \e context, avoiding per-call heap allocation and message container construction
+      in hot loops. The pose is passed to the solver without intermediate user-side copies. */
+  bool setFromIK(const JointModelGroup* group, const Eigen::Isometry3d& pose, const std::string& tip,
+                 unsigned int attempts, double timeout, const GroupStateValidityCallbackFn& constraint,
+                 const kinematics::KinematicsQueryOptions& options, IKQueryContext& context);
+
+  /** \brief Variant of the multi-pose setFromIK() that reuses the scratch buffers in \e context
+      instead of allocating temporary vectors on every call */
+  bool setFromIK(const JointModelGroup* group, const EigenSTL::vector_Isometry3d& poses,
+                 const std::vector<std::string>& tips, const std::vector<std::vector<double> >& consistency_limits,
+                 unsigned int attempts, double timeout, const GroupStateValidityCallbackFn& constraint,
+                 const kinematics::KinematicsQueryOptions& options, IKQueryContext& context);
+
   /**
       \brief setFromIK for multiple poses and tips (end effectors) when no solver exists for the jmg that can solver for
       non-chain kinematics. In this case, we divide the group into subgroups and do IK solving individually
@@ -1052,6 +1086,47 @@ as the new values that correspond to the group */
                           const GroupStateValidityCallbackFn& constraint = GroupStateValidityCallbackFn(),
                           const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions());
 
+  /** \brief Workspace reused across setFromIKCoordinated() calls. The stacked Jacobian, error
+      vector and intermediate matrices are sized on first use and reused afterwards, so repeated
+      coordinated solves (e.g. dual-arm servoing at 50 Hz) do not allocate inside the iteration. */
+  struct CoordinatedIKContext
+  {
+    Eigen::MatrixXd jacobian;      // stacked: 6 * tips x group variables
+    Eigen::MatrixXd tip_jacobian;  // 6 x group variables
+    Eigen::MatrixXd damped;        // 6 * tips x 6 * tips
+    Eigen::VectorXd error;         // 6 * tips
+    Eigen::VectorXd delta;         // group variables
+    Eigen::VectorXd positions;     // group variables
+    Eigen::VectorXd initial;       // group variables, for restoring the state on failure
+  };
+
+  /** \brief Coordinated multi-tip inverse kinematics: iterate damped least-squares steps on the
+      Jacobians of all \e tips stacked over the joints of \e group, so joints shared between the
+      tip chains (e.g. a torso feeding both arms) are moved consistently instead of each tip being
+      solved independently as setFromIKSubgroups() does. The poses are expected in the model
+      frame, in the same order as \e tips. \e tip_weights scales the rows of each tip in the
+      least-squares problem (larger values prioritize that tip); when empty, all tips are weighted
+      equally. On success the state holds the solution; on failure it is restored to its entry
+      values. Bounds are enforced after every step, but no collision or validity checking is done.
+      @param group The group of joints to solve for
+      @param poses The poses each tip link needs to achieve, in the model frame
+      @param tips The names of the tip links
+      @param context Scratch buffers reused across calls
+      @param tip_weights Per-tip priority weights; empty means equal weights
+      @param max_iterations The maximum number of damped least-squares iterations
+      @param tolerance Convergence threshold on the position (m) and rotation (rad) error of every tip
+      @param damping The damping factor of the least-squares step */
+  bool setFromIKCoordinated(const JointModelGroup* group, const EigenSTL::vector_Isometry3d& poses,
+                            const std::vector<std::string>& tips, CoordinatedIKContext& context,
+                            const std::vector<double>& tip_weights = std::vector<double>(),
+                            unsigned int max_iterations = 50, double tolerance = 1e-4, double damping = 0.05);
+
+  /** \brief Variant of setFromIKCoordinated() that allocates its workspace internally */
+  bool setFromIKCoordinated(const JointModelGroup* group, const EigenSTL::vector_Isometry3d& poses,
+                            const std::vector<std::string>& tips,
+                            const std::vector<double>& tip_weights = std::vector<double>(),
+                            unsigned int max_iterations = 50, double tolerance = 1e-4, double damping = 0.05);
+
   /** \brief Set the joint values from a Cartesian velocity applied during a time dt
    * @param group the group of joints this function operates on
    * @param twist a Cartesian velocity on the 'tip' frame
@@ -1163,6 +1238,22 @@ as the new values that correspond to the group */
                                 JumpThreshold(jump_threshold_factor), validCallback, options);
   }
 
+  /** \brief Parallel variant of the single-target computeCartesianPath(): the interpolated
+     Cartesian steps are partitioned into \e num_threads chunks. The chunk boundary states are
+     solved first with a serial IK pass (each seeded from the previous boundary), then the
+     interior steps of all chunks are solved concurrently, each chunk seeded from its boundary
+     state. The stitched trajectory is truncated at the first unsolved step and passed through
+     the same joint-space jump test, so the returned fraction has the same semantics as the
+     serial version. The group's kinematics solver and \e validCallback are called from
+     multiple threads concurrently and must be safe to use that way.
+     With \e num_threads <= 1 (or few steps) this falls back to the serial implementation. */
+  double computeCartesianPathParallel(const JointModelGroup* group, std::vector<RobotStatePtr>& traj,
+                                      const LinkModel* link, const Eigen::Isometry3d& target,
+                                      bool global_reference_frame, const MaxEEFStep& max_step,
+                                      const JumpThreshold& jump_threshold, unsigned int num_threads,
+                                      const GroupStateValidityCallbackFn& validCallback = GroupStateValidityCallbackFn(),
+                                      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions());
+
   /** \brief Tests joint space jumps of a trajectory.
 
      If \e jump_threshold_factor is non-zero, we test for relative jumps.
@@ -1260,6 +1351,34 @@ as the new values that correspond to the group */
     return static_cast<const RobotState*>(this)->getJacobian(group, reference_point_position);
   }
 
+  /** \brief Reusable buffers for getJacobianVectorized(). Holds the world-frame joint axes and
+      origins of a chain in contiguous 3xN matrices plus the joint values they were computed for,
+      so that repeated calls (e.g. a servo loop) only refresh the columns whose joints moved. */
+  struct JacobianCache
+  {
+    Eigen::Matrix3Xd axes;
+    Eigen::Matrix3Xd origins;
+    Eigen::RowVectorXd rotational;  // 1.0 for revolute columns, 0.0 for prismatic ones
+    std::vector<double> last_values;
+    const LinkModel* link = nullptr;
+    const JointModelGroup* group = nullptr;
+  };
+
+  /** \brief Compute the 6xN Jacobian for a chain of single-DOF joints with vectorized column
+      evaluation: world axes and joint origins are gathered into contiguous 3xN matrices and all
+      columns are produced with array-wide Eigen expressions instead of per-column cross products.
+      Falls back to getJacobian() for groups containing multi-DOF joints.
+      \return True if the Jacobian was successfully computed, false otherwise */
+  bool getJacobianVectorized(const JointModelGroup* group, const LinkModel* link,
+                             const Eigen::Vector3d& reference_point_position, Eigen::MatrixXd& jacobian) const;
+
+  /** \brief Variant of getJacobianVectorized() that keeps the gathered axis/origin columns in
+      \e cache and refreshes only the columns of joints whose values changed since the last call
+      with the same cache (proximal columns are unaffected by distal joint motion). */
+  bool getJacobianVectorized(const JointModelGroup* group, const LinkModel* link,
+                             const Eigen::Vector3d& reference_point_position, Eigen::MatrixXd& jacobian,
+                             JacobianCache& cache) const;
+
   /** \brief Given a twist for a particular link (\e tip), compute the corresponding velocity for every variable and
    * store it in \e qdot */
   void computeVariableVelocity(const JointModelGroup* jmg, Eigen::VectorXd& qdot, const Eigen::VectorXd& twist,
@@ -1745,6 +1864,7 @@ private:
   void markDirtyJointTransforms(const JointModel* joint)
   {
     dirty_joint_transforms_[joint->getJointIndex()] = 1;
+    setDirtyLinkJointBit(joint);
     dirty_link_transforms_ =
         dirty_link_transforms_ == NULL ? joint : robot_model_->getCommonRoot(dirty_link_transforms_, joint);
   }
@@ -1753,12 +1873,35 @@ private:
   {
     const std::vector<const JointModel*>& jm = group->getActiveJointModels();
     for (std::size_t i = 0; i < jm.size(); ++i)
+    {
       dirty_joint_transforms_[jm[i]->getJointIndex()] = 1;
+      setDirtyLinkJointBit(jm[i]);
+    }
     dirty_link_transforms_ = dirty_link_transforms_ == NULL ?
                                  group->getCommonRoot() :
                                  robot_model_->getCommonRoot(dirty_link_transforms_, group->getCommonRoot());
   }
 
+  /** \brief Mark \e joint in the per-joint dirty bitmask; updateLinkTransformsInternal() only
+      recomputes links whose parent joint moved or whose parent link was recomputed, so sibling
+      branches between the common dirty root and the actually moved joints are skipped. */
+  void setDirtyLinkJointBit(const JointModel* joint)
+  {
+    dirty_link_joints_[joint->getJointIndex() >> 6] |= static_cast<uint64_t>(1) << (joint->getJointIndex() & 63);
+  }
+
+  bool dirtyLinkJointBit(const JointModel* joint) const
+  {
+    return dirty_link_joints_[joint->getJointIndex() >> 6] & (static_cast<uint64_t>(1) << (joint->getJointIndex() & 63));
+  }
+
+  /** \brief Mark all joints in the per-joint dirty bitmask (used by the bulk setters that
+      invalidate all transforms at once) */
+  void markAllLinkJointsDirty()
+  {
+    dirty_link_joints_.assign((robot_model_->getJointModelCount() + 63) / 64, ~static_cast<uint64_t>(0));
+  }
+
   void markVelocity();
   void markAcceleration();
   void markEffort();
@@ -1804,6 +1947,14 @@ private:
 
   void updateLinkTransformsInternal(const JointModel* start);
 
+  /** \brief Recompute the global transform of \e link; the transform of its parent link (if any)
+      must already be up to date */
+  void computeLinkTransform(const LinkModel* link);
+
+  /** \brief Recompute the global transforms of \e links in order (used as the per-subtree task of
+      the parallel FK path; the links must be ordered parent-before-child) */
+  void computeSubtreeLinkTransforms(const std::vector<const LinkModel*>& links);
+
   void getMissingKeys(const std::map<std::string, double>& variable_map,
                       std::vector<std::string>& missing_variables) const;
   void getStateTreeJointString(std::ostream& ss, const JointModel* jm, const std::string& pfx0, bool last) const;
@@ -1836,6 +1987,15 @@ private:
   Eigen::Isometry3d* global_collision_body_transforms_;  // this points to an element in transforms_, so it is aligned
   unsigned char* dirty_joint_transforms_;
 
+  /** \brief One bit per joint (by joint index): set when the joint moved since its child link
+      transform was last recomputed. Lets updateLinkTransformsInternal() skip sibling branches
+      below the common dirty root that did not actually move. */
+  std::vector<uint64_t> dirty_link_joints_;
+
+  /** \brief Scratch per-link flags used during updateLinkTransformsInternal() to propagate
+      "parent link was recomputed" down the sweep; sized lazily to the link count */
+  std::vector<unsigned char> updated_links_scratch_;
+
   /** \brief All attached bodies that are part of this state, indexed by their name */
   std::map<std::string, AttachedBody*> attached_body_map_;
 
@@ -0,0 +1,95 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt Team.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Author: MoveIt Team */
+
+#ifndef MOVEIT_CORE_ROBOT_STATE_ROBOT_STATE_POOL_
+#define MOVEIT_CORE_ROBOT_STATE_ROBOT_STATE_POOL_
+
+#include <moveit/robot_state/robot_state.h>
+#include <boost/thread/mutex.hpp>
+#include <memory>
+#include <vector>
+
+namespace moveit
+{
+namespace core
+{
+MOVEIT_CLASS_FORWARD(RobotStatePool);
+
+/** \brief Thread-safe free-list pool of RobotState instances for one RobotModel.
+
+    Constructing a RobotState allocates several large buffers (positions, transforms,
+    collision body transforms); code that creates short-lived state copies in hot loops
+    (constraint sampling, state validity checking) pays malloc/free for each of them.
+    The pool hands out pre-constructed states wrapped in a RobotStatePtr whose deleter
+    returns the state to the free list instead of destroying it.
+
+    The pool must outlive all states obtained from it. */
+class RobotStatePool
+{
+public:
+  /** \brief Create a pool for \e model, optionally pre-constructing \e initial_size states */
+  RobotStatePool(const RobotModelConstPtr& model, std::size_t initial_size = 0);
+
+  ~RobotStatePool();
+
+  /** \brief Get a state from the pool (constructing one if the free list is empty).
+      The variable values of the returned state are whatever the last user left in it;
+      callers that care must set them. */
+  RobotStatePtr getState();
+
+  /** \brief Get a state from the pool and assign \e seed to it. Assignment into the
+      pre-sized buffers does not allocate. */
+  RobotStatePtr getState(const RobotState& seed);
+
+  const RobotModelConstPtr& getRobotModel() const
+  {
+    return model_;
+  }
+
+  /** \brief Number of states currently in the free list */
+  std::size_t getFreeCount() const;
+
+private:
+  void returnState(RobotState* state);
+
+  RobotModelConstPtr model_;
+  std::vector<RobotState*> free_list_;
+  mutable boost::mutex lock_;
+};
+}  // namespace core
+}  // namespace moveit
+
+#endif
@@ -48,7 +48,9 @@ moveit::core::AttachedBody::AttachedBody(const LinkModel* parent_link_model, con
   , attach_trans_(attach_trans)
   , touch_links_(touch_links)
   , detach_posture_(detach_posture)
+  , global_transforms_dirty_(false)
 {
+  parent_link_global_transform_.setIdentity();
   global_collision_body_transforms_.resize(attach_trans.size());
   for (std::size_t i = 0; i < global_collision_body_transforms_.size(); ++i)
     global_collision_body_transforms_[i].setIdentity();
@@ -52,6 +52,20 @@ const std::string LOGNAME = "robot_state";
 
 namespace
 {
+/** Cached msg-name -> variable-index mapping; high-rate state updates arrive with an identical
+    joint ordering almost every time, so the string lookups only need to run when the layout
+    changes */
+struct JointStateIndexCache
+{
+  JointStateIndexCache() : model(nullptr)
+  {
+  }
+
+  const RobotModel* model;
+  std::vector<std::string> names;
+  std::vector<int> indices;
+};
+
 static bool _jointStateToRobotState(const sensor_msgs::JointState& joint_state, RobotState& state)
 {
   if (joint_state.name.size() != joint_state.position.size())
@@ -61,7 +75,26 @@ static bool _jointStateToRobotState(const sensor_msgs::JointState& joint_state,
     return false;
   }
 
-  state.setVariableValues(joint_state);
+  static thread_local JointStateIndexCache cache;
+  const RobotModel* model = state.getRobotModel().get();
+  if (cache.model != model || cache.names != joint_state.name)
+  {
+    // build into a temporary first; getVariableIndex() throws on unknown names and the cache
+    // must not be left half-filled in that case
+    std::vector<int> indices;
+    indices.reserve(joint_state.name.size());
+    for (std::size_t i = 0; i < joint_state.name.size(); ++i)
+      indices.push_back(model->getVariableIndex(joint_state.name[i]));
+    cache.model = model;
+    cache.names = joint_state.name;
+    cache.indices.swap(indices);
+  }
+
+  for (std::size_t i = 0; i < joint_state.position.size(); ++i)
+    state.setVariablePosition(cache.indices[i], joint_state.position[i]);
+  if (!joint_state.velocity.empty() && joint_state.velocity.size() == joint_state.name.size())
+    for (std::size_t i = 0; i < joint_state.velocity.size(); ++i)
+      state.setVariableVelocity(cache.indices[i], joint_state.velocity[i]);
 
   return true;
 }
@@ -129,8 +162,17 @@ static bool _multiDOFJointsToRobotState(const sensor_msgs::MultiDOFJointState& m
 static inline void _robotStateToMultiDOFJointState(const RobotState& state, sensor_msgs::MultiDOFJointState& mjs)
 {
   const std::vector<const JointModel*>& js = state.getRobotModel()->getMultiDOFJointModels();
-  mjs.joint_names.clear();
-  mjs.transforms.clear();
+  // keep the name storage of a reused message instead of reallocating all strings per call
+  bool names_match = mjs.joint_names.size() == js.size();
+  for (std::size_t i = 0; names_match && i < js.size(); ++i)
+    names_match = mjs.joint_names[i] == js[i]->getName();
+  if (!names_match)
+  {
+    mjs.joint_names.resize(js.size());
+    for (std::size_t i = 0; i < js.size(); ++i)
+      mjs.joint_names[i] = js[i]->getName();
+  }
+  mjs.transforms.resize(js.size());
   for (std::size_t i = 0; i < js.size(); ++i)
   {
     geometry_msgs::TransformStamped p;
@@ -143,8 +185,7 @@ static inline void _robotStateToMultiDOFJointState(const RobotState& state, sens
     }
     else
       p = tf2::eigenToTransform(state.getJointTransform(js[i]));
-    mjs.joint_names.push_back(js[i]->getName());
-    mjs.transforms.push_back(p.transform);
+    mjs.transforms[i] = p.transform;
   }
   mjs.header.frame_id = state.getRobotModel()->getModelFrame();
 }
@@ -331,6 +372,27 @@ static void _msgToAttachedBody(const Transforms* tf, const moveit_msgs::Attached
     ROS_ERROR_NAMED(LOGNAME, "Unknown collision object operation: %d", aco.object.operation);
 }
 
+/** Check whether the attached collision objects in a reused message still describe the given
+    attached bodies. The geometry in the message is expressed in the attachment link frame, so it
+    only changes when an object is (re)attached; id, link name, shape count and touch link count
+    are enough to detect that. */
+static bool _attachedBodiesMatchMsgs(const std::vector<const AttachedBody*>& attached_bodies,
+                                     const std::vector<moveit_msgs::AttachedCollisionObject>& acos)
+{
+  if (attached_bodies.size() != acos.size())
+    return false;
+  for (std::size_t i = 0; i < attached_bodies.size(); ++i)
+  {
+    const AttachedBody* ab = attached_bodies[i];
+    const moveit_msgs::AttachedCollisionObject& aco = acos[i];
+    if (aco.object.id != ab->getName() || aco.link_name != ab->getAttachedLinkName() ||
+        aco.touch_links.size() != ab->getTouchLinks().size() ||
+        aco.object.primitives.size() + aco.object.meshes.size() + aco.object.planes.size() != ab->getShapes().size())
+      return false;
+  }
+  return true;
+}
+
 static bool _robotStateMsgToRobotStateHelper(const Transforms* tf, const moveit_msgs::RobotState& robot_state,
                                              RobotState& state, bool copy_attached_bodies)
 {
@@ -388,15 +450,26 @@ bool robotStateMsgToRobotState(const Transforms& tf, const moveit_msgs::RobotSta
 }
 
 void robotStateToRobotStateMsg(const RobotState& state, moveit_msgs::RobotState& robot_state, bool copy_attached_bodies)
+{
+  RobotStateMsgOptions options;
+  options.copy_attached_bodies = copy_attached_bodies;
+  robotStateToRobotStateMsg(state, robot_state, options);
+}
+
+void robotStateToRobotStateMsg(const RobotState& state, moveit_msgs::RobotState& robot_state,
+                               const RobotStateMsgOptions& options)
 {
   robot_state.is_diff = false;
   robotStateToJointStateMsg(state, robot_state.joint_state);
   _robotStateToMultiDOFJointState(state, robot_state.multi_dof_joint_state);
 
-  if (copy_attached_bodies)
+  if (options.copy_attached_bodies)
   {
     std::vector<const AttachedBody*> attached_bodies;
     state.getAttachedBodies(attached_bodies);
+    if (options.reuse_unchanged_attached_bodies &&
+        _attachedBodiesMatchMsgs(attached_bodies, robot_state.attached_collision_objects))
+      return;
     attachedBodiesToAttachedCollisionObjectMsgs(attached_bodies, robot_state.attached_collision_objects);
   }
 }
@@ -413,20 +486,32 @@ void attachedBodiesToAttachedCollisionObjectMsgs(
 void robotStateToJointStateMsg(const RobotState& state, sensor_msgs::JointState& joint_state)
 {
   const std::vector<const JointModel*>& js = state.getRobotModel()->getSingleDOFJointModels();
-  joint_state = sensor_msgs::JointState();
+  // keep the name storage of a reused message instead of reallocating all strings per call; a
+  // 100 Hz monitored-state publisher hands in the same message every cycle
+  bool names_match = joint_state.name.size() == js.size();
+  for (std::size_t i = 0; names_match && i < js.size(); ++i)
+    names_match = joint_state.name[i] == js[i]->getName();
+  if (!names_match)
+  {
+    joint_state.name.resize(js.size());
+    for (std::size_t i = 0; i < js.size(); ++i)
+      joint_state.name[i] = js[i]->getName();
+  }
 
+  joint_state.position.resize(js.size());
+  if (state.hasVelocities())
+    joint_state.velocity.resize(js.size());
+  else
+    joint_state.velocity.clear();
+  joint_state.effort.clear();
   for (std::size_t i = 0; i < js.size(); ++i)
   {
-    joint_state.name.push_back(js[i]->getName());
-    joint_state.position.push_back(state.getVariablePosition(js[i]->getFirstVariableIndex()));
+    joint_state.position[i] = state.getVariablePosition(js[i]->getFirstVariableIndex());
     if (state.hasVelocities())
-      joint_state.velocity.push_back(state.getVariableVelocity(js[i]->getFirstVariableIndex()));
+      joint_state.velocity[i] = state.getVariableVelocity(js[i]->getFirstVariableIndex());
   }
 
-  // if inconsistent number of velocities are specified, discard them
-  if (joint_state.velocity.size() != joint_state.position.size())
-    joint_state.velocity.clear();
-
+  joint_state.header = std_msgs::Header();
   joint_state.header.frame_id = state.getRobotModel()->getModelFrame();
 }
 
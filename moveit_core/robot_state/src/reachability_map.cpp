@@ -0,0 +1,323 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/robot_state/reachability_map.h>
+#include <ros/console.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace moveit
+{
+namespace core
+{
+const unsigned int ReachabilityMap::ORIENTATION_BUCKETS;
+
+namespace
+{
+const char* LOGNAME = "reachability_map";
+
+// on-disk layout of a reachability map; the voxel data follows the header directly
+struct MapFileHeader
+{
+  char magic[4];
+  std::uint32_t version;
+  char group[64];
+  char tip_link[64];
+  double resolution;
+  double origin[3];
+  std::uint32_t dims[3];
+  std::uint32_t reserved;
+};
+
+const char MAP_FILE_MAGIC[4] = { 'M', 'R', 'M', 'B' };
+const std::uint32_t MAP_FILE_VERSION = 1;
+}
+
+ReachabilityMap::ReachabilityMap() : resolution_(0.0), cells_(nullptr), mapped_base_(nullptr), mapped_length_(0)
+{
+  origin_[0] = origin_[1] = origin_[2] = 0.0;
+  dims_[0] = dims_[1] = dims_[2] = 0;
+}
+
+ReachabilityMap::~ReachabilityMap()
+{
+  freeMap();
+}
+
+void ReachabilityMap::freeMap()
+{
+  if (mapped_base_)
+  {
+    munmap(mapped_base_, mapped_length_);
+    mapped_base_ = nullptr;
+    mapped_length_ = 0;
+  }
+  cells_ = nullptr;
+  cells_storage_.clear();
+}
+
+unsigned int ReachabilityMap::orientationBucket(const Eigen::Quaterniond& orientation)
+{
+  // the octant of the tip frame z axis; coarse, but sufficient to separate e.g. top-down from
+  // sideways grasps
+  const Eigen::Vector3d z = orientation * Eigen::Vector3d::UnitZ();
+  return (z.x() >= 0.0 ? 1 : 0) | (z.y() >= 0.0 ? 2 : 0) | (z.z() >= 0.0 ? 4 : 0);
+}
+
+const std::uint8_t* ReachabilityMap::cellAt(const Eigen::Vector3d& position) const
+{
+  if (!cells_)
+    return nullptr;
+  long idx[3];
+  for (int k = 0; k < 3; ++k)
+  {
+    idx[k] = (long)std::floor((position[k] - origin_[k]) / resolution_);
+    if (idx[k] < 0 || idx[k] >= (long)dims_[k])
+      return nullptr;
+  }
+  return cells_ + (idx[0] * dims_[1] + idx[1]) * dims_[2] + idx[2];
+}
+
+bool ReachabilityMap::build(const robot_model::RobotModelConstPtr& model, const std::string& group,
+                            const std::string& tip_link, double resolution, unsigned int samples)
+{
+  const robot_model::JointModelGroup* jmg = model->getJointModelGroup(group);
+  if (!jmg)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Group '%s' not found in model '%s'", group.c_str(), model->getName().c_str());
+    return false;
+  }
+  if (jmg->getLinkModelNames().empty())
+    return false;
+  const robot_model::LinkModel* tip =
+      model->getLinkModel(tip_link.empty() ? jmg->getLinkModelNames().back() : tip_link);
+  if (!tip)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Tip link '%s' not found in model '%s'", tip_link.c_str(), model->getName().c_str());
+    return false;
+  }
+  if (resolution <= 0.0)
+    return false;
+
+  freeMap();
+  group_ = group;
+  tip_link_ = tip->getName();
+  resolution_ = resolution;
+
+  // the grid spans the sphere every configuration of the group keeps the tip in: the maximum
+  // extent of the group around the position of its root link at the default state
+  robot_state::RobotState state(model);
+  state.setToDefaultValues();
+  state.update();
+  const robot_model::JointModel* root_joint = jmg->getCommonRoot();
+  Eigen::Vector3d center = Eigen::Vector3d::Zero();
+  if (root_joint && root_joint->getParentLinkModel())
+    center = state.getGlobalLinkTransform(root_joint->getParentLinkModel()).translation();
+  const double reach = jmg->getMaximumExtent() + resolution;
+  for (int k = 0; k < 3; ++k)
+  {
+    origin_[k] = center[k] - reach;
+    dims_[k] = (std::uint32_t)std::ceil(2.0 * reach / resolution);
+  }
+  cells_storage_.assign((std::size_t)dims_[0] * dims_[1] * dims_[2], 0);
+
+  random_numbers::RandomNumberGenerator rng;
+  for (unsigned int i = 0; i < samples; ++i)
+  {
+    state.setToRandomPositions(jmg, rng);
+    state.updateLinkTransforms();
+    const Eigen::Isometry3d& t = state.getGlobalLinkTransform(tip);
+    long idx[3];
+    bool inside = true;
+    for (int k = 0; k < 3; ++k)
+    {
+      idx[k] = (long)std::floor((t.translation()[k] - origin_[k]) / resolution_);
+      if (idx[k] < 0 || idx[k] >= (long)dims_[k])
+      {
+        inside = false;
+        break;
+      }
+    }
+    if (inside)
+      cells_storage_[(idx[0] * dims_[1] + idx[1]) * dims_[2] + idx[2]] |=
+          1 << orientationBucket(Eigen::Quaterniond(t.rotation()));
+  }
+
+  // dilate by one voxel so that sampling sparsity and quantization at the surface of the reached
+  // region cannot cause false rejections; queries then need only a single lookup
+  std::vector<std::uint8_t> dilated = cells_storage_;
+  for (std::uint32_t x = 0; x < dims_[0]; ++x)
+    for (std::uint32_t y = 0; y < dims_[1]; ++y)
+      for (std::uint32_t z = 0; z < dims_[2]; ++z)
+      {
+        const std::uint8_t mask = cells_storage_[((std::size_t)x * dims_[1] + y) * dims_[2] + z];
+        if (!mask)
+          continue;
+        for (int dx = -1; dx <= 1; ++dx)
+          for (int dy = -1; dy <= 1; ++dy)
+            for (int dz = -1; dz <= 1; ++dz)
+            {
+              long nx = (long)x + dx, ny = (long)y + dy, nz = (long)z + dz;
+              if (nx < 0 || ny < 0 || nz < 0 || nx >= (long)dims_[0] || ny >= (long)dims_[1] || nz >= (long)dims_[2])
+                continue;
+              dilated[((std::size_t)nx * dims_[1] + ny) * dims_[2] + nz] |= mask;
+            }
+      }
+  cells_storage_.swap(dilated);
+  cells_ = cells_storage_.data();
+
+  ROS_DEBUG_NAMED(LOGNAME, "Built reachability map for group '%s' (tip '%s'): %u x %u x %u voxels at %lf m, "
+                           "%.1f%% occupied",
+                  group_.c_str(), tip_link_.c_str(), dims_[0], dims_[1], dims_[2], resolution_,
+                  100.0 * getOccupancy());
+  return true;
+}
+
+bool ReachabilityMap::isPositionReachable(const Eigen::Vector3d& position) const
+{
+  if (!cells_)
+    return true;  // without a map nothing can be ruled out
+  const std::uint8_t* cell = cellAt(position);
+  return cell && *cell;
+}
+
+bool ReachabilityMap::isPoseReachable(const Eigen::Vector3d& position, const Eigen::Quaterniond& orientation) const
+{
+  if (!cells_)
+    return true;
+  const std::uint8_t* cell = cellAt(position);
+  return cell && (*cell & (1 << orientationBucket(orientation)));
+}
+
+double ReachabilityMap::getOccupancy() const
+{
+  const std::size_t n = (std::size_t)dims_[0] * dims_[1] * dims_[2];
+  if (!cells_ || n == 0)
+    return 0.0;
+  std::size_t occupied = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    if (cells_[i])
+      ++occupied;
+  return (double)occupied / (double)n;
+}
+
+bool ReachabilityMap::save(const std::string& filename) const
+{
+  if (!cells_)
+    return false;
+  MapFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAP_FILE_MAGIC, sizeof(header.magic));
+  header.version = MAP_FILE_VERSION;
+  strncpy(header.group, group_.c_str(), sizeof(header.group) - 1);
+  strncpy(header.tip_link, tip_link_.c_str(), sizeof(header.tip_link) - 1);
+  header.resolution = resolution_;
+  for (int k = 0; k < 3; ++k)
+  {
+    header.origin[k] = origin_[k];
+    header.dims[k] = dims_[k];
+  }
+
+  FILE* out = fopen(filename.c_str(), "wb");
+  if (!out)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Unable to open '%s' for writing", filename.c_str());
+    return false;
+  }
+  const std::size_t n = (std::size_t)dims_[0] * dims_[1] * dims_[2];
+  bool ok = fwrite(&header, sizeof(header), 1, out) == 1 && fwrite(cells_, 1, n, out) == n;
+  fclose(out);
+  if (!ok)
+    ROS_ERROR_NAMED(LOGNAME, "Failed writing reachability map to '%s'", filename.c_str());
+  return ok;
+}
+
+bool ReachabilityMap::load(const std::string& filename)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Unable to open reachability map '%s'", filename.c_str());
+    return false;
+  }
+  struct stat file_info;
+  if (fstat(fd, &file_info) != 0 || (std::size_t)file_info.st_size < sizeof(MapFileHeader))
+  {
+    close(fd);
+    ROS_ERROR_NAMED(LOGNAME, "Reachability map '%s' is truncated", filename.c_str());
+    return false;
+  }
+  void* base = mmap(nullptr, file_info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Unable to map reachability map '%s' into memory", filename.c_str());
+    return false;
+  }
+
+  const MapFileHeader* header = static_cast<const MapFileHeader*>(base);
+  const std::size_t n = (std::size_t)header->dims[0] * header->dims[1] * header->dims[2];
+  if (memcmp(header->magic, MAP_FILE_MAGIC, sizeof(header->magic)) != 0 || header->version != MAP_FILE_VERSION ||
+      (std::size_t)file_info.st_size < sizeof(MapFileHeader) + n)
+  {
+    munmap(base, file_info.st_size);
+    ROS_ERROR_NAMED(LOGNAME, "'%s' is not a valid reachability map", filename.c_str());
+    return false;
+  }
+
+  freeMap();
+  mapped_base_ = base;
+  mapped_length_ = file_info.st_size;
+  group_ = std::string(header->group, strnlen(header->group, sizeof(header->group)));
+  tip_link_ = std::string(header->tip_link, strnlen(header->tip_link, sizeof(header->tip_link)));
+  resolution_ = header->resolution;
+  for (int k = 0; k < 3; ++k)
+  {
+    origin_[k] = header->origin[k];
+    dims_[k] = header->dims[k];
+  }
+  cells_ = static_cast<const std::uint8_t*>(base) + sizeof(MapFileHeader);
+  ROS_DEBUG_NAMED(LOGNAME, "Loaded reachability map for group '%s' (tip '%s') from '%s'", group_.c_str(),
+                  tip_link_.c_str(), filename.c_str());
+  return true;
+}
+}  // namespace core
+}  // namespace moveit
@@ -36,13 +36,16 @@
 /* Author: Ioan Sucan, Sachin Chitta, Acorn Pooley, Mario Prats, Dave Coleman */
 
 #include <moveit/robot_state/robot_state.h>
+#include <moveit/robot_model/soa_fk_engine.h>
 #include <moveit/transforms/transforms.h>
 #include <geometric_shapes/shape_operations.h>
 #include <tf2_eigen/tf2_eigen.h>
 #include <moveit/backtrace/backtrace.h>
 #include <moveit/profiler/profiler.h>
+#include <moveit/utils/task_scheduler.h>
 #include <boost/bind.hpp>
 #include <moveit/robot_model/aabb.h>
+#include <thread>
 
 namespace moveit
 {
@@ -54,6 +57,11 @@ namespace core
  * valid paths from paths with large joint space jumps. */
 static const std::size_t MIN_STEPS_FOR_JUMP_THRESH = 10;
 
+/** \brief Models with fewer links than this are updated serially even when the kinematic tree
+ * splits into independent subtrees; below this size the fork-join overhead of the task
+ * scheduler exceeds the cost of the transforms themselves. */
+static const std::size_t MIN_PARALLEL_FK_LINKS = 32;
+
 const std::string LOGNAME = "robot_state";
 
 RobotState::RobotState(const RobotModelConstPtr& robot_model)
@@ -113,6 +121,7 @@ void RobotState::initTransforms()
   const int nr_doubles_for_dirty_joint_transforms =
       1 + robot_model_->getJointModelCount() / (sizeof(double) / sizeof(unsigned char));
   memset(dirty_joint_transforms_, 1, sizeof(double) * nr_doubles_for_dirty_joint_transforms);
+  markAllLinkJointsDirty();
 
   // initialize last row of transformation matrices, which will not be modified by transform updates anymore
   for (size_t i = 0, end = robot_model_->getJointModelCount() + robot_model_->getLinkModelCount() +
@@ -159,6 +168,7 @@ void RobotState::copyFrom(const RobotState& other)
                                                  ((has_acceleration_ || has_effort_) ? 1 : 0)) +
              nr_doubles_for_dirty_joint_transforms);
     memcpy(variable_joint_transforms_, other.variable_joint_transforms_, bytes);
+    dirty_link_joints_ = other.dirty_link_joints_;
   }
 
   // copy attached bodies
@@ -233,6 +243,7 @@ void RobotState::setToRandomPositions()
   random_numbers::RandomNumberGenerator& rng = getRandomNumberGenerator();
   robot_model_->getVariableRandomPositions(rng, position_);
   memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
+  markAllLinkJointsDirty();
   dirty_link_transforms_ = robot_model_->getRootJoint();
   // mimic values are correctly set in RobotModel
 }
@@ -298,6 +309,7 @@ void RobotState::setToDefaultValues()
   // set velocity & acceleration to 0
   memset(velocity_, 0, sizeof(double) * 2 * robot_model_->getVariableCount());
   memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
+  markAllLinkJointsDirty();
   dirty_link_transforms_ = robot_model_->getRootJoint();
 }
 
@@ -310,6 +322,7 @@ void RobotState::setVariablePositions(const double* position)
 
   // Since all joint values have potentially changed, we will need to recompute all transforms
   memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
+  markAllLinkJointsDirty();
   dirty_link_transforms_ = robot_model_->getRootJoint();
 }
 
@@ -564,6 +577,7 @@ void RobotState::update(bool force)
   if (force)
   {
     memset(dirty_joint_transforms_, 1, robot_model_->getJointModelCount() * sizeof(unsigned char));
+    markAllLinkJointsDirty();
     dirty_link_transforms_ = robot_model_->getRootJoint();
   }
 
@@ -613,37 +627,107 @@ void RobotState::updateLinkTransforms()
   }
 }
 
-void RobotState::updateLinkTransformsInternal(const JointModel* start)
+void RobotState::computeLinkTransform(const LinkModel* link)
 {
-  for (const LinkModel* link : start->getDescendantLinkModels())
+  const int idx_link = link->getLinkIndex();
+  const LinkModel* parent = link->getParentLinkModel();
+  if (parent)  // root JointModel will not have a parent
   {
-    int idx_link = link->getLinkIndex();
-    const LinkModel* parent = link->getParentLinkModel();
-    if (parent)  // root JointModel will not have a parent
+    int idx_parent = parent->getLinkIndex();
+    if (link->parentJointIsFixed())
+      global_link_transforms_[idx_link].affine().noalias() =
+          global_link_transforms_[idx_parent].affine() * link->getJointOriginTransform().matrix();
+    else
     {
-      int idx_parent = parent->getLinkIndex();
-      if (link->parentJointIsFixed())
+      if (link->jointOriginTransformIsIdentity())
         global_link_transforms_[idx_link].affine().noalias() =
-            global_link_transforms_[idx_parent].affine() * link->getJointOriginTransform().matrix();
+            global_link_transforms_[idx_parent].affine() * getJointTransform(link->getParentJointModel()).matrix();
       else
-      {
-        if (link->jointOriginTransformIsIdentity())
-          global_link_transforms_[idx_link].affine().noalias() =
-              global_link_transforms_[idx_parent].affine() * getJointTransform(link->getParentJointModel()).matrix();
-        else
-          global_link_transforms_[idx_link].affine().noalias() =
-              global_link_transforms_[idx_parent].affine() * link->getJointOriginTransform().matrix() *
-              getJointTransform(link->getParentJointModel()).matrix();
-      }
+        global_link_transforms_[idx_link].affine().noalias() =
+            global_link_transforms_[idx_parent].affine() * link->getJointOriginTransform().matrix() *
+            getJointTransform(link->getParentJointModel()).matrix();
     }
+  }
+  else
+  {
+    if (link->jointOriginTransformIsIdentity())
+      global_link_transforms_[idx_link] = getJointTransform(link->getParentJointModel());
     else
+      global_link_transforms_[idx_link].affine().noalias() =
+          link->getJointOriginTransform().affine() * getJointTransform(link->getParentJointModel()).matrix();
+  }
+}
+
+void RobotState::computeSubtreeLinkTransforms(const std::vector<const LinkModel*>& links)
+{
+  // no dirty-bit bookkeeping here: the per-joint bitmask words are shared between subtrees,
+  // so the caller clears the whole bitmask once all subtrees are done
+  for (const LinkModel* link : links)
+    computeLinkTransform(link);
+}
+
+void RobotState::updateLinkTransformsInternal(const JointModel* start)
+{
+  // when all transforms are dirty and the model has a flattened FK table, use the
+  // linear sweep over contiguous arrays instead of the pointer-based tree walk
+  const SoAFkEngine* soa_fk = robot_model_->getSoAFkEngine();
+  if (soa_fk && start == robot_model_->getRootJoint())
+  {
+    soa_fk->computeTransforms(position_, global_link_transforms_);
+    std::fill(dirty_link_joints_.begin(), dirty_link_joints_.end(), 0);
+    for (std::map<std::string, AttachedBody*>::const_iterator it = attached_body_map_.begin();
+         it != attached_body_map_.end(); ++it)
+      it->second->computeTransform(global_link_transforms_[it->second->getAttachedLink()->getLinkIndex()]);
+    return;
+  }
+
+  // for large trees that split into independent subtrees, compute the serial prefix and then
+  // fork one task per subtree on the shared scheduler; the subtrees touch disjoint links and
+  // joints, so they can run concurrently (the lazily computed joint transforms use one dirty
+  // byte per joint). Only worth it for full updates of models with enough links to amortize
+  // the fork-join overhead. Opt-in per model (the fork-join blocks on the scheduler, which is
+  // not acceptable on every thread that updates a state), see RobotModel::setParallelFkEnabled().
+  const RobotModel::FkPartition& fk_partition = robot_model_->getFkPartition();
+  if (robot_model_->isParallelFkEnabled() && start == robot_model_->getRootJoint() &&
+      fk_partition.subtree_roots_.size() > 1 && robot_model_->getLinkModelCount() >= MIN_PARALLEL_FK_LINKS &&
+      moveit::tools::TaskScheduler::getInstance().getThreadCount() > 1)
+  {
+    for (const LinkModel* link : fk_partition.prefix_links_)
+      computeLinkTransform(link);
+
+    moveit::tools::TaskScheduler& scheduler = moveit::tools::TaskScheduler::getInstance();
+    moveit::tools::TaskScheduler::TaskGroup task_group(scheduler);
+    for (const JointModel* root : fk_partition.subtree_roots_)
     {
-      if (link->jointOriginTransformIsIdentity())
-        global_link_transforms_[idx_link] = getJointTransform(link->getParentJointModel());
-      else
-        global_link_transforms_[idx_link].affine().noalias() =
-            link->getJointOriginTransform().affine() * getJointTransform(link->getParentJointModel()).matrix();
+      const std::vector<const LinkModel*>& links = root->getDescendantLinkModels();
+      scheduler.submit(task_group, [this, &links] { computeSubtreeLinkTransforms(links); }, "robot_state");
     }
+    task_group.wait();
+
+    std::fill(dirty_link_joints_.begin(), dirty_link_joints_.end(), 0);
+    for (std::map<std::string, AttachedBody*>::const_iterator it = attached_body_map_.begin();
+         it != attached_body_map_.end(); ++it)
+      it->second->computeTransform(global_link_transforms_[it->second->getAttachedLink()->getLinkIndex()]);
+    return;
+  }
+
+  updated_links_scratch_.assign(robot_model_->getLinkModelCount(), 0);
+  for (const LinkModel* link : start->getDescendantLinkModels())
+  {
+    int idx_link = link->getLinkIndex();
+    const LinkModel* parent = link->getParentLinkModel();
+
+    // skip links on branches where nothing moved: a link transform only changes if its
+    // parent joint moved or the transform of its parent link was recomputed
+    const JointModel* pjm = link->getParentJointModel();
+    const bool joint_moved = dirtyLinkJointBit(pjm);
+    if (!joint_moved && !(parent && updated_links_scratch_[parent->getLinkIndex()]))
+      continue;
+    if (joint_moved)
+      dirty_link_joints_[pjm->getJointIndex() >> 6] &= ~(static_cast<uint64_t>(1) << (pjm->getJointIndex() & 63));
+    updated_links_scratch_[idx_link] = 1;
+
+    computeLinkTransform(link);
   }
 
   // update attached bodies tf; these are usually very few, so we update them all
@@ -668,7 +752,11 @@ void RobotState::updateStateWithLinkAt(const LinkModel* link, const Eigen::Isome
   // update link transforms for descendant links only (leaving the transform for the current link untouched)
   const std::vector<const JointModel*>& cj = link->getChildJointModels();
   for (std::size_t i = 0; i < cj.size(); ++i)
+  {
+    // the parent link was warped, so the whole subtree must be recomputed
+    setDirtyLinkJointBit(cj[i]);
     updateLinkTransformsInternal(cj[i]);
+  }
 
   // if we also need to go backward
   if (backward)
@@ -692,7 +780,10 @@ void RobotState::updateStateWithLinkAt(const LinkModel* link, const Eigen::Isome
       const std::vector<const JointModel*>& cj = parent_link->getChildJointModels();
       for (std::size_t i = 0; i < cj.size(); ++i)
         if (cj[i] != child_link->getParentJointModel())
+        {
+          setDirtyLinkJointBit(cj[i]);
           updateLinkTransformsInternal(cj[i]);
+        }
     }
     // all collision body transforms are invalid now
     dirty_collision_body_transforms_ = parent_link->getParentJointModel();
@@ -821,6 +912,7 @@ void RobotState::interpolate(const RobotState& to, double t, RobotState& state)
   robot_model_->interpolate(getVariablePositions(), to.getVariablePositions(), t, state.getVariablePositions());
 
   memset(state.dirty_joint_transforms_, 1, state.robot_model_->getJointModelCount() * sizeof(unsigned char));
+  state.markAllLinkJointsDirty();
   state.dirty_link_transforms_ = state.robot_model_->getRootJoint();
 }
 
@@ -893,7 +985,7 @@ void RobotState::getAttachedBodies(std::vector<const AttachedBody*>& attached_bo
   attached_bodies.clear();
   for (std::map<std::string, AttachedBody*>::const_iterator it = attached_body_map_.begin();
        it != attached_body_map_.end(); ++it)
-    if (group->hasLinkModel(it->second->getAttachedLinkName()))
+    if (group->hasLinkModel(it->second->getAttachedLink()))
       attached_bodies.push_back(it->second);
 }
 
@@ -941,7 +1033,7 @@ void RobotState::clearAttachedBodies(const JointModelGroup* group)
   std::map<std::string, AttachedBody*>::iterator it = attached_body_map_.begin();
   while (it != attached_body_map_.end())
   {
-    if (!group->hasLinkModel(it->second->getAttachedLinkName()))
+    if (!group->hasLinkModel(it->second->getAttachedLink()))
     {
       ++it;
       continue;
@@ -1167,12 +1259,12 @@ bool RobotState::getJacobian(const JointModelGroup* group, const LinkModel* link
     const JointModel* pjm = link->getParentJointModel();
     if (pjm->getVariableCount() > 0)
     {
-      if (not group->hasJointModel(pjm->getName()))
+      if (not group->hasJointModel(pjm))
       {
         link = pjm->getParentLinkModel();
         continue;
       }
-      unsigned int joint_index = group->getVariableGroupIndex(pjm->getName());
+      unsigned int joint_index = group->getVariableGroupIndex(pjm);
       if (pjm->getType() == robot_model::JointModel::REVOLUTE)
       {
         joint_transform = reference_transform * getGlobalLinkTransform(link);
@@ -1222,6 +1314,265 @@ bool RobotState::getJacobian(const JointModelGroup* group, const LinkModel* link
   return true;
 }
 
+namespace
+{
+/* Dense evaluation of the gathered Jacobian columns: cross the world joint axes with the
+   lever arms to the reference point and route each column to the linear or angular rows.
+   The fixed-size instantiations keep every temporary on the stack and let Eigen unroll and
+   vectorize the row expressions without the tail loops of the dynamic-size path. */
+template <int N>
+void denseJacobianKernel(const Eigen::Matrix3Xd& axes, const Eigen::Matrix3Xd& origins,
+                         const Eigen::RowVectorXd& rotational, const Eigen::Vector3d& point_transform,
+                         Eigen::MatrixXd& jacobian)
+{
+  const Eigen::Array<double, 3, N> ax = axes.leftCols<N>().array();
+  const Eigen::Array<double, 3, N> d = ((-origins.leftCols<N>()).colwise() + point_transform).array();
+  Eigen::Array<double, 3, N> lin;
+  lin.row(0) = ax.row(1) * d.row(2) - ax.row(2) * d.row(1);
+  lin.row(1) = ax.row(2) * d.row(0) - ax.row(0) * d.row(2);
+  lin.row(2) = ax.row(0) * d.row(1) - ax.row(1) * d.row(0);
+  const Eigen::Array<double, 1, N> rot = rotational.head<N>().array();
+  jacobian.topRows<3>() = (lin.rowwise() * rot + ax.rowwise() * (1.0 - rot)).matrix();
+  jacobian.bottomRows<3>() = (ax.rowwise() * rot).matrix();
+}
+
+void denseJacobianKernelDynamic(const Eigen::Matrix3Xd& axes, const Eigen::Matrix3Xd& origins,
+                                const Eigen::RowVectorXd& rotational, const Eigen::Vector3d& point_transform,
+                                Eigen::MatrixXd& jacobian)
+{
+  const int columns = axes.cols();
+  Eigen::Array<double, 3, Eigen::Dynamic> d = ((-origins).colwise() + point_transform).array();
+  const auto& ax = axes.array();
+  Eigen::Array<double, 3, Eigen::Dynamic> lin(3, columns);
+  lin.row(0) = ax.row(1) * d.row(2) - ax.row(2) * d.row(1);
+  lin.row(1) = ax.row(2) * d.row(0) - ax.row(0) * d.row(2);
+  lin.row(2) = ax.row(0) * d.row(1) - ax.row(1) * d.row(0);
+  const auto& rot = rotational.array();
+  jacobian.topRows<3>() = (lin.rowwise() * rot + ax.rowwise() * (1.0 - rot)).matrix();
+  jacobian.bottomRows<3>() = (ax.rowwise() * rot).matrix();
+}
+
+typedef void (*DenseJacobianKernelFn)(const Eigen::Matrix3Xd&, const Eigen::Matrix3Xd&, const Eigen::RowVectorXd&,
+                                      const Eigen::Vector3d&, Eigen::MatrixXd&);
+
+/* Most groups are 4-8 DOF chains; those get a kernel compiled for their exact column
+   count, everything else falls back to the dynamic-size evaluation. */
+DenseJacobianKernelFn denseJacobianKernelFor(int columns)
+{
+  static const DenseJacobianKernelFn fixed_size_kernels[] = { &denseJacobianKernel<4>, &denseJacobianKernel<5>,
+                                                              &denseJacobianKernel<6>, &denseJacobianKernel<7>,
+                                                              &denseJacobianKernel<8> };
+  if (columns >= 4 && columns <= 8)
+    return fixed_size_kernels[columns - 4];
+  return &denseJacobianKernelDynamic;
+}
+}  // namespace
+
+bool RobotState::getJacobianVectorized(const JointModelGroup* group, const LinkModel* link,
+                                       const Eigen::Vector3d& reference_point_position,
+                                       Eigen::MatrixXd& jacobian) const
+{
+  JacobianCache cache;
+  return getJacobianVectorized(group, link, reference_point_position, jacobian, cache);
+}
+
+bool RobotState::getJacobianVectorized(const JointModelGroup* group, const LinkModel* link,
+                                       const Eigen::Vector3d& reference_point_position, Eigen::MatrixXd& jacobian,
+                                       JacobianCache& cache) const
+{
+  BOOST_VERIFY(checkLinkTransforms());
+
+  if (!group->isChain())
+  {
+    ROS_ERROR_NAMED(LOGNAME, "The group '%s' is not a chain. Cannot compute Jacobian.", group->getName().c_str());
+    return false;
+  }
+
+  if (!group->isLinkUpdated(link->getName()))
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Link name '%s' does not exist in the chain '%s' or is not a child for this chain",
+                    link->getName().c_str(), group->getName().c_str());
+    return false;
+  }
+
+  const robot_model::JointModel* root_joint_model = group->getJointModels()[0];
+  const robot_model::LinkModel* root_link_model = root_joint_model->getParentLinkModel();
+  Eigen::Isometry3d reference_transform =
+      root_link_model ? getGlobalLinkTransform(root_link_model).inverse() : Eigen::Isometry3d::Identity();
+  const int columns = group->getVariableCount();
+
+  const bool fresh = cache.group != group || cache.link != link || cache.axes.cols() != columns;
+  if (fresh)
+  {
+    cache.axes.setZero(3, columns);
+    cache.origins.setZero(3, columns);
+    cache.rotational.setZero(columns);
+  }
+
+  // determine the first column whose joint value changed since the cached gather;
+  // columns are ordered root to tip, so all columns distal to it need refreshing,
+  // while the world axes and origins of proximal columns are unaffected
+  std::vector<double> values(columns);
+  copyJointGroupPositions(group, &values[0]);
+  int first_dirty = fresh ? 0 : columns;
+  if (!fresh)
+    for (int i = 0; i < columns; ++i)
+      if (values[i] != cache.last_values[i])
+      {
+        first_dirty = i;
+        break;
+      }
+
+  const LinkModel* l = link;
+  while (l)
+  {
+    const JointModel* pjm = l->getParentJointModel();
+    if (pjm->getVariableCount() > 0)
+    {
+      if (not group->hasJointModel(pjm))
+      {
+        l = pjm->getParentLinkModel();
+        continue;
+      }
+      if (pjm->getVariableCount() > 1)
+        // multi-DOF joints keep the scalar column-by-column path
+        return getJacobian(group, link, reference_point_position, jacobian, false);
+      unsigned int joint_index = group->getVariableGroupIndex(pjm);
+      if (static_cast<int>(joint_index) >= first_dirty)
+      {
+        Eigen::Isometry3d joint_transform = reference_transform * getGlobalLinkTransform(l);
+        cache.origins.col(joint_index) = joint_transform.translation();
+        if (pjm->getType() == robot_model::JointModel::REVOLUTE)
+        {
+          cache.axes.col(joint_index) =
+              joint_transform.rotation() * static_cast<const robot_model::RevoluteJointModel*>(pjm)->getAxis();
+          cache.rotational(joint_index) = 1.0;
+        }
+        else if (pjm->getType() == robot_model::JointModel::PRISMATIC)
+        {
+          cache.axes.col(joint_index) =
+              joint_transform.rotation() * static_cast<const robot_model::PrismaticJointModel*>(pjm)->getAxis();
+          cache.rotational(joint_index) = 0.0;
+        }
+        else
+        {
+          ROS_ERROR_NAMED(LOGNAME, "Unknown type of joint in Jacobian computation");
+          return false;
+        }
+      }
+    }
+    if (pjm == root_joint_model)
+      break;
+    l = pjm->getParentLinkModel();
+  }
+  cache.group = group;
+  cache.link = link;
+  cache.last_values.swap(values);
+
+  Eigen::Vector3d point_transform = reference_transform * getGlobalLinkTransform(link) * reference_point_position;
+
+  // evaluate all columns at once over the contiguous 3xN axis/origin storage, through
+  // a kernel compiled for the group's column count when one is available
+  jacobian.resize(6, columns);
+  denseJacobianKernelFor(columns)(cache.axes, cache.origins, cache.rotational, point_transform, jacobian);
+  return true;
+}
+
+bool RobotState::setFromIKCoordinated(const JointModelGroup* group, const EigenSTL::vector_Isometry3d& poses,
+                                      const std::vector<std::string>& tips, CoordinatedIKContext& context,
+                                      const std::vector<double>& tip_weights, unsigned int max_iterations,
+                                      double tolerance, double damping)
+{
+  if (poses.empty() || poses.size() != tips.size())
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Number of poses (%zu) and tips (%zu) must match and be non-zero", poses.size(),
+                    tips.size());
+    return false;
+  }
+  if (!tip_weights.empty() && tip_weights.size() != tips.size())
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Number of tip weights (%zu) does not match the number of tips (%zu)", tip_weights.size(),
+                    tips.size());
+    return false;
+  }
+  std::vector<const LinkModel*> links(tips.size());
+  for (std::size_t i = 0; i < tips.size(); ++i)
+  {
+    links[i] = robot_model_->getLinkModel(tips[i]);
+    if (!links[i])
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Tip link '%s' not found in model", tips[i].c_str());
+      return false;
+    }
+  }
+
+  const std::size_t rows = 6 * tips.size();
+  const std::size_t cols = group->getVariableCount();
+  context.jacobian.resize(rows, cols);
+  context.damped.resize(rows, rows);
+  context.error.resize(rows);
+  context.delta.resize(cols);
+  context.initial.resize(cols);
+  copyJointGroupPositions(group, context.initial);
+
+  // bound on the per-joint change of one step, to stay within the range where the Jacobian
+  // linearization holds
+  const double max_step = 0.2;
+
+  for (unsigned int iteration = 0; iteration < max_iterations; ++iteration)
+  {
+    updateLinkTransforms();
+
+    bool converged = true;
+    for (std::size_t t = 0; t < tips.size(); ++t)
+    {
+      const Eigen::Isometry3d& current = getGlobalLinkTransform(links[t]);
+      const Eigen::Vector3d position_error = poses[t].translation() - current.translation();
+      const Eigen::AngleAxisd rotation_error(poses[t].rotation() * current.rotation().transpose());
+      if (position_error.norm() > tolerance || std::fabs(rotation_error.angle()) > tolerance)
+        converged = false;
+
+      const double weight = tip_weights.empty() ? 1.0 : tip_weights[t];
+      context.error.segment<3>(6 * t) = weight * position_error;
+      context.error.segment<3>(6 * t + 3) = weight * rotation_error.angle() * rotation_error.axis();
+      if (!getJacobian(group, links[t], Eigen::Vector3d::Zero(), context.tip_jacobian))
+      {
+        setJointGroupPositions(group, context.initial);
+        updateLinkTransforms();
+        return false;
+      }
+      context.jacobian.middleRows(6 * t, 6) = weight * context.tip_jacobian;
+    }
+    if (converged)
+      return true;
+
+    // damped least-squares step on the stacked problem: dq = J^T (J J^T + lambda^2 I)^-1 e
+    context.damped.noalias() = context.jacobian * context.jacobian.transpose();
+    context.damped.diagonal().array() += damping * damping;
+    context.delta.noalias() = context.jacobian.transpose() * context.damped.ldlt().solve(context.error);
+    const double largest_change = context.delta.lpNorm<Eigen::Infinity>();
+    if (largest_change > max_step)
+      context.delta *= max_step / largest_change;
+
+    copyJointGroupPositions(group, context.positions);
+    context.positions += context.delta;
+    setJointGroupPositions(group, context.positions);
+    enforceBounds(group);
+  }
+
+  setJointGroupPositions(group, context.initial);
+  updateLinkTransforms();
+  return false;
+}
+
+bool RobotState::setFromIKCoordinated(const JointModelGroup* group, const EigenSTL::vector_Isometry3d& poses,
+                                      const std::vector<std::string>& tips, const std::vector<double>& tip_weights,
+                                      unsigned int max_iterations, double tolerance, double damping)
+{
+  CoordinatedIKContext context;
+  return setFromIKCoordinated(group, poses, tips, context, tip_weights, max_iterations, tolerance, damping);
+}
+
 bool RobotState::setFromDiffIK(const JointModelGroup* jmg, const Eigen::VectorXd& twist, const std::string& tip,
                                double dt, const GroupStateValidityCallbackFn& constraint)
 {
@@ -1346,14 +1697,30 @@ bool RobotState::setFromIK(const JointModelGroup* jmg, const Eigen::Isometry3d&
 namespace
 {
 bool ikCallbackFnAdapter(RobotState* state, const JointModelGroup* group,
-                         const GroupStateValidityCallbackFn& constraint, const geometry_msgs::Pose& /*unused*/,
+                         const GroupStateValidityCallbackFn& constraint,
+                         const kinematics::KinematicsQueryOptions& options, const geometry_msgs::Pose& /*unused*/,
                          const std::vector<double>& ik_sol, moveit_msgs::MoveItErrorCodes& error_code)
 {
   const std::vector<unsigned int>& bij = group->getKinematicsSolverJointBijection();
   std::vector<double> solution(bij.size());
   for (std::size_t i = 0; i < bij.size(); ++i)
     solution[bij[i]] = ik_sol[i];
-  if (constraint(state, group, &solution[0]))
+
+  // Run the cheap pre-filter stages first; most invalid candidates are rejected here without ever
+  // paying for the full validity callback (typically a planning scene collision check).
+  // A negative margin tightens the bounds, so candidates within joint_limit_margin of a limit fail.
+  if (options.joint_limit_margin > 0.0 && !group->satisfiesPositionBounds(&solution[0], -options.joint_limit_margin))
+  {
+    error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+    return true;
+  }
+  if (options.solution_prefilter && !options.solution_prefilter(state, group, &solution[0]))
+  {
+    error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+    return true;
+  }
+
+  if (!constraint || constraint(state, group, &solution[0]))
     error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
   else
     error_code.val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
@@ -1414,6 +1781,30 @@ bool RobotState::setFromIK(const JointModelGroup* jmg, const EigenSTL::vector_Is
                            const std::vector<std::vector<double> >& consistency_limit_sets, unsigned int attempts,
                            double timeout, const GroupStateValidityCallbackFn& constraint,
                            const kinematics::KinematicsQueryOptions& options)
+{
+  IKQueryContext context;
+  return setFromIK(jmg, poses_in, tips_in, consistency_limit_sets, attempts, timeout, constraint, options, context);
+}
+
+bool RobotState::setFromIK(const JointModelGroup* jmg, const Eigen::Isometry3d& pose_in, const std::string& tip_in,
+                           unsigned int attempts, double timeout, const GroupStateValidityCallbackFn& constraint,
+                           const kinematics::KinematicsQueryOptions& options, IKQueryContext& context)
+{
+  // reuse the context's pose/tip scratch vectors instead of building fresh ones
+  context.poses.resize(1);
+  context.poses[0] = pose_in;
+  context.tips.resize(1);
+  context.tips[0] = tip_in;
+  context.consistency_limit_sets.clear();
+  return setFromIK(jmg, context.poses, context.tips, context.consistency_limit_sets, attempts, timeout, constraint,
+                   options, context);
+}
+
+bool RobotState::setFromIK(const JointModelGroup* jmg, const EigenSTL::vector_Isometry3d& poses_in,
+                           const std::vector<std::string>& tips_in,
+                           const std::vector<std::vector<double> >& consistency_limit_sets, unsigned int attempts,
+                           double timeout, const GroupStateValidityCallbackFn& constraint,
+                           const kinematics::KinematicsQueryOptions& options, IKQueryContext& context)
 {
   // Error check
   if (poses_in.size() != tips_in.size())
@@ -1459,7 +1850,8 @@ bool RobotState::setFromIK(const JointModelGroup* jmg, const EigenSTL::vector_Is
   }
 
   // Check that no, or only one set of consistency limits have been passed in, and choose that one
-  std::vector<double> consistency_limits;
+  std::vector<double>& consistency_limits = context.consistency_limits;
+  consistency_limits.clear();
   if (consistency_limit_sets.size() > 1)
   {
     ROS_ERROR_NAMED(LOGNAME, "Invalid number (%zu) of sets of consistency limits for a setFromIK request "
@@ -1473,10 +1865,12 @@ bool RobotState::setFromIK(const JointModelGroup* jmg, const EigenSTL::vector_Is
   const std::vector<std::string>& solver_tip_frames = solver->getTipFrames();
 
   // Track which possible tips frames we have filled in so far
-  std::vector<bool> tip_frames_used(solver_tip_frames.size(), false);
+  std::vector<bool>& tip_frames_used = context.tip_frames_used;
+  tip_frames_used.assign(solver_tip_frames.size(), false);
 
   // Create vector to hold the output frames in the same order as solver_tip_frames
-  std::vector<geometry_msgs::Pose> ik_queries(solver_tip_frames.size());
+  std::vector<geometry_msgs::Pose>& ik_queries = context.ik_queries;
+  ik_queries.resize(solver_tip_frames.size());
 
   // Bring each pose to the frame of the IK solver
   for (std::size_t i = 0; i < poses_in.size(); ++i)
@@ -1618,19 +2012,29 @@ bool RobotState::setFromIK(const JointModelGroup* jmg, const EigenSTL::vector_Is
   if (attempts == 0)
     attempts = jmg->getDefaultIKAttempts();
 
+  // Reject poses outside the reachable workspace before paying for any solver restarts
+  if (options.pose_prefilter)
+    for (std::size_t i = 0; i < ik_queries.size(); ++i)
+      if (!options.pose_prefilter(ik_queries[i]))
+      {
+        ROS_DEBUG_NAMED(LOGNAME, "IK query pose %zu was rejected by the pose pre-filter", i);
+        return false;
+      }
+
   // set callback function
   kinematics::KinematicsBase::IKCallbackFn ik_callback_fn;
-  if (constraint)
-    ik_callback_fn = boost::bind(&ikCallbackFnAdapter, this, jmg, constraint, _1, _2, _3);
+  if (constraint || options.joint_limit_margin > 0.0 || options.solution_prefilter)
+    ik_callback_fn = boost::bind(&ikCallbackFnAdapter, this, jmg, constraint, options, _1, _2, _3);
 
   // Bijection
   const std::vector<unsigned int>& bij = jmg->getKinematicsSolverJointBijection();
 
   bool first_seed = true;
-  std::vector<double> initial_values;
+  std::vector<double>& initial_values = context.initial_values;
   for (unsigned int st = 0; st < attempts; ++st)
   {
-    std::vector<double> seed(bij.size());
+    std::vector<double>& seed = context.seed;
+    seed.resize(bij.size());
 
     // the first seed is the current robot state joint values
     if (first_seed)
@@ -1646,7 +2050,7 @@ bool RobotState::setFromIK(const JointModelGroup* jmg, const EigenSTL::vector_Is
 
       // sample a random seed
       random_numbers::RandomNumberGenerator& rng = getRandomNumberGenerator();
-      std::vector<double> random_values;
+      std::vector<double>& random_values = context.random_values;
       jmg->getVariableRandomPositions(rng, random_values);
       for (std::size_t i = 0; i < bij.size(); ++i)
         seed[i] = random_values[bij[i]];
@@ -1662,13 +2066,15 @@ bool RobotState::setFromIK(const JointModelGroup* jmg, const EigenSTL::vector_Is
     }
 
     // compute the IK solution
-    std::vector<double> ik_sol;
+    std::vector<double>& ik_sol = context.ik_sol;
+    ik_sol.clear();
     moveit_msgs::MoveItErrorCodes error;
 
     if (solver->searchPositionIK(ik_queries, seed, timeout, consistency_limits, ik_sol, ik_callback_fn, error, options,
                                  this))
     {
-      std::vector<double> solution(bij.size());
+      std::vector<double>& solution = context.solution;
+      solution.resize(bij.size());
       for (std::size_t i = 0; i < bij.size(); ++i)
         solution[bij[i]] = ik_sol[i];
       setJointGroupPositions(jmg, solution);
@@ -1797,8 +2203,8 @@ bool RobotState::setFromIKSubgroups(const JointModelGroup* jmg, const EigenSTL::
   // Convert Eigen poses to geometry_msg format
   std::vector<geometry_msgs::Pose> ik_queries(poses_in.size());
   kinematics::KinematicsBase::IKCallbackFn ik_callback_fn;
-  if (constraint)
-    ik_callback_fn = boost::bind(&ikCallbackFnAdapter, this, jmg, constraint, _1, _2, _3);
+  if (constraint || options.joint_limit_margin > 0.0 || options.solution_prefilter)
+    ik_callback_fn = boost::bind(&ikCallbackFnAdapter, this, jmg, constraint, options, _1, _2, _3);
 
   for (std::size_t i = 0; i < transformed_poses.size(); ++i)
   {
@@ -1813,6 +2219,15 @@ bool RobotState::setFromIKSubgroups(const JointModelGroup* jmg, const EigenSTL::
     ik_queries[i].orientation.w = quat.w();
   }
 
+  // Reject poses outside the reachable workspace before paying for any solver restarts
+  if (options.pose_prefilter)
+    for (std::size_t i = 0; i < ik_queries.size(); ++i)
+      if (!options.pose_prefilter(ik_queries[i]))
+      {
+        ROS_DEBUG_NAMED(LOGNAME, "IK query pose %zu was rejected by the pose pre-filter", i);
+        return false;
+      }
+
   if (attempts == 0)
     attempts = jmg->getDefaultIKAttempts();
 
@@ -1995,6 +2410,150 @@ double RobotState::computeCartesianPath(const JointModelGroup* group, std::vecto
   return last_valid_percentage;
 }
 
+double RobotState::computeCartesianPathParallel(const JointModelGroup* group, std::vector<RobotStatePtr>& traj,
+                                                const LinkModel* link, const Eigen::Isometry3d& target,
+                                                bool global_reference_frame, const MaxEEFStep& max_step,
+                                                const JumpThreshold& jump_threshold, unsigned int num_threads,
+                                                const GroupStateValidityCallbackFn& validCallback,
+                                                const kinematics::KinematicsQueryOptions& options)
+{
+  const std::vector<const JointModel*>& cjnt = group->getContinuousJointModels();
+  // make sure that continuous joints wrap
+  for (std::size_t i = 0; i < cjnt.size(); ++i)
+    enforceBounds(cjnt[i]);
+
+  Eigen::Isometry3d start_pose = getGlobalLinkTransform(link);
+  Eigen::Isometry3d rotated_target = global_reference_frame ? target : start_pose * target;
+
+  Eigen::Quaterniond start_quaternion(start_pose.rotation());
+  Eigen::Quaterniond target_quaternion(rotated_target.rotation());
+
+  if (max_step.translation <= 0.0 && max_step.rotation <= 0.0)
+  {
+    ROS_ERROR_NAMED(LOGNAME,
+                    "Invalid MaxEEFStep passed into computeCartesianPathParallel. Both the MaxEEFStep.rotation and "
+                    "MaxEEFStep.translation components must be non-negative and at least one component must be "
+                    "greater than zero");
+    return 0.0;
+  }
+
+  double rotation_distance = start_quaternion.angularDistance(target_quaternion);
+  double translation_distance = (rotated_target.translation() - start_pose.translation()).norm();
+
+  std::size_t translation_steps = 0;
+  if (max_step.translation > 0.0)
+    translation_steps = floor(translation_distance / max_step.translation);
+
+  std::size_t rotation_steps = 0;
+  if (max_step.rotation > 0.0)
+    rotation_steps = floor(rotation_distance / max_step.rotation);
+
+  std::size_t steps = std::max(translation_steps, rotation_steps) + 1;
+  if (jump_threshold.factor > 0 && steps < MIN_STEPS_FOR_JUMP_THRESH)
+    steps = MIN_STEPS_FOR_JUMP_THRESH;
+
+  // too little work to be worth the thread handoff; keep the serial semantics
+  if (num_threads <= 1 || steps < 2 * static_cast<std::size_t>(num_threads))
+    return computeCartesianPath(group, traj, link, rotated_target, true /* rotated_target is global */, max_step,
+                                jump_threshold, validCallback, options);
+
+  std::vector<double> consistency_limits;
+  if (jump_threshold.prismatic > 0 || jump_threshold.revolute > 0)
+    for (const JointModel* jm : group->getActiveJointModels())
+    {
+      double limit;
+      switch (jm->getType())
+      {
+        case JointModel::REVOLUTE:
+          limit = jump_threshold.revolute;
+          break;
+        case JointModel::PRISMATIC:
+          limit = jump_threshold.prismatic;
+          break;
+        default:
+          limit = 0.0;
+      }
+      if (limit == 0.0)
+        limit = jm->getMaximumExtent();
+      consistency_limits.push_back(limit);
+    }
+
+  // precompute the interpolated poses for steps 1..steps
+  EigenSTL::vector_Isometry3d poses(steps, Eigen::Isometry3d::Identity());
+  for (std::size_t i = 1; i <= steps; ++i)
+  {
+    double percentage = (double)i / (double)steps;
+    Eigen::Isometry3d pose(start_quaternion.slerp(percentage, target_quaternion));
+    pose.translation() = percentage * rotated_target.translation() + (1 - percentage) * start_pose.translation();
+    poses[i - 1] = pose;
+  }
+
+  // partition steps into chunks; chunk c covers step indices [chunk_start[c], chunk_start[c + 1])
+  const std::size_t nchunks = num_threads;
+  std::vector<std::size_t> chunk_start(nchunks + 1);
+  for (std::size_t c = 0; c <= nchunks; ++c)
+    chunk_start[c] = c * steps / nchunks;
+
+  // serial pass over the chunk boundary poses, each seeded from the previous boundary solution,
+  // so every chunk gets a consistent seed before the interior steps are solved in parallel
+  std::vector<RobotStatePtr> boundary(nchunks + 1);
+  boundary[0].reset(new RobotState(*this));
+  std::size_t solved_boundaries = 0;
+  for (std::size_t c = 1; c <= nchunks; ++c)
+  {
+    RobotStatePtr b(new RobotState(*boundary[c - 1]));
+    if (!b->setFromIK(group, poses[chunk_start[c] - 1], link->getName(), consistency_limits, 1, 0.0, validCallback,
+                      options))
+      break;
+    boundary[c] = b;
+    solved_boundaries = c;
+  }
+
+  // solve the interior steps of each reachable chunk concurrently
+  std::vector<std::vector<RobotStatePtr> > chunk_states(nchunks);
+  std::vector<std::size_t> chunk_solved(nchunks, 0);  // number of interior steps solved per chunk
+  std::vector<std::thread> threads;
+  for (std::size_t c = 0; c < solved_boundaries; ++c)
+    threads.emplace_back([&, c] {
+      RobotState st(*boundary[c]);
+      for (std::size_t i = chunk_start[c]; i + 1 < chunk_start[c + 1]; ++i)
+      {
+        if (!st.setFromIK(group, poses[i], link->getName(), consistency_limits, 1, 0.0, validCallback, options))
+          return;
+        chunk_states[c].push_back(RobotStatePtr(new RobotState(st)));
+        ++chunk_solved[c];
+      }
+    });
+  for (std::thread& t : threads)
+    t.join();
+
+  // stitch the chunks back together, truncating at the first unsolved step
+  traj.clear();
+  traj.push_back(RobotStatePtr(new RobotState(*this)));
+  std::size_t last_solved_step = 0;  // 1-based step count
+  for (std::size_t c = 0; c < solved_boundaries; ++c)
+  {
+    const std::size_t interior = chunk_start[c + 1] - chunk_start[c] - 1;
+    traj.insert(traj.end(), chunk_states[c].begin(), chunk_states[c].end());
+    if (chunk_solved[c] < interior)
+    {
+      last_solved_step = chunk_start[c] + chunk_solved[c];
+      break;
+    }
+    traj.push_back(boundary[c + 1]);
+    last_solved_step = chunk_start[c + 1];
+  }
+
+  double last_valid_percentage = (double)last_solved_step / (double)steps;
+  last_valid_percentage *= testJointSpaceJump(group, traj, jump_threshold);
+
+  // leave this state at the end of the computed trajectory, matching the serial version
+  if (!traj.empty())
+    *this = *traj.back();
+
+  return last_valid_percentage;
+}
+
 double RobotState::computeCartesianPath(const JointModelGroup* group, std::vector<RobotStatePtr>& traj,
                                         const LinkModel* link, const EigenSTL::vector_Isometry3d& waypoints,
                                         bool global_reference_frame, const MaxEEFStep& max_step,
@@ -0,0 +1,101 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2021, MoveIt Team.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+/* Author: MoveIt Team */
+
+#include <moveit/robot_state/robot_state_pool.h>
+
+namespace moveit
+{
+namespace core
+{
+RobotStatePool::RobotStatePool(const RobotModelConstPtr& model, std::size_t initial_size) : model_(model)
+{
+  free_list_.reserve(initial_size);
+  for (std::size_t i = 0; i < initial_size; ++i)
+  {
+    RobotState* state = new RobotState(model_);
+    state->setToDefaultValues();
+    free_list_.push_back(state);
+  }
+}
+
+RobotStatePool::~RobotStatePool()
+{
+  boost::mutex::scoped_lock slock(lock_);
+  for (RobotState* state : free_list_)
+    delete state;
+}
+
+RobotStatePtr RobotStatePool::getState()
+{
+  RobotState* state = nullptr;
+  {
+    boost::mutex::scoped_lock slock(lock_);
+    if (!free_list_.empty())
+    {
+      state = free_list_.back();
+      free_list_.pop_back();
+    }
+  }
+  if (!state)
+  {
+    state = new RobotState(model_);
+    state->setToDefaultValues();
+  }
+  return RobotStatePtr(state, [this](RobotState* s) { returnState(s); });
+}
+
+RobotStatePtr RobotStatePool::getState(const RobotState& seed)
+{
+  RobotStatePtr state = getState();
+  *state = seed;  // assignment reuses the pre-sized buffers; no allocation
+  return state;
+}
+
+std::size_t RobotStatePool::getFreeCount() const
+{
+  boost::mutex::scoped_lock slock(lock_);
+  return free_list_.size();
+}
+
+void RobotStatePool::returnState(RobotState* state)
+{
+  // drop any attached bodies so pooled states do not pin geometry
+  state->clearAttachedBodies();
+  boost::mutex::scoped_lock slock(lock_);
+  free_list_.push_back(state);
+}
+}  // namespace core
+}  // namespace moveit
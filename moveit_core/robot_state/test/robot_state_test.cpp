@@ -576,6 +576,68 @@ std::size_t generateTestTraj(std::vector<std::shared_ptr<robot_state::RobotState
   return traj.size();
 }
 
+TEST(getJacobianVectorized, MatchesScalarJacobian)
+{
+  moveit::core::RobotModelBuilder builder("myrobot", "base_link");
+  builder.addChain("base_link->a->b->c", "revolute");
+  builder.addGroupChain("base_link", "c", "arm");
+  ASSERT_TRUE(builder.isValid());
+  moveit::core::RobotModelPtr model = builder.build();
+  moveit::core::RobotState state(model);
+  const moveit::core::JointModelGroup* group = model->getJointModelGroup("arm");
+  const moveit::core::LinkModel* tip = model->getLinkModel("c");
+  const Eigen::Vector3d ref(0.1, 0.0, 0.2);
+
+  moveit::core::RobotState::JacobianCache cache;
+  random_numbers::RandomNumberGenerator rng(17);
+  for (int trial = 0; trial < 5; ++trial)
+  {
+    state.setToRandomPositions(group, rng);
+    state.updateLinkTransforms();
+
+    Eigen::MatrixXd jacobian_scalar, jacobian_vec, jacobian_cached;
+    ASSERT_TRUE(static_cast<const moveit::core::RobotState&>(state).getJacobian(group, tip, ref, jacobian_scalar));
+    ASSERT_TRUE(state.getJacobianVectorized(group, tip, ref, jacobian_vec));
+    ASSERT_TRUE(state.getJacobianVectorized(group, tip, ref, jacobian_cached, cache));
+    EXPECT_TRUE(jacobian_scalar.isApprox(jacobian_vec, 1e-12));
+    EXPECT_TRUE(jacobian_scalar.isApprox(jacobian_cached, 1e-12));
+
+    // perturb only the distal joint and make sure the cached variant stays in sync
+    std::vector<double> values;
+    state.copyJointGroupPositions(group, values);
+    values.back() += 0.3;
+    state.setJointGroupPositions(group, values);
+    state.updateLinkTransforms();
+    ASSERT_TRUE(static_cast<const moveit::core::RobotState&>(state).getJacobian(group, tip, ref, jacobian_scalar));
+    ASSERT_TRUE(state.getJacobianVectorized(group, tip, ref, jacobian_cached, cache));
+    EXPECT_TRUE(jacobian_scalar.isApprox(jacobian_cached, 1e-12));
+  }
+}
+
+TEST_F(OneRobot, SoAFk)
+{
+  // the flattened FK sweep must produce the same global transforms as the tree walk
+  moveit::core::RobotState state_tree(robot_model_);
+  moveit::core::RobotState state_soa(robot_model_);
+
+  random_numbers::RandomNumberGenerator rng(42);
+  for (int trial = 0; trial < 10; ++trial)
+  {
+    state_tree.setToRandomPositions(rng);
+    state_soa.setVariablePositions(state_tree.getVariablePositions());
+    state_tree.update();
+
+    std::const_pointer_cast<moveit::core::RobotModel>(robot_model_)->setSoAFkEnabled(true);
+    ASSERT_TRUE(robot_model_->getSoAFkEngine() != nullptr);
+    state_soa.update(true);
+    std::const_pointer_cast<moveit::core::RobotModel>(robot_model_)->setSoAFkEnabled(false);
+
+    for (const moveit::core::LinkModel* link : robot_model_->getLinkModels())
+      EXPECT_TRUE(state_tree.getGlobalLinkTransform(link).isApprox(state_soa.getGlobalLinkTransform(link), 1e-9))
+          << "link " << link->getName() << " differs in trial " << trial;
+  }
+}
+
 TEST_F(OneRobot, testGenerateTrajectory)
 {
   const robot_model::JointModelGroup* joint_model_group = robot_model_->getJointModelGroup("base_from_base_to_e");
@@ -276,6 +276,47 @@ TEST_F(LoadPlanningModelsPr2, FullTest)
   ASSERT_EQ(attached_bodies_2.size(), 0u);
 }
 
+TEST_F(LoadPlanningModelsPr2, CoordinatedMultiTipIK)
+{
+  moveit::core::RobotModelPtr robot_model(new moveit::core::RobotModel(urdf_model_, srdf_model_));
+  const moveit::core::JointModelGroup* jmg = robot_model->getJointModelGroup("arms");
+  ASSERT_TRUE(jmg);
+
+  std::vector<std::string> tips;
+  tips.push_back("l_wrist_roll_link");
+  tips.push_back("r_wrist_roll_link");
+
+  moveit::core::RobotState state(robot_model);
+  state.setToDefaultValues();
+  state.update();
+
+  // targets from a configuration near the seed, so both tips are simultaneously achievable
+  random_numbers::RandomNumberGenerator rng(42);
+  moveit::core::RobotState target_state(state);
+  target_state.setToRandomPositionsNearBy(jmg, state, 0.2, rng);
+  target_state.update();
+  EigenSTL::vector_Isometry3d poses;
+  poses.push_back(target_state.getGlobalLinkTransform(tips[0]));
+  poses.push_back(target_state.getGlobalLinkTransform(tips[1]));
+
+  moveit::core::RobotState::CoordinatedIKContext context;
+  ASSERT_TRUE(state.setFromIKCoordinated(jmg, poses, tips, context, std::vector<double>(), 200, 1e-3));
+  state.update();
+  for (std::size_t t = 0; t < tips.size(); ++t)
+  {
+    const Eigen::Isometry3d& reached = state.getGlobalLinkTransform(tips[t]);
+    EXPECT_LT((reached.translation() - poses[t].translation()).norm(), 5e-3);
+    EXPECT_LT(Eigen::AngleAxisd(poses[t].rotation() * reached.rotation().transpose()).angle(), 5e-3);
+  }
+
+  // on failure (zero iterations allowed) the state must be left untouched
+  moveit::core::RobotState unchanged(robot_model);
+  unchanged.setToDefaultValues();
+  moveit::core::RobotState failed(unchanged);
+  EXPECT_FALSE(failed.setFromIKCoordinated(jmg, poses, tips, context, std::vector<double>(), 0, 1e-3));
+  EXPECT_NEAR(failed.distance(unchanged), 0.0, 1e-12);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,108 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/robot_state/reachability_map.h>
+#include <moveit/robot_state/robot_state.h>
+#include <moveit/utils/robot_model_test_utils.h>
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+TEST(ReachabilityMap, BuildAndQuery)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("pr2");
+  moveit::core::ReachabilityMap map;
+  ASSERT_TRUE(map.build(model, "right_arm", "", 0.1, 20000));
+  EXPECT_EQ("right_arm", map.getGroupName());
+  EXPECT_GT(map.getOccupancy(), 0.0);
+
+  // positions far outside the workspace of the arm must be rejected
+  EXPECT_FALSE(map.isPositionReachable(Eigen::Vector3d(10.0, 0.0, 0.0)));
+  EXPECT_FALSE(map.isPositionReachable(Eigen::Vector3d(0.0, 0.0, -5.0)));
+
+  // the map is conservative: tip positions of random configurations must (almost) all be found;
+  // a few may fall in voxels the sampling pass missed
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup("right_arm");
+  int reachable = 0;
+  for (int i = 0; i < 100; ++i)
+  {
+    state.setToRandomPositions(jmg);
+    state.updateLinkTransforms();
+    if (map.isPositionReachable(state.getGlobalLinkTransform(map.getTipLink()).translation()))
+      ++reachable;
+  }
+  EXPECT_GE(reachable, 80);
+}
+
+TEST(ReachabilityMap, SaveLoadRoundtrip)
+{
+  moveit::core::RobotModelPtr model = moveit::core::loadTestingRobotModel("pr2");
+  moveit::core::ReachabilityMap map;
+  ASSERT_TRUE(map.build(model, "right_arm", "", 0.1, 20000));
+
+  const std::string filename =
+      (boost::filesystem::temp_directory_path() / "moveit_test_reachability_map.rmap").string();
+  ASSERT_TRUE(map.save(filename));
+
+  moveit::core::ReachabilityMap loaded;
+  ASSERT_TRUE(loaded.load(filename));
+  EXPECT_EQ(map.getGroupName(), loaded.getGroupName());
+  EXPECT_EQ(map.getTipLink(), loaded.getTipLink());
+  EXPECT_DOUBLE_EQ(map.getResolution(), loaded.getResolution());
+  EXPECT_DOUBLE_EQ(map.getOccupancy(), loaded.getOccupancy());
+
+  // both maps must answer queries identically
+  moveit::core::RobotState state(model);
+  state.setToDefaultValues();
+  const moveit::core::JointModelGroup* jmg = model->getJointModelGroup("right_arm");
+  for (int i = 0; i < 20; ++i)
+  {
+    state.setToRandomPositions(jmg);
+    state.updateLinkTransforms();
+    const Eigen::Isometry3d& tip = state.getGlobalLinkTransform(loaded.getTipLink());
+    EXPECT_EQ(map.isPositionReachable(tip.translation()), loaded.isPositionReachable(tip.translation()));
+    EXPECT_EQ(map.isPoseReachable(tip.translation(), Eigen::Quaterniond(tip.rotation())),
+              loaded.isPoseReachable(tip.translation(), Eigen::Quaterniond(tip.rotation())));
+  }
+  EXPECT_FALSE(loaded.isPositionReachable(Eigen::Vector3d(10.0, 0.0, 0.0)));
+
+  boost::filesystem::remove(filename);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -185,6 +185,15 @@ public:
     duration_from_previous_.insert(duration_from_previous_.begin() + index, dt);
   }
 
+  /**
+   * \brief Remove the waypoint at the given index; the durations of the remaining waypoints are unchanged
+   */
+  void removeWayPoint(std::size_t index)
+  {
+    waypoints_.erase(waypoints_.begin() + index);
+    duration_from_previous_.erase(duration_from_previous_.begin() + index);
+  }
+
   /**
    * \brief Add a specified part of a trajectory to the end of the current trajectory. The default (when \p start_index
    * and \p end_index are omitted) is to add the whole trajectory.
@@ -204,7 +213,17 @@ public:
 
   double getAverageSegmentDuration() const;
 
-  void getRobotTrajectoryMsg(moveit_msgs::RobotTrajectory& trajectory) const;
+  /**
+   * \brief Build a trajectory message from a part of this trajectory. The default (when \p start_index and
+   * \p end_index are omitted) is to convert the whole trajectory. Extracting a window this way avoids first
+   * converting the full waypoint set and then discarding most of it, e.g. when repeatedly streaming the
+   * remaining suffix of a trajectory to an executor.
+   * \param trajectory - the message to fill; its previous content is discarded
+   * \param start_index - index of the first waypoint to convert, the default is the start of the trajectory
+   * \param end_index - index one past the last waypoint to convert, the default is to convert until the end
+   */
+  void getRobotTrajectoryMsg(moveit_msgs::RobotTrajectory& trajectory, std::size_t start_index = 0,
+                             std::size_t end_index = std::numeric_limits<std::size_t>::max()) const;
 
   /** \brief Copy the content of the trajectory message into this class. The trajectory message itself is not required
      to contain the values
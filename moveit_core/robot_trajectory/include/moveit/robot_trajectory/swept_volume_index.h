@@ -0,0 +1,96 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_ROBOT_TRAJECTORY_SWEPT_VOLUME_INDEX_
+#define MOVEIT_ROBOT_TRAJECTORY_SWEPT_VOLUME_INDEX_
+
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/robot_model/aabb.h>
+#include <vector>
+
+namespace robot_trajectory
+{
+/** \brief Per-segment axis-aligned bounding boxes of a trajectory, for fast invalidation queries.
+
+    When an obstacle appears while a plan is executing, re-validating the whole trajectory
+    against the planning scene is far too slow for a reactive response. This index computes,
+    in one pass over the waypoints, an axis-aligned bounding box of the robot (including
+    attached bodies) at every waypoint and unions consecutive waypoint boxes into one box
+    per trajectory segment. segmentsIntersecting() then reports which segments a given box
+    overlaps with a linear sweep over flat memory.
+
+    A segment box is the union of the boxes of its two endpoint waypoints, which is not a
+    strict bound on the volume swept between them; callers should extend the query box by a
+    margin that covers the motion between adjacent waypoints. A non-empty result is a hint
+    to re-validate the reported segments, not a collision verdict. */
+class SweptVolumeIndex
+{
+public:
+  /** \brief Build the index from the current waypoints of \e trajectory. The index is a
+      snapshot; it does not track later changes to the trajectory. */
+  SweptVolumeIndex(const RobotTrajectory& trajectory);
+
+  /** \brief Number of segments indexed; one less than the number of waypoints */
+  std::size_t getSegmentCount() const
+  {
+    return segment_aabbs_.size();
+  }
+
+  /** \brief The bounding box of the robot over segment \e segment (between waypoints
+      \e segment and \e segment + 1) */
+  const moveit::core::AABB& getSegmentAABB(std::size_t segment) const
+  {
+    return segment_aabbs_[segment];
+  }
+
+  /** \brief The bounding box of the robot over the entire trajectory */
+  const moveit::core::AABB& getTrajectoryAABB() const
+  {
+    return trajectory_aabb_;
+  }
+
+  /** \brief Get the indices of the segments whose bounding box intersects \e box, in
+      increasing order. \e segments is cleared first. */
+  void segmentsIntersecting(const moveit::core::AABB& box, std::vector<std::size_t>& segments) const;
+
+  /** \brief Whether the bounding box of any segment intersects \e box */
+  bool intersects(const moveit::core::AABB& box) const;
+
+private:
+  std::vector<moveit::core::AABB> segment_aabbs_;
+  moveit::core::AABB trajectory_aabb_;
+};
+}
+
+#endif
@@ -0,0 +1,133 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_ROBOT_TRAJECTORY_TRAJECTORY_COLUMNS_
+#define MOVEIT_ROBOT_TRAJECTORY_TRAJECTORY_COLUMNS_
+
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <vector>
+
+namespace robot_trajectory
+{
+/** \brief Columnar (structure-of-arrays) view of the waypoints of a RobotTrajectory.
+
+    A RobotTrajectory stores its waypoints as individually allocated RobotState objects,
+    so algorithms that sweep over one variable across all waypoints chase a pointer and
+    touch a full state for every value they read. This class gathers the positions,
+    velocities and accelerations of the variables of the trajectory's group into
+    contiguous per-variable arrays, so such sweeps run over flat memory. The velocity
+    and acceleration columns are writable; writeBack() scatters them into the waypoint
+    states of a trajectory. Positions are a read-only snapshot: writing them back would
+    invalidate the transforms cached in the waypoint states. */
+class TrajectoryColumns
+{
+public:
+  /** \brief Gather the waypoints of \e trajectory into columns. If the trajectory has no
+      group, all variables of the robot model are gathered. */
+  TrajectoryColumns(const RobotTrajectory& trajectory);
+
+  std::size_t getWayPointCount() const
+  {
+    return num_points_;
+  }
+
+  std::size_t getVariableCount() const
+  {
+    return num_variables_;
+  }
+
+  /** \brief The indices in the RobotState variable vector of the gathered variables, in column order */
+  const std::vector<int>& getVariableIndexList() const
+  {
+    return variable_index_list_;
+  }
+
+  /** \brief The positions of variable \e variable at all waypoints, as a contiguous array of
+      getWayPointCount() values */
+  const double* getPositions(std::size_t variable) const
+  {
+    return &positions_[variable * num_points_];
+  }
+
+  const double* getVelocities(std::size_t variable) const
+  {
+    return &velocities_[variable * num_points_];
+  }
+
+  double* getVelocities(std::size_t variable)
+  {
+    return &velocities_[variable * num_points_];
+  }
+
+  const double* getAccelerations(std::size_t variable) const
+  {
+    return &accelerations_[variable * num_points_];
+  }
+
+  double* getAccelerations(std::size_t variable)
+  {
+    return &accelerations_[variable * num_points_];
+  }
+
+  /** \brief Whether the waypoint at \e index had velocities when the columns were gathered.
+      The velocity column holds zeros for waypoints that did not. */
+  bool hasVelocities(std::size_t index) const
+  {
+    return has_velocities_[index];
+  }
+
+  /** \brief Whether the waypoint at \e index had accelerations when the columns were gathered.
+      The acceleration column holds zeros for waypoints that did not. */
+  bool hasAccelerations(std::size_t index) const
+  {
+    return has_accelerations_[index];
+  }
+
+  /** \brief Scatter the velocity and acceleration columns into the waypoint states of
+      \e trajectory, which must have the same number of waypoints the columns were gathered from */
+  void writeBack(RobotTrajectory& trajectory) const;
+
+private:
+  std::size_t num_points_;
+  std::size_t num_variables_;
+  std::vector<int> variable_index_list_;
+  std::vector<double> positions_;
+  std::vector<double> velocities_;
+  std::vector<double> accelerations_;
+  std::vector<bool> has_velocities_;
+  std::vector<bool> has_accelerations_;
+};
+}
+
+#endif
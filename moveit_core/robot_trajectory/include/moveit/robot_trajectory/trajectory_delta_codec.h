@@ -0,0 +1,69 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_ROBOT_TRAJECTORY_TRAJECTORY_DELTA_CODEC_
+#define MOVEIT_ROBOT_TRAJECTORY_TRAJECTORY_DELTA_CODEC_
+
+#include <trajectory_msgs/JointTrajectory.h>
+#include <cstdint>
+#include <vector>
+
+namespace robot_trajectory
+{
+/** \brief Delta encoding of joint trajectories for introspection and logging.
+
+    A full JointTrajectory message stores every waypoint as absolute double-precision
+    values, which is highly redundant for smooth paths: consecutive waypoints differ by
+    small amounts and many joints do not move at all. The encoder quantizes positions at
+    the given resolution, stores the first waypoint absolutely, and encodes subsequent
+    waypoints as variable-length zigzag deltas of the quantized values, with runs of
+    unchanged joints collapsed by run-length encoding. Time stamps are stored as
+    microsecond deltas. For smooth paths this shrinks the waypoint data roughly an order
+    of magnitude. Only joint names, positions and time stamps survive a roundtrip;
+    velocities, accelerations and effort are not encoded.
+
+    The encoding is lossy up to half the quantization resolution per position. */
+
+/** \brief Encode \e trajectory into \e buffer, quantizing positions at \e resolution
+    (in radians or meters). Previous content of \e buffer is discarded. */
+void encodeJointTrajectoryDeltas(const trajectory_msgs::JointTrajectory& trajectory, double resolution,
+                                 std::vector<std::uint8_t>& buffer);
+
+/** \brief Decode a buffer produced by encodeJointTrajectoryDeltas() back into a
+    trajectory with positions and time stamps. Returns false if the buffer is not a
+    valid encoding. */
+bool decodeJointTrajectoryDeltas(const std::vector<std::uint8_t>& buffer, trajectory_msgs::JointTrajectory& trajectory);
+}
+
+#endif
@@ -0,0 +1,64 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_ROBOT_TRAJECTORY_TRAJECTORY_FINGERPRINT_
+#define MOVEIT_ROBOT_TRAJECTORY_TRAJECTORY_FINGERPRINT_
+
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <cstdint>
+
+namespace robot_trajectory
+{
+/** \brief Compact joint-space signature of a trajectory, for detecting near-duplicate paths.
+
+    The trajectory is resampled to a fixed number of waypoints (by linear interpolation over the
+    waypoint index, so timing does not influence the signature), each sampled position is quantized
+    at the given resolution, and the quantized values are hashed together with the group name. Two
+    trajectories for the same group whose resampled waypoints all fall into the same quantization
+    cells therefore produce the same fingerprint, regardless of waypoint count or time
+    parameterization; this is what makes the hash locality sensitive. Paths that differ by more
+    than the resolution anywhere along their length produce different fingerprints with the usual
+    hash collision probability, so a fingerprint match should be treated as "almost certainly the
+    same path", not as proof. */
+typedef std::uint64_t TrajectoryFingerprint;
+
+/** \brief Compute the fingerprint of \e trajectory, quantizing joint positions at \e resolution
+    (radians or meters) and resampling the path to \e samples waypoints. An empty trajectory
+    yields 0, which no non-empty trajectory produces. The same \e resolution and \e samples must
+    be used for fingerprints to be comparable. */
+TrajectoryFingerprint computeTrajectoryFingerprint(const RobotTrajectory& trajectory, double resolution = 0.05,
+                                                   std::size_t samples = 16);
+}
+
+#endif
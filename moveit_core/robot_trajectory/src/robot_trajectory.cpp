@@ -196,11 +196,14 @@ void RobotTrajectory::clear()
   duration_from_previous_.clear();
 }
 
-void RobotTrajectory::getRobotTrajectoryMsg(moveit_msgs::RobotTrajectory& trajectory) const
+void RobotTrajectory::getRobotTrajectoryMsg(moveit_msgs::RobotTrajectory& trajectory, std::size_t start_index,
+                                            std::size_t end_index) const
 {
   trajectory = moveit_msgs::RobotTrajectory();
-  if (waypoints_.empty())
+  end_index = std::min(end_index, waypoints_.size());
+  if (start_index >= end_index)
     return;
+  std::size_t point_count = end_index - start_index;
   const std::vector<const robot_model::JointModel*>& jnt =
       group_ ? group_->getActiveJointModels() : robot_model_->getActiveJointModels();
 
@@ -224,70 +227,74 @@ void RobotTrajectory::getRobotTrajectoryMsg(moveit_msgs::RobotTrajectory& trajec
   {
     trajectory.joint_trajectory.header.frame_id = robot_model_->getModelFrame();
     trajectory.joint_trajectory.header.stamp = ros::Time(0);
-    trajectory.joint_trajectory.points.resize(waypoints_.size());
+    trajectory.joint_trajectory.points.resize(point_count);
   }
 
   if (!mdof.empty())
   {
     trajectory.multi_dof_joint_trajectory.header.frame_id = robot_model_->getModelFrame();
     trajectory.multi_dof_joint_trajectory.header.stamp = ros::Time(0);
-    trajectory.multi_dof_joint_trajectory.points.resize(waypoints_.size());
+    trajectory.multi_dof_joint_trajectory.points.resize(point_count);
   }
 
+  // the variable index of each single-dof joint; hoisted out of the waypoint loop below
+  std::vector<int> onedof_idx(onedof.size());
+  for (std::size_t j = 0; j < onedof.size(); ++j)
+    onedof_idx[j] = onedof[j]->getFirstVariableIndex();
+
   static const ros::Duration ZERO_DURATION(0.0);
+  // time stamps are relative to the first converted waypoint, so an extracted window starts near zero
   double total_time = 0.0;
-  for (std::size_t i = 0; i < waypoints_.size(); ++i)
+  for (std::size_t i = start_index; i < end_index; ++i)
   {
     if (duration_from_previous_.size() > i)
       total_time += duration_from_previous_[i];
+    std::size_t out = i - start_index;
 
+    const robot_state::RobotState& waypoint = *waypoints_[i];
     if (!onedof.empty())
     {
-      trajectory.joint_trajectory.points[i].positions.resize(onedof.size());
-      trajectory.joint_trajectory.points[i].velocities.reserve(onedof.size());
-
+      trajectory_msgs::JointTrajectoryPoint& point = trajectory.joint_trajectory.points[out];
+      point.positions.resize(onedof.size());
       for (std::size_t j = 0; j < onedof.size(); ++j)
+        point.positions[j] = waypoint.getVariablePosition(onedof_idx[j]);
+      // if we have velocities/accelerations/effort, copy those too
+      if (waypoint.hasVelocities())
+      {
+        point.velocities.resize(onedof.size());
+        for (std::size_t j = 0; j < onedof.size(); ++j)
+          point.velocities[j] = waypoint.getVariableVelocity(onedof_idx[j]);
+      }
+      if (waypoint.hasAccelerations())
+      {
+        point.accelerations.resize(onedof.size());
+        for (std::size_t j = 0; j < onedof.size(); ++j)
+          point.accelerations[j] = waypoint.getVariableAcceleration(onedof_idx[j]);
+      }
+      if (waypoint.hasEffort())
       {
-        trajectory.joint_trajectory.points[i].positions[j] =
-            waypoints_[i]->getVariablePosition(onedof[j]->getFirstVariableIndex());
-        // if we have velocities/accelerations/effort, copy those too
-        if (waypoints_[i]->hasVelocities())
-          trajectory.joint_trajectory.points[i].velocities.push_back(
-              waypoints_[i]->getVariableVelocity(onedof[j]->getFirstVariableIndex()));
-        if (waypoints_[i]->hasAccelerations())
-          trajectory.joint_trajectory.points[i].accelerations.push_back(
-              waypoints_[i]->getVariableAcceleration(onedof[j]->getFirstVariableIndex()));
-        if (waypoints_[i]->hasEffort())
-          trajectory.joint_trajectory.points[i].effort.push_back(
-              waypoints_[i]->getVariableEffort(onedof[j]->getFirstVariableIndex()));
+        point.effort.resize(onedof.size());
+        for (std::size_t j = 0; j < onedof.size(); ++j)
+          point.effort[j] = waypoint.getVariableEffort(onedof_idx[j]);
       }
-      // clear velocities if we have an incomplete specification
-      if (trajectory.joint_trajectory.points[i].velocities.size() != onedof.size())
-        trajectory.joint_trajectory.points[i].velocities.clear();
-      // clear accelerations if we have an incomplete specification
-      if (trajectory.joint_trajectory.points[i].accelerations.size() != onedof.size())
-        trajectory.joint_trajectory.points[i].accelerations.clear();
-      // clear effort if we have an incomplete specification
-      if (trajectory.joint_trajectory.points[i].effort.size() != onedof.size())
-        trajectory.joint_trajectory.points[i].effort.clear();
 
       if (duration_from_previous_.size() > i)
-        trajectory.joint_trajectory.points[i].time_from_start = ros::Duration(total_time);
+        point.time_from_start = ros::Duration(total_time);
       else
-        trajectory.joint_trajectory.points[i].time_from_start = ZERO_DURATION;
+        point.time_from_start = ZERO_DURATION;
     }
     if (!mdof.empty())
     {
-      trajectory.multi_dof_joint_trajectory.points[i].transforms.resize(mdof.size());
+      trajectory.multi_dof_joint_trajectory.points[out].transforms.resize(mdof.size());
       for (std::size_t j = 0; j < mdof.size(); ++j)
       {
         geometry_msgs::TransformStamped ts = tf2::eigenToTransform(waypoints_[i]->getJointTransform(mdof[j]));
-        trajectory.multi_dof_joint_trajectory.points[i].transforms[j] = ts.transform;
+        trajectory.multi_dof_joint_trajectory.points[out].transforms[j] = ts.transform;
         // TODO: currently only checking for planar multi DOF joints / need to add check for floating
-        if (waypoints_[i]->hasVelocities() && (mdof[j]->getType() == robot_model::JointModel::JointType::PLANAR))
+        if (waypoint.hasVelocities() && (mdof[j]->getType() == robot_model::JointModel::JointType::PLANAR))
         {
           const std::vector<std::string> names = mdof[j]->getVariableNames();
-          const double* velocities = waypoints_[i]->getJointVelocities(mdof[j]);
+          const double* velocities = waypoint.getJointVelocities(mdof[j]);
 
           geometry_msgs::Twist point_velocity;
 
@@ -310,13 +317,13 @@ void RobotTrajectory::getRobotTrajectoryMsg(moveit_msgs::RobotTrajectory& trajec
               point_velocity.angular.z = velocities[k];
             }
           }
-          trajectory.multi_dof_joint_trajectory.points[i].velocities.push_back(point_velocity);
+          trajectory.multi_dof_joint_trajectory.points[out].velocities.push_back(point_velocity);
         }
       }
       if (duration_from_previous_.size() > i)
-        trajectory.multi_dof_joint_trajectory.points[i].time_from_start = ros::Duration(total_time);
+        trajectory.multi_dof_joint_trajectory.points[out].time_from_start = ros::Duration(total_time);
       else
-        trajectory.multi_dof_joint_trajectory.points[i].time_from_start = ZERO_DURATION;
+        trajectory.multi_dof_joint_trajectory.points[out].time_from_start = ZERO_DURATION;
     }
   }
 }
@@ -0,0 +1,102 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/robot_trajectory/swept_volume_index.h>
+#include <moveit/robot_state/attached_body.h>
+#include <geometric_shapes/shape_operations.h>
+
+namespace robot_trajectory
+{
+SweptVolumeIndex::SweptVolumeIndex(const RobotTrajectory& trajectory)
+{
+  const std::size_t num_points = trajectory.getWayPointCount();
+  if (num_points == 0)
+    return;
+
+  // hoisted out of the waypoint loop; the link set and shape extents are the same at every waypoint
+  const std::vector<const robot_model::LinkModel*>& links =
+      trajectory.getRobotModel()->getLinkModelsWithCollisionGeometry();
+
+  std::vector<moveit::core::AABB> waypoint_aabbs(num_points);
+  std::vector<const moveit::core::AttachedBody*> attached_bodies;
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    const robot_state::RobotState& waypoint = trajectory.getWayPoint(i);
+    moveit::core::AABB& box = waypoint_aabbs[i];
+    for (std::size_t j = 0; j < links.size(); ++j)
+    {
+      Eigen::Isometry3d transform = waypoint.getGlobalLinkTransform(links[j]);  // intentional copy, we will translate
+      transform.translate(links[j]->getCenteredBoundingBoxOffset());
+      box.extendWithTransformedBox(transform, links[j]->getShapeExtentsAtOrigin());
+    }
+    waypoint.getAttachedBodies(attached_bodies);
+    for (std::size_t j = 0; j < attached_bodies.size(); ++j)
+    {
+      const EigenSTL::vector_Isometry3d& transforms = attached_bodies[j]->getGlobalCollisionBodyTransforms();
+      const std::vector<shapes::ShapeConstPtr>& shapes = attached_bodies[j]->getShapes();
+      for (std::size_t k = 0; k < transforms.size(); ++k)
+        box.extendWithTransformedBox(transforms[k], shapes::computeShapeExtents(shapes[k].get()));
+    }
+    trajectory_aabb_.extend(box);
+  }
+
+  segment_aabbs_.resize(num_points > 1 ? num_points - 1 : 0);
+  for (std::size_t i = 0; i < segment_aabbs_.size(); ++i)
+  {
+    segment_aabbs_[i] = waypoint_aabbs[i];
+    segment_aabbs_[i].extend(waypoint_aabbs[i + 1]);
+  }
+}
+
+void SweptVolumeIndex::segmentsIntersecting(const moveit::core::AABB& box,
+                                            std::vector<std::size_t>& segments) const
+{
+  segments.clear();
+  if (!trajectory_aabb_.intersects(box))
+    return;
+  for (std::size_t i = 0; i < segment_aabbs_.size(); ++i)
+    if (segment_aabbs_[i].intersects(box))
+      segments.push_back(i);
+}
+
+bool SweptVolumeIndex::intersects(const moveit::core::AABB& box) const
+{
+  if (!trajectory_aabb_.intersects(box))
+    return false;
+  for (std::size_t i = 0; i < segment_aabbs_.size(); ++i)
+    if (segment_aabbs_[i].intersects(box))
+      return true;
+  return false;
+}
+}  // end of namespace robot_trajectory
@@ -0,0 +1,87 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/robot_trajectory/trajectory_columns.h>
+
+namespace robot_trajectory
+{
+TrajectoryColumns::TrajectoryColumns(const RobotTrajectory& trajectory)
+{
+  const robot_model::JointModelGroup* group = trajectory.getGroup();
+  if (group)
+    variable_index_list_ = group->getVariableIndexList();
+  else
+  {
+    variable_index_list_.resize(trajectory.getRobotModel()->getVariableCount());
+    for (std::size_t j = 0; j < variable_index_list_.size(); ++j)
+      variable_index_list_[j] = j;
+  }
+
+  num_points_ = trajectory.getWayPointCount();
+  num_variables_ = variable_index_list_.size();
+  positions_.resize(num_variables_ * num_points_);
+  velocities_.assign(num_variables_ * num_points_, 0.0);
+  accelerations_.assign(num_variables_ * num_points_, 0.0);
+  has_velocities_.resize(num_points_);
+  has_accelerations_.resize(num_points_);
+
+  for (std::size_t i = 0; i < num_points_; ++i)
+  {
+    const robot_state::RobotState& waypoint = trajectory.getWayPoint(i);
+    has_velocities_[i] = waypoint.hasVelocities();
+    has_accelerations_[i] = waypoint.hasAccelerations();
+    for (std::size_t j = 0; j < num_variables_; ++j)
+    {
+      positions_[j * num_points_ + i] = waypoint.getVariablePosition(variable_index_list_[j]);
+      if (has_velocities_[i])
+        velocities_[j * num_points_ + i] = waypoint.getVariableVelocity(variable_index_list_[j]);
+      if (has_accelerations_[i])
+        accelerations_[j * num_points_ + i] = waypoint.getVariableAcceleration(variable_index_list_[j]);
+    }
+  }
+}
+
+void TrajectoryColumns::writeBack(RobotTrajectory& trajectory) const
+{
+  for (std::size_t i = 0; i < num_points_; ++i)
+  {
+    const robot_state::RobotStatePtr& waypoint = trajectory.getWayPointPtr(i);
+    for (std::size_t j = 0; j < num_variables_; ++j)
+    {
+      waypoint->setVariableVelocity(variable_index_list_[j], velocities_[j * num_points_ + i]);
+      waypoint->setVariableAcceleration(variable_index_list_[j], accelerations_[j * num_points_ + i]);
+    }
+  }
+}
+}  // end of namespace robot_trajectory
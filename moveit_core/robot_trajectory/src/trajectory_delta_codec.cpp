@@ -0,0 +1,211 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/robot_trajectory/trajectory_delta_codec.h>
+#include <cmath>
+#include <cstring>
+
+namespace robot_trajectory
+{
+namespace
+{
+// buffer layout: magic, version, position resolution, joint names, point count, then the
+// first waypoint absolutely and every further waypoint as deltas; all integers are LEB128
+// varints, signed values zigzag-mapped first
+const char CODEC_MAGIC[4] = { 'M', 'J', 'T', 'D' };
+const std::uint8_t CODEC_VERSION = 1;
+
+void putVarint(std::uint64_t value, std::vector<std::uint8_t>& buffer)
+{
+  while (value >= 0x80)
+  {
+    buffer.push_back(static_cast<std::uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<std::uint8_t>(value));
+}
+
+bool getVarint(const std::vector<std::uint8_t>& buffer, std::size_t& pos, std::uint64_t& value)
+{
+  value = 0;
+  unsigned int shift = 0;
+  while (pos < buffer.size() && shift < 64)
+  {
+    std::uint8_t byte = buffer[pos++];
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+    shift += 7;
+  }
+  return false;
+}
+
+std::uint64_t zigzag(std::int64_t value)
+{
+  return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value)
+{
+  return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+std::int64_t quantize(double value, double resolution)
+{
+  return static_cast<std::int64_t>(llround(value / resolution));
+}
+}
+
+void encodeJointTrajectoryDeltas(const trajectory_msgs::JointTrajectory& trajectory, double resolution,
+                                 std::vector<std::uint8_t>& buffer)
+{
+  if (resolution <= 0.0)
+    resolution = 1e-5;
+  buffer.clear();
+  buffer.insert(buffer.end(), CODEC_MAGIC, CODEC_MAGIC + sizeof(CODEC_MAGIC));
+  buffer.push_back(CODEC_VERSION);
+  const std::uint8_t* res_bytes = reinterpret_cast<const std::uint8_t*>(&resolution);
+  buffer.insert(buffer.end(), res_bytes, res_bytes + sizeof(double));
+
+  std::size_t joint_count = trajectory.joint_names.size();
+  putVarint(joint_count, buffer);
+  for (std::size_t j = 0; j < joint_count; ++j)
+  {
+    putVarint(trajectory.joint_names[j].size(), buffer);
+    buffer.insert(buffer.end(), trajectory.joint_names[j].begin(), trajectory.joint_names[j].end());
+  }
+  putVarint(trajectory.points.size(), buffer);
+
+  std::vector<std::int64_t> previous(joint_count, 0);
+  std::int64_t previous_time = 0;
+  for (std::size_t i = 0; i < trajectory.points.size(); ++i)
+  {
+    const trajectory_msgs::JointTrajectoryPoint& point = trajectory.points[i];
+    std::int64_t time = point.time_from_start.toNSec() / 1000;
+    putVarint(zigzag(time - previous_time), buffer);
+    previous_time = time;
+
+    for (std::size_t j = 0; j < joint_count; ++j)
+    {
+      std::int64_t cell = j < point.positions.size() ? quantize(point.positions[j], resolution) : 0;
+      std::uint64_t delta = zigzag(cell - previous[j]);
+      previous[j] = cell;
+      if (delta == 0)
+      {
+        // run-length encode joints that did not move: a zero delta is followed by the
+        // number of further joints of this waypoint whose delta is also zero
+        std::size_t run_end = j + 1;
+        while (run_end < joint_count)
+        {
+          std::int64_t next_cell =
+              run_end < point.positions.size() ? quantize(point.positions[run_end], resolution) : 0;
+          if (next_cell != previous[run_end])
+            break;
+          ++run_end;
+        }
+        buffer.push_back(0);
+        putVarint(run_end - j - 1, buffer);
+        j = run_end - 1;
+      }
+      else
+        putVarint(delta, buffer);
+    }
+  }
+}
+
+bool decodeJointTrajectoryDeltas(const std::vector<std::uint8_t>& buffer, trajectory_msgs::JointTrajectory& trajectory)
+{
+  trajectory = trajectory_msgs::JointTrajectory();
+  std::size_t pos = sizeof(CODEC_MAGIC) + 1 + sizeof(double);
+  if (buffer.size() < pos || memcmp(&buffer[0], CODEC_MAGIC, sizeof(CODEC_MAGIC)) != 0 ||
+      buffer[sizeof(CODEC_MAGIC)] != CODEC_VERSION)
+    return false;
+  double resolution;
+  memcpy(&resolution, &buffer[sizeof(CODEC_MAGIC) + 1], sizeof(double));
+  if (!(resolution > 0.0))
+    return false;
+
+  std::uint64_t joint_count;
+  if (!getVarint(buffer, pos, joint_count))
+    return false;
+  trajectory.joint_names.resize(joint_count);
+  for (std::uint64_t j = 0; j < joint_count; ++j)
+  {
+    std::uint64_t length;
+    if (!getVarint(buffer, pos, length) || pos + length > buffer.size())
+      return false;
+    trajectory.joint_names[j].assign(buffer.begin() + pos, buffer.begin() + pos + length);
+    pos += length;
+  }
+
+  std::uint64_t point_count;
+  if (!getVarint(buffer, pos, point_count))
+    return false;
+  trajectory.points.resize(point_count);
+
+  std::vector<std::int64_t> previous(joint_count, 0);
+  std::int64_t previous_time = 0;
+  for (std::uint64_t i = 0; i < point_count; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint& point = trajectory.points[i];
+    std::uint64_t encoded;
+    if (!getVarint(buffer, pos, encoded))
+      return false;
+    previous_time += unzigzag(encoded);
+    point.time_from_start.fromNSec(previous_time * 1000);
+
+    point.positions.resize(joint_count);
+    for (std::uint64_t j = 0; j < joint_count; ++j)
+    {
+      if (!getVarint(buffer, pos, encoded))
+        return false;
+      if (encoded == 0)
+      {
+        std::uint64_t run;
+        if (!getVarint(buffer, pos, run) || j + run >= joint_count)
+          return false;
+        for (std::uint64_t k = 0; k <= run; ++k, ++j)
+          point.positions[j] = previous[j] * resolution;
+        --j;
+      }
+      else
+      {
+        previous[j] += unzigzag(encoded);
+        point.positions[j] = previous[j] * resolution;
+      }
+    }
+  }
+  return pos == buffer.size();
+}
+}
@@ -0,0 +1,98 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/robot_trajectory/trajectory_fingerprint.h>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+void hashBytes(std::uint64_t& hash, const void* data, std::size_t size)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= FNV_PRIME;
+  }
+}
+}
+
+robot_trajectory::TrajectoryFingerprint
+robot_trajectory::computeTrajectoryFingerprint(const RobotTrajectory& trajectory, double resolution,
+                                               std::size_t samples)
+{
+  const std::size_t waypoints = trajectory.getWayPointCount();
+  if (waypoints == 0 || resolution <= 0.0)
+    return 0;
+  if (samples < 2)
+    samples = 2;
+
+  // the group name is part of the signature, so trajectories for different groups never match
+  std::uint64_t hash = FNV_OFFSET;
+  const std::string& group_name = trajectory.getGroupName();
+  hashBytes(hash, group_name.data(), group_name.size());
+
+  const robot_model::JointModelGroup* group = trajectory.getGroup();
+  const std::vector<int>* index_list = group ? &group->getVariableIndexList() : NULL;
+  const std::size_t variable_count =
+      index_list ? index_list->size() : trajectory.getRobotModel()->getVariableCount();
+  hashBytes(hash, &variable_count, sizeof(variable_count));
+
+  for (std::size_t s = 0; s < samples; ++s)
+  {
+    // resample by linear interpolation over the waypoint index, so the signature depends only on
+    // the path, not on the waypoint density or the time parameterization
+    const double position =
+        waypoints > 1 ? static_cast<double>(s * (waypoints - 1)) / static_cast<double>(samples - 1) : 0.0;
+    const std::size_t before = static_cast<std::size_t>(position);
+    const std::size_t after = std::min(before + 1, waypoints - 1);
+    const double blend = position - static_cast<double>(before);
+    const double* a = trajectory.getWayPoint(before).getVariablePositions();
+    const double* b = trajectory.getWayPoint(after).getVariablePositions();
+    for (std::size_t v = 0; v < variable_count; ++v)
+    {
+      const int index = index_list ? (*index_list)[v] : static_cast<int>(v);
+      const double value = a[index] + (b[index] - a[index]) * blend;
+      const std::int64_t cell = static_cast<std::int64_t>(std::lround(value / resolution));
+      hashBytes(hash, &cell, sizeof(cell));
+    }
+  }
+
+  // 0 is reserved for "no fingerprint"
+  return hash ? hash : 1;
+}
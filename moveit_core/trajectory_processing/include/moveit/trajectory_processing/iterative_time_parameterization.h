@@ -41,6 +41,7 @@
 #include <moveit_msgs/JointLimits.h>
 #include <moveit_msgs/RobotState.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
+#include <moveit/robot_trajectory/trajectory_columns.h>
 
 namespace trajectory_processing
 {
@@ -59,10 +60,12 @@ private:
   unsigned int max_iterations_;    /// @brief maximum number of iterations to find solution
   double max_time_change_per_it_;  /// @brief maximum allowed time change per iteration in seconds
 
-  void applyVelocityConstraints(robot_trajectory::RobotTrajectory& rob_trajectory, std::vector<double>& time_diff,
+  void applyVelocityConstraints(const robot_trajectory::RobotTrajectory& rob_trajectory,
+                                const robot_trajectory::TrajectoryColumns& columns, std::vector<double>& time_diff,
                                 const double max_velocity_scaling_factor) const;
 
-  void applyAccelerationConstraints(robot_trajectory::RobotTrajectory& rob_trajectory, std::vector<double>& time_diff,
+  void applyAccelerationConstraints(const robot_trajectory::RobotTrajectory& rob_trajectory,
+                                    const robot_trajectory::TrajectoryColumns& columns, std::vector<double>& time_diff,
                                     const double max_acceleration_scaling_factor) const;
 
   double findT1(const double d1, const double d2, double t1, const double t2, const double a_max) const;
@@ -98,15 +98,14 @@ void printStats(const trajectory_msgs::JointTrajectory& trajectory, const std::v
 }
 
 // Applies velocity
-void IterativeParabolicTimeParameterization::applyVelocityConstraints(robot_trajectory::RobotTrajectory& rob_trajectory,
-                                                                      std::vector<double>& time_diff,
-                                                                      const double max_velocity_scaling_factor) const
+void IterativeParabolicTimeParameterization::applyVelocityConstraints(
+    const robot_trajectory::RobotTrajectory& rob_trajectory, const robot_trajectory::TrajectoryColumns& columns,
+    std::vector<double>& time_diff, const double max_velocity_scaling_factor) const
 {
   const robot_model::JointModelGroup* group = rob_trajectory.getGroup();
   const std::vector<std::string>& vars = group->getVariableNames();
-  const std::vector<int>& idx = group->getVariableIndexList();
   const robot_model::RobotModel& rmodel = group->getParentModel();
-  const int num_points = rob_trajectory.getWayPointCount();
+  const int num_points = columns.getWayPointCount();
 
   double velocity_scaling_factor = 1.0;
 
@@ -121,21 +120,24 @@ void IterativeParabolicTimeParameterization::applyVelocityConstraints(robot_traj
                    "Invalid max_velocity_scaling_factor %f specified, defaulting to %f instead.",
                    max_velocity_scaling_factor, velocity_scaling_factor);
 
-  for (int i = 0; i < num_points - 1; ++i)
+  // Hoist the velocity limits out of the waypoint loop (getVariableBounds does a name lookup); the
+  // minimum-time computation below then sweeps over the flat position columns and can be vectorized
+  // by the compiler
+  std::vector<double> v_max(vars.size(), DEFAULT_VEL_MAX);
+  for (std::size_t j = 0; j < vars.size(); ++j)
   {
-    const robot_state::RobotStatePtr& curr_waypoint = rob_trajectory.getWayPointPtr(i);
-    const robot_state::RobotStatePtr& next_waypoint = rob_trajectory.getWayPointPtr(i + 1);
+    const robot_model::VariableBounds& b = rmodel.getVariableBounds(vars[j]);
+    if (b.velocity_bounded_)
+      v_max[j] =
+          std::min(fabs(b.max_velocity_ * velocity_scaling_factor), fabs(b.min_velocity_ * velocity_scaling_factor));
+  }
 
-    for (std::size_t j = 0; j < vars.size(); ++j)
+  for (std::size_t j = 0; j < vars.size(); ++j)
+  {
+    const double* q = columns.getPositions(j);
+    for (int i = 0; i < num_points - 1; ++i)
     {
-      double v_max = DEFAULT_VEL_MAX;
-      const robot_model::VariableBounds& b = rmodel.getVariableBounds(vars[j]);
-      if (b.velocity_bounded_)
-        v_max =
-            std::min(fabs(b.max_velocity_ * velocity_scaling_factor), fabs(b.min_velocity_ * velocity_scaling_factor));
-      const double dq1 = curr_waypoint->getVariablePosition(idx[j]);
-      const double dq2 = next_waypoint->getVariablePosition(idx[j]);
-      const double t_min = std::abs(dq2 - dq1) / v_max;
+      const double t_min = std::abs(q[i + 1] - q[i]) / v_max[j];
       if (t_min > time_diff[i])
         time_diff[i] = t_min;
     }
@@ -187,7 +189,8 @@ namespace
 {
 // Takes the time differences, and updates the timestamps, velocities and accelerations
 // in the trajectory.
-void updateTrajectory(robot_trajectory::RobotTrajectory& rob_trajectory, const std::vector<double>& time_diff)
+void updateTrajectory(robot_trajectory::RobotTrajectory& rob_trajectory,
+                      robot_trajectory::TrajectoryColumns& columns, const std::vector<double>& time_diff)
 {
   // Error check
   if (time_diff.empty())
@@ -195,14 +198,6 @@ void updateTrajectory(robot_trajectory::RobotTrajectory& rob_trajectory, const s
 
   double time_sum = 0.0;
 
-  robot_state::RobotStatePtr prev_waypoint;
-  robot_state::RobotStatePtr curr_waypoint;
-  robot_state::RobotStatePtr next_waypoint;
-
-  const robot_model::JointModelGroup* group = rob_trajectory.getGroup();
-  const std::vector<std::string>& vars = group->getVariableNames();
-  const std::vector<int>& idx = group->getVariableIndexList();
-
   int num_points = rob_trajectory.getWayPointCount();
 
   rob_trajectory.setWayPointDurationFromPrevious(0, time_sum);
@@ -216,18 +211,15 @@ void updateTrajectory(robot_trajectory::RobotTrajectory& rob_trajectory, const s
   if (num_points <= 1)
     return;
 
-  // Accelerations
-  for (int i = 0; i < num_points; ++i)
+  // Accelerations; computed into the velocity and acceleration columns and scattered into the
+  // waypoint states in one pass at the end
+  for (std::size_t j = 0; j < columns.getVariableCount(); ++j)
   {
-    curr_waypoint = rob_trajectory.getWayPointPtr(i);
-
-    if (i > 0)
-      prev_waypoint = rob_trajectory.getWayPointPtr(i - 1);
-
-    if (i < num_points - 1)
-      next_waypoint = rob_trajectory.getWayPointPtr(i + 1);
+    const double* q = columns.getPositions(j);
+    double* vel = columns.getVelocities(j);
+    double* acc = columns.getAccelerations(j);
 
-    for (std::size_t j = 0; j < vars.size(); ++j)
+    for (int i = 0; i < num_points; ++i)
     {
       double q1;
       double q2;
@@ -238,8 +230,8 @@ void updateTrajectory(robot_trajectory::RobotTrajectory& rob_trajectory, const s
       if (i == 0)
       {
         // First point
-        q1 = next_waypoint->getVariablePosition(idx[j]);
-        q2 = curr_waypoint->getVariablePosition(idx[j]);
+        q1 = q[i + 1];
+        q2 = q[i];
         q3 = q1;
 
         dt1 = dt2 = time_diff[i];
@@ -247,9 +239,9 @@ void updateTrajectory(robot_trajectory::RobotTrajectory& rob_trajectory, const s
       else if (i < num_points - 1)
       {
         // middle points
-        q1 = prev_waypoint->getVariablePosition(idx[j]);
-        q2 = curr_waypoint->getVariablePosition(idx[j]);
-        q3 = next_waypoint->getVariablePosition(idx[j]);
+        q1 = q[i - 1];
+        q2 = q[i];
+        q3 = q[i + 1];
 
         dt1 = time_diff[i - 1];
         dt2 = time_diff[i];
@@ -257,8 +249,8 @@ void updateTrajectory(robot_trajectory::RobotTrajectory& rob_trajectory, const s
       else
       {
         // last point
-        q1 = prev_waypoint->getVariablePosition(idx[j]);
-        q2 = curr_waypoint->getVariablePosition(idx[j]);
+        q1 = q[i - 1];
+        q2 = q[i];
         q3 = q1;
 
         dt1 = dt2 = time_diff[i - 1];
@@ -277,10 +269,13 @@ void updateTrajectory(robot_trajectory::RobotTrajectory& rob_trajectory, const s
       {
         if (i == 0)
         {
-          if (curr_waypoint->hasVelocities())
+          // In the original point-major loop, setting the velocity of the first variable marked
+          // the waypoint as having velocities, so every subsequent variable saw a (zero) start
+          // velocity at the first waypoint; keep that behavior in the variable-major order
+          if (columns.hasVelocities(0) || j > 0)
           {
             start_velocity = true;
-            v1 = curr_waypoint->getVariableVelocity(idx[j]);
+            v1 = vel[0];
           }
         }
         v1 = start_velocity ? v1 : (q2 - q1) / dt1;
@@ -289,28 +284,25 @@ void updateTrajectory(robot_trajectory::RobotTrajectory& rob_trajectory, const s
         a = 2.0 * (v2 - v1) / (dt1 + dt2);
       }
 
-      curr_waypoint->setVariableVelocity(idx[j], (v2 + v1) / 2.0);
-      curr_waypoint->setVariableAcceleration(idx[j], a);
+      vel[i] = (v2 + v1) / 2.0;
+      acc[i] = a;
     }
   }
+
+  columns.writeBack(rob_trajectory);
 }
 }
 
 // Applies Acceleration constraints
 void IterativeParabolicTimeParameterization::applyAccelerationConstraints(
-    robot_trajectory::RobotTrajectory& rob_trajectory, std::vector<double>& time_diff,
-    const double max_acceleration_scaling_factor) const
+    const robot_trajectory::RobotTrajectory& rob_trajectory, const robot_trajectory::TrajectoryColumns& columns,
+    std::vector<double>& time_diff, const double max_acceleration_scaling_factor) const
 {
-  robot_state::RobotStatePtr prev_waypoint;
-  robot_state::RobotStatePtr curr_waypoint;
-  robot_state::RobotStatePtr next_waypoint;
-
   const robot_model::JointModelGroup* group = rob_trajectory.getGroup();
   const std::vector<std::string>& vars = group->getVariableNames();
-  const std::vector<int>& idx = group->getVariableIndexList();
   const robot_model::RobotModel& rmodel = group->getParentModel();
 
-  const int num_points = rob_trajectory.getWayPointCount();
+  const int num_points = columns.getWayPointCount();
   const unsigned int num_joints = group->getVariableCount();
   int num_updates = 0;
   int iteration = 0;
@@ -337,6 +329,18 @@ void IterativeParabolicTimeParameterization::applyAccelerationConstraints(
                    "Invalid max_acceleration_scaling_factor %f specified, defaulting to %f instead.",
                    max_acceleration_scaling_factor, acceleration_scaling_factor);
 
+  // As in applyVelocityConstraints, hoist the acceleration limits out of the waypoint loops; the
+  // position columns do not change while iterating, only the time intervals do, so the columns
+  // gathered by the caller serve all smoothing iterations
+  std::vector<double> a_max_per_joint(num_joints, DEFAULT_ACCEL_MAX);
+  for (unsigned int j = 0; j < num_joints; ++j)
+  {
+    const robot_model::VariableBounds& b = rmodel.getVariableBounds(vars[j]);
+    if (b.acceleration_bounded_)
+      a_max_per_joint[j] = std::min(fabs(b.max_acceleration_ * acceleration_scaling_factor),
+                                    fabs(b.min_acceleration_ * acceleration_scaling_factor));
+  }
+
   do
   {
     num_updates = 0;
@@ -346,6 +350,9 @@ void IterativeParabolicTimeParameterization::applyAccelerationConstraints(
     // This is so that any time interval increases have a chance to get propogated through the trajectory
     for (unsigned int j = 0; j < num_joints; ++j)
     {
+      const double a_max = a_max_per_joint[j];
+      const double* q = columns.getPositions(j);
+
       // Loop forwards, then backwards
       for (int count = 0; count < 2; ++count)
       {
@@ -353,27 +360,12 @@ void IterativeParabolicTimeParameterization::applyAccelerationConstraints(
         {
           int index = backwards ? (num_points - 1) - i : i;
 
-          curr_waypoint = rob_trajectory.getWayPointPtr(index);
-
-          if (index > 0)
-            prev_waypoint = rob_trajectory.getWayPointPtr(index - 1);
-
-          if (index < num_points - 1)
-            next_waypoint = rob_trajectory.getWayPointPtr(index + 1);
-
-          // Get acceleration limits
-          double a_max = DEFAULT_ACCEL_MAX;
-          const robot_model::VariableBounds& b = rmodel.getVariableBounds(vars[j]);
-          if (b.acceleration_bounded_)
-            a_max = std::min(fabs(b.max_acceleration_ * acceleration_scaling_factor),
-                             fabs(b.min_acceleration_ * acceleration_scaling_factor));
-
           if (index == 0)
           {
             // First point
-            q1 = next_waypoint->getVariablePosition(idx[j]);
-            q2 = curr_waypoint->getVariablePosition(idx[j]);
-            q3 = next_waypoint->getVariablePosition(idx[j]);
+            q1 = q[index + 1];
+            q2 = q[index];
+            q3 = q[index + 1];
 
             dt1 = dt2 = time_diff[index];
             assert(!backwards);
@@ -381,9 +373,9 @@ void IterativeParabolicTimeParameterization::applyAccelerationConstraints(
           else if (index < num_points - 1)
           {
             // middle points
-            q1 = prev_waypoint->getVariablePosition(idx[j]);
-            q2 = curr_waypoint->getVariablePosition(idx[j]);
-            q3 = next_waypoint->getVariablePosition(idx[j]);
+            q1 = q[index - 1];
+            q2 = q[index];
+            q3 = q[index + 1];
 
             dt1 = time_diff[index - 1];
             dt2 = time_diff[index];
@@ -391,9 +383,9 @@ void IterativeParabolicTimeParameterization::applyAccelerationConstraints(
           else
           {
             // last point - careful, there are only numpoints-1 time intervals
-            q1 = prev_waypoint->getVariablePosition(idx[j]);
-            q2 = curr_waypoint->getVariablePosition(idx[j]);
-            q3 = prev_waypoint->getVariablePosition(idx[j]);
+            q1 = q[index - 1];
+            q2 = q[index];
+            q3 = q[index - 1];
 
             dt1 = dt2 = time_diff[index - 1];
             assert(backwards);
@@ -410,10 +402,10 @@ void IterativeParabolicTimeParameterization::applyAccelerationConstraints(
             bool start_velocity = false;
             if (index == 0)
             {
-              if (curr_waypoint->hasVelocities())
+              if (columns.hasVelocities(0))
               {
                 start_velocity = true;
-                v1 = curr_waypoint->getVariableVelocity(idx[j]);
+                v1 = columns.getVelocities(j)[0];
               }
             }
             v1 = start_velocity ? v1 : (q2 - q1) / dt1;
@@ -478,10 +470,14 @@ bool IterativeParabolicTimeParameterization::computeTimeStamps(robot_trajectory:
   const int num_points = trajectory.getWayPointCount();
   std::vector<double> time_diff(num_points - 1, 0.0);  // the time difference between adjacent points
 
-  applyVelocityConstraints(trajectory, time_diff, max_velocity_scaling_factor);
-  applyAccelerationConstraints(trajectory, time_diff, max_acceleration_scaling_factor);
+  // Gather the waypoints into contiguous per-variable columns once; all passes below sweep over
+  // flat memory instead of chasing a RobotState pointer per waypoint
+  robot_trajectory::TrajectoryColumns columns(trajectory);
+
+  applyVelocityConstraints(trajectory, columns, time_diff, max_velocity_scaling_factor);
+  applyAccelerationConstraints(trajectory, columns, time_diff, max_acceleration_scaling_factor);
 
-  updateTrajectory(trajectory, time_diff);
+  updateTrajectory(trajectory, columns, time_diff);
   return true;
 }
 }
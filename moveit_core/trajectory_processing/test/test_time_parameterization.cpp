@@ -41,6 +41,7 @@
 #include <moveit/robot_trajectory/robot_trajectory.h>
 #include <moveit/trajectory_processing/iterative_spline_parameterization.h>
 #include <moveit/trajectory_processing/iterative_time_parameterization.h>
+#include <moveit/trajectory_processing/time_optimal_trajectory_generation.h>
 #include <moveit/utils/robot_model_test_utils.h>
 
 // Static variables used in all tests
@@ -170,6 +171,28 @@ TEST(TestTimeParameterization, TestIterativeSplineAddPoints)
   ASSERT_LT(trajectory.getWayPointDurationFromStart(trajectory.getWayPointCount() - 1), 5.0);
 }
 
+TEST(TestTimeParameterization, TestTimeOptimalTrajectoryGeneration)
+{
+  trajectory_processing::TimeOptimalTrajectoryGeneration time_parameterization;
+  EXPECT_EQ(initStraightTrajectory(trajectory), 0);
+
+  ros::WallTime wt = ros::WallTime::now();
+  EXPECT_TRUE(time_parameterization.computeTimeStamps(trajectory));
+  std::cout << "TimeOptimalTrajectoryGeneration took " << (ros::WallTime::now() - wt).toSec() << std::endl;
+  printTrajectory(trajectory);
+  ASSERT_LT(trajectory.getWayPointDurationFromStart(trajectory.getWayPointCount() - 1), 3.0);
+}
+
+TEST(TestTimeParameterization, TestTimeOptimalTrajectoryGenerationRepeatedPoint)
+{
+  trajectory_processing::TimeOptimalTrajectoryGeneration time_parameterization;
+  EXPECT_EQ(initRepeatedPointTrajectory(trajectory), 0);
+
+  EXPECT_TRUE(time_parameterization.computeTimeStamps(trajectory));
+  printTrajectory(trajectory);
+  ASSERT_LT(trajectory.getWayPointDurationFromStart(trajectory.getWayPointCount() - 1), 0.001);
+}
+
 TEST(TestTimeParameterization, TestRepeatedPoint)
 {
   trajectory_processing::IterativeSplineParameterization time_parameterization(true);
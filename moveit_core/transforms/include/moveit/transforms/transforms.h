@@ -40,6 +40,7 @@
 #include <geometry_msgs/TransformStamped.h>
 #include <geometry_msgs/Pose.h>
 #include <Eigen/Geometry>
+#include <eigen_stl_containers/eigen_stl_containers.h>
 #include <boost/noncopyable.hpp>
 #include <moveit/macros/class_forward.h>
 
@@ -174,6 +175,22 @@ public:
   {
     t_out = getTransform(from_frame) * t_in;
   }
+
+  /**
+   * @brief Transform multiple poses from from_frame to the target_frame.
+   *        The frame is resolved only once and the resulting transform is applied to all poses.
+   * @param from_frame The frame in which the input poses are specified
+   * @param poses_in The input poses (in from_frame)
+   * @param poses_out The resultant (transformed) poses; may be the same container as \e poses_in
+   */
+  void transformPoses(const std::string& from_frame, const EigenSTL::vector_Isometry3d& poses_in,
+                      EigenSTL::vector_Isometry3d& poses_out) const
+  {
+    const Eigen::Isometry3d t = getTransform(from_frame);
+    poses_out.resize(poses_in.size());
+    for (std::size_t i = 0; i < poses_in.size(); ++i)
+      poses_out[i] = t * poses_in[i];
+  }
   /**@}*/
 
   /**
@@ -194,9 +211,31 @@ public:
    */
   virtual const Eigen::Isometry3d& getTransform(const std::string& from_frame) const;
 
+  /**
+   * @brief Get the dense index compiled for \e from_frame, so that repeated lookups
+   *        can use getTransform(int) and avoid resolving the frame string each time.
+   *        Indices remain valid until the set of maintained frames changes.
+   * @return The frame index, or -1 if the frame is not a fixed frame maintained here
+   */
+  int getFrameIndex(const std::string& from_frame) const;
+
+  /**
+   * @brief Get transform by the dense index obtained from getFrameIndex() (w.r.t target frame)
+   */
+  const Eigen::Isometry3d& getTransform(int frame_index) const;
+
 protected:
   std::string target_frame_;
   FixedTransformsMap transforms_map_;
+
+private:
+  /** @brief Rebuild the dense frame table from transforms_map_ */
+  void compileFrameTable();
+
+  // dense table mirroring transforms_map_, compiled whenever the transforms
+  // are modified through the setters of this class
+  std::map<std::string, int> frame_index_;
+  EigenSTL::vector_Isometry3d compiled_transforms_;
 };
 }
 }
@@ -51,9 +51,40 @@ Transforms::Transforms(const std::string& target_frame) : target_frame_(target_f
   else
   {
     transforms_map_[target_frame_] = Eigen::Isometry3d::Identity();
+    compileFrameTable();
   }
 }
 
+void Transforms::compileFrameTable()
+{
+  frame_index_.clear();
+  compiled_transforms_.clear();
+  compiled_transforms_.reserve(transforms_map_.size());
+  for (FixedTransformsMap::const_iterator it = transforms_map_.begin(); it != transforms_map_.end(); ++it)
+  {
+    frame_index_[it->first] = static_cast<int>(compiled_transforms_.size());
+    compiled_transforms_.push_back(it->second);
+  }
+}
+
+int Transforms::getFrameIndex(const std::string& from_frame) const
+{
+  std::map<std::string, int>::const_iterator it = frame_index_.find(from_frame);
+  return it != frame_index_.end() ? it->second : -1;
+}
+
+const Eigen::Isometry3d& Transforms::getTransform(int frame_index) const
+{
+  if (frame_index >= 0 && frame_index < static_cast<int>(compiled_transforms_.size()))
+    return compiled_transforms_[frame_index];
+
+  ROS_ERROR_NAMED("transforms", "Invalid frame index %d. Returning identity.", frame_index);
+
+  // return identity
+  static const Eigen::Isometry3d IDENTITY = Eigen::Isometry3d::Identity();
+  return IDENTITY;
+}
+
 bool Transforms::sameFrame(const std::string& frame1, const std::string& frame2)
 {
   if (frame1.empty() || frame2.empty())
@@ -76,6 +107,7 @@ const FixedTransformsMap& Transforms::getAllTransforms() const
 void Transforms::setAllTransforms(const FixedTransformsMap& transforms)
 {
   transforms_map_ = transforms;
+  compileFrameTable();
 }
 
 bool Transforms::isFixedFrame(const std::string& frame) const
@@ -117,7 +149,20 @@ void Transforms::setTransform(const Eigen::Isometry3d& t, const std::string& fro
   if (from_frame.empty())
     ROS_ERROR_NAMED("transforms", "Cannot record transform with empty name");
   else
+  {
     transforms_map_[from_frame] = t;
+
+    // keep the compiled table in sync; updating an existing frame keeps
+    // previously handed out indices valid
+    std::map<std::string, int>::const_iterator it = frame_index_.find(from_frame);
+    if (it != frame_index_.end())
+      compiled_transforms_[it->second] = t;
+    else
+    {
+      frame_index_[from_frame] = static_cast<int>(compiled_transforms_.size());
+      compiled_transforms_.push_back(t);
+    }
+  }
 }
 
 void Transforms::setTransform(const geometry_msgs::TransformStamped& transform)
@@ -61,6 +61,49 @@ TEST(Transforms, Simple)
   EXPECT_TRUE(tf.isFixedFrame("global"));
 }
 
+TEST(Transforms, FrameIndex)
+{
+  moveit::core::Transforms tf("global");
+
+  Eigen::Isometry3d t1(Eigen::Translation3d(1.0, 2.0, 3.0));
+  tf.setTransform(t1, "some_frame_1");
+
+  int index = tf.getFrameIndex("some_frame_1");
+  ASSERT_GE(index, 0);
+  EXPECT_EQ(-1, tf.getFrameIndex("unknown_frame"));
+  EXPECT_TRUE(tf.getTransform(index).isApprox(t1));
+
+  // updating the transform of a known frame keeps the index valid
+  Eigen::Isometry3d t2(Eigen::Translation3d(-1.0, 0.0, 0.0) * Eigen::AngleAxisd(0.25, Eigen::Vector3d::UnitZ()));
+  tf.setTransform(t2, "some_frame_1");
+  EXPECT_EQ(index, tf.getFrameIndex("some_frame_1"));
+  EXPECT_TRUE(tf.getTransform(index).isApprox(t2));
+}
+
+TEST(Transforms, TransformPoses)
+{
+  moveit::core::Transforms tf("global");
+
+  Eigen::Isometry3d t(Eigen::Translation3d(10.0, 1.0, 0.0) * Eigen::AngleAxisd(0.5, Eigen::Vector3d::UnitY()));
+  tf.setTransform(t, "some_frame");
+
+  EigenSTL::vector_Isometry3d poses_in(3);
+  poses_in[0] = Eigen::Isometry3d(Eigen::Translation3d(1.0, 0.0, 0.0));
+  poses_in[1] = Eigen::Isometry3d(Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitX()));
+  poses_in[2] = poses_in[0] * poses_in[1];
+
+  EigenSTL::vector_Isometry3d poses_out;
+  tf.transformPoses("some_frame", poses_in, poses_out);
+  ASSERT_EQ(poses_in.size(), poses_out.size());
+  for (std::size_t i = 0; i < poses_in.size(); ++i)
+    EXPECT_TRUE(poses_out[i].isApprox(t * poses_in[i]));
+
+  // in-place transformation
+  tf.transformPoses("some_frame", poses_in, poses_in);
+  for (std::size_t i = 0; i < poses_in.size(); ++i)
+    EXPECT_TRUE(poses_in[i].isApprox(poses_out[i]));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -46,6 +46,7 @@
  *  (i.e. the default if no locale is set on the system).
  */
 
+#include <cstddef>
 #include <string>
 namespace moveit
 {
@@ -57,6 +58,15 @@ std::string toString(double d);
 /** \brief Convert a float to std::string using the classic C locale */
 std::string toString(float f);
 
+/** \brief Format a contiguous array of doubles as space-separated text using the classic C locale.
+ *  Formats every value in one pass without constructing a stream per value; use this for bulk text
+ *  export (e.g. scene geometry files). */
+std::string toString(const double* values, std::size_t count);
+
+/** \brief Parse exactly \e count whitespace-separated doubles from \e s using the classic C locale.
+ *  \return false if \e s does not contain exactly \e count numbers */
+bool toDoubles(const std::string& s, double* values, std::size_t count);
+
 /** \brief Converts a std::string to double using the classic C locale
  \throws std::runtime_exception if not a valid number
 */
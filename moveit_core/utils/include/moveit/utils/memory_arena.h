@@ -0,0 +1,120 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_UTILS_MEMORY_ARENA_
+#define MOVEIT_UTILS_MEMORY_ARENA_
+
+#include <cstddef>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+namespace moveit
+{
+namespace tools
+{
+/** \brief A fixed-block-size memory arena backed by large, prefaulted slabs.
+
+    The arena hands out uniform blocks carved from slabs of at least two
+    megabytes. On Linux the slabs are mapped anonymously, advised towards
+    transparent huge pages and touched page by page on creation, so block
+    accesses neither page-fault nor spread across many TLB entries the way
+    individually malloc'd blocks do. Elsewhere (and when huge pages are
+    disabled) the slabs come from operator new and are still prefaulted.
+
+    Freed blocks go to a free list and are reused before a new slab is
+    mapped; slabs are only returned to the system when the arena is
+    destroyed. The arena performs no construction or destruction of
+    objects and is not thread-safe.
+
+    Huge page backing is controlled with the MOVEIT_HUGEPAGE_ARENAS
+    environment variable; set it to 0 to fall back to plain allocation. */
+class MemoryArena : private boost::noncopyable
+{
+public:
+  /** \brief Create an arena handing out blocks of \e block_size bytes.
+      The size is rounded up so that blocks are suitably aligned for any
+      object type. */
+  explicit MemoryArena(std::size_t block_size);
+
+  ~MemoryArena();
+
+  /** \brief Get one block of getBlockSize() bytes; never returns NULL */
+  void* allocate();
+
+  /** \brief Return a block obtained from allocate() to the arena */
+  void deallocate(void* block);
+
+  /** \brief The (rounded) size of the blocks this arena hands out */
+  std::size_t getBlockSize() const
+  {
+    return block_size_;
+  }
+
+  /** \brief The number of slabs currently mapped */
+  std::size_t getSlabCount() const
+  {
+    return slabs_.size();
+  }
+
+  /** \brief Whether slabs are backed by transparent huge pages; false on
+      non-Linux platforms and when MOVEIT_HUGEPAGE_ARENAS is set to 0 */
+  static bool useHugePages();
+
+private:
+  /** a contiguous chunk of memory blocks are carved from */
+  struct Slab
+  {
+    void* base_;
+    std::size_t size_;
+    bool mapped_; /**< whether base_ came from mmap rather than operator new */
+  };
+
+  /** map a new slab and point the bump allocator at it */
+  void addSlab();
+
+  std::size_t block_size_;
+  std::size_t slab_size_;
+  std::vector<Slab> slabs_;
+
+  /** singly linked list of freed blocks, threaded through their first word */
+  void* free_list_;
+
+  /** unused tail of the newest slab */
+  char* bump_;
+  std::size_t bump_remaining_;
+};
+}  // namespace tools
+}  // namespace moveit
+
+#endif
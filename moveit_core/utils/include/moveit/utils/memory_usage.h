@@ -0,0 +1,107 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_UTILS_MEMORY_USAGE_
+#define MOVEIT_UTILS_MEMORY_USAGE_
+
+#include <cstddef>
+#include <string>
+
+namespace moveit
+{
+namespace tools
+{
+/** \brief Samples the memory use of the current process over a scope, so that a
+    single operation (e.g. one motion planning request) can be attributed a peak
+    resident set size and a heap growth figure.
+
+    At construction the current resident set size and heap use are recorded and
+    the kernel's peak-RSS counter is reset, so peakResidentSetSize() reports the
+    peak reached within this scope rather than since process start. All numbers
+    come from /proc and the allocator's own bookkeeping; taking them costs a few
+    microseconds and nothing is installed or hooked, so the tracker is safe to
+    use on a live system. On platforms without /proc the queries return 0.
+
+    Note that peak-RSS reset is per process, so concurrently active trackers in
+    different threads will each observe the process-wide peak since whichever of
+    them was constructed last. */
+class ScopedMemoryTracker
+{
+public:
+  ScopedMemoryTracker();
+
+  /** \brief Current resident set size of the process, in bytes (0 if unknown) */
+  static std::size_t residentSetSize();
+
+  /** \brief Bytes of heap memory currently handed out by the allocator (0 if unknown).
+      The underlying counter is 32 bits wide, so values wrap beyond 4 GiB. */
+  static std::size_t heapUsed();
+
+  /** \brief Resident set size recorded at construction, in bytes */
+  std::size_t initialResidentSetSize() const
+  {
+    return initial_rss_;
+  }
+
+  /** \brief Peak resident set size since construction, in bytes. If the kernel
+      did not support resetting the peak counter this falls back to the peak
+      since process start (0 if unknown). */
+  std::size_t peakResidentSetSize() const;
+
+  /** \brief Change in heap bytes handed out by the allocator since
+      construction; negative when more was freed than allocated */
+  long heapUsedDelta() const;
+
+private:
+  std::size_t initial_rss_;
+  std::size_t initial_heap_used_;
+  bool peak_reset_ok_;
+};
+
+/** \brief Start tracing individual allocations to \e trace_file using the C
+    library's allocation tracing facility. Every allocation and deallocation is
+    appended to the file with the address of the call site; the mtrace(1) script
+    resolves the addresses to source locations and reports what was never
+    freed. Returns false if tracing is unsupported on this platform or already
+    active. Tracing slows allocation down considerably and serializes the
+    allocator, so it is meant for attributing memory spikes offline, not for
+    production use. */
+bool startAllocationTrace(const std::string& trace_file);
+
+/** \brief Stop allocation tracing previously started with startAllocationTrace() */
+void stopAllocationTrace();
+}  // namespace tools
+}  // namespace moveit
+
+#endif
@@ -0,0 +1,237 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_UTILS_TASK_SCHEDULER_
+#define MOVEIT_UTILS_TASK_SCHEDULER_
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+
+namespace moveit
+{
+namespace tools
+{
+/** \brief A process-wide pool of worker threads shared by the MoveIt!
+    components that run work in parallel, so that concurrent subsystems
+    (background jobs, manipulation pipelines, parallel validation) share
+    one set of threads instead of each spinning up its own and
+    oversubscribing the machine.
+
+    Tasks submitted from a worker thread go to that worker's own deque
+    (newest first, for cache locality); idle workers steal the oldest
+    tasks of their peers. Tasks submitted from outside the pool are
+    queued per priority and handed out oldest-first, higher priorities
+    first. Each task carries a subsystem tag; a per-subsystem quota can
+    cap how many tasks of one subsystem run concurrently, and queue
+    depths per subsystem can be inspected at runtime.
+
+    Tasks must not block waiting for other queued tasks (TaskGroup::wait
+    is safe: it executes pending tasks while it waits). Tasks still
+    queued when the scheduler is destroyed are dropped without being
+    executed. */
+class TaskScheduler : private boost::noncopyable
+{
+public:
+  /** \brief The signature for tasks */
+  typedef boost::function<void()> TaskFn;
+
+  /** \brief Priorities for queued tasks; tasks spawned from worker threads bypass the priority queues */
+  enum TaskPriority
+  {
+    PRIORITY_LOW = 0,
+    PRIORITY_DEFAULT = 1,
+    PRIORITY_HIGH = 2
+  };
+
+  /** \brief Runtime introspection data for one subsystem */
+  struct SubsystemStatus
+  {
+    SubsystemStatus() : queued_(0), running_(0), quota_(0)
+    {
+    }
+
+    /// Tasks of this subsystem waiting to run (including tasks deferred by the quota)
+    std::size_t queued_;
+    /// Tasks of this subsystem currently executing
+    std::size_t running_;
+    /// Maximum number of concurrently executing tasks (0 means no limit)
+    unsigned int quota_;
+  };
+
+  /** \brief Runtime introspection data for the scheduler */
+  struct Status
+  {
+    Status() : stolen_(0), executed_(0)
+    {
+    }
+
+    /// Queued task counts, indexed by TaskPriority (worker deques included under PRIORITY_DEFAULT)
+    std::vector<std::size_t> queued_per_priority_;
+    /// Total number of tasks obtained by work stealing
+    std::size_t stolen_;
+    /// Total number of tasks executed
+    std::size_t executed_;
+    std::map<std::string, SubsystemStatus> subsystems_;
+  };
+
+  /** \brief A set of tasks that can be waited on together. The group
+      must outlive its tasks, which \ref wait guarantees when called
+      before the group goes out of scope. */
+  class TaskGroup : private boost::noncopyable
+  {
+  public:
+    TaskGroup(TaskScheduler& scheduler) : scheduler_(scheduler), pending_(0)
+    {
+    }
+
+    /** \brief Wait for all tasks submitted to this group to complete.
+        When called from a worker thread, pending tasks of the scheduler
+        are executed on the calling thread while waiting, so calling
+        this from within a task does not deadlock the pool. Threads from
+        outside the pool only execute tasks of this group while they
+        wait: the scheduler cannot know what locks an external caller
+        holds, so running unrelated work inline on it could deadlock
+        against the task it executes. */
+    void wait();
+
+  private:
+    friend class TaskScheduler;
+
+    void taskDone();
+
+    TaskScheduler& scheduler_;
+    boost::mutex lock_;
+    boost::condition_variable done_condition_;
+    std::size_t pending_;
+  };
+
+  /** \brief Get the process-wide scheduler, created on first use with one worker per hardware thread */
+  static TaskScheduler& getInstance();
+
+  /** \brief Construct a scheduler with \e thread_count workers; 0 means one worker per hardware thread */
+  TaskScheduler(unsigned int thread_count = 0);
+
+  /** \brief Finishes currently executing tasks and drops the remaining queue (waiting groups are released) */
+  ~TaskScheduler();
+
+  unsigned int getThreadCount() const
+  {
+    return static_cast<unsigned int>(workers_.size());
+  }
+
+  /** \brief Cap the number of concurrently executing tasks of \e subsystem (0 removes the cap) */
+  void setSubsystemQuota(const std::string& subsystem, unsigned int max_running);
+
+  /** \brief Queue a task for execution */
+  void submit(const TaskFn& task, const std::string& subsystem, TaskPriority priority = PRIORITY_DEFAULT);
+
+  /** \brief Queue a task for execution as part of \e group, so it can be waited on */
+  void submit(TaskGroup& group, const TaskFn& task, const std::string& subsystem,
+              TaskPriority priority = PRIORITY_DEFAULT);
+
+  /** \brief Get a snapshot of queue depths and per-subsystem usage */
+  Status getStatus() const;
+
+private:
+  struct Task
+  {
+    TaskFn fn_;
+    std::string subsystem_;
+    int priority_;
+    TaskGroup* group_;
+  };
+
+  /** \brief A worker's own deque of tasks, stolen from by idle peers */
+  struct Worker
+  {
+    mutable boost::mutex lock_;
+    std::deque<Task> deque_;
+  };
+
+  struct Subsystem
+  {
+    Subsystem() : running_(0), quota_(0)
+    {
+    }
+
+    std::size_t running_;
+    unsigned int quota_;
+    /// Tasks admitted from the queues while the subsystem was at quota wait here
+    std::deque<Task> deferred_;
+  };
+
+  void enqueue(TaskGroup* group, const TaskFn& task, const std::string& subsystem, TaskPriority priority);
+
+  /** \brief Pop the next task; \e worker_index is the index of the calling worker, or -1 for helper threads.
+      When \e only_group is given, only tasks of that group are considered */
+  bool takeTask(int worker_index, Task& task, const TaskGroup* only_group = NULL);
+
+  /** \brief Check the quota of the task's subsystem; defers the task and returns false if the quota is reached */
+  bool admitTask(const Task& task);
+
+  /** \brief Release the quota slot of a completed task and re-queue a deferred task of its subsystem, if any */
+  void completeTask(const Task& task);
+
+  void runTask(const Task& task);
+
+  /** \brief Pop and execute a single pending task on the calling thread; returns false if none was runnable.
+      Worker threads run any pending task; threads from outside the pool are restricted to tasks of \e group */
+  bool helpOne(const TaskGroup* group);
+
+  void workerThread(unsigned int index);
+
+  std::vector<std::unique_ptr<Worker> > workers_;
+  std::vector<std::unique_ptr<boost::thread> > threads_;
+
+  mutable boost::mutex global_lock_;
+  boost::condition_variable work_condition_;
+  bool run_workers_;
+  /// One FIFO queue per priority level for tasks submitted from outside the pool
+  std::vector<std::deque<Task> > global_queues_;
+  std::map<std::string, Subsystem> subsystems_;
+
+  std::atomic<std::size_t> stolen_;
+  std::atomic<std::size_t> executed_;
+};
+}
+}
+
+#endif
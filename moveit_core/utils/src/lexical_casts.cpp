@@ -36,56 +36,111 @@
 
 #include "moveit/utils/lexical_casts.h"
 
-#include <locale>
-#include <sstream>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <locale.h>
+#include <stdexcept>
 
 namespace moveit
 {
 namespace core
 {
-template <class InType>
-std::string toStringImpl(InType t)
+namespace
 {
-  // convert to string using no locale
-  std::ostringstream oss;
-  oss.imbue(std::locale::classic());
-  oss << t;
-  return oss.str();
+// The C library conversions below are much faster than stringstreams, but honor the current
+// locale; running them under a cached classic "C" locale keeps the output locale-agnostic.
+// uselocale() only swaps a thread-local pointer, so this costs nothing per call.
+locale_t classicCLocale()
+{
+  static locale_t loc = newlocale(LC_ALL_MASK, "C", nullptr);
+  return loc;
+}
+
+// Format with "%g", which produces the same text as the default-formatted ostream the previous
+// implementation used (6 significant digits, scientific notation for large/small magnitudes)
+int formatReal(char* buf, std::size_t size, double value)
+{
+  locale_t old_locale = uselocale(classicCLocale());
+  int len = std::snprintf(buf, size, "%g", value);
+  uselocale(old_locale);
+  return len;
+}
+
+template <class OutType, class StrToFn>
+OutType parseReal(const std::string& s, StrToFn strto)
+{
+  locale_t old_locale = uselocale(classicCLocale());
+  const char* begin = s.c_str();
+  char* end = nullptr;
+  OutType result = strto(begin, &end);
+  uselocale(old_locale);
+  // match the strictness of the stream-based implementation this replaces: leading whitespace is
+  // fine, but the number must extend to the end of the string
+  if (end == begin || *end != '\0')
+    throw std::runtime_error("Failed converting string to real number");
+  return result;
+}
 }
 
 std::string toString(double d)
 {
-  return toStringImpl(d);
+  char buf[32];
+  return std::string(buf, formatReal(buf, sizeof(buf), d));
 }
 
 std::string toString(float f)
 {
-  return toStringImpl(f);
+  char buf[32];
+  return std::string(buf, formatReal(buf, sizeof(buf), f));
 }
 
-template <class OutType>
-OutType toRealImpl(const std::string& s)
+std::string toString(const double* values, std::size_t count)
 {
-  // convert from string using no locale
-  std::istringstream stream(s);
-  stream.imbue(std::locale::classic());
-  OutType result;
-  stream >> result;
-  if (stream.fail() || !stream.eof())
+  std::string result;
+  result.reserve(16 * count);
+  char buf[32];
+  for (std::size_t i = 0; i < count; ++i)
   {
-    throw std::runtime_error("Failed converting string to real number");
+    if (i > 0)
+      result += ' ';
+    result.append(buf, formatReal(buf, sizeof(buf), values[i]));
   }
   return result;
 }
 
+bool toDoubles(const std::string& s, double* values, std::size_t count)
+{
+  locale_t old_locale = uselocale(classicCLocale());
+  const char* cursor = s.c_str();
+  bool ok = true;
+  for (std::size_t i = 0; i < count && ok; ++i)
+  {
+    char* end = nullptr;
+    values[i] = std::strtod(cursor, &end);
+    if (end == cursor)
+      ok = false;
+    else
+      cursor = end;
+  }
+  while (ok && *cursor != '\0')
+  {
+    if (!std::isspace(static_cast<unsigned char>(*cursor)))
+      ok = false;
+    ++cursor;
+  }
+  uselocale(old_locale);
+  return ok;
+}
+
 double toDouble(const std::string& s)
 {
-  return toRealImpl<double>(s);
+  return parseReal<double>(s, std::strtod);
 }
 
 float toFloat(const std::string& s)
 {
-  return toRealImpl<float>(s);
+  return parseReal<float>(s, std::strtof);
 }
 }
 }
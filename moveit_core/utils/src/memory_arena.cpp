@@ -0,0 +1,143 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/utils/memory_arena.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// slabs of at least this size; also the transparent huge page size on x86-64
+const std::size_t MIN_SLAB_SIZE = 2 * 1024 * 1024;
+}
+
+bool moveit::tools::MemoryArena::useHugePages()
+{
+#ifdef __linux__
+  static const bool enabled = []() {
+    const char* env = std::getenv("MOVEIT_HUGEPAGE_ARENAS");
+    return !(env && env[0] == '0' && env[1] == '\0');
+  }();
+  return enabled;
+#else
+  return false;
+#endif
+}
+
+moveit::tools::MemoryArena::MemoryArena(std::size_t block_size)
+  : free_list_(NULL), bump_(NULL), bump_remaining_(0)
+{
+  // blocks double as free list nodes and must align any object type
+  const std::size_t alignment = alignof(std::max_align_t);
+  if (block_size < sizeof(void*))
+    block_size = sizeof(void*);
+  block_size_ = (block_size + alignment - 1) / alignment * alignment;
+
+  slab_size_ = (block_size_ + MIN_SLAB_SIZE - 1) / MIN_SLAB_SIZE * MIN_SLAB_SIZE;
+}
+
+moveit::tools::MemoryArena::~MemoryArena()
+{
+  for (std::size_t i = 0; i < slabs_.size(); ++i)
+  {
+#ifdef __linux__
+    if (slabs_[i].mapped_)
+    {
+      munmap(slabs_[i].base_, slabs_[i].size_);
+      continue;
+    }
+#endif
+    ::operator delete(slabs_[i].base_);
+  }
+}
+
+void moveit::tools::MemoryArena::addSlab()
+{
+  Slab slab;
+  slab.size_ = slab_size_;
+  slab.base_ = NULL;
+  slab.mapped_ = false;
+#ifdef __linux__
+  if (useHugePages())
+  {
+    void* mem = mmap(NULL, slab.size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem != MAP_FAILED)
+    {
+      // ask for huge page backing before the first touch so the kernel can
+      // satisfy the faults below with huge pages directly
+      madvise(mem, slab.size_, MADV_HUGEPAGE);
+      slab.base_ = mem;
+      slab.mapped_ = true;
+    }
+  }
+#endif
+  if (!slab.base_)
+    slab.base_ = ::operator new(slab_size_);
+
+  // prefault the whole slab up front; this moves the page faults (and huge
+  // page assembly) out of the first pass over the data
+  std::memset(slab.base_, 0, slab.size_);
+
+  slabs_.push_back(slab);
+  bump_ = static_cast<char*>(slab.base_);
+  bump_remaining_ = slab.size_;
+}
+
+void* moveit::tools::MemoryArena::allocate()
+{
+  if (free_list_)
+  {
+    void* block = free_list_;
+    free_list_ = *static_cast<void**>(block);
+    return block;
+  }
+  if (bump_remaining_ < block_size_)
+    addSlab();
+  void* block = bump_;
+  bump_ += block_size_;
+  bump_remaining_ -= block_size_;
+  return block;
+}
+
+void moveit::tools::MemoryArena::deallocate(void* block)
+{
+  *static_cast<void**>(block) = free_list_;
+  free_list_ = block;
+}
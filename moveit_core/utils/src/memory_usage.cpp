@@ -0,0 +1,171 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/utils/memory_usage.h>
+
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <cstdlib>
+#include <malloc.h>
+#include <mcheck.h>
+#endif
+
+namespace
+{
+#if defined(__linux__)
+// Return the value of a "<key>:  <number> kB" line from /proc/self/status, in
+// bytes, or 0 if the key was not found
+std::size_t readStatusValue(const char* key)
+{
+  std::size_t result = 0;
+  FILE* f = fopen("/proc/self/status", "r");
+  if (!f)
+    return 0;
+  const std::size_t key_len = strlen(key);
+  char line[256];
+  while (fgets(line, sizeof(line), f))
+    if (strncmp(line, key, key_len) == 0)
+    {
+      unsigned long kb = 0;
+      if (sscanf(line + key_len, " %lu", &kb) == 1)
+        result = static_cast<std::size_t>(kb) * 1024;
+      break;
+    }
+  fclose(f);
+  return result;
+}
+
+// Ask the kernel to reset the process peak-RSS counter (VmHWM) to the current
+// RSS. Supported since Linux 4.0; returns false on older kernels.
+bool resetPeakResidentSetSize()
+{
+  int fd = open("/proc/self/clear_refs", O_WRONLY);
+  if (fd < 0)
+    return false;
+  bool ok = write(fd, "5", 1) == 1;
+  close(fd);
+  return ok;
+}
+#endif
+
+bool allocation_trace_active = false;
+}
+
+namespace moveit
+{
+namespace tools
+{
+ScopedMemoryTracker::ScopedMemoryTracker()
+  : initial_rss_(residentSetSize()), initial_heap_used_(heapUsed()), peak_reset_ok_(false)
+{
+#if defined(__linux__)
+  peak_reset_ok_ = resetPeakResidentSetSize();
+#endif
+}
+
+std::size_t ScopedMemoryTracker::residentSetSize()
+{
+#if defined(__linux__)
+  return readStatusValue("VmRSS:");
+#else
+  return 0;
+#endif
+}
+
+std::size_t ScopedMemoryTracker::heapUsed()
+{
+#if defined(__GLIBC__)
+  struct mallinfo mi = mallinfo();
+  // uordblks is a signed int; clamp rather than report a huge bogus value
+  return mi.uordblks > 0 ? static_cast<std::size_t>(mi.uordblks) : 0;
+#else
+  return 0;
+#endif
+}
+
+std::size_t ScopedMemoryTracker::peakResidentSetSize() const
+{
+#if defined(__linux__)
+  std::size_t peak = readStatusValue("VmHWM:");
+  // if the counter could not be reset, the pre-scope peak is all we have; the
+  // initial RSS is a lower bound on what this scope saw in that case as well
+  if (!peak_reset_ok_ && peak < initial_rss_)
+    peak = initial_rss_;
+  return peak;
+#else
+  return 0;
+#endif
+}
+
+long ScopedMemoryTracker::heapUsedDelta() const
+{
+  return static_cast<long>(heapUsed()) - static_cast<long>(initial_heap_used_);
+}
+
+bool startAllocationTrace(const std::string& trace_file)
+{
+#if defined(__GLIBC__)
+  if (allocation_trace_active || trace_file.empty())
+    return false;
+  // mtrace() reads the output file name from the environment when tracing starts
+  if (setenv("MALLOC_TRACE", trace_file.c_str(), 1) != 0)
+    return false;
+  mtrace();
+  allocation_trace_active = true;
+  return true;
+#else
+  (void)trace_file;
+  return false;
+#endif
+}
+
+void stopAllocationTrace()
+{
+#if defined(__GLIBC__)
+  if (allocation_trace_active)
+  {
+    muntrace();
+    allocation_trace_active = false;
+  }
+#endif
+}
+}  // namespace tools
+}  // namespace moveit
@@ -0,0 +1,359 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/utils/task_scheduler.h>
+#include <ros/console.h>
+
+namespace moveit
+{
+namespace tools
+{
+static const std::string LOGNAME = "task_scheduler";
+
+// identifies the scheduler (and worker index) owning the current thread, so
+// tasks spawned from within a task land on the worker's own deque
+static thread_local TaskScheduler* tls_scheduler = NULL;
+static thread_local int tls_worker_index = -1;
+
+TaskScheduler& TaskScheduler::getInstance()
+{
+  static TaskScheduler instance;
+  return instance;
+}
+
+TaskScheduler::TaskScheduler(unsigned int thread_count) : run_workers_(true), stolen_(0), executed_(0)
+{
+  if (thread_count == 0)
+  {
+    thread_count = boost::thread::hardware_concurrency();
+    if (thread_count == 0)
+      thread_count = 4;
+  }
+  global_queues_.resize(PRIORITY_HIGH + 1);
+  workers_.resize(thread_count);
+  for (unsigned int i = 0; i < thread_count; ++i)
+    workers_[i].reset(new Worker());
+  for (unsigned int i = 0; i < thread_count; ++i)
+    threads_.emplace_back(new boost::thread(boost::bind(&TaskScheduler::workerThread, this, i)));
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  {
+    boost::mutex::scoped_lock _(global_lock_);
+    run_workers_ = false;
+  }
+  work_condition_.notify_all();
+  for (std::size_t i = 0; i < threads_.size(); ++i)
+    threads_[i]->join();
+
+  // drop whatever is still queued, releasing any groups waiting on it
+  std::vector<Task> dropped;
+  {
+    boost::mutex::scoped_lock _(global_lock_);
+    for (std::size_t p = 0; p < global_queues_.size(); ++p)
+    {
+      dropped.insert(dropped.end(), global_queues_[p].begin(), global_queues_[p].end());
+      global_queues_[p].clear();
+    }
+    for (std::map<std::string, Subsystem>::iterator it = subsystems_.begin(); it != subsystems_.end(); ++it)
+    {
+      dropped.insert(dropped.end(), it->second.deferred_.begin(), it->second.deferred_.end());
+      it->second.deferred_.clear();
+    }
+  }
+  for (std::size_t i = 0; i < workers_.size(); ++i)
+  {
+    boost::mutex::scoped_lock _(workers_[i]->lock_);
+    dropped.insert(dropped.end(), workers_[i]->deque_.begin(), workers_[i]->deque_.end());
+    workers_[i]->deque_.clear();
+  }
+  for (std::size_t i = 0; i < dropped.size(); ++i)
+    if (dropped[i].group_)
+      dropped[i].group_->taskDone();
+}
+
+void TaskScheduler::setSubsystemQuota(const std::string& subsystem, unsigned int max_running)
+{
+  boost::mutex::scoped_lock _(global_lock_);
+  Subsystem& s = subsystems_[subsystem];
+  s.quota_ = max_running;
+  // re-queue deferred tasks; they get deferred again if the new quota is still reached
+  while (!s.deferred_.empty())
+  {
+    global_queues_[s.deferred_.front().priority_].push_back(s.deferred_.front());
+    s.deferred_.pop_front();
+  }
+  work_condition_.notify_all();
+}
+
+void TaskScheduler::submit(const TaskFn& task, const std::string& subsystem, TaskPriority priority)
+{
+  enqueue(NULL, task, subsystem, priority);
+}
+
+void TaskScheduler::submit(TaskGroup& group, const TaskFn& task, const std::string& subsystem, TaskPriority priority)
+{
+  {
+    boost::mutex::scoped_lock _(group.lock_);
+    group.pending_++;
+  }
+  enqueue(&group, task, subsystem, priority);
+}
+
+void TaskScheduler::enqueue(TaskGroup* group, const TaskFn& fn, const std::string& subsystem, TaskPriority priority)
+{
+  Task task;
+  task.fn_ = fn;
+  task.subsystem_ = subsystem;
+  task.priority_ = priority;
+  task.group_ = group;
+
+  if (tls_scheduler == this && tls_worker_index >= 0)
+  {
+    Worker& self = *workers_[tls_worker_index];
+    boost::mutex::scoped_lock _(self.lock_);
+    self.deque_.push_back(task);
+  }
+  else
+  {
+    boost::mutex::scoped_lock _(global_lock_);
+    global_queues_[priority].push_back(task);
+  }
+  work_condition_.notify_one();
+}
+
+bool TaskScheduler::takeTask(int worker_index, Task& task, const TaskGroup* only_group)
+{
+  // newest task of the worker's own deque first (cache-hot)
+  if (worker_index >= 0)
+  {
+    Worker& self = *workers_[worker_index];
+    boost::mutex::scoped_lock _(self.lock_);
+    if (!self.deque_.empty())
+    {
+      task = self.deque_.back();
+      self.deque_.pop_back();
+      return true;
+    }
+  }
+
+  // then the external queues, higher priorities first
+  {
+    boost::mutex::scoped_lock _(global_lock_);
+    for (int p = static_cast<int>(global_queues_.size()) - 1; p >= 0; --p)
+    {
+      std::deque<Task>& queue = global_queues_[p];
+      for (std::deque<Task>::iterator it = queue.begin(); it != queue.end(); ++it)
+        if (!only_group || it->group_ == only_group)
+        {
+          task = *it;
+          queue.erase(it);
+          return true;
+        }
+    }
+  }
+
+  // then steal the oldest task of a peer
+  const std::size_t worker_count = workers_.size();
+  const std::size_t start = worker_index >= 0 ? static_cast<std::size_t>(worker_index) + 1 : 0;
+  for (std::size_t k = 0; k < worker_count; ++k)
+  {
+    const std::size_t j = (start + k) % worker_count;
+    if (static_cast<int>(j) == worker_index)
+      continue;
+    Worker& victim = *workers_[j];
+    boost::mutex::scoped_lock _(victim.lock_);
+    for (std::deque<Task>::iterator it = victim.deque_.begin(); it != victim.deque_.end(); ++it)
+      if (!only_group || it->group_ == only_group)
+      {
+        task = *it;
+        victim.deque_.erase(it);
+        stolen_++;
+        return true;
+      }
+  }
+  return false;
+}
+
+bool TaskScheduler::admitTask(const Task& task)
+{
+  boost::mutex::scoped_lock _(global_lock_);
+  Subsystem& s = subsystems_[task.subsystem_];
+  if (s.quota_ && s.running_ >= s.quota_)
+  {
+    s.deferred_.push_back(task);
+    return false;
+  }
+  s.running_++;
+  return true;
+}
+
+void TaskScheduler::completeTask(const Task& task)
+{
+  boost::mutex::scoped_lock _(global_lock_);
+  Subsystem& s = subsystems_[task.subsystem_];
+  s.running_--;
+  if (!s.deferred_.empty() && (s.quota_ == 0 || s.running_ < s.quota_))
+  {
+    global_queues_[s.deferred_.front().priority_].push_back(s.deferred_.front());
+    s.deferred_.pop_front();
+    work_condition_.notify_one();
+  }
+}
+
+void TaskScheduler::runTask(const Task& task)
+{
+  try
+  {
+    task.fn_();
+  }
+  catch (std::exception& ex)
+  {
+    ROS_ERROR_NAMED(LOGNAME, "Exception caught while executing task of subsystem '%s': %s", task.subsystem_.c_str(),
+                    ex.what());
+  }
+  executed_++;
+}
+
+bool TaskScheduler::helpOne(const TaskGroup* group)
+{
+  // threads from outside the pool may hold arbitrary locks, so they must not execute
+  // unrelated tasks inline; restrict them to the group they are waiting on
+  const bool pool_thread = tls_scheduler == this && tls_worker_index >= 0;
+  Task task;
+  if (!takeTask(pool_thread ? tls_worker_index : -1, task, pool_thread ? NULL : group))
+    return false;
+  if (!admitTask(task))
+    return true;  // the task was deferred by its quota; progress was still made
+  runTask(task);
+  completeTask(task);
+  if (task.group_)
+    task.group_->taskDone();
+  return true;
+}
+
+void TaskScheduler::workerThread(unsigned int index)
+{
+  tls_scheduler = this;
+  tls_worker_index = static_cast<int>(index);
+
+  while (true)
+  {
+    Task task;
+    if (takeTask(static_cast<int>(index), task))
+    {
+      if (!admitTask(task))
+        continue;
+      runTask(task);
+      completeTask(task);
+      if (task.group_)
+        task.group_->taskDone();
+      continue;
+    }
+    boost::unique_lock<boost::mutex> ulock(global_lock_);
+    if (!run_workers_)
+      break;
+    // the idle scan races submissions to the worker deques, so never sleep without a timeout
+    work_condition_.timed_wait(ulock, boost::posix_time::milliseconds(100));
+    if (!run_workers_)
+      break;
+  }
+
+  tls_scheduler = NULL;
+  tls_worker_index = -1;
+}
+
+TaskScheduler::Status TaskScheduler::getStatus() const
+{
+  Status status;
+  status.stolen_ = stolen_;
+  status.executed_ = executed_;
+  {
+    boost::mutex::scoped_lock _(global_lock_);
+    status.queued_per_priority_.resize(global_queues_.size(), 0);
+    for (std::size_t p = 0; p < global_queues_.size(); ++p)
+    {
+      status.queued_per_priority_[p] = global_queues_[p].size();
+      for (std::size_t i = 0; i < global_queues_[p].size(); ++i)
+        status.subsystems_[global_queues_[p][i].subsystem_].queued_++;
+    }
+    for (std::map<std::string, Subsystem>::const_iterator it = subsystems_.begin(); it != subsystems_.end(); ++it)
+    {
+      SubsystemStatus& s = status.subsystems_[it->first];
+      s.running_ = it->second.running_;
+      s.quota_ = it->second.quota_;
+      s.queued_ += it->second.deferred_.size();
+    }
+  }
+  for (std::size_t i = 0; i < workers_.size(); ++i)
+  {
+    boost::mutex::scoped_lock _(workers_[i]->lock_);
+    status.queued_per_priority_[PRIORITY_DEFAULT] += workers_[i]->deque_.size();
+    for (std::size_t j = 0; j < workers_[i]->deque_.size(); ++j)
+      status.subsystems_[workers_[i]->deque_[j].subsystem_].queued_++;
+  }
+  return status;
+}
+
+void TaskScheduler::TaskGroup::wait()
+{
+  while (true)
+  {
+    {
+      boost::mutex::scoped_lock _(lock_);
+      if (pending_ == 0)
+        return;
+    }
+    if (!scheduler_.helpOne(this))
+    {
+      boost::unique_lock<boost::mutex> ulock(lock_);
+      if (pending_ == 0)
+        return;
+      done_condition_.timed_wait(ulock, boost::posix_time::milliseconds(10));
+    }
+  }
+}
+
+void TaskScheduler::TaskGroup::taskDone()
+{
+  boost::mutex::scoped_lock _(lock_);
+  if (pending_ > 0)
+    pending_--;
+  if (pending_ == 0)
+    done_condition_.notify_all();
+}
+
+}  // end of namespace tools
+}  // end of namespace moveit
@@ -0,0 +1,222 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2026, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+*********************************************************************/
+
+#ifndef KINEMATICS_CACHE_CACHED_KINEMATICS_PLUGIN_H_
+#define KINEMATICS_CACHE_CACHED_KINEMATICS_PLUGIN_H_
+
+#include <moveit/kinematics_cache/kinematics_cache.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace kinematics_cache
+{
+/** @class
+ *  @brief Caching decorator for any kinematics::KinematicsBase-derived solver. IK queries are first seeded with
+ * configurations retrieved from a workspace-indexed KinematicsCache, sorted by joint-space distance to the caller's
+ * seed state; the wrapped solver with the original seed is the fallback. The cache file is mapped into memory with
+ * mmap, so all processes wrapping the same file share a single in-memory copy of the cache.
+ *
+ * The following parameters are read from the solver's parameter namespace:
+ * - kinematics_cache_file: the cache file to map; if it does not exist, a cache map is generated and the file is
+ *   created (an empty value disables caching)
+ * - kinematics_cache_timeout: time (in seconds) spent generating the cache map when the file does not exist
+ * - kinematics_cache_origin_{x,y,z}, kinematics_cache_workspace_size, kinematics_cache_resolution,
+ *   kinematics_cache_max_solutions: the workspace grid parameters (see KinematicsCache::Options)
+ */
+template <class KinematicsPlugin>
+class CachedKinematicsPlugin : public KinematicsPlugin
+{
+public:
+  using IKCallbackFn = kinematics::KinematicsBase::IKCallbackFn;
+  using KinematicsQueryOptions = kinematics::KinematicsQueryOptions;
+
+  bool initialize(const moveit::core::RobotModel& robot_model, const std::string& group_name,
+                  const std::string& base_frame, const std::vector<std::string>& tip_frames,
+                  double search_discretization) override
+  {
+    if (!KinematicsPlugin::initialize(robot_model, group_name, base_frame, tip_frames, search_discretization))
+      return false;
+
+    std::string cache_file;
+    double generation_timeout, workspace_size, resolution;
+    int max_solutions;
+    KinematicsCache::Options opts;
+    this->lookupParam("kinematics_cache_file", cache_file, std::string());
+    this->lookupParam("kinematics_cache_timeout", generation_timeout, 30.);
+    this->lookupParam("kinematics_cache_origin_x", opts.origin.x, 0.);
+    this->lookupParam("kinematics_cache_origin_y", opts.origin.y, 0.);
+    this->lookupParam("kinematics_cache_origin_z", opts.origin.z, 0.);
+    this->lookupParam("kinematics_cache_workspace_size", workspace_size, 2.);
+    this->lookupParam("kinematics_cache_resolution", resolution, 0.1);
+    this->lookupParam("kinematics_cache_max_solutions", max_solutions, 4);
+    opts.workspace_size[0] = opts.workspace_size[1] = opts.workspace_size[2] = workspace_size;
+    opts.resolution[0] = opts.resolution[1] = opts.resolution[2] = resolution;
+    opts.max_solutions_per_grid_location = std::max(1, max_solutions);
+
+    if (cache_file.empty())
+    {
+      ROS_DEBUG_NAMED("kinematics_cache", "No kinematics_cache_file specified, caching is disabled");
+      return true;
+    }
+    cache_.reset(new KinematicsCache());
+    // the cache only needs the decorated solver for forward kinematics and group information, so a
+    // non-owning pointer is sufficient (the cache cannot outlive this plugin)
+    kinematics::KinematicsBaseConstPtr solver(this, [](const kinematics::KinematicsBase*) {});
+    if (!cache_->initialize(solver, this->robot_model_, opts))
+    {
+      cache_.reset();
+      return false;
+    }
+    if (!cache_->mapFromFile(cache_file))
+    {
+      ROS_INFO_NAMED("kinematics_cache", "Generating kinematics cache map for group %s (%g seconds)",
+                     group_name.c_str(), generation_timeout);
+      if (!cache_->generateCacheMap(generation_timeout) || !cache_->createMappedFile(cache_file))
+      {
+        ROS_WARN_NAMED("kinematics_cache", "Could not create kinematics cache file %s, caching is disabled",
+                       cache_file.c_str());
+        cache_.reset();
+      }
+    }
+    return true;
+  }
+
+  bool getPositionIK(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state,
+                     std::vector<double>& solution, moveit_msgs::MoveItErrorCodes& error_code,
+                     const KinematicsQueryOptions& options = KinematicsQueryOptions()) const override
+  {
+    std::vector<std::vector<double> > seeds;
+    if (getCachedSeeds(ik_pose, ik_seed_state, seeds))
+      for (std::size_t i = 0; i < seeds.size(); ++i)
+        if (KinematicsPlugin::getPositionIK(ik_pose, seeds[i], solution, error_code, options))
+          return true;
+    if (!KinematicsPlugin::getPositionIK(ik_pose, ik_seed_state, solution, error_code, options))
+      return false;
+    updateCache(ik_pose, solution);
+    return true;
+  }
+
+  bool searchPositionIK(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+                        std::vector<double>& solution, moveit_msgs::MoveItErrorCodes& error_code,
+                        const KinematicsQueryOptions& options = KinematicsQueryOptions()) const override
+  {
+    std::vector<std::vector<double> > seeds;
+    if (getCachedSeeds(ik_pose, ik_seed_state, seeds))
+      for (std::size_t i = 0; i < seeds.size(); ++i)
+        if (KinematicsPlugin::getPositionIK(ik_pose, seeds[i], solution, error_code, options))
+          return true;
+    if (!KinematicsPlugin::searchPositionIK(ik_pose, ik_seed_state, timeout, solution, error_code, options))
+      return false;
+    updateCache(ik_pose, solution);
+    return true;
+  }
+
+  bool searchPositionIK(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+                        const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                        moveit_msgs::MoveItErrorCodes& error_code,
+                        const KinematicsQueryOptions& options = KinematicsQueryOptions()) const override
+  {
+    // cached seeds could violate the consistency limits around the caller's seed, so only the
+    // closest one is tried before falling back to a regular search
+    std::vector<std::vector<double> > seeds;
+    if (getCachedSeeds(ik_pose, ik_seed_state, seeds) && !seeds.empty() &&
+        KinematicsPlugin::searchPositionIK(ik_pose, seeds[0], timeout, consistency_limits, solution, error_code,
+                                           options))
+      return true;
+    if (!KinematicsPlugin::searchPositionIK(ik_pose, ik_seed_state, timeout, consistency_limits, solution, error_code,
+                                            options))
+      return false;
+    updateCache(ik_pose, solution);
+    return true;
+  }
+
+  bool searchPositionIK(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+                        std::vector<double>& solution, const IKCallbackFn& solution_callback,
+                        moveit_msgs::MoveItErrorCodes& error_code,
+                        const KinematicsQueryOptions& options = KinematicsQueryOptions()) const override
+  {
+    std::vector<std::vector<double> > seeds;
+    if (getCachedSeeds(ik_pose, ik_seed_state, seeds) && !seeds.empty() &&
+        KinematicsPlugin::searchPositionIK(ik_pose, seeds[0], timeout, solution, solution_callback, error_code,
+                                           options))
+      return true;
+    if (!KinematicsPlugin::searchPositionIK(ik_pose, ik_seed_state, timeout, solution, solution_callback, error_code,
+                                            options))
+      return false;
+    updateCache(ik_pose, solution);
+    return true;
+  }
+
+  bool searchPositionIK(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state, double timeout,
+                        const std::vector<double>& consistency_limits, std::vector<double>& solution,
+                        const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
+                        const KinematicsQueryOptions& options = KinematicsQueryOptions()) const override
+  {
+    std::vector<std::vector<double> > seeds;
+    if (getCachedSeeds(ik_pose, ik_seed_state, seeds) && !seeds.empty() &&
+        KinematicsPlugin::searchPositionIK(ik_pose, seeds[0], timeout, consistency_limits, solution, solution_callback,
+                                           error_code, options))
+      return true;
+    if (!KinematicsPlugin::searchPositionIK(ik_pose, ik_seed_state, timeout, consistency_limits, solution,
+                                            solution_callback, error_code, options))
+      return false;
+    updateCache(ik_pose, solution);
+    return true;
+  }
+
+private:
+  /** @brief Retrieve the cached seed configurations for a pose, sorted by distance to the seed state */
+  bool getCachedSeeds(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state,
+                      std::vector<std::vector<double> >& seeds) const
+  {
+    return cache_ && cache_->getSolutions(ik_pose, ik_seed_state, seeds);
+  }
+
+  /** @brief Add a solution found by the wrapped solver to the cache */
+  void updateCache(const geometry_msgs::Pose& ik_pose, const std::vector<double>& solution) const
+  {
+    if (cache_)
+      cache_->addToCache(ik_pose, solution);
+  }
+
+  // the IK methods are declared const in the base class, but successful solutions are added to the cache
+  mutable KinematicsCachePtr cache_;
+};
+}
+
+#endif
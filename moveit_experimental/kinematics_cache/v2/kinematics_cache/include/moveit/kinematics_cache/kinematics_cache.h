@@ -63,6 +63,8 @@ public:
    */
   KinematicsCache();
 
+  ~KinematicsCache();
+
   /** @brief Generate the cache map spending timeout (seconds) on the generation process)
    *  @param timeout Time (in seconds) to be spent on generating the cache
    *  @return True if cache map generation was successful
@@ -89,6 +91,16 @@ public:
    */
   bool getSolutions(const geometry_msgs::Pose& pose, std::vector<std::vector<double> >& solutions) const;
 
+  /** @brief Get all candidate solutions for a particular pose, sorted by increasing joint-space distance to a seed
+   * state. Unlike the unsorted overload, the solutions vector is resized by this function.
+   *  @param pose The desired pose
+   *  @param seed_state The reference configuration the solutions are sorted against
+   *  @param solutions The candidate solutions, closest first
+   *  @return False if desired pose lies outside the grid or seed_state has the wrong dimension
+   */
+  bool getSolutions(const geometry_msgs::Pose& pose, const std::vector<double>& seed_state,
+                    std::vector<std::vector<double> >& solutions) const;
+
   /** @brief Get number of candidate solutions for a particular pose.
    *  @param pose The desired pose
    *  @param solution_index The solution index
@@ -103,8 +115,8 @@ public:
    *  @param opt Parameters needed for defining the cache workspace
    *  @return False if any error occured during initialization
    */
-  bool initialize(kinematics::KinematicsBaseConstPtr& solver, const robot_model::RobotModelConstPtr& kinematic_model,
-                  const KinematicsCache::Options& opt);
+  bool initialize(const kinematics::KinematicsBaseConstPtr& solver,
+                  const robot_model::RobotModelConstPtr& kinematic_model, const KinematicsCache::Options& opt);
 
   /** @brief Return the instance of the kinematics solver */
   const kinematics::KinematicsBaseConstPtr& getSolverInstance() const
@@ -133,10 +145,30 @@ public:
    **/
   bool addToCache(const geometry_msgs::Pose& pose, const std::vector<double>& joint_values, bool overwrite = false);
 
+  /** @brief Write the cache to a text file (legacy format) */
   bool writeToFile(const std::string& filename);
 
+  /** @brief Read the cache from a text file (legacy format) */
   bool readFromFile(const std::string& filename);
 
+  /** @brief Map an existing binary cache file into memory with mmap. The file pages are shared, so all processes
+   * mapping the same file reference a single in-memory copy of the cache; solutions added with addToCache are written
+   * through to the file and become visible to other processes.
+   *  @param filename The cache file, created earlier with createMappedFile
+   *  @return False if the file cannot be mapped or was written for a different group or grid
+   */
+  bool mapFromFile(const std::string& filename);
+
+  /** @brief Write the current cache contents to a binary file and map it with mmap, replacing the in-memory storage.
+   * Subsequent calls to addToCache update the file in place.
+   *  @param filename The cache file to create (an existing file is overwritten)
+   *  @return False if the file cannot be created or mapped
+   */
+  bool createMappedFile(const std::string& filename);
+
+  /** @brief Drop the file mapping, if any. The cache is empty afterwards until setup or another load */
+  void unmap();
+
   std::pair<double, double> getMinMaxSquaredDistance();
 
 private:
@@ -149,8 +181,9 @@ private:
   /** @brief Get the grid index for a given pose */
   bool getGridIndex(const geometry_msgs::Pose& pose, unsigned int& grid_index) const;
 
-  /** @brief Setup the cache */
-  void setup(const KinematicsCache::Options& opt);
+  /** @brief Setup the cache; with allocate set to false only the grid dimensions are computed and no storage is
+   * allocated (used when the storage comes from a file mapping) */
+  void setup(const KinematicsCache::Options& opt, bool allocate = true);
 
   void updateDistances(const geometry_msgs::Pose& pose);
 
@@ -164,16 +197,20 @@ private:
   unsigned int kinematics_cache_points_with_solution_; /** Number of grid points that have solutions */
   unsigned int kinematics_cache_size_;                 /** Total number of grid points */
 
-  std::vector<double> kinematics_cache_vector_;    /** Storage for the solutions */
-  std::vector<unsigned int> num_solutions_vector_; /** Storage for number of solutions for each grid location */
+  std::vector<double> kinematics_cache_vector_;    /** In-memory storage for the solutions */
+  std::vector<unsigned int> num_solutions_vector_; /** In-memory storage for number of solutions per grid location */
+
+  double* cache_data_;               /** Solution storage; points into the vector above or into the file mapping */
+  unsigned int* num_solutions_data_; /** Solution counts; points into the vector above or into the file mapping */
+  void* mapped_region_;              /** Address of the mmap'ed cache file, NULL if the cache is not mapped */
+  size_t mapped_length_;             /** Length of the file mapping */
 
   kinematics::KinematicsBaseConstPtr kinematics_solver_; /** An instance of the kinematics solver */
 
   robot_model::RobotModelConstPtr kinematic_model_; /** An instance of the kinematic model */
   robot_state::RobotStatePtr kinematic_state_;      /** An instance of the kinematic state */
 
-  const robot_model::JointModelGroup* joint_model_group_;           /** Joint model group associated with this cache */
-  std::shared_ptr<robot_state::JointStateGroup> joint_state_group_; /** Joint state corresponding to cache */
+  const robot_model::JointModelGroup* joint_model_group_; /** Joint model group associated with this cache */
 
   //    mutable std::vector<double> solution_local_; /** Local pre-allocated storage */
 
@@ -36,16 +36,56 @@
 *********************************************************************/
 
 #include <moveit/kinematics_cache/kinematics_cache.h>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+// fixed-size header at the start of a mmap'ed cache file; the solution storage (doubles) follows the
+// header and the per-grid-point solution counts come last, so the doubles stay 8-byte aligned
+struct MappedCacheHeader
+{
+  char magic[8];
+  char group_name[64];
+  double origin[3];
+  double workspace_size[3];
+  double resolution[3];
+  double min_squared_distance;
+  double max_squared_distance;
+  unsigned int max_solutions_per_grid_location;
+  unsigned int solution_dimension;
+  unsigned int num_grid_points;
+  unsigned int padding;
+};
+
+static const char MAPPED_CACHE_MAGIC[8] = { 'M', 'V', 'K', 'I', 'N', 'C', 'A', '1' };
+}
+
 namespace kinematics_cache
 {
-KinematicsCache::KinematicsCache() : min_squared_distance_(1e6), max_squared_distance_(0.0)
+KinematicsCache::KinematicsCache()
+  : cache_data_(NULL)
+  , num_solutions_data_(NULL)
+  , mapped_region_(NULL)
+  , mapped_length_(0)
+  , min_squared_distance_(1e6)
+  , max_squared_distance_(0.0)
 {
 }
 
-bool KinematicsCache::initialize(kinematics::KinematicsBaseConstPtr& kinematics_solver,
+KinematicsCache::~KinematicsCache()
+{
+  unmap();
+}
+
+bool KinematicsCache::initialize(const kinematics::KinematicsBaseConstPtr& kinematics_solver,
                                  const robot_model::RobotModelConstPtr& kinematic_model,
                                  const KinematicsCache::Options& opt)
 {
@@ -54,13 +94,12 @@ bool KinematicsCache::initialize(kinematics::KinematicsBaseConstPtr& kinematics_
   kinematic_model_ = kinematic_model;
   joint_model_group_ = kinematic_model_->getJointModelGroup(kinematics_solver_->getGroupName());
   kinematic_state_.reset(new robot_state::RobotState(kinematic_model));
-  joint_state_group_.reset(new robot_state::JointStateGroup(kinematic_state_.get(), joint_model_group_));
 
   setup(opt);
   return true;
 }
 
-void KinematicsCache::setup(const KinematicsCache::Options& opt)
+void KinematicsCache::setup(const KinematicsCache::Options& opt, bool allocate)
 {
   cache_origin_ = opt.origin;
   cache_resolution_x_ = opt.resolution[0];
@@ -75,8 +114,14 @@ void KinematicsCache::setup(const KinematicsCache::Options& opt)
   size_grid_node_ = max_solutions_per_grid_location_ * solution_dimension_;
   kinematics_cache_size_ = cache_size_x_ * cache_size_y_ * cache_size_z_;
   kinematics_cache_points_with_solution_ = 0;
-  kinematics_cache_vector_.resize(kinematics_cache_size_ * size_grid_node_, 0.0);
-  num_solutions_vector_.resize(kinematics_cache_size_, 0);
+  if (allocate)
+  {
+    unmap();
+    kinematics_cache_vector_.assign(kinematics_cache_size_ * size_grid_node_, 0.0);
+    num_solutions_vector_.assign(kinematics_cache_size_, 0);
+    cache_data_ = kinematics_cache_vector_.data();
+    num_solutions_data_ = num_solutions_vector_.data();
+  }
   ROS_DEBUG_NAMED("kinematics_cache", "Origin: %f %f %f", cache_origin_.x, cache_origin_.y, cache_origin_.z);
   ROS_DEBUG_NAMED("kinematics_cache", "Cache size (num points x,y,z): %d %d %d", cache_size_x_, cache_size_y_,
                   cache_size_z_);
@@ -100,8 +145,8 @@ bool KinematicsCache::generateCacheMap(double timeout)
   while ((ros::WallTime::now() - start_time).toSec() <= timeout &&
          kinematics_cache_points_with_solution_ <= kinematics_cache_size_)
   {
-    joint_state_group_->setToRandomValues();
-    joint_state_group_->getVariableValues(fk_values);
+    kinematic_state_->setToRandomPositions(joint_model_group_);
+    kinematic_state_->copyJointGroupPositions(joint_model_group_, fk_values);
     if (!kinematics_solver_->getPositionFK(fk_names, fk_values, poses))
     {
       ROS_ERROR_NAMED("kinematics_cache", "Fk failed");
@@ -128,7 +173,7 @@ bool KinematicsCache::addToCache(const geometry_msgs::Pose& pose, const std::vec
     ROS_DEBUG_NAMED("kinematics_cache", "Failed to get grid index");
     return false;
   }
-  unsigned int num_solutions = num_solutions_vector_[grid_index];
+  unsigned int num_solutions = num_solutions_data_[grid_index];
   if (!overwrite && num_solutions >= max_solutions_per_grid_location_)
   {
     ROS_DEBUG_NAMED("kinematics_cache", "Pose already has max number of solutions");
@@ -142,10 +187,10 @@ bool KinematicsCache::addToCache(const geometry_msgs::Pose& pose, const std::vec
   for (unsigned int i = 0; i < joint_values.size(); ++i)
   {
     //    ROS_INFO("Joint value[%d]: %f, localtion: %d",i,joint_values[i],start_index+i);
-    kinematics_cache_vector_[start_index + i] = joint_values[i];
+    cache_data_[start_index + i] = joint_values[i];
   }
-  if (num_solutions_vector_[grid_index] < max_solutions_per_grid_location_)
-    num_solutions_vector_[grid_index]++;
+  if (num_solutions_data_[grid_index] < max_solutions_per_grid_location_)
+    num_solutions_data_[grid_index]++;
   updateDistances(pose);
   return true;
 }
@@ -185,7 +230,7 @@ bool KinematicsCache::getNumSolutions(const geometry_msgs::Pose& pose, unsigned
   if (!getGridIndex(pose, grid_index))
     return false;
 
-  num_solutions = num_solutions_vector_[grid_index];
+  num_solutions = num_solutions_data_[grid_index];
   return true;
 }
 
@@ -216,7 +261,7 @@ bool KinematicsCache::getSolutions(const geometry_msgs::Pose& pose, std::vector<
   unsigned int grid_index;
   if (!getGridIndex(pose, grid_index))
     return false;
-  if (solution.size() != num_solutions_vector_[grid_index])
+  if (solution.size() != num_solutions_data_[grid_index])
     return false;
   for (unsigned int i = 0; i < solution.size(); i++)
   {
@@ -227,12 +272,40 @@ bool KinematicsCache::getSolutions(const geometry_msgs::Pose& pose, std::vector<
   return true;
 }
 
+bool KinematicsCache::getSolutions(const geometry_msgs::Pose& pose, const std::vector<double>& seed_state,
+                                   std::vector<std::vector<double> >& solutions) const
+{
+  unsigned int grid_index;
+  if (!getGridIndex(pose, grid_index))
+    return false;
+  if (seed_state.size() != solution_dimension_)
+    return false;
+  unsigned int num_solutions = num_solutions_data_[grid_index];
+  std::vector<std::pair<double, unsigned int> > distances(num_solutions);
+  for (unsigned int i = 0; i < num_solutions; ++i)
+  {
+    unsigned int solution_location = getSolutionLocation(grid_index, i);
+    double distance_squared = 0.0;
+    for (unsigned int j = 0; j < solution_dimension_; ++j)
+    {
+      double diff = cache_data_[solution_location + j] - seed_state[j];
+      distance_squared += diff * diff;
+    }
+    distances[i] = std::make_pair(distance_squared, i);
+  }
+  std::sort(distances.begin(), distances.end());
+  solutions.resize(num_solutions);
+  for (unsigned int i = 0; i < num_solutions; ++i)
+    solutions[i] = getSolution(grid_index, distances[i].second);
+  return true;
+}
+
 std::vector<double> KinematicsCache::getSolution(unsigned int grid_index, unsigned int solution_index) const
 {
   std::vector<double> solution_local(solution_dimension_);
   unsigned int solution_location = getSolutionLocation(grid_index, solution_index);
   for (unsigned int i = 0; i < solution_dimension_; ++i)
-    solution_local[i] = kinematics_cache_vector_[solution_location + i];
+    solution_local[i] = cache_data_[solution_location + i];
   return solution_local;
 }
 
@@ -325,6 +398,8 @@ bool KinematicsCache::readFromFile(const std::string& filename)
 
   kinematics_cache_vector_ = kinematics_cache_vector;
   num_solutions_vector_ = num_solutions_vector;
+  cache_data_ = kinematics_cache_vector_.data();
+  num_solutions_data_ = num_solutions_vector_.data();
   ROS_DEBUG_NAMED("kinematics_cache", "Read %d total points from file: %s", (int)num_solutions_vector_.size(),
                   filename.c_str());
   return true;
@@ -332,7 +407,7 @@ bool KinematicsCache::readFromFile(const std::string& filename)
 
 bool KinematicsCache::writeToFile(const std::string& filename)
 {
-  ROS_DEBUG_NAMED("kinematics_cache", "Writing %d total points to file: %s", (int)num_solutions_vector_.size(),
+  ROS_DEBUG_NAMED("kinematics_cache", "Writing %d total points to file: %s", (int)kinematics_cache_size_,
                   filename.c_str());
   std::ofstream file;
   file.open(filename.c_str());
@@ -353,13 +428,13 @@ bool KinematicsCache::writeToFile(const std::string& filename)
     file << options_.max_solutions_per_grid_location << std::endl;
     file << min_squared_distance_ << std::endl;
     file << max_squared_distance_ << std::endl;
-    file << kinematics_cache_vector_.size() << std::endl;
-    std::copy(kinematics_cache_vector_.begin(), kinematics_cache_vector_.end(),
+    file << kinematics_cache_size_ * size_grid_node_ << std::endl;
+    std::copy(cache_data_, cache_data_ + kinematics_cache_size_ * size_grid_node_,
               std::ostream_iterator<double>(file, " "));
     file << std::endl;
 
-    file << num_solutions_vector_.size() << std::endl;
-    std::copy(num_solutions_vector_.begin(), num_solutions_vector_.end(),
+    file << kinematics_cache_size_ << std::endl;
+    std::copy(num_solutions_data_, num_solutions_data_ + kinematics_cache_size_,
               std::ostream_iterator<unsigned int>(file, " "));
     file << std::endl;
   }
@@ -368,6 +443,162 @@ bool KinematicsCache::writeToFile(const std::string& filename)
   return true;
 }
 
+bool KinematicsCache::mapFromFile(const std::string& filename)
+{
+  int fd = open(filename.c_str(), O_RDWR);
+  if (fd < 0)
+  {
+    ROS_DEBUG_NAMED("kinematics_cache", "Could not open file: %s", filename.c_str());
+    return false;
+  }
+
+  MappedCacheHeader header;
+  if (read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) ||
+      memcmp(header.magic, MAPPED_CACHE_MAGIC, sizeof(MAPPED_CACHE_MAGIC)) != 0)
+  {
+    ROS_ERROR_NAMED("kinematics_cache", "File %s is not a kinematics cache file", filename.c_str());
+    close(fd);
+    return false;
+  }
+  header.group_name[sizeof(header.group_name) - 1] = '\0';
+  if (kinematics_solver_->getGroupName() != header.group_name)
+  {
+    ROS_ERROR_NAMED("kinematics_cache", "Input file group name %s does not match solver group name %s",
+                    header.group_name, kinematics_solver_->getGroupName().c_str());
+    close(fd);
+    return false;
+  }
+
+  options_.origin.x = header.origin[0];
+  options_.origin.y = header.origin[1];
+  options_.origin.z = header.origin[2];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    options_.workspace_size[i] = header.workspace_size[i];
+    options_.resolution[i] = header.resolution[i];
+  }
+  options_.max_solutions_per_grid_location = header.max_solutions_per_grid_location;
+  unmap();
+  setup(options_, false);
+  if (header.num_grid_points != kinematics_cache_size_ || header.solution_dimension != solution_dimension_)
+  {
+    ROS_ERROR_NAMED("kinematics_cache", "Grid in file %s does not match the solver group: %u points of dimension %u, "
+                                        "expected %u points of dimension %u",
+                    filename.c_str(), header.num_grid_points, header.solution_dimension, kinematics_cache_size_,
+                    solution_dimension_);
+    close(fd);
+    return false;
+  }
+
+  size_t length = sizeof(MappedCacheHeader) + kinematics_cache_size_ * size_grid_node_ * sizeof(double) +
+                  kinematics_cache_size_ * sizeof(unsigned int);
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || (size_t)file_stat.st_size != length)
+  {
+    ROS_ERROR_NAMED("kinematics_cache", "File %s has unexpected size", filename.c_str());
+    close(fd);
+    return false;
+  }
+
+  // MAP_SHARED, so concurrent processes mapping the same file share one physical copy of the
+  // cache and updates are written through to the file
+  void* region = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (region == MAP_FAILED)
+  {
+    ROS_ERROR_NAMED("kinematics_cache", "Could not map file: %s", filename.c_str());
+    return false;
+  }
+
+  mapped_region_ = region;
+  mapped_length_ = length;
+  cache_data_ = reinterpret_cast<double*>(static_cast<char*>(region) + sizeof(MappedCacheHeader));
+  num_solutions_data_ = reinterpret_cast<unsigned int*>(cache_data_ + kinematics_cache_size_ * size_grid_node_);
+  min_squared_distance_ = header.min_squared_distance;
+  max_squared_distance_ = header.max_squared_distance;
+  kinematics_cache_vector_.clear();
+  num_solutions_vector_.clear();
+  for (unsigned int i = 0; i < kinematics_cache_size_; ++i)
+    if (num_solutions_data_[i] > 0)
+      kinematics_cache_points_with_solution_++;
+  ROS_DEBUG_NAMED("kinematics_cache", "Mapped %d total points (%d with solutions) from file: %s",
+                  (int)kinematics_cache_size_, (int)kinematics_cache_points_with_solution_, filename.c_str());
+  return true;
+}
+
+bool KinematicsCache::createMappedFile(const std::string& filename)
+{
+  size_t length = sizeof(MappedCacheHeader) + kinematics_cache_size_ * size_grid_node_ * sizeof(double) +
+                  kinematics_cache_size_ * sizeof(unsigned int);
+  int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    ROS_ERROR_NAMED("kinematics_cache", "Could not create file: %s", filename.c_str());
+    return false;
+  }
+  if (ftruncate(fd, length) != 0)
+  {
+    ROS_ERROR_NAMED("kinematics_cache", "Could not resize file %s to %zu bytes", filename.c_str(), length);
+    close(fd);
+    return false;
+  }
+  void* region = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (region == MAP_FAILED)
+  {
+    ROS_ERROR_NAMED("kinematics_cache", "Could not map file: %s", filename.c_str());
+    return false;
+  }
+
+  MappedCacheHeader* header = static_cast<MappedCacheHeader*>(region);
+  memset(header, 0, sizeof(MappedCacheHeader));
+  memcpy(header->magic, MAPPED_CACHE_MAGIC, sizeof(MAPPED_CACHE_MAGIC));
+  strncpy(header->group_name, kinematics_solver_->getGroupName().c_str(), sizeof(header->group_name) - 1);
+  header->origin[0] = options_.origin.x;
+  header->origin[1] = options_.origin.y;
+  header->origin[2] = options_.origin.z;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    header->workspace_size[i] = options_.workspace_size[i];
+    header->resolution[i] = options_.resolution[i];
+  }
+  header->max_solutions_per_grid_location = max_solutions_per_grid_location_;
+  header->solution_dimension = solution_dimension_;
+  header->num_grid_points = kinematics_cache_size_;
+  header->min_squared_distance = min_squared_distance_;
+  header->max_squared_distance = max_squared_distance_;
+
+  double* mapped_cache_data = reinterpret_cast<double*>(static_cast<char*>(region) + sizeof(MappedCacheHeader));
+  unsigned int* mapped_num_solutions =
+      reinterpret_cast<unsigned int*>(mapped_cache_data + kinematics_cache_size_ * size_grid_node_);
+  if (cache_data_)
+    memcpy(mapped_cache_data, cache_data_, kinematics_cache_size_ * size_grid_node_ * sizeof(double));
+  if (num_solutions_data_)
+    memcpy(mapped_num_solutions, num_solutions_data_, kinematics_cache_size_ * sizeof(unsigned int));
+
+  unmap();
+  kinematics_cache_vector_.clear();
+  num_solutions_vector_.clear();
+  mapped_region_ = region;
+  mapped_length_ = length;
+  cache_data_ = mapped_cache_data;
+  num_solutions_data_ = mapped_num_solutions;
+  ROS_DEBUG_NAMED("kinematics_cache", "Created mapped cache file %s (%zu bytes)", filename.c_str(), length);
+  return true;
+}
+
+void KinematicsCache::unmap()
+{
+  if (!mapped_region_)
+    return;
+  msync(mapped_region_, mapped_length_, MS_SYNC);
+  munmap(mapped_region_, mapped_length_);
+  mapped_region_ = NULL;
+  mapped_length_ = 0;
+  cache_data_ = kinematics_cache_vector_.empty() ? NULL : kinematics_cache_vector_.data();
+  num_solutions_data_ = num_solutions_vector_.empty() ? NULL : num_solutions_vector_.data();
+}
+
 std::pair<double, double> KinematicsCache::getMinMaxSquaredDistance()
 {
   return std::pair<double, double>(min_squared_distance_, max_squared_distance_);
@@ -379,5 +610,11 @@ void KinematicsCache::updateDistances(const geometry_msgs::Pose& pose)
       (pose.position.x * pose.position.x + pose.position.y * pose.position.y + pose.position.z * pose.position.z);
   min_squared_distance_ = std::min<double>(distance_squared, min_squared_distance_);
   max_squared_distance_ = std::max<double>(distance_squared, max_squared_distance_);
+  if (mapped_region_)
+  {
+    MappedCacheHeader* header = static_cast<MappedCacheHeader*>(mapped_region_);
+    header->min_squared_distance = min_squared_distance_;
+    header->max_squared_distance = max_squared_distance_;
+  }
 }
 }
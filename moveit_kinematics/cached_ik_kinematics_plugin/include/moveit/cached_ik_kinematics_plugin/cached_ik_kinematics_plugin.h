@@ -44,6 +44,7 @@
 #include <tf2/LinearMath/Quaternion.h>
 #include <moveit/cached_ik_kinematics_plugin/detail/NearestNeighborsGNAT.h>
 #include <boost/filesystem.hpp>
+#include <memory>
 #include <unordered_map>
 #include <mutex>
 #include <utility>
@@ -116,8 +117,26 @@ public:
 protected:
   /** compute the distance between two joint configurations */
   double configDistance2(const std::vector<double>& config1, const std::vector<double>& config2) const;
-  /** save current state of cache to disk */
+  /**
+    save current state of cache to disk; the file format uses fixed-size
+    records, so entries added since the last save are appended to the
+    existing file and only the entry count in the header is rewritten
+  */
   void saveCache() const;
+  /**
+    build a nearest-neighbor structure over all current cache entries and
+    atomically publish it as the new read snapshot; lock_ must be held
+  */
+  void publishNearestNeighbors() const;
+  /**
+    load the optional precomputed seed database generated by the
+    build_ik_seed_database tool and index it with a workspace grid
+  */
+  void loadSeedDatabase(const boost::filesystem::path& filename);
+  /** constant-time seed database lookup; returns nullptr if the grid cell of \e poses[0] is empty */
+  const IKEntry* lookupSeedDatabase(const std::vector<Pose>& poses) const;
+  /** constant-time seed database lookup; returns nullptr if the grid cell of \e pose is empty */
+  const IKEntry* lookupSeedDatabase(const Pose& pose) const;
 
   /** number of joints in the system */
   unsigned int num_joints_;
@@ -131,15 +150,28 @@ protected:
   /** file name for loading / saving cache */
   boost::filesystem::path cache_file_name_;
 
+  /** entries of the optional precomputed seed database; read-only after initialization */
+  std::vector<IKEntry> seed_db_;
+  /** maps the hash of a workspace grid cell to the seed entries whose first tip position falls in that cell */
+  std::unordered_map<std::size_t, std::vector<unsigned int>> seed_grid_;
+  /** edge length of the workspace grid cells; 0 if no seed database is loaded */
+  double seed_db_cell_size_{ 0. };
+
   /**
     the IK methods are declared const in the base class, but the
-    wrapped methods need to modify the cache, so the next four members
+    wrapped methods need to modify the cache, so the following members
     are mutable
     cache of IK solutions
   */
   mutable std::vector<IKEntry> ik_cache_;
-  /** nearest neighbor data structure over IK cache entries */
-  mutable NearestNeighborsGNAT<IKEntry*> ik_nn_;
+  /**
+    immutable nearest-neighbor snapshot over IK cache entries; readers
+    atomically load the snapshot and query it without taking lock_, while
+    writers publish a freshly built snapshot after a batch of insertions
+  */
+  mutable std::shared_ptr<const NearestNeighborsGNAT<IKEntry*>> ik_nn_;
+  /** number of cache entries covered by the currently published snapshot */
+  mutable unsigned int snapshot_size_{ 0 };
   /** size of the cache when it was last saved */
   mutable unsigned int last_saved_cache_size_{ 0 };
   /** mutex for changing IK cache */
@@ -0,0 +1,230 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Rice University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Rice University nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+// Offline builder for the seed databases used by the Cached IK Kinematics Plugin.
+// It densely samples the configuration space of a planning group on all available
+// cores, computes forward kinematics for each collision-free sample and writes a
+// workspace-indexed seed database (.ikseeds file) that IKCache can query in
+// constant time, so a freshly deployed robot doesn't start with an empty cache.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <ros/ros.h>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/program_options.hpp>
+#include <tf2/LinearMath/Scalar.h>
+#include <moveit/robot_model_loader/robot_model_loader.h>
+#include <moveit/planning_scene/planning_scene.h>
+
+namespace po = boost::program_options;
+
+namespace
+{
+// one collision-free sample: the joint configuration and the poses of the end effectors
+struct SeedSample
+{
+  std::vector<double> config;
+  EigenSTL::vector_Isometry3d poses;
+};
+
+// spatial hash of the workspace grid cell containing a given position; this only needs to
+// spread samples over buckets, it does not need to match the hash used by IKCache at runtime
+std::size_t cellHash(const Eigen::Vector3d& position, double cell_size)
+{
+  long x = std::lround(std::floor(position.x() / cell_size));
+  long y = std::lround(std::floor(position.y() / cell_size));
+  long z = std::lround(std::floor(position.z() / cell_size));
+  return std::size_t(x * 73856093l) ^ std::size_t(y * 19349663l) ^ std::size_t(z * 83492791l);
+}
+
+void sampleWorker(const robot_model::RobotModelPtr& kinematic_model, const robot_model::JointModelGroup* group,
+                  const std::vector<std::string>& end_effectors, unsigned int num_samples,
+                  std::vector<SeedSample>* samples)
+{
+  // each worker gets its own planning scene and robot state, so no synchronization is needed
+  planning_scene::PlanningScene planning_scene(kinematic_model);
+  robot_state::RobotState state(kinematic_model);
+  state.setToDefaultValues();
+  collision_detection::CollisionRequest collision_request;
+  collision_detection::CollisionResult collision_result;
+  SeedSample sample;
+  sample.poses.resize(end_effectors.size());
+
+  samples->reserve(num_samples);
+  for (unsigned int i = 0; i < num_samples; ++i)
+  {
+    state.setToRandomPositions(group);
+    state.update();
+    collision_result.clear();
+    planning_scene.checkSelfCollision(collision_request, collision_result, state);
+    if (collision_result.collision)
+      continue;
+    state.copyJointGroupPositions(group, sample.config);
+    for (unsigned int j = 0; j < end_effectors.size(); ++j)
+      sample.poses[j] = state.getGlobalLinkTransform(end_effectors[j]);
+    samples->push_back(sample);
+  }
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  std::string group;
+  std::string tip;
+  std::string path;
+  unsigned int num;
+  unsigned int num_threads;
+  unsigned int seeds_per_cell;
+  double cell_size;
+  po::options_description desc("Options");
+  desc.add_options()("help", "show help message")("group", po::value<std::string>(&group)->default_value("all"),
+                                                  "name of planning group")(
+      "tip", po::value<std::string>(&tip)->default_value("default"), "name of the end effector in the planning group")(
+      "num", po::value<unsigned int>(&num)->default_value(1000000), "number of configurations to sample")(
+      "threads", po::value<unsigned int>(&num_threads)->default_value(0),
+      "number of sampling threads (0 uses all cores)")("cell_size", po::value<double>(&cell_size)->default_value(0.1),
+                                    "edge length of the workspace grid cells")(
+      "seeds_per_cell", po::value<unsigned int>(&seeds_per_cell)->default_value(4),
+      "maximum number of seed configurations stored per grid cell")(
+      "path", po::value<std::string>(&path)->default_value("."),
+      "output directory for seed databases (should match cached_ik_path)");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help") != 0u)
+  {
+    std::cout << desc << "\n";
+    return 1;
+  }
+
+  ros::init(argc, argv, "build_ik_seed_database");
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  robot_model_loader::RobotModelLoader robot_model_loader;
+  robot_model::RobotModelPtr kinematic_model = robot_model_loader.getModel();
+  std::vector<robot_state::JointModelGroup*> groups;
+  std::vector<std::string> end_effectors;
+
+  if (group == "all")
+    groups = kinematic_model->getJointModelGroups();
+  else
+    groups.push_back(kinematic_model->getJointModelGroup(group));
+
+  boost::filesystem::path prefix(path);
+  boost::filesystem::create_directories(prefix);
+
+  for (const auto& group : groups)
+  {
+    // skip group if there's no IK solver; the solver's base and tip frames determine the file name
+    const kinematics::KinematicsBaseConstPtr& solver = group->getSolverInstance();
+    if (solver == nullptr)
+      continue;
+
+    if (tip == "default")
+      end_effectors = solver->getTipFrames();
+    else
+      end_effectors = std::vector<std::string>(1, tip);
+    if (end_effectors.empty())
+      continue;
+
+    // sample the configuration space on all threads
+    std::vector<std::vector<SeedSample>> thread_samples(num_threads);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < num_threads; ++i)
+      threads.emplace_back(sampleWorker, kinematic_model, group, end_effectors,
+                           num / num_threads + (i < num % num_threads ? 1 : 0), &thread_samples[i]);
+    for (auto& thread : threads)
+      thread.join();
+
+    // keep at most seeds_per_cell samples per workspace grid cell of the first end effector,
+    // so the database stays small while still covering the reachable workspace
+    std::unordered_map<std::size_t, unsigned int> cell_count;
+    std::vector<const SeedSample*> selected;
+    for (const auto& samples : thread_samples)
+      for (const auto& sample : samples)
+        if (cell_count[cellHash(sample.poses[0].translation(), cell_size)]++ < seeds_per_cell)
+          selected.push_back(&sample);
+
+    // write the seed database; the record layout matches the .ikcache format, preceded by the cell size
+    std::string cache_name = solver->getBaseFrame();
+    for (const auto& end_effector : end_effectors)
+      cache_name += end_effector;
+    boost::filesystem::path filename =
+        prefix / (kinematic_model->getName() + group->getName() + "_" + cache_name + ".ikseeds");
+    boost::filesystem::ofstream seed_file(filename, std::ios_base::binary | std::ios_base::out);
+    unsigned int num_entries = selected.size();
+    unsigned int num_dofs = group->getVariableCount();
+    unsigned int num_tips = end_effectors.size();
+    seed_file.write((char*)&cell_size, sizeof(double));
+    seed_file.write((char*)&num_entries, sizeof(unsigned int));
+    seed_file.write((char*)&num_dofs, sizeof(unsigned int));
+    seed_file.write((char*)&num_tips, sizeof(unsigned int));
+
+    unsigned int position_size = 3 * sizeof(tf2Scalar);
+    unsigned int orientation_size = 4 * sizeof(tf2Scalar);
+    unsigned int pose_size = position_size + orientation_size;
+    unsigned int config_size = num_dofs * sizeof(double);
+    unsigned int offset_conf = pose_size * num_tips;
+    unsigned int bufsize = offset_conf + config_size;
+    std::vector<char> buffer(bufsize);
+    for (const SeedSample* sample : selected)
+    {
+      for (unsigned int i = 0; i < num_tips; ++i)
+      {
+        Eigen::Vector3d translation = sample->poses[i].translation();
+        Eigen::Quaterniond orientation(sample->poses[i].linear());
+        tf2Scalar pose[7] = { translation.x(), translation.y(), translation.z(), orientation.x(),
+                              orientation.y(), orientation.z(), orientation.w() };
+        memcpy(&buffer[i * pose_size], pose, pose_size);
+      }
+      memcpy(&buffer[offset_conf], &sample->config[0], config_size);
+      seed_file.write(&buffer[0], bufsize);
+    }
+    ROS_INFO_NAMED("cached_ik.build_ik_seed_database",
+                   "wrote %d seed configurations for group %s to %s (%ld samples, cell size %g)", num_entries,
+                   group->getName().c_str(), filename.string().c_str(), (long)num, cell_size);
+  }
+
+  ros::shutdown();
+  return 0;
+}
@@ -36,22 +36,32 @@
 
 #include <boost/filesystem/fstream.hpp>
 #include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <limits>
 #include <numeric>
 
 #include <moveit/cached_ik_kinematics_plugin/cached_ik_kinematics_plugin.h>
 
 namespace cached_ik_kinematics_plugin
 {
+// number of insertions batched up before a new nearest-neighbor snapshot is published
+static const unsigned int SNAPSHOT_BATCH_SIZE = 128;
+
+// spatial hash of the workspace grid cell containing a given position; hash collisions between
+// distant cells are harmless, they only cause extra candidates to be scanned during lookup
+static std::size_t seedCellHash(const tf2::Vector3& position, double cell_size)
+{
+  long x = std::lround(std::floor(position.x() / cell_size));
+  long y = std::lround(std::floor(position.y() / cell_size));
+  long z = std::lround(std::floor(position.z() / cell_size));
+  return std::size_t(x * 73856093l) ^ std::size_t(y * 19349663l) ^ std::size_t(z * 83492791l);
+}
+
 IKCache::IKCache()
 {
-  // set distance function for nearest-neighbor queries
-  ik_nn_.setDistanceFunction([this](const IKEntry* entry1, const IKEntry* entry2) {
-    double dist = 0.;
-    for (unsigned int i = 0; i < entry1->first.size(); ++i)
-      dist += entry1->first[i].distance(entry2->first[i]);
-    return dist;
-  });
+  // publish an empty snapshot so that concurrent readers never see a null pointer
+  publishNearestNeighbors();
 }
 
 IKCache::~IKCache()
@@ -83,7 +93,6 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
                                std::to_string(std::sqrt(min_config_distance2_)) + ".ikcache");
 
   ik_cache_.clear();
-  ik_nn_.clear();
   last_saved_cache_size_ = 0;
   if (boost::filesystem::exists(cache_file_name_))
   {
@@ -126,17 +135,118 @@ void IKCache::initializeCache(const std::string& robot_id, const std::string& gr
     ROS_INFO_NAMED("cached_ik", "freeing buffer");
     delete[] buffer;
     ROS_INFO_NAMED("cached_ik", "freed buffer");
-    std::vector<IKEntry*> ik_entry_ptrs(last_saved_cache_size_);
-    for (unsigned int i = 0; i < last_saved_cache_size_; ++i)
-      ik_entry_ptrs[i] = &ik_cache_[i];
-    ik_nn_.add(ik_entry_ptrs);
   }
+  // publish a snapshot over the loaded entries (or an empty one) for lock-free readers
+  publishNearestNeighbors();
 
   num_joints_ = num_joints;
 
+  // load the optional precomputed seed database produced by build_ik_seed_database
+  loadSeedDatabase(prefix / (robot_id + group_name + "_" + cache_name + ".ikseeds"));
+
   ROS_INFO_NAMED("cached_ik", "cache file %s initialized!", cache_file_name_.string().c_str());
 }
 
+void IKCache::loadSeedDatabase(const boost::filesystem::path& filename)
+{
+  seed_db_.clear();
+  seed_grid_.clear();
+  seed_db_cell_size_ = 0.;
+  if (!boost::filesystem::exists(filename))
+    return;
+
+  boost::filesystem::ifstream seed_file(filename, std::ios_base::binary | std::ios_base::in);
+  double cell_size;
+  seed_file.read((char*)&cell_size, sizeof(double));
+  unsigned int num_entries;
+  seed_file.read((char*)&num_entries, sizeof(unsigned int));
+  unsigned int num_dofs;
+  seed_file.read((char*)&num_dofs, sizeof(unsigned int));
+  unsigned int num_tips;
+  seed_file.read((char*)&num_tips, sizeof(unsigned int));
+  if (num_dofs != num_joints_ || cell_size <= 0.)
+  {
+    ROS_WARN_NAMED("cached_ik", "ignoring seed database %s: expected %d dofs, found %d",
+                   filename.string().c_str(), num_joints_, num_dofs);
+    return;
+  }
+
+  unsigned int position_size = 3 * sizeof(tf2Scalar);
+  unsigned int orientation_size = 4 * sizeof(tf2Scalar);
+  unsigned int pose_size = position_size + orientation_size;
+  unsigned int config_size = num_dofs * sizeof(double);
+  unsigned int offset_conf = pose_size * num_tips;
+  unsigned int bufsize = offset_conf + config_size;
+  char* buffer = new char[bufsize];
+  IKEntry entry;
+  entry.first.resize(num_tips);
+  entry.second.resize(num_dofs);
+  seed_db_.reserve(num_entries);
+
+  for (unsigned int i = 0; i < num_entries; ++i)
+  {
+    unsigned int j = 0;
+    seed_file.read(buffer, bufsize);
+    for (auto& pose : entry.first)
+    {
+      memcpy(&pose.position[0], buffer + j * pose_size, position_size);
+      memcpy(&pose.orientation[0], buffer + j * pose_size + position_size, orientation_size);
+      ++j;
+    }
+    memcpy(&entry.second[0], buffer + offset_conf, config_size);
+    seed_db_.push_back(entry);
+    seed_grid_[seedCellHash(entry.first[0].position, cell_size)].push_back(i);
+  }
+  delete[] buffer;
+  seed_db_cell_size_ = cell_size;
+  ROS_INFO_NAMED("cached_ik", "Loaded seed database %s with %d entries (cell size %g)", filename.string().c_str(),
+                 num_entries, cell_size);
+}
+
+const IKCache::IKEntry* IKCache::lookupSeedDatabase(const std::vector<Pose>& poses) const
+{
+  if (seed_db_.empty() || seed_db_[0].first.size() != poses.size())
+    return nullptr;
+  auto it = seed_grid_.find(seedCellHash(poses[0].position, seed_db_cell_size_));
+  if (it == seed_grid_.end())
+    return nullptr;
+  const IKEntry* best = nullptr;
+  double best_dist = std::numeric_limits<double>::infinity(), dist;
+  for (unsigned int index : it->second)
+  {
+    const IKEntry& entry = seed_db_[index];
+    dist = 0.;
+    for (unsigned int i = 0; i < poses.size(); ++i)
+      dist += entry.first[i].distance(poses[i]);
+    if (dist < best_dist)
+    {
+      best_dist = dist;
+      best = &entry;
+    }
+  }
+  return best;
+}
+
+const IKCache::IKEntry* IKCache::lookupSeedDatabase(const Pose& pose) const
+{
+  auto it = seed_grid_.find(seedCellHash(pose.position, seed_db_cell_size_));
+  if (it == seed_grid_.end())
+    return nullptr;
+  const IKEntry* best = nullptr;
+  double best_dist = std::numeric_limits<double>::infinity(), dist;
+  for (unsigned int index : it->second)
+  {
+    const IKEntry& entry = seed_db_[index];
+    dist = entry.first[0].distance(pose);
+    if (dist < best_dist)
+    {
+      best_dist = dist;
+      best = &entry;
+    }
+  }
+  return best;
+}
+
 double IKCache::configDistance2(const std::vector<double>& config1, const std::vector<double>& config2) const
 {
   double dist = 0., diff;
@@ -150,24 +260,40 @@ double IKCache::configDistance2(const std::vector<double>& config1, const std::v
 
 const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const Pose& pose) const
 {
-  if (ik_cache_.empty())
+  // a precomputed seed database offers a constant-time lookup; the nearest-neighbor cache is
+  // only consulted for poses outside the database's coverage
+  if (seed_db_cell_size_ > 0.)
+  {
+    const IKEntry* seed = lookupSeedDatabase(pose);
+    if (seed)
+      return *seed;
+  }
+  std::shared_ptr<const NearestNeighborsGNAT<IKEntry*>> nn = std::atomic_load(&ik_nn_);
+  if (nn->size() == 0)
   {
     static IKEntry dummy = std::make_pair(std::vector<Pose>(1, pose), std::vector<double>(num_joints_, 0.));
     return dummy;
   }
   IKEntry query = std::make_pair(std::vector<Pose>(1, pose), std::vector<double>());
-  return *ik_nn_.nearest(&query);
+  return *nn->nearest(&query);
 }
 
 const IKCache::IKEntry& IKCache::getBestApproximateIKSolution(const std::vector<Pose>& poses) const
 {
-  if (ik_cache_.empty())
+  if (seed_db_cell_size_ > 0.)
+  {
+    const IKEntry* seed = lookupSeedDatabase(poses);
+    if (seed)
+      return *seed;
+  }
+  std::shared_ptr<const NearestNeighborsGNAT<IKEntry*>> nn = std::atomic_load(&ik_nn_);
+  if (nn->size() == 0)
   {
     static IKEntry dummy = std::make_pair(poses, std::vector<double>(num_joints_, 0.));
     return dummy;
   }
   IKEntry query = std::make_pair(poses, std::vector<double>());
-  return *ik_nn_.nearest(&query);
+  return *nn->nearest(&query);
 }
 
 void IKCache::updateCache(const IKEntry& nearest, const Pose& pose, const std::vector<double>& config) const
@@ -177,7 +303,9 @@ void IKCache::updateCache(const IKEntry& nearest, const Pose& pose, const std::v
   {
     std::lock_guard<std::mutex> slock(lock_);
     ik_cache_.emplace_back(std::vector<Pose>(1u, pose), config);
-    ik_nn_.add(&ik_cache_.back());
+    if (snapshot_size_ == 0 || ik_cache_.size() >= snapshot_size_ + SNAPSHOT_BATCH_SIZE ||
+        ik_cache_.size() == max_cache_size_)
+      publishNearestNeighbors();
     if (ik_cache_.size() >= last_saved_cache_size_ + 500u || ik_cache_.size() == max_cache_size_)
       saveCache();
   }
@@ -206,21 +334,43 @@ void IKCache::updateCache(const IKEntry& nearest, const std::vector<Pose>& poses
     {
       std::lock_guard<std::mutex> slock(lock_);
       ik_cache_.emplace_back(poses, config);
-      ik_nn_.add(&ik_cache_.back());
+      if (snapshot_size_ == 0 || ik_cache_.size() >= snapshot_size_ + SNAPSHOT_BATCH_SIZE ||
+          ik_cache_.size() == max_cache_size_)
+        publishNearestNeighbors();
       if (ik_cache_.size() >= last_saved_cache_size_ + 500u || ik_cache_.size() == max_cache_size_)
         saveCache();
     }
   }
 }
 
+void IKCache::publishNearestNeighbors() const
+{
+  auto nn = std::make_shared<NearestNeighborsGNAT<IKEntry*>>();
+  // set distance function for nearest-neighbor queries
+  nn->setDistanceFunction([](const IKEntry* entry1, const IKEntry* entry2) {
+    double dist = 0.;
+    for (unsigned int i = 0; i < entry1->first.size(); ++i)
+      dist += entry1->first[i].distance(entry2->first[i]);
+    return dist;
+  });
+  if (!ik_cache_.empty())
+  {
+    std::vector<IKEntry*> ik_entry_ptrs(ik_cache_.size());
+    for (unsigned int i = 0; i < ik_cache_.size(); ++i)
+      ik_entry_ptrs[i] = &ik_cache_[i];
+    nn->add(ik_entry_ptrs);
+  }
+  snapshot_size_ = ik_cache_.size();
+  std::atomic_store(&ik_nn_, std::shared_ptr<const NearestNeighborsGNAT<IKEntry*>>(std::move(nn)));
+}
+
 void IKCache::saveCache() const
 {
   if (cache_file_name_.empty())
     ROS_ERROR_NAMED("cached_ik", "can't save cache before initialization");
+  if (last_saved_cache_size_ == ik_cache_.size() && boost::filesystem::exists(cache_file_name_))
+    return;
 
-  ROS_INFO_NAMED("cached_ik", "writing %ld IK solutions to %s", ik_cache_.size(), cache_file_name_.string().c_str());
-
-  boost::filesystem::ofstream cache_file(cache_file_name_, std::ios_base::binary | std::ios_base::out);
   unsigned int position_size = 3 * sizeof(tf2Scalar);
   unsigned int orientation_size = 4 * sizeof(tf2Scalar);
   unsigned int pose_size = position_size + orientation_size;
@@ -230,14 +380,37 @@ void IKCache::saveCache() const
   unsigned int bufsize = offset_conf + config_size;
   char* buffer = new char[bufsize];
 
+  // all records after the header have the same size, so entries added since the last save can
+  // simply be appended to the existing file; a full rewrite is only needed when no file exists yet
+  unsigned int first_unsaved = 0;
+  bool append = last_saved_cache_size_ > 0 && last_saved_cache_size_ < ik_cache_.size() &&
+                boost::filesystem::exists(cache_file_name_);
+  boost::filesystem::ofstream cache_file;
+  if (append)
+  {
+    first_unsaved = last_saved_cache_size_;
+    ROS_INFO_NAMED("cached_ik", "appending %ld IK solutions to %s", ik_cache_.size() - first_unsaved,
+                   cache_file_name_.string().c_str());
+    cache_file.open(cache_file_name_, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+  }
+  else
+  {
+    ROS_INFO_NAMED("cached_ik", "writing %ld IK solutions to %s", ik_cache_.size(), cache_file_name_.string().c_str());
+    cache_file.open(cache_file_name_, std::ios_base::binary | std::ios_base::out);
+  }
+
   // write number of IK entries and size of each configuration first
   last_saved_cache_size_ = ik_cache_.size();
   cache_file.write((char*)&last_saved_cache_size_, sizeof(unsigned int));
   unsigned int sz = ik_cache_[0].second.size();
   cache_file.write((char*)&sz, sizeof(unsigned int));
   cache_file.write((char*)&num_tips, sizeof(unsigned int));
-  for (const auto& entry : ik_cache_)
+  if (append)
+    cache_file.seekp(std::streamoff(3 * sizeof(unsigned int)) + std::streamoff(first_unsaved) * bufsize,
+                     std::ios_base::beg);
+  for (unsigned int entry_index = first_unsaved; entry_index < last_saved_cache_size_; ++entry_index)
   {
+    const IKEntry& entry = ik_cache_[entry_index];
     for (unsigned int i = 0; i < num_tips; ++i)
     {
       memcpy(buffer + i * pose_size, &entry.first[i].position[0], position_size);
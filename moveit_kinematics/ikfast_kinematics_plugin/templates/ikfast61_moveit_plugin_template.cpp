@@ -50,6 +50,8 @@
 #include <moveit/kinematics_base/kinematics_base.h>
 #include <urdf/model.h>
 #include <tf2_kdl/tf2_kdl.h>
+#include <algorithm>
+#include <utility>
 
 // Need a floating point tolerance when checking joint limits, in case the joint starts at limit
 const double LIMIT_TOLERANCE = .0000001;
@@ -999,6 +1001,12 @@ bool IKFastKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose
   std::vector<double> best_solution;
   int nattempts = 0, nvalid = 0;
 
+  // flat buffer holding all candidate solutions of one sweep step, and their ranking by
+  // joint-space distance to the seed; allocated once and reused across sweep steps
+  std::vector<double> candidate_buffer;
+  std::vector<double> sol(num_joints_);
+  std::vector<std::pair<double, int> > candidate_order;
+
   while (true)
   {
     IkSolutionList<IkReal> solutions;
@@ -1010,26 +1018,47 @@ bool IKFastKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose
 
     if (numsol > 0)
     {
+      // extract each candidate only once into the flat buffer and rank the candidates by their
+      // largest joint motion relative to the seed, so the nearest feasible solution is checked
+      // (and returned) first
+      candidate_buffer.resize(numsol * num_joints_);
+      candidate_order.clear();
       for (int s = 0; s < numsol; ++s)
       {
-        nattempts++;
-        std::vector<double> sol;
         getSolution(solutions, ik_seed_state, s, sol);
+        std::copy(sol.begin(), sol.end(), candidate_buffer.begin() + s * num_joints_);
+
+        // Costs for solution: Largest joint motion
+        double costs = 0.0;
+        for (unsigned int i = 0; i < num_joints_; i++)
+        {
+          double d = fabs(ik_seed_state[i] - sol[i]);
+          if (d > costs)
+            costs = d;
+        }
+        candidate_order.push_back(std::make_pair(costs, s));
+      }
+      std::sort(candidate_order.begin(), candidate_order.end());
+
+      for (int s = 0; s < numsol; ++s)
+      {
+        nattempts++;
+        const double* candidate = &candidate_buffer[candidate_order[s].second * num_joints_];
 
         bool obeys_limits = true;
-        for (unsigned int i = 0; i < sol.size(); i++)
+        for (unsigned int i = 0; i < num_joints_; i++)
         {
-          if (joint_has_limits_vector_[i] && (sol[i] < joint_min_vector_[i] || sol[i] > joint_max_vector_[i]))
+          if (joint_has_limits_vector_[i] && (candidate[i] < joint_min_vector_[i] || candidate[i] > joint_max_vector_[i]))
           {
             obeys_limits = false;
             break;
           }
-          // ROS_INFO_STREAM_NAMED(name_,"Num " << i << " value " << sol[i] << " has limits " <<
+          // ROS_INFO_STREAM_NAMED(name_,"Num " << i << " value " << candidate[i] << " has limits " <<
           // joint_has_limits_vector_[i] << " " << joint_min_vector_[i] << " " << joint_max_vector_[i]);
         }
         if (obeys_limits)
         {
-          getSolution(solutions, ik_seed_state, s, solution);
+          solution.assign(candidate, candidate + num_joints_);
 
           // This solution is within joint limits, now check if in collision (if callback provided)
           if (!solution_callback.empty())
@@ -1046,14 +1075,7 @@ bool IKFastKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose
             nvalid++;
             if (search_mode & OPTIMIZE_MAX_JOINT)
             {
-              // Costs for solution: Largest joint motion
-              double costs = 0.0;
-              for (unsigned int i = 0; i < solution.size(); i++)
-              {
-                double d = fabs(ik_seed_state[i] - solution[i]);
-                if (d > costs)
-                  costs = d;
-              }
+              double costs = candidate_order[s].first;
               if (costs < best_costs || best_costs == -1.0)
               {
                 best_costs = costs;
@@ -62,6 +62,8 @@
 #include <moveit/robot_model/robot_model.h>
 #include <moveit/robot_state/robot_state.h>
 
+#include <boost/thread/tss.hpp>
+
 namespace kdl_kinematics_plugin
 {
 /**
@@ -102,6 +104,12 @@ public:
       const IKCallbackFn& solution_callback, moveit_msgs::MoveItErrorCodes& error_code,
       const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
 
+  bool searchPositionIKBatch(
+      const std::vector<geometry_msgs::Pose>& ik_poses, const std::vector<std::vector<double> >& ik_seed_states,
+      double timeout, std::vector<std::vector<double> >& solutions,
+      std::vector<moveit_msgs::MoveItErrorCodes>& error_codes,
+      const kinematics::KinematicsQueryOptions& options = kinematics::KinematicsQueryOptions()) const override;
+
   bool getPositionFK(const std::vector<std::string>& link_names, const std::vector<double>& joint_angles,
                      std::vector<geometry_msgs::Pose>& poses) const override;
 
@@ -146,6 +154,17 @@ protected:
 private:
   bool timedOut(const ros::WallTime& start_time, double duration) const;
 
+  /** @brief Run the iterative search for a single query, using already constructed solvers. When \e warm_start is not
+   * NULL, it is used as the initial configuration for the first solver iteration instead of the seed state; the seed
+   * state still serves as the reference for consistency checks and random restarts */
+  bool searchPositionIKLoop(const geometry_msgs::Pose& ik_pose, const std::vector<double>& ik_seed_state,
+                            double timeout, std::vector<double>& solution, const IKCallbackFn& solution_callback,
+                            moveit_msgs::MoveItErrorCodes& error_code, const std::vector<double>& consistency_limits,
+                            const kinematics::KinematicsQueryOptions& options,
+                            KDL::ChainIkSolverPos_NR_JL_Mimic& ik_solver_pos,
+                            KDL::ChainIkSolverVel_pinv_mimic& ik_solver_vel,
+                            const KDL::JntArray* warm_start = NULL) const;
+
   /** @brief Check whether the solution lies within the consistency limit of the seed state
    *  @param seed_state Seed state
    *  @param redundancy Index of the redundant joint within the chain
@@ -175,6 +194,17 @@ private:
 
   bool isRedundantJoint(unsigned int index) const;
 
+  /** @brief Return this thread's scratch state for drawing random configurations, creating it on first use.
+   * Several threads may run IK through the same solver instance at once (parallel Cartesian solves, parallel
+   * goal sampling), so the random restarts must not share a state (or its random number generator) */
+  robot_state::RobotState& getRandomStateBuffer() const;
+
+  /** @brief Fixed-iteration damped least-squares solve starting at \e jnt_seed_state, with no random restarts.
+   * Intended for seeds that are already close to the solution (e.g. Cartesian path tracking); every iterate is
+   * clamped to the joint limits. Returns true if the pose error converged below epsilon */
+  bool solveDampedLeastSquares(const KDL::Frame& pose_desired, const KDL::JntArray& jnt_seed_state,
+                               KDL::JntArray& jnt_pos_out) const;
+
   bool active_; /** Internal variable that indicates whether solvers are configured and ready */
 
   moveit_msgs::KinematicSolverInfo ik_chain_info_; /** Stores information for the inverse kinematics solver */
@@ -187,10 +217,11 @@ private:
 
   KDL::JntArray joint_min_, joint_max_; /** Joint limits */
 
-  mutable random_numbers::RandomNumberGenerator random_number_generator_;
-
   robot_state::RobotStatePtr state_;
 
+  // per-thread scratch states for random restarts; see getRandomStateBuffer()
+  mutable boost::thread_specific_ptr<robot_state::RobotState> random_state_buffer_;
+
   int num_possible_redundant_joints_;
   std::vector<unsigned int> redundant_joints_map_index_;
 
@@ -200,6 +231,12 @@ private:
   double max_solver_iterations_;
   double epsilon_;
   std::vector<JointMimic> mimic_joints_;
+
+  // thresholds on the seed's pose error below which the damped least-squares warm path is
+  // attempted before the general solver; a distance of 0 disables the warm path
+  double warm_start_distance_;
+  double warm_start_angle_;
+  int warm_start_iterations_;
 };
 }
 
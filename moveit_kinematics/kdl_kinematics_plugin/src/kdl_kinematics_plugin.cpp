@@ -37,6 +37,11 @@
 #include <moveit/kdl_kinematics_plugin/kdl_kinematics_plugin.h>
 #include <class_loader/class_loader.hpp>
 
+#include <kdl/chainjnttojacsolver.hpp>
+#include <kdl/frames.hpp>
+
+#include <algorithm>
+
 #include <tf2_kdl/tf2_kdl.h>
 #include <tf2/transform_datatypes.h>
 
@@ -51,15 +56,30 @@ CLASS_LOADER_REGISTER_CLASS(kdl_kinematics_plugin::KDLKinematicsPlugin, kinemati
 
 namespace kdl_kinematics_plugin
 {
+// damping factor for the warm-start damped least-squares solver
+static const double WARM_START_DLS_DAMPING = 0.05;
+
 KDLKinematicsPlugin::KDLKinematicsPlugin() : active_(false)
 {
 }
 
+robot_state::RobotState& KDLKinematicsPlugin::getRandomStateBuffer() const
+{
+  robot_state::RobotState* buffer = random_state_buffer_.get();
+  if (!buffer)
+  {
+    random_state_buffer_.reset(new robot_state::RobotState(*state_));
+    buffer = random_state_buffer_.get();
+  }
+  return *buffer;
+}
+
 void KDLKinematicsPlugin::getRandomConfiguration(KDL::JntArray& jnt_array, bool lock_redundancy) const
 {
+  robot_state::RobotState& random_state = getRandomStateBuffer();
   std::vector<double> jnt_array_vector(dimension_, 0.0);
-  state_->setToRandomPositions(joint_model_group_);
-  state_->copyJointGroupPositions(joint_model_group_, &jnt_array_vector[0]);
+  random_state.setToRandomPositions(joint_model_group_);
+  random_state.copyJointGroupPositions(joint_model_group_, &jnt_array_vector[0]);
   for (std::size_t i = 0; i < dimension_; ++i)
   {
     if (lock_redundancy)
@@ -95,7 +115,7 @@ void KDLKinematicsPlugin::getRandomConfiguration(const KDL::JntArray& seed_state
     consistency_limits_mimic.push_back(consistency_limits[i]);
   }
 
-  joint_model_group_->getVariableRandomPositionsNearBy(state_->getRandomNumberGenerator(), values, near,
+  joint_model_group_->getVariableRandomPositionsNearBy(getRandomStateBuffer().getRandomNumberGenerator(), values, near,
                                                        consistency_limits_mimic);
 
   for (std::size_t i = 0; i < dimension_; ++i)
@@ -198,6 +218,9 @@ bool KDLKinematicsPlugin::initialize(const moveit::core::RobotModel& robot_model
   lookupParam("max_solver_iterations", max_solver_iterations, 500);
   lookupParam("epsilon", epsilon, 1e-5);
   lookupParam("position_only_ik", position_ik, false);
+  lookupParam("warm_start_distance", warm_start_distance_, 0.02);
+  lookupParam("warm_start_angle", warm_start_angle_, 0.1);
+  lookupParam("warm_start_iterations", warm_start_iterations_, 15);
   ROS_DEBUG_NAMED("kdl", "Looking for param name: position_only_ik");
 
   if (position_ik)
@@ -420,7 +443,6 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
                                            const std::vector<double>& consistency_limits,
                                            const kinematics::KinematicsQueryOptions& options) const
 {
-  ros::WallTime n1 = ros::WallTime::now();
   if (!active_)
   {
     ROS_ERROR_NAMED("kdl", "kinematics not active");
@@ -444,9 +466,44 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
     return false;
   }
 
-  KDL::JntArray jnt_seed_state(dimension_);
-  KDL::JntArray jnt_pos_in(dimension_);
-  KDL::JntArray jnt_pos_out(dimension_);
+  // when the seed is already close to the goal pose (e.g. in Cartesian path tracking), a few
+  // damped least-squares iterations starting at the seed are much cheaper than the general
+  // solver and its random restart machinery
+  if (warm_start_distance_ > 0.0 && consistency_limits.empty() && !options.lock_redundant_joints &&
+      joint_model_group_->getMimicJointModels().empty())
+  {
+    KDL::Frame pose_desired, pose_seed;
+    tf2::fromMsg(ik_pose, pose_desired);
+    KDL::JntArray jnt_seed_state(dimension_);
+    for (unsigned int i = 0; i < dimension_; i++)
+      jnt_seed_state(i) = ik_seed_state[i];
+    KDL::ChainFkSolverPos_recursive fk_solver_seed(kdl_chain_);
+    if (fk_solver_seed.JntToCart(jnt_seed_state, pose_seed) >= 0)
+    {
+      KDL::Twist seed_error = KDL::diff(pose_seed, pose_desired);
+      if (seed_error.vel.Norm() <= warm_start_distance_ &&
+          (position_ik_ || seed_error.rot.Norm() <= warm_start_angle_))
+      {
+        KDL::JntArray jnt_pos_out(dimension_);
+        if (solveDampedLeastSquares(pose_desired, jnt_seed_state, jnt_pos_out))
+        {
+          solution.resize(dimension_);
+          for (unsigned int j = 0; j < dimension_; j++)
+            solution[j] = jnt_pos_out(j);
+          if (!solution_callback.empty())
+            solution_callback(ik_pose, solution, error_code);
+          else
+            error_code.val = error_code.SUCCESS;
+          if (error_code.val == error_code.SUCCESS)
+          {
+            ROS_DEBUG_NAMED("kdl", "Solved with warm-start damped least-squares solver");
+            return true;
+          }
+        }
+        // on failure, fall through to the general solver
+      }
+    }
+  }
 
   KDL::ChainFkSolverPos_recursive fk_solver(kdl_chain_);
   KDL::ChainIkSolverVel_pinv_mimic ik_solver_vel(kdl_chain_, joint_model_group_->getMimicJointModels().size(),
@@ -467,6 +524,26 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
     ik_solver_vel.lockRedundantJoints();
   }
 
+  return searchPositionIKLoop(ik_pose, ik_seed_state, timeout, solution, solution_callback, error_code,
+                              consistency_limits, options, ik_solver_pos, ik_solver_vel);
+}
+
+bool KDLKinematicsPlugin::searchPositionIKLoop(const geometry_msgs::Pose& ik_pose,
+                                               const std::vector<double>& ik_seed_state, double timeout,
+                                               std::vector<double>& solution, const IKCallbackFn& solution_callback,
+                                               moveit_msgs::MoveItErrorCodes& error_code,
+                                               const std::vector<double>& consistency_limits,
+                                               const kinematics::KinematicsQueryOptions& options,
+                                               KDL::ChainIkSolverPos_NR_JL_Mimic& ik_solver_pos,
+                                               KDL::ChainIkSolverVel_pinv_mimic& ik_solver_vel,
+                                               const KDL::JntArray* warm_start) const
+{
+  ros::WallTime n1 = ros::WallTime::now();
+
+  KDL::JntArray jnt_seed_state(dimension_);
+  KDL::JntArray jnt_pos_in(dimension_);
+  KDL::JntArray jnt_pos_out(dimension_);
+
   solution.resize(dimension_);
 
   KDL::Frame pose_desired;
@@ -479,7 +556,7 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
   // Do the IK
   for (unsigned int i = 0; i < dimension_; i++)
     jnt_seed_state(i) = ik_seed_state[i];
-  jnt_pos_in = jnt_seed_state;
+  jnt_pos_in = warm_start ? *warm_start : jnt_seed_state;
 
   unsigned int counter(0);
   while (1)
@@ -540,6 +617,126 @@ bool KDLKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
   return false;
 }
 
+bool KDLKinematicsPlugin::solveDampedLeastSquares(const KDL::Frame& pose_desired, const KDL::JntArray& jnt_seed_state,
+                                                  KDL::JntArray& jnt_pos_out) const
+{
+  KDL::ChainFkSolverPos_recursive fk_solver(kdl_chain_);
+  KDL::ChainJntToJacSolver jac_solver(kdl_chain_);
+  KDL::Jacobian jacobian(dimension_);
+  KDL::Frame pose_current;
+
+  // workspace reused by every iteration
+  Eigen::Matrix<double, 6, 1> pose_error;
+  Eigen::Matrix<double, 6, 6> jjt;
+
+  jnt_pos_out = jnt_seed_state;
+  for (int iteration = 0; iteration < warm_start_iterations_; ++iteration)
+  {
+    if (fk_solver.JntToCart(jnt_pos_out, pose_current) < 0)
+      return false;
+    KDL::Twist delta_twist = KDL::diff(pose_current, pose_desired);
+    if (position_ik_)
+      delta_twist.rot = KDL::Vector::Zero();
+    if (KDL::Equal(delta_twist, KDL::Twist::Zero(), epsilon_))
+      return true;
+    if (jac_solver.JntToJac(jnt_pos_out, jacobian) < 0)
+      return false;
+
+    for (unsigned int i = 0; i < 6; ++i)
+      pose_error(i) = delta_twist(i);
+    jjt.noalias() = jacobian.data * jacobian.data.transpose();
+    jjt.diagonal().array() += WARM_START_DLS_DAMPING * WARM_START_DLS_DAMPING;
+    jnt_pos_out.data.noalias() += jacobian.data.transpose() * jjt.ldlt().solve(pose_error);
+
+    // keep every iterate within the joint limits
+    for (unsigned int i = 0; i < dimension_; ++i)
+      jnt_pos_out(i) = std::min(std::max(jnt_pos_out(i), joint_min_(i)), joint_max_(i));
+  }
+
+  // the iteration budget is exhausted; accept the result only if it converged
+  if (fk_solver.JntToCart(jnt_pos_out, pose_current) < 0)
+    return false;
+  KDL::Twist delta_twist = KDL::diff(pose_current, pose_desired);
+  if (position_ik_)
+    delta_twist.rot = KDL::Vector::Zero();
+  return KDL::Equal(delta_twist, KDL::Twist::Zero(), epsilon_);
+}
+
+bool KDLKinematicsPlugin::searchPositionIKBatch(const std::vector<geometry_msgs::Pose>& ik_poses,
+                                                const std::vector<std::vector<double> >& ik_seed_states, double timeout,
+                                                std::vector<std::vector<double> >& solutions,
+                                                std::vector<moveit_msgs::MoveItErrorCodes>& error_codes,
+                                                const kinematics::KinematicsQueryOptions& options) const
+{
+  if (!active_)
+  {
+    ROS_ERROR_NAMED("kdl", "kinematics not active");
+    return false;
+  }
+
+  if (ik_poses.size() != ik_seed_states.size())
+  {
+    ROS_ERROR_NAMED("kdl", "Number of seed states (%zu) does not match number of poses (%zu)", ik_seed_states.size(),
+                    ik_poses.size());
+    return false;
+  }
+
+  // construct the solvers once and share their workspace across all queries of the batch
+  KDL::ChainFkSolverPos_recursive fk_solver(kdl_chain_);
+  KDL::ChainIkSolverVel_pinv_mimic ik_solver_vel(kdl_chain_, joint_model_group_->getMimicJointModels().size(),
+                                                 redundant_joint_indices_.size(), position_ik_);
+  KDL::ChainIkSolverPos_NR_JL_Mimic ik_solver_pos(kdl_chain_, joint_min_, joint_max_, fk_solver, ik_solver_vel,
+                                                  max_solver_iterations_, epsilon_, position_ik_);
+  ik_solver_vel.setMimicJoints(mimic_joints_);
+  ik_solver_pos.setMimicJoints(mimic_joints_);
+
+  if ((redundant_joint_indices_.size() > 0) && !ik_solver_vel.setRedundantJointsMapIndex(redundant_joints_map_index_))
+  {
+    ROS_ERROR_NAMED("kdl", "Could not set redundant joints");
+    return false;
+  }
+
+  if (options.lock_redundant_joints)
+  {
+    ik_solver_vel.lockRedundantJoints();
+  }
+
+  solutions.resize(ik_poses.size());
+  error_codes.resize(ik_poses.size());
+
+  const IKCallbackFn solution_callback = 0;
+  std::vector<double> consistency_limits;
+
+  // batch queries (e.g. grasp candidates) tend to be clustered in the workspace, so the solution of
+  // the previous query is a good initial configuration for the next one
+  KDL::JntArray last_solution(dimension_);
+  bool have_last_solution = false;
+  bool any_solved = false;
+  for (std::size_t i = 0; i < ik_poses.size(); ++i)
+  {
+    solutions[i].clear();
+    if (ik_seed_states[i].size() != dimension_)
+    {
+      ROS_ERROR_STREAM_NAMED("kdl", "Seed state must have size " << dimension_ << " instead of size "
+                                                                 << ik_seed_states[i].size());
+      error_codes[i].val = moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION;
+      continue;
+    }
+    if (searchPositionIKLoop(ik_poses[i], ik_seed_states[i], timeout, solutions[i], solution_callback, error_codes[i],
+                             consistency_limits, options, ik_solver_pos, ik_solver_vel,
+                             have_last_solution ? &last_solution : NULL))
+    {
+      any_solved = true;
+      for (unsigned int j = 0; j < dimension_; ++j)
+        last_solution(j) = solutions[i][j];
+      have_last_solution = true;
+    }
+    else
+      solutions[i].clear();
+  }
+  return any_solved;
+}
+
 bool KDLKinematicsPlugin::getPositionFK(const std::vector<std::string>& link_names,
                                         const std::vector<double>& joint_angles,
                                         std::vector<geometry_msgs::Pose>& poses) const
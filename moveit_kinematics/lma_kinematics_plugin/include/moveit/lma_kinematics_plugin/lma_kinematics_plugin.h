@@ -52,11 +52,16 @@
 #include <kdl/jntarray.hpp>
 #include <kdl/chainiksolvervel_pinv.hpp>
 #include <kdl/chainiksolverpos_nr_jl.hpp>
+#include <kdl/chainiksolverpos_lma.hpp>
 #include <kdl/chainfksolverpos_recursive.hpp>
 #include <moveit/lma_kinematics_plugin/chainiksolver_pos_lma_jl_mimic.h>
 #include <moveit/lma_kinematics_plugin/chainiksolver_vel_pinv_mimic.h>
 #include <moveit/lma_kinematics_plugin/joint_mimic.h>
 
+#include <boost/thread/tss.hpp>
+#include <atomic>
+#include <memory>
+
 // MoveIt!
 #include <moveit/kinematics_base/kinematics_base.h>
 #include <moveit/robot_state/robot_state.h>
@@ -119,6 +124,12 @@ public:
    */
   const std::vector<std::string>& getLinkNames() const override;
 
+  /**
+   * @brief  Discard the per-thread solver workspaces; they are rebuilt lazily on the next query.
+   * This is called automatically when the set of redundant joints changes.
+   */
+  void resetSolverWorkspace();
+
 protected:
   /**
    * @brief Given a desired pose of the end-effector, search for the joint angles required to reach it.
@@ -175,6 +186,24 @@ private:
 
   bool isRedundantJoint(unsigned int index) const;
 
+  /** @brief Persistent per-thread solver workspace, so the chain solvers and their internal matrix
+   * storage are not reconstructed on every IK query */
+  struct SolverWorkspace
+  {
+    std::unique_ptr<KDL::ChainFkSolverPos_recursive> fk_solver;
+    std::unique_ptr<KDL::ChainIkSolverPos_LMA> lma_solver;
+    std::unique_ptr<KDL::ChainIkSolverVel_pinv_mimic> ik_solver_vel;
+    std::unique_ptr<KDL::ChainIkSolverPos_LMA_JL_Mimic> ik_solver_pos;
+    KDL::JntArray jnt_seed_state;
+    KDL::JntArray jnt_pos_in;
+    KDL::JntArray jnt_pos_out;
+    unsigned int epoch;
+  };
+
+  /** @brief Return this thread's solver workspace, (re)building it if it does not exist yet or was
+   * invalidated by resetSolverWorkspace() */
+  SolverWorkspace& getSolverWorkspace() const;
+
   bool active_; /** Internal variable that indicates whether solvers are configured and ready */
 
   moveit_msgs::KinematicSolverInfo ik_chain_info_; /** Stores information for the inverse kinematics solver */
@@ -200,6 +229,14 @@ private:
   double max_solver_iterations_;
   double epsilon_;
   std::vector<JointMimic> mimic_joints_;
+
+  // task-space error weights and joint-space convergence threshold for the LMA solver
+  Eigen::Matrix<double, 6, 1> lma_weights_;
+  double eps_joints_;
+
+  // per-thread solver workspaces; bumping the epoch counter invalidates them
+  mutable boost::thread_specific_ptr<SolverWorkspace> solver_workspace_;
+  mutable std::atomic<unsigned int> workspace_epoch_;
 };
 }
 
@@ -49,7 +49,7 @@ CLASS_LOADER_REGISTER_CLASS(lma_kinematics_plugin::LMAKinematicsPlugin, kinemati
 
 namespace lma_kinematics_plugin
 {
-LMAKinematicsPlugin::LMAKinematicsPlugin() : active_(false)
+LMAKinematicsPlugin::LMAKinematicsPlugin() : active_(false), workspace_epoch_(0)
 {
 }
 
@@ -191,13 +191,25 @@ bool LMAKinematicsPlugin::initialize(const moveit::core::RobotModel& robot_model
   // Get Solver Parameters
   int max_solver_iterations;
   double epsilon;
+  double orientation_weight;
   bool position_ik;
 
   lookupParam("max_solver_iterations", max_solver_iterations, 500);
   lookupParam("epsilon", epsilon, 1e-5);
+  // weight of the orientation error relative to the position error in the LMA cost function
+  lookupParam("orientation_weight", orientation_weight, 0.01);
+  // joint-space increment below which the LMA iteration is considered stuck
+  lookupParam("eps_joints", eps_joints_, 1e-15);
   lookupParam("position_only_ik", position_ik, false);
   ROS_DEBUG_NAMED("lma", "Looking for param name: position_only_ik");
 
+  lma_weights_(0) = 1;
+  lma_weights_(1) = 1;
+  lma_weights_(2) = 1;
+  lma_weights_(3) = orientation_weight;
+  lma_weights_(4) = orientation_weight;
+  lma_weights_(5) = orientation_weight;
+
   if (position_ik)
     ROS_INFO_NAMED("lma", "Using position only ik");
 
@@ -264,11 +276,49 @@ bool LMAKinematicsPlugin::initialize(const moveit::core::RobotModel& robot_model
   max_solver_iterations_ = max_solver_iterations;
   epsilon_ = epsilon;
 
+  // invalidate any solver workspaces built for a previous configuration
+  resetSolverWorkspace();
+
   active_ = true;
   ROS_DEBUG_NAMED("lma", "KDL solver initialized");
   return true;
 }
 
+void LMAKinematicsPlugin::resetSolverWorkspace()
+{
+  // bumping the epoch makes every thread rebuild its workspace on the next query
+  ++workspace_epoch_;
+}
+
+LMAKinematicsPlugin::SolverWorkspace& LMAKinematicsPlugin::getSolverWorkspace() const
+{
+  SolverWorkspace* workspace = solver_workspace_.get();
+  unsigned int epoch = workspace_epoch_.load();
+  if (workspace && workspace->epoch == epoch)
+    return *workspace;
+
+  if (!workspace)
+  {
+    solver_workspace_.reset(new SolverWorkspace);
+    workspace = solver_workspace_.get();
+  }
+  workspace->epoch = epoch;
+  workspace->fk_solver.reset(new KDL::ChainFkSolverPos_recursive(kdl_chain_));
+  workspace->lma_solver.reset(
+      new KDL::ChainIkSolverPos_LMA(kdl_chain_, lma_weights_, epsilon_, max_solver_iterations_, eps_joints_));
+  workspace->ik_solver_vel.reset(new KDL::ChainIkSolverVel_pinv_mimic(
+      kdl_chain_, joint_model_group_->getMimicJointModels().size(), redundant_joint_indices_.size(), position_ik_));
+  workspace->ik_solver_pos.reset(
+      new KDL::ChainIkSolverPos_LMA_JL_Mimic(kdl_chain_, joint_min_, joint_max_, *workspace->fk_solver,
+                                             *workspace->lma_solver, max_solver_iterations_, epsilon_, position_ik_));
+  workspace->ik_solver_vel->setMimicJoints(mimic_joints_);
+  workspace->ik_solver_pos->setMimicJoints(mimic_joints_);
+  workspace->jnt_seed_state.resize(dimension_);
+  workspace->jnt_pos_in.resize(dimension_);
+  workspace->jnt_pos_out.resize(dimension_);
+  return *workspace;
+}
+
 bool LMAKinematicsPlugin::setRedundantJoints(const std::vector<unsigned int>& redundant_joints)
 {
   if (num_possible_redundant_joints_ < 0)
@@ -325,6 +375,7 @@ bool LMAKinematicsPlugin::setRedundantJoints(const std::vector<unsigned int>& re
 
   redundant_joints_map_index_ = redundant_joints_map_index;
   redundant_joint_indices_ = redundant_joints;
+  resetSolverWorkspace();
   return true;
 }
 
@@ -442,27 +493,13 @@ bool LMAKinematicsPlugin::searchPositionIK(const geometry_msgs::Pose& ik_pose, c
     return false;
   }
 
-  KDL::JntArray jnt_seed_state(dimension_);
-  KDL::JntArray jnt_pos_in(dimension_);
-  KDL::JntArray jnt_pos_out(dimension_);
-
-  // Build Solvers
-  Eigen::Matrix<double, 6, 1> L;
-  L(0) = 1;
-  L(1) = 1;
-  L(2) = 1;
-  L(3) = 0.01;
-  L(4) = 0.01;
-  L(5) = 0.01;
-
-  KDL::ChainFkSolverPos_recursive fk_solver(kdl_chain_);
-  KDL::ChainIkSolverPos_LMA ik_solver(kdl_chain_, L, epsilon_, max_solver_iterations_);
-  KDL::ChainIkSolverVel_pinv_mimic ik_solver_vel(kdl_chain_, joint_model_group_->getMimicJointModels().size(),
-                                                 redundant_joint_indices_.size(), position_ik_);
-  KDL::ChainIkSolverPos_LMA_JL_Mimic ik_solver_pos(kdl_chain_, joint_min_, joint_max_, fk_solver, ik_solver,
-                                                   max_solver_iterations_, epsilon_, position_ik_);
-  ik_solver_vel.setMimicJoints(mimic_joints_);
-  ik_solver_pos.setMimicJoints(mimic_joints_);
+  // Use this thread's persistent solvers and joint arrays instead of rebuilding them per call
+  SolverWorkspace& workspace = getSolverWorkspace();
+  KDL::JntArray& jnt_seed_state = workspace.jnt_seed_state;
+  KDL::JntArray& jnt_pos_in = workspace.jnt_pos_in;
+  KDL::JntArray& jnt_pos_out = workspace.jnt_pos_out;
+  KDL::ChainIkSolverVel_pinv_mimic& ik_solver_vel = *workspace.ik_solver_vel;
+  KDL::ChainIkSolverPos_LMA_JL_Mimic& ik_solver_pos = *workspace.ik_solver_pos;
 
   if ((redundant_joint_indices_.size() > 0) && !ik_solver_vel.setRedundantJointsMapIndex(redundant_joints_map_index_))
   {
@@ -571,7 +608,7 @@ bool LMAKinematicsPlugin::getPositionFK(const std::vector<std::string>& link_nam
     jnt_pos_in(i) = joint_angles[i];
   }
 
-  KDL::ChainFkSolverPos_recursive fk_solver(kdl_chain_);
+  KDL::ChainFkSolverPos_recursive& fk_solver = *getSolverWorkspace().fk_solver;
 
   bool valid = true;
   for (unsigned int i = 0; i < poses.size(); i++)
@@ -46,7 +46,12 @@
 #include <ros/ros.h>
 
 // System
+#include <condition_variable>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 
 // ROS msgs
 #include <geometry_msgs/PoseStamped.h>
@@ -144,6 +149,16 @@ private:
 
   bool isRedundantJoint(unsigned int index) const;
 
+  /** @brief Build the memoization key for a query by quantizing the poses and the seed state */
+  std::vector<long> makeCacheKey(const std::vector<geometry_msgs::Pose>& ik_poses,
+                                 const std::vector<double>& ik_seed_state,
+                                 const kinematics::KinematicsQueryOptions& options) const;
+
+  /** @brief Perform the actual round trip over the IK service; fills in \e solution and \e error_code.
+   * Returns false on transport failure (in which case the result must not be memoized) */
+  bool callIKService(const std::vector<geometry_msgs::Pose>& ik_poses, const std::vector<double>& ik_seed_state,
+                     std::vector<double>& solution, moveit_msgs::MoveItErrorCodes& error_code) const;
+
   bool active_; /** Internal variable that indicates whether solvers are configured and ready */
 
   moveit_msgs::KinematicSolverInfo ik_group_info_; /** Stores information for the inverse kinematics solver */
@@ -157,6 +172,25 @@ private:
   int num_possible_redundant_joints_;
 
   std::shared_ptr<ros::ServiceClient> ik_service_client_;
+
+  /** a memoized IK response (the solver's answer, successful or not) */
+  struct IKCacheEntry
+  {
+    std::vector<double> solution;
+    int error_code;
+    std::list<std::vector<long> >::iterator lru_position;
+  };
+
+  // client-side LRU memoization of service responses, keyed by quantized poses + seed state;
+  // concurrent callers with the same key share a single in-flight service call
+  unsigned int ik_cache_size_;        /** maximum number of memoized responses; 0 disables the cache */
+  double ik_cache_pose_resolution_;   /** quantization step for pose coordinates in the cache key */
+  double ik_cache_joint_resolution_;  /** quantization step for seed joint values in the cache key */
+  mutable std::map<std::vector<long>, IKCacheEntry> ik_cache_;
+  mutable std::list<std::vector<long> > ik_cache_lru_; /** most recently used keys at the front */
+  mutable std::set<std::vector<long> > ik_requests_in_flight_;
+  mutable std::mutex ik_cache_mutex_;
+  mutable std::condition_variable ik_cache_condition_;
 };
 }
 
@@ -37,6 +37,8 @@
 #include <moveit/srv_kinematics_plugin/srv_kinematics_plugin.h>
 #include <class_loader/class_loader.hpp>
 
+#include <cmath>
+
 // URDF, SRDF
 #include <urdf_model/model.h>
 #include <srdfdom/model.h>
@@ -114,6 +116,15 @@ bool SrvKinematicsPlugin::initialize(const moveit::core::RobotModel& robot_model
   std::string ik_service_name;
   lookupParam("kinematics_solver_service_name", ik_service_name, std::string("solve_ik"));
 
+  // Client-side memoization of service responses
+  int ik_cache_size;
+  lookupParam("ik_cache_size", ik_cache_size, 1024);
+  ik_cache_size_ = ik_cache_size < 0 ? 0 : ik_cache_size;
+  lookupParam("ik_cache_pose_resolution", ik_cache_pose_resolution_, 1e-4);
+  lookupParam("ik_cache_joint_resolution", ik_cache_joint_resolution_, 1e-3);
+  ik_cache_.clear();
+  ik_cache_lru_.clear();
+
   // Setup the joint state groups that we need
   robot_state_.reset(new robot_state::RobotState(robot_model_));
   robot_state_->setToDefaultValues();
@@ -275,6 +286,130 @@ bool SrvKinematicsPlugin::searchPositionIK(const std::vector<geometry_msgs::Pose
     return false;
   }
 
+  // Short-circuit repeat queries with a memoized response; concurrent callers asking for the
+  // same quantized query share a single service round trip
+  std::vector<long> cache_key;
+  bool have_solution = false;
+  bool owns_request = false;
+  if (ik_cache_size_ > 0)
+  {
+    cache_key = makeCacheKey(ik_poses, ik_seed_state, options);
+    std::unique_lock<std::mutex> lock(ik_cache_mutex_);
+    while (!have_solution)
+    {
+      auto it = ik_cache_.find(cache_key);
+      if (it != ik_cache_.end())
+      {
+        // move the entry to the front of the LRU list
+        ik_cache_lru_.splice(ik_cache_lru_.begin(), ik_cache_lru_, it->second.lru_position);
+        error_code.val = it->second.error_code;
+        if (error_code.val != error_code.SUCCESS)
+        {
+          ROS_DEBUG_NAMED("srv", "Returning memoized IK failure");
+          return false;
+        }
+        ROS_DEBUG_NAMED("srv", "Returning memoized IK solution");
+        solution = it->second.solution;
+        have_solution = true;
+      }
+      else if (ik_requests_in_flight_.count(cache_key))
+      {
+        // another caller is already performing this exact query; wait for its response
+        ik_cache_condition_.wait(lock);
+      }
+      else
+      {
+        ik_requests_in_flight_.insert(cache_key);
+        owns_request = true;
+      }
+      if (owns_request)
+        break;
+    }
+  }
+
+  if (!have_solution)
+  {
+    bool service_ok = callIKService(ik_poses, ik_seed_state, solution, error_code);
+    if (owns_request)
+    {
+      std::lock_guard<std::mutex> lock(ik_cache_mutex_);
+      ik_requests_in_flight_.erase(cache_key);
+      if (service_ok)
+      {
+        // memoize the solver's answer, successful or not, evicting the least recently used entry
+        ik_cache_lru_.push_front(cache_key);
+        IKCacheEntry& entry = ik_cache_[cache_key];
+        entry.solution = solution;
+        entry.error_code = error_code.val;
+        entry.lru_position = ik_cache_lru_.begin();
+        if (ik_cache_.size() > ik_cache_size_)
+        {
+          ik_cache_.erase(ik_cache_lru_.back());
+          ik_cache_lru_.pop_back();
+        }
+      }
+      ik_cache_condition_.notify_all();
+    }
+    if (!service_ok || error_code.val != error_code.SUCCESS)
+      return false;
+  }
+
+  // Run the solution callback (i.e. collision checker) if available
+  if (!solution_callback.empty())
+  {
+    ROS_DEBUG_STREAM_NAMED("srv", "Calling solution callback on IK solution");
+
+    // hack: should use all poses, not just the 0th
+    solution_callback(ik_poses[0], solution, error_code);
+
+    if (error_code.val != error_code.SUCCESS)
+    {
+      switch (error_code.val)
+      {
+        case moveit_msgs::MoveItErrorCodes::FAILURE:
+          ROS_ERROR_STREAM_NAMED("srv", "IK solution callback failed with with error code: FAILURE");
+          break;
+        case moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION:
+          ROS_ERROR_STREAM_NAMED("srv", "IK solution callback failed with with error code: "
+                                        "NO IK SOLUTION");
+          break;
+        default:
+          ROS_ERROR_STREAM_NAMED("srv", "IK solution callback failed with with error code: " << error_code.val);
+      }
+      return false;
+    }
+  }
+
+  ROS_INFO_STREAM_NAMED("srv", "IK Solver Succeeded!");
+  return true;
+}
+
+std::vector<long> SrvKinematicsPlugin::makeCacheKey(const std::vector<geometry_msgs::Pose>& ik_poses,
+                                                    const std::vector<double>& ik_seed_state,
+                                                    const kinematics::KinematicsQueryOptions& options) const
+{
+  std::vector<long> key;
+  key.reserve(7 * ik_poses.size() + ik_seed_state.size() + 1);
+  key.push_back(options.return_approximate_solution ? 1 : 0);
+  for (const geometry_msgs::Pose& pose : ik_poses)
+  {
+    key.push_back(std::lround(pose.position.x / ik_cache_pose_resolution_));
+    key.push_back(std::lround(pose.position.y / ik_cache_pose_resolution_));
+    key.push_back(std::lround(pose.position.z / ik_cache_pose_resolution_));
+    key.push_back(std::lround(pose.orientation.x / ik_cache_pose_resolution_));
+    key.push_back(std::lround(pose.orientation.y / ik_cache_pose_resolution_));
+    key.push_back(std::lround(pose.orientation.z / ik_cache_pose_resolution_));
+    key.push_back(std::lround(pose.orientation.w / ik_cache_pose_resolution_));
+  }
+  for (double value : ik_seed_state)
+    key.push_back(std::lround(value / ik_cache_joint_resolution_));
+  return key;
+}
+
+bool SrvKinematicsPlugin::callIKService(const std::vector<geometry_msgs::Pose>& ik_poses,
+                                        const std::vector<double>& ik_seed_state, std::vector<double>& solution,
+                                        moveit_msgs::MoveItErrorCodes& error_code) const
+{
   // Create the service message
   moveit_msgs::GetPositionIK ik_srv;
   ik_srv.request.ik_request.avoid_collisions = true;
@@ -328,7 +463,8 @@ bool SrvKinematicsPlugin::searchPositionIK(const std::vector<geometry_msgs::Pose
         default:
           ROS_ERROR_STREAM_NAMED("srv", "Service failed with with error code: " << error_code.val);
       }
-      return false;
+      // the solver gave a definitive answer, so the failure can be memoized
+      return true;
     }
   }
   else
@@ -350,33 +486,6 @@ bool SrvKinematicsPlugin::searchPositionIK(const std::vector<geometry_msgs::Pose
   // Get just the joints we are concerned about in our planning group
   robot_state_->copyJointGroupPositions(joint_model_group_, solution);
 
-  // Run the solution callback (i.e. collision checker) if available
-  if (!solution_callback.empty())
-  {
-    ROS_DEBUG_STREAM_NAMED("srv", "Calling solution callback on IK solution");
-
-    // hack: should use all poses, not just the 0th
-    solution_callback(ik_poses[0], solution, error_code);
-
-    if (error_code.val != error_code.SUCCESS)
-    {
-      switch (error_code.val)
-      {
-        case moveit_msgs::MoveItErrorCodes::FAILURE:
-          ROS_ERROR_STREAM_NAMED("srv", "IK solution callback failed with with error code: FAILURE");
-          break;
-        case moveit_msgs::MoveItErrorCodes::NO_IK_SOLUTION:
-          ROS_ERROR_STREAM_NAMED("srv", "IK solution callback failed with with error code: "
-                                        "NO IK SOLUTION");
-          break;
-        default:
-          ROS_ERROR_STREAM_NAMED("srv", "IK solution callback failed with with error code: " << error_code.val);
-      }
-      return false;
-    }
-  }
-
-  ROS_INFO_STREAM_NAMED("srv", "IK Solver Succeeded!");
   return true;
 }
 
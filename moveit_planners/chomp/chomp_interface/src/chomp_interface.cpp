@@ -73,5 +73,9 @@ void CHOMPInterface::loadParams()
             std::string("quintic-spline"));
   nh_.param("enable_failure_recovery", params_.enable_failure_recovery_, false);
   nh_.param("max_recovery_attempts", params_.max_recovery_attempts_, 5);
+  nh_.param("enable_warm_start", params_.enable_warm_start_, false);
+  nh_.param("cost_plateau_threshold", params_.cost_plateau_threshold_, 1e-4);
+  nh_.param("cost_plateau_window", params_.cost_plateau_window_, 10);
+  nh_.param("evaluation_threads", params_.evaluation_threads_, 1);
 }
 }
@@ -95,6 +95,16 @@ public:
                                   /// an initial path is not found with the specified chomp parameters
   int max_recovery_attempts_;     /// this the maximum recovery attempts to find a collision free path after an initial
                                   /// failure to find a solution
+
+  bool enable_warm_start_;  /// if set to true, ChompPlanner seeds the optimization from the previous solution of the
+                            /// same group (or a trajectory supplied through setWarmStartTrajectory()) instead of the
+                            /// configured trajectory initialization method
+  double cost_plateau_threshold_;  /// relative cost improvement over the plateau window below which the optimization
+                                   /// terminates early; 0 disables plateau detection
+  int cost_plateau_window_;  /// number of iterations over which the cost improvement is measured for early termination
+
+  int evaluation_threads_;  /// number of OpenMP threads used to evaluate the collision gradient and collision cost
+                            /// across trajectory points; 1 keeps the serial code path
 };
 
 }  // namespace chomp
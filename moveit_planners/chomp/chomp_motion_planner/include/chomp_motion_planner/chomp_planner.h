@@ -41,6 +41,11 @@
 #include <moveit_msgs/MotionPlanDetailedResponse.h>
 #include <moveit_msgs/MotionPlanRequest.h>
 #include <moveit/planning_scene/planning_scene.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+#include <map>
+#include <mutex>
+#include <string>
 
 namespace chomp
 {
@@ -52,6 +57,22 @@ public:
 
   bool solve(const planning_scene::PlanningSceneConstPtr& planning_scene, const moveit_msgs::MotionPlanRequest& req,
              const ChompParameters& params, moveit_msgs::MotionPlanDetailedResponse& res) const;
+
+  /**
+   * \brief Supply a trajectory (e.g. a previous solution or a path computed by OMPL) to seed the
+   * next optimization for the given group, used when ChompParameters::enable_warm_start_ is set.
+   * With warm starting enabled, solve() also stores its own solutions here, so consecutive
+   * requests with near-identical goals start from an almost converged trajectory.
+   */
+  void setWarmStartTrajectory(const std::string& group, const trajectory_msgs::JointTrajectory& trajectory) const;
+
+  /** \brief Discard all stored warm-start trajectories */
+  void clearWarmStartTrajectories() const;
+
+private:
+  // solve() is const but caches its solutions for warm starting the next request
+  mutable std::mutex warm_start_lock_;
+  mutable std::map<std::string, trajectory_msgs::JointTrajectory> warm_start_trajectories_;
 };
 }
 
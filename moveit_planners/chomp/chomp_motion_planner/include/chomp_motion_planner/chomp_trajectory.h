@@ -139,6 +139,13 @@ public:
    */
   bool fillInFromTrajectory(moveit_msgs::MotionPlanDetailedResponse& res);
 
+  /**
+   * \brief Receives a joint trajectory (e.g., the solution of a previous request or a trajectory
+   * produced by OMPL) and resamples it onto the trajectory points required for CHOMP
+   * @param trajectory the input joint trajectory; must have at least two points
+   */
+  bool fillInFromJointTrajectory(const trajectory_msgs::JointTrajectory& trajectory);
+
   /**
    * This function assigns the chomp_trajectory row / robot pose at index 'chomp_trajectory_point' obtained from input
    * trajectory_msgs at index 'trajectory_msgs_point'
@@ -147,7 +154,7 @@ public:
    * @param trajectory_msgs_point index of the input trajectory_msg's point to get joint values from
    * @param chomp_trajectory_point index of the chomp_trajectory's point to get joint values from
    */
-  void assignCHOMPTrajectoryPointFromInputTrajectoryPoint(moveit_msgs::RobotTrajectory trajectory_msg,
+  void assignCHOMPTrajectoryPointFromInputTrajectoryPoint(const moveit_msgs::RobotTrajectory& trajectory_msg,
                                                           int num_joints_trajectory, int trajectory_msgs_point,
                                                           int chomp_trajectory_point);
 
@@ -151,9 +151,6 @@ void ChompOptimizer::initialize()
   collision_increments_ = Eigen::MatrixXd::Zero(num_vars_free_, num_joints_);
   final_increments_ = Eigen::MatrixXd::Zero(num_vars_free_, num_joints_);
   smoothness_derivative_ = Eigen::VectorXd::Zero(num_vars_all_);
-  jacobian_ = Eigen::MatrixXd::Zero(3, num_joints_);
-  jacobian_pseudo_inverse_ = Eigen::MatrixXd::Zero(num_joints_, 3);
-  jacobian_jacobian_tranpose_ = Eigen::MatrixXd::Zero(3, 3);
   random_state_ = Eigen::VectorXd::Zero(num_joints_);
   joint_state_velocities_ = Eigen::VectorXd::Zero(num_joints_);
 
@@ -321,6 +318,7 @@ bool ChompOptimizer::optimize()
   // int currentCostIter = 0;
   int costWindow = 10;
   std::vector<double> costs(costWindow, 0.0);
+  std::vector<double> cost_history;  // total cost per iteration, used for plateau detection
   // double minimaThreshold = 0.05;
   bool should_break_out = false;
 
@@ -370,6 +368,24 @@ bool ChompOptimizer::optimize()
         last_improvement_iteration_ = iteration_;
       }
     }
+
+    // terminate early when the cost has plateaued: compare against the cost from
+    // 'cost_plateau_window_' iterations ago and stop once the relative improvement is negligible
+    if (parameters_->cost_plateau_threshold_ > 0.0 && parameters_->cost_plateau_window_ > 0)
+    {
+      cost_history.push_back(cost);
+      if ((int)cost_history.size() > parameters_->cost_plateau_window_)
+      {
+        double previous_cost = cost_history[cost_history.size() - 1 - parameters_->cost_plateau_window_];
+        if (previous_cost - cost < parameters_->cost_plateau_threshold_ * fabs(previous_cost))
+        {
+          ROS_INFO("Cost improvement plateaued at iteration %d (cost %f); terminating early", iteration_, cost);
+          iteration_++;
+          break;
+        }
+      }
+    }
+
     calculateSmoothnessIncrements();
     calculateCollisionIncrements();
     calculateTotalIncrements();
@@ -606,15 +622,6 @@ void ChompOptimizer::calculateSmoothnessIncrements()
 
 void ChompOptimizer::calculateCollisionIncrements()
 {
-  double potential;
-  double vel_mag_sq;
-  double vel_mag;
-  Eigen::Vector3d potential_gradient;
-  Eigen::Vector3d normalized_velocity;
-  Eigen::Matrix3d orthogonal_projector;
-  Eigen::Vector3d curvature_vector;
-  Eigen::Vector3d cartesian_gradient;
-
   collision_increments_.setZero(num_vars_free_, num_joints_);
 
   int startPoint = 0;
@@ -636,38 +643,50 @@ void ChompOptimizer::calculateCollisionIncrements()
     startPoint = free_vars_start_;
   }
 
+// Each trajectory point writes a distinct row of collision_increments_ and only reads the
+// collision point arrays filled in by performForwardKinematics(), so the points can be
+// processed independently; the jacobian scratch lives inside the loop body so that every
+// OpenMP thread has its own copy. With stochastic descent only one point is processed,
+// so the parallel region is not entered.
+#pragma omp parallel for if (parameters_->evaluation_threads_ > 1 && endPoint > startPoint)                            \
+    num_threads(parameters_->evaluation_threads_)
   for (int i = startPoint; i <= endPoint; i++)
   {
+    Eigen::MatrixXd jacobian = Eigen::MatrixXd::Zero(3, num_joints_);
+    Eigen::MatrixXd jacobian_pseudo_inverse = Eigen::MatrixXd::Zero(num_joints_, 3);
+
     for (int j = 0; j < num_collision_points_; j++)
     {
-      potential = collision_point_potential_[i][j];
+      double potential = collision_point_potential_[i][j];
 
       if (potential < 0.0001)
         continue;
 
-      potential_gradient = -collision_point_potential_gradient_[i][j];
+      Eigen::Vector3d potential_gradient = -collision_point_potential_gradient_[i][j];
 
-      vel_mag = collision_point_vel_mag_[i][j];
-      vel_mag_sq = vel_mag * vel_mag;
+      double vel_mag = collision_point_vel_mag_[i][j];
+      double vel_mag_sq = vel_mag * vel_mag;
 
       // all math from the CHOMP paper:
 
-      normalized_velocity = collision_point_vel_eigen_[i][j] / vel_mag;
-      orthogonal_projector = Eigen::Matrix3d::Identity() - (normalized_velocity * normalized_velocity.transpose());
-      curvature_vector = (orthogonal_projector * collision_point_acc_eigen_[i][j]) / vel_mag_sq;
-      cartesian_gradient = vel_mag * (orthogonal_projector * potential_gradient - potential * curvature_vector);
+      Eigen::Vector3d normalized_velocity = collision_point_vel_eigen_[i][j] / vel_mag;
+      Eigen::Matrix3d orthogonal_projector =
+          Eigen::Matrix3d::Identity() - (normalized_velocity * normalized_velocity.transpose());
+      Eigen::Vector3d curvature_vector = (orthogonal_projector * collision_point_acc_eigen_[i][j]) / vel_mag_sq;
+      Eigen::Vector3d cartesian_gradient =
+          vel_mag * (orthogonal_projector * potential_gradient - potential * curvature_vector);
 
       // pass it through the jacobian transpose to get the increments
-      getJacobian(i, collision_point_pos_eigen_[i][j], collision_point_joint_names_[i][j], jacobian_);
+      getJacobian(i, collision_point_pos_eigen_[i][j], collision_point_joint_names_[i][j], jacobian);
 
       if (parameters_->use_pseudo_inverse_)
       {
-        calculatePseudoInverse();
-        collision_increments_.row(i - free_vars_start_).transpose() -= jacobian_pseudo_inverse_ * cartesian_gradient;
+        calculatePseudoInverse(jacobian, jacobian_pseudo_inverse);
+        collision_increments_.row(i - free_vars_start_).transpose() -= jacobian_pseudo_inverse * cartesian_gradient;
       }
       else
       {
-        collision_increments_.row(i - free_vars_start_).transpose() -= jacobian_.transpose() * cartesian_gradient;
+        collision_increments_.row(i - free_vars_start_).transpose() -= jacobian.transpose() * cartesian_gradient;
       }
 
       /*
@@ -681,11 +700,12 @@ void ChompOptimizer::calculateCollisionIncrements()
   // cout << collision_increments_ << endl;
 }
 
-void ChompOptimizer::calculatePseudoInverse()
+void ChompOptimizer::calculatePseudoInverse(const Eigen::MatrixXd& jacobian,
+                                            Eigen::MatrixXd& jacobian_pseudo_inverse) const
 {
-  jacobian_jacobian_tranpose_ =
-      jacobian_ * jacobian_.transpose() + Eigen::MatrixXd::Identity(3, 3) * parameters_->pseudo_inverse_ridge_factor_;
-  jacobian_pseudo_inverse_ = jacobian_.transpose() * jacobian_jacobian_tranpose_.inverse();
+  Eigen::MatrixXd jacobian_jacobian_tranpose =
+      jacobian * jacobian.transpose() + Eigen::MatrixXd::Identity(3, 3) * parameters_->pseudo_inverse_ridge_factor_;
+  jacobian_pseudo_inverse = jacobian.transpose() * jacobian_jacobian_tranpose.inverse();
 }
 
 void ChompOptimizer::calculateTotalIncrements()
@@ -995,7 +1015,10 @@ void ChompOptimizer::performForwardKinematics()
 
   // ROS_INFO_STREAM("Total dur " << total_dur << " total checks " << end-start+1);
 
-  // now, get the vel and acc for each collision point (using finite differencing)
+// now, get the vel and acc for each collision point (using finite differencing)
+// each trajectory point only writes its own entries of the vel/acc arrays, so the
+// points can be differentiated in parallel
+#pragma omp parallel for if (parameters_->evaluation_threads_ > 1) num_threads(parameters_->evaluation_threads_)
   for (int i = free_vars_start_; i <= free_vars_end_; i++)
   {
     for (int j = 0; j < num_collision_points_; j++)
@@ -68,6 +68,12 @@ ChompParameters::ChompParameters()
   trajectory_initialization_method_ = std::string("quintic-spline");
   enable_failure_recovery_ = false;
   max_recovery_attempts_ = 5;
+
+  enable_warm_start_ = false;
+  cost_plateau_threshold_ = 1e-4;
+  cost_plateau_window_ = 10;
+
+  evaluation_threads_ = 1;
 }
 
 ChompParameters::~ChompParameters()
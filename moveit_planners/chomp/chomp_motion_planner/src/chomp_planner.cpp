@@ -47,6 +47,19 @@ ChompPlanner::ChompPlanner()
 {
 }
 
+void ChompPlanner::setWarmStartTrajectory(const std::string& group,
+                                          const trajectory_msgs::JointTrajectory& trajectory) const
+{
+  std::lock_guard<std::mutex> slock(warm_start_lock_);
+  warm_start_trajectories_[group] = trajectory;
+}
+
+void ChompPlanner::clearWarmStartTrajectories() const
+{
+  std::lock_guard<std::mutex> slock(warm_start_lock_);
+  warm_start_trajectories_.clear();
+}
+
 bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
                          const moveit_msgs::MotionPlanRequest& req, const chomp::ChompParameters& params,
                          moveit_msgs::MotionPlanDetailedResponse& res) const
@@ -139,27 +152,58 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
     return false;
   }
 
-  // fill in an initial trajectory based on user choice from the chomp_config.yaml file
-  if (params.trajectory_initialization_method_.compare("quintic-spline") == 0)
-    trajectory.fillInMinJerk();
-  else if (params.trajectory_initialization_method_.compare("linear") == 0)
-    trajectory.fillInLinearInterpolation();
-  else if (params.trajectory_initialization_method_.compare("cubic") == 0)
-    trajectory.fillInCubicInterpolation();
-  else if (params.trajectory_initialization_method_.compare("fillTrajectory") == 0)
+  // seed the optimization from a previously computed trajectory for this group, if available
+  bool warm_started = false;
+  if (params.enable_warm_start_)
   {
-    if (!(trajectory.fillInFromTrajectory(res)))
+    trajectory_msgs::JointTrajectory seed;
     {
-      ROS_ERROR_STREAM_NAMED("chomp_planner", "Input trajectory has less than 2 points, "
-                                              "trajectory must contain at least start and goal state");
-      return false;
+      std::lock_guard<std::mutex> slock(warm_start_lock_);
+      std::map<std::string, trajectory_msgs::JointTrajectory>::const_iterator it =
+          warm_start_trajectories_.find(req.group_name);
+      if (it != warm_start_trajectories_.end())
+        seed = it->second;
+    }
+    if (!seed.points.empty())
+    {
+      // the seed was computed for a previous request; the endpoints must remain the start and
+      // goal of this request
+      const Eigen::MatrixXd start_point = trajectory.getTrajectoryPoint(0);
+      if (trajectory.fillInFromJointTrajectory(seed))
+      {
+        trajectory.getTrajectoryPoint(0) = start_point;
+        trajectory.getTrajectoryPoint(goal_index) = goal_state;
+        warm_started = true;
+        ROS_INFO_NAMED("chomp_planner", "CHOMP trajectory for group '%s' seeded from the previous solution",
+                       req.group_name.c_str());
+      }
     }
   }
-  else
-    ROS_ERROR_STREAM_NAMED("chomp_planner", "invalid interpolation method specified in the chomp_planner file");
 
-  ROS_INFO_NAMED("chomp_planner", "CHOMP trajectory initialized using method: %s ",
-                 (params.trajectory_initialization_method_).c_str());
+  // fill in an initial trajectory based on user choice from the chomp_config.yaml file
+  if (!warm_started)
+  {
+    if (params.trajectory_initialization_method_.compare("quintic-spline") == 0)
+      trajectory.fillInMinJerk();
+    else if (params.trajectory_initialization_method_.compare("linear") == 0)
+      trajectory.fillInLinearInterpolation();
+    else if (params.trajectory_initialization_method_.compare("cubic") == 0)
+      trajectory.fillInCubicInterpolation();
+    else if (params.trajectory_initialization_method_.compare("fillTrajectory") == 0)
+    {
+      if (!(trajectory.fillInFromTrajectory(res)))
+      {
+        ROS_ERROR_STREAM_NAMED("chomp_planner", "Input trajectory has less than 2 points, "
+                                                "trajectory must contain at least start and goal state");
+        return false;
+      }
+    }
+    else
+      ROS_ERROR_STREAM_NAMED("chomp_planner", "invalid interpolation method specified in the chomp_planner file");
+
+    ROS_INFO_NAMED("chomp_planner", "CHOMP trajectory initialized using method: %s ",
+                   (params.trajectory_initialization_method_).c_str());
+  }
 
   // optimize!
   moveit::core::RobotState start_state(planning_scene->getCurrentState());
@@ -298,6 +342,10 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
     }
   }
 
+  // remember the solution so the next request for this group can warm-start from it
+  if (params.enable_warm_start_)
+    setWarmStartTrajectory(req.group_name, res.trajectory[0].joint_trajectory);
+
   return true;
 }
 }
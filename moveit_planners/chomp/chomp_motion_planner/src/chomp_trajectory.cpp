@@ -254,20 +254,25 @@ void ChompTrajectory::fillInMinJerk()
 
 bool ChompTrajectory::fillInFromTrajectory(moveit_msgs::MotionPlanDetailedResponse& res)
 {
-  // create a RobotTrajectory msg to obtain the trajectory from the MotionPlanDetailedResponse object
-  moveit_msgs::RobotTrajectory trajectory_msg = res.trajectory[0];
+  return fillInFromJointTrajectory(res.trajectory[0].joint_trajectory);
+}
 
+bool ChompTrajectory::fillInFromJointTrajectory(const trajectory_msgs::JointTrajectory& trajectory)
+{
   // get the default number of points in the CHOMP trajectory
   int num_chomp_trajectory_points = (*this).getNumPoints();
-  // get the number of points in the response trajectory obtained from OMPL
-  int num_response_points = trajectory_msg.joint_trajectory.points.size();
+  // get the number of points in the input trajectory (e.g. obtained from OMPL or a previous solution)
+  int num_response_points = trajectory.points.size();
 
   // check if input trajectory has less than two states (start and goal), function returns false if condition is true
   if (num_response_points < 2)
     return false;
 
   // get the number of joints for each robot state
-  int num_joints_trajectory = trajectory_msg.joint_trajectory.points[0].positions.size();
+  int num_joints_trajectory = trajectory.points[0].positions.size();
+
+  moveit_msgs::RobotTrajectory trajectory_msg;
+  trajectory_msg.joint_trajectory = trajectory;
 
   // variables for populating the CHOMP trajectory with correct number of trajectory points
   int repeated_factor = num_chomp_trajectory_points / num_response_points;
@@ -310,7 +315,7 @@ bool ChompTrajectory::fillInFromTrajectory(moveit_msgs::MotionPlanDetailedRespon
   return true;
 }
 
-void ChompTrajectory::assignCHOMPTrajectoryPointFromInputTrajectoryPoint(moveit_msgs::RobotTrajectory trajectory_msg,
+void ChompTrajectory::assignCHOMPTrajectoryPointFromInputTrajectoryPoint(const moveit_msgs::RobotTrajectory& trajectory_msg,
                                                                          int num_joints_trajectory,
                                                                          int trajectory_msgs_point_index,
                                                                          int chomp_trajectory_point_index)
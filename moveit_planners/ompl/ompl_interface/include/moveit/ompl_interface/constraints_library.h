@@ -135,6 +135,7 @@ struct ConstraintApproximationConstructionOptions
     , explicit_motions(false)
     , explicit_points_resolution(0.0)
     , max_explicit_points(0)
+    , n_threads(1)
   {
   }
 
@@ -145,6 +146,10 @@ struct ConstraintApproximationConstructionOptions
   bool explicit_motions;
   double explicit_points_resolution;
   unsigned int max_explicit_points;
+
+  /// number of worker threads used for sampling states and computing connections
+  /// (1 keeps the original single-threaded construction; 0 uses all hardware threads)
+  unsigned int n_threads;
 };
 
 struct ConstraintApproximationConstructionResults
@@ -196,6 +201,15 @@ private:
       const moveit_msgs::Constraints& constr_hard, const ConstraintApproximationConstructionOptions& options,
       ConstraintApproximationConstructionResults& result);
 
+  /** \brief Multi-threaded version of constructConstraintApproximation(), used when
+      ConstraintApproximationConstructionOptions::n_threads is not 1. Workers sample states and
+      validate connections independently, each with its own sampler, robot state and constraint
+      set; the shared state storage is updated under a lock. */
+  ompl::base::StateStoragePtr constructConstraintApproximationParallel(
+      const ModelBasedPlanningContextPtr& pcontext, const moveit_msgs::Constraints& constr_sampling,
+      const moveit_msgs::Constraints& constr_hard, const ConstraintApproximationConstructionOptions& options,
+      ConstraintApproximationConstructionResults& result);
+
   const PlanningContextManager& context_manager_;
   std::map<std::string, ConstraintApproximationPtr> constraint_approximations_;
 };
@@ -0,0 +1,90 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2026, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef MOVEIT_OMPL_INTERFACE_DETAIL_CLEARANCE_ADAPTIVE_MOTION_VALIDATOR_
+#define MOVEIT_OMPL_INTERFACE_DETAIL_CLEARANCE_ADAPTIVE_MOTION_VALIDATOR_
+
+#include <ompl/base/MotionValidator.h>
+#include <ompl/base/SpaceInformation.h>
+
+namespace ompl_interface
+{
+class ModelBasedPlanningContext;
+
+/** @class ClearanceAdaptiveMotionValidator
+    @brief Motion validator that spaces its samples along a motion according to obstacle clearance
+
+    The default discrete motion validator samples every motion at the fixed
+    longest-valid-segment resolution. This validator instead asks the state
+    validity checker for the clearance of each sampled state: a state with
+    clearance \e d certifies that every configuration within \e d /
+    \e workspace_factor of it (in the state space metric) is collision free,
+    so the next sample can be placed at the edge of that ball. Near obstacles
+    the certified balls shrink and sampling degrades gracefully to the fixed
+    resolution, giving the same guarantee as the discrete validator.
+
+    \e workspace_factor must upper bound how far any point on the robot can
+    move, in meters, per unit of distance in the state space metric. For an
+    arm with unit joint weights the maximum reach of the robot is such a
+    bound. An underestimate can certify segments that pass through
+    obstacles, so the value should be chosen conservatively. */
+class ClearanceAdaptiveMotionValidator : public ompl::base::MotionValidator
+{
+public:
+  ClearanceAdaptiveMotionValidator(const ompl::base::SpaceInformationPtr& si, double workspace_factor);
+
+  bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2) const override;
+
+  bool checkMotion(const ompl::base::State* s1, const ompl::base::State* s2,
+                   std::pair<ompl::base::State*, double>& last_valid) const override;
+
+private:
+  /** \brief Check the validity of \e state and report its clearance. A
+      clearance of 0 is reported when the checker does not provide a usable
+      distance, which disables ball certification around that sample. */
+  bool clearance(const ompl::base::State* state, double& dist) const;
+
+  /** \brief Walk the motion from \e s1 to \e s2, skipping over certified
+      free balls. On failure \e last_valid_time is set to the interpolation
+      time of the last sample known to be valid (0 if that is \e s1). \e s1
+      is assumed valid and \e s2 is assumed to have been checked already,
+      with clearance \e d2. */
+  bool checkInterior(const ompl::base::State* s1, const ompl::base::State* s2, double d2,
+                     double& last_valid_time) const;
+
+  double workspace_factor_;
+};
+}
+
+#endif
@@ -44,17 +44,30 @@
 #include <moveit/robot_state/robot_state.h>
 #include <moveit/robot_model/joint_model_group.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
 namespace ompl_interface
 {
 class ModelBasedPlanningContext;
 
 /** @class ConstrainedGoalSampler
- *  An interface to the OMPL goal lazy sampler*/
+ *  An interface to the OMPL goal lazy sampler. When more than one sampling thread is requested,
+ *  a pool of IK worker threads continuously fills a queue of valid, de-duplicated goal states
+ *  that the lazy sampling thread consumes, so slow IK retries do not stall goal production. */
 class ConstrainedGoalSampler : public ompl::base::GoalLazySamples
 {
 public:
   ConstrainedGoalSampler(const ModelBasedPlanningContext* pc, kinematic_constraints::KinematicConstraintSetPtr ks,
-                         constraint_samplers::ConstraintSamplerPtr cs = constraint_samplers::ConstraintSamplerPtr());
+                         constraint_samplers::ConstraintSamplerPtr cs = constraint_samplers::ConstraintSamplerPtr(),
+                         unsigned int sampling_threads = 1);
+  ~ConstrainedGoalSampler() override;
 
 private:
   bool sampleUsingConstraintSampler(const ompl::base::GoalLazySamples* gls, ompl::base::State* new_goal);
@@ -63,6 +76,32 @@ private:
   bool checkStateValidity(ompl::base::State* new_goal, const robot_state::RobotState& state,
                           bool verbose = false) const;
 
+  /** \brief Body of one IK worker; samples goal states with its own constraint sampler and scratch
+      robot state and pushes the valid ones into the goal queue */
+  void ikWorkerThread();
+
+  /** \brief Score the quality of a sampled goal state from its workspace clearance and the
+      manipulability of the arm configuration; higher is better. \e state and \e robot_state
+      must describe the same (already updated) configuration. */
+  double scoreGoalState(const ompl::base::State* state, const robot_state::RobotState& robot_state) const;
+
+  /** \brief Add a copy of \e state with the given quality score to the goal reservoir, unless it
+      duplicates an already produced goal state. When the reservoir is full the candidate replaces
+      the worst queued goal if it scores higher and is dropped otherwise.
+      Returns false if the state was rejected as a duplicate. */
+  bool pushGoalState(const ompl::base::State* state, double score);
+
+  /** \brief Take the best-scored produced goal state from the reservoir into \e new_goal, waiting
+      for the workers if it is momentarily empty. Returns false once no more goal states can be
+      produced. */
+  bool popGoalState(const ompl::base::GoalLazySamples* gls, ompl::base::State* new_goal);
+
+  /** \brief Stop the IK workers and discard any goal states still queued */
+  void shutdownWorkers();
+
+  /** \brief Hash the joint values of \e state, used to filter out duplicate goal states */
+  std::uint64_t hashState(const ompl::base::State* state) const;
+
   const ModelBasedPlanningContext* planning_context_;
   kinematic_constraints::KinematicConstraintSetPtr kinematic_constraint_set_;
   constraint_samplers::ConstraintSamplerPtr constraint_sampler_;
@@ -71,6 +110,27 @@ private:
   unsigned int invalid_sampled_constraints_;
   bool warned_invalid_samples_;
   unsigned int verbose_display_;
+
+  /// the IK producer pool; empty when goal sampling runs inline in the lazy sampling thread
+  std::vector<std::thread> ik_workers_;
+  std::atomic<bool> stop_workers_;
+  std::atomic<unsigned int> active_workers_;
+  std::atomic<unsigned int> worker_attempts_;
+
+  /** \brief A produced goal state together with its quality score */
+  struct ScoredGoal
+  {
+    ompl::base::State* state;
+    double score;
+  };
+
+  /// goal states produced by the workers, ordered best score first so the lazy sampling
+  /// thread feeds the planner the highest-quality goals before the marginal ones
+  std::deque<ScoredGoal> goal_queue_;
+  /// hashes of all goal states produced so far, used to reject duplicates
+  std::set<std::uint64_t> goal_hashes_;
+  std::mutex goal_queue_lock_;
+  std::condition_variable goal_queue_cond_;
 };
 }
 
@@ -40,6 +40,14 @@
 #include <moveit/ompl_interface/detail/threadsafe_state_storage.h>
 #include <moveit/collision_detection/collision_common.h>
 #include <ompl/base/StateValidityChecker.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace planning_scene
+{
+class CollisionQuerySession;
+}
 
 namespace ompl_interface
 {
@@ -70,6 +78,23 @@ public:
 
   void setVerbose(bool flag);
 
+  /** \brief Invalidate all entries of the validity cache shared across planner threads, e.g. after the
+      planning scene changed. Implemented by bumping the scene epoch mixed into the cache keys, so it is
+      safe to call while planner threads are running. */
+  void clearValidityCache();
+
+  /// Number of lookups performed in the shared validity cache
+  std::uint64_t getValidityCacheLookups() const
+  {
+    return validity_cache_lookups_.load(std::memory_order_relaxed);
+  }
+
+  /// Number of lookups answered from the shared validity cache
+  std::uint64_t getValidityCacheHits() const
+  {
+    return validity_cache_hits_.load(std::memory_order_relaxed);
+  }
+
 protected:
   bool isValidWithoutCache(const ompl::base::State* state, bool verbose) const;
   bool isValidWithoutCache(const ompl::base::State* state, double& dist, bool verbose) const;
@@ -77,6 +102,22 @@ protected:
   bool isValidWithCache(const ompl::base::State* state, bool verbose) const;
   bool isValidWithCache(const ompl::base::State* state, double& dist, bool verbose) const;
 
+  /** \brief Compute the shared cache key for a state: a hash of its quantized joint values and the
+      current scene epoch */
+  std::uint64_t validityCacheKey(const ompl::base::State* state) const;
+
+  /** \brief Look up \e key in the shared validity cache; on a hit, set \e valid to the cached result
+      and return true */
+  bool lookupValidityCache(std::uint64_t key, bool& valid) const;
+
+  /** \brief Record the result of a validity check in the shared cache */
+  void storeValidityCache(std::uint64_t key, bool valid) const;
+
+  /** \brief Collision query session resolved for the context's current planning scene. One
+      session is kept per planner thread and re-resolved when the scene changes between solves,
+      so the thousands of checks of a solve skip the per-call checker and ACM lookups */
+  const planning_scene::CollisionQuerySession& getCollisionSession() const;
+
   const ModelBasedPlanningContext* planning_context_;
   std::string group_name_;
   TSStateStorage tss_;
@@ -87,6 +128,12 @@ protected:
 
   collision_detection::CollisionRequest collision_request_with_cost_;
   bool verbose_;
+
+  /// lock-free validity cache shared across planner threads; each slot packs a key tag and a validity bit
+  mutable std::vector<std::atomic<std::uint64_t>> validity_cache_;
+  std::atomic<std::uint64_t> scene_epoch_;
+  mutable std::atomic<std::uint64_t> validity_cache_lookups_;
+  mutable std::atomic<std::uint64_t> validity_cache_hits_;
 };
 }
 
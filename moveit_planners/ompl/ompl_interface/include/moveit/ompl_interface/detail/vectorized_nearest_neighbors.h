@@ -0,0 +1,99 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_OMPL_INTERFACE_DETAIL_VECTORIZED_NEAREST_NEIGHBORS_
+#define MOVEIT_OMPL_INTERFACE_DETAIL_VECTORIZED_NEAREST_NEIGHBORS_
+
+#include <moveit/ompl_interface/parameterization/model_based_state_space.h>
+#include <ompl/datastructures/NearestNeighbors.h>
+#include <vector>
+
+namespace ompl_interface
+{
+/** @brief A nearest-neighbor structure over states of a ModelBasedStateSpace that stores the state
+ *  values in structure-of-arrays blocks and evaluates the space metric for a whole block at a time.
+ *
+ *  Queries compute one distance row per call through ModelBasedStateSpace::distanceBlock(), whose
+ *  variable-major layout lets the compiler vectorize across states and handles the wrap-around of
+ *  continuous joints branchlessly. This beats per-pair distance() calls whenever many distances to
+ *  the same query are needed, e.g. when connecting milestones of a roadmap or a constraint
+ *  approximation database. When the space cannot run its flat kernels (multi-variable joints,
+ *  mimic joints, or a custom distance function) all queries transparently fall back to pairwise
+ *  distance computation; the same happens when a distance function is set on this structure.
+ *
+ *  The stored State pointers are not owned and must outlive this structure. Concurrent read-only
+ *  queries (distancesTo(), nearest*() with caller-provided buffers) are safe; add() and remove()
+ *  require external synchronization.
+ */
+class VectorizedNearestNeighbors : public ompl::NearestNeighbors<ompl::base::State*>
+{
+public:
+  VectorizedNearestNeighbors(const ModelBasedStateSpace* space);
+
+  /** @brief A custom distance function disables the block kernels and forces pairwise evaluation */
+  void setDistanceFunction(const DistanceFunction& dist_fun) override;
+
+  bool reportsSortedResults() const override;
+  void clear() override;
+  void add(ompl::base::State* const& data) override;
+  bool remove(ompl::base::State* const& data) override;
+  ompl::base::State* nearest(ompl::base::State* const& data) const override;
+  void nearestK(ompl::base::State* const& data, std::size_t k, std::vector<ompl::base::State*>& nbh) const override;
+  void nearestR(ompl::base::State* const& data, double radius, std::vector<ompl::base::State*>& nbh) const override;
+  std::size_t size() const override;
+  void list(std::vector<ompl::base::State*>& data) const override;
+
+  /** @brief Compute the distance from \e data to every stored state, in insertion order. The caller
+   *  provides the output buffer, which makes concurrent queries from multiple threads safe. */
+  void distancesTo(const ompl::base::State* data, std::vector<double>& distances) const;
+
+private:
+  /// number of states per structure-of-arrays block; also the vectorization-friendly column stride
+  static const unsigned int BLOCK_LANES = 64;
+
+  double distanceToElement(const ompl::base::State* data, std::size_t index) const;
+
+  const ModelBasedStateSpace* space_;
+  unsigned int variable_count_;
+  bool use_block_kernels_;
+
+  /// stored states, in insertion order
+  std::vector<ompl::base::State*> elements_;
+  /// value storage: block b holds the values of states [b * BLOCK_LANES, ...), variable-major;
+  /// variable v of lane j lives at blocks_[b][v * BLOCK_LANES + j]
+  std::vector<std::vector<double> > blocks_;
+};
+}  // namespace ompl_interface
+
+#endif
@@ -47,6 +47,8 @@
 #include <ompl/tools/multiplan/ParallelPlan.h>
 #include <ompl/base/StateStorage.h>
 
+#include <cstdint>
+
 namespace ompl_interface
 {
 namespace ob = ompl::base;
@@ -55,6 +57,7 @@ namespace ot = ompl::tools;
 
 MOVEIT_CLASS_FORWARD(ModelBasedPlanningContext);
 MOVEIT_CLASS_FORWARD(ConstraintsLibrary);
+MOVEIT_CLASS_FORWARD(RoadmapCache);
 
 struct ModelBasedPlanningContextSpecification;
 typedef std::function<ob::PlannerPtr(const ompl::base::SpaceInformationPtr& si, const std::string& name,
@@ -197,6 +200,19 @@ public:
     max_planning_threads_ = max_planning_threads;
   }
 
+  /* \brief Get the processor indices the planning threads of this context are restricted to;
+     an empty set leaves thread placement to the operating system */
+  const std::vector<int>& getPlanningCpuAffinity() const
+  {
+    return planning_cpu_affinity_;
+  }
+
+  /* \brief Restrict the planner and validity checking threads of this context to a set of processors */
+  void setPlanningCpuAffinity(const std::vector<int>& cpus)
+  {
+    planning_cpu_affinity_ = cpus;
+  }
+
   /* \brief Get the maximum solution segment length */
   double getMaximumSolutionSegmentLength() const
   {
@@ -247,6 +263,22 @@ public:
     spec_.constraints_library_ = constraints_library;
   }
 
+  /** \brief Set the cache used to persist and reuse multi-query roadmaps, together with the
+      geometry signature of the planning scene of the current request. The cache is only consulted
+      when the 'multi_query_roadmap' parameter is enabled in the planner configuration. */
+  void setRoadmapCache(const RoadmapCachePtr& roadmap_cache, std::uint64_t scene_signature)
+  {
+    roadmap_cache_ = roadmap_cache;
+    roadmap_scene_signature_ = scene_signature;
+  }
+
+  /** \brief Provide previously computed trajectories (e.g. retrieved from the warehouse) as
+      candidate solutions for this request. Before running the planner, solve() checks the seeds
+      in order: the first one that connects the start state of the request to its goal and is
+      still valid in the current scene is reported as the solution directly, without a cold
+      solve. Seeds that do not check out are ignored. The seeds are dropped by clear(). */
+  void setSeedTrajectories(const std::vector<robot_trajectory::RobotTrajectoryPtr>& seed_trajectories);
+
   bool useStateValidityCache() const
   {
     return use_state_validity_cache_;
@@ -297,6 +329,12 @@ public:
      @param timeout The amount of time allowed to be spent on simplifying the plan*/
   void simplifySolution(double timeout);
 
+  /* @brief Simplify disjoint sections of the solution path concurrently, each worker with its own
+     path simplifier. All workers stop at the deadline, so the best simplification achieved within
+     the given time slice is returned. Used instead of simplifySolution()'s single-threaded pass
+     when the 'simplifier_threads' parameter of the planner configuration is larger than 1. */
+  void parallelSimplifySolution(double timeout);
+
   /* @brief Interpolate the solution*/
   void interpolateSolution();
 
@@ -322,6 +360,26 @@ protected:
   void registerTerminationCondition(const ob::PlannerTerminationCondition& ptc);
   void unregisterTerminationCondition();
 
+  /** \brief Check the trajectories set with setSeedTrajectories() against the current problem
+      definition; if one of them, spliced onto the exact start state, satisfies the goal and
+      passes validity checking, register it as the solution path. Returns true if a seed was
+      accepted. */
+  bool trySeedTrajectories();
+
+  /** \brief If roadmap caching is enabled and the configured planner is a PRM variant that can be
+      constructed from planner data, install a planner seeded with the cached roadmap */
+  void installWarmRoadmap();
+
+  /** \brief If roadmap caching is enabled, extract the roadmap grown by the planner during the
+      last solve and store it in the cache for later requests */
+  void harvestRoadmap();
+
+  /** \brief The key under which roadmaps of this configuration are cached */
+  std::string roadmapCacheKey() const
+  {
+    return name_ + "/" + spec_.state_space_->getName();
+  }
+
   ModelBasedPlanningContextSpecification spec_;
 
   robot_state::RobotState complete_initial_robot_state_;
@@ -335,6 +393,36 @@ protected:
   /// tool used to compute multiple plans in parallel; this uses the problem definition maintained by ompl_simple_setup_
   ot::ParallelPlan ompl_parallel_plan_;
 
+  /// allocators for the heterogeneous planners raced against each other when the 'planner_race'
+  /// parameter is set in the planner configuration; the first solution terminates the others
+  std::vector<ob::PlannerAllocator> race_planner_allocators_;
+
+  /// trajectories of earlier, nearby requests to try as candidate solutions before planning cold
+  std::vector<robot_trajectory::RobotTrajectoryPtr> seed_trajectories_;
+
+  /// cache serving warm multi-query roadmaps across planning requests, set by the context manager
+  RoadmapCachePtr roadmap_cache_;
+
+  /// geometry signature of the planning scene of the current request, used to key roadmap_cache_
+  std::uint64_t roadmap_scene_signature_;
+
+  /// whether the 'multi_query_roadmap' parameter enables roadmap caching for this configuration
+  bool use_roadmap_cache_;
+
+  /// number of IK worker threads producing goal states, set with the 'goal_sampler_threads'
+  /// parameter; 1 keeps goal sampling inline in the lazy goal sampling thread
+  unsigned int goal_sampling_threads_;
+
+  /// number of threads simplifying sections of the solution path concurrently, set with the
+  /// 'simplifier_threads' parameter; 1 keeps the original single-threaded simplification
+  unsigned int simplifier_threads_;
+
+  /// processor indices the planning threads of this context are restricted to, set with the
+  /// 'planning_cpu_affinity' parameter; on multi-socket hosts restricting a context to the
+  /// processors of one node keeps planner threads and the memory they first touch local.
+  /// An empty set leaves thread placement to the operating system.
+  std::vector<int> planning_cpu_affinity_;
+
   std::vector<int> space_signature_;
 
   kinematic_constraints::KinematicConstraintSetPtr path_constraints_;
@@ -167,6 +167,10 @@ protected:
   /** @brief Load the additional plugins for sampling constraints */
   void loadConstraintSamplers();
 
+  /** @brief Pre-construct planning contexts for all planner configurations if the
+      ~prewarm_planning_contexts parameter is set */
+  void prewarmPlanningContexts();
+
   void configureContext(const ModelBasedPlanningContextPtr& context) const;
 
   /** \brief Configure the OMPL planning context for a new planning request */
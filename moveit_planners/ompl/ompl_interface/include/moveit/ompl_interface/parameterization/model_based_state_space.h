@@ -84,7 +84,10 @@ public:
       GOAL_DISTANCE_KNOWN = 2,
       VALIDITY_TRUE = 4,
       IS_START_STATE = 8,
-      IS_GOAL_STATE = 16
+      IS_GOAL_STATE = 16,
+      // the values array aliases externally owned memory (e.g. a memory-mapped database)
+      // and must not be freed with the state
+      IS_MAPPED_MEMORY = 32
     };
 
     StateType() : ompl::base::State(), values(NULL), tag(-1), flags(0), distance(0.0)
@@ -123,7 +126,7 @@ public:
 
     void clearKnownInformation()
     {
-      flags = 0;
+      flags &= IS_MAPPED_MEMORY;  // memory ownership is not planner information; keep it
     }
 
     bool isMarkedValid() const
@@ -182,6 +185,11 @@ public:
 
   ompl::base::State* allocState() const override;
   void freeState(ompl::base::State* state) const override;
+
+  /** \brief Allocate a state whose values array aliases externally owned (typically read-only,
+      memory-mapped) memory instead of a heap allocation. freeState() will free the state itself
+      but not the aliased values. Such states must not be written to. */
+  ompl::base::State* allocMappedState(double* values) const;
   unsigned int getDimension() const override;
   void enforceBounds(ompl::base::State* state) const override;
   bool satisfiesBounds(const ompl::base::State* state) const override;
@@ -190,6 +198,22 @@ public:
   void interpolate(const ompl::base::State* from, const ompl::base::State* to, const double t,
                    ompl::base::State* state) const override;
   double distance(const ompl::base::State* state1, const ompl::base::State* state2) const override;
+
+  /** \brief Whether distance() and interpolate() run the flat kernels; see setupFlatKernels() */
+  bool hasFlatKernels() const
+  {
+    return use_flat_kernels_;
+  }
+
+  /** \brief Compute the distances from \e query (a flat value array) to \e count states stored
+      variable-major in \e block: variable \e v of state \e j lives at block[v * stride + j]. One
+      distance per state is written to \e distances. The variable-major layout lets the compiler
+      vectorize across states, with the wrap-around of continuous joints handled branchlessly.
+      Returns false (leaving \e distances untouched) when the joint composition of the group does
+      not allow the flat kernels; callers must then fall back to pairwise distance(). */
+  bool distanceBlock(const double* query, const double* block, unsigned int stride, unsigned int count,
+                     double* distances) const;
+
   bool equalStates(const ompl::base::State* state1, const ompl::base::State* state2) const override;
   double getMaximumExtent() const override;
   double getMeasure() const override;
@@ -266,6 +290,24 @@ protected:
   InterpolationFunction interpolation_function_;
   DistanceFunction distance_function_;
 
+  /** \brief Precompute the data for the flat distance/interpolation kernels, if the joint
+      composition of the group allows them (called once from the constructor) */
+  void setupFlatKernels();
+
+  /// whether distance() and interpolate() can run the flat kernels instead of dispatching
+  /// through virtual per-joint calls; set when all active joints are single-variable
+  /// revolute/prismatic joints and the group has no mimic joints
+  bool use_flat_kernels_;
+
+  /// whether any variable belongs to a continuous joint and needs angle wrapping in the kernels
+  bool has_continuous_variables_;
+
+  /// per-variable distance factor of the owning joint, used by the flat distance kernel
+  std::vector<double> variable_distance_weights_;
+
+  /// per-variable flag marking variables of continuous joints
+  std::vector<unsigned char> variable_continuous_;
+
   double tag_snap_to_segment_;
   double tag_snap_to_segment_complement_;
 };
@@ -40,6 +40,9 @@
 #include <moveit/ompl_interface/parameterization/model_based_state_space.h>
 #include <ompl/base/spaces/SE3StateSpace.h>
 
+#include <mutex>
+#include <unordered_map>
+
 namespace ompl_interface
 {
 class PoseModelStateSpace : public ModelBasedStateSpace
@@ -132,8 +135,18 @@ private:
     std::vector<std::string> fk_link_;
   };
 
+  /** \brief Hash of the interpolated pose and the joint seed of \e state, used as key of the
+      interpolation IK cache. Quantized so last-bit noise in the interpolated values still hits. */
+  std::size_t interpolationCacheKey(const StateType* state) const;
+
   std::vector<PoseComponent> poses_;
   double jump_factor_;
+
+  /// IK solutions computed by interpolate(); planners interpolate repeatedly along the same
+  /// edges (e.g. when checking motions at different resolutions), so identical pose/seed pairs
+  /// come back often and the solve can be skipped
+  mutable std::mutex interpolation_ik_cache_lock_;
+  mutable std::unordered_map<std::size_t, std::vector<double>> interpolation_ik_cache_;
 };
 }
 
@@ -148,6 +148,13 @@ public:
                                                   const planning_interface::MotionPlanRequest& req,
                                                   moveit_msgs::MoveItErrorCodes& error_code) const;
 
+  /** @brief Pre-construct planning contexts (state space, space information, planner instance) for
+      all known planner configurations and place them in the internal cache, so that the first
+      planning request for a configuration does not pay the context construction cost. One context
+      is created per configuration by default; a different pool size can be set per configuration
+      with the 'prewarm_contexts' parameter (0 disables pre-warming that configuration). */
+  void prewarmPlanningContexts();
+
   void registerPlannerAllocator(const std::string& planner_id, const ConfiguredPlannerAllocator& pa)
   {
     known_planners_[planner_id] = pa;
@@ -224,6 +231,10 @@ protected:
   /// needed)
   unsigned int minimum_waypoint_count_;
 
+  /// cache of multi-query roadmaps shared by all contexts that enable the 'multi_query_roadmap'
+  /// parameter in their planner configuration
+  RoadmapCachePtr roadmap_cache_;
+
 private:
   MOVEIT_CLASS_FORWARD(CachedContexts);
   CachedContextsPtr cached_contexts_;
@@ -0,0 +1,98 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2012, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef MOVEIT_OMPL_INTERFACE_ROADMAP_CACHE_
+#define MOVEIT_OMPL_INTERFACE_ROADMAP_CACHE_
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <ompl/base/PlannerData.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ompl_interface
+{
+MOVEIT_CLASS_FORWARD(RoadmapCache);
+
+/** \brief Cache of multi-query roadmaps (the PRM family of planners), keyed by planner
+    configuration and a signature of the collision world geometry.
+
+    Roadmaps harvested after a successful solve are served back to later planning requests of the
+    same configuration: verbatim when the world geometry has not changed, otherwise after pruning
+    the vertices and edges invalidated by the current scene. Quasi-static scenes thus keep most of
+    the graph warm across requests instead of rebuilding it from scratch every time. */
+class RoadmapCache
+{
+public:
+  /** \brief Compute a signature of the collision world geometry of \e scene (object ids, shape
+      types, shape extents and poses). The robot state and attached bodies are not part of the
+      signature, as they do not describe the environment the roadmap was built in. */
+  static std::uint64_t computeSceneSignature(const planning_scene::PlanningSceneConstPtr& scene);
+
+  /** \brief Remove from \e data the vertices that are invalid according to the current validity
+      checker of \e si, as well as the edges whose motions are no longer valid. Returns the number
+      of removed vertices and edges. */
+  static std::size_t pruneInvalidatedRoadmap(ompl::base::PlannerData& data,
+                                             const ompl::base::SpaceInformationPtr& si);
+
+  /** \brief Store the roadmap \e data harvested for configuration \e key, built in the scene with
+      the given geometry signature. Replaces any previously stored roadmap for that configuration. */
+  void storeRoadmap(const std::string& key, std::uint64_t scene_signature, const ompl::base::PlannerDataPtr& data);
+
+  /** \brief Get a roadmap for configuration \e key that is usable in the scene with the given
+      geometry signature. An exact signature match is returned as is; a roadmap built in a
+      different scene is first pruned of invalidated vertices and edges using \e si. Returns NULL
+      if nothing usable is cached. */
+  ompl::base::PlannerDataPtr fetchRoadmap(const std::string& key, std::uint64_t scene_signature,
+                                          const ompl::base::SpaceInformationPtr& si);
+
+  /** \brief Discard all cached roadmaps */
+  void clear();
+
+private:
+  struct CachedRoadmap
+  {
+    std::uint64_t scene_signature;
+    ompl::base::PlannerDataPtr data;
+  };
+
+  std::map<std::string, CachedRoadmap> roadmaps_;
+  std::mutex lock_;
+};
+}  // namespace ompl_interface
+
+#endif
@@ -36,13 +36,24 @@
 
 #include <moveit/ompl_interface/constraints_library.h>
 #include <moveit/ompl_interface/detail/constrained_sampler.h>
+#include <moveit/ompl_interface/detail/vectorized_nearest_neighbors.h>
 #include <moveit/profiler/profiler.h>
 #include <ompl/tools/config/SelfConfig.h>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/filesystem.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <mutex>
+#include <thread>
 #include <utility>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace ompl_interface
 {
 namespace
@@ -77,6 +88,173 @@ void hexToMsg(const std::string& hex, T& msg)
   ros::serialization::IStream stream_arg(buffer_arg.get(), serial_size_arg);
   ros::serialization::deserialize(stream_arg, msg);
 }
+
+// Layout of the memory-mapped constraint database files ("<name>.ompldb.mmap"): a fixed header,
+// one contiguous block of state values (page-faulted on demand), one block of state tags, and the
+// (comparatively small) connectivity metadata, which is read eagerly.
+struct MmapDatabaseHeader
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint64_t state_count;
+  std::uint64_t state_value_bytes;
+};
+
+static const std::uint32_t MMAP_DATABASE_MAGIC = 0x42444143;  // "CADB"
+static const std::uint32_t MMAP_DATABASE_VERSION = 1;
+
+/** \brief State storage whose state values alias a read-only memory-mapped database file. The
+    mapping is shared between processes that load the same file and pages are only brought in when
+    the corresponding states are accessed. */
+class MmapConstraintStateStorage : public ConstraintApproximationStateStorage
+{
+public:
+  MmapConstraintStateStorage(const ob::StateSpacePtr& space, void* addr, std::size_t length)
+    : ConstraintApproximationStateStorage(space), addr_(addr), length_(length)
+  {
+  }
+
+  ~MmapConstraintStateStorage() override
+  {
+    // free the states (they do not own their values) before dropping the mapping
+    clear();
+    munmap(addr_, length_);
+  }
+
+  /** \brief Append a state already allocated for this storage, without cloning it. */
+  void addStateDirect(const ompl::base::State* state, ConstrainedStateMetadata&& metadata)
+  {
+    states_.push_back(state);
+    metadata_.push_back(std::move(metadata));
+  }
+
+private:
+  void* addr_;
+  std::size_t length_;
+};
+
+void writeUint64(std::ofstream& out, std::uint64_t value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool writeMmapDatabase(const std::string& file, ConstraintApproximationStateStorage* cass,
+                       std::size_t state_value_bytes)
+{
+  std::ofstream out(file.c_str(), std::ios::binary);
+  if (!out.good())
+    return false;
+  MmapDatabaseHeader header;
+  header.magic = MMAP_DATABASE_MAGIC;
+  header.version = MMAP_DATABASE_VERSION;
+  header.state_count = cass->size();
+  header.state_value_bytes = state_value_bytes;
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (std::size_t i = 0; i < cass->size(); ++i)
+    out.write(reinterpret_cast<const char*>(cass->getState(i)->as<ModelBasedStateSpace::StateType>()->values),
+              state_value_bytes);
+  for (std::size_t i = 0; i < cass->size(); ++i)
+  {
+    std::int32_t tag = cass->getState(i)->as<ModelBasedStateSpace::StateType>()->tag;
+    out.write(reinterpret_cast<const char*>(&tag), sizeof(tag));
+  }
+  for (std::size_t i = 0; i < cass->size(); ++i)
+  {
+    const ConstrainedStateMetadata& md = cass->getMetadata(i);
+    writeUint64(out, md.first.size());
+    for (std::size_t connection : md.first)
+      writeUint64(out, connection);
+    writeUint64(out, md.second.size());
+    for (const std::pair<const std::size_t, std::pair<std::size_t, std::size_t>>& motion : md.second)
+    {
+      writeUint64(out, motion.first);
+      writeUint64(out, motion.second.first);
+      writeUint64(out, motion.second.second);
+    }
+  }
+  return out.good();
+}
+
+ompl::base::StateStoragePtr readMmapDatabase(const std::string& file, const ob::StateSpacePtr& space,
+                                             std::size_t state_value_bytes)
+{
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+    return ompl::base::StateStoragePtr();
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || static_cast<std::size_t>(file_stat.st_size) < sizeof(MmapDatabaseHeader))
+  {
+    close(fd);
+    return ompl::base::StateStoragePtr();
+  }
+  const std::size_t length = file_stat.st_size;
+  void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);  // the mapping keeps the file referenced
+  if (addr == MAP_FAILED)
+    return ompl::base::StateStoragePtr();
+
+  MmapDatabaseHeader header;
+  memcpy(&header, addr, sizeof(header));
+  const char* values = reinterpret_cast<const char*>(addr) + sizeof(header);
+  const char* tags = values + header.state_count * header.state_value_bytes;
+  const char* metadata = tags + header.state_count * sizeof(std::int32_t);
+  const char* end = reinterpret_cast<const char*>(addr) + length;
+  if (header.magic != MMAP_DATABASE_MAGIC || header.version != MMAP_DATABASE_VERSION ||
+      header.state_value_bytes != state_value_bytes || metadata > end)
+  {
+    ROS_ERROR_NAMED("constraints_library", "'%s' is not a valid constraint database for this state space",
+                    file.c_str());
+    munmap(addr, length);
+    return ompl::base::StateStoragePtr();
+  }
+
+  auto* storage = new MmapConstraintStateStorage(space, addr, length);
+  ompl::base::StateStoragePtr result(storage);
+
+  bool ok = true;
+  const char* cursor = metadata;
+  auto read_u64 = [&cursor, end, &ok]() -> std::uint64_t {
+    std::uint64_t value = 0;
+    if (cursor + sizeof(value) > end)
+    {
+      ok = false;
+      return 0;
+    }
+    memcpy(&value, cursor, sizeof(value));
+    cursor += sizeof(value);
+    return value;
+  };
+
+  for (std::uint64_t i = 0; ok && i < header.state_count; ++i)
+  {
+    ConstrainedStateMetadata md;
+    std::uint64_t n_connections = read_u64();
+    for (std::uint64_t j = 0; ok && j < n_connections; ++j)
+      md.first.push_back(read_u64());
+    std::uint64_t n_motions = read_u64();
+    for (std::uint64_t j = 0; ok && j < n_motions; ++j)
+    {
+      std::uint64_t to = read_u64();
+      std::uint64_t first_state = read_u64();
+      std::uint64_t last_state = read_u64();
+      md.second[to] = std::make_pair(first_state, last_state);
+    }
+    if (!ok)
+      break;
+    std::int32_t tag;
+    memcpy(&tag, tags + i * sizeof(std::int32_t), sizeof(tag));
+    ompl::base::State* state = space->as<ModelBasedStateSpace>()->allocMappedState(
+        const_cast<double*>(reinterpret_cast<const double*>(values + i * state_value_bytes)));
+    state->as<ModelBasedStateSpace::StateType>()->tag = tag;
+    storage->addStateDirect(state, std::move(md));
+  }
+  if (!ok)
+  {
+    ROS_ERROR_NAMED("constraints_library", "Memory-mapped constraint database '%s' is truncated", file.c_str());
+    return ompl::base::StateStoragePtr();
+  }
+  return result;
+}
 }  // namespace
 
 class ConstraintApproximationStateSampler : public ob::StateSampler
@@ -308,11 +486,23 @@ void ompl_interface::ConstraintsLibrary::loadConstraintApproximations(const std:
     {
       moveit_msgs::Constraints msg;
       hexToMsg(serialization, msg);
-      auto* cass = new ConstraintApproximationStateStorage(pc->getOMPLSimpleSetup()->getStateSpace());
-      cass->load((path + "/" + filename).c_str());
+      const ob::StateSpacePtr& space = pc->getOMPLSimpleSetup()->getStateSpace();
+      const std::size_t state_value_bytes = space->getSerializationLength() - sizeof(int);
+      // prefer the memory-mapped database when one exists next to the serialized one: its states
+      // are page-faulted on demand and shared read-only between processes loading the same file
+      ompl::base::StateStoragePtr storage =
+          readMmapDatabase(path + "/" + filename + ".mmap", space, state_value_bytes);
+      if (storage)
+        ROS_INFO_NAMED("constraints_library", "Using memory-mapped database '%s.mmap'", filename.c_str());
+      else
+      {
+        auto* loaded = new ConstraintApproximationStateStorage(space);
+        loaded->load((path + "/" + filename).c_str());
+        storage.reset(loaded);
+      }
+      auto* cass = static_cast<ConstraintApproximationStateStorage*>(storage.get());
       ConstraintApproximationPtr cap(new ConstraintApproximation(group, state_space_parameterization, explicit_motions,
-                                                                 msg, filename, ompl::base::StateStoragePtr(cass),
-                                                                 milestones));
+                                                                 msg, filename, storage, milestones));
       if (constraint_approximations_.find(cap->getName()) != constraint_approximations_.end())
         ROS_WARN_NAMED("constraints_library", "Overwriting constraint approximation named '%s'",
                        cap->getName().c_str());
@@ -355,7 +545,17 @@ void ompl_interface::ConstraintsLibrary::saveConstraintApproximations(const std:
       fout << serialization << std::endl;
       fout << it->second->getFilename() << std::endl;
       if (it->second->getStateStorage())
-        it->second->getStateStorage()->store((path + "/" + it->second->getFilename()).c_str());
+      {
+        const std::string db_file = path + "/" + it->second->getFilename();
+        it->second->getStateStorage()->store(db_file.c_str());
+        // also store the memory-mapped variant, preferred by loadConstraintApproximations()
+        auto* cass = static_cast<ConstraintApproximationStateStorage*>(it->second->getStateStorage().get());
+        const std::size_t state_value_bytes =
+            it->second->getStateStorage()->getStateSpace()->getSerializationLength() - sizeof(int);
+        if (!writeMmapDatabase(db_file + ".mmap", cass, state_value_bytes))
+          ROS_WARN_NAMED("constraints_library", "Unable to save memory-mapped constraint database to '%s.mmap'",
+                         db_file.c_str());
+      }
     }
   else
     ROS_ERROR_NAMED("constraints_library", "Unable to save constraint approximation to '%s'", path.c_str());
@@ -441,6 +641,9 @@ ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstra
     const moveit_msgs::Constraints& constr_hard, const ConstraintApproximationConstructionOptions& options,
     ConstraintApproximationConstructionResults& result)
 {
+  if (options.n_threads != 1)
+    return constructConstraintApproximationParallel(pcontext, constr_sampling, constr_hard, options, result);
+
   // state storage structure
   ConstraintApproximationStateStorage* cass = new ConstraintApproximationStateStorage(pcontext->getOMPLStateSpace());
   ob::StateStoragePtr sstor(cass);
@@ -534,6 +737,13 @@ ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstra
     std::vector<ob::State*> int_states(options.max_explicit_points, nullptr);
     pcontext->getOMPLSimpleSetup()->getSpaceInformation()->allocStates(int_states);
 
+    // compute the distances of each milestone to all others one row at a time, over
+    // structure-of-arrays blocks, instead of one virtual distance() call per pair
+    VectorizedNearestNeighbors milestone_distances(pcontext->getOMPLStateSpace().get());
+    for (std::size_t i = 0; i < milestones; ++i)
+      milestone_distances.add(sstor->getState(i));
+    std::vector<double> distance_row;
+
     ompl::time::point start = ompl::time::now();
     int good = 0;
     int done = -1;
@@ -550,12 +760,13 @@ ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstra
         continue;
 
       const ob::State* sj = sstor->getState(j);
+      milestone_distances.distancesTo(sj, distance_row);
 
       for (std::size_t i = j + 1; i < milestones; ++i)
       {
         if (cass->getMetadata(i).first.size() >= options.edges_per_sample)
           continue;
-        double d = space->distance(sstor->getState(i), sj);
+        double d = distance_row[i];
         if (d >= options.max_edge_length)
           continue;
         unsigned int isteps =
@@ -612,3 +823,219 @@ ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstra
   ROS_ERROR_NAMED("constraints_library", "No StateStoragePtr found - implement better solution here.");
   return sstor;
 }
+
+ompl::base::StateStoragePtr ompl_interface::ConstraintsLibrary::constructConstraintApproximationParallel(
+    const ModelBasedPlanningContextPtr& pcontext, const moveit_msgs::Constraints& constr_sampling,
+    const moveit_msgs::Constraints& constr_hard, const ConstraintApproximationConstructionOptions& options,
+    ConstraintApproximationConstructionResults& result)
+{
+  unsigned int n_threads = options.n_threads ? options.n_threads : std::thread::hardware_concurrency();
+  if (n_threads == 0)
+    n_threads = 1;
+
+  // state storage structure
+  ConstraintApproximationStateStorage* cass = new ConstraintApproximationStateStorage(pcontext->getOMPLStateSpace());
+  ob::StateStoragePtr sstor(cass);
+
+  robot_state::Transforms no_transforms(pcontext->getRobotModel()->getModelFrame());
+  const robot_state::RobotState& default_state = pcontext->getCompleteInitialRobotState();
+
+  double bounds_val = std::numeric_limits<double>::max() / 2.0 - 1.0;
+  pcontext->getOMPLStateSpace()->setPlanningVolume(-bounds_val, bounds_val, -bounds_val, bounds_val, -bounds_val,
+                                                   bounds_val);
+  pcontext->getOMPLStateSpace()->setup();
+
+  const constraint_samplers::ConstraintSamplerManagerPtr& csmng = pcontext->getConstraintSamplerManager();
+
+  // all access to the shared state storage and its metadata is serialized by this lock; sampling,
+  // constraint checking and interpolation run concurrently on per-thread data
+  std::mutex storage_lock;
+  std::atomic<unsigned int> attempts(0);
+  std::atomic<bool> give_up(false);
+  double success_rate_sum = 0.0;
+  unsigned int success_rate_cnt = 0;
+
+  ompl::time::point start = ompl::time::now();
+
+  auto sample_states = [&]() {
+    robot_state::RobotState robot_state(default_state);
+    kinematic_constraints::KinematicConstraintSet kset(pcontext->getRobotModel());
+    kset.add(constr_hard, no_transforms);
+
+    ConstrainedSampler* csmp = nullptr;
+    if (csmng)
+    {
+      constraint_samplers::ConstraintSamplerPtr cs = csmng->selectSampler(
+          pcontext->getPlanningScene(), pcontext->getJointModelGroup()->getName(), constr_sampling);
+      if (cs)
+        csmp = new ConstrainedSampler(pcontext.get(), cs);
+    }
+    ob::StateSamplerPtr ss(csmp ? ob::StateSamplerPtr(csmp) :
+                                  pcontext->getOMPLStateSpace()->allocDefaultStateSampler());
+    ompl::base::ScopedState<> temp(pcontext->getOMPLStateSpace());
+
+    while (!give_up)
+    {
+      {
+        std::lock_guard<std::mutex> slock(storage_lock);
+        if (sstor->size() >= options.samples)
+          break;
+      }
+      if (++attempts > options.samples)
+      {
+        std::lock_guard<std::mutex> slock(storage_lock);
+        if (sstor->size() == 0)
+        {
+          give_up = true;
+          break;
+        }
+      }
+      ss->sampleUniform(temp.get());
+      pcontext->getOMPLStateSpace()->copyToRobotState(robot_state, temp.get());
+      if (kset.decide(robot_state).satisfied)
+      {
+        std::lock_guard<std::mutex> slock(storage_lock);
+        if (sstor->size() < options.samples)
+        {
+          temp->as<ModelBasedStateSpace::StateType>()->tag = sstor->size();
+          sstor->addState(temp.get());
+        }
+      }
+    }
+    if (csmp)
+    {
+      std::lock_guard<std::mutex> slock(storage_lock);
+      success_rate_sum += csmp->getConstrainedSamplingRate();
+      ++success_rate_cnt;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(n_threads);
+  for (unsigned int i = 0; i < n_threads; ++i)
+    workers.emplace_back(sample_states);
+  for (std::thread& worker : workers)
+    worker.join();
+  workers.clear();
+
+  if (give_up)
+    ROS_ERROR_NAMED("constraints_library", "Unable to generate any samples");
+
+  result.state_sampling_time = ompl::time::seconds(ompl::time::now() - start);
+  ROS_INFO_NAMED("constraints_library", "Generated %u states in %lf seconds using %u threads",
+                 (unsigned int)sstor->size(), result.state_sampling_time, n_threads);
+  if (success_rate_cnt)
+  {
+    result.sampling_success_rate = success_rate_sum / (double)success_rate_cnt;
+    ROS_INFO_NAMED("constraints_library", "Constrained sampling rate: %lf", result.sampling_success_rate);
+  }
+
+  result.milestones = sstor->size();
+  if (options.edges_per_sample > 0)
+  {
+    ROS_INFO_NAMED("constraints_library", "Computing graph connections (max %u edges per sample) ...",
+                   options.edges_per_sample);
+
+    const ob::StateSpacePtr& space = pcontext->getOMPLSimpleSetup()->getStateSpace();
+    unsigned int milestones = sstor->size();
+    // snapshot the milestone state pointers: appending explicit motion states grows the storage
+    // vector, which must not be read concurrently
+    std::vector<const ob::State*> milestone_states(sstor->getStates().begin(),
+                                                   sstor->getStates().begin() + milestones);
+
+    // shared read-only distance structure; each worker computes whole distance rows over
+    // structure-of-arrays blocks into its own buffer instead of per-pair distance() calls
+    VectorizedNearestNeighbors milestone_distances(pcontext->getOMPLStateSpace().get());
+    for (std::size_t i = 0; i < milestones; ++i)
+      milestone_distances.add(sstor->getState(i));
+
+    std::atomic<std::size_t> next_row(0);
+    std::atomic<int> good(0);
+
+    start = ompl::time::now();
+
+    auto connect_states = [&]() {
+      robot_state::RobotState robot_state(default_state);
+      kinematic_constraints::KinematicConstraintSet kset(pcontext->getRobotModel());
+      kset.add(constr_hard, no_transforms);
+      std::vector<ob::State*> int_states(options.max_explicit_points, nullptr);
+      pcontext->getOMPLSimpleSetup()->getSpaceInformation()->allocStates(int_states);
+      std::vector<double> distance_row;
+
+      for (std::size_t j = next_row++; j < milestones; j = next_row++)
+      {
+        const ob::State* sj = milestone_states[j];
+        milestone_distances.distancesTo(sj, distance_row);
+
+        for (std::size_t i = j + 1; i < milestones; ++i)
+        {
+          {
+            std::lock_guard<std::mutex> slock(storage_lock);
+            if (cass->getMetadata(j).first.size() >= options.edges_per_sample)
+              break;
+            if (cass->getMetadata(i).first.size() >= options.edges_per_sample)
+              continue;
+          }
+          double d = distance_row[i];
+          if (d >= options.max_edge_length)
+            continue;
+          unsigned int isteps =
+              std::min<unsigned int>(options.max_explicit_points, d / options.explicit_points_resolution);
+          double step = 1.0 / (double)isteps;
+          bool ok = true;
+          space->interpolate(milestone_states[i], sj, step, int_states[0]);
+          for (unsigned int k = 1; k < isteps; ++k)
+          {
+            double this_step = step / (1.0 - (k - 1) * step);
+            space->interpolate(int_states[k - 1], sj, this_step, int_states[k]);
+            pcontext->getOMPLStateSpace()->copyToRobotState(robot_state, int_states[k]);
+            if (!kset.decide(robot_state).satisfied)
+            {
+              ok = false;
+              break;
+            }
+          }
+
+          if (ok)
+          {
+            std::lock_guard<std::mutex> slock(storage_lock);
+            // re-check the caps: other threads may have filled them while this edge was validated
+            if (cass->getMetadata(j).first.size() >= options.edges_per_sample)
+              break;
+            if (cass->getMetadata(i).first.size() >= options.edges_per_sample)
+              continue;
+            cass->getMetadata(i).first.push_back(j);
+            cass->getMetadata(j).first.push_back(i);
+
+            if (options.explicit_motions)
+            {
+              cass->getMetadata(i).second[j].first = sstor->size();
+              for (unsigned int k = 0; k < isteps; ++k)
+              {
+                int_states[k]->as<ModelBasedStateSpace::StateType>()->tag = -1;
+                sstor->addState(int_states[k]);
+              }
+              cass->getMetadata(i).second[j].second = sstor->size();
+              cass->getMetadata(j).second[i] = cass->getMetadata(i).second[j];
+            }
+
+            ++good;
+          }
+        }
+      }
+
+      pcontext->getOMPLSimpleSetup()->getSpaceInformation()->freeStates(int_states);
+    };
+
+    for (unsigned int i = 0; i < n_threads; ++i)
+      workers.emplace_back(connect_states);
+    for (std::thread& worker : workers)
+      worker.join();
+
+    result.state_connection_time = ompl::time::seconds(ompl::time::now() - start);
+    ROS_INFO_NAMED("constraints_library", "Computed possible connexions in %lf seconds. Added %d connexions",
+                   result.state_connection_time, good.load());
+  }
+
+  return sstor;
+}
@@ -0,0 +1,138 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2026, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#include <moveit/ompl_interface/detail/clearance_adaptive_motion_validator.h>
+
+#include <cmath>
+#include <limits>
+
+ompl_interface::ClearanceAdaptiveMotionValidator::ClearanceAdaptiveMotionValidator(
+    const ompl::base::SpaceInformationPtr& si, double workspace_factor)
+  : ompl::base::MotionValidator(si), workspace_factor_(workspace_factor)
+{
+}
+
+bool ompl_interface::ClearanceAdaptiveMotionValidator::clearance(const ompl::base::State* state, double& dist) const
+{
+  dist = 0.0;
+  double d = 0.0;
+  if (!si_->getStateValidityChecker()->isValid(state, d))
+    return false;
+  // distance is negative when the active collision environment does not
+  // compute it; in that case no ball can be certified around this sample
+  if (d > 0.0)
+    dist = d;
+  return true;
+}
+
+bool ompl_interface::ClearanceAdaptiveMotionValidator::checkInterior(const ompl::base::State* s1,
+                                                                     const ompl::base::State* s2, double d2,
+                                                                     double& last_valid_time) const
+{
+  last_valid_time = 0.0;
+  const double length = si_->distance(s1, s2);
+  if (length <= std::numeric_limits<double>::epsilon())
+    return true;
+
+  // sampling resolution and ball radii expressed in interpolation time
+  const double resolution = si_->getStateSpace()->getLongestValidSegmentLength() / length;
+  const double ball_scale = 1.0 / (workspace_factor_ * length);
+
+  double d1 = 0.0;
+  clearance(s1, d1);  // s1 is known valid; this only retrieves its clearance
+
+  double t = 0.0;                       // time of the last valid sample
+  double covered = d1 * ball_scale;     // time up to which freedom is certified
+  const double end = 1.0 - d2 * ball_scale;
+
+  ompl::base::State* test = si_->allocState();
+  bool result = true;
+  while (covered < end)
+  {
+    // jump to the edge of the certified ball, or step at the fixed
+    // resolution when the clearance is too small to skip anything
+    double next = std::max(t + resolution, covered);
+    if (next >= 1.0 - 0.5 * resolution)
+      break;  // closer to s2 than the resolution; s2 itself was already checked
+    si_->getStateSpace()->interpolate(s1, s2, next, test);
+    double d = 0.0;
+    if (!clearance(test, d))
+    {
+      last_valid_time = t;
+      result = false;
+      break;
+    }
+    t = next;
+    covered = std::max(covered, t + d * ball_scale);
+  }
+  si_->freeState(test);
+  return result;
+}
+
+bool ompl_interface::ClearanceAdaptiveMotionValidator::checkMotion(const ompl::base::State* s1,
+                                                                   const ompl::base::State* s2) const
+{
+  // assume s1 is valid; check s2 first, as that is the cheapest way to fail
+  double d2 = 0.0;
+  bool result = clearance(s2, d2);
+  if (result)
+  {
+    double last_valid_time;
+    result = checkInterior(s1, s2, d2, last_valid_time);
+  }
+  if (result)
+    valid_++;
+  else
+    invalid_++;
+  return result;
+}
+
+bool ompl_interface::ClearanceAdaptiveMotionValidator::checkMotion(
+    const ompl::base::State* s1, const ompl::base::State* s2,
+    std::pair<ompl::base::State*, double>& last_valid) const
+{
+  double d2 = 0.0;
+  double last_valid_time = 0.0;
+  bool result = clearance(s2, d2) && checkInterior(s1, s2, d2, last_valid_time);
+  if (result)
+    valid_++;
+  else
+  {
+    if (last_valid.first)
+      si_->getStateSpace()->interpolate(s1, s2, last_valid_time, last_valid.first);
+    last_valid.second = last_valid_time;
+    invalid_++;
+  }
+  return result;
+}
@@ -39,11 +39,26 @@
 #include <moveit/ompl_interface/detail/state_validity_checker.h>
 #include <moveit/profiler/profiler.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <utility>
 
+namespace
+{
+// goals farther than this from the nearest obstacle all score the same on clearance; only
+// the low-clearance range matters for deprioritizing goals squeezed against the environment
+const double MAX_USEFUL_CLEARANCE = 0.2;
+
+// soft scale for the manipulability index w = sqrt(det(J * J^T)); configurations with w
+// around this value score 0.5 on the manipulability term, near-singular ones score ~0
+const double MANIPULABILITY_SCALE = 0.05;
+}
+
 ompl_interface::ConstrainedGoalSampler::ConstrainedGoalSampler(const ModelBasedPlanningContext* pc,
                                                                kinematic_constraints::KinematicConstraintSetPtr ks,
-                                                               constraint_samplers::ConstraintSamplerPtr cs)
+                                                               constraint_samplers::ConstraintSamplerPtr cs,
+                                                               unsigned int sampling_threads)
   : ob::GoalLazySamples(pc->getOMPLSimpleSetup()->getSpaceInformation(),
                         std::bind(&ConstrainedGoalSampler::sampleUsingConstraintSampler, this, std::placeholders::_1,
                                   std::placeholders::_2),
@@ -55,13 +70,178 @@ ompl_interface::ConstrainedGoalSampler::ConstrainedGoalSampler(const ModelBasedP
   , invalid_sampled_constraints_(0)
   , warned_invalid_samples_(false)
   , verbose_display_(0)
+  , stop_workers_(false)
+  , active_workers_(0)
+  , worker_attempts_(0)
 {
   if (!constraint_sampler_)
     default_sampler_ = si_->allocStateSampler();
   ROS_DEBUG_NAMED("constrained_goal_sampler", "Constructed a ConstrainedGoalSampler instance at address %p", this);
+
+  // decouple IK from the lazy sampling thread: workers fill the goal queue, the sampling
+  // function only consumes from it. Workers need their own samplers, so this requires a
+  // constraint sampler manager to create them from.
+  if (sampling_threads > 1 && constraint_sampler_ && pc->getSpecification().constraint_sampler_manager_)
+  {
+    active_workers_ = sampling_threads;
+    ik_workers_.reserve(sampling_threads);
+    for (unsigned int i = 0; i < sampling_threads; ++i)
+      ik_workers_.emplace_back(&ConstrainedGoalSampler::ikWorkerThread, this);
+    ROS_DEBUG_NAMED("constrained_goal_sampler", "Sampling goal states with %u IK worker threads", sampling_threads);
+  }
+
   startSampling();
 }
 
+ompl_interface::ConstrainedGoalSampler::~ConstrainedGoalSampler()
+{
+  stopSampling();
+  shutdownWorkers();
+}
+
+void ompl_interface::ConstrainedGoalSampler::shutdownWorkers()
+{
+  stop_workers_ = true;
+  goal_queue_cond_.notify_all();
+  for (std::size_t i = 0; i < ik_workers_.size(); ++i)
+    if (ik_workers_[i].joinable())
+      ik_workers_[i].join();
+  ik_workers_.clear();
+
+  std::unique_lock<std::mutex> slock(goal_queue_lock_);
+  for (std::size_t i = 0; i < goal_queue_.size(); ++i)
+    si_->freeState(goal_queue_[i].state);
+  goal_queue_.clear();
+}
+
+std::uint64_t ompl_interface::ConstrainedGoalSampler::hashState(const ob::State* state) const
+{
+  // FNV-1a over the raw joint values; exact duplicates are what IK retries produce
+  const double* values = state->as<ModelBasedStateSpace::StateType>()->values;
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+  const std::size_t length = planning_context_->getOMPLStateSpace()->getDimension() * sizeof(double);
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+double ompl_interface::ConstrainedGoalSampler::scoreGoalState(const ob::State* state,
+                                                              const robot_state::RobotState& robot_state) const
+{
+  // clearance of the goal configuration; goals wedged against the environment force the
+  // planner to approach through a narrow passage and are the ones worth deprioritizing
+  const double clearance =
+      static_cast<const StateValidityChecker*>(si_->getStateValidityChecker().get())->clearance(state);
+  const double clearance_term = std::min(clearance, MAX_USEFUL_CLEARANCE) / MAX_USEFUL_CLEARANCE;
+
+  // manipulability of the arm at the goal; near-singular goal configurations make poor
+  // attractors even when they have clearance
+  double manipulability_term = 0.0;
+  const robot_model::JointModelGroup* jmg = planning_context_->getJointModelGroup();
+  if (jmg->isChain())
+  {
+    Eigen::MatrixXd jacobian;
+    if (robot_state.getJacobian(jmg, jmg->getLinkModels().back(), Eigen::Vector3d::Zero(), jacobian, false))
+    {
+      const double w = std::sqrt(std::max(0.0, (jacobian * jacobian.transpose()).determinant()));
+      manipulability_term = w / (w + MANIPULABILITY_SCALE);
+    }
+  }
+  return clearance_term + 0.5 * manipulability_term;
+}
+
+bool ompl_interface::ConstrainedGoalSampler::pushGoalState(const ob::State* state, double score)
+{
+  const std::uint64_t hash = hashState(state);
+  ScoredGoal goal;
+  goal.score = score;
+  std::unique_lock<std::mutex> slock(goal_queue_lock_);
+  if (!goal_hashes_.insert(hash).second)
+    return false;
+  // the reservoir is bounded by the number of goal states the planner keeps anyway; once
+  // full, a new candidate displaces the worst queued goal or is dropped, so the workers
+  // keep refining goal quality instead of blocking
+  const std::size_t capacity = std::max(planning_context_->getMaximumGoalSamples(), 1u);
+  if (goal_queue_.size() >= capacity)
+  {
+    if (score <= goal_queue_.back().score)
+      return true;
+    si_->freeState(goal_queue_.back().state);
+    goal_queue_.pop_back();
+  }
+  goal.state = si_->cloneState(state);
+  goal_queue_.insert(std::upper_bound(goal_queue_.begin(), goal_queue_.end(), goal,
+                                      [](const ScoredGoal& a, const ScoredGoal& b) { return a.score > b.score; }),
+                     goal);
+  goal_queue_cond_.notify_all();
+  return true;
+}
+
+bool ompl_interface::ConstrainedGoalSampler::popGoalState(const ob::GoalLazySamples* gls, ob::State* new_goal)
+{
+  std::unique_lock<std::mutex> slock(goal_queue_lock_);
+  while (goal_queue_.empty())
+  {
+    if (stop_workers_ || !gls->isSampling() || active_workers_ == 0)
+      return false;
+    goal_queue_cond_.wait_for(slock, std::chrono::milliseconds(10));
+  }
+  // the queue is kept sorted, so the front is the best goal produced so far
+  ob::State* state = goal_queue_.front().state;
+  goal_queue_.pop_front();
+  goal_queue_cond_.notify_all();
+  slock.unlock();
+
+  si_->copyState(new_goal, state);
+  si_->freeState(state);
+  return true;
+}
+
+void ompl_interface::ConstrainedGoalSampler::ikWorkerThread()
+{
+  // each worker owns its constraint sampler and scratch states; shared planner structures are
+  // only accessed through the thread-safe validity checker and the locked goal queue
+  constraint_samplers::ConstraintSamplerPtr sampler =
+      planning_context_->getSpecification().constraint_sampler_manager_->selectSampler(
+          planning_context_->getPlanningScene(), planning_context_->getJointModelGroup()->getName(),
+          kinematic_constraint_set_->getAllConstraints());
+  if (!sampler)
+  {
+    --active_workers_;
+    goal_queue_cond_.notify_all();
+    return;
+  }
+
+  robot_state::RobotState work_state(planning_context_->getCompleteInitialRobotState());
+  ob::State* temp = si_->allocState();
+  const unsigned int max_attempts = planning_context_->getMaximumGoalSamplingAttempts();
+
+  while (!stop_workers_ && ++worker_attempts_ <= max_attempts)
+  {
+    if (planning_context_->getOMPLSimpleSetup()->getProblemDefinition()->hasSolution())
+      break;
+    if (moveit::tools::Profiler::Running())
+      moveit::tools::Profiler::Event("ConstrainedGoalSampler.sampleAttempt");
+    if (!sampler->project(work_state, planning_context_->getMaximumStateSamplingAttempts()))
+      continue;
+    work_state.update();
+    if (!kinematic_constraint_set_->decide(work_state).satisfied)
+      continue;
+    planning_context_->getOMPLStateSpace()->copyToOMPLState(temp, work_state);
+    if (!static_cast<const StateValidityChecker*>(si_->getStateValidityChecker().get())->isValid(temp))
+      continue;
+    pushGoalState(temp, scoreGoalState(temp, work_state));
+  }
+
+  si_->freeState(temp);
+  --active_workers_;
+  goal_queue_cond_.notify_all();
+}
+
 bool ompl_interface::ConstrainedGoalSampler::checkStateValidity(ob::State* new_goal,
                                                                 const robot_state::RobotState& state,
                                                                 bool verbose) const
@@ -85,8 +265,6 @@ bool ompl_interface::ConstrainedGoalSampler::stateValidityCallback(ob::State* ne
 bool ompl_interface::ConstrainedGoalSampler::sampleUsingConstraintSampler(const ob::GoalLazySamples* gls,
                                                                           ob::State* new_goal)
 {
-  //  moveit::Profiler::ScopedBlock sblock("ConstrainedGoalSampler::sampleUsingConstraintSampler");
-
   unsigned int max_attempts = planning_context_->getMaximumGoalSamplingAttempts();
   unsigned int attempts_so_far = gls->samplingAttemptsCount();
 
@@ -102,9 +280,16 @@ bool ompl_interface::ConstrainedGoalSampler::sampleUsingConstraintSampler(const
   if (planning_context_->getOMPLSimpleSetup()->getProblemDefinition()->hasSolution())
     return false;
 
+  // when the producer pool is running, this thread only consumes pre-computed goal states
+  if (!ik_workers_.empty())
+    return popGoalState(gls, new_goal);
+
   unsigned int max_attempts_div2 = max_attempts / 2;
   for (unsigned int a = gls->samplingAttemptsCount(); a < max_attempts && gls->isSampling(); ++a)
   {
+    if (moveit::tools::Profiler::Running())
+      moveit::tools::Profiler::Event("ConstrainedGoalSampler.sampleAttempt");
+
     bool verbose = false;
     if (gls->getStateCount() == 0 && a >= max_attempts_div2)
       if (verbose_display_ < 1)
@@ -36,8 +36,18 @@
 
 #include <moveit/ompl_interface/detail/state_validity_checker.h>
 #include <moveit/ompl_interface/model_based_planning_context.h>
+#include <moveit/planning_scene/planning_scene.h>
 #include <moveit/profiler/profiler.h>
 #include <ros/ros.h>
+#include <cmath>
+
+namespace
+{
+// number of slots in the shared validity cache (power of two, 0.5 MB)
+const std::size_t VALIDITY_CACHE_SIZE = 1 << 16;
+// joint values are quantized to this resolution before hashing
+const double VALIDITY_CACHE_RESOLUTION = 1e-4;
+}
 
 ompl_interface::StateValidityChecker::StateValidityChecker(const ModelBasedPlanningContext* pc)
   : ompl::base::StateValidityChecker(pc->getOMPLSimpleSetup()->getSpaceInformation())
@@ -45,7 +55,14 @@ ompl_interface::StateValidityChecker::StateValidityChecker(const ModelBasedPlann
   , group_name_(pc->getGroupName())
   , tss_(pc->getCompleteInitialRobotState())
   , verbose_(false)
+  , validity_cache_(VALIDITY_CACHE_SIZE)
+  , scene_epoch_(0)
+  , validity_cache_lookups_(0)
+  , validity_cache_hits_(0)
 {
+  for (std::atomic<std::uint64_t>& slot : validity_cache_)
+    slot.store(0, std::memory_order_relaxed);
+
   specs_.clearanceComputationType = ompl::base::StateValidityCheckerSpecs::APPROXIMATE;
   specs_.hasValidDirectionComputation = false;
 
@@ -68,20 +85,83 @@ void ompl_interface::StateValidityChecker::setVerbose(bool flag)
   verbose_ = flag;
 }
 
+void ompl_interface::StateValidityChecker::clearValidityCache()
+{
+  scene_epoch_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t ompl_interface::StateValidityChecker::validityCacheKey(const ompl::base::State* state) const
+{
+  // FNV-1a over the quantized joint values, seeded with the scene epoch; planner threads hash
+  // their own copies of the same joint values to the same slot
+  const double* values = state->as<ModelBasedStateSpace::StateType>()->values;
+  const unsigned int dim = planning_context_->getOMPLStateSpace()->getDimension();
+  std::uint64_t hash = 14695981039346656037ULL ^ scene_epoch_.load(std::memory_order_relaxed);
+  for (unsigned int i = 0; i < dim; ++i)
+  {
+    const std::uint64_t quantized =
+        static_cast<std::uint64_t>(static_cast<std::int64_t>(floor(values[i] / VALIDITY_CACHE_RESOLUTION + 0.5)));
+    for (unsigned int byte = 0; byte < 8; ++byte)
+    {
+      hash ^= (quantized >> (8 * byte)) & 0xffULL;
+      hash *= 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
+bool ompl_interface::StateValidityChecker::lookupValidityCache(std::uint64_t key, bool& valid) const
+{
+  validity_cache_lookups_.fetch_add(1, std::memory_order_relaxed);
+  const std::uint64_t entry = validity_cache_[key % VALIDITY_CACHE_SIZE].load(std::memory_order_acquire);
+  // the low two bits hold the occupied and validity flags; the rest is the key tag
+  if ((entry & 1) == 0 || (entry & ~static_cast<std::uint64_t>(3)) != (key & ~static_cast<std::uint64_t>(3)))
+    return false;
+  validity_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+  valid = (entry & 2) != 0;
+  return true;
+}
+
+void ompl_interface::StateValidityChecker::storeValidityCache(std::uint64_t key, bool valid) const
+{
+  // colliding keys simply overwrite each other; a single-word store keeps the table lock-free
+  const std::uint64_t entry = (key & ~static_cast<std::uint64_t>(3)) | (valid ? 3 : 1);
+  validity_cache_[key % VALIDITY_CACHE_SIZE].store(entry, std::memory_order_release);
+}
+
 bool ompl_interface::StateValidityChecker::isValid(const ompl::base::State* state, bool verbose) const
 {
-  //  moveit::Profiler::ScopedBlock sblock("isValid");
+  if (moveit::tools::Profiler::Running())
+    moveit::tools::Profiler::Event("StateValidityChecker.isValid");
   return planning_context_->useStateValidityCache() ? isValidWithCache(state, verbose) :
                                                       isValidWithoutCache(state, verbose);
 }
 
 bool ompl_interface::StateValidityChecker::isValid(const ompl::base::State* state, double& dist, bool verbose) const
 {
-  //  moveit::Profiler::ScopedBlock sblock("isValid");
+  if (moveit::tools::Profiler::Running())
+    moveit::tools::Profiler::Event("StateValidityChecker.isValid");
   return planning_context_->useStateValidityCache() ? isValidWithCache(state, dist, verbose) :
                                                       isValidWithoutCache(state, dist, verbose);
 }
 
+const planning_scene::CollisionQuerySession& ompl_interface::StateValidityChecker::getCollisionSession() const
+{
+  // one session per planner thread: sessions are immutable and cheap to build, and per-thread
+  // instances keep even the shared_ptr control blocks from bouncing between cores
+  thread_local const StateValidityChecker* cached_owner = nullptr;
+  thread_local const planning_scene::PlanningScene* cached_scene = nullptr;
+  thread_local planning_scene::CollisionQuerySessionPtr session;
+  const planning_scene::PlanningSceneConstPtr& scene = planning_context_->getPlanningScene();
+  if (cached_owner != this || cached_scene != scene.get())
+  {
+    session.reset(new planning_scene::CollisionQuerySession(scene));
+    cached_owner = this;
+    cached_scene = scene.get();
+  }
+  return *session;
+}
+
 double ompl_interface::StateValidityChecker::cost(const ompl::base::State* state) const
 {
   double cost = 0.0;
@@ -91,7 +171,7 @@ double ompl_interface::StateValidityChecker::cost(const ompl::base::State* state
 
   // Calculates cost from a summation of distance to obstacles times the size of the obstacle
   collision_detection::CollisionResult res;
-  planning_context_->getPlanningScene()->checkCollision(collision_request_with_cost_, res, *robot_state);
+  getCollisionSession().checkCollision(collision_request_with_cost_, res, *robot_state);
 
   for (const collision_detection::CostSource& cost_source : res.cost_sources)
     cost += cost_source.cost * cost_source.getVolume();
@@ -105,7 +185,7 @@ double ompl_interface::StateValidityChecker::clearance(const ompl::base::State*
   planning_context_->getOMPLStateSpace()->copyToRobotState(*robot_state, state);
 
   collision_detection::CollisionResult res;
-  planning_context_->getPlanningScene()->checkCollision(collision_request_with_distance_, res, *robot_state);
+  getCollisionSession().checkCollision(collision_request_with_distance_, res, *robot_state);
   return res.collision ? 0.0 : (res.distance < 0.0 ? std::numeric_limits<double>::infinity() : res.distance);
 }
 
@@ -134,7 +214,7 @@ bool ompl_interface::StateValidityChecker::isValidWithoutCache(const ompl::base:
 
   // check collision avoidance
   collision_detection::CollisionResult res;
-  planning_context_->getPlanningScene()->checkCollision(
+  getCollisionSession().checkCollision(
       verbose ? collision_request_simple_verbose_ : collision_request_simple_, res, *robot_state);
   return !res.collision;
 }
@@ -173,7 +253,7 @@ bool ompl_interface::StateValidityChecker::isValidWithoutCache(const ompl::base:
 
   // check collision avoidance
   collision_detection::CollisionResult res;
-  planning_context_->getPlanningScene()->checkCollision(
+  getCollisionSession().checkCollision(
       verbose ? collision_request_with_distance_verbose_ : collision_request_with_distance_, res, *robot_state);
   dist = res.distance;
   return !res.collision;
@@ -184,11 +264,25 @@ bool ompl_interface::StateValidityChecker::isValidWithCache(const ompl::base::St
   if (state->as<ModelBasedStateSpace::StateType>()->isValidityKnown())
     return state->as<ModelBasedStateSpace::StateType>()->isMarkedValid();
 
+  // consult the cache shared across planner threads; threads of a parallel plan frequently
+  // re-check the same joint values (tree roots, goal regions) through distinct state instances
+  const std::uint64_t cache_key = validityCacheKey(state);
+  bool cached_valid = false;
+  if (lookupValidityCache(cache_key, cached_valid))
+  {
+    if (cached_valid)
+      const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markValid();
+    else
+      const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
+    return cached_valid;
+  }
+
   if (!si_->satisfiesBounds(state))
   {
     if (verbose)
       ROS_INFO_NAMED("state_validity_checker", "State outside bounds");
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
+    storeValidityCache(cache_key, false);
     return false;
   }
 
@@ -200,6 +294,7 @@ bool ompl_interface::StateValidityChecker::isValidWithCache(const ompl::base::St
   if (kset && !kset->decide(*robot_state, verbose).satisfied)
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
+    storeValidityCache(cache_key, false);
     return false;
   }
 
@@ -207,21 +302,24 @@ bool ompl_interface::StateValidityChecker::isValidWithCache(const ompl::base::St
   if (!planning_context_->getPlanningScene()->isStateFeasible(*robot_state, verbose))
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
+    storeValidityCache(cache_key, false);
     return false;
   }
 
   // check collision avoidance
   collision_detection::CollisionResult res;
-  planning_context_->getPlanningScene()->checkCollision(
+  getCollisionSession().checkCollision(
       verbose ? collision_request_simple_verbose_ : collision_request_simple_, res, *robot_state);
   if (!res.collision)
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markValid();
+    storeValidityCache(cache_key, true);
     return true;
   }
   else
   {
     const_cast<ob::State*>(state)->as<ModelBasedStateSpace::StateType>()->markInvalid();
+    storeValidityCache(cache_key, false);
     return false;
   }
 }
@@ -269,7 +367,7 @@ bool ompl_interface::StateValidityChecker::isValidWithCache(const ompl::base::St
 
   // check collision avoidance
   collision_detection::CollisionResult res;
-  planning_context_->getPlanningScene()->checkCollision(
+  getCollisionSession().checkCollision(
       verbose ? collision_request_with_distance_verbose_ : collision_request_with_distance_, res, *robot_state);
   dist = res.distance;
   return !res.collision;
@@ -0,0 +1,195 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/ompl_interface/detail/vectorized_nearest_neighbors.h>
+#include <ompl/util/Exception.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+ompl_interface::VectorizedNearestNeighbors::VectorizedNearestNeighbors(const ModelBasedStateSpace* space)
+  : ompl::NearestNeighbors<ompl::base::State*>()
+  , space_(space)
+  , variable_count_(space->getDimension())
+  , use_block_kernels_(space->hasFlatKernels())
+{
+}
+
+void ompl_interface::VectorizedNearestNeighbors::setDistanceFunction(const DistanceFunction& dist_fun)
+{
+  ompl::NearestNeighbors<ompl::base::State*>::setDistanceFunction(dist_fun);
+  use_block_kernels_ = false;
+}
+
+bool ompl_interface::VectorizedNearestNeighbors::reportsSortedResults() const
+{
+  return true;
+}
+
+void ompl_interface::VectorizedNearestNeighbors::clear()
+{
+  elements_.clear();
+  blocks_.clear();
+}
+
+void ompl_interface::VectorizedNearestNeighbors::add(ompl::base::State* const& data)
+{
+  const unsigned int lane = elements_.size() % BLOCK_LANES;
+  if (lane == 0)
+    blocks_.push_back(std::vector<double>(static_cast<std::size_t>(variable_count_) * BLOCK_LANES, 0.0));
+  std::vector<double>& block = blocks_.back();
+  const double* values = data->as<ModelBasedStateSpace::StateType>()->values;
+  for (unsigned int v = 0; v < variable_count_; ++v)
+    block[v * BLOCK_LANES + lane] = values[v];
+  elements_.push_back(data);
+}
+
+bool ompl_interface::VectorizedNearestNeighbors::remove(ompl::base::State* const& data)
+{
+  std::vector<ompl::base::State*>::iterator it = std::find(elements_.begin(), elements_.end(), data);
+  if (it == elements_.end())
+    return false;
+  // move the last element into the vacated slot so the blocks stay dense
+  const std::size_t index = it - elements_.begin();
+  const std::size_t last = elements_.size() - 1;
+  if (index != last)
+  {
+    elements_[index] = elements_[last];
+    std::vector<double>& dest_block = blocks_[index / BLOCK_LANES];
+    const std::vector<double>& src_block = blocks_[last / BLOCK_LANES];
+    const unsigned int dest_lane = index % BLOCK_LANES;
+    const unsigned int src_lane = last % BLOCK_LANES;
+    for (unsigned int v = 0; v < variable_count_; ++v)
+      dest_block[v * BLOCK_LANES + dest_lane] = src_block[v * BLOCK_LANES + src_lane];
+  }
+  elements_.pop_back();
+  if (elements_.size() <= (blocks_.size() - 1) * BLOCK_LANES)
+    blocks_.pop_back();
+  return true;
+}
+
+double ompl_interface::VectorizedNearestNeighbors::distanceToElement(const ompl::base::State* data,
+                                                                     std::size_t index) const
+{
+  if (distFun_)
+    return distFun_(const_cast<ompl::base::State*>(data), elements_[index]);
+  return space_->distance(data, elements_[index]);
+}
+
+void ompl_interface::VectorizedNearestNeighbors::distancesTo(const ompl::base::State* data,
+                                                             std::vector<double>& distances) const
+{
+  distances.resize(elements_.size());
+  if (elements_.empty())
+    return;
+  if (use_block_kernels_)
+  {
+    const double* query = data->as<ModelBasedStateSpace::StateType>()->values;
+    std::size_t offset = 0;
+    for (std::size_t b = 0; b < blocks_.size(); ++b)
+    {
+      const unsigned int count =
+          std::min<std::size_t>(BLOCK_LANES, elements_.size() - offset);
+      if (!space_->distanceBlock(query, &blocks_[b][0], BLOCK_LANES, count, &distances[offset]))
+      {
+        // the space refused the flat kernels (e.g. a custom distance function was installed on it
+        // after construction); recompute everything pairwise from here on
+        const_cast<VectorizedNearestNeighbors*>(this)->use_block_kernels_ = false;
+        break;
+      }
+      offset += count;
+    }
+    if (use_block_kernels_)
+      return;
+  }
+  for (std::size_t i = 0; i < elements_.size(); ++i)
+    distances[i] = distanceToElement(data, i);
+}
+
+ompl::base::State* ompl_interface::VectorizedNearestNeighbors::nearest(ompl::base::State* const& data) const
+{
+  if (elements_.empty())
+    throw ompl::Exception("No elements found in nearest neighbors data structure");
+  std::vector<double> distances;
+  distancesTo(data, distances);
+  return elements_[std::min_element(distances.begin(), distances.end()) - distances.begin()];
+}
+
+void ompl_interface::VectorizedNearestNeighbors::nearestK(ompl::base::State* const& data, std::size_t k,
+                                                          std::vector<ompl::base::State*>& nbh) const
+{
+  nbh.clear();
+  if (k == 0 || elements_.empty())
+    return;
+  std::vector<double> distances;
+  distancesTo(data, distances);
+  std::vector<std::size_t> order(elements_.size());
+  std::iota(order.begin(), order.end(), 0);
+  k = std::min(k, elements_.size());
+  std::partial_sort(order.begin(), order.begin() + k, order.end(),
+                    [&distances](std::size_t a, std::size_t b) { return distances[a] < distances[b]; });
+  nbh.reserve(k);
+  for (std::size_t i = 0; i < k; ++i)
+    nbh.push_back(elements_[order[i]]);
+}
+
+void ompl_interface::VectorizedNearestNeighbors::nearestR(ompl::base::State* const& data, double radius,
+                                                          std::vector<ompl::base::State*>& nbh) const
+{
+  nbh.clear();
+  if (elements_.empty())
+    return;
+  std::vector<double> distances;
+  distancesTo(data, distances);
+  std::vector<std::size_t> order;
+  for (std::size_t i = 0; i < elements_.size(); ++i)
+    if (distances[i] <= radius)
+      order.push_back(i);
+  std::sort(order.begin(), order.end(),
+            [&distances](std::size_t a, std::size_t b) { return distances[a] < distances[b]; });
+  nbh.reserve(order.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+    nbh.push_back(elements_[order[i]]);
+}
+
+std::size_t ompl_interface::VectorizedNearestNeighbors::size() const
+{
+  return elements_.size();
+}
+
+void ompl_interface::VectorizedNearestNeighbors::list(std::vector<ompl::base::State*>& data) const
+{
+  data = elements_;
+}
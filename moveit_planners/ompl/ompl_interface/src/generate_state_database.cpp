@@ -74,6 +74,9 @@ struct GenerateStateDatabaseParameters
     construction_opts.state_space_parameterization =
         nh.param<std::string>("state_space_parameterization", "JointModel");
 
+    // number of worker threads for sampling and connecting states (0 uses all hardware threads)
+    construction_opts.n_threads = nh.param("n_threads", 1);
+
     output_folder = nh.param<std::string>("output_folder", "constraint_approximations_database");
 
     if (!nh.getParam("planning_group", planning_group))
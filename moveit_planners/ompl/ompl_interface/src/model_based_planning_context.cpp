@@ -35,14 +35,18 @@
 /* Author: Ioan Sucan */
 
 #include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
 
 #include <moveit/ompl_interface/model_based_planning_context.h>
 #include <moveit/ompl_interface/detail/state_validity_checker.h>
+#include <moveit/ompl_interface/detail/clearance_adaptive_motion_validator.h>
 #include <moveit/ompl_interface/detail/constrained_sampler.h>
 #include <moveit/ompl_interface/detail/constrained_goal_sampler.h>
 #include <moveit/ompl_interface/detail/goal_union.h>
 #include <moveit/ompl_interface/detail/projection_evaluators.h>
 #include <moveit/ompl_interface/constraints_library.h>
+#include <moveit/ompl_interface/roadmap_cache.h>
 #include <moveit/kinematic_constraints/utils.h>
 #include <moveit/profiler/profiler.h>
 #include <moveit/utils/lexical_casts.h>
@@ -52,6 +56,16 @@
 #include <ompl/tools/config/SelfConfig.h>
 #include <ompl/base/spaces/SE3StateSpace.h>
 #include <ompl/datastructures/PDF.h>
+#include <ompl/geometric/PathSimplifier.h>
+#include <ompl/geometric/planners/prm/PRM.h>
+
+#include <algorithm>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "ompl/base/objectives/PathLengthOptimizationObjective.h"
 #include "ompl/base/objectives/MechanicalWorkOptimizationObjective.h"
@@ -67,6 +81,10 @@ ompl_interface::ModelBasedPlanningContext::ModelBasedPlanningContext(const std::
   , ompl_simple_setup_(spec.ompl_simple_setup_)
   , ompl_benchmark_(*ompl_simple_setup_)
   , ompl_parallel_plan_(ompl_simple_setup_->getProblemDefinition())
+  , roadmap_scene_signature_(0)
+  , use_roadmap_cache_(false)
+  , goal_sampling_threads_(1)
+  , simplifier_threads_(1)
   , ptc_(nullptr)
   , last_plan_time_(0.0)
   , last_simplify_time_(0.0)
@@ -314,6 +332,105 @@ void ompl_interface::ModelBasedPlanningContext::useConfig()
 
   ompl_simple_setup_->setOptimizationObjective(objective);
 
+  // configure the set of planners raced against each other, if specified
+  race_planner_allocators_.clear();
+  it = cfg.find("planner_race");
+  if (it != cfg.end())
+  {
+    boost::char_separator<char> sep(" ");
+    boost::tokenizer<boost::char_separator<char> > tok(it->second, sep);
+    for (boost::tokenizer<boost::char_separator<char> >::iterator beg = tok.begin(); beg != tok.end(); ++beg)
+    {
+      ConfiguredPlannerAllocator pa = spec_.planner_selector_(*beg);
+      if (pa)
+        race_planner_allocators_.push_back(
+            std::bind(pa, std::placeholders::_1, std::string(), std::cref(spec_)));
+    }
+    cfg.erase(it);
+    if (!race_planner_allocators_.empty())
+      ROS_INFO_NAMED("model_based_planning_context",
+                     "%s: Racing %zu planners; the first solution found terminates the others", name_.c_str(),
+                     race_planner_allocators_.size());
+  }
+
+  // restrict the planning threads of this context to a set of processors, if requested
+  it = cfg.find("planning_cpu_affinity");
+  if (it != cfg.end())
+  {
+    planning_cpu_affinity_.clear();
+    boost::char_separator<char> sep(" ");
+    boost::tokenizer<boost::char_separator<char> > tok(it->second, sep);
+    for (boost::tokenizer<boost::char_separator<char> >::iterator beg = tok.begin(); beg != tok.end(); ++beg)
+    {
+      int cpu = boost::lexical_cast<int>(*beg);
+      if (cpu >= 0 && cpu < static_cast<int>(std::thread::hardware_concurrency()))
+        planning_cpu_affinity_.push_back(cpu);
+      else
+        ROS_WARN_NAMED("model_based_planning_context",
+                       "%s: Ignoring processor index %d in 'planning_cpu_affinity'; this host has %u processors",
+                       name_.c_str(), cpu, std::thread::hardware_concurrency());
+    }
+    cfg.erase(it);
+    if (!planning_cpu_affinity_.empty())
+      ROS_INFO_NAMED("model_based_planning_context", "%s: Planning threads will be restricted to %zu processors",
+                     name_.c_str(), planning_cpu_affinity_.size());
+  }
+
+  // validate motions adaptively, skipping over free space certified by clearance queries
+  it = cfg.find("clearance_workspace_factor");
+  if (it != cfg.end())
+  {
+    double workspace_factor = moveit::core::toDouble(it->second);
+    cfg.erase(it);
+    if (workspace_factor > 0.0)
+    {
+      ompl_simple_setup_->getSpaceInformation()->setMotionValidator(ompl::base::MotionValidatorPtr(
+          new ClearanceAdaptiveMotionValidator(ompl_simple_setup_->getSpaceInformation(), workspace_factor)));
+      ROS_INFO_NAMED("model_based_planning_context",
+                     "%s: Using clearance-adaptive motion validation (workspace factor %lf); "
+                     "the factor must upper bound the robot's point motion per unit of configuration space distance",
+                     name_.c_str(), workspace_factor);
+    }
+    else
+      ROS_WARN_NAMED("model_based_planning_context",
+                     "%s: Ignoring non-positive 'clearance_workspace_factor'; using fixed-resolution "
+                     "motion validation",
+                     name_.c_str());
+  }
+
+  // number of IK worker threads producing goal states, if goal sampling should be decoupled
+  it = cfg.find("goal_sampler_threads");
+  if (it != cfg.end())
+  {
+    goal_sampling_threads_ = boost::lexical_cast<unsigned int>(it->second);
+    cfg.erase(it);
+    if (goal_sampling_threads_ > 1)
+      ROS_INFO_NAMED("model_based_planning_context", "%s: Goal states will be produced by %u IK worker threads",
+                     name_.c_str(), goal_sampling_threads_);
+  }
+
+  // number of threads simplifying sections of the solution path concurrently
+  it = cfg.find("simplifier_threads");
+  if (it != cfg.end())
+  {
+    simplifier_threads_ = boost::lexical_cast<unsigned int>(it->second);
+    cfg.erase(it);
+    if (simplifier_threads_ > 1)
+      ROS_INFO_NAMED("model_based_planning_context", "%s: Solution paths will be simplified using %u threads",
+                     name_.c_str(), simplifier_threads_);
+  }
+
+  // enable the multi-query roadmap cache, if requested for this configuration
+  it = cfg.find("multi_query_roadmap");
+  if (it != cfg.end())
+  {
+    use_roadmap_cache_ = boost::lexical_cast<bool>(it->second);
+    cfg.erase(it);
+    if (use_roadmap_cache_)
+      ROS_INFO_NAMED("model_based_planning_context", "%s: Reusing multi-query roadmaps across planning requests",
+                     name_.c_str());
+  }
+
   // remove the 'type' parameter; the rest are parameters for the planner itself
   it = cfg.find("type");
   if (it == cfg.end())
@@ -360,10 +477,67 @@ void ompl_interface::ModelBasedPlanningContext::setPlanningVolume(const moveit_m
 
 void ompl_interface::ModelBasedPlanningContext::simplifySolution(double timeout)
 {
+  // the number of iterations the simplifier performs internally is not observable through OMPL,
+  // so we count the simplification passes themselves
+  if (moveit::tools::Profiler::Running())
+    moveit::tools::Profiler::Event("PlanningContext.simplifySolution");
+
+  // the parallel simplifier needs a positive time slice for its deadline and enough waypoints
+  // for every worker to get a non-trivial section
+  if (simplifier_threads_ > 1 && timeout > 0.0 && ompl_simple_setup_->haveSolutionPath() &&
+      ompl_simple_setup_->getSolutionPath().getStateCount() > 2 * simplifier_threads_)
+  {
+    parallelSimplifySolution(timeout);
+    return;
+  }
   ompl_simple_setup_->simplifySolution(timeout);
   last_simplify_time_ = ompl_simple_setup_->getLastSimplificationTime();
 }
 
+void ompl_interface::ModelBasedPlanningContext::parallelSimplifySolution(double timeout)
+{
+  ompl::time::point start = ompl::time::now();
+  const ob::SpaceInformationPtr& si = ompl_simple_setup_->getSpaceInformation();
+  og::PathGeometric& path = ompl_simple_setup_->getSolutionPath();
+  const std::size_t state_count = path.getStateCount();
+  const std::size_t n_threads = std::min<std::size_t>(simplifier_threads_, (state_count - 1) / 2);
+
+  // split the path into contiguous sections at shared waypoints; each section is simplified
+  // independently and the fixed section endpoints keep the stitched path connected
+  std::vector<og::PathGeometric> sections(n_threads, og::PathGeometric(si));
+  for (std::size_t i = 0; i < n_threads; ++i)
+  {
+    const std::size_t from = i * (state_count - 1) / n_threads;
+    const std::size_t to = (i + 1) * (state_count - 1) / n_threads;
+    for (std::size_t j = from; j <= to; ++j)
+      sections[i].append(path.getState(j));
+  }
+
+  // the deadline makes each worker return the best simplification achieved within the time slice
+  ob::PlannerTerminationCondition ptc = ob::timedPlannerTerminationCondition(timeout);
+  std::vector<std::thread> workers;
+  workers.reserve(n_threads);
+  for (std::size_t i = 0; i < n_threads; ++i)
+    workers.emplace_back([&, i] {
+      // one simplifier per worker; motion validation goes through the thread-safe validity checker
+      og::PathSimplifier simplifier(si);
+      simplifier.simplify(sections[i], ptc);
+    });
+  for (std::size_t i = 0; i < n_threads; ++i)
+    workers[i].join();
+
+  og::PathGeometric simplified(si);
+  for (std::size_t i = 0; i < n_threads; ++i)
+    for (std::size_t j = i == 0 ? 0 : 1; j < sections[i].getStateCount(); ++j)
+      simplified.append(sections[i].getState(j));
+  path = simplified;
+
+  last_simplify_time_ = ompl::time::seconds(ompl::time::now() - start);
+  ROS_DEBUG_NAMED("model_based_planning_context", "%s: Simplified solution path from %zu to %zu states using %zu "
+                                                  "threads in %lf seconds",
+                  name_.c_str(), state_count, simplified.getStateCount(), n_threads, last_simplify_time_);
+}
+
 void ompl_interface::ModelBasedPlanningContext::interpolateSolution()
 {
   if (ompl_simple_setup_->haveSolutionPath())
@@ -431,7 +605,7 @@ ompl::base::GoalPtr ompl_interface::ModelBasedPlanningContext::constructGoal()
                                                             goal_constraint->getAllConstraints());
     if (cs)
     {
-      ob::GoalPtr g = ob::GoalPtr(new ConstrainedGoalSampler(this, goal_constraint, cs));
+      ob::GoalPtr g = ob::GoalPtr(new ConstrainedGoalSampler(this, goal_constraint, cs, goal_sampling_threads_));
       goals.push_back(g);
     }
   }
@@ -459,6 +633,7 @@ void ompl_interface::ModelBasedPlanningContext::clear()
   ompl_simple_setup_->setStateValidityChecker(ob::StateValidityCheckerPtr());
   path_constraints_.reset();
   goal_constraints_.clear();
+  seed_trajectories_.clear();
   getOMPLStateSpace()->setInterpolationFunction(InterpolationFunction());
 }
 
@@ -638,22 +813,103 @@ bool ompl_interface::ModelBasedPlanningContext::solve(planning_interface::Motion
   }
 }
 
+namespace
+{
+// Applies a processor affinity mask to the calling thread for the duration of a scope.
+// Threads spawned inside the scope (the parallel planner and validity checking threads)
+// inherit the mask, so the memory they first touch is allocated from the node of the
+// selected processors. Only effective on Linux; a no-op elsewhere.
+class ScopedThreadAffinity
+{
+public:
+  ScopedThreadAffinity(const std::vector<int>& cpus, const std::string& context_name) : restore_(false)
+  {
+#ifdef __linux__
+    if (cpus.empty())
+      return;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu : cpus)
+      CPU_SET(cpu, &mask);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &previous_) == 0 &&
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask) == 0)
+      restore_ = true;
+    else
+      ROS_WARN_NAMED("model_based_planning_context", "%s: Unable to apply processor affinity to planning threads",
+                     context_name.c_str());
+#else
+    (void)cpus;
+    (void)context_name;
+#endif
+  }
+
+  ~ScopedThreadAffinity()
+  {
+#ifdef __linux__
+    if (restore_)
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &previous_);
+#endif
+  }
+
+private:
+#ifdef __linux__
+  cpu_set_t previous_;
+#endif
+  bool restore_;
+};
+}  // namespace
+
 bool ompl_interface::ModelBasedPlanningContext::solve(double timeout, unsigned int count)
 {
   moveit::tools::Profiler::ScopedBlock sblock("PlanningContext:Solve");
   ompl::time::point start = ompl::time::now();
   preSolve();
 
+  // a valid seed trajectory is a solution; skip the planner entirely
+  if (trySeedTrajectories())
+  {
+    last_plan_time_ = ompl::time::seconds(ompl::time::now() - start);
+    postSolve();
+    return true;
+  }
+
+  // pin this thread before planners are constructed; the planner threads spawned below inherit
+  // the mask, so planner and state space data structures are first-touched on the configured node
+  ScopedThreadAffinity affinity_guard(planning_cpu_affinity_, name_);
+
   bool result = false;
   if (count <= 1)
   {
-    ROS_DEBUG_NAMED("model_based_planning_context", "%s: Solving the planning problem once...", name_.c_str());
-    ob::PlannerTerminationCondition ptc =
-        ob::timedPlannerTerminationCondition(timeout - ompl::time::seconds(ompl::time::now() - start));
-    registerTerminationCondition(ptc);
-    result = ompl_simple_setup_->solve(ptc) == ompl::base::PlannerStatus::EXACT_SOLUTION;
-    last_plan_time_ = ompl_simple_setup_->getLastPlanComputationTime();
-    unregisterTerminationCondition();
+    if (!race_planner_allocators_.empty())
+    {
+      // race the configured heterogeneous planners against the same space information and
+      // validity checker; the first exact solution terminates the others
+      ROS_DEBUG_NAMED("model_based_planning_context", "%s: Racing %zu planners on the planning problem...",
+                      name_.c_str(), race_planner_allocators_.size());
+      ompl_parallel_plan_.clearHybridizationPaths();
+      ompl_parallel_plan_.clearPlanners();
+      for (const ob::PlannerAllocator& pa : race_planner_allocators_)
+        ompl_parallel_plan_.addPlanner(pa(ompl_simple_setup_->getSpaceInformation()));
+      ob::PlannerTerminationCondition ptc =
+          ob::timedPlannerTerminationCondition(timeout - ompl::time::seconds(ompl::time::now() - start));
+      registerTerminationCondition(ptc);
+      result = ompl_parallel_plan_.solve(ptc, 1, race_planner_allocators_.size(), false) ==
+               ompl::base::PlannerStatus::EXACT_SOLUTION;
+      last_plan_time_ = ompl::time::seconds(ompl::time::now() - start);
+      unregisterTerminationCondition();
+    }
+    else
+    {
+      ROS_DEBUG_NAMED("model_based_planning_context", "%s: Solving the planning problem once...", name_.c_str());
+      installWarmRoadmap();
+      ob::PlannerTerminationCondition ptc =
+          ob::timedPlannerTerminationCondition(timeout - ompl::time::seconds(ompl::time::now() - start));
+      registerTerminationCondition(ptc);
+      result = ompl_simple_setup_->solve(ptc) == ompl::base::PlannerStatus::EXACT_SOLUTION;
+      last_plan_time_ = ompl_simple_setup_->getLastPlanComputationTime();
+      unregisterTerminationCondition();
+      harvestRoadmap();
+    }
   }
   else
   {
@@ -719,6 +975,102 @@ bool ompl_interface::ModelBasedPlanningContext::solve(double timeout, unsigned i
   return result;
 }
 
+void ompl_interface::ModelBasedPlanningContext::setSeedTrajectories(
+    const std::vector<robot_trajectory::RobotTrajectoryPtr>& seed_trajectories)
+{
+  seed_trajectories_ = seed_trajectories;
+}
+
+bool ompl_interface::ModelBasedPlanningContext::trySeedTrajectories()
+{
+  if (seed_trajectories_.empty())
+    return false;
+
+  const ob::SpaceInformationPtr& si = ompl_simple_setup_->getSpaceInformation();
+  if (!si->isSetup())
+    si->setup();
+  const ob::GoalPtr& goal = ompl_simple_setup_->getGoal();
+  if (!goal)
+    return false;
+
+  ob::ScopedState<> work(spec_.state_space_);
+  for (std::size_t i = 0; i < seed_trajectories_.size(); ++i)
+  {
+    const robot_trajectory::RobotTrajectoryPtr& seed = seed_trajectories_[i];
+    if (!seed || seed->empty() || seed->getGroupName() != getGroupName())
+      continue;
+
+    // the seed was recorded for a nearby request, so splice it onto the exact start state of
+    // this one; the splice motion is validated together with the rest of the path
+    std::shared_ptr<og::PathGeometric> path(new og::PathGeometric(si));
+    spec_.state_space_->copyToOMPLState(work.get(), getCompleteInitialRobotState());
+    path->append(work.get());
+    for (std::size_t j = 0; j < seed->getWayPointCount(); ++j)
+    {
+      spec_.state_space_->copyToOMPLState(work.get(), seed->getWayPoint(j));
+      path->append(work.get());
+    }
+    if (!goal->isSatisfied(path->getState(path->getStateCount() - 1)))
+      continue;
+    if (!path->check())
+      continue;
+    ompl_simple_setup_->getProblemDefinition()->addSolutionPath(path, false, 0.0, getName());
+    ROS_DEBUG_NAMED("model_based_planning_context", "%s: Reusing seed trajectory %lu (%u states) as the solution",
+                    name_.c_str(), (unsigned long)i, path->getStateCount());
+    return true;
+  }
+  return false;
+}
+
+void ompl_interface::ModelBasedPlanningContext::installWarmRoadmap()
+{
+  if (!use_roadmap_cache_ || !roadmap_cache_)
+    return;
+
+  // only the planners that can be constructed from previously grown planner data can start warm;
+  // SPARS and the lazy PRM variants do not expose such a constructor
+  std::map<std::string, std::string>::const_iterator it = spec_.config_.find("type");
+  if (it == spec_.config_.end() || (it->second != "geometric::PRM" && it->second != "geometric::PRMstar"))
+    return;
+
+  ompl::base::PlannerDataPtr data = roadmap_cache_->fetchRoadmap(roadmapCacheKey(), roadmap_scene_signature_,
+                                                                 ompl_simple_setup_->getSpaceInformation());
+  if (!data)
+    return;
+
+  ob::PlannerPtr planner(new og::PRM(*data, it->second == "geometric::PRMstar"));
+  planner->params().setParams(spec_.config_, true);
+  ompl_simple_setup_->setPlanner(planner);
+  ompl_simple_setup_->setup();
+  ROS_DEBUG_NAMED("model_based_planning_context", "%s: Starting from a warm roadmap with %u vertices", name_.c_str(),
+                  data->numVertices());
+}
+
+void ompl_interface::ModelBasedPlanningContext::harvestRoadmap()
+{
+  if (!use_roadmap_cache_ || !roadmap_cache_)
+    return;
+
+  std::map<std::string, std::string>::const_iterator it = spec_.config_.find("type");
+  if (it == spec_.config_.end() || (it->second != "geometric::PRM" && it->second != "geometric::PRMstar"))
+    return;
+
+  const ob::PlannerPtr& planner = ompl_simple_setup_->getPlanner();
+  if (!planner)
+    return;
+
+  ompl::base::PlannerDataPtr data(new ompl::base::PlannerData(ompl_simple_setup_->getSpaceInformation()));
+  planner->getPlannerData(*data);
+  if (data->numVertices() == 0)
+    return;
+
+  // clone the states out of the planner so the roadmap outlives it
+  data->decoupleFromPlanner();
+  roadmap_cache_->storeRoadmap(roadmapCacheKey(), roadmap_scene_signature_, data);
+  ROS_DEBUG_NAMED("model_based_planning_context", "%s: Cached a roadmap with %u vertices for later requests",
+                  name_.c_str(), data->numVertices());
+}
+
 void ompl_interface::ModelBasedPlanningContext::registerTerminationCondition(const ob::PlannerTerminationCondition& ptc)
 {
   std::unique_lock<std::mutex> slock(ptc_lock_);
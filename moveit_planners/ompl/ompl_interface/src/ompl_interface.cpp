@@ -56,6 +56,7 @@ ompl_interface::OMPLInterface::OMPLInterface(const robot_model::RobotModelConstP
   loadPlannerConfigurations();
   loadConstraintApproximations();
   loadConstraintSamplers();
+  prewarmPlanningContexts();
 }
 
 ompl_interface::OMPLInterface::OMPLInterface(const robot_model::RobotModelConstPtr& robot_model,
@@ -73,6 +74,7 @@ ompl_interface::OMPLInterface::OMPLInterface(const robot_model::RobotModelConstP
   setPlannerConfigurations(pconfig);
   loadConstraintApproximations();
   loadConstraintSamplers();
+  prewarmPlanningContexts();
 }
 
 ompl_interface::OMPLInterface::~OMPLInterface() = default;
@@ -173,6 +175,14 @@ void ompl_interface::OMPLInterface::loadConstraintSamplers()
       new constraint_sampler_manager_loader::ConstraintSamplerManagerLoader(constraint_sampler_manager_));
 }
 
+void ompl_interface::OMPLInterface::prewarmPlanningContexts()
+{
+  bool prewarm = false;
+  nh_.param("prewarm_planning_contexts", prewarm, false);
+  if (prewarm)
+    context_manager_.prewarmPlanningContexts();
+}
+
 bool ompl_interface::OMPLInterface::loadPlannerConfiguration(
     const std::string& group_name, const std::string& planner_id,
     const std::map<std::string, std::string>& group_params,
@@ -35,8 +35,90 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/ompl_interface/parameterization/model_based_state_space.h>
+#include <moveit/robot_model/revolute_joint_model.h>
+#include <boost/math/constants/constants.hpp>
 #include <utility>
 
+namespace
+{
+// Flat distance/interpolation kernels for groups whose active joints are all single-variable.
+// Templating on the presence of continuous joints lets the compiler drop the wrapping code and
+// vectorize the plain loop in the common all-bounded case.
+template <bool HAS_CONTINUOUS>
+double flatDistance(const double* values1, const double* values2, const double* weights,
+                    const unsigned char* continuous, unsigned int count)
+{
+  static const double PI = boost::math::constants::pi<double>();
+  double d = 0.0;
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    double diff = fabs(values1[i] - values2[i]);
+    if (HAS_CONTINUOUS && continuous[i])
+    {
+      diff = fmod(diff, 2.0 * PI);
+      if (diff > PI)
+        diff = 2.0 * PI - diff;
+    }
+    d += weights[i] * diff;
+  }
+  return d;
+}
+
+template <bool HAS_CONTINUOUS>
+void flatDistanceBlock(const double* query, const double* block, unsigned int stride, unsigned int count,
+                       const double* weights, const unsigned char* continuous, unsigned int variable_count,
+                       double* distances)
+{
+  static const double PI = boost::math::constants::pi<double>();
+  for (unsigned int j = 0; j < count; ++j)
+    distances[j] = 0.0;
+  for (unsigned int v = 0; v < variable_count; ++v)
+  {
+    const double* column = block + v * static_cast<std::size_t>(stride);
+    const double q = query[v];
+    const double w = weights[v];
+    if (HAS_CONTINUOUS && continuous[v])
+      // continuous joints are bounded to [-pi, pi], so |diff| <= 2*pi and the wrap reduces to a
+      // branchless min; this keeps the inner loop vectorizable
+      for (unsigned int j = 0; j < count; ++j)
+      {
+        double diff = fabs(column[j] - q);
+        distances[j] += w * std::min(diff, 2.0 * PI - diff);
+      }
+    else
+      for (unsigned int j = 0; j < count; ++j)
+        distances[j] += w * fabs(column[j] - q);
+  }
+}
+
+template <bool HAS_CONTINUOUS>
+void flatInterpolate(const double* from, const double* to, const double t, double* state,
+                     const unsigned char* continuous, unsigned int count)
+{
+  static const double PI = boost::math::constants::pi<double>();
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    double diff = to[i] - from[i];
+    if (HAS_CONTINUOUS && continuous[i] && fabs(diff) > PI)
+    {
+      // interpolate continuous joints along the shorter arc (same logic as RevoluteJointModel)
+      if (diff > 0.0)
+        diff = 2.0 * PI - diff;
+      else
+        diff = -2.0 * PI - diff;
+      state[i] = from[i] - diff * t;
+      // input states are within bounds, so the following check is sufficient
+      if (state[i] > PI)
+        state[i] -= 2.0 * PI;
+      else if (state[i] < -PI)
+        state[i] += 2.0 * PI;
+    }
+    else
+      state[i] = from[i] + diff * t;
+  }
+}
+}  // namespace
+
 ompl_interface::ModelBasedStateSpace::ModelBasedStateSpace(ModelBasedStateSpaceSpecification spec)
   : ompl::base::StateSpace(), spec_(std::move(spec))
 {
@@ -67,6 +149,8 @@ ompl_interface::ModelBasedStateSpace::ModelBasedStateSpace(ModelBasedStateSpaceS
     spec_.joint_bounds_[i] = &joint_bounds_storage_[i];
   }
 
+  setupFlatKernels();
+
   // default settings
   setTagSnapToSegment(0.95);
 
@@ -78,6 +162,38 @@ ompl_interface::ModelBasedStateSpace::ModelBasedStateSpace(ModelBasedStateSpaceS
 
 ompl_interface::ModelBasedStateSpace::~ModelBasedStateSpace() = default;
 
+void ompl_interface::ModelBasedStateSpace::setupFlatKernels()
+{
+  use_flat_kernels_ = false;
+  has_continuous_variables_ = false;
+  variable_distance_weights_.clear();
+  variable_continuous_.clear();
+
+  // mimic joints are updated by JointModelGroup::interpolate(), which the kernels bypass
+  if (!spec_.joint_model_group_->getMimicJointModels().empty())
+    return;
+
+  std::vector<double> weights;
+  std::vector<unsigned char> continuous;
+  for (const robot_model::JointModel* jm : joint_model_vector_)
+  {
+    if (jm->getVariableCount() != 1 ||
+        (jm->getType() != robot_model::JointModel::REVOLUTE && jm->getType() != robot_model::JointModel::PRISMATIC))
+      return;
+    weights.push_back(jm->getDistanceFactor());
+    continuous.push_back(jm->getType() == robot_model::JointModel::REVOLUTE &&
+                         static_cast<const robot_model::RevoluteJointModel*>(jm)->isContinuous());
+    if (continuous.back())
+      has_continuous_variables_ = true;
+  }
+  if (weights.size() != variable_count_)
+    return;
+
+  variable_distance_weights_.swap(weights);
+  variable_continuous_.swap(continuous);
+  use_flat_kernels_ = true;
+}
+
 double ompl_interface::ModelBasedStateSpace::getTagSnapToSegment() const
 {
   return tag_snap_to_segment_;
@@ -106,16 +222,31 @@ ompl::base::State* ompl_interface::ModelBasedStateSpace::allocState() const
 
 void ompl_interface::ModelBasedStateSpace::freeState(ompl::base::State* state) const
 {
-  delete[] state->as<StateType>()->values;
+  if (!(state->as<StateType>()->flags & StateType::IS_MAPPED_MEMORY))
+    delete[] state->as<StateType>()->values;
   delete state->as<StateType>();
 }
 
+ompl::base::State* ompl_interface::ModelBasedStateSpace::allocMappedState(double* values) const
+{
+  // allocState() is virtual, so derived state spaces allocate their full state type; only the
+  // values array is replaced with the aliased memory
+  ompl::base::State* state = allocState();
+  auto* mstate = state->as<StateType>();
+  delete[] mstate->values;
+  mstate->values = values;
+  mstate->flags |= StateType::IS_MAPPED_MEMORY;
+  return state;
+}
+
 void ompl_interface::ModelBasedStateSpace::copyState(ompl::base::State* destination,
                                                      const ompl::base::State* source) const
 {
   memcpy(destination->as<StateType>()->values, source->as<StateType>()->values, state_values_size_);
   destination->as<StateType>()->tag = source->as<StateType>()->tag;
-  destination->as<StateType>()->flags = source->as<StateType>()->flags;
+  // memory ownership stays with the destination state; all other flags are copied
+  destination->as<StateType>()->flags = (destination->as<StateType>()->flags & StateType::IS_MAPPED_MEMORY) |
+                                        (source->as<StateType>()->flags & ~StateType::IS_MAPPED_MEMORY);
   destination->as<StateType>()->distance = source->as<StateType>()->distance;
 }
 
@@ -168,8 +299,29 @@ double ompl_interface::ModelBasedStateSpace::distance(const ompl::base::State* s
 {
   if (distance_function_)
     return distance_function_(state1, state2);
+  if (use_flat_kernels_)
+  {
+    if (has_continuous_variables_)
+      return flatDistance<true>(state1->as<StateType>()->values, state2->as<StateType>()->values,
+                                &variable_distance_weights_[0], &variable_continuous_[0], variable_count_);
+    return flatDistance<false>(state1->as<StateType>()->values, state2->as<StateType>()->values,
+                               &variable_distance_weights_[0], &variable_continuous_[0], variable_count_);
+  }
+  return spec_.joint_model_group_->distance(state1->as<StateType>()->values, state2->as<StateType>()->values);
+}
+
+bool ompl_interface::ModelBasedStateSpace::distanceBlock(const double* query, const double* block, unsigned int stride,
+                                                         unsigned int count, double* distances) const
+{
+  if (!use_flat_kernels_ || distance_function_)
+    return false;
+  if (has_continuous_variables_)
+    flatDistanceBlock<true>(query, block, stride, count, &variable_distance_weights_[0], &variable_continuous_[0],
+                            variable_count_, distances);
   else
-    return spec_.joint_model_group_->distance(state1->as<StateType>()->values, state2->as<StateType>()->values);
+    flatDistanceBlock<false>(query, block, stride, count, &variable_distance_weights_[0], &variable_continuous_[0],
+                             variable_count_, distances);
+  return true;
 }
 
 bool ompl_interface::ModelBasedStateSpace::equalStates(const ompl::base::State* state1,
@@ -202,8 +354,18 @@ void ompl_interface::ModelBasedStateSpace::interpolate(const ompl::base::State*
   if (!interpolation_function_ || !interpolation_function_(from, to, t, state))
   {
     // perform the actual interpolation
-    spec_.joint_model_group_->interpolate(from->as<StateType>()->values, to->as<StateType>()->values, t,
-                                          state->as<StateType>()->values);
+    if (use_flat_kernels_)
+    {
+      if (has_continuous_variables_)
+        flatInterpolate<true>(from->as<StateType>()->values, to->as<StateType>()->values, t,
+                              state->as<StateType>()->values, &variable_continuous_[0], variable_count_);
+      else
+        flatInterpolate<false>(from->as<StateType>()->values, to->as<StateType>()->values, t,
+                               state->as<StateType>()->values, &variable_continuous_[0], variable_count_);
+    }
+    else
+      spec_.joint_model_group_->interpolate(from->as<StateType>()->values, to->as<StateType>()->values, t,
+                                            state->as<StateType>()->values);
 
     // compute tag
     if (from->as<StateType>()->tag >= 0 && t < 1.0 - tag_snap_to_segment_)
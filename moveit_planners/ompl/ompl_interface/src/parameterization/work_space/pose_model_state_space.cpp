@@ -38,10 +38,15 @@
 #include <ompl/base/spaces/SE3StateSpace.h>
 #include <moveit/profiler/profiler.h>
 
+#include <cmath>
+#include <cstring>
 #include <utility>
 
 const std::string ompl_interface::PoseModelStateSpace::PARAMETERIZATION_TYPE = "PoseModel";
 
+// once this many IK solutions are cached, the cache is dropped and starts over
+static const std::size_t MAX_INTERPOLATION_IK_CACHE_SIZE = 8192;
+
 ompl_interface::PoseModelStateSpace::PoseModelStateSpace(const ModelBasedStateSpaceSpecification& spec)
   : ModelBasedStateSpace(spec)
 {
@@ -148,8 +153,31 @@ void ompl_interface::PoseModelStateSpace::interpolate(const ompl::base::State* f
   */
 
   // after interpolation we cannot be sure about the joint values (we use them as seed only)
-  // so we recompute IK if needed
-  if (computeStateIK(state))
+  // so we recompute IK if needed; planners interpolate along the same edge many times over,
+  // so first check whether this pose/seed pair was solved before (the key must be computed
+  // now, while the values still hold the seed)
+  std::size_t key = interpolationCacheKey(state->as<StateType>());
+  bool joints_computed = false;
+  {
+    std::unique_lock<std::mutex> slock(interpolation_ik_cache_lock_);
+    std::unordered_map<std::size_t, std::vector<double>>::const_iterator it = interpolation_ik_cache_.find(key);
+    if (it != interpolation_ik_cache_.end())
+    {
+      memcpy(state->as<StateType>()->values, &it->second[0], variable_count_ * sizeof(double));
+      state->as<StateType>()->setJointsComputed(true);
+      joints_computed = true;
+    }
+  }
+  if (!joints_computed && computeStateIK(state))
+  {
+    std::unique_lock<std::mutex> slock(interpolation_ik_cache_lock_);
+    if (interpolation_ik_cache_.size() >= MAX_INTERPOLATION_IK_CACHE_SIZE)
+      interpolation_ik_cache_.clear();
+    interpolation_ik_cache_[key].assign(state->as<StateType>()->values,
+                                        state->as<StateType>()->values + variable_count_);
+    joints_computed = true;
+  }
+  if (joints_computed)
   {
     double dj = jump_factor_ * ModelBasedStateSpace::distance(from, to);
     double d_from = ModelBasedStateSpace::distance(from, state);
@@ -161,6 +189,29 @@ void ompl_interface::PoseModelStateSpace::interpolate(const ompl::base::State* f
   }
 }
 
+std::size_t ompl_interface::PoseModelStateSpace::interpolationCacheKey(const StateType* state) const
+{
+  // FNV-1a over the quantized pose coordinates and joint seed; the seed is part of the key
+  // because the IK solution depends on it
+  std::size_t h = 14695981039346656037ULL;
+  auto mix = [&h](long v) { h = (h ^ static_cast<std::size_t>(v)) * 1099511628211ULL; };
+  for (std::size_t i = 0; i < poses_.size(); ++i)
+  {
+    const ompl::base::SE3StateSpace::StateType* se3_state = state->poses[i];
+    mix(lround(se3_state->getX() * 1e6));
+    mix(lround(se3_state->getY() * 1e6));
+    mix(lround(se3_state->getZ() * 1e6));
+    const ompl::base::SO3StateSpace::StateType& so3_state = se3_state->rotation();
+    mix(lround(so3_state.x * 1e6));
+    mix(lround(so3_state.y * 1e6));
+    mix(lround(so3_state.z * 1e6));
+    mix(lround(so3_state.w * 1e6));
+  }
+  for (unsigned int i = 0; i < variable_count_; ++i)
+    mix(lround(state->values[i] * 1e4));
+  return h;
+}
+
 void ompl_interface::PoseModelStateSpace::setPlanningVolume(double minX, double maxX, double minY, double maxY,
                                                             double minZ, double maxZ)
 {
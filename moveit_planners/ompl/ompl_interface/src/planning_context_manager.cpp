@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/ompl_interface/planning_context_manager.h>
+#include <moveit/ompl_interface/roadmap_cache.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/profiler/profiler.h>
 #include <algorithm>
@@ -95,6 +96,7 @@ ompl_interface::PlanningContextManager::PlanningContextManager(robot_model::Robo
   , max_solution_segment_length_(0.0)
   , minimum_waypoint_count_(2)
 {
+  roadmap_cache_.reset(new RoadmapCache());
   cached_contexts_.reset(new CachedContexts());
   registerDefaultPlanners();
   registerDefaultStateSpaces();
@@ -226,6 +228,77 @@ void ompl_interface::PlanningContextManager::setPlannerConfigurations(
   planner_configs_ = pconfig;
 }
 
+void ompl_interface::PlanningContextManager::prewarmPlanningContexts()
+{
+  std::size_t n_contexts = 0;
+  for (const auto& pc : planner_configs_)
+  {
+    unsigned int pool_size = 1;
+    auto psize = pc.second.config.find("prewarm_contexts");
+    if (psize != pc.second.config.end())
+      pool_size = boost::lexical_cast<unsigned int>(psize->second);
+    if (pool_size == 0)
+      continue;
+
+    moveit_msgs::MotionPlanRequest req;  // dummy request with default values
+    req.group_name = pc.second.group;
+
+    // select the state space the same way a planning request for this group would
+    StateSpaceFactoryTypeSelector factory_selector;
+    auto it = pc.second.config.find("enforce_joint_model_state_space");
+    if (it != pc.second.config.end() && boost::lexical_cast<bool>(it->second))
+      factory_selector = std::bind(&PlanningContextManager::getStateSpaceFactory1, this, std::placeholders::_1,
+                                   JointModelStateSpace::PARAMETERIZATION_TYPE);
+    else
+      factory_selector = std::bind(&PlanningContextManager::getStateSpaceFactory2, this, std::placeholders::_1, req);
+    if (!factory_selector(pc.second.group))
+      continue;
+
+    auto type = pc.second.config.find("type");
+
+    // hold on to the contexts while filling the pool, so that every iteration allocates a fresh
+    // context instead of reusing the previous one; the references are dropped at the end of the
+    // scope, which marks the cached contexts as reusable
+    std::vector<ModelBasedPlanningContextPtr> pool;
+    pool.reserve(pool_size);
+    for (unsigned int i = 0; i < pool_size; ++i)
+    {
+      try
+      {
+        ModelBasedPlanningContextPtr context = getPlanningContext(pc.second, factory_selector, req);
+        if (!context)
+          break;
+        const og::SimpleSetupPtr& ss = context->getOMPLSimpleSetup();
+        // setting up the space information requires a validity checker; install a permissive
+        // placeholder, which is replaced with the real checker when the context is configured
+        if (!ss->getSpaceInformation()->isSetup())
+        {
+          ss->setStateValidityChecker(
+              ob::StateValidityCheckerPtr(new ob::AllValidStateValidityChecker(ss->getSpaceInformation())));
+          ss->getSpaceInformation()->setup();
+        }
+        // instantiate the configured planner up front as well
+        if (type != pc.second.config.end() && !ss->getPlanner())
+        {
+          ConfiguredPlannerAllocator pa = plannerSelector(type->second);
+          if (pa)
+            ss->setPlanner(pa(ss->getSpaceInformation(), pc.second.name != pc.second.group ? pc.second.name : "",
+                              context->getSpecification()));
+        }
+        pool.push_back(context);
+        ++n_contexts;
+      }
+      catch (ompl::Exception& ex)
+      {
+        ROS_WARN_NAMED("planning_context_manager", "Failed to pre-warm planning context for '%s': %s",
+                       pc.first.c_str(), ex.what());
+        break;
+      }
+    }
+  }
+  ROS_DEBUG_NAMED("planning_context_manager", "Pre-warmed %zu planning context(s)", n_contexts);
+}
+
 ompl_interface::ModelBasedPlanningContextPtr ompl_interface::PlanningContextManager::getPlanningContext(
     const std::string& config, const std::string& factory_type) const
 {
@@ -438,6 +511,7 @@ ompl_interface::PlanningContextManager::getPlanningContext(const planning_scene:
 
     // Setup the context
     context->setPlanningScene(planning_scene);
+    context->setRoadmapCache(roadmap_cache_, RoadmapCache::computeSceneSignature(planning_scene));
     context->setMotionPlanRequest(req);
     context->setCompleteInitialState(*start_state);
 
@@ -0,0 +1,160 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2012, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#include <moveit/ompl_interface/roadmap_cache.h>
+#include <geometric_shapes/shape_operations.h>
+#include <ompl/base/SpaceInformation.h>
+#include <ros/console.h>
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+// FNV-1a, folding in raw bytes; poses and extents are hashed bitwise, so the signature
+// detects any change in the world geometry, not approximate equality
+void hashBytes(std::uint64_t& hash, const void* data, std::size_t length)
+{
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < length; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+}
+}  // namespace
+
+std::uint64_t ompl_interface::RoadmapCache::computeSceneSignature(const planning_scene::PlanningSceneConstPtr& scene)
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  if (!scene)
+    return hash;
+
+  const collision_detection::WorldConstPtr& world = scene->getWorld();
+  // the world stores objects in a map, so iteration order is stable across requests
+  for (collision_detection::World::const_iterator it = world->begin(); it != world->end(); ++it)
+  {
+    const collision_detection::World::ObjectConstPtr& obj = it->second;
+    hashBytes(hash, obj->id_.data(), obj->id_.size());
+    for (std::size_t i = 0; i < obj->shapes_.size(); ++i)
+    {
+      const int type = obj->shapes_[i]->type;
+      hashBytes(hash, &type, sizeof(type));
+      const Eigen::Vector3d extents = shapes::computeShapeExtents(obj->shapes_[i].get());
+      hashBytes(hash, extents.data(), 3 * sizeof(double));
+      hashBytes(hash, obj->shape_poses_[i].matrix().data(), 16 * sizeof(double));
+    }
+  }
+  return hash;
+}
+
+std::size_t ompl_interface::RoadmapCache::pruneInvalidatedRoadmap(ompl::base::PlannerData& data,
+                                                                  const ompl::base::SpaceInformationPtr& si)
+{
+  std::size_t removed = 0;
+
+  // remove invalidated vertices first (this also drops their edges); iterate backwards so the
+  // indices of vertices not yet visited remain stable as removal renumbers higher indices
+  for (unsigned int v = data.numVertices(); v > 0; --v)
+    if (!si->isValid(data.getVertex(v - 1).getState()))
+    {
+      data.removeVertex(v - 1);
+      ++removed;
+    }
+
+  // then drop the edges whose motions pass through new obstacles
+  for (unsigned int v = 0; v < data.numVertices(); ++v)
+  {
+    std::vector<unsigned int> edges;
+    data.getEdges(v, edges);
+    for (std::size_t e = 0; e < edges.size(); ++e)
+      if (!si->checkMotion(data.getVertex(v).getState(), data.getVertex(edges[e]).getState()))
+      {
+        data.removeEdge(v, edges[e]);
+        ++removed;
+      }
+  }
+
+  return removed;
+}
+
+void ompl_interface::RoadmapCache::storeRoadmap(const std::string& key, std::uint64_t scene_signature,
+                                                const ompl::base::PlannerDataPtr& data)
+{
+  if (!data || data->numVertices() == 0)
+    return;
+
+  std::lock_guard<std::mutex> slock(lock_);
+  CachedRoadmap& entry = roadmaps_[key];
+  entry.scene_signature = scene_signature;
+  entry.data = data;
+}
+
+ompl::base::PlannerDataPtr ompl_interface::RoadmapCache::fetchRoadmap(const std::string& key,
+                                                                      std::uint64_t scene_signature,
+                                                                      const ompl::base::SpaceInformationPtr& si)
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  std::map<std::string, CachedRoadmap>::iterator it = roadmaps_.find(key);
+  if (it == roadmaps_.end())
+    return ompl::base::PlannerDataPtr();
+
+  // a roadmap can only be handed to planners operating on the space information it was built with
+  if (it->second.data->getSpaceInformation() != si)
+    return ompl::base::PlannerDataPtr();
+
+  if (it->second.scene_signature != scene_signature)
+  {
+    // the world geometry changed; prune the parts of the graph the new scene invalidates and
+    // keep the rest warm, instead of discarding the whole roadmap
+    std::size_t removed = pruneInvalidatedRoadmap(*it->second.data, si);
+    it->second.scene_signature = scene_signature;
+    ROS_DEBUG_NAMED("roadmap_cache", "Scene geometry changed for '%s'; pruned %zu invalidated roadmap elements, "
+                                     "%u vertices remain",
+                    key.c_str(), removed, it->second.data->numVertices());
+    if (it->second.data->numVertices() == 0)
+    {
+      roadmaps_.erase(it);
+      return ompl::base::PlannerDataPtr();
+    }
+  }
+
+  return it->second.data;
+}
+
+void ompl_interface::RoadmapCache::clear()
+{
+  std::lock_guard<std::mutex> slock(lock_);
+  roadmaps_.clear();
+}
@@ -38,6 +38,8 @@
 #define _SBPL_BFS_3D_H_
 
 #include <boost/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#include <vector>
 
 namespace sbpl_interface
 {
@@ -60,7 +62,14 @@ private:
 
   volatile bool running;
 
+  // frontier buffers of the level-synchronous parallel search
+  std::vector<int> parallel_frontier_;
+  std::vector<std::vector<int> > parallel_next_;
+  volatile bool stop_parallel_;
+
   void search(int, int, int volatile*, int*, int&, int&);
+  void searchParallel(int, int, unsigned int);
+  void parallelWorker(int, int, unsigned int, unsigned int, boost::barrier*);
   inline int getNode(int, int, int);
 
 public:
@@ -72,7 +81,9 @@ public:
   void setWall(int, int, int);
   bool isWall(int, int, int);
 
-  void run(int, int, int);
+  // starts the search from the given cell in a background thread; with num_threads > 1 the
+  // wavefront of each BFS level is expanded by that many worker threads
+  void run(int, int, int, unsigned int num_threads = 1);
 
   int getDistance(int, int, int);
 };
@@ -84,6 +84,7 @@ struct PlanningParameters
     , attempt_full_shortcut_(true)
     , interpolation_distance_(DEFAULT_INTERPOLATION_DISTANCE)
     , joint_motion_primitive_distance_(DEFAULT_JOINT_MOTION_PRIMITIVE_DISTANCE)
+    , bfs_threads_(1)
   {
   }
 
@@ -92,6 +93,31 @@ struct PlanningParameters
   bool attempt_full_shortcut_;
   double interpolation_distance_;
   double joint_motion_primitive_distance_;
+  unsigned int bfs_threads_;
+};
+
+/** Obstacle cells extracted from the distance fields during a previous call to
+    setupForMotionPlan. As the old API exposes no world diffs, the cache is keyed on the
+    identity and dimensions of the source distance fields; if they match, the wall cells
+    are replayed into the BFS grid instead of re-scanning both fields. */
+struct BFSWallCache
+{
+  BFSWallCache() : world_field_(NULL), self_field_(NULL), dim_x_(0), dim_y_(0), dim_z_(0)
+  {
+  }
+
+  bool matches(const void* world_field, const void* self_field, int dim_x, int dim_y, int dim_z) const
+  {
+    return world_field_ == world_field && self_field_ == self_field && dim_x_ == dim_x && dim_y_ == dim_y &&
+           dim_z_ == dim_z;
+  }
+
+  const void* world_field_;
+  const void* self_field_;
+  int dim_x_;
+  int dim_y_;
+  int dim_z_;
+  std::vector<int> wall_cells_;
 };
 
 /** Environment to be used when planning for a Robotic Arm using the SBPL. */
@@ -214,6 +240,13 @@ public:
                           const moveit_msgs::GetMotionPlan::Request& req, moveit_msgs::GetMotionPlan::Response& res,
                           const PlanningParameters& params);
 
+  /** @brief Provide a wall cache to reuse across planning episodes. The cache is consulted
+      and refreshed by setupForMotionPlan; it must outlive this environment. */
+  void setWallCache(BFSWallCache* wall_cache)
+  {
+    wall_cache_ = wall_cache;
+  }
+
   const EnvChain3DPlanningData& getPlanningData() const
   {
     return planning_data_;
@@ -245,6 +278,7 @@ protected:
 
   double angle_discretization_;
   BFS_3D* bfs_;
+  BFSWallCache* wall_cache_;
 
   std::vector<boost::shared_ptr<JointMotionWrapper> > joint_motion_wrappers_;
   std::vector<boost::shared_ptr<JointMotionPrimitive> > possible_actions_;
@@ -64,6 +64,10 @@ public:
 protected:
   PlanningStatistics last_planning_statistics_;
 
+  // wall cells recorded in the last episode; reused by the environment when the distance
+  // fields have not changed since then
+  BFSWallCache wall_cache_;
+
   // DummyEnvironment* dummy_env_;
   // SBPLPlanner *planner_;
 };
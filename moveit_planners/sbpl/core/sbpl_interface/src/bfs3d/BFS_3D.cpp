@@ -79,7 +79,7 @@ bool BFS_3D::isWall(int x, int y, int z)
   return distance_grid[node] == WALL;
 }
 
-void BFS_3D::run(int x, int y, int z)
+void BFS_3D::run(int x, int y, int z, unsigned int num_threads)
 {
   if (running)
   {
@@ -99,8 +99,17 @@ void BFS_3D::run(int x, int y, int z)
 
   distance_grid[origin] = 0;
 
-  search_thread_.reset(
-      new boost::thread(&BFS_3D::search, this, dim_x, dim_xy, distance_grid, queue, queue_head, queue_tail));
+  if (num_threads > 1)
+  {
+    stop_parallel_ = false;
+    parallel_frontier_.clear();
+    parallel_frontier_.push_back(origin);
+    parallel_next_.assign(num_threads, std::vector<int>());
+    search_thread_.reset(new boost::thread(&BFS_3D::searchParallel, this, dim_x, dim_xy, num_threads));
+  }
+  else
+    search_thread_.reset(
+        new boost::thread(&BFS_3D::search, this, dim_x, dim_xy, distance_grid, queue, queue_head, queue_tail));
   running = true;
 }
 
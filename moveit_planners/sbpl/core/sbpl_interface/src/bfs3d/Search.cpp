@@ -1,6 +1,7 @@
 #include <sbpl_interface/bfs3d/BFS_3D.h>
 #include <iostream>
 #include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 namespace sbpl_interface
 {
@@ -49,4 +50,94 @@ void BFS_3D::search(int width, int planeSize, int volatile* distance_grid, int*
   // std::cerr << "Search thread done" << std::endl;
   running = false;
 }
+
+// same expansion as above, but cells are claimed with a compare-and-swap so several workers can
+// expand one BFS level concurrently; UNDISCOVERED is -1 as an int, so < 0 means unclaimed
+#define EXPAND_NEIGHBOR_PARALLEL(offset)                                                                               \
+  {                                                                                                                    \
+    int neighbor = currentNode + offset;                                                                               \
+    if (distance_grid[neighbor] < 0 &&                                                                                 \
+        __sync_bool_compare_and_swap((int*)(distance_grid + neighbor), (int)UNDISCOVERED, currentCost))                \
+      next.push_back(neighbor);                                                                                        \
+  }
+
+void BFS_3D::parallelWorker(int width, int planeSize, unsigned int thread_index, unsigned int num_threads,
+                            boost::barrier* level_barrier)
+{
+  while (true)
+  {
+    // the frontier is only modified by thread 0 between the two barriers, so after this wait
+    // every worker sees the same (stable) frontier for the level
+    level_barrier->wait();
+    if (parallel_frontier_.empty())
+      break;
+
+    std::vector<int>& next = parallel_next_[thread_index];
+    for (size_t i = thread_index; i < parallel_frontier_.size(); i += num_threads)
+    {
+      int currentNode = parallel_frontier_[i];
+      int currentCost = distance_grid[currentNode] + 1;
+
+      EXPAND_NEIGHBOR_PARALLEL(-width);
+      EXPAND_NEIGHBOR_PARALLEL(1);
+      EXPAND_NEIGHBOR_PARALLEL(width);
+      EXPAND_NEIGHBOR_PARALLEL(-1);
+      EXPAND_NEIGHBOR_PARALLEL(-width - 1);
+      EXPAND_NEIGHBOR_PARALLEL(-width + 1);
+      EXPAND_NEIGHBOR_PARALLEL(width + 1);
+      EXPAND_NEIGHBOR_PARALLEL(width - 1);
+      EXPAND_NEIGHBOR_PARALLEL(planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(-width + planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(1 + planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(width + planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(-1 + planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(-width - 1 + planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(-width + 1 + planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(width + 1 + planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(width - 1 + planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(-planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(-width - planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(1 - planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(width - planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(-1 - planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(-width - 1 - planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(-width + 1 - planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(width + 1 - planeSize);
+      EXPAND_NEIGHBOR_PARALLEL(width - 1 - planeSize);
+    }
+
+    level_barrier->wait();
+    if (thread_index == 0)
+    {
+      // workers loop back and block on the first barrier until thread 0 finishes the merge
+      parallel_frontier_.clear();
+      for (unsigned int t = 0; t < num_threads; t++)
+      {
+        if (!stop_parallel_)
+          parallel_frontier_.insert(parallel_frontier_.end(), parallel_next_[t].begin(), parallel_next_[t].end());
+        parallel_next_[t].clear();
+      }
+    }
+  }
+}
+
+void BFS_3D::searchParallel(int width, int planeSize, unsigned int num_threads)
+{
+  boost::barrier level_barrier(num_threads);
+  boost::thread_group workers;
+  for (unsigned int i = 0; i < num_threads; i++)
+    workers.create_thread(boost::bind(&BFS_3D::parallelWorker, this, width, planeSize, i, num_threads, &level_barrier));
+  try
+  {
+    workers.join_all();
+  }
+  catch (boost::thread_interrupted&)
+  {
+    // thread 0 empties the frontier once the stop flag is set, so the workers wind down together
+    stop_parallel_ = true;
+    boost::this_thread::disable_interruption no_interruption;
+    workers.join_all();
+  }
+  running = false;
+}
 }
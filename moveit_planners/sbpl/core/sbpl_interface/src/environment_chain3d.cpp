@@ -50,6 +50,7 @@ namespace sbpl_interface
 EnvironmentChain3D::EnvironmentChain3D(const planning_scene::PlanningSceneConstPtr& planning_scene)
   : planning_scene_(planning_scene)
   , bfs_(NULL)
+  , wall_cache_(NULL)
   , state_(planning_scene->getCurrentState())
   , planning_data_(StateID2IndexMapping)
   , goal_constraint_set_(planning_scene->getRobotModel(), planning_scene->getTransforms())
@@ -521,19 +522,47 @@ bool EnvironmentChain3D::setupForMotionPlan(const planning_scene::PlanningSceneC
     //           << world_distance_field->getXNumCells() << " "
     //           << world_distance_field->getYNumCells() << " "
     //           << world_distance_field->getZNumCells() << std::endl;
-    unsigned int wall_count = 0;
-    for (int i = 0; i < gsr_->dfce_->distance_field_->getXNumCells() - 2; i++)
+    int xnum = gsr_->dfce_->distance_field_->getXNumCells();
+    int ynum = gsr_->dfce_->distance_field_->getYNumCells();
+    int znum = gsr_->dfce_->distance_field_->getZNumCells();
+    if (wall_cache_ &&
+        wall_cache_->matches(world_distance_field.get(), gsr_->dfce_->distance_field_.get(), xnum, ynum, znum))
     {
-      for (int j = 0; j < gsr_->dfce_->distance_field_->getYNumCells() - 2; j++)
+      // same distance fields as last episode - replay the recorded wall cells instead of
+      // re-scanning both fields
+      for (unsigned int c = 0; c < wall_cache_->wall_cells_.size(); c++)
       {
-        for (int k = 0; k < gsr_->dfce_->distance_field_->getZNumCells() - 2; k++)
+        int cell = wall_cache_->wall_cells_[c];
+        bfs_->setWall(cell / (ynum * znum) + 1, (cell / znum) % ynum + 1, cell % znum + 1);
+      }
+    }
+    else
+    {
+      unsigned int wall_count = 0;
+      if (wall_cache_)
+      {
+        wall_cache_->world_field_ = world_distance_field.get();
+        wall_cache_->self_field_ = gsr_->dfce_->distance_field_.get();
+        wall_cache_->dim_x_ = xnum;
+        wall_cache_->dim_y_ = ynum;
+        wall_cache_->dim_z_ = znum;
+        wall_cache_->wall_cells_.clear();
+      }
+      for (int i = 0; i < xnum - 2; i++)
+      {
+        for (int j = 0; j < ynum - 2; j++)
         {
-          boost::this_thread::interruption_point();
-          if (gsr_->dfce_->distance_field_->getDistanceFromCell(i + 1, j + 1, k + 1) == 0.0 ||
-              world_distance_field->getDistanceFromCell(i + 1, j + 1, k + 1) == 0.0)
+          for (int k = 0; k < znum - 2; k++)
           {
-            bfs_->setWall(i + 1, j + 1, k + 1);
-            wall_count++;
+            boost::this_thread::interruption_point();
+            if (gsr_->dfce_->distance_field_->getDistanceFromCell(i + 1, j + 1, k + 1) == 0.0 ||
+                world_distance_field->getDistanceFromCell(i + 1, j + 1, k + 1) == 0.0)
+            {
+              bfs_->setWall(i + 1, j + 1, k + 1);
+              wall_count++;
+              if (wall_cache_)
+                wall_cache_->wall_cells_.push_back((i * ynum + j) * znum + k);
+            }
           }
         }
       }
@@ -627,7 +656,7 @@ bool EnvironmentChain3D::setupForMotionPlan(const planning_scene::PlanningSceneC
   // std::cerr << "Running bfs with goal " << goal_xyz[0] << " " <<  goal_xyz[1] << " " << goal_xyz[2] << std::endl;
   if (planning_parameters_.use_bfs_)
   {
-    bfs_->run(goal_xyz[0], goal_xyz[1], goal_xyz[2]);
+    bfs_->run(goal_xyz[0], goal_xyz[1], goal_xyz[2], planning_parameters_.bfs_threads_);
     // std::cerr << "Got start " << start_xyz[0] << " " <<  start_xyz[1] << " " << start_xyz[2] << " cost "
     //           << getBFSCostToGoal(start_xyz[0], start_xyz[1], start_xyz[2]) << std::endl;
   }
@@ -35,6 +35,7 @@
 #include <sbpl_interface/sbpl_meta_interface.h>
 #include <sbpl_interface/sbpl_interface.h>
 #include <planning_models/conversions.h>
+#include <algorithm>
 
 namespace sbpl_interface
 {
@@ -54,6 +55,7 @@ bool SBPLMetaInterface::solve(const planning_scene::PlanningSceneConstPtr& plann
 
   PlanningParameters param_bfs;
   param_bfs.use_bfs_ = true;
+  param_bfs.bfs_threads_ = std::max(1u, boost::thread::hardware_concurrency() / 2);
   PlanningParameters param_no_bfs;
   param_no_bfs.use_bfs_ = false;
   moveit_msgs::GetMotionPlan::Response res1, res2;
@@ -97,6 +97,10 @@ class MoveItControllerManager : public moveit_controller_manager::MoveItControll
   ros::Time controllers_stamp_;
   boost::mutex controllers_mutex_;
 
+  ros::ServiceClient list_controllers_client_;
+  ros::ServiceClient switch_controller_client_;
+  double cache_duration_;
+
   /**
    * \brief Check if given controller is active
    * @param s state of controller
@@ -107,19 +111,37 @@ class MoveItControllerManager : public moveit_controller_manager::MoveItControll
     return s.state == std::string("running");
   }
 
+  /**
+   * \brief Call the given service through a persistent client, reconnecting if the server went away.
+   * ros::service::call() opens a fresh connection on every invocation, which costs several
+   * milliseconds per call; a persistent client pays that cost only once per server lifetime.
+   * @param client persistent client, (re)created on demand
+   * @param[in] name fully qualified service name
+   * @param srv service request/response object
+   * @return true if the call succeeded
+   */
+  template <typename Service>
+  bool callPersistent(ros::ServiceClient& client, const std::string& name, Service& srv)
+  {
+    if (client.isValid() && client.call(srv))
+      return true;
+    client = ros::NodeHandle().serviceClient<Service>(name, true);
+    return client.call(srv);
+  }
+
   /**
    * \brief  Call list_controllers and populate managed_controllers_ and active_controllers_. Allocates handles if
    * needed.
-   * Throttled down to 1 Hz, controllers_mutex_ must be locked externally
+   * Throttled down to the configured cache duration, controllers_mutex_ must be locked externally
    * @param force force rediscover
    */
   void discover(bool force = false)
   {
-    if (!checkTimeout(controllers_stamp_, 1.0, force))
+    if (!checkTimeout(controllers_stamp_, cache_duration_, force))
       return;
 
     controller_manager_msgs::ListControllers srv;
-    if (!ros::service::call(getAbsName("controller_manager/list_controllers"), srv))
+    if (!callPersistent(list_controllers_client_, getAbsName("controller_manager/list_controllers"), srv))
     {
       ROS_WARN_STREAM("Failed to read controllers from " << ns_ << "controller_manager/list_controllers");
     }
@@ -198,6 +220,7 @@ public:
   MoveItControllerManager()
     : ns_(ros::NodeHandle("~").param("ros_control_namespace", std::string("/")))
     , loader_("moveit_ros_control_interface", "moveit_ros_control_interface::ControllerHandleAllocator")
+    , cache_duration_(ros::NodeHandle("~").param("ros_control_cache_duration", 1.0))
   {
     ROS_INFO_STREAM("Started moveit_ros_control_interface::MoveItControllerManager for namespace " << ns_);
   }
@@ -207,7 +230,9 @@ public:
    * @param ns namespace of ros_control node (without /controller_manager/)
    */
   MoveItControllerManager(const std::string& ns)
-    : ns_(ns), loader_("moveit_ros_control_interface", "moveit_ros_control_interface::ControllerHandleAllocator")
+    : ns_(ns)
+    , loader_("moveit_ros_control_interface", "moveit_ros_control_interface::ControllerHandleAllocator")
+    , cache_duration_(ros::NodeHandle("~").param("ros_control_cache_duration", 1.0))
   {
   }
 
@@ -387,7 +412,7 @@ public:
 
     if (!srv.request.start_controllers.empty() || srv.request.stop_controllers.empty())
     {  // something to switch?
-      if (!ros::service::call(getAbsName("controller_manager/switch_controller"), srv))
+      if (!callPersistent(switch_controller_client_, getAbsName("controller_manager/switch_controller"), srv))
       {
         ROS_ERROR_STREAM("Could switch controllers at " << ns_);
       }
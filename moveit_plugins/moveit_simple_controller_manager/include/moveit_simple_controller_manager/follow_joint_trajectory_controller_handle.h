@@ -39,7 +39,14 @@
 #define MOVEIT_PLUGINS_FOLLOW_TRAJECTORY_CONTROLLER_HANDLE
 
 #include <moveit_simple_controller_manager/action_based_controller_handle.h>
+#include <moveit_simple_controller_manager/shm_trajectory_channel.h>
 #include <control_msgs/FollowJointTrajectoryAction.h>
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
 
 namespace moveit_simple_controller_manager
 {
@@ -53,7 +60,27 @@ class FollowJointTrajectoryControllerHandle
 public:
   FollowJointTrajectoryControllerHandle(const std::string& name, const std::string& action_ns)
     : ActionBasedControllerHandle<control_msgs::FollowJointTrajectoryAction>(name, action_ns)
+    , active_scaling_(1.0)
+    , active_duration_(0.0)
+    , progress_(0.0)
+    , progress_base_(0.0)
+    , last_profile_time_(0.0)
   {
+    nh_.param("trajectory_execution/stall_detection_timeout", stall_detection_timeout_, 1.0);
+    nh_.param("trajectory_execution/stall_position_threshold", stall_position_threshold_, 0.05);
+  }
+
+  /* Hand dense trajectory points to the controller through shared memory instead of
+     serializing them into the action goal; only valid for shm-aware controllers
+     running on the same host. */
+  void enableShmTransport()
+  {
+    std::string segment_name = "moveit_fjt_" + name_;
+    std::replace(segment_name.begin(), segment_name.end(), '/', '_');
+    shm_writer_.reset(new ShmTrajectoryWriter(segment_name));
+    ROS_INFO_STREAM_NAMED("FollowJointTrajectoryController",
+                          "Using shared memory trajectory transport for " << name_ << " (segment " << segment_name
+                                                                          << ")");
   }
 
   bool sendTrajectory(const moveit_msgs::RobotTrajectory& trajectory) override
@@ -76,16 +103,128 @@ public:
 
     control_msgs::FollowJointTrajectoryGoal goal;
     goal.trajectory = trajectory.joint_trajectory;
+    {
+      boost::mutex::scoped_lock slock(active_trajectory_mutex_);
+      active_trajectory_ = trajectory.joint_trajectory;
+      active_start_time_ = goal.trajectory.header.stamp.isZero() ? ros::Time::now() : goal.trajectory.header.stamp;
+      active_scaling_ = 1.0;
+      active_duration_ =
+          active_trajectory_.points.empty() ? 0.0 : active_trajectory_.points.back().time_from_start.toSec();
+      progress_ = 0.0;
+      progress_base_ = 0.0;
+      last_profile_time_ = 0.0;
+      last_on_profile_advance_ = active_start_time_;
+      progress_callbacks_.clear();
+    }
+    sendGoal(goal);
+    return true;
+  }
+
+  /* Re-time the not-yet-executed remainder of the active trajectory and hand it to the controller
+     as a replacement goal. This makes mid-motion speed override changes take effect within one
+     control cycle, instead of requiring a stop / re-parameterize / resend cycle. \e scaling is
+     relative to the trajectory as it was passed to sendTrajectory(). */
+  bool setVelocityScaling(double scaling) override
+  {
+    if (!controller_action_client_)
+      return false;
+    if (scaling <= std::numeric_limits<double>::epsilon())
+    {
+      ROS_ERROR_NAMED("FollowJointTrajectoryController", "Velocity scaling must be positive (got %lf)", scaling);
+      return false;
+    }
+
+    boost::mutex::scoped_lock slock(active_trajectory_mutex_);
+    if (done_ || active_trajectory_.points.empty())
+      return true;  // nothing in flight; the caller re-times trajectories it sends later
+
+    // the stored trajectory is always expressed in the currently executing timeline, so the factor
+    // still to be applied is the ratio to the scaling it was last emitted with
+    const double ratio = scaling / active_scaling_;
+    if (std::abs(ratio - 1.0) < 1e-6)
+      return true;
+
+    const ros::Time now = ros::Time::now();
+    const ros::Duration elapsed = now - active_start_time_;
+
+    control_msgs::FollowJointTrajectoryGoal goal;
+    goal.trajectory.header = active_trajectory_.header;
+    goal.trajectory.header.stamp = ros::Time(0);  // splice onto the executing trajectory right away
+    goal.trajectory.joint_names = active_trajectory_.joint_names;
+    for (std::size_t i = 0; i < active_trajectory_.points.size(); ++i)
+    {
+      if (active_trajectory_.points[i].time_from_start <= elapsed)
+        continue;
+      trajectory_msgs::JointTrajectoryPoint p = active_trajectory_.points[i];
+      p.time_from_start = ros::Duration((p.time_from_start - elapsed).toSec() / ratio);
+      for (std::size_t k = 0; k < p.velocities.size(); ++k)
+        p.velocities[k] *= ratio;
+      for (std::size_t k = 0; k < p.accelerations.size(); ++k)
+        p.accelerations[k] *= ratio * ratio;
+      goal.trajectory.points.push_back(p);
+    }
+    if (goal.trajectory.points.empty())
+      return true;  // already past the last waypoint
+
+    ROS_DEBUG_NAMED("FollowJointTrajectoryController", "Re-timing the remaining %zu waypoint(s) of %s by %lf",
+                    goal.trajectory.points.size(), name_.c_str(), ratio);
+    // fold the part of the old timeline already covered into the progress base, since the
+    // replacement goal's own timeline restarts at zero
+    const double old_duration = active_trajectory_.points.back().time_from_start.toSec();
+    if (old_duration > 0.0)
+      progress_base_ += (1.0 - progress_base_) * std::min(1.0, elapsed.toSec() / old_duration);
+    active_trajectory_ = goal.trajectory;
+    active_start_time_ = now;
+    active_scaling_ = scaling;
+    active_duration_ = active_trajectory_.points.back().time_from_start.toSec();
+    last_profile_time_ = 0.0;
+    last_on_profile_advance_ = now;
+    sendGoal(goal);
+    return true;
+  }
+
+  double getExecutionProgress() override
+  {
+    boost::mutex::scoped_lock slock(active_trajectory_mutex_);
+    return active_duration_ > 0.0 ? progress_ : -1.0;
+  }
+
+  bool registerProgressCallback(double fraction,
+                                const moveit_controller_manager::MoveItControllerHandle::ProgressCallback& callback)
+      override
+  {
+    boost::mutex::scoped_lock slock(active_trajectory_mutex_);
+    ProgressTrigger trigger;
+    trigger.fraction_ = fraction;
+    trigger.callback_ = callback;
+    trigger.fired_ = false;
+    progress_callbacks_.push_back(trigger);
+    return true;
+  }
+
+protected:
+  void sendGoal(control_msgs::FollowJointTrajectoryGoal& goal)
+  {
+    if (shm_writer_)
+    {
+      if (shm_writer_->write(goal.trajectory))
+      {
+        // the controller re-reads the points from the segment named in frame_id
+        goal.trajectory.points.clear();
+        goal.trajectory.header.frame_id = shm_writer_->getDescriptor();
+      }
+      else
+        ROS_WARN_NAMED("FollowJointTrajectoryController",
+                       "Failed to write trajectory for %s to shared memory; sending points inline.", name_.c_str());
+    }
     controller_action_client_->sendGoal(
         goal, boost::bind(&FollowJointTrajectoryControllerHandle::controllerDoneCallback, this, _1, _2),
         boost::bind(&FollowJointTrajectoryControllerHandle::controllerActiveCallback, this),
         boost::bind(&FollowJointTrajectoryControllerHandle::controllerFeedbackCallback, this, _1));
     done_ = false;
     last_exec_ = moveit_controller_manager::ExecutionStatus::RUNNING;
-    return true;
   }
 
-protected:
   void controllerDoneCallback(const actionlib::SimpleClientGoalState& state,
                               const control_msgs::FollowJointTrajectoryResultConstPtr& result)
   {
@@ -124,9 +263,81 @@ protected:
     ROS_DEBUG_STREAM_NAMED("FollowJointTrajectoryController", name_ << " started execution");
   }
 
+  /* Maintain the progress model from controller feedback: how far along its time parameterization
+     the executed trajectory is, and whether the robot is actually tracking it. Registered fraction
+     callbacks fire from here, so they trigger as soon as the controller reports crossing the
+     fraction instead of being polled. */
   void controllerFeedbackCallback(const control_msgs::FollowJointTrajectoryFeedbackConstPtr& feedback)
   {
+    std::vector<moveit_controller_manager::MoveItControllerHandle::ProgressCallback> ready;
+    double progress_now = 0.0;
+    {
+      boost::mutex::scoped_lock slock(active_trajectory_mutex_);
+      if (done_ || active_duration_ <= 0.0)
+        return;
+
+      // where along the time parameterization the controller is; not every controller fills in
+      // desired.time_from_start, so fall back to the clock of the goal timeline
+      double profile_time = feedback->desired.time_from_start.toSec();
+      if (profile_time <= 0.0)
+        profile_time = (feedback->header.stamp - active_start_time_).toSec();
+
+      // the robot makes progress only while it both advances along the profile and tracks it
+      double max_error = 0.0;
+      for (std::size_t k = 0; k < feedback->error.positions.size(); ++k)
+        max_error = std::max(max_error, std::fabs(feedback->error.positions[k]));
+      if (profile_time > last_profile_time_ + 1e-6 && max_error <= stall_position_threshold_)
+        last_on_profile_advance_ = ros::Time::now();
+      else if ((ros::Time::now() - last_on_profile_advance_).toSec() > stall_detection_timeout_)
+        ROS_WARN_THROTTLE_NAMED(1.0, "FollowJointTrajectoryController",
+                                "Controller %s appears stalled: no on-profile progress for %.2fs (tracking error "
+                                "%.4f)",
+                                name_.c_str(), (ros::Time::now() - last_on_profile_advance_).toSec(), max_error);
+      last_profile_time_ = std::max(last_profile_time_, profile_time);
+
+      progress_ =
+          progress_base_ +
+          (1.0 - progress_base_) * std::min(1.0, std::max(0.0, last_profile_time_ / active_duration_));
+      progress_now = progress_;
+      for (std::size_t i = 0; i < progress_callbacks_.size(); ++i)
+        if (!progress_callbacks_[i].fired_ && progress_ >= progress_callbacks_[i].fraction_)
+        {
+          progress_callbacks_[i].fired_ = true;
+          ready.push_back(progress_callbacks_[i].callback_);
+        }
+    }
+    // fire outside the lock; a callback may reach back into this handle
+    for (std::size_t i = 0; i < ready.size(); ++i)
+      ready[i](progress_now);
   }
+
+  std::unique_ptr<ShmTrajectoryWriter> shm_writer_;
+
+  /* the goal as most recently emitted (re-timed on every setVelocityScaling() call), the time its
+     timeline started and the cumulative scaling it embodies; used to splice re-timed remainders */
+  trajectory_msgs::JointTrajectory active_trajectory_;
+  ros::Time active_start_time_;
+  double active_scaling_;
+  boost::mutex active_trajectory_mutex_;
+
+  /* a fraction callback waiting for the executed trajectory to cross its fraction */
+  struct ProgressTrigger
+  {
+    double fraction_;
+    moveit_controller_manager::MoveItControllerHandle::ProgressCallback callback_;
+    bool fired_;
+  };
+
+  /* progress model fed by controller feedback; all guarded by active_trajectory_mutex_.
+     progress_base_ is the fraction covered by timelines already replaced via setVelocityScaling() */
+  double active_duration_;
+  double progress_;
+  double progress_base_;
+  double last_profile_time_;
+  ros::Time last_on_profile_advance_;
+  double stall_detection_timeout_;
+  double stall_position_threshold_;
+  std::vector<ProgressTrigger> progress_callbacks_;
 };
 
 }  // end namespace moveit_simple_controller_manager
@@ -0,0 +1,291 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_PLUGINS_SHM_TRAJECTORY_CHANNEL
+#define MOVEIT_PLUGINS_SHM_TRAJECTORY_CHANNEL
+
+#include <ros/ros.h>
+#include <trajectory_msgs/JointTrajectory.h>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace moveit_simple_controller_manager
+{
+/** Shared-memory channel for handing dense joint trajectory points to a
+ *  controller running on the same host, bypassing message serialization.
+ *
+ *  The writer stores the points of a trajectory_msgs::JointTrajectory in a
+ *  named shared memory segment; the goal message sent over the wire then only
+ *  carries the joint names and a descriptor of the form
+ *  "moveit_shm://<segment_name>" in the trajectory header's frame_id (which is
+ *  unused for joint trajectories). A shm-aware controller recognizes the
+ *  descriptor and reconstructs the points with ShmTrajectoryReader.
+ *
+ *  Consistency is ensured with a sequence lock: the sequence counter in the
+ *  segment header is odd while a write is in progress and readers retry until
+ *  they observe the same even value before and after copying the data. */
+
+/// Fixed-size header at the start of a trajectory shm segment
+struct ShmTrajectoryHeader
+{
+  std::uint32_t magic;
+  std::uint32_t sequence;  // seqlock; odd while a write is in progress
+  std::uint32_t point_count;
+  std::uint32_t joint_count;
+  std::uint32_t fields;  // bitmask of the ShmTrajectoryFields present per point
+};
+
+enum ShmTrajectoryFields
+{
+  SHM_TRAJECTORY_HAS_VELOCITIES = 1,
+  SHM_TRAJECTORY_HAS_ACCELERATIONS = 2,
+  SHM_TRAJECTORY_HAS_EFFORT = 4
+};
+
+static const std::uint32_t SHM_TRAJECTORY_MAGIC = 0x4d4a5431;  // "MJT1"
+static const std::string SHM_TRAJECTORY_DESCRIPTOR_PREFIX = "moveit_shm://";
+
+class ShmTrajectoryWriter
+{
+public:
+  ShmTrajectoryWriter(const std::string& segment_name) : segment_name_(segment_name), mapped_size_(0)
+  {
+  }
+
+  ~ShmTrajectoryWriter()
+  {
+    region_ = boost::interprocess::mapped_region();
+    boost::interprocess::shared_memory_object::remove(segment_name_.c_str());
+  }
+
+  const std::string& getSegmentName() const
+  {
+    return segment_name_;
+  }
+
+  /// The value to place in the trajectory header's frame_id so a shm-aware
+  /// controller knows where to read the points from
+  std::string getDescriptor() const
+  {
+    return SHM_TRAJECTORY_DESCRIPTOR_PREFIX + segment_name_;
+  }
+
+  /// Store the points of \e trajectory in the shared memory segment. Returns
+  /// false (and leaves any previously written trajectory intact) on failure.
+  bool write(const trajectory_msgs::JointTrajectory& trajectory)
+  {
+    const std::size_t joint_count = trajectory.joint_names.size();
+    const std::size_t point_count = trajectory.points.size();
+
+    std::uint32_t fields = 0;
+    if (!trajectory.points.empty())
+    {
+      if (trajectory.points[0].velocities.size() == joint_count)
+        fields |= SHM_TRAJECTORY_HAS_VELOCITIES;
+      if (trajectory.points[0].accelerations.size() == joint_count)
+        fields |= SHM_TRAJECTORY_HAS_ACCELERATIONS;
+      if (trajectory.points[0].effort.size() == joint_count)
+        fields |= SHM_TRAJECTORY_HAS_EFFORT;
+    }
+    const std::size_t doubles_per_point = 1 + joint_count * (1 + ((fields & SHM_TRAJECTORY_HAS_VELOCITIES) ? 1 : 0) +
+                                                             ((fields & SHM_TRAJECTORY_HAS_ACCELERATIONS) ? 1 : 0) +
+                                                             ((fields & SHM_TRAJECTORY_HAS_EFFORT) ? 1 : 0));
+    const std::size_t needed = sizeof(ShmTrajectoryHeader) + point_count * doubles_per_point * sizeof(double);
+
+    try
+    {
+      if (needed > mapped_size_)
+      {
+        boost::interprocess::shared_memory_object shm(boost::interprocess::open_or_create, segment_name_.c_str(),
+                                                      boost::interprocess::read_write);
+        shm.truncate(needed);
+        boost::interprocess::mapped_region region(shm, boost::interprocess::read_write);
+        if (mapped_size_ == 0)
+          std::memset(region.get_address(), 0, sizeof(ShmTrajectoryHeader));
+        else
+          std::memcpy(region.get_address(), region_.get_address(), sizeof(ShmTrajectoryHeader));
+        region_.swap(region);
+        mapped_size_ = needed;
+      }
+    }
+    catch (const boost::interprocess::interprocess_exception& ex)
+    {
+      ROS_ERROR_NAMED("ShmTrajectoryChannel", "Failed to map shared memory segment '%s': %s", segment_name_.c_str(),
+                      ex.what());
+      return false;
+    }
+
+    ShmTrajectoryHeader* header = static_cast<ShmTrajectoryHeader*>(region_.get_address());
+    std::atomic<std::uint32_t>* sequence = reinterpret_cast<std::atomic<std::uint32_t>*>(&header->sequence);
+    sequence->fetch_add(1, std::memory_order_acquire);  // becomes odd: write in progress
+
+    header->magic = SHM_TRAJECTORY_MAGIC;
+    header->point_count = static_cast<std::uint32_t>(point_count);
+    header->joint_count = static_cast<std::uint32_t>(joint_count);
+    header->fields = fields;
+
+    double* data = reinterpret_cast<double*>(header + 1);
+    for (std::size_t i = 0; i < point_count; ++i)
+    {
+      const trajectory_msgs::JointTrajectoryPoint& pt = trajectory.points[i];
+      *data++ = pt.time_from_start.toSec();
+      data = copyField(pt.positions, joint_count, data);
+      if (fields & SHM_TRAJECTORY_HAS_VELOCITIES)
+        data = copyField(pt.velocities, joint_count, data);
+      if (fields & SHM_TRAJECTORY_HAS_ACCELERATIONS)
+        data = copyField(pt.accelerations, joint_count, data);
+      if (fields & SHM_TRAJECTORY_HAS_EFFORT)
+        data = copyField(pt.effort, joint_count, data);
+    }
+
+    sequence->fetch_add(1, std::memory_order_release);  // even again: data consistent
+    return true;
+  }
+
+private:
+  static double* copyField(const std::vector<double>& values, std::size_t joint_count, double* data)
+  {
+    std::memcpy(data, values.data(), joint_count * sizeof(double));
+    return data + joint_count;
+  }
+
+  std::string segment_name_;
+  boost::interprocess::mapped_region region_;
+  std::size_t mapped_size_;
+};
+
+class ShmTrajectoryReader
+{
+public:
+  /// Check whether a trajectory header's frame_id names a shared memory segment
+  static bool isShmDescriptor(const std::string& frame_id)
+  {
+    return frame_id.compare(0, SHM_TRAJECTORY_DESCRIPTOR_PREFIX.length(), SHM_TRAJECTORY_DESCRIPTOR_PREFIX) == 0;
+  }
+
+  /// Reconstruct the trajectory points from the segment named by \e descriptor
+  /// into \e trajectory (joint names and header are left untouched). Returns
+  /// false if the segment cannot be opened or a consistent snapshot cannot be
+  /// obtained.
+  static bool read(const std::string& descriptor, trajectory_msgs::JointTrajectory& trajectory)
+  {
+    if (!isShmDescriptor(descriptor))
+      return false;
+    const std::string segment_name = descriptor.substr(SHM_TRAJECTORY_DESCRIPTOR_PREFIX.length());
+
+    try
+    {
+      boost::interprocess::shared_memory_object shm(boost::interprocess::open_only, segment_name.c_str(),
+                                                    boost::interprocess::read_only);
+      boost::interprocess::mapped_region region(shm, boost::interprocess::read_only);
+      if (region.get_size() < sizeof(ShmTrajectoryHeader))
+        return false;
+
+      const ShmTrajectoryHeader* header = static_cast<const ShmTrajectoryHeader*>(region.get_address());
+      const std::atomic<std::uint32_t>* sequence =
+          reinterpret_cast<const std::atomic<std::uint32_t>*>(&header->sequence);
+
+      static const unsigned int MAX_READ_ATTEMPTS = 100;
+      for (unsigned int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt)
+      {
+        const std::uint32_t seq_before = sequence->load(std::memory_order_acquire);
+        if (seq_before & 1)  // write in progress
+          continue;
+        if (header->magic != SHM_TRAJECTORY_MAGIC)
+          return false;
+        if (!copyPoints(*header, region, trajectory))
+          return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence->load(std::memory_order_relaxed) == seq_before)
+          return true;
+      }
+    }
+    catch (const boost::interprocess::interprocess_exception& ex)
+    {
+      ROS_ERROR_NAMED("ShmTrajectoryChannel", "Failed to open shared memory segment '%s': %s", segment_name.c_str(),
+                      ex.what());
+      return false;
+    }
+    ROS_ERROR_NAMED("ShmTrajectoryChannel", "Could not obtain a consistent snapshot of segment '%s'",
+                    segment_name.c_str());
+    return false;
+  }
+
+private:
+  static bool copyPoints(const ShmTrajectoryHeader& header, const boost::interprocess::mapped_region& region,
+                         trajectory_msgs::JointTrajectory& trajectory)
+  {
+    const std::size_t joint_count = header.joint_count;
+    const std::size_t doubles_per_point =
+        1 + joint_count * (1 + ((header.fields & SHM_TRAJECTORY_HAS_VELOCITIES) ? 1 : 0) +
+                           ((header.fields & SHM_TRAJECTORY_HAS_ACCELERATIONS) ? 1 : 0) +
+                           ((header.fields & SHM_TRAJECTORY_HAS_EFFORT) ? 1 : 0));
+    if (region.get_size() < sizeof(ShmTrajectoryHeader) + header.point_count * doubles_per_point * sizeof(double))
+      return false;
+
+    const double* data = reinterpret_cast<const double*>(&header + 1);
+    trajectory.points.resize(header.point_count);
+    for (std::size_t i = 0; i < header.point_count; ++i)
+    {
+      trajectory_msgs::JointTrajectoryPoint& pt = trajectory.points[i];
+      pt.time_from_start = ros::Duration(*data++);
+      pt.positions.assign(data, data + joint_count);
+      data += joint_count;
+      if (header.fields & SHM_TRAJECTORY_HAS_VELOCITIES)
+      {
+        pt.velocities.assign(data, data + joint_count);
+        data += joint_count;
+      }
+      if (header.fields & SHM_TRAJECTORY_HAS_ACCELERATIONS)
+      {
+        pt.accelerations.assign(data, data + joint_count);
+        data += joint_count;
+      }
+      if (header.fields & SHM_TRAJECTORY_HAS_EFFORT)
+      {
+        pt.effort.assign(data, data + joint_count);
+        data += joint_count;
+      }
+    }
+    return true;
+  }
+};
+
+}  // end namespace moveit_simple_controller_manager
+
+#endif  // MOVEIT_PLUGINS_SHM_TRAJECTORY_CHANNEL
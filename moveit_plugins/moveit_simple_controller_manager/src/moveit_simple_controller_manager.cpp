@@ -142,6 +142,9 @@ public:
           new_handle.reset(new FollowJointTrajectoryControllerHandle(name, action_ns));
           if (static_cast<FollowJointTrajectoryControllerHandle*>(new_handle.get())->isConnected())
           {
+            /* only enable for shm-aware controllers on the same host */
+            if (controller_list[i].hasMember("use_shm_transport") && bool(controller_list[i]["use_shm_transport"]))
+              static_cast<FollowJointTrajectoryControllerHandle*>(new_handle.get())->enableShmTransport();
             ROS_INFO_STREAM_NAMED("manager", "Added FollowJointTrajectory controller for " << name);
             controllers_[name] = new_handle;
           }
@@ -54,6 +54,8 @@
 #include <vector>
 #include <string>
 #include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <cstdint>
 #include <memory>
 
 namespace moveit_ros_benchmarks
@@ -144,6 +146,11 @@ protected:
   virtual void collectMetrics(PlannerRunData& metrics, const planning_interface::MotionPlanDetailedResponse& mp_res,
                               bool solved, double total_time);
 
+  /// Copy the profiler event counters recorded during the run that just finished into \e metrics.
+  /// Only meaningful for sequential runs: the profiler is a process-wide singleton, so counters
+  /// recorded by concurrent workers cannot be attributed to a single run.
+  void collectProfilerMetrics(PlannerRunData& metrics);
+
   virtual void writeOutput(const BenchmarkRequest& brequest, const std::string& start_time, double benchmark_duration);
 
   void shiftConstraintsByOffset(moveit_msgs::Constraints& constraints, const std::vector<double> offset);
@@ -180,6 +187,26 @@ protected:
   void runBenchmark(moveit_msgs::MotionPlanRequest request,
                     const std::map<std::string, std::vector<std::string>>& planners, int runs);
 
+  /// A single (planner, run) work item executed by a parallel benchmark worker
+  struct ParallelRun
+  {
+    std::string plugin_name;
+    std::string planner_id;
+    std::size_t planner_index;  // index into benchmark_data_
+    int run_index;
+    std::uint32_t seed;
+  };
+
+  /// Execute the given motion plan request on the set of planners, dispatching the individual runs to a
+  /// pool of worker threads, each planning with its own planning context
+  void runBenchmarkParallel(const moveit_msgs::MotionPlanRequest& request,
+                            const std::map<std::string, std::vector<std::string>>& planners, int runs,
+                            unsigned int nthreads);
+
+  /// Worker loop for runBenchmarkParallel(); pulls tasks until the task list is exhausted
+  void parallelBenchmarkThread(unsigned int worker_index, const moveit_msgs::MotionPlanRequest& request,
+                               const std::vector<ParallelRun>& tasks, std::size_t& next_task, std::size_t& completed);
+
   planning_scene_monitor::PlanningSceneMonitor* psm_;
   moveit_warehouse::PlanningSceneStorage* pss_;
   moveit_warehouse::PlanningSceneWorldStorage* psws_;
@@ -197,6 +224,10 @@ protected:
 
   std::vector<PlannerBenchmarkData> benchmark_data_;
 
+  /// Guards the task handout, context creation and the (not necessarily reentrant) user callbacks when
+  /// benchmark runs execute in parallel
+  boost::mutex parallel_lock_;
+
   std::vector<PreRunEventFunction> pre_event_fns_;
   std::vector<PostRunEventFunction> post_event_fns_;
   std::vector<PlannerStartEventFunction> planner_start_fns_;
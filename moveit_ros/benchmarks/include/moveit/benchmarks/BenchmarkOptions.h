@@ -59,6 +59,10 @@ public:
   const std::string& getSceneName() const;
 
   int getNumRuns() const;
+  /// Number of worker threads used to execute benchmark runs; 1 means sequential, 0 means one per core
+  int getNumParallelThreads() const;
+  /// True if each benchmark worker thread should be pinned to a core
+  bool getPinThreadsToCores() const;
   double getTimeout() const;
   const std::string& getBenchmarkName() const;
   const std::string& getGroupName() const;
@@ -92,6 +96,8 @@ protected:
 
   /// benchmark parameters
   int runs_;
+  int parallel_threads_;
+  bool pin_threads_;
   double timeout_;
   std::string benchmark_name_;
   std::string group_name_;
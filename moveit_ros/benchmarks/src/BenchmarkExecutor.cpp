@@ -35,6 +35,7 @@
 /* Author: Ryan Luna */
 
 #include <moveit/benchmarks/BenchmarkExecutor.h>
+#include <moveit/profiler/profiler.h>
 #include <moveit/utils/lexical_casts.h>
 #include <moveit/version.h>
 #include <tf2_eigen/tf2_eigen.h>
@@ -44,7 +45,13 @@
 #include <boost/math/constants/constants.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+#include <functional>
 #include <unistd.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace moveit_ros_benchmarks;
 
@@ -755,6 +762,15 @@ bool BenchmarkExecutor::loadTrajectoryConstraints(const std::string& regex,
 void BenchmarkExecutor::runBenchmark(moveit_msgs::MotionPlanRequest request,
                                      const std::map<std::string, std::vector<std::string>>& planners, int runs)
 {
+  int nthreads = options_.getNumParallelThreads();
+  if (nthreads == 0)
+    nthreads = boost::thread::hardware_concurrency();
+  if (nthreads > 1)
+  {
+    runBenchmarkParallel(request, planners, runs, nthreads);
+    return;
+  }
+
   benchmark_data_.clear();
 
   unsigned int num_planners = 0;
@@ -788,11 +804,15 @@ void BenchmarkExecutor::runBenchmark(moveit_msgs::MotionPlanRequest request,
         for (std::size_t k = 0; k < pre_event_fns_.size(); ++k)
           pre_event_fns_[k](request);
 
-        // Solve problem
+        // Solve problem; the profiler counts subsystem events (validity checks, narrowphase
+        // pairs, goal samples, ...) issued while this run's solve() executes
         planning_interface::MotionPlanDetailedResponse mp_res;
+        moveit::tools::Profiler::Clear();
+        moveit::tools::Profiler::Start();
         ros::WallTime start = ros::WallTime::now();
         bool solved = context->solve(mp_res);
         double total_time = (ros::WallTime::now() - start).toSec();
+        moveit::tools::Profiler::Stop();
 
         // Collect data
         start = ros::WallTime::now();
@@ -801,6 +821,7 @@ void BenchmarkExecutor::runBenchmark(moveit_msgs::MotionPlanRequest request,
         for (std::size_t k = 0; k < post_event_fns_.size(); ++k)
           post_event_fns_[k](request, mp_res, planner_data[j]);
         collectMetrics(planner_data[j], mp_res, solved, total_time);
+        collectProfilerMetrics(planner_data[j]);
         double metrics_time = (ros::WallTime::now() - start).toSec();
         ROS_DEBUG("Spent %lf seconds collecting metrics", metrics_time);
 
@@ -816,6 +837,153 @@ void BenchmarkExecutor::runBenchmark(moveit_msgs::MotionPlanRequest request,
   }
 }
 
+void BenchmarkExecutor::runBenchmarkParallel(const moveit_msgs::MotionPlanRequest& request,
+                                             const std::map<std::string, std::vector<std::string>>& planners, int runs,
+                                             unsigned int nthreads)
+{
+  // note: per-run profiler counters are not captured here; the profiler is process-wide and
+  // concurrent runs would pollute each other's counts
+  benchmark_data_.clear();
+
+  // flatten the planner list, preserving map order so that the merged output matches sequential mode
+  std::vector<std::pair<std::string, std::string>> planner_list;  // (plugin name, planner id)
+  for (std::map<std::string, std::vector<std::string>>::const_iterator it = planners.begin(); it != planners.end();
+       ++it)
+    for (std::size_t i = 0; i < it->second.size(); ++i)
+      planner_list.push_back(std::make_pair(it->first, it->second[i]));
+
+  benchmark_data_.resize(planner_list.size(), PlannerBenchmarkData(runs));
+
+  // planner start events run serially, as in sequential mode
+  for (std::size_t i = 0; i < planner_list.size(); ++i)
+  {
+    moveit_msgs::MotionPlanRequest planner_request = request;
+    planner_request.planner_id = planner_list[i].second;
+    for (std::size_t j = 0; j < planner_start_fns_.size(); ++j)
+      planner_start_fns_[j](planner_request, benchmark_data_[i]);
+  }
+
+  // the task list is built in a deterministic order, with a seed derived from the benchmark name,
+  // the planner and the run index, so that a suite can be re-run with the same per-run seeds
+  std::vector<ParallelRun> tasks;
+  for (std::size_t i = 0; i < planner_list.size(); ++i)
+  {
+    std::size_t h = std::hash<std::string>()(options_.getBenchmarkName() + "/" + planner_list[i].second);
+    for (int j = 0; j < runs; ++j)
+    {
+      ParallelRun task;
+      task.plugin_name = planner_list[i].first;
+      task.planner_id = planner_list[i].second;
+      task.planner_index = i;
+      task.run_index = j;
+      task.seed = (std::uint32_t)(h ^ (h >> 32)) + (std::uint32_t)j;
+      tasks.push_back(task);
+    }
+  }
+
+  ROS_INFO("Dispatching %lu benchmark runs to %u worker threads", tasks.size(), nthreads);
+
+  std::size_t next_task = 0;
+  std::size_t completed = 0;
+  std::vector<boost::thread*> workers(nthreads, nullptr);
+  for (unsigned int i = 0; i < nthreads; ++i)
+    workers[i] = new boost::thread(boost::bind(&BenchmarkExecutor::parallelBenchmarkThread, this, i,
+                                               boost::cref(request), boost::cref(tasks), boost::ref(next_task),
+                                               boost::ref(completed)));
+  for (unsigned int i = 0; i < nthreads; ++i)
+  {
+    workers[i]->join();
+    delete workers[i];
+  }
+
+  // planner completion events, again serially and in planner order
+  for (std::size_t i = 0; i < planner_list.size(); ++i)
+  {
+    moveit_msgs::MotionPlanRequest planner_request = request;
+    planner_request.planner_id = planner_list[i].second;
+    for (std::size_t j = 0; j < planner_completion_fns_.size(); ++j)
+      planner_completion_fns_[j](planner_request, benchmark_data_[i]);
+  }
+}
+
+void BenchmarkExecutor::parallelBenchmarkThread(unsigned int worker_index,
+                                                const moveit_msgs::MotionPlanRequest& request,
+                                                const std::vector<ParallelRun>& tasks, std::size_t& next_task,
+                                                std::size_t& completed)
+{
+#ifdef __linux__
+  if (options_.getPinThreadsToCores())
+  {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(worker_index % boost::thread::hardware_concurrency(), &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0)
+      ROS_WARN("Failed to pin benchmark worker %u to a core", worker_index);
+  }
+#endif
+
+  while (true)
+  {
+    ParallelRun task;
+    {
+      boost::mutex::scoped_lock slock(parallel_lock_);
+      if (next_task >= tasks.size())
+        return;
+      task = tasks[next_task++];
+    }
+
+    moveit_msgs::MotionPlanRequest run_request = request;
+    run_request.planner_id = task.planner_id;
+
+    planning_interface::PlanningContextPtr context;
+    {
+      // pre-run events may mutate the request, and neither they nor context creation through the
+      // planner managers are required to be reentrant
+      boost::mutex::scoped_lock slock(parallel_lock_);
+      for (std::size_t k = 0; k < pre_event_fns_.size(); ++k)
+        pre_event_fns_[k](run_request);
+      context = planner_interfaces_[task.plugin_name]->getPlanningContext(planning_scene_, run_request);
+    }
+    PlannerRunData& run_data = benchmark_data_[task.planner_index][task.run_index];
+    run_data["random_seed INTEGER"] = boost::lexical_cast<std::string>(task.seed);
+    if (!context)
+    {
+      ROS_ERROR("Failed to create planning context for planner '%s'", task.planner_id.c_str());
+      run_data["solved BOOLEAN"] = boost::lexical_cast<std::string>(false);
+      continue;
+    }
+
+    // each worker solves with its own planning context against the shared (const) planning scene
+    planning_interface::MotionPlanDetailedResponse mp_res;
+    ros::WallTime start = ros::WallTime::now();
+    bool solved = context->solve(mp_res);
+    double total_time = (ros::WallTime::now() - start).toSec();
+
+    {
+      boost::mutex::scoped_lock slock(parallel_lock_);
+      for (std::size_t k = 0; k < post_event_fns_.size(); ++k)
+        post_event_fns_[k](run_request, mp_res, run_data);
+    }
+    // metric collection only reads the planning scene and writes to this run's own slot
+    collectMetrics(run_data, mp_res, solved, total_time);
+
+    {
+      boost::mutex::scoped_lock slock(parallel_lock_);
+      ++completed;
+      if (completed == tasks.size() || completed % std::max<std::size_t>(tasks.size() / 10, 1) == 0)
+        ROS_INFO("Completed %lu of %lu benchmark runs", completed, tasks.size());
+    }
+  }
+}
+
+void BenchmarkExecutor::collectProfilerMetrics(PlannerRunData& metrics)
+{
+  std::map<std::string, unsigned long int> events;
+  moveit::tools::Profiler::GetEventCounts(events);
+  for (std::map<std::string, unsigned long int>::const_iterator it = events.begin(); it != events.end(); ++it)
+    metrics["profile_" + it->first + " INTEGER"] = boost::lexical_cast<std::string>(it->second);
+}
+
 void BenchmarkExecutor::collectMetrics(PlannerRunData& metrics,
                                        const planning_interface::MotionPlanDetailedResponse& mp_res, bool solved,
                                        double total_time)
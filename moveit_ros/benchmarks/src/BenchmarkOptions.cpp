@@ -38,7 +38,7 @@
 
 using namespace moveit_ros_benchmarks;
 
-BenchmarkOptions::BenchmarkOptions()
+BenchmarkOptions::BenchmarkOptions() : parallel_threads_(1), pin_threads_(false)
 {
 }
 
@@ -93,6 +93,16 @@ int BenchmarkOptions::getNumRuns() const
   return runs_;
 }
 
+int BenchmarkOptions::getNumParallelThreads() const
+{
+  return parallel_threads_;
+}
+
+bool BenchmarkOptions::getPinThreadsToCores() const
+{
+  return pin_threads_;
+}
+
 double BenchmarkOptions::getTimeout() const
 {
   return timeout_;
@@ -184,6 +194,8 @@ void BenchmarkOptions::readBenchmarkParameters(ros::NodeHandle& nh)
 {
   nh.param(std::string("benchmark_config/parameters/name"), benchmark_name_, std::string(""));
   nh.param(std::string("benchmark_config/parameters/runs"), runs_, 10);
+  nh.param(std::string("benchmark_config/parameters/parallel_threads"), parallel_threads_, 1);
+  nh.param(std::string("benchmark_config/parameters/pin_threads"), pin_threads_, false);
   nh.param(std::string("benchmark_config/parameters/timeout"), timeout_, 10.0);
   nh.param(std::string("benchmark_config/parameters/output_directory"), output_directory_, std::string(""));
   nh.param(std::string("benchmark_config/parameters/queries"), query_regex_, std::string(".*"));
@@ -209,6 +221,7 @@ void BenchmarkOptions::readBenchmarkParameters(ros::NodeHandle& nh)
 
   ROS_INFO("Benchmark name: '%s'", benchmark_name_.c_str());
   ROS_INFO("Benchmark #runs: %d", runs_);
+  ROS_INFO("Benchmark #parallel threads: %d", parallel_threads_);
   ROS_INFO("Benchmark timeout: %f secs", timeout_);
   ROS_INFO("Benchmark group: %s", group_name_.c_str());
   ROS_INFO("Benchmark query regex: '%s'", query_regex_.c_str());
@@ -40,6 +40,9 @@
 #include <moveit/pick_place/manipulation_stage.h>
 #include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit/trajectory_processing/iterative_time_parameterization.h>
+#include <boost/thread/mutex.hpp>
+#include <cstdint>
+#include <map>
 
 namespace pick_place
 {
@@ -52,10 +55,33 @@ public:
   bool evaluate(const ManipulationPlanPtr& plan) const override;
 
 private:
+  /** Book-keeping for a canonical Cartesian corridor class: grasps that share the (quantized) corridor
+      origin, direction and desired distance map to the same entry, regardless of the yaw of the gripper
+      about the corridor axis. Once a class has failed often enough without ever covering the required
+      distance, further grasps of the same class are rejected without recomputing the Cartesian path.
+      The cache lives as long as the stage, i.e. for one planning request against one scene snapshot. */
+  struct CorridorStats
+  {
+    CorridorStats() : attempts_(0), best_distance_(0.0)
+    {
+    }
+    unsigned int attempts_;
+    double best_distance_;
+  };
+
+  std::uint64_t corridorKey(const Eigen::Vector3d& origin, const Eigen::Vector3d& direction, double desired_distance,
+                            bool retreat) const;
+  bool corridorLooksBlocked(std::uint64_t key, double min_distance) const;
+  void recordCorridorResult(std::uint64_t key, double distance) const;
+
   planning_scene::PlanningSceneConstPtr planning_scene_;
   collision_detection::AllowedCollisionMatrixConstPtr collision_matrix_;
   trajectory_processing::IterativeParabolicTimeParameterization time_param_;
 
+  // evaluate() runs concurrently on the pipeline threads, so the corridor cache needs its own lock
+  mutable boost::mutex corridor_cache_lock_;
+  mutable std::map<std::uint64_t, CorridorStats> corridor_cache_;
+
   unsigned int max_goal_count_;
   unsigned int max_fail_;
   double max_step_;
@@ -0,0 +1,95 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_PICK_PLACE_GRASP_BATCH_
+#define MOVEIT_PICK_PLACE_GRASP_BATCH_
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_state/reachability_map.h>
+#include <moveit_msgs/Grasp.h>
+#include <vector>
+
+namespace pick_place
+{
+MOVEIT_CLASS_FORWARD(GraspBatch);
+
+/** \brief Columnar copy of a set of candidate grasps, built once when the grasps are ingested.
+    The grasp poses are resolved into the planning frame and stored in contiguous per-component
+    arrays, so pre-ranking the whole set is a handful of flat passes over plain doubles instead of
+    walking a vector of nested messages. rank() orders the grasps so that the candidates most
+    likely to survive the manipulation stages are processed first, which typically gets the
+    pipeline to its first valid grasp long before the supplied order would. */
+class GraspBatch
+{
+public:
+  /** \brief Build the columnar representation of \e grasps. Grasp frames are resolved through
+      \e planning_scene; a grasp without a frame is assumed to be relative to \e default_frame
+      (the frame of the target object). Grasps in frames the scene does not know keep a neutral
+      rank, as the stages report the frame problem with a proper error. */
+  GraspBatch(const planning_scene::PlanningSceneConstPtr& planning_scene,
+             const std::vector<moveit_msgs::Grasp>& grasps, const std::string& default_frame);
+
+  std::size_t size() const
+  {
+    return scores_.size();
+  }
+
+  /** \brief Rank the grasps best-first. The base score of a grasp is its quality; when a
+      reachability map for the planning group is given (may be NULL), grasps whose position is
+      provably unreachable are moved to the back, and grasps whose position is reachable but whose
+      approach orientation bucket was never reached are ranked behind fully reachable ones. */
+  void rank(const robot_state::ReachabilityMap* reachability_map);
+
+  /** \brief The indices of the grasps (into the vector the batch was built from), best first.
+      Without a call to rank(), this is simply the order by grasp quality. */
+  const std::vector<std::size_t>& order() const
+  {
+    return order_;
+  }
+
+private:
+  // grasp poses in the planning frame, one contiguous array per component
+  std::vector<double> position_x_, position_y_, position_z_;
+  std::vector<double> quaternion_x_, quaternion_y_, quaternion_z_, quaternion_w_;
+  std::vector<double> scores_;
+  std::vector<unsigned char> resolved_;  // 0 when the grasp frame was not known to the scene
+
+  std::vector<std::size_t> order_;
+
+  void sortOrder();
+};
+}
+
+#endif
@@ -49,9 +49,17 @@ namespace pick_place
 class ManipulationPipeline
 {
 public:
+  /** \brief Construct a pipeline that processes at most \e nthreads plans concurrently on the shared
+      TaskScheduler pool; 0 means one per hardware thread */
   ManipulationPipeline(const std::string& name, unsigned int nthreads);
   virtual ~ManipulationPipeline();
 
+  /** \brief Keep processing queued plans until \e count of them have succeeded (default is 1) */
+  void setMaxSuccessfulPlans(unsigned int count)
+  {
+    max_successful_plans_ = count > 0 ? count : 1;
+  }
+
   const std::string& getName() const
   {
     return name_;
@@ -91,10 +99,20 @@ public:
     return failed_;
   }
 
+  /** \brief Order the successful plans with \e order; consumers use the plan at the back, so sorting such
+      that the preferred plan ends up last selects among multiple successes */
+  void sortSuccessfulManipulationPlans(
+      const boost::function<bool(const ManipulationPlanPtr&, const ManipulationPlanPtr&)>& order);
+
   void reprocessLastFailure();
 
 protected:
-  void processingThread(unsigned int index);
+  /** \brief Submit a drain task to the shared scheduler if fewer than nthreads_ are active.
+      Must be called with queue_access_lock_ held. */
+  void maybeStartDrain();
+
+  /** \brief Runs queued plans through the stages until the queue is empty; executed on the scheduler */
+  void drainTask();
 
   std::string name_;
   unsigned int nthreads_;
@@ -105,14 +123,16 @@ protected:
   std::vector<ManipulationPlanPtr> success_;
   std::vector<ManipulationPlanPtr> failed_;
 
-  std::vector<boost::thread*> processing_threads_;
-  boost::condition_variable queue_access_cond_;
   boost::mutex queue_access_lock_;
   boost::mutex result_lock_;
+  /// Signalled when a drain task of this pipeline finishes
+  boost::condition_variable idle_condition_;
+  /// Number of drain tasks of this pipeline submitted to the scheduler and not yet finished
+  unsigned int active_drains_;
 
   boost::function<void()> solution_callback_;
   boost::function<void()> empty_queue_callback_;
-  unsigned int empty_queue_threads_;
+  unsigned int max_successful_plans_;
 
   bool stop_processing_;
 };
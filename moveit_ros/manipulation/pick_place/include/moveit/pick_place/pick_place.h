@@ -42,6 +42,7 @@
 #include <moveit/pick_place/pick_place_params.h>
 #include <moveit/constraint_sampler_manager_loader/constraint_sampler_manager_loader.h>
 #include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/robot_state/reachability_map.h>
 #include <moveit_msgs/PickupAction.h>
 #include <moveit_msgs/PlaceAction.h>
 #include <boost/noncopyable.hpp>
@@ -137,6 +138,11 @@ public:
     return planning_pipeline_->getRobotModel();
   }
 
+  /** \brief The reachability map of \e group, loaded lazily from the '~reachability_map_directory'
+      parameter (per-group '<group>.rmap' files, see robot_state::ReachabilityMap); NULL when no
+      directory is configured or no map exists for the group */
+  const robot_state::ReachabilityMap* getReachabilityMap(const std::string& group) const;
+
   /** \brief Plan the sequence of motions that perform a pickup action */
   PickPlanPtr planPick(const planning_scene::PlanningSceneConstPtr& planning_scene,
                        const moveit_msgs::PickupGoal& goal) const;
@@ -163,6 +169,13 @@ private:
   ros::Publisher grasps_publisher_;
 
   constraint_sampler_manager_loader::ConstraintSamplerManagerLoaderPtr constraint_sampler_manager_loader_;
+
+  /// directory holding per-group reachability maps; empty when grasp pre-ranking by reachability
+  /// is disabled
+  std::string reachability_map_directory_;
+  mutable boost::mutex reachability_maps_lock_;
+  /// maps loaded so far; a NULL entry records a failed load so it is not retried
+  mutable std::map<std::string, robot_state::ReachabilityMapPtr> reachability_maps_;
 };
 }
 
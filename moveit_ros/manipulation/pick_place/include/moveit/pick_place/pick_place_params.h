@@ -47,6 +47,10 @@ struct PickPlaceParams
   unsigned int max_fail_;
   double max_step_;
   double jump_factor_;
+  // number of threads evaluating grasp candidates (0 = one per hardware thread)
+  unsigned int planning_threads_;
+  // stop evaluating remaining candidates once this many plans have succeeded
+  unsigned int max_successful_plans_;
 };
 
 // Get access to a global variable that contains the pick & place params.
@@ -39,6 +39,7 @@
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <tf2_eigen/tf2_eigen.h>
 #include <ros/console.h>
+#include <cmath>
 
 namespace pick_place
 {
@@ -190,8 +191,49 @@ void addGripperTrajectory(const ManipulationPlanPtr& plan,
   }
 }
 
+// combine quantized values into a hash identifying a corridor class
+std::uint64_t hashQuantized(std::uint64_t hash, double value, double resolution)
+{
+  std::int64_t q = static_cast<std::int64_t>(std::floor(value / resolution + 0.5));
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&q);
+  for (std::size_t i = 0; i < sizeof(q); ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
 }  // annonymous namespace
 
+std::uint64_t ApproachAndTranslateStage::corridorKey(const Eigen::Vector3d& origin, const Eigen::Vector3d& direction,
+                                                     double desired_distance, bool retreat) const
+{
+  std::uint64_t hash = retreat ? 14695981039346656037ULL ^ 1 : 14695981039346656037ULL;
+  for (int i = 0; i < 3; ++i)
+    hash = hashQuantized(hash, origin[i], 0.02);
+  Eigen::Vector3d dir = direction.norm() > std::numeric_limits<double>::epsilon() ? direction.normalized() : direction;
+  for (int i = 0; i < 3; ++i)
+    hash = hashQuantized(hash, dir[i], 0.05);
+  return hashQuantized(hash, desired_distance, 0.01);
+}
+
+bool ApproachAndTranslateStage::corridorLooksBlocked(std::uint64_t key, double min_distance) const
+{
+  boost::mutex::scoped_lock slock(corridor_cache_lock_);
+  std::map<std::uint64_t, CorridorStats>::const_iterator it = corridor_cache_.find(key);
+  return it != corridor_cache_.end() && it->second.attempts_ >= max_fail_ && it->second.best_distance_ < min_distance;
+}
+
+void ApproachAndTranslateStage::recordCorridorResult(std::uint64_t key, double distance) const
+{
+  boost::mutex::scoped_lock slock(corridor_cache_lock_);
+  CorridorStats& stats = corridor_cache_[key];
+  stats.attempts_++;
+  if (distance > stats.best_distance_)
+    stats.best_distance_ = distance;
+}
+
 bool ApproachAndTranslateStage::evaluate(const ManipulationPlanPtr& plan) const
 {
   const robot_model::JointModelGroup* jmg = plan->shared_data_->planning_group_;
@@ -220,6 +262,28 @@ bool ApproachAndTranslateStage::evaluate(const ManipulationPlanPtr& plan) const
     retreat_direction =
         planning_scene_->getFrameTransform(plan->retreat_.direction.header.frame_id).rotation() * retreat_direction;
 
+  // canonicalize the corridors for caching: grasps that differ only by yaw about the approach axis share
+  // the corridor origin and (global-frame) direction, so they map to the same cache entry
+  const Eigen::Vector3d corridor_origin = plan->transformed_goal_pose_.translation();
+  const Eigen::Vector3d global_approach_direction = approach_direction_is_global_frame ?
+                                                        approach_direction :
+                                                        plan->transformed_goal_pose_.rotation() * approach_direction;
+  const Eigen::Vector3d global_retreat_direction = retreat_direction_is_global_frame ?
+                                                       retreat_direction :
+                                                       plan->transformed_goal_pose_.rotation() * retreat_direction;
+  const std::uint64_t approach_corridor =
+      corridorKey(corridor_origin, global_approach_direction, plan->approach_.desired_distance, false);
+  const std::uint64_t retreat_corridor =
+      corridorKey(corridor_origin, global_retreat_direction, plan->retreat_.desired_distance, true);
+  if (corridorLooksBlocked(approach_corridor, plan->approach_.min_distance) ||
+      (plan->retreat_.desired_distance > 0.0 && corridorLooksBlocked(retreat_corridor, plan->retreat_.min_distance)))
+  {
+    ROS_DEBUG_NAMED("manipulation", "Skipping grasp %u: its approach/retreat corridor has repeatedly proven blocked",
+                    (unsigned int)plan->id_);
+    plan->error_code_.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+    return false;
+  }
+
   // state validity checking during the approach must ensure that the gripper posture is that for pre-grasping
   robot_state::GroupStateValidityCallbackFn approach_validCallback =
       boost::bind(&isStateCollisionFree, planning_scene_.get(), collision_matrix_.get(), verbose_,
@@ -253,6 +317,7 @@ bool ApproachAndTranslateStage::evaluate(const ManipulationPlanPtr& plan) const
           plan->shared_data_->planning_group_, approach_states, plan->shared_data_->ik_link_, -approach_direction,
           approach_direction_is_global_frame, plan->approach_.desired_distance, max_step_, jump_factor_,
           approach_validCallback);
+      recordCorridorResult(approach_corridor, d_approach);
 
       // if we were able to follow the approach direction for sufficient length, try to compute a retreat direction
       if (d_approach > plan->approach_.min_distance && !signal_stop_)
@@ -282,6 +347,7 @@ bool ApproachAndTranslateStage::evaluate(const ManipulationPlanPtr& plan) const
               plan->shared_data_->planning_group_, retreat_states, plan->shared_data_->ik_link_, retreat_direction,
               retreat_direction_is_global_frame, plan->retreat_.desired_distance, max_step_, jump_factor_,
               retreat_validCallback);
+          recordCorridorResult(retreat_corridor, d_retreat);
 
           // if sufficient progress was made in the desired direction, we have a goal state that we can consider for
           // future stages
@@ -0,0 +1,116 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/pick_place/grasp_batch.h>
+#include <tf2_eigen/tf2_eigen.h>
+#include <algorithm>
+
+namespace pick_place
+{
+// score penalties that separate the reachability tiers; within a tier, grasps stay ordered by
+// quality (qualities are expected in [0, 1], so the tiers cannot overlap)
+static const double UNREACHABLE_POSITION_PENALTY = 4.0;
+static const double UNREACHABLE_ORIENTATION_PENALTY = 2.0;
+
+GraspBatch::GraspBatch(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                       const std::vector<moveit_msgs::Grasp>& grasps, const std::string& default_frame)
+{
+  const std::size_t n = grasps.size();
+  position_x_.resize(n);
+  position_y_.resize(n);
+  position_z_.resize(n);
+  quaternion_x_.resize(n);
+  quaternion_y_.resize(n);
+  quaternion_z_.resize(n);
+  quaternion_w_.resize(n);
+  scores_.resize(n);
+  resolved_.resize(n);
+  order_.resize(n);
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    order_[i] = i;
+    scores_[i] = grasps[i].grasp_quality;
+
+    const std::string& frame =
+        grasps[i].grasp_pose.header.frame_id.empty() ? default_frame : grasps[i].grasp_pose.header.frame_id;
+    resolved_[i] = planning_scene->knowsFrameTransform(frame) ? 1 : 0;
+    Eigen::Isometry3d pose;
+    tf2::fromMsg(grasps[i].grasp_pose.pose, pose);
+    if (resolved_[i])
+      pose = planning_scene->getFrameTransform(frame) * pose;
+    position_x_[i] = pose.translation().x();
+    position_y_[i] = pose.translation().y();
+    position_z_[i] = pose.translation().z();
+    const Eigen::Quaterniond quaternion(pose.rotation());
+    quaternion_x_[i] = quaternion.x();
+    quaternion_y_[i] = quaternion.y();
+    quaternion_z_[i] = quaternion.z();
+    quaternion_w_[i] = quaternion.w();
+  }
+
+  sortOrder();
+}
+
+void GraspBatch::rank(const robot_state::ReachabilityMap* reachability_map)
+{
+  if (!reachability_map || scores_.empty())
+    return;
+
+  for (std::size_t i = 0; i < scores_.size(); ++i)
+  {
+    if (!resolved_[i])
+      continue;
+    const Eigen::Vector3d position(position_x_[i], position_y_[i], position_z_[i]);
+    if (!reachability_map->isPositionReachable(position))
+      scores_[i] -= UNREACHABLE_POSITION_PENALTY;
+    else
+    {
+      const Eigen::Quaterniond orientation(quaternion_w_[i], quaternion_x_[i], quaternion_y_[i], quaternion_z_[i]);
+      if (!reachability_map->isPoseReachable(position, orientation))
+        scores_[i] -= UNREACHABLE_ORIENTATION_PENALTY;
+    }
+  }
+
+  sortOrder();
+}
+
+void GraspBatch::sortOrder()
+{
+  // stable, so equally scored grasps keep the order they were supplied in
+  const std::vector<double>& scores = scores_;
+  std::stable_sort(order_.begin(), order_.end(),
+                   [&scores](std::size_t a, std::size_t b) { return scores[a] > scores[b]; });
+}
+}
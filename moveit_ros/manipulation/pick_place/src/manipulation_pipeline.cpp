@@ -35,14 +35,21 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/pick_place/manipulation_pipeline.h>
+#include <moveit/utils/task_scheduler.h>
 #include <ros/console.h>
+#include <algorithm>
 
 namespace pick_place
 {
 ManipulationPipeline::ManipulationPipeline(const std::string& name, unsigned int nthreads)
-  : name_(name), nthreads_(nthreads), verbose_(false), stop_processing_(true)
+  : name_(name), nthreads_(nthreads), verbose_(false), active_drains_(0), max_successful_plans_(1), stop_processing_(true)
 {
-  processing_threads_.resize(nthreads, NULL);
+  if (nthreads_ == 0)
+  {
+    nthreads_ = boost::thread::hardware_concurrency();
+    if (nthreads_ == 0)
+      nthreads_ = 4;
+  }
 }
 
 ManipulationPipeline::~ManipulationPipeline()
@@ -108,13 +115,11 @@ void ManipulationPipeline::clear()
 
 void ManipulationPipeline::start()
 {
+  boost::mutex::scoped_lock slock(queue_access_lock_);
   stop_processing_ = false;
-  empty_queue_threads_ = 0;
   for (std::size_t i = 0; i < stages_.size(); ++i)
     stages_[i]->resetStopSignal();
-  for (std::size_t i = 0; i < processing_threads_.size(); ++i)
-    if (!processing_threads_[i])
-      processing_threads_[i] = new boost::thread(boost::bind(&ManipulationPipeline::processingThread, this, i));
+  maybeStartDrain();
 }
 
 void ManipulationPipeline::signalStop()
@@ -122,86 +127,84 @@ void ManipulationPipeline::signalStop()
   for (std::size_t i = 0; i < stages_.size(); ++i)
     stages_[i]->signalStop();
   stop_processing_ = true;
-  queue_access_cond_.notify_all();
 }
 
 void ManipulationPipeline::stop()
 {
   signalStop();
-  for (std::size_t i = 0; i < processing_threads_.size(); ++i)
-    if (processing_threads_[i])
-    {
-      processing_threads_[i]->join();
-      delete processing_threads_[i];
-      processing_threads_[i] = NULL;
-    }
+  boost::unique_lock<boost::mutex> ulock(queue_access_lock_);
+  while (active_drains_ > 0)
+    idle_condition_.wait(ulock);
 }
 
-void ManipulationPipeline::processingThread(unsigned int index)
+void ManipulationPipeline::maybeStartDrain()
 {
-  ROS_DEBUG_STREAM_NAMED("manipulation", "Start thread " << index << " for '" << name_ << "'");
+  if (stop_processing_ || active_drains_ >= nthreads_ || queue_.empty())
+    return;
+  active_drains_++;
+  moveit::tools::TaskScheduler::getInstance().submit(boost::bind(&ManipulationPipeline::drainTask, this), "pick_place");
+}
 
-  while (!stop_processing_)
+void ManipulationPipeline::drainTask()
+{
+  ROS_DEBUG_STREAM_NAMED("manipulation", "Start drain task for '" << name_ << "'");
+
+  boost::unique_lock<boost::mutex> ulock(queue_access_lock_);
+  while (!stop_processing_ && !queue_.empty())
   {
-    bool inc_queue = false;
-    boost::unique_lock<boost::mutex> ulock(queue_access_lock_);
-    // if the queue is empty, we trigger the corresponding event
-    if (queue_.empty() && !stop_processing_ && empty_queue_callback_)
-    {
-      empty_queue_threads_++;
-      inc_queue = true;
-      if (empty_queue_threads_ == processing_threads_.size())
-        empty_queue_callback_();
-    }
-    while (queue_.empty() && !stop_processing_)
-      queue_access_cond_.wait(ulock);
-    while (!stop_processing_ && !queue_.empty())
+    ManipulationPlanPtr g = queue_.front();
+    queue_.pop_front();
+
+    queue_access_lock_.unlock();
+    try
     {
-      ManipulationPlanPtr g = queue_.front();
-      queue_.pop_front();
-      if (inc_queue)
+      g->error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+      for (std::size_t i = 0; !stop_processing_ && i < stages_.size(); ++i)
       {
-        empty_queue_threads_--;
-        inc_queue = false;
+        bool res = stages_[i]->evaluate(g);
+        g->processing_stage_ = i + 1;
+        if (res == false)
+        {
+          boost::mutex::scoped_lock slock(result_lock_);
+          failed_.push_back(g);
+          ROS_INFO_STREAM_NAMED("manipulation", "Manipulation plan " << g->id_ << " failed at stage '"
+                                                                     << stages_[i]->getName() << "'");
+          break;
+        }
       }
-
-      queue_access_lock_.unlock();
-      try
+      if (g->error_code_.val == moveit_msgs::MoveItErrorCodes::SUCCESS)
       {
-        g->error_code_.val = moveit_msgs::MoveItErrorCodes::FAILURE;
-        for (std::size_t i = 0; !stop_processing_ && i < stages_.size(); ++i)
+        g->processing_stage_++;
+        std::size_t successful_plans = 0;
         {
-          bool res = stages_[i]->evaluate(g);
-          g->processing_stage_ = i + 1;
-          if (res == false)
-          {
-            boost::mutex::scoped_lock slock(result_lock_);
-            failed_.push_back(g);
-            ROS_INFO_STREAM_NAMED("manipulation", "Manipulation plan " << g->id_ << " failed at stage '"
-                                                                       << stages_[i]->getName() << "' on thread "
-                                                                       << index);
-            break;
-          }
+          boost::mutex::scoped_lock slock(result_lock_);
+          success_.push_back(g);
+          successful_plans = success_.size();
         }
-        if (g->error_code_.val == moveit_msgs::MoveItErrorCodes::SUCCESS)
+        ROS_INFO_STREAM_NAMED("manipulation", "Found successful manipulation plan!");
+        // keep the remaining candidates flowing through the stages until enough plans succeeded
+        if (successful_plans >= max_successful_plans_)
         {
-          g->processing_stage_++;
-          {
-            boost::mutex::scoped_lock slock(result_lock_);
-            success_.push_back(g);
-          }
           signalStop();
-          ROS_INFO_STREAM_NAMED("manipulation", "Found successful manipulation plan!");
           if (solution_callback_)
             solution_callback_();
         }
       }
-      catch (std::exception& ex)
-      {
-        ROS_ERROR_NAMED("manipulation", "[%s:%u] %s", name_.c_str(), index, ex.what());
-      }
-      queue_access_lock_.lock();
     }
+    catch (std::exception& ex)
+    {
+      ROS_ERROR_NAMED("manipulation", "[%s] %s", name_.c_str(), ex.what());
+    }
+    queue_access_lock_.lock();
+  }
+
+  active_drains_--;
+  if (active_drains_ == 0)
+  {
+    idle_condition_.notify_all();
+    // all queued plans were processed; this mirrors the empty-queue event of the old thread pool
+    if (!stop_processing_ && queue_.empty() && empty_queue_callback_)
+      empty_queue_callback_();
   }
 }
 
@@ -211,7 +214,14 @@ void ManipulationPipeline::push(const ManipulationPlanPtr& plan)
   queue_.push_back(plan);
   ROS_INFO_STREAM_NAMED("manipulation", "Added plan for pipeline '" << name_ << "'. Queue is now of size "
                                                                     << queue_.size());
-  queue_access_cond_.notify_all();
+  maybeStartDrain();
+}
+
+void ManipulationPipeline::sortSuccessfulManipulationPlans(
+    const boost::function<bool(const ManipulationPlanPtr&, const ManipulationPlanPtr&)>& order)
+{
+  boost::mutex::scoped_lock slock(result_lock_);
+  std::stable_sort(success_.begin(), success_.end(), order);
 }
 
 void ManipulationPipeline::reprocessLastFailure()
@@ -225,6 +235,6 @@ void ManipulationPipeline::reprocessLastFailure()
   queue_.push_back(plan);
   ROS_INFO_STREAM_NAMED("manipulation", "Re-added last failed plan for pipeline '"
                                             << name_ << "'. Queue is now of size " << queue_.size());
-  queue_access_cond_.notify_all();
+  maybeStartDrain();
 }
 }
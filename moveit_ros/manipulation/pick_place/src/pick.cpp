@@ -35,6 +35,7 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/pick_place/pick_place.h>
+#include <moveit/pick_place/grasp_batch.h>
 #include <moveit/pick_place/reachable_valid_pose_filter.h>
 #include <moveit/pick_place/approach_and_translate_stage.h>
 #include <moveit/pick_place/plan_stage.h>
@@ -48,15 +49,16 @@ PickPlan::PickPlan(const PickPlaceConstPtr& pick_place) : PickPlacePlanBase(pick
 
 namespace
 {
-struct OrderGraspQuality
+struct OrderPlanGraspQuality
 {
-  OrderGraspQuality(const std::vector<moveit_msgs::Grasp>& grasps) : grasps_(grasps)
+  OrderPlanGraspQuality(const std::vector<moveit_msgs::Grasp>& grasps) : grasps_(grasps)
   {
   }
 
-  bool operator()(const std::size_t a, const std::size_t b) const
+  bool operator()(const ManipulationPlanPtr& a, const ManipulationPlanPtr& b) const
   {
-    return grasps_[a].grasp_quality > grasps_[b].grasp_quality;
+    // ascending, so the best grasp ends up at the back (that is the plan consumers use)
+    return grasps_[a->id_].grasp_quality < grasps_[b->id_].grasp_quality;
   }
 
   const std::vector<moveit_msgs::Grasp>& grasps_;
@@ -167,12 +169,12 @@ bool PickPlan::plan(const planning_scene::PlanningSceneConstPtr& planning_scene,
   initialize();
   pipeline_.start();
 
-  // order the grasps by quality
-  std::vector<std::size_t> grasp_order(goal.possible_grasps.size());
-  for (std::size_t i = 0; i < goal.possible_grasps.size(); ++i)
-    grasp_order[i] = i;
-  OrderGraspQuality oq(goal.possible_grasps);
-  std::sort(grasp_order.begin(), grasp_order.end(), oq);
+  // copy the grasps into a columnar batch and order them best-first: by quality, refined with
+  // the reachability map of the planning group (if one is configured), so the stages spend their
+  // first attempts on the candidates most likely to work out
+  GraspBatch grasp_batch(planning_scene, goal.possible_grasps, goal.target_name);
+  grasp_batch.rank(pick_place_->getReachabilityMap(planning_group));
+  const std::vector<std::size_t>& grasp_order = grasp_batch.order();
 
   // feed the available grasps to the stages we set up
   for (std::size_t i = 0; i < goal.possible_grasps.size(); ++i)
@@ -195,6 +197,9 @@ bool PickPlan::plan(const planning_scene::PlanningSceneConstPtr& planning_scene,
   waitForPipeline(endtime);
   pipeline_.stop();
 
+  // if multiple plans were allowed to succeed, select among them by grasp quality
+  pipeline_.sortSuccessfulManipulationPlans(OrderPlanGraspQuality(goal.possible_grasps));
+
   last_plan_time_ = (ros::WallTime::now() - start_time).toSec();
 
   if (!getSuccessfulManipulationPlans().empty())
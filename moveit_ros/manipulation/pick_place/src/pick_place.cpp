@@ -50,8 +50,12 @@ const double PickPlace::DEFAULT_GRASP_POSTURE_COMPLETION_DURATION = 7.0;  // sec
 // functionality specific to place-only is in place.cpp;
 
 PickPlacePlanBase::PickPlacePlanBase(const PickPlaceConstPtr& pick_place, const std::string& name)
-  : pick_place_(pick_place), pipeline_(name, 4), last_plan_time_(0.0), done_(false)
+  : pick_place_(pick_place)
+  , pipeline_(name, GetGlobalPickPlaceParams().planning_threads_)
+  , last_plan_time_(0.0)
+  , done_(false)
 {
+  pipeline_.setMaxSuccessfulPlans(GetGlobalPickPlaceParams().max_successful_plans_);
   pipeline_.setSolutionCallback(boost::bind(&PickPlacePlanBase::foundSolution, this));
   pipeline_.setEmptyQueueCallback(boost::bind(&PickPlacePlanBase::emptyQueue, this));
 }
@@ -96,6 +100,22 @@ PickPlace::PickPlace(const planning_pipeline::PlanningPipelinePtr& planning_pipe
   : nh_("~"), planning_pipeline_(planning_pipeline), display_computed_motion_plans_(false), display_grasps_(false)
 {
   constraint_sampler_manager_loader_.reset(new constraint_sampler_manager_loader::ConstraintSamplerManagerLoader());
+  nh_.param("reachability_map_directory", reachability_map_directory_, std::string());
+}
+
+const robot_state::ReachabilityMap* PickPlace::getReachabilityMap(const std::string& group) const
+{
+  if (reachability_map_directory_.empty() || group.empty())
+    return NULL;
+  boost::mutex::scoped_lock slock(reachability_maps_lock_);
+  std::map<std::string, robot_state::ReachabilityMapPtr>::const_iterator it = reachability_maps_.find(group);
+  if (it != reachability_maps_.end())
+    return it->second.get();
+  robot_state::ReachabilityMapPtr map(new robot_state::ReachabilityMap());
+  if (!map->load(reachability_map_directory_ + "/" + group + ".rmap"))
+    map.reset();  // remember the failure so the load is not retried for every goal
+  reachability_maps_[group] = map;
+  return map.get();
 }
 
 void PickPlace::displayProcessedGrasps(bool flag)
@@ -63,6 +63,8 @@ static const std::string APPLY_PLANNING_SCENE_SERVICE_NAME =
     "apply_planning_scene";  // name of the service that applies a given planning scene
 static const std::string CLEAR_OCTOMAP_SERVICE_NAME =
     "clear_octomap";  // name of the service that can be used to clear the octomap
+static const std::string CLEAR_PLAN_CACHE_SERVICE_NAME =
+    "clear_plan_cache";  // name of the service that can be used to clear the plan cache
 }
 
 #endif
@@ -62,6 +62,8 @@ MOVEIT_CLASS_FORWARD(TrajectoryExecutionManager);
 
 namespace move_group
 {
+MOVEIT_CLASS_FORWARD(PerformanceMetrics);
+MOVEIT_CLASS_FORWARD(PlanCache);
 MOVEIT_CLASS_FORWARD(MoveGroupContext);
 
 struct MoveGroupContext
@@ -77,6 +79,8 @@ struct MoveGroupContext
   planning_pipeline::PlanningPipelinePtr planning_pipeline_;
   plan_execution::PlanExecutionPtr plan_execution_;
   plan_execution::PlanWithSensingPtr plan_with_sensing_;
+  PerformanceMetricsPtr performance_metrics_;
+  PlanCachePtr plan_cache_;
   bool allow_trajectory_execution_;
   bool debug_;
 };
@@ -0,0 +1,132 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_MOVE_GROUP_PERFORMANCE_METRICS_
+#define MOVEIT_MOVE_GROUP_PERFORMANCE_METRICS_
+
+#include <moveit/macros/class_forward.h>
+#include <ros/ros.h>
+#include <std_srvs/Trigger.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <boost/thread/mutex.hpp>
+
+namespace move_group
+{
+MOVEIT_CLASS_FORWARD(PerformanceMetrics);
+
+/** @class PerformanceMetrics
+    @brief Registry of latency histograms for the hot paths of move_group. Recording a sample is a few
+    relaxed atomic increments, so capabilities can time every request. The histograms are published on
+    the diagnostics topic while samples arrive (nothing is published when idle) and can be pulled at any
+    time through the get_performance_metrics service. */
+class PerformanceMetrics
+{
+public:
+  /** @brief A latency histogram with lock-free recording. Bucket \e i counts samples in
+      [2^i, 2^(i+1)) microseconds, so quantile estimates carry a relative error bounded by the
+      bucket width. */
+  class Histogram
+  {
+  public:
+    Histogram();
+
+    /** @brief Record a duration, given in seconds */
+    void record(double seconds);
+
+    /** @brief Number of recorded samples */
+    std::uint64_t getCount() const;
+
+    /** @brief Mean of the recorded samples, in seconds */
+    double getMean() const;
+
+    /** @brief Estimate the given quantile (in [0, 1]) of the recorded samples, in seconds */
+    double getQuantile(double quantile) const;
+
+  private:
+    /// 40 doubling buckets starting at 1 microsecond span more than 12 days
+    static const std::size_t BUCKET_COUNT = 40;
+
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets_;
+    std::atomic<std::uint64_t> count_;
+    std::atomic<std::uint64_t> sum_us_;
+  };
+  typedef std::shared_ptr<Histogram> HistogramPtr;
+
+  /** @brief Record the wall time between construction and destruction in a histogram */
+  class ScopedTimer
+  {
+  public:
+    ScopedTimer(const HistogramPtr& histogram) : histogram_(histogram), start_(ros::WallTime::now())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+      if (histogram_)
+        histogram_->record((ros::WallTime::now() - start_).toSec());
+    }
+
+  private:
+    HistogramPtr histogram_;
+    ros::WallTime start_;
+  };
+
+  PerformanceMetrics(const ros::NodeHandle& node_handle);
+
+  /** @brief Get the histogram registered under \e name, creating it if needed. The returned pointer
+      can be stored by the caller and used without further registry lookups. */
+  HistogramPtr getHistogram(const std::string& name);
+
+private:
+  void publishDiagnostics(const ros::TimerEvent& event);
+  bool getMetricsService(std_srvs::Trigger::Request& req, std_srvs::Trigger::Response& res);
+
+  ros::NodeHandle node_handle_;
+  ros::Publisher diagnostics_publisher_;
+  ros::ServiceServer metrics_service_;
+  ros::Timer diagnostics_timer_;
+
+  /// protects \e histograms_; taken when registering and exporting, not when recording
+  boost::mutex lock_;
+  std::map<std::string, HistogramPtr> histograms_;
+  std::uint64_t last_published_samples_;
+};
+}
+
+#endif
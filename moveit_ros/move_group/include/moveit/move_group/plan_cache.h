@@ -0,0 +1,135 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_MOVE_GROUP_PLAN_CACHE_
+#define MOVEIT_MOVE_GROUP_PLAN_CACHE_
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/planning_interface/planning_request.h>
+#include <moveit/planning_interface/planning_response.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <moveit_msgs/RobotState.h>
+#include <moveit_msgs/RobotTrajectory.h>
+#include <boost/thread/mutex.hpp>
+#include <cstdint>
+#include <list>
+#include <map>
+
+namespace move_group
+{
+MOVEIT_CLASS_FORWARD(PlanCache);
+
+/** \brief Memoize successful motion plans, keyed on the planning group, the quantized start
+    state, the hashed goal and path constraints and a signature of the world geometry.
+
+    Repetitive applications issue the same handful of planning requests over and over; a cache
+    hit replaces a full planning pipeline run with a (much cheaper) validation of the cached
+    path against the current planning scene. Entries that fail validation are evicted and the
+    caller falls back to planning. The cache is bounded and evicts least recently used entries.
+
+    The cache is disabled by default; loading the MoveGroupPlanCacheService capability
+    enables it. */
+class PlanCache
+{
+public:
+  PlanCache();
+
+  bool isEnabled() const
+  {
+    return enabled_;
+  }
+
+  void setEnabled(bool flag)
+  {
+    enabled_ = flag;
+  }
+
+  std::size_t getMaxSize() const
+  {
+    return max_size_;
+  }
+
+  /** \brief Set the maximum number of cached plans; least recently used entries are evicted */
+  void setMaxSize(std::size_t max_size);
+
+  /** \brief Look up a cached plan for \e req. On a hit the cached path is validated against
+      \e scene (including the request's path and goal constraints) before \e res is filled in;
+      entries that fail validation are evicted. Returns true only for a validated hit. */
+  bool fetch(const planning_scene::PlanningSceneConstPtr& scene, const planning_interface::MotionPlanRequest& req,
+             planning_interface::MotionPlanResponse& res);
+
+  /** \brief Store the result of a successful planning pipeline run; does nothing if \e res
+      does not contain a successfully computed trajectory */
+  void store(const planning_scene::PlanningSceneConstPtr& scene, const planning_interface::MotionPlanRequest& req,
+             const planning_interface::MotionPlanResponse& res);
+
+  /** \brief Remove all cached plans */
+  void clear();
+
+  std::size_t getEntryCount() const;
+
+  std::size_t getHitCount() const
+  {
+    return hits_;
+  }
+
+  std::size_t getMissCount() const
+  {
+    return misses_;
+  }
+
+private:
+  struct Entry
+  {
+    moveit_msgs::RobotState trajectory_start;
+    moveit_msgs::RobotTrajectory trajectory;
+    std::list<std::uint64_t>::iterator lru_position;
+  };
+
+  /** \brief Compute the cache key for a request against a scene */
+  std::uint64_t cacheKey(const planning_scene::PlanningSceneConstPtr& scene,
+                         const planning_interface::MotionPlanRequest& req) const;
+
+  bool enabled_;
+  std::size_t max_size_;
+
+  mutable boost::mutex lock_;
+  std::map<std::uint64_t, Entry> entries_;
+  std::list<std::uint64_t> lru_;  // most recently used keys at the front
+  std::size_t hits_;
+  std::size_t misses_;
+};
+}
+
+#endif
@@ -43,30 +43,221 @@
 #include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit_msgs/DisplayTrajectory.h>
 #include <moveit/trajectory_processing/iterative_time_parameterization.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <ros/serialization.h>
+#include <cmath>
+
+namespace
+{
+// resolution at which start state values and waypoint poses are considered equal
+const double SIGNATURE_RESOLUTION = 1e-3;
+
+std::uint64_t fnv1a(const void* data, std::size_t length, std::uint64_t hash)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < length; ++i)
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  return hash;
+}
+
+std::uint64_t hashQuantized(double value, std::uint64_t hash)
+{
+  std::int64_t quantized = static_cast<std::int64_t>(std::floor(value / SIGNATURE_RESOLUTION + 0.5));
+  return fnv1a(&quantized, sizeof(quantized), hash);
+}
+}
 
 move_group::MoveGroupCartesianPathService::MoveGroupCartesianPathService()
-  : MoveGroupCapability("CartesianPathService"), display_computed_paths_(true)
+  : MoveGroupCapability("CartesianPathService")
+  , display_computed_paths_(true)
+  , cartesian_path_threads_(1)
+  , cartesian_path_cache_size_(32)
 {
 }
 
 void move_group::MoveGroupCartesianPathService::initialize()
 {
+  node_handle_.param("cartesian_path_threads", cartesian_path_threads_, 1);
+  node_handle_.param("cartesian_path_cache_size", cartesian_path_cache_size_, 32);
   display_path_ = node_handle_.advertise<moveit_msgs::DisplayTrajectory>(
       planning_pipeline::PlanningPipeline::DISPLAY_PATH_TOPIC, 10, true);
+  progress_path_ = node_handle_.advertise<moveit_msgs::DisplayTrajectory>("cartesian_path_progress", 10);
   cartesian_path_service_ = root_node_handle_.advertiseService(CARTESIAN_PATH_SERVICE_NAME,
                                                                &MoveGroupCartesianPathService::computeService, this);
 }
 
+void move_group::MoveGroupCartesianPathService::publishProgress(const std::string& group_name,
+                                                                const std::vector<robot_state::RobotStatePtr>& traj)
+{
+  if (progress_path_.getNumSubscribers() == 0 || traj.empty())
+    return;
+
+  robot_trajectory::RobotTrajectory rt(context_->planning_scene_monitor_->getRobotModel(), group_name);
+  for (std::size_t i = 0; i < traj.size(); ++i)
+    rt.addSuffixWayPoint(traj[i], 0.0);
+  trajectory_processing::IterativeParabolicTimeParameterization time_param;
+  time_param.computeTimeStamps(rt, 1.0);
+
+  moveit_msgs::DisplayTrajectory prefix;
+  prefix.model_id = context_->planning_scene_monitor_->getRobotModel()->getName();
+  prefix.trajectory.resize(1);
+  rt.getRobotTrajectoryMsg(prefix.trajectory[0]);
+  robot_state::robotStateToRobotStateMsg(rt.getFirstWayPoint(), prefix.trajectory_start);
+  progress_path_.publish(prefix);
+}
+
+std::uint64_t move_group::MoveGroupCartesianPathService::pathSignature(
+    const moveit_msgs::GetCartesianPath::Request& req, const robot_state::RobotState& start_state,
+    const EigenSTL::vector_Isometry3d& waypoints, const std::string& link_name) const
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+
+  // hash the request itself, with the fields that are keyed separately in resolved form below
+  // blanked out (the header also carries a sequence number and stamp that must not contribute)
+  moveit_msgs::GetCartesianPath::Request key_req = req;
+  key_req.header = std_msgs::Header();
+  key_req.start_state = moveit_msgs::RobotState();
+  key_req.waypoints.clear();
+  key_req.link_name.clear();
+  std::vector<std::uint8_t> buffer(ros::serialization::serializationLength(key_req));
+  if (!buffer.empty())
+  {
+    ros::serialization::OStream stream(buffer.data(), buffer.size());
+    ros::serialization::serialize(stream, key_req);
+    hash = fnv1a(buffer.data(), buffer.size(), hash);
+  }
+
+  // the frame decides whether the waypoints are interpreted in the global or the link frame
+  hash = fnv1a(req.header.frame_id.data(), req.header.frame_id.length(), hash);
+  hash = fnv1a(link_name.data(), link_name.length(), hash);
+
+  // quantized waypoint poses, as resolved for the solve
+  for (std::size_t i = 0; i < waypoints.size(); ++i)
+    for (int r = 0; r < 3; ++r)
+      for (int c = 0; c < 4; ++c)
+        hash = hashQuantized(waypoints[i](r, c), hash);
+
+  // quantized start state, as resolved against the current state
+  const double* positions = start_state.getVariablePositions();
+  for (std::size_t i = 0; i < start_state.getVariableCount(); ++i)
+    hash = hashQuantized(positions[i], hash);
+
+  return hash;
+}
+
+bool move_group::MoveGroupCartesianPathService::fetchCachedPath(std::uint64_t signature,
+                                                                const moveit_msgs::GetCartesianPath::Request& req,
+                                                                moveit_msgs::GetCartesianPath::Response& res)
+{
+  if (cartesian_path_cache_size_ <= 0)
+    return false;
+
+  CachedPath entry;
+  {
+    boost::mutex::scoped_lock slock(path_cache_lock_);
+    std::map<std::uint64_t, CachedPath>::iterator it = path_cache_.find(signature);
+    if (it == path_cache_.end())
+      return false;
+    path_cache_lru_.splice(path_cache_lru_.begin(), path_cache_lru_, it->second.lru_position);
+    entry = it->second;
+  }
+
+  // a cached path depends on the scene only when collisions were avoided or path constraints
+  // given; purely kinematic requests can be served without looking at the world at all
+  if (req.avoid_collisions || !kinematic_constraints::isEmpty(req.path_constraints))
+  {
+    planning_scene_monitor::LockedPlanningSceneRO ls(context_->planning_scene_monitor_);
+    const collision_detection::WorldConstPtr& world = ls->getWorld();
+    const std::uint64_t geometry_epoch = world->getGeometryEpoch();
+    const std::uint64_t pose_epoch = world->getPoseEpoch();
+    if (geometry_epoch != entry.geometry_epoch || pose_epoch != entry.pose_epoch)
+    {
+      // the world changed since this path was last known to be valid; revalidating the joint
+      // path is still far cheaper than re-running IK along the Cartesian path
+      robot_state::RobotState reference_state(ls->getRobotModel());
+      robot_state::robotStateMsgToRobotState(entry.start_state, reference_state);
+      robot_trajectory::RobotTrajectory trajectory(ls->getRobotModel(), req.group_name);
+      trajectory.setRobotTrajectoryMsg(reference_state, entry.solution);
+      if (!ls->isPathValidParallel(trajectory, req.path_constraints, std::vector<moveit_msgs::Constraints>(),
+                                   req.group_name))
+      {
+        boost::mutex::scoped_lock slock(path_cache_lock_);
+        std::map<std::uint64_t, CachedPath>::iterator it = path_cache_.find(signature);
+        if (it != path_cache_.end())
+        {
+          path_cache_lru_.erase(it->second.lru_position);
+          path_cache_.erase(it);
+        }
+        ROS_DEBUG("Cached Cartesian path failed validation against the current scene; solving again");
+        return false;
+      }
+      // remember that the path is valid for the current world, so the next cycle at this epoch
+      // skips the validation pass as well
+      boost::mutex::scoped_lock slock(path_cache_lock_);
+      std::map<std::uint64_t, CachedPath>::iterator it = path_cache_.find(signature);
+      if (it != path_cache_.end())
+      {
+        it->second.geometry_epoch = geometry_epoch;
+        it->second.pose_epoch = pose_epoch;
+      }
+    }
+  }
+
+  res.start_state = entry.start_state;
+  res.solution = entry.solution;
+  res.fraction = entry.fraction;
+  ROS_INFO("Serving Cartesian path from cache (%u points)",
+           (unsigned int)entry.solution.joint_trajectory.points.size());
+  return true;
+}
+
+void move_group::MoveGroupCartesianPathService::storeCachedPath(std::uint64_t signature,
+                                                                const moveit_msgs::GetCartesianPath::Response& res,
+                                                                std::uint64_t geometry_epoch, std::uint64_t pose_epoch)
+{
+  // only fully solved paths are worth replaying; where a partial path stops depends on the scene
+  if (cartesian_path_cache_size_ <= 0 || res.solution.joint_trajectory.points.empty() ||
+      fabs(res.fraction - 1.0) > std::numeric_limits<double>::epsilon())
+    return;
+
+  CachedPath entry;
+  entry.start_state = res.start_state;
+  entry.solution = res.solution;
+  entry.fraction = res.fraction;
+  entry.geometry_epoch = geometry_epoch;
+  entry.pose_epoch = pose_epoch;
+
+  boost::mutex::scoped_lock slock(path_cache_lock_);
+  std::map<std::uint64_t, CachedPath>::iterator it = path_cache_.find(signature);
+  if (it != path_cache_.end())
+    path_cache_lru_.erase(it->second.lru_position);
+  else if (path_cache_.size() >= static_cast<std::size_t>(cartesian_path_cache_size_))
+  {
+    path_cache_.erase(path_cache_lru_.back());
+    path_cache_lru_.pop_back();
+  }
+  path_cache_lru_.push_front(signature);
+  entry.lru_position = path_cache_lru_.begin();
+  path_cache_[signature] = entry;
+}
+
 namespace
 {
-bool isStateValid(const planning_scene::PlanningScene* planning_scene,
+bool isStateValid(const planning_scene::PlanningScene* planning_scene, boost::mutex* scene_lock,
                   const kinematic_constraints::KinematicConstraintSet* constraint_set, robot_state::RobotState* state,
                   const robot_state::JointModelGroup* group, const double* ik_solution)
 {
   state->setJointGroupPositions(group, ik_solution);
   state->update();
-  return (!planning_scene || !planning_scene->isStateColliding(*state, group->getName())) &&
-         (!constraint_set || constraint_set->decide(*state).satisfied);
+  if (planning_scene)
+  {
+    // the scene's collision structures are not safe for concurrent queries, and this callback
+    // runs on all chunk threads of the parallel Cartesian solver at once; serialize the check
+    boost::mutex::scoped_lock slock(*scene_lock);
+    if (planning_scene->isStateColliding(*state, group->getName()))
+      return false;
+  }
+  return !constraint_set || constraint_set->decide(*state).satisfied;
 }
 }
 
@@ -124,9 +315,27 @@ bool move_group::MoveGroupCartesianPathService::computeService(moveit_msgs::GetC
       {
         if (waypoints.size() > 0)
         {
+          // cyclic tasks repeat the same Cartesian request over and over; serve the memoized
+          // joint path when we already solved this exact request and the scene still allows it
+          const std::uint64_t signature = pathSignature(req, start_state, waypoints, link_name);
+          if (fetchCachedPath(signature, req, res))
+          {
+            res.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+            return true;
+          }
+          // record the world epochs before solving: if the world changes mid-solve, the stored
+          // entry looks stale and gets revalidated on its first hit
+          std::uint64_t geometry_epoch = 0, pose_epoch = 0;
+          {
+            planning_scene_monitor::LockedPlanningSceneRO ls_epoch(context_->planning_scene_monitor_);
+            geometry_epoch = ls_epoch->getWorld()->getGeometryEpoch();
+            pose_epoch = ls_epoch->getWorld()->getPoseEpoch();
+          }
+
           robot_state::GroupStateValidityCallbackFn constraint_fn;
           std::unique_ptr<planning_scene_monitor::LockedPlanningSceneRO> ls;
           std::unique_ptr<kinematic_constraints::KinematicConstraintSet> kset;
+          boost::mutex scene_collision_lock;
           if (req.avoid_collisions || !kinematic_constraints::isEmpty(req.path_constraints))
           {
             ls.reset(new planning_scene_monitor::LockedPlanningSceneRO(context_->planning_scene_monitor_));
@@ -135,19 +344,48 @@ bool move_group::MoveGroupCartesianPathService::computeService(moveit_msgs::GetC
             constraint_fn = boost::bind(
                 &isStateValid,
                 req.avoid_collisions ? static_cast<const planning_scene::PlanningSceneConstPtr&>(*ls).get() : NULL,
-                kset->empty() ? NULL : kset.get(), _1, _2, _3);
+                &scene_collision_lock, kset->empty() ? NULL : kset.get(), _1, _2, _3);
           }
           bool global_frame = !robot_state::Transforms::sameFrame(link_name, req.header.frame_id);
           ROS_INFO("Attempting to follow %u waypoints for link '%s' using a step of %lf m and jump threshold %lf (in "
                    "%s reference frame)",
                    (unsigned int)waypoints.size(), link_name.c_str(), req.max_step, req.jump_threshold,
                    global_frame ? "global" : "link");
-          std::vector<robot_state::RobotStatePtr> traj;
-          res.fraction =
-              start_state.computeCartesianPath(jmg, traj, start_state.getLinkModel(link_name), waypoints, global_frame,
-                                               req.max_step, req.jump_threshold, constraint_fn);
           robot_state::robotStateToRobotStateMsg(start_state, res.start_state);
 
+          // compute the path waypoint by waypoint so validated prefixes can be streamed on the
+          // progress topic while the remainder is still being solved; this mirrors the logic of
+          // the multi-waypoint computeCartesianPath() overload (joint-space jumps are tested on
+          // the whole trajectory at the end)
+          std::vector<robot_state::RobotStatePtr> traj;
+          res.fraction = 0.0;
+          for (std::size_t i = 0; i < waypoints.size(); ++i)
+          {
+            static const robot_state::JumpThreshold NO_JOINT_SPACE_JUMP_TEST;
+            std::vector<robot_state::RobotStatePtr> waypoint_traj;
+            double wp_fraction = start_state.computeCartesianPathParallel(
+                jmg, waypoint_traj, start_state.getLinkModel(link_name), waypoints[i], global_frame,
+                robot_state::MaxEEFStep(req.max_step), NO_JOINT_SPACE_JUMP_TEST,
+                cartesian_path_threads_ > 0 ? cartesian_path_threads_ : 0, constraint_fn);
+
+            std::vector<robot_state::RobotStatePtr>::iterator seg_start = waypoint_traj.begin();
+            if (i > 0 && !waypoint_traj.empty())
+              std::advance(seg_start, 1);
+            traj.insert(traj.end(), seg_start, waypoint_traj.end());
+
+            bool waypoint_complete = fabs(wp_fraction - 1.0) < std::numeric_limits<double>::epsilon();
+            if (waypoint_complete)
+              res.fraction = (double)(i + 1) / (double)waypoints.size();
+            else
+              res.fraction += wp_fraction / (double)waypoints.size();
+
+            publishProgress(req.group_name, traj);
+
+            if (!waypoint_complete)
+              break;
+          }
+          res.fraction *= start_state.testJointSpaceJump(jmg, traj, robot_state::JumpThreshold(req.jump_threshold));
+
           robot_trajectory::RobotTrajectory rt(context_->planning_scene_monitor_->getRobotModel(), req.group_name);
           for (std::size_t i = 0; i < traj.size(); ++i)
             rt.addSuffixWayPoint(traj[i], 0.0);
@@ -168,6 +406,8 @@ bool move_group::MoveGroupCartesianPathService::computeService(moveit_msgs::GetC
             robot_state::robotStateToRobotStateMsg(rt.getFirstWayPoint(), disp.trajectory_start);
             display_path_.publish(disp);
           }
+
+          storeCachedPath(signature, res, geometry_epoch, pose_epoch);
         }
         res.error_code.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
       }
@@ -38,7 +38,12 @@
 #define MOVEIT_MOVE_GROUP_CARTESIAN_PATH_SERVICE_CAPABILITY_
 
 #include <moveit/move_group/move_group_capability.h>
+#include <moveit/robot_state/robot_state.h>
 #include <moveit_msgs/GetCartesianPath.h>
+#include <boost/thread/mutex.hpp>
+#include <cstdint>
+#include <list>
+#include <map>
 
 namespace move_group
 {
@@ -50,11 +55,53 @@ public:
   void initialize() override;
 
 private:
+  /** \brief One memoized Cartesian solve: the full joint-space path for a request signature,
+      together with the world epochs recorded when the path was last known to be valid */
+  struct CachedPath
+  {
+    moveit_msgs::RobotState start_state;
+    moveit_msgs::RobotTrajectory solution;
+    double fraction;
+    std::uint64_t geometry_epoch;
+    std::uint64_t pose_epoch;
+    std::list<std::uint64_t>::iterator lru_position;
+  };
+
   bool computeService(moveit_msgs::GetCartesianPath::Request& req, moveit_msgs::GetCartesianPath::Response& res);
 
+  /** \brief Signature of a Cartesian request: the group, resolved link, quantized start state and
+      resolved waypoint poses, step sizes and constraints. Requests with the same signature solve
+      to the same joint-space path as long as the scene still permits it. */
+  std::uint64_t pathSignature(const moveit_msgs::GetCartesianPath::Request& req,
+                              const robot_state::RobotState& start_state,
+                              const EigenSTL::vector_Isometry3d& waypoints, const std::string& link_name) const;
+
+  /** \brief Serve \e res from the path cache if a cached solve for \e signature is still valid.
+      When the world epochs are unchanged since the entry was stored the cached path is returned
+      as is; otherwise it is revalidated against the current scene (and evicted on failure). */
+  bool fetchCachedPath(std::uint64_t signature, const moveit_msgs::GetCartesianPath::Request& req,
+                       moveit_msgs::GetCartesianPath::Response& res);
+
+  /** \brief Memoize a fully solved request (fraction 1) together with the world epochs recorded
+      before the solve started */
+  void storeCachedPath(std::uint64_t signature, const moveit_msgs::GetCartesianPath::Response& res,
+                       std::uint64_t geometry_epoch, std::uint64_t pose_epoch);
+
+  /** \brief Publish the (time parameterized) path computed so far on the progress topic, so
+      consumers can start executing the first segments while the rest is still being solved */
+  void publishProgress(const std::string& group_name, const std::vector<robot_state::RobotStatePtr>& traj);
+
   ros::ServiceServer cartesian_path_service_;
   ros::Publisher display_path_;
+  ros::Publisher progress_path_;
   bool display_computed_paths_;
+  int cartesian_path_threads_;
+
+  /** \brief Memoized solves, keyed by request signature; bounded LRU (see ~cartesian_path_cache_size) */
+  boost::mutex path_cache_lock_;
+  std::map<std::uint64_t, CachedPath> path_cache_;
+  std::list<std::uint64_t> path_cache_lru_;  // most recently used signatures at the front
+  int cartesian_path_cache_size_;
 };
 }
 
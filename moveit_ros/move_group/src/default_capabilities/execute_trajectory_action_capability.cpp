@@ -49,6 +49,8 @@ MoveGroupExecuteTrajectoryAction::MoveGroupExecuteTrajectoryAction() : MoveGroup
 
 void MoveGroupExecuteTrajectoryAction::initialize()
 {
+  execution_time_metric_ = context_->performance_metrics_->getHistogram("execution_time");
+
   // start the move action server
   execute_action_server_.reset(new actionlib::SimpleActionServer<moveit_msgs::ExecuteTrajectoryAction>(
       root_node_handle_, EXECUTE_ACTION_NAME,
@@ -69,7 +71,10 @@ void MoveGroupExecuteTrajectoryAction::executePathCallback(const moveit_msgs::Ex
     return;
   }
 
-  executePath(goal, action_res);
+  {
+    PerformanceMetrics::ScopedTimer execution_timer(execution_time_metric_);
+    executePath(goal, action_res);
+  }
 
   const std::string response = getActionResultString(action_res.error_code, false, false);
   if (action_res.error_code.val == moveit_msgs::MoveItErrorCodes::SUCCESS)
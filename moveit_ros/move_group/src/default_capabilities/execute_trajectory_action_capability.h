@@ -42,6 +42,7 @@
 #define MOVEIT_MOVE_GROUP_EXECUTE_TRAJECTORY_ACTION_CAPABILITY_
 
 #include <moveit/move_group/move_group_capability.h>
+#include <moveit/move_group/performance_metrics.h>
 #include <actionlib/server/simple_action_server.h>
 #include <moveit_msgs/ExecuteTrajectoryAction.h>
 #include <memory>
@@ -63,6 +64,7 @@ private:
   void setExecuteTrajectoryState(MoveGroupState state);
 
   std::unique_ptr<actionlib::SimpleActionServer<moveit_msgs::ExecuteTrajectoryAction> > execute_action_server_;
+  PerformanceMetrics::HistogramPtr execution_time_metric_;
 };
 
 }  // namespace move_group
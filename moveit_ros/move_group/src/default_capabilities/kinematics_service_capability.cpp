@@ -46,10 +46,32 @@ move_group::MoveGroupKinematicsService::MoveGroupKinematicsService() : MoveGroup
 
 void move_group::MoveGroupKinematicsService::initialize()
 {
-  fk_service_ =
-      root_node_handle_.advertiseService(FK_SERVICE_NAME, &MoveGroupKinematicsService::computeFKService, this);
-  ik_service_ =
-      root_node_handle_.advertiseService(IK_SERVICE_NAME, &MoveGroupKinematicsService::computeIKService, this);
+  ik_time_metric_ = context_->performance_metrics_->getHistogram("ik_time");
+
+  int worker_threads = 4;
+  node_handle_.param("kinematics_worker_threads", worker_threads, 4);
+  if (worker_threads < 1)
+    worker_threads = 1;
+
+  ros::AdvertiseServiceOptions fk_ops = ros::AdvertiseServiceOptions::create<moveit_msgs::GetPositionFK>(
+      FK_SERVICE_NAME, boost::bind(&MoveGroupKinematicsService::computeFKService, this, _1, _2), ros::VoidConstPtr(),
+      &service_queue_);
+  fk_service_ = root_node_handle_.advertiseService(fk_ops);
+  ros::AdvertiseServiceOptions ik_ops = ros::AdvertiseServiceOptions::create<moveit_msgs::GetPositionIK>(
+      IK_SERVICE_NAME, boost::bind(&MoveGroupKinematicsService::computeIKService, this, _1, _2), ros::VoidConstPtr(),
+      &service_queue_);
+  ik_service_ = root_node_handle_.advertiseService(ik_ops);
+  service_spinner_.reset(new ros::AsyncSpinner(worker_threads, &service_queue_));
+  service_spinner_->start();
+}
+
+boost::mutex& move_group::MoveGroupKinematicsService::getGroupIKLock(const std::string& group_name) const
+{
+  boost::mutex::scoped_lock slock(group_ik_locks_lock_);
+  std::shared_ptr<boost::mutex>& lock = group_ik_locks_[group_name];
+  if (!lock)
+    lock.reset(new boost::mutex());
+  return *lock;
 }
 
 namespace
@@ -73,6 +95,9 @@ void move_group::MoveGroupKinematicsService::computeIK(
   const robot_state::JointModelGroup* jmg = rs.getJointModelGroup(req.group_name);
   if (jmg)
   {
+    // IK queries for the same group are serialized (the solver instances are stateful);
+    // queries for different groups run in parallel on the worker pool
+    boost::mutex::scoped_lock slock(getGroupIKLock(req.group_name));
     robot_state::robotStateMsgToRobotState(req.robot_state, rs);
     const std::string& default_frame = context_->planning_scene_monitor_->getRobotModel()->getModelFrame();
 
@@ -143,6 +168,8 @@ void move_group::MoveGroupKinematicsService::computeIK(
 bool move_group::MoveGroupKinematicsService::computeIKService(moveit_msgs::GetPositionIK::Request& req,
                                                               moveit_msgs::GetPositionIK::Response& res)
 {
+  PerformanceMetrics::ScopedTimer ik_timer(ik_time_metric_);
+
   context_->planning_scene_monitor_->updateFrameTransforms();
 
   // check if the planning scene needs to be kept locked; if so, call computeIK() in the scope of the lock
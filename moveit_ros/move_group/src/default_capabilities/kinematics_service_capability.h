@@ -38,8 +38,13 @@
 #define MOVEIT_MOVE_GROUP_KINEMATICS_SERVICE_CAPABILITY_
 
 #include <moveit/move_group/move_group_capability.h>
+#include <moveit/move_group/performance_metrics.h>
 #include <moveit_msgs/GetPositionIK.h>
 #include <moveit_msgs/GetPositionFK.h>
+#include <ros/callback_queue.h>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <memory>
 
 namespace move_group
 {
@@ -59,8 +64,21 @@ private:
       robot_state::RobotState& rs,
       const robot_state::GroupStateValidityCallbackFn& constraint = robot_state::GroupStateValidityCallbackFn()) const;
 
+  /** \brief Get the lock serializing IK queries for a group; the kinematics solver instances
+      attached to the model keep internal state and must not be used concurrently */
+  boost::mutex& getGroupIKLock(const std::string& group_name) const;
+
   ros::ServiceServer fk_service_;
   ros::ServiceServer ik_service_;
+  PerformanceMetrics::HistogramPtr ik_time_metric_;
+
+  /// requests are served from a dedicated callback queue by a pool of worker threads, so bulk
+  /// IK/FK queries do not serialize with the node's global callback queue
+  ros::CallbackQueue service_queue_;
+  std::unique_ptr<ros::AsyncSpinner> service_spinner_;
+
+  mutable boost::mutex group_ik_locks_lock_;
+  mutable std::map<std::string, std::shared_ptr<boost::mutex> > group_ik_locks_;
 };
 }
 
@@ -42,55 +42,268 @@
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/kinematic_constraints/utils.h>
 #include <moveit/move_group/capability_names.h>
+#include <moveit/move_group/plan_cache.h>
+#include <cmath>
 
 move_group::MoveGroupMoveAction::MoveGroupMoveAction()
-  : MoveGroupCapability("MoveAction"), move_state_(IDLE), preempt_requested_{ false }
+  : MoveGroupCapability("MoveAction"), execution_active_(false), shutdown_(false), preempt_requested_{ false }
 {
 }
 
+move_group::MoveGroupMoveAction::~MoveGroupMoveAction()
+{
+  {
+    boost::mutex::scoped_lock slock(goals_lock_);
+    shutdown_ = true;
+  }
+  goals_cond_.notify_all();
+  worker_threads_.join_all();
+}
+
 void move_group::MoveGroupMoveAction::initialize()
 {
-  // start the move action server
-  move_action_server_.reset(new actionlib::SimpleActionServer<moveit_msgs::MoveGroupAction>(
-      root_node_handle_, MOVE_ACTION, boost::bind(&MoveGroupMoveAction::executeMoveCallback, this, _1), false));
-  move_action_server_->registerPreemptCallback(boost::bind(&MoveGroupMoveAction::preemptMoveCallback, this));
+  plan_time_metric_ = context_->performance_metrics_->getHistogram("plan_time");
+
+  node_handle_.param("reachability_map_directory", reachability_map_directory_, std::string());
+
+  int worker_threads = 1;
+  node_handle_.param("move_group_worker_threads", worker_threads, 1);
+  if (worker_threads < 1)
+    worker_threads = 1;
+  for (int i = 0; i < worker_threads; ++i)
+    worker_threads_.create_thread(boost::bind(&MoveGroupMoveAction::workerThread, this));
+
+  // start the move action server; goals are queued and dispatched to the worker pool so that
+  // goals for independent planning groups can be processed concurrently
+  move_action_server_.reset(new MoveActionServer(root_node_handle_, MOVE_ACTION,
+                                                 boost::bind(&MoveGroupMoveAction::goalCallback, this, _1),
+                                                 boost::bind(&MoveGroupMoveAction::cancelCallback, this, _1), false));
   move_action_server_->start();
 }
 
-void move_group::MoveGroupMoveAction::executeMoveCallback(const moveit_msgs::MoveGroupGoalConstPtr& goal)
+void move_group::MoveGroupMoveAction::goalCallback(MoveGoalHandle goal_handle)
+{
+  goal_handle.setAccepted("This goal has been accepted by the action server");
+  {
+    boost::mutex::scoped_lock slock(goals_lock_);
+    goal_queue_.push_back(goal_handle);
+  }
+  goals_cond_.notify_one();
+}
+
+void move_group::MoveGroupMoveAction::cancelCallback(MoveGoalHandle goal_handle)
+{
+  const std::string& goal_id = goal_handle.getGoalID().id;
+  boost::mutex::scoped_lock slock(goals_lock_);
+  for (std::deque<MoveGoalHandle>::iterator it = goal_queue_.begin(); it != goal_queue_.end(); ++it)
+    if (it->getGoalID().id == goal_id)
+    {
+      moveit_msgs::MoveGroupResult action_res;
+      action_res.error_code.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      it->setCanceled(action_res, "This goal was canceled while waiting in the queue");
+      goal_queue_.erase(it);
+      return;
+    }
+  cancel_requested_.insert(goal_id);
+  if (execution_active_ && current_execution_goal_.getGoalID().id == goal_id)
+  {
+    preempt_requested_ = true;
+    context_->plan_execution_->stop();
+  }
+}
+
+void move_group::MoveGroupMoveAction::workerThread()
+{
+  boost::unique_lock<boost::mutex> ulock(goals_lock_);
+  while (!shutdown_)
+  {
+    bool claimed = false;
+    for (std::deque<MoveGoalHandle>::iterator it = goal_queue_.begin(); it != goal_queue_.end(); ++it)
+    {
+      const std::string& group = it->getGoal()->request.group_name;
+      // goals that end up in the shared execution pipeline must not overlap; plan-only goals
+      // only need their planning group to be free
+      bool needs_execution = !it->getGoal()->planning_options.plan_only && context_->allow_trajectory_execution_;
+      if (active_groups_.find(group) != active_groups_.end() || (needs_execution && execution_active_))
+        continue;
+
+      MoveGoalHandle goal_handle = *it;
+      goal_queue_.erase(it);
+      active_groups_.insert(group);
+      if (needs_execution)
+      {
+        execution_active_ = true;
+        current_execution_goal_ = goal_handle;
+        preempt_requested_ = cancel_requested_.find(goal_handle.getGoalID().id) != cancel_requested_.end();
+      }
+      claimed = true;
+
+      ulock.unlock();
+      executeMoveCallback(goal_handle);
+      ulock.lock();
+
+      active_groups_.erase(group);
+      if (needs_execution)
+      {
+        execution_active_ = false;
+        current_execution_goal_ = MoveGoalHandle();
+        preempt_requested_ = false;
+      }
+      cancel_requested_.erase(goal_handle.getGoalID().id);
+      goals_cond_.notify_all();
+      break;
+    }
+    if (!claimed && !shutdown_)
+      goals_cond_.wait(ulock);
+  }
+}
+
+bool move_group::MoveGroupMoveAction::isCancelRequested(const MoveGoalHandle& goal_handle)
+{
+  boost::mutex::scoped_lock slock(goals_lock_);
+  return cancel_requested_.find(goal_handle.getGoalID().id) != cancel_requested_.end();
+}
+
+const robot_state::ReachabilityMap* move_group::MoveGroupMoveAction::getReachabilityMap(const std::string& group)
+{
+  boost::mutex::scoped_lock slock(reachability_maps_lock_);
+  std::map<std::string, robot_state::ReachabilityMapPtr>::const_iterator it = reachability_maps_.find(group);
+  if (it != reachability_maps_.end())
+    return it->second.get();
+  robot_state::ReachabilityMapPtr map(new robot_state::ReachabilityMap());
+  if (!map->load(reachability_map_directory_ + "/" + group + ".rmap"))
+    map.reset();  // remember the failure so the load is not retried for every goal
+  reachability_maps_[group] = map;
+  return map.get();
+}
+
+namespace
+{
+// radius of a sphere centered at the primitive pose that contains the primitive, regardless of
+// its orientation
+double primitiveBoundRadius(const shape_msgs::SolidPrimitive& primitive)
+{
+  switch (primitive.type)
+  {
+    case shape_msgs::SolidPrimitive::BOX:
+      if (primitive.dimensions.size() >= 3)
+        return 0.5 * sqrt(primitive.dimensions[0] * primitive.dimensions[0] +
+                          primitive.dimensions[1] * primitive.dimensions[1] +
+                          primitive.dimensions[2] * primitive.dimensions[2]);
+      break;
+    case shape_msgs::SolidPrimitive::SPHERE:
+      if (primitive.dimensions.size() >= 1)
+        return primitive.dimensions[0];
+      break;
+    case shape_msgs::SolidPrimitive::CYLINDER:
+    case shape_msgs::SolidPrimitive::CONE:
+      if (primitive.dimensions.size() >= 2)
+        return sqrt(0.25 * primitive.dimensions[0] * primitive.dimensions[0] +
+                    primitive.dimensions[1] * primitive.dimensions[1]);
+      break;
+  }
+  return 0.0;
+}
+}
+
+bool move_group::MoveGroupMoveAction::goalDeemedReachable(const moveit_msgs::MotionPlanRequest& request,
+                                                          moveit_msgs::MoveGroupResult& action_res)
+{
+  if (reachability_map_directory_.empty() || request.goal_constraints.empty())
+    return true;
+  const robot_state::ReachabilityMap* map = getReachabilityMap(request.group_name);
+  if (!map)
+    return true;
+
+  planning_scene_monitor::LockedPlanningSceneRO lscene(context_->planning_scene_monitor_);
+  for (std::size_t i = 0; i < request.goal_constraints.size(); ++i)
+  {
+    const moveit_msgs::Constraints& goal = request.goal_constraints[i];
+    // an orientation constraint on the mapped link narrows the query to an orientation bucket
+    const moveit_msgs::OrientationConstraint* oc = nullptr;
+    for (std::size_t j = 0; j < goal.orientation_constraints.size(); ++j)
+      if (goal.orientation_constraints[j].link_name == map->getTipLink())
+        oc = &goal.orientation_constraints[j];
+
+    bool provably_unreachable = false;
+    for (std::size_t j = 0; j < goal.position_constraints.size() && !provably_unreachable; ++j)
+    {
+      const moveit_msgs::PositionConstraint& pc = goal.position_constraints[j];
+      if (pc.link_name != map->getTipLink() || !lscene->knowsFrameTransform(pc.header.frame_id))
+        continue;
+      const Eigen::Isometry3d& frame_transform = lscene->getFrameTransform(pc.header.frame_id);
+      std::size_t np = std::min(pc.constraint_region.primitives.size(), pc.constraint_region.primitive_poses.size());
+      bool any_target_reachable = np == 0;
+      for (std::size_t p = 0; p < np && !any_target_reachable; ++p)
+      {
+        // large constraint regions cannot be judged from their center alone; skip them
+        if (primitiveBoundRadius(pc.constraint_region.primitives[p]) > map->getResolution())
+        {
+          any_target_reachable = true;
+          continue;
+        }
+        const geometry_msgs::Point& target = pc.constraint_region.primitive_poses[p].position;
+        Eigen::Vector3d position = frame_transform * Eigen::Vector3d(target.x, target.y, target.z);
+        if (oc)
+        {
+          const geometry_msgs::Quaternion& q = oc->orientation;
+          any_target_reachable = map->isPoseReachable(position, Eigen::Quaterniond(q.w, q.x, q.y, q.z));
+        }
+        else
+          any_target_reachable = map->isPositionReachable(position);
+      }
+      provably_unreachable = !any_target_reachable;
+    }
+    // a goal alternative that cannot be ruled out means the request must be planned
+    if (!provably_unreachable)
+      return true;
+  }
+
+  ROS_WARN("Rejecting goal for group '%s': all pose goals are outside the precomputed reachable "
+           "workspace of link '%s'",
+           request.group_name.c_str(), map->getTipLink().c_str());
+  action_res.error_code.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
+  return false;
+}
+
+void move_group::MoveGroupMoveAction::executeMoveCallback(MoveGoalHandle& goal_handle)
 {
-  setMoveState(PLANNING);
+  const moveit_msgs::MoveGroupGoalConstPtr& goal = goal_handle.getGoal();
+  setMoveState(PLANNING, goal_handle);
   // before we start planning, ensure that we have the latest robot state received...
   context_->planning_scene_monitor_->waitForCurrentRobotState(ros::Time::now());
   context_->planning_scene_monitor_->updateFrameTransforms();
 
   moveit_msgs::MoveGroupResult action_res;
-  if (goal->planning_options.plan_only || !context_->allow_trajectory_execution_)
+  if (!goalDeemedReachable(goal->request, action_res))
+  {
+    // the goal was rejected before planning; action_res already carries the error code
+  }
+  else if (goal->planning_options.plan_only || !context_->allow_trajectory_execution_)
   {
     if (!goal->planning_options.plan_only)
       ROS_WARN("This instance of MoveGroup is not allowed to execute trajectories but the goal request has plan_only "
                "set to false. Only a motion plan will be computed anyway.");
-    executeMoveCallback_PlanOnly(goal, action_res);
+    executeMoveCallback_PlanOnly(goal_handle, action_res);
   }
   else
     executeMoveCallback_PlanAndExecute(goal, action_res);
 
+  if (action_res.planning_time > 0.0)
+    plan_time_metric_->record(action_res.planning_time);
+
   bool planned_trajectory_empty = trajectory_processing::isTrajectoryEmpty(action_res.planned_trajectory);
   std::string response =
       getActionResultString(action_res.error_code, planned_trajectory_empty, goal->planning_options.plan_only);
   if (action_res.error_code.val == moveit_msgs::MoveItErrorCodes::SUCCESS)
-    move_action_server_->setSucceeded(action_res, response);
+    goal_handle.setSucceeded(action_res, response);
   else
   {
     if (action_res.error_code.val == moveit_msgs::MoveItErrorCodes::PREEMPTED)
-      move_action_server_->setPreempted(action_res, response);
+      goal_handle.setCanceled(action_res, response);
     else
-      move_action_server_->setAborted(action_res, response);
+      goal_handle.setAborted(action_res, response);
   }
-
-  setMoveState(IDLE);
-
-  preempt_requested_ = false;
 }
 
 void move_group::MoveGroupMoveAction::executeMoveCallback_PlanAndExecute(const moveit_msgs::MoveGroupGoalConstPtr& goal,
@@ -157,9 +370,10 @@ void move_group::MoveGroupMoveAction::executeMoveCallback_PlanAndExecute(const m
   action_res.error_code = plan.error_code_;
 }
 
-void move_group::MoveGroupMoveAction::executeMoveCallback_PlanOnly(const moveit_msgs::MoveGroupGoalConstPtr& goal,
+void move_group::MoveGroupMoveAction::executeMoveCallback_PlanOnly(MoveGoalHandle& goal_handle,
                                                                    moveit_msgs::MoveGroupResult& action_res)
 {
+  const moveit_msgs::MoveGroupGoalConstPtr& goal = goal_handle.getGoal();
   ROS_INFO("Planning request received for MoveGroup action. Forwarding to planning pipeline.");
 
   planning_scene_monitor::LockedPlanningSceneRO lscene(context_->planning_scene_monitor_);  // lock the scene so that it
@@ -172,7 +386,7 @@ void move_group::MoveGroupMoveAction::executeMoveCallback_PlanOnly(const moveit_
           lscene->diff(goal->planning_options.planning_scene_diff);
   planning_interface::MotionPlanResponse res;
 
-  if (preempt_requested_)
+  if (isCancelRequested(goal_handle))
   {
     ROS_INFO("Preempt requested before the goal is planned.");
     action_res.error_code.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
@@ -181,7 +395,11 @@ void move_group::MoveGroupMoveAction::executeMoveCallback_PlanOnly(const moveit_
 
   try
   {
-    context_->planning_pipeline_->generatePlan(the_scene, goal->request, res);
+    if (!context_->plan_cache_->fetch(the_scene, goal->request, res))
+    {
+      context_->planning_pipeline_->generatePlan(the_scene, goal->request, res);
+      context_->plan_cache_->store(the_scene, goal->request, res);
+    }
   }
   catch (std::exception& ex)
   {
@@ -197,7 +415,7 @@ void move_group::MoveGroupMoveAction::executeMoveCallback_PlanOnly(const moveit_
 bool move_group::MoveGroupMoveAction::planUsingPlanningPipeline(const planning_interface::MotionPlanRequest& req,
                                                                 plan_execution::ExecutableMotionPlan& plan)
 {
-  setMoveState(PLANNING);
+  setMoveState(PLANNING, current_execution_goal_);
 
   planning_scene_monitor::LockedPlanningSceneRO lscene(plan.planning_scene_monitor_);
   bool solved = false;
@@ -223,25 +441,19 @@ bool move_group::MoveGroupMoveAction::planUsingPlanningPipeline(const planning_i
 
 void move_group::MoveGroupMoveAction::startMoveExecutionCallback()
 {
-  setMoveState(MONITOR);
+  setMoveState(MONITOR, current_execution_goal_);
 }
 
 void move_group::MoveGroupMoveAction::startMoveLookCallback()
 {
-  setMoveState(LOOK);
-}
-
-void move_group::MoveGroupMoveAction::preemptMoveCallback()
-{
-  preempt_requested_ = true;
-  context_->plan_execution_->stop();
+  setMoveState(LOOK, current_execution_goal_);
 }
 
-void move_group::MoveGroupMoveAction::setMoveState(MoveGroupState state)
+void move_group::MoveGroupMoveAction::setMoveState(MoveGroupState state, MoveGoalHandle& goal_handle)
 {
-  move_state_ = state;
-  move_feedback_.state = stateToStr(state);
-  move_action_server_->publishFeedback(move_feedback_);
+  moveit_msgs::MoveGroupFeedback move_feedback;
+  move_feedback.state = stateToStr(state);
+  goal_handle.publishFeedback(move_feedback);
 }
 
 #include <class_loader/class_loader.hpp>
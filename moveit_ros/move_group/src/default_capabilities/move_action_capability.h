@@ -38,9 +38,16 @@
 #define MOVEIT_MOVE_GROUP_MOVE_ACTION_CAPABILITY_
 
 #include <moveit/move_group/move_group_capability.h>
-#include <actionlib/server/simple_action_server.h>
+#include <moveit/move_group/performance_metrics.h>
+#include <moveit/robot_state/reachability_map.h>
+#include <actionlib/server/action_server.h>
 #include <moveit_msgs/MoveGroupAction.h>
+#include <boost/thread.hpp>
+#include <deque>
+#include <map>
 #include <memory>
+#include <set>
+#include <string>
 
 namespace move_group
 {
@@ -48,27 +55,62 @@ class MoveGroupMoveAction : public MoveGroupCapability
 {
 public:
   MoveGroupMoveAction();
+  ~MoveGroupMoveAction();
 
   void initialize() override;
 
 private:
-  void executeMoveCallback(const moveit_msgs::MoveGroupGoalConstPtr& goal);
+  typedef actionlib::ActionServer<moveit_msgs::MoveGroupAction> MoveActionServer;
+  typedef MoveActionServer::GoalHandle MoveGoalHandle;
+
+  void goalCallback(MoveGoalHandle goal_handle);
+  void cancelCallback(MoveGoalHandle goal_handle);
+  void workerThread();
+  bool isCancelRequested(const MoveGoalHandle& goal_handle);
+
+  void executeMoveCallback(MoveGoalHandle& goal_handle);
   void executeMoveCallback_PlanAndExecute(const moveit_msgs::MoveGroupGoalConstPtr& goal,
                                           moveit_msgs::MoveGroupResult& action_res);
-  void executeMoveCallback_PlanOnly(const moveit_msgs::MoveGroupGoalConstPtr& goal,
-                                    moveit_msgs::MoveGroupResult& action_res);
+  void executeMoveCallback_PlanOnly(MoveGoalHandle& goal_handle, moveit_msgs::MoveGroupResult& action_res);
   void startMoveExecutionCallback();
   void startMoveLookCallback();
-  void preemptMoveCallback();
-  void setMoveState(MoveGroupState state);
+  void setMoveState(MoveGroupState state, MoveGoalHandle& goal_handle);
   bool planUsingPlanningPipeline(const planning_interface::MotionPlanRequest& req,
                                  plan_execution::ExecutableMotionPlan& plan);
 
-  std::unique_ptr<actionlib::SimpleActionServer<moveit_msgs::MoveGroupAction> > move_action_server_;
-  moveit_msgs::MoveGroupFeedback move_feedback_;
+  /// Check the pose goals of \e request against the reachability map of its group, if one is
+  /// configured; returns false (and sets the error code of \e action_res) when every goal
+  /// constraint is provably out of reach, so no planning time needs to be spent on the request
+  bool goalDeemedReachable(const moveit_msgs::MotionPlanRequest& request, moveit_msgs::MoveGroupResult& action_res);
+
+  /// The reachability map of \e group, loaded lazily from reachability_map_directory_; nullptr
+  /// when no map is available for the group
+  const robot_state::ReachabilityMap* getReachabilityMap(const std::string& group);
 
-  MoveGroupState move_state_;
+  std::unique_ptr<MoveActionServer> move_action_server_;
+  PerformanceMetrics::HistogramPtr plan_time_metric_;
+
+  /// queued goals picked up by the worker pool; goals of the same planning group, and all goals
+  /// that need the shared execution pipeline, are serialized while independent groups run in parallel
+  boost::mutex goals_lock_;
+  boost::condition_variable goals_cond_;
+  std::deque<MoveGoalHandle> goal_queue_;
+  std::set<std::string> active_groups_;
+  std::set<std::string> cancel_requested_;
+  bool execution_active_;
+  bool shutdown_;
+  boost::thread_group worker_threads_;
+
+  /// goal currently using the shared plan/execution pipeline (at most one at a time)
+  MoveGoalHandle current_execution_goal_;
   bool preempt_requested_;
+
+  /// directory holding per-group reachability maps ('<group>.rmap', see
+  /// robot_state::ReachabilityMap); empty when the pre-planning reachability check is disabled
+  std::string reachability_map_directory_;
+  boost::mutex reachability_maps_lock_;
+  /// maps loaded so far; a null entry records a failed load so it is not retried per goal
+  std::map<std::string, robot_state::ReachabilityMapPtr> reachability_maps_;
 };
 }
 
@@ -0,0 +1,67 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "plan_cache_service_capability.h"
+#include <moveit/move_group/plan_cache.h>
+#include <moveit/move_group/capability_names.h>
+
+move_group::MoveGroupPlanCacheService::MoveGroupPlanCacheService() : MoveGroupCapability("PlanCacheService")
+{
+}
+
+void move_group::MoveGroupPlanCacheService::initialize()
+{
+  int max_size = 100;
+  node_handle_.param("plan_cache/max_size", max_size, 100);
+  if (max_size > 0)
+    context_->plan_cache_->setMaxSize(max_size);
+  context_->plan_cache_->setEnabled(true);
+  ROS_INFO_NAMED(capability_name_, "Plan cache enabled (at most %d cached plans)", max_size);
+
+  service_ = root_node_handle_.advertiseService(CLEAR_PLAN_CACHE_SERVICE_NAME,
+                                                &MoveGroupPlanCacheService::clearPlanCache, this);
+}
+
+bool move_group::MoveGroupPlanCacheService::clearPlanCache(std_srvs::Empty::Request& req,
+                                                           std_srvs::Empty::Response& res)
+{
+  ROS_INFO_NAMED(capability_name_, "Clearing %zu cached plans (%zu hits, %zu misses so far)",
+                 context_->plan_cache_->getEntryCount(), context_->plan_cache_->getHitCount(),
+                 context_->plan_cache_->getMissCount());
+  context_->plan_cache_->clear();
+  return true;
+}
+
+#include <class_loader/class_loader.hpp>
+CLASS_LOADER_REGISTER_CLASS(move_group::MoveGroupPlanCacheService, move_group::MoveGroupCapability)
@@ -37,6 +37,7 @@
 #include "plan_service_capability.h"
 #include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit/move_group/capability_names.h>
+#include <moveit/move_group/plan_cache.h>
 
 move_group::MoveGroupPlanService::MoveGroupPlanService() : MoveGroupCapability("MotionPlanService")
 {
@@ -44,6 +45,7 @@ move_group::MoveGroupPlanService::MoveGroupPlanService() : MoveGroupCapability("
 
 void move_group::MoveGroupPlanService::initialize()
 {
+  plan_time_metric_ = context_->performance_metrics_->getHistogram("plan_time");
   plan_service_ =
       root_node_handle_.advertiseService(PLANNER_SERVICE_NAME, &MoveGroupPlanService::computePlanService, this);
 }
@@ -61,8 +63,16 @@ bool move_group::MoveGroupPlanService::computePlanService(moveit_msgs::GetMotion
   try
   {
     planning_interface::MotionPlanResponse mp_res;
+    if (context_->plan_cache_->fetch(ps, req.motion_plan_request, mp_res))
+    {
+      mp_res.getMessage(res.motion_plan_response);
+      return true;
+    }
     context_->planning_pipeline_->generatePlan(ps, req.motion_plan_request, mp_res);
+    context_->plan_cache_->store(ps, req.motion_plan_request, mp_res);
     mp_res.getMessage(res.motion_plan_response);
+    if (mp_res.planning_time_ > 0.0)
+      plan_time_metric_->record(mp_res.planning_time_);
   }
   catch (std::exception& ex)
   {
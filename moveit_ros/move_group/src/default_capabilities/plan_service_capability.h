@@ -38,6 +38,7 @@
 #define MOVEIT_MOVE_GROUP_PLAN_SERVICE_CAPABILITY_
 
 #include <moveit/move_group/move_group_capability.h>
+#include <moveit/move_group/performance_metrics.h>
 #include <moveit_msgs/GetMotionPlan.h>
 
 namespace move_group
@@ -53,6 +54,7 @@ private:
   bool computePlanService(moveit_msgs::GetMotionPlan::Request& req, moveit_msgs::GetMotionPlan::Response& res);
 
   ros::ServiceServer plan_service_;
+  PerformanceMetrics::HistogramPtr plan_time_metric_;
 };
 }
 
@@ -47,8 +47,17 @@ move_group::MoveGroupStateValidationService::MoveGroupStateValidationService()
 
 void move_group::MoveGroupStateValidationService::initialize()
 {
-  validity_service_ = root_node_handle_.advertiseService(STATE_VALIDITY_SERVICE_NAME,
-                                                         &MoveGroupStateValidationService::computeService, this);
+  int worker_threads = 4;
+  node_handle_.param("state_validation_worker_threads", worker_threads, 4);
+  if (worker_threads < 1)
+    worker_threads = 1;
+
+  ros::AdvertiseServiceOptions ops = ros::AdvertiseServiceOptions::create<moveit_msgs::GetStateValidity>(
+      STATE_VALIDITY_SERVICE_NAME, boost::bind(&MoveGroupStateValidationService::computeService, this, _1, _2),
+      ros::VoidConstPtr(), &service_queue_);
+  validity_service_ = root_node_handle_.advertiseService(ops);
+  service_spinner_.reset(new ros::AsyncSpinner(worker_threads, &service_queue_));
+  service_spinner_->start();
 }
 
 bool move_group::MoveGroupStateValidationService::computeService(moveit_msgs::GetStateValidity::Request& req,
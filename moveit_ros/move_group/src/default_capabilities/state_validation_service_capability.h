@@ -39,6 +39,8 @@
 
 #include <moveit/move_group/move_group_capability.h>
 #include <moveit_msgs/GetStateValidity.h>
+#include <ros/callback_queue.h>
+#include <memory>
 
 namespace move_group
 {
@@ -53,6 +55,11 @@ private:
   bool computeService(moveit_msgs::GetStateValidity::Request& req, moveit_msgs::GetStateValidity::Response& res);
 
   ros::ServiceServer validity_service_;
+
+  /// requests are served from a dedicated callback queue by a pool of worker threads, so bulk
+  /// validation does not serialize with the node's global callback queue
+  ros::CallbackQueue service_queue_;
+  std::unique_ptr<ros::AsyncSpinner> service_spinner_;
 };
 }
 
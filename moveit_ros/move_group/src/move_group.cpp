@@ -41,6 +41,7 @@
 #include <boost/tokenizer.hpp>
 #include <moveit/macros/console_colors.h>
 #include <moveit/move_group/node_name.h>
+#include <std_srvs/Trigger.h>
 #include <memory>
 #include <set>
 
@@ -49,19 +50,25 @@ static const std::string ROBOT_DESCRIPTION =
 
 namespace move_group
 {
-// These capabilities are loaded unless listed in disable_capabilities
+// These capabilities are loaded unless listed in disable_capabilities.
+// The essential set is what planning and executing motion requires; the optional set is
+// skipped entirely when the minimal_runtime parameter is set, keeping the plugin
+// libraries behind it out of the process on resource-constrained controllers.
 // clang-format off
-static const char* DEFAULT_CAPABILITIES[] = {
-   "move_group/MoveGroupCartesianPathService",
-   "move_group/MoveGroupKinematicsService",
+static const char* ESSENTIAL_CAPABILITIES[] = {
    "move_group/MoveGroupExecuteTrajectoryAction",
    "move_group/MoveGroupMoveAction",
-   "move_group/MoveGroupPickPlaceAction",
-   "move_group/MoveGroupPlanService",
    "move_group/MoveGroupQueryPlannersService",
-   "move_group/MoveGroupStateValidationService",
    "move_group/MoveGroupGetPlanningSceneService",
    "move_group/ApplyPlanningSceneService",
+};
+
+static const char* OPTIONAL_CAPABILITIES[] = {
+   "move_group/MoveGroupCartesianPathService",
+   "move_group/MoveGroupKinematicsService",
+   "move_group/MoveGroupPickPlaceAction",
+   "move_group/MoveGroupPlanService",
+   "move_group/MoveGroupStateValidationService",
    "move_group/ClearOctomapService",
 };
 // clang-format on
@@ -75,10 +82,25 @@ public:
     bool allow_trajectory_execution;
     node_handle_.param("allow_trajectory_execution", allow_trajectory_execution, true);
 
+    // a standby instance builds everything below and keeps ingesting scene updates, but its
+    // capabilities do not start serving until the 'activate' service is called; this lets a
+    // warm spare take over from a failed instance without paying the cold-start cost
+    node_handle_.param("standby", standby_, false);
+
     context_.reset(new MoveGroupContext(psm, allow_trajectory_execution, debug));
 
-    // start the capabilities
+    // start the capabilities (in standby mode they are loaded, but not yet initialized)
     configureCapabilities();
+
+    // pre-run kinematics and collision queries so the first user request does not pay
+    // for lazy allocations; can be disabled by setting this ROS param to false
+    bool warm_up;
+    node_handle_.param("warm_up", warm_up, true);
+    if (warm_up)
+      warmUp(psm);
+
+    if (standby_)
+      activation_service_ = node_handle_.advertiseService("activate", &MoveGroupExe::activateCallback, this);
   }
 
   ~MoveGroupExe()
@@ -94,7 +116,10 @@ public:
     {
       if (context_->status())
       {
-        if (capabilities_.empty())
+        if (standby_)
+          printf(MOVEIT_CONSOLE_COLOR_BLUE "\nmove_group is warmed up and standing by; call the '~activate' "
+                                           "service to start serving.\n\n" MOVEIT_CONSOLE_COLOR_RESET);
+        else if (capabilities_.empty())
           printf(MOVEIT_CONSOLE_COLOR_BLUE "\nmove_group is running but no capabilities are "
                                            "loaded.\n\n" MOVEIT_CONSOLE_COLOR_RESET);
         else
@@ -107,6 +132,45 @@ public:
   }
 
 private:
+  // The first queries after startup are much slower than steady state: the first IK call
+  // inside a solver plugin performs its internal allocations, the first collision check
+  // constructs the FCL geometry for every link and world object, and freshly allocated
+  // memory is faulted in on first touch. Running one representative query of each kind
+  // here moves that cost before the node reports that planning can start.
+  void warmUp(const planning_scene_monitor::PlanningSceneMonitorPtr& psm)
+  {
+    ros::WallTime start_time = ros::WallTime::now();
+
+    robot_state::RobotState state(psm->getRobotModel());
+    state.setToDefaultValues();
+    state.update();
+
+    const std::vector<const robot_model::JointModelGroup*>& groups = psm->getRobotModel()->getJointModelGroups();
+    for (std::size_t i = 0; i < groups.size(); ++i)
+    {
+      const kinematics::KinematicsBaseConstPtr solver = groups[i]->getSolverInstance();
+      if (!solver || solver->getTipFrame().empty() || !state.knowsFrameTransform(solver->getTipFrame()))
+        continue;
+      // solve for the pose the default state is already at; the answer does not matter,
+      // only that the solver runs once
+      const Eigen::Isometry3d pose = state.getFrameTransform(solver->getTipFrame());
+      robot_state::RobotState ik_state(state);
+      ik_state.setFromIK(groups[i], pose, 1, 0.1);
+    }
+
+    {
+      planning_scene_monitor::LockedPlanningSceneRO lscene(psm);
+      collision_detection::CollisionRequest creq;
+      collision_detection::CollisionResult cres;
+      lscene->checkCollision(creq, cres, state);
+      cres.clear();
+      lscene->checkSelfCollision(creq, cres, state);
+    }
+
+    ROS_INFO("Warmed up kinematics solvers and collision checking in %.3f s",
+             (ros::WallTime::now() - start_time).toSec());
+  }
+
   void configureCapabilities()
   {
     try
@@ -122,9 +186,19 @@ private:
 
     std::set<std::string> capabilities;
 
-    // add default capabilities
-    for (size_t i = 0; i < sizeof(DEFAULT_CAPABILITIES) / sizeof(DEFAULT_CAPABILITIES[0]); ++i)
-      capabilities.insert(DEFAULT_CAPABILITIES[i]);
+    // add default capabilities; with minimal_runtime set, only the essential set is
+    // loaded by default and any of the optional ones can still be requested explicitly
+    // through the 'capabilities' parameter
+    bool minimal_runtime;
+    node_handle_.param("minimal_runtime", minimal_runtime, false);
+    for (size_t i = 0; i < sizeof(ESSENTIAL_CAPABILITIES) / sizeof(ESSENTIAL_CAPABILITIES[0]); ++i)
+      capabilities.insert(ESSENTIAL_CAPABILITIES[i]);
+    if (!minimal_runtime)
+      for (size_t i = 0; i < sizeof(OPTIONAL_CAPABILITIES) / sizeof(OPTIONAL_CAPABILITIES[0]); ++i)
+        capabilities.insert(OPTIONAL_CAPABILITIES[i]);
+    else
+      ROS_INFO("Running with minimal_runtime: only essential capabilities are loaded by default; "
+               "list any further ones in the 'capabilities' parameter");
 
     // add capabilities listed in ROS parameter
     std::string capability_plugins;
@@ -152,7 +226,10 @@ private:
         printf(MOVEIT_CONSOLE_COLOR_CYAN "Loading '%s'...\n" MOVEIT_CONSOLE_COLOR_RESET, plugin->c_str());
         MoveGroupCapabilityPtr cap = capability_plugin_loader_->createUniqueInstance(*plugin);
         cap->setContext(context_);
-        cap->initialize();
+        // in standby mode the plugin library is loaded and the capability constructed, but
+        // initialize() - which advertises the action servers and services - waits for activation
+        if (!standby_)
+          cap->initialize();
         capabilities_.push_back(cap);
       }
       catch (pluginlib::PluginlibException& ex)
@@ -165,17 +242,48 @@ private:
     ss << std::endl;
     ss << std::endl;
     ss << "********************************************************" << std::endl;
-    ss << "* MoveGroup using: " << std::endl;
+    ss << "* MoveGroup " << (standby_ ? "standing by with: " : "using: ") << std::endl;
     for (std::size_t i = 0; i < capabilities_.size(); ++i)
       ss << "*     - " << capabilities_[i]->getName() << std::endl;
     ss << "********************************************************" << std::endl;
     ROS_INFO_STREAM(ss.str());
   }
 
+  bool activateCallback(std_srvs::Trigger::Request& req, std_srvs::Trigger::Response& res)
+  {
+    if (!standby_)
+    {
+      res.success = false;
+      res.message = "move_group is already active";
+      return true;
+    }
+    ros::WallTime start_time = ros::WallTime::now();
+    for (std::size_t i = 0; i < capabilities_.size(); ++i)
+      try
+      {
+        capabilities_[i]->initialize();
+      }
+      catch (std::exception& ex)
+      {
+        ROS_ERROR_STREAM("Exception while activating move_group capability '" << capabilities_[i]->getName()
+                                                                              << "': " << ex.what());
+      }
+    standby_ = false;
+    const double activation_time = (ros::WallTime::now() - start_time).toSec();
+    ROS_INFO("move_group activated from standby in %.3f s", activation_time);
+    printf(MOVEIT_CONSOLE_COLOR_GREEN "\nYou can start planning now!\n\n" MOVEIT_CONSOLE_COLOR_RESET);
+    fflush(stdout);
+    res.success = true;
+    res.message = "activated";
+    return true;
+  }
+
   ros::NodeHandle node_handle_;
   MoveGroupContextPtr context_;
   std::shared_ptr<pluginlib::ClassLoader<MoveGroupCapability> > capability_plugin_loader_;
   std::vector<MoveGroupCapabilityPtr> capabilities_;
+  bool standby_;
+  ros::ServiceServer activation_service_;
 };
 }
 
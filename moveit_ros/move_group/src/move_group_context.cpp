@@ -35,6 +35,8 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/move_group/move_group_context.h>
+#include <moveit/move_group/performance_metrics.h>
+#include <moveit/move_group/plan_cache.h>
 
 #include <moveit/planning_pipeline/planning_pipeline.h>
 #include <moveit/plan_execution/plan_execution.h>
@@ -47,6 +49,8 @@ move_group::MoveGroupContext::MoveGroupContext(
   , allow_trajectory_execution_(allow_trajectory_execution)
   , debug_(debug)
 {
+  performance_metrics_.reset(new PerformanceMetrics(ros::NodeHandle("~")));
+  plan_cache_.reset(new PlanCache());  // disabled until the plan cache capability is loaded
   planning_pipeline_.reset(new planning_pipeline::PlanningPipeline(planning_scene_monitor_->getRobotModel()));
 
   if (allow_trajectory_execution_)
@@ -0,0 +1,162 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/move_group/performance_metrics.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <sstream>
+
+namespace
+{
+const std::string METRICS_SERVICE_NAME = "get_performance_metrics";
+const double DIAGNOSTICS_PERIOD = 1.0;  // seconds between diagnostics publications while samples arrive
+
+void appendKeyValue(diagnostic_msgs::DiagnosticStatus& status, const std::string& key, double value)
+{
+  diagnostic_msgs::KeyValue kv;
+  kv.key = key;
+  std::stringstream ss;
+  ss << value;
+  kv.value = ss.str();
+  status.values.push_back(kv);
+}
+}
+
+move_group::PerformanceMetrics::Histogram::Histogram() : count_(0), sum_us_(0)
+{
+  for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    buckets_[i].store(0, std::memory_order_relaxed);
+}
+
+void move_group::PerformanceMetrics::Histogram::record(double seconds)
+{
+  const std::uint64_t us = seconds > 0.0 ? static_cast<std::uint64_t>(seconds * 1e6) : 0;
+  std::size_t bucket = 0;
+  while ((us >> (bucket + 1)) != 0 && bucket + 1 < BUCKET_COUNT)
+    ++bucket;
+  buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  sum_us_.fetch_add(us, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t move_group::PerformanceMetrics::Histogram::getCount() const
+{
+  return count_.load(std::memory_order_relaxed);
+}
+
+double move_group::PerformanceMetrics::Histogram::getMean() const
+{
+  const std::uint64_t count = count_.load(std::memory_order_relaxed);
+  return count ? sum_us_.load(std::memory_order_relaxed) / (1e6 * count) : 0.0;
+}
+
+double move_group::PerformanceMetrics::Histogram::getQuantile(double quantile) const
+{
+  const std::uint64_t count = count_.load(std::memory_order_relaxed);
+  if (count == 0)
+    return 0.0;
+  std::uint64_t rank = static_cast<std::uint64_t>(quantile * count);
+  if (rank >= count)
+    rank = count - 1;
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+  {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen > rank)
+      // report the midpoint of bucket [2^i, 2^(i+1)) microseconds
+      return 1.5 * static_cast<double>(1ull << i) / 1e6;
+  }
+  return 1.5 * static_cast<double>(1ull << (BUCKET_COUNT - 1)) / 1e6;
+}
+
+move_group::PerformanceMetrics::PerformanceMetrics(const ros::NodeHandle& node_handle)
+  : node_handle_(node_handle), last_published_samples_(0)
+{
+  diagnostics_publisher_ = node_handle_.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 2);
+  metrics_service_ = node_handle_.advertiseService(METRICS_SERVICE_NAME, &PerformanceMetrics::getMetricsService, this);
+  diagnostics_timer_ =
+      node_handle_.createTimer(ros::Duration(DIAGNOSTICS_PERIOD), &PerformanceMetrics::publishDiagnostics, this);
+}
+
+move_group::PerformanceMetrics::HistogramPtr move_group::PerformanceMetrics::getHistogram(const std::string& name)
+{
+  boost::mutex::scoped_lock slock(lock_);
+  HistogramPtr& histogram = histograms_[name];
+  if (!histogram)
+    histogram.reset(new Histogram());
+  return histogram;
+}
+
+void move_group::PerformanceMetrics::publishDiagnostics(const ros::TimerEvent& /*event*/)
+{
+  boost::mutex::scoped_lock slock(lock_);
+
+  std::uint64_t total_samples = 0;
+  for (std::map<std::string, HistogramPtr>::const_iterator it = histograms_.begin(); it != histograms_.end(); ++it)
+    total_samples += it->second->getCount();
+  // publish only when new samples arrived, so an idle move_group generates no traffic
+  if (total_samples == last_published_samples_)
+    return;
+  last_published_samples_ = total_samples;
+
+  diagnostic_msgs::DiagnosticArray msg;
+  msg.header.stamp = ros::Time::now();
+  for (std::map<std::string, HistogramPtr>::const_iterator it = histograms_.begin(); it != histograms_.end(); ++it)
+  {
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = "move_group: " + it->first;
+    status.message = "latency histogram";
+    appendKeyValue(status, "count", static_cast<double>(it->second->getCount()));
+    appendKeyValue(status, "mean_s", it->second->getMean());
+    appendKeyValue(status, "p50_s", it->second->getQuantile(0.5));
+    appendKeyValue(status, "p90_s", it->second->getQuantile(0.9));
+    appendKeyValue(status, "p99_s", it->second->getQuantile(0.99));
+    msg.status.push_back(status);
+  }
+  diagnostics_publisher_.publish(msg);
+}
+
+bool move_group::PerformanceMetrics::getMetricsService(std_srvs::Trigger::Request& /*req*/,
+                                                       std_srvs::Trigger::Response& res)
+{
+  boost::mutex::scoped_lock slock(lock_);
+  std::stringstream ss;
+  for (std::map<std::string, HistogramPtr>::const_iterator it = histograms_.begin(); it != histograms_.end(); ++it)
+    ss << it->first << ": count=" << it->second->getCount() << " mean=" << it->second->getMean()
+       << "s p50=" << it->second->getQuantile(0.5) << "s p90=" << it->second->getQuantile(0.9)
+       << "s p99=" << it->second->getQuantile(0.99) << "s" << std::endl;
+  res.success = true;
+  res.message = ss.str();
+  return true;
+}
@@ -0,0 +1,223 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/move_group/plan_cache.h>
+#include <moveit/robot_state/conversions.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+#include <ros/serialization.h>
+#include <cmath>
+#include <vector>
+
+namespace move_group
+{
+namespace
+{
+const std::size_t DEFAULT_MAX_SIZE = 100;
+// resolution at which start state values and world poses are considered equal
+const double KEY_RESOLUTION = 1e-3;
+
+std::uint64_t fnv1a(const void* data, std::size_t length, std::uint64_t hash)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i = 0; i < length; ++i)
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  return hash;
+}
+
+std::uint64_t hashQuantized(double value, std::uint64_t hash)
+{
+  std::int64_t quantized = static_cast<std::int64_t>(std::floor(value / KEY_RESOLUTION + 0.5));
+  return fnv1a(&quantized, sizeof(quantized), hash);
+}
+}
+
+PlanCache::PlanCache() : enabled_(false), max_size_(DEFAULT_MAX_SIZE), hits_(0), misses_(0)
+{
+}
+
+void PlanCache::setMaxSize(std::size_t max_size)
+{
+  boost::mutex::scoped_lock slock(lock_);
+  max_size_ = max_size;
+  while (entries_.size() > max_size_)
+  {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+}
+
+std::uint64_t PlanCache::cacheKey(const planning_scene::PlanningSceneConstPtr& scene,
+                                  const planning_interface::MotionPlanRequest& req) const
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+
+  // hash the request itself; the start state is keyed separately (below) as the resolved,
+  // quantized state, and fields that do not change the requested motion are excluded
+  planning_interface::MotionPlanRequest key_req = req;
+  key_req.start_state = moveit_msgs::RobotState();
+  key_req.allowed_planning_time = 0.0;
+  key_req.num_planning_attempts = 0;
+  std::vector<std::uint8_t> buffer(ros::serialization::serializationLength(key_req));
+  if (!buffer.empty())
+  {
+    ros::serialization::OStream stream(buffer.data(), buffer.size());
+    ros::serialization::serialize(stream, key_req);
+    hash = fnv1a(buffer.data(), buffer.size(), hash);
+  }
+
+  // quantized start state, as resolved against the scene's current state
+  robot_state::RobotState start_state = scene->getCurrentState();
+  robot_state::robotStateMsgToRobotState(scene->getTransforms(), req.start_state, start_state);
+  const double* positions = start_state.getVariablePositions();
+  for (std::size_t i = 0; i < start_state.getVariableCount(); ++i)
+    hash = hashQuantized(positions[i], hash);
+
+  // signature of the world geometry: object ids, shape counts and quantized shape poses
+  const collision_detection::WorldConstPtr& world = scene->getWorld();
+  for (collision_detection::World::const_iterator it = world->begin(); it != world->end(); ++it)
+  {
+    hash = fnv1a(it->first.data(), it->first.length(), hash);
+    const collision_detection::World::Object& obj = *it->second;
+    std::uint64_t shape_count = obj.shapes_.size();
+    hash = fnv1a(&shape_count, sizeof(shape_count), hash);
+    for (std::size_t i = 0; i < obj.shape_poses_.size(); ++i)
+    {
+      const Eigen::Isometry3d& pose = obj.shape_poses_[i];
+      for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 4; ++c)
+          hash = hashQuantized(pose(r, c), hash);
+    }
+  }
+
+  return hash;
+}
+
+bool PlanCache::fetch(const planning_scene::PlanningSceneConstPtr& scene,
+                      const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res)
+{
+  if (!enabled_)
+    return false;
+
+  ros::WallTime start_time = ros::WallTime::now();
+  std::uint64_t key = cacheKey(scene, req);
+
+  Entry entry;
+  {
+    boost::mutex::scoped_lock slock(lock_);
+    std::map<std::uint64_t, Entry>::iterator it = entries_.find(key);
+    if (it == entries_.end())
+    {
+      ++misses_;
+      return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+    entry = it->second;
+  }
+
+  // reconstruct the cached trajectory and validate it against the current scene before
+  // returning it; this uses the parallel path validation, so a hit costs one batched
+  // collision pass instead of a planner run
+  robot_state::RobotState reference_state(scene->getRobotModel());
+  robot_state::robotStateMsgToRobotState(entry.trajectory_start, reference_state);
+  robot_trajectory::RobotTrajectoryPtr trajectory(
+      new robot_trajectory::RobotTrajectory(scene->getRobotModel(), req.group_name));
+  trajectory->setRobotTrajectoryMsg(reference_state, entry.trajectory);
+
+  if (!scene->isPathValidParallel(*trajectory, req.path_constraints, req.goal_constraints, req.group_name))
+  {
+    boost::mutex::scoped_lock slock(lock_);
+    std::map<std::uint64_t, Entry>::iterator it = entries_.find(key);
+    if (it != entries_.end())
+    {
+      lru_.erase(it->second.lru_position);
+      entries_.erase(it);
+    }
+    ++misses_;
+    ROS_DEBUG_NAMED("plan_cache", "Cached plan failed validation against the current scene; replanning");
+    return false;
+  }
+
+  res.trajectory_ = trajectory;
+  res.planning_time_ = (ros::WallTime::now() - start_time).toSec();
+  res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+  {
+    boost::mutex::scoped_lock slock(lock_);
+    ++hits_;
+  }
+  ROS_DEBUG_NAMED("plan_cache", "Returning cached plan (validated in %lf s)", res.planning_time_);
+  return true;
+}
+
+void PlanCache::store(const planning_scene::PlanningSceneConstPtr& scene,
+                      const planning_interface::MotionPlanRequest& req,
+                      const planning_interface::MotionPlanResponse& res)
+{
+  if (!enabled_ || !res.trajectory_ || res.trajectory_->getWayPointCount() == 0 ||
+      res.error_code_.val != moveit_msgs::MoveItErrorCodes::SUCCESS)
+    return;
+
+  std::uint64_t key = cacheKey(scene, req);
+
+  Entry entry;
+  robot_state::robotStateToRobotStateMsg(res.trajectory_->getFirstWayPoint(), entry.trajectory_start);
+  res.trajectory_->getRobotTrajectoryMsg(entry.trajectory);
+
+  boost::mutex::scoped_lock slock(lock_);
+  std::map<std::uint64_t, Entry>::iterator it = entries_.find(key);
+  if (it != entries_.end())
+    lru_.erase(it->second.lru_position);
+  else if (entries_.size() >= max_size_ && max_size_ > 0)
+  {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  entry.lru_position = lru_.begin();
+  entries_[key] = entry;
+}
+
+void PlanCache::clear()
+{
+  boost::mutex::scoped_lock slock(lock_);
+  entries_.clear();
+  lru_.clear();
+}
+
+std::size_t PlanCache::getEntryCount() const
+{
+  boost::mutex::scoped_lock slock(lock_);
+  return entries_.size();
+}
+
+}  // namespace move_group
@@ -40,6 +40,7 @@
 #include <ros/ros.h>
 #include <tf2_ros/buffer.h>
 #include <moveit/occupancy_map_monitor/occupancy_map_updater.h>
+#include <moveit/occupancy_map_monitor/ordered_key_set.h>
 #include <moveit/mesh_filter/mesh_filter.h>
 #include <moveit/mesh_filter/stereo_camera_model.h>
 #include <moveit/lazy_free_space_updater/lazy_free_space_updater.h>
@@ -92,6 +93,9 @@ private:
   double max_update_rate_;
   unsigned int skip_vertical_pixels_;
   unsigned int skip_horizontal_pixels_;
+  /** @brief when enabled, sample each image row at roughly half an octree voxel per pixel;
+   *  the sampling step is recomputed from the depth of each pixel */
+  bool pixel_decimation_;
 
   unsigned int image_callback_count_;
   double average_callback_dt_;
@@ -105,6 +109,10 @@ private:
   double inv_fx_, inv_fy_, K0_, K2_, K4_, K5_;
   std::vector<unsigned int> filtered_labels_;
   ros::WallTime last_depth_callback_start_;
+
+  /* per-frame key columns, reused across callbacks */
+  OrderedKeySet occupied_cells_buffer_;
+  OrderedKeySet model_cells_buffer_;
 };
 }
 
@@ -65,6 +65,7 @@ DepthImageOctomapUpdater::DepthImageOctomapUpdater()
   , max_update_rate_(0)
   , skip_vertical_pixels_(4)
   , skip_horizontal_pixels_(6)
+  , pixel_decimation_(false)
   , image_callback_count_(0)
   , average_callback_dt_(0.0)
   , good_tf_(5)
@@ -101,6 +102,8 @@ bool DepthImageOctomapUpdater::setParams(XmlRpc::XmlRpcValue& params)
       readXmlParam(params, "max_update_rate", &max_update_rate_);
     readXmlParam(params, "skip_vertical_pixels", &skip_vertical_pixels_);
     readXmlParam(params, "skip_horizontal_pixels", &skip_horizontal_pixels_);
+    if (params.hasMember("pixel_decimation"))
+      pixel_decimation_ = (bool)params["pixel_decimation"];
     if (params.hasMember("filtered_cloud_topic"))
       filtered_cloud_topic_ = static_cast<const std::string&>(params["filtered_cloud_topic"]);
   }
@@ -204,6 +207,13 @@ bool host_is_big_endian(void)
   } bint = { 0x01020304 };
   return bint.c[0] == 1;
 }
+
+/* with fewer image rows than this, the fork/join overhead of the parallel
+   classification loop outweighs the gain */
+const int MIN_PARALLEL_IMAGE_ROWS = 64;
+
+/* number of image rows each tile of the parallel classification loop covers */
+const int IMAGE_TILE_ROWS = 8;
 }
 
 static const bool HOST_IS_BIG_ENDIAN = host_is_big_endian();
@@ -375,10 +385,8 @@ void DepthImageOctomapUpdater::depthImageCallback(const sensor_msgs::ImageConstP
   const octomap::point3d sensor_origin(map_H_sensor.getOrigin().getX(), map_H_sensor.getOrigin().getY(),
                                        map_H_sensor.getOrigin().getZ());
 
-  octomap::KeySet* occupied_cells_ptr = new octomap::KeySet();
-  octomap::KeySet* model_cells_ptr = new octomap::KeySet();
-  octomap::KeySet& occupied_cells = *occupied_cells_ptr;
-  octomap::KeySet& model_cells = *model_cells_ptr;
+  occupied_cells_buffer_.clear();
+  model_cells_buffer_.clear();
 
   // allocate memory if needed
   std::size_t img_size = h * w;
@@ -386,7 +394,6 @@ void DepthImageOctomapUpdater::depthImageCallback(const sensor_msgs::ImageConstP
     filtered_labels_.resize(img_size);
 
   // get the labels of the filtered data
-  const unsigned int* labels_row = &filtered_labels_[0];
   mesh_filter_->getFilteredLabels(&filtered_labels_[0]);
 
   // publish debug information if needed
@@ -457,64 +464,101 @@ void DepthImageOctomapUpdater::depthImageCallback(const sensor_msgs::ImageConstP
   {
     const int h_bound = h - skip_vertical_pixels_;
     const int w_bound = w - skip_horizontal_pixels_;
+    const int num_rows = h_bound - (int)skip_vertical_pixels_;
 
-    if (is_u_short)
+    // adjacent pixels that fall into the same octree voxel only produce duplicate keys;
+    // when decimation is enabled we advance along each row at roughly half a voxel per sample,
+    // with the step recomputed from the depth of the current pixel (near pixels are dense
+    // on the voxel grid, far ones are not)
+    const float half_voxel_pixels = pixel_decimation_ ? (float)(0.5 * tree_->getResolution() * K0_) : 0.0f;
+
+    // each tile of rows is converted into thread-local key columns which are appended to the
+    // frame-wide columns exactly once per thread
+#pragma omp parallel if (num_rows >= MIN_PARALLEL_IMAGE_ROWS)
     {
-      const uint16_t* input_row = reinterpret_cast<const uint16_t*>(&depth_msg->data[0]);
+      OrderedKeySet tile_occupied_cells;
+      OrderedKeySet tile_model_cells;
+
+      if (is_u_short)
+      {
+        const uint16_t* input = reinterpret_cast<const uint16_t*>(&depth_msg->data[0]);
 
-      for (int y = skip_vertical_pixels_; y < h_bound; ++y, labels_row += w, input_row += w)
-        for (int x = skip_horizontal_pixels_; x < w_bound; ++x)
+#pragma omp for schedule(dynamic, IMAGE_TILE_ROWS) nowait
+        for (int y = skip_vertical_pixels_; y < h_bound; ++y)
         {
-          // not filtered
-          if (labels_row[x] == mesh_filter::MeshFilterBase::Background)
+          const unsigned int* labels_row = &filtered_labels_[y * w];
+          const uint16_t* input_row = input + y * w;
+          for (int x = skip_horizontal_pixels_; x < w_bound;)
           {
             float zz = (float)input_row[x] * 1e-3;  // scale from mm to m
-            float yy = y_cache_[y] * zz;
-            float xx = x_cache_[x] * zz;
-            /* transform to map frame */
-            tf2::Vector3 point_tf = map_H_sensor * tf2::Vector3(xx, yy, zz);
-            occupied_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
-          }
-          // on far plane or a model point -> remove
-          else if (labels_row[x] >= mesh_filter::MeshFilterBase::FarClip)
-          {
-            float zz = input_row[x] * 1e-3;
-            float yy = y_cache_[y] * zz;
-            float xx = x_cache_[x] * zz;
-            /* transform to map frame */
-            tf2::Vector3 point_tf = map_H_sensor * tf2::Vector3(xx, yy, zz);
-            // add to the list of model cells
-            model_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
+            // not filtered
+            if (labels_row[x] == mesh_filter::MeshFilterBase::Background)
+            {
+              float yy = y_cache_[y] * zz;
+              float xx = x_cache_[x] * zz;
+              /* transform to map frame */
+              tf2::Vector3 point_tf = map_H_sensor * tf2::Vector3(xx, yy, zz);
+              tile_occupied_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
+            }
+            // on far plane or a model point -> remove
+            else if (labels_row[x] >= mesh_filter::MeshFilterBase::FarClip)
+            {
+              float yy = y_cache_[y] * zz;
+              float xx = x_cache_[x] * zz;
+              /* transform to map frame */
+              tf2::Vector3 point_tf = map_H_sensor * tf2::Vector3(xx, yy, zz);
+              // add to the list of model cells
+              tile_model_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
+            }
+            if (half_voxel_pixels > 0.0f && zz > 0.0f)
+              x += std::max(1, (int)(half_voxel_pixels / zz));
+            else
+              ++x;
           }
         }
-    }
-    else
-    {
-      const float* input_row = reinterpret_cast<const float*>(&depth_msg->data[0]);
+      }
+      else
+      {
+        const float* input = reinterpret_cast<const float*>(&depth_msg->data[0]);
 
-      for (int y = skip_vertical_pixels_; y < h_bound; ++y, labels_row += w, input_row += w)
-        for (int x = skip_horizontal_pixels_; x < w_bound; ++x)
+#pragma omp for schedule(dynamic, IMAGE_TILE_ROWS) nowait
+        for (int y = skip_vertical_pixels_; y < h_bound; ++y)
         {
-          if (labels_row[x] == mesh_filter::MeshFilterBase::Background)
-          {
-            float zz = input_row[x];
-            float yy = y_cache_[y] * zz;
-            float xx = x_cache_[x] * zz;
-            /* transform to map frame */
-            tf2::Vector3 point_tf = map_H_sensor * tf2::Vector3(xx, yy, zz);
-            occupied_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
-          }
-          else if (labels_row[x] >= mesh_filter::MeshFilterBase::FarClip)
+          const unsigned int* labels_row = &filtered_labels_[y * w];
+          const float* input_row = input + y * w;
+          for (int x = skip_horizontal_pixels_; x < w_bound;)
           {
             float zz = input_row[x];
-            float yy = y_cache_[y] * zz;
-            float xx = x_cache_[x] * zz;
-            /* transform to map frame */
-            tf2::Vector3 point_tf = map_H_sensor * tf2::Vector3(xx, yy, zz);
-            // add to the list of model cells
-            model_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
+            if (labels_row[x] == mesh_filter::MeshFilterBase::Background)
+            {
+              float yy = y_cache_[y] * zz;
+              float xx = x_cache_[x] * zz;
+              /* transform to map frame */
+              tf2::Vector3 point_tf = map_H_sensor * tf2::Vector3(xx, yy, zz);
+              tile_occupied_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
+            }
+            else if (labels_row[x] >= mesh_filter::MeshFilterBase::FarClip)
+            {
+              float yy = y_cache_[y] * zz;
+              float xx = x_cache_[x] * zz;
+              /* transform to map frame */
+              tf2::Vector3 point_tf = map_H_sensor * tf2::Vector3(xx, yy, zz);
+              // add to the list of model cells
+              tile_model_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
+            }
+            if (half_voxel_pixels > 0.0f && zz > 0.0f)
+              x += std::max(1, (int)(half_voxel_pixels / zz));
+            else
+              ++x;
           }
         }
+      }
+
+#pragma omp critical(merge_depth_cells)
+      {
+        occupied_cells_buffer_.insert(tile_occupied_cells);
+        model_cells_buffer_.insert(tile_model_cells);
+      }
     }
   }
   catch (...)
@@ -525,17 +569,20 @@ void DepthImageOctomapUpdater::depthImageCallback(const sensor_msgs::ImageConstP
   }
   tree_->unlockRead();
 
+  occupied_cells_buffer_.compact();
+  model_cells_buffer_.compact();
+
   /* cells that overlap with the model are not occupied */
-  for (octomap::KeySet::iterator it = model_cells.begin(), end = model_cells.end(); it != end; ++it)
-    occupied_cells.erase(*it);
+  occupied_cells_buffer_.subtract(model_cells_buffer_);
 
   // mark occupied cells
   tree_->lockWrite();
   try
   {
-    /* now mark all occupied cells */
-    for (octomap::KeySet::iterator it = occupied_cells.begin(), end = occupied_cells.end(); it != end; ++it)
-      tree_->updateNode(*it, true);
+    /* now mark all occupied cells; the compacted column is in key order, so the batch
+       insertion walks the octree with good node locality */
+    for (std::uint64_t key : occupied_cells_buffer_.keys())
+      tree_->updateNode(OrderedKeySet::unpack(key), true);
   }
   catch (...)
   {
@@ -544,7 +591,15 @@ void DepthImageOctomapUpdater::depthImageCallback(const sensor_msgs::ImageConstP
   tree_->unlockWrite();
   tree_->triggerUpdateCallback();
 
-  // at this point we still have not freed the space
+  // at this point we still have not freed the space; the lazy free space updater still
+  // consumes hashed key sets, but these are now built from the deduplicated columns, so
+  // each distinct key is hashed once instead of once per pixel that produced it
+  octomap::KeySet* occupied_cells_ptr = new octomap::KeySet();
+  octomap::KeySet* model_cells_ptr = new octomap::KeySet();
+  for (std::uint64_t key : occupied_cells_buffer_.keys())
+    occupied_cells_ptr->insert(OrderedKeySet::unpack(key));
+  for (std::uint64_t key : model_cells_buffer_.keys())
+    model_cells_ptr->insert(OrderedKeySet::unpack(key));
   free_space_updater_->pushLazyUpdate(occupied_cells_ptr, model_cells_ptr, sensor_origin);
 
   ROS_DEBUG("Processed depth image in %lf ms", (ros::WallTime::now() - start).toSec() * 1000.0);
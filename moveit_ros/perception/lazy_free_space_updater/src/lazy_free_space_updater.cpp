@@ -36,6 +36,8 @@
 
 #include <moveit/lazy_free_space_updater/lazy_free_space_updater.h>
 #include <ros/console.h>
+#include <utility>
+#include <vector>
 
 namespace occupancy_map_monitor
 {
@@ -106,13 +108,13 @@ void LazyFreeSpaceUpdater::processThread()
   const float lg_0 = tree_->getClampingThresMinLog() - tree_->getClampingThresMaxLog();
   const float lg_miss = tree_->getProbMissLog();
 
-  octomap::KeyRay key_ray1, key_ray2;
-  OcTreeKeyCountMap free_cells1, free_cells2;
+  OcTreeKeyCountMap free_cells;
+  std::vector<std::pair<octomap::OcTreeKey, unsigned int> > ray_endpoints;
 
   while (running_)
   {
-    free_cells1.clear();
-    free_cells2.clear();
+    free_cells.clear();
+    ray_endpoints.clear();
 
     boost::unique_lock<boost::mutex> ulock(cell_process_lock_);
     while (!process_occupied_cells_set_ && running_)
@@ -128,28 +130,32 @@ void LazyFreeSpaceUpdater::processThread()
     ros::WallTime start = ros::WallTime::now();
     tree_->lockRead();
 
-#pragma omp sections
-    {
-#pragma omp section
-      {
-        /* compute the free cells along each ray that ends at an occupied cell */
-        for (OcTreeKeyCountMap::iterator it = process_occupied_cells_set_->begin(),
-                                         end = process_occupied_cells_set_->end();
-             it != end; ++it)
-          if (tree_->computeRayKeys(process_sensor_origin_, tree_->keyToCoord(it->first), key_ray1))
-            for (octomap::KeyRay::iterator jt = key_ray1.begin(), end = key_ray1.end(); jt != end; ++jt)
-              free_cells1[*jt] += it->second;
-      }
+    /* gather the ray endpoints into one contiguous vector so they can be distributed across
+       threads; rays ending at an occupied cell free the cells along them once per observation
+       of the endpoint, rays ending at a model cell free them once */
+    for (OcTreeKeyCountMap::iterator it = process_occupied_cells_set_->begin(),
+                                     end = process_occupied_cells_set_->end();
+         it != end; ++it)
+      ray_endpoints.push_back(std::make_pair(it->first, it->second));
+    for (octomap::KeySet::iterator it = process_model_cells_set_->begin(), end = process_model_cells_set_->end();
+         it != end; ++it)
+      ray_endpoints.push_back(std::make_pair(*it, 1u));
+    const int num_rays = static_cast<int>(ray_endpoints.size());
 
-#pragma omp section
-      {
-        /* compute the free cells along each ray that ends at a model cell */
-        for (octomap::KeySet::iterator it = process_model_cells_set_->begin(), end = process_model_cells_set_->end();
-             it != end; ++it)
-          if (tree_->computeRayKeys(process_sensor_origin_, tree_->keyToCoord(*it), key_ray2))
-            for (octomap::KeyRay::iterator jt = key_ray2.begin(), end = key_ray2.end(); jt != end; ++jt)
-              free_cells2[*jt]++;
-      }
+    /* the rays only read the (read-locked) octree, so they are cast in parallel; each thread
+       accumulates miss counts in its own map and the maps are merged afterwards */
+#pragma omp parallel
+    {
+      octomap::KeyRay key_ray;
+      OcTreeKeyCountMap thread_free_cells;
+#pragma omp for nowait
+      for (int i = 0; i < num_rays; ++i)
+        if (tree_->computeRayKeys(process_sensor_origin_, tree_->keyToCoord(ray_endpoints[i].first), key_ray))
+          for (octomap::KeyRay::iterator jt = key_ray.begin(), end = key_ray.end(); jt != end; ++jt)
+            thread_free_cells[*jt] += ray_endpoints[i].second;
+#pragma omp critical(merge_free_cells)
+      for (OcTreeKeyCountMap::iterator it = thread_free_cells.begin(), end = thread_free_cells.end(); it != end; ++it)
+        free_cells[it->first] += it->second;
     }
 
     tree_->unlockRead();
@@ -157,18 +163,12 @@ void LazyFreeSpaceUpdater::processThread()
     for (OcTreeKeyCountMap::iterator it = process_occupied_cells_set_->begin(),
                                      end = process_occupied_cells_set_->end();
          it != end; ++it)
-    {
-      free_cells1.erase(it->first);
-      free_cells2.erase(it->first);
-    }
+      free_cells.erase(it->first);
 
     for (octomap::KeySet::iterator it = process_model_cells_set_->begin(), end = process_model_cells_set_->end();
          it != end; ++it)
-    {
-      free_cells1.erase(*it);
-      free_cells2.erase(*it);
-    }
-    ROS_DEBUG("Marking %lu cells as free...", (long unsigned int)(free_cells1.size() + free_cells2.size()));
+      free_cells.erase(*it);
+    ROS_DEBUG("Marking %lu cells as free...", (long unsigned int)free_cells.size());
 
     tree_->lockWrite();
 
@@ -180,9 +180,7 @@ void LazyFreeSpaceUpdater::processThread()
         tree_->updateNode(*it, lg_0);
 
       /* mark free cells only if not seen occupied in this cloud */
-      for (OcTreeKeyCountMap::iterator it = free_cells1.begin(), end = free_cells1.end(); it != end; ++it)
-        tree_->updateNode(it->first, it->second * lg_miss);
-      for (OcTreeKeyCountMap::iterator it = free_cells2.begin(), end = free_cells2.end(); it != end; ++it)
+      for (OcTreeKeyCountMap::iterator it = free_cells.begin(), end = free_cells.end(); it != end; ++it)
         tree_->updateNode(it->first, it->second * lg_miss);
     }
     catch (...)
@@ -104,6 +104,20 @@ public:
    */
   void getDepthBuffer(float* buffer) const;
 
+  /**
+   * \brief starts an asynchronous readback of the color buffer into a pixel pack buffer.
+   *        A subsequent getColorBuffer call waits on a fence for the transfer to complete instead
+   *        of stalling the pipeline. No-op if pixel buffer objects or fences are not supported.
+   */
+  void queueColorReadback();
+
+  /**
+   * \brief starts an asynchronous readback of the depth buffer into a pixel pack buffer.
+   *        A subsequent getDepthBuffer call waits on a fence for the transfer to complete instead
+   *        of stalling the pipeline. No-op if pixel buffer objects or fences are not supported.
+   */
+  void queueDepthReadback();
+
   /**
    * \brief loads, compiles, links and adds GLSL shaders from files to the current OpenGL context.
    * \author Suat Gedikli (gedikli@willowgarage.com)
@@ -273,6 +287,18 @@ private:
   /** \brief handle to depth buffer*/
   GLuint depth_id_;
 
+  /** \brief pixel pack buffer for asynchronous readback of the color buffer. 0 if unsupported*/
+  GLuint color_pbo_id_;
+
+  /** \brief pixel pack buffer for asynchronous readback of the depth buffer. 0 if unsupported*/
+  GLuint depth_pbo_id_;
+
+  /** \brief fence signaled once a queued color readback has finished*/
+  mutable GLsync color_readback_fence_;
+
+  /** \brief fence signaled once a queued depth readback has finished*/
+  mutable GLsync depth_readback_fence_;
+
   /** \brief handle to program that is currently used*/
   GLuint program_;
 
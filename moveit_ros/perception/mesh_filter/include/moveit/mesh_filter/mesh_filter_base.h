@@ -278,6 +278,21 @@ protected:
   /** \brief handle depth texture from sensor data*/
   GLuint sensor_depth_texture_;
 
+  /** \brief double-buffered pixel unpack buffers for streaming the sensor depth to the GPU*/
+  GLuint sensor_upload_pbo_[2];
+
+  /** \brief persistently mapped pointers into the upload buffers. NULL if persistent mapping is unsupported*/
+  void* sensor_upload_map_[2];
+
+  /** \brief fences preventing an upload buffer from being overwritten while its transfer is still in flight*/
+  mutable GLsync sensor_upload_fence_[2];
+
+  /** \brief index of the upload buffer to be used for the next frame*/
+  mutable unsigned int sensor_upload_index_;
+
+  /** \brief size of each upload buffer in bytes*/
+  std::size_t sensor_upload_size_;
+
   /** \brief handle to GLSL location of shadow threshold*/
   GLuint shadow_threshold_location_;
 
@@ -47,12 +47,19 @@
 #include <fstream>
 #include <stdexcept>
 #include <vector>
+#include <cstring>
 #include <iostream>
 #include <boost/thread.hpp>
 #include <ros/console.h>
 
 using namespace std;
 
+namespace
+{
+// maximum time to wait for a queued readback before falling back to a synchronous download
+const GLuint64 READBACK_TIMEOUT_NS = 1000000000;
+}
+
 mesh_filter::GLRenderer::GLRenderer(unsigned width, unsigned height, float near, float far)
   : width_(width)
   , height_(height)
@@ -60,6 +67,10 @@ mesh_filter::GLRenderer::GLRenderer(unsigned width, unsigned height, float near,
   , rbo_id_(0)
   , rgb_id_(0)
   , depth_id_(0)
+  , color_pbo_id_(0)
+  , depth_pbo_id_(0)
+  , color_readback_fence_(0)
+  , depth_readback_fence_(0)
   , program_(0)
   , near_(near)
   , far_(far)
@@ -166,10 +177,33 @@ void mesh_filter::GLRenderer::initFrameBuffers()
     throw runtime_error("Couldn't create frame buffer");
 
   glBindFramebuffer(GL_FRAMEBUFFER, 0);  // Unbind our frame buffer
+
+  // pack buffers for asynchronous readback of the color and depth buffers
+  if (GLEW_ARB_pixel_buffer_object && GLEW_ARB_sync)
+  {
+    glGenBuffers(1, &color_pbo_id_);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, color_pbo_id_);
+    glBufferData(GL_PIXEL_PACK_BUFFER, width_ * height_ * 4 * sizeof(unsigned char), NULL, GL_STREAM_READ);
+
+    glGenBuffers(1, &depth_pbo_id_);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_pbo_id_);
+    glBufferData(GL_PIXEL_PACK_BUFFER, width_ * height_ * sizeof(float), NULL, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+  else
+    ROS_DEBUG("pixel buffer objects or fences not available. Falling back to synchronous buffer readback.");
 }
 
 void mesh_filter::GLRenderer::deleteFrameBuffers()
 {
+  if (color_readback_fence_)
+    glDeleteSync(color_readback_fence_);
+  if (depth_readback_fence_)
+    glDeleteSync(depth_readback_fence_);
+  if (color_pbo_id_)
+    glDeleteBuffers(1, &color_pbo_id_);
+  if (depth_pbo_id_)
+    glDeleteBuffers(1, &depth_pbo_id_);
   if (rbo_id_)
     glDeleteRenderbuffers(1, &rbo_id_);
   if (fbo_id_)
@@ -179,7 +213,8 @@ void mesh_filter::GLRenderer::deleteFrameBuffers()
   if (rgb_id_)
     glDeleteTextures(1, &rgb_id_);
 
-  rbo_id_ = fbo_id_ = depth_id_ = rgb_id_ = 0;
+  color_readback_fence_ = depth_readback_fence_ = 0;
+  color_pbo_id_ = depth_pbo_id_ = rbo_id_ = fbo_id_ = depth_id_ = rgb_id_ = 0;
 }
 
 void mesh_filter::GLRenderer::begin() const
@@ -206,8 +241,60 @@ void mesh_filter::GLRenderer::end() const
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void mesh_filter::GLRenderer::queueColorReadback()
+{
+  if (!color_pbo_id_)
+    return;
+
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
+  glBindTexture(GL_TEXTURE_2D, rgb_id_);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, color_pbo_id_);
+  // with a pack buffer bound the download runs asynchronously; the fence tells us when it is done
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+  if (color_readback_fence_)
+    glDeleteSync(color_readback_fence_);
+  color_readback_fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void mesh_filter::GLRenderer::queueDepthReadback()
+{
+  if (!depth_pbo_id_)
+    return;
+
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
+  glBindTexture(GL_TEXTURE_2D, depth_id_);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_pbo_id_);
+  // with a pack buffer bound the download runs asynchronously; the fence tells us when it is done
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+  if (depth_readback_fence_)
+    glDeleteSync(depth_readback_fence_);
+  depth_readback_fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 void mesh_filter::GLRenderer::getColorBuffer(unsigned char* buffer) const
 {
+  if (color_readback_fence_)
+  {
+    glClientWaitSync(color_readback_fence_, GL_SYNC_FLUSH_COMMANDS_BIT, READBACK_TIMEOUT_NS);
+    glDeleteSync(color_readback_fence_);
+    color_readback_fence_ = 0;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, color_pbo_id_);
+    const void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (data)
+    {
+      memcpy(buffer, data, width_ * height_ * 4 * sizeof(unsigned char));
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      return;
+    }
+    // mapping failed; fall back to the synchronous path
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+
   glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
   glBindTexture(GL_TEXTURE_2D, rgb_id_);
   glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
@@ -216,6 +303,24 @@ void mesh_filter::GLRenderer::getColorBuffer(unsigned char* buffer) const
 
 void mesh_filter::GLRenderer::getDepthBuffer(float* buffer) const
 {
+  if (depth_readback_fence_)
+  {
+    glClientWaitSync(depth_readback_fence_, GL_SYNC_FLUSH_COMMANDS_BIT, READBACK_TIMEOUT_NS);
+    glDeleteSync(depth_readback_fence_);
+    depth_readback_fence_ = 0;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_pbo_id_);
+    const void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (data)
+    {
+      memcpy(buffer, data, width_ * height_ * sizeof(float));
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      return;
+    }
+    // mapping failed; fall back to the synchronous path
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+
   glBindFramebuffer(GL_FRAMEBUFFER, fbo_id_);
   glBindTexture(GL_TEXTURE_2D, depth_id_);
   glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, buffer);
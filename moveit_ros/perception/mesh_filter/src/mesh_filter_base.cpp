@@ -43,6 +43,7 @@
 #include <Eigen/Eigen>
 #include <stdexcept>
 #include <sstream>
+#include <cstring>
 #include <sensor_msgs/image_encodings.h>
 
 #include <ros/console.h>
@@ -62,11 +63,19 @@ mesh_filter::MeshFilterBase::MeshFilterBase(const TransformCallback& transform_c
   , next_handle_(FirstLabel)  // 0 and 1 are reserved!
   , min_handle_(FirstLabel)
   , stop_(false)
+  , sensor_upload_index_(0)
+  , sensor_upload_size_(0)
   , transform_callback_(transform_callback)
   , padding_scale_(1.0)
   , padding_offset_(0.01)
   , shadow_threshold_(0.5)
 {
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    sensor_upload_pbo_[i] = 0;
+    sensor_upload_map_[i] = NULL;
+    sensor_upload_fence_[i] = 0;
+  }
   filter_thread_ = boost::thread(boost::bind(&MeshFilterBase::run, this, render_vertex_shader, render_fragment_shader,
                                              filter_vertex_shader, filter_fragment_shader));
 }
@@ -90,6 +99,33 @@ void mesh_filter::MeshFilterBase::initialize(const std::string& render_vertex_sh
 
   glGenTextures(1, &sensor_depth_texture_);
 
+  // persistently mapped upload buffers let the CPU write the next sensor frame while the GPU is
+  // still transferring the previous one, instead of stalling in glTexImage2D each frame
+  sensor_upload_size_ = sensor_parameters_->getWidth() * sensor_parameters_->getHeight() * sizeof(float);
+  if (GLEW_ARB_buffer_storage && GLEW_ARB_sync)
+  {
+    glGenBuffers(2, sensor_upload_pbo_);
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sensor_upload_pbo_[i]);
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER, sensor_upload_size_, NULL,
+                      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+      sensor_upload_map_[i] = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, sensor_upload_size_,
+                                               GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (!sensor_upload_map_[0] || !sensor_upload_map_[1])
+    {
+      ROS_WARN("unable to persistently map sensor upload buffers. Falling back to synchronous upload.");
+      glDeleteBuffers(2, sensor_upload_pbo_);
+      sensor_upload_pbo_[0] = sensor_upload_pbo_[1] = 0;
+      sensor_upload_map_[0] = sensor_upload_map_[1] = NULL;
+    }
+  }
+  else
+    ROS_DEBUG("GL_ARB_buffer_storage not available. Falling back to synchronous sensor upload.");
+
   glUniform1i(glGetUniformLocation(depth_filter_->getProgramID(), "sensor"), 0);
   glUniform1i(glGetUniformLocation(depth_filter_->getProgramID(), "depth"), 2);
   glUniform1i(glGetUniformLocation(depth_filter_->getProgramID(), "label"), 4);
@@ -148,6 +184,27 @@ void mesh_filter::MeshFilterBase::deInitialize()
   glDeleteLists(canvas_, 1);
   glDeleteTextures(1, &sensor_depth_texture_);
 
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    if (sensor_upload_fence_[i])
+    {
+      glDeleteSync(sensor_upload_fence_[i]);
+      sensor_upload_fence_[i] = 0;
+    }
+    if (sensor_upload_map_[i])
+    {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sensor_upload_pbo_[i]);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      sensor_upload_map_[i] = NULL;
+    }
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  if (sensor_upload_pbo_[0])
+  {
+    glDeleteBuffers(2, sensor_upload_pbo_);
+    sensor_upload_pbo_[0] = sensor_upload_pbo_[1] = 0;
+  }
+
   meshes_.clear();
   mesh_renderer_.reset();
   depth_filter_.reset();
@@ -367,8 +424,31 @@ void mesh_filter::MeshFilterBase::doFilter(const void* sensor_data, const int en
     glPixelTransferf(GL_DEPTH_SCALE, scale);
   glPixelTransferf(GL_DEPTH_BIAS, -scale * sensor_parameters_->getNearClippingPlaneDistance());
 
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, sensor_parameters_->getWidth(), sensor_parameters_->getHeight(), 0,
-               GL_DEPTH_COMPONENT, encoding, sensor_data);
+  const std::size_t pixel_size = (encoding == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(float);
+  const std::size_t data_size = sensor_parameters_->getWidth() * sensor_parameters_->getHeight() * pixel_size;
+  if (sensor_upload_map_[0] && data_size <= sensor_upload_size_)
+  {
+    const unsigned int buffer = sensor_upload_index_;
+    // don't overwrite a buffer whose transfer from two frames ago is still in flight
+    if (sensor_upload_fence_[buffer])
+    {
+      glClientWaitSync(sensor_upload_fence_[buffer], GL_SYNC_FLUSH_COMMANDS_BIT, GLuint64(1000000000));
+      glDeleteSync(sensor_upload_fence_[buffer]);
+      sensor_upload_fence_[buffer] = 0;
+    }
+    memcpy(sensor_upload_map_[buffer], sensor_data, data_size);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sensor_upload_pbo_[buffer]);
+    // with an unpack buffer bound the transfer runs asynchronously from buffer memory;
+    // the depth scale/bias pixel transfer set above still applies
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, sensor_parameters_->getWidth(),
+                 sensor_parameters_->getHeight(), 0, GL_DEPTH_COMPONENT, encoding, 0);
+    sensor_upload_fence_[buffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    sensor_upload_index_ = 1 - sensor_upload_index_;
+  }
+  else
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, sensor_parameters_->getWidth(), sensor_parameters_->getHeight(),
+                 0, GL_DEPTH_COMPONENT, encoding, sensor_data);
   glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -383,6 +463,11 @@ void mesh_filter::MeshFilterBase::doFilter(const void* sensor_data, const int en
   glBindTexture(GL_TEXTURE_2D, color_texture);
   glCallList(canvas_);
   depth_filter_->end();
+
+  // start downloading the filter results right away; getFilteredDepth() and getFilteredLabels()
+  // then only wait for the transfer to finish instead of stalling the pipeline
+  depth_filter_->queueDepthReadback();
+  depth_filter_->queueColorReadback();
 }
 
 void mesh_filter::MeshFilterBase::setPaddingOffset(float offset)
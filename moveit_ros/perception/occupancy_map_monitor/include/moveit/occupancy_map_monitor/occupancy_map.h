@@ -57,6 +57,12 @@ public:
   {
   }
 
+  /** @brief Deep copy of the octree data. The lock and the update callback are not copied;
+   *  this is used to take read-only snapshots of the tree. */
+  OccMapTree(const OccMapTree& rhs) : octomap::OcTree(rhs)
+  {
+  }
+
   /** @brief lock the underlying octree. it will not be read or written by the
    *  monitor until unlockTree() is called */
   void lockRead()
@@ -47,9 +47,11 @@
 #include <moveit_msgs/LoadMap.h>
 #include <moveit/occupancy_map_monitor/occupancy_map.h>
 #include <moveit/occupancy_map_monitor/occupancy_map_updater.h>
+#include <moveit/occupancy_map_monitor/ordered_key_set.h>
 
 #include <boost/thread/mutex.hpp>
 
+#include <algorithm>
 #include <memory>
 
 namespace occupancy_map_monitor
@@ -57,6 +59,9 @@ namespace occupancy_map_monitor
 class OccupancyMapMonitor
 {
 public:
+  /** @brief Number of downsampled octrees maintained on top of the fine tree */
+  static const unsigned int PYRAMID_LEVELS = 2;
+
   OccupancyMapMonitor(const std::shared_ptr<tf2_ros::Buffer>& tf_buffer, const std::string& map_frame = "",
                       double map_resolution = 0.0);
   OccupancyMapMonitor(double map_resolution = 0.0);
@@ -84,6 +89,21 @@ public:
     return tree_const_;
   }
 
+  /** @brief Get the octree at \e level of the resolution pyramid. Level 0 is the fine tree the
+   *  sensors update; level \e n halves its resolution \e n times (2x, 4x cell size). The coarse
+   *  trees are refreshed from the fine tree's change set after every batch of updates, and a
+   *  coarse cell stores the maximum occupancy over the fine cells it covers, so coarse-level
+   *  queries are conservative. Lock the returned tree before reading. */
+  const OccMapTreeConstPtr& getOcTreePtr(unsigned int level) const
+  {
+    return level == 0 ? tree_const_ : pyramid_tree_const_[std::min(level, PYRAMID_LEVELS) - 1];
+  }
+
+  /** @brief Get a read-only snapshot of the octree, taken after the most recent batch of updates.
+   *  The snapshot is never written to again, so it can be read without locking while the updaters
+   *  keep writing to the live tree. Returns a NULL pointer before the first update. */
+  OccMapTreeConstPtr getOcTreeSnapshotPtr() const;
+
   const std::string& getMapFrame() const
   {
     return map_frame_;
@@ -109,10 +129,11 @@ public:
   /** \brief Forget about this shape handle and the shapes it corresponds to */
   void forgetShape(ShapeHandle handle);
 
-  /** @brief Set the callback to trigger when updates to the maintained octomap are received */
+  /** @brief Set the callback to trigger when updates to the maintained octomap are received.
+   *  The callback runs after the read-only snapshot has been refreshed. */
   void setUpdateCallback(const boost::function<void()>& update_callback)
   {
-    tree_->setUpdateCallback(update_callback);
+    update_callback_ = update_callback;
   }
 
   void setTransformCacheCallback(const TransformCacheProvider& transform_cache_callback);
@@ -136,6 +157,17 @@ private:
   bool getShapeTransformCache(std::size_t index, const std::string& target_frame, const ros::Time& target_time,
                               ShapeTransformCache& cache) const;
 
+  /** @brief Called by the tree whenever a batch of updates completed; folds the change set into
+   *  the resolution pyramid, refreshes the read-only snapshot and then triggers the user callback */
+  void treeUpdated();
+
+  /** @brief Apply the fine tree's accumulated change set to the downsampled trees */
+  void updatePyramid();
+
+  /** @brief Rebuild the downsampled trees from scratch (used when the fine tree is replaced
+   *  wholesale, e.g. when a map is loaded from disk) */
+  void rebuildPyramid();
+
   std::shared_ptr<tf2_ros::Buffer> tf_buffer_;
   std::string map_frame_;
   double map_resolution_;
@@ -144,6 +176,23 @@ private:
   OccMapTreePtr tree_;
   OccMapTreeConstPtr tree_const_;
 
+  /** @brief downsampled trees (index 0 = half resolution); written only by the monitor while
+   *  pyramid_lock_ is held, read by consumers under the trees' own locks */
+  OccMapTreePtr pyramid_tree_[PYRAMID_LEVELS];
+  OccMapTreeConstPtr pyramid_tree_const_[PYRAMID_LEVELS];
+
+  /** @brief serializes pyramid maintenance; updaters may report completed batches concurrently */
+  boost::mutex pyramid_lock_;
+
+  /** @brief scratch key sets reused across pyramid updates */
+  OrderedKeySet changed_cells_;
+  OrderedKeySet coarse_cells_;
+
+  /** @brief read-only copy of the tree, swapped in after every batch of updates */
+  OccMapTreeConstPtr tree_snapshot_;
+  mutable boost::mutex snapshot_lock_;
+  boost::function<void()> update_callback_;
+
   std::unique_ptr<pluginlib::ClassLoader<OccupancyMapUpdater> > updater_plugin_loader_;
   std::vector<OccupancyMapUpdaterPtr> map_updaters_;
   std::vector<std::map<ShapeHandle, ShapeHandle> > mesh_handles_;
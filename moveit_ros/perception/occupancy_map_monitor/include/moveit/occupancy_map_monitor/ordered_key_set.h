@@ -0,0 +1,187 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_OCCUPANCY_MAP_MONITOR_ORDERED_KEY_SET_
+#define MOVEIT_OCCUPANCY_MAP_MONITOR_ORDERED_KEY_SET_
+
+#include <octomap/octomap.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace occupancy_map_monitor
+{
+/** \brief A set of octree keys stored as a flat column of packed 48-bit integers.
+ *
+ * The octomap updaters collect hundreds of thousands of keys per sensor frame. Building these
+ * sets with octomap::KeySet hashes every key individually and scatters the entries across
+ * buckets; with an OrderedKeySet, insertion is an append into contiguous storage and a single
+ * compact() call sorts (radix, three 16-bit digit passes) and deduplicates the column.
+ * Iterating the compacted set visits the keys in Morton-like order, so batch updates walk the
+ * octree with much better node locality than hash order does. The buffers are retained across
+ * clear() calls, so a set reused from frame to frame allocates only while growing. */
+class OrderedKeySet
+{
+public:
+  OrderedKeySet() : compacted_(true)
+  {
+  }
+
+  /** \brief Remove all keys; the underlying buffers keep their capacity */
+  void clear()
+  {
+    keys_.clear();
+    compacted_ = true;
+  }
+
+  bool empty() const
+  {
+    return keys_.empty();
+  }
+
+  std::size_t size() const
+  {
+    return keys_.size();
+  }
+
+  /** \brief Pack the three 16-bit coordinates of a key into one integer, z-major */
+  static std::uint64_t pack(const octomap::OcTreeKey& key)
+  {
+    return static_cast<std::uint64_t>(key[0]) | (static_cast<std::uint64_t>(key[1]) << 16) |
+           (static_cast<std::uint64_t>(key[2]) << 32);
+  }
+
+  static octomap::OcTreeKey unpack(std::uint64_t packed)
+  {
+    return octomap::OcTreeKey(static_cast<unsigned short>(packed & 0xFFFF),
+                              static_cast<unsigned short>((packed >> 16) & 0xFFFF),
+                              static_cast<unsigned short>((packed >> 32) & 0xFFFF));
+  }
+
+  void insert(const octomap::OcTreeKey& key)
+  {
+    keys_.push_back(pack(key));
+    compacted_ = false;
+  }
+
+  template <typename Iterator>
+  void insert(Iterator first, Iterator last)
+  {
+    for (; first != last; ++first)
+      keys_.push_back(pack(*first));
+    compacted_ = false;
+  }
+
+  /** \brief Append the raw (possibly uncompacted) contents of another set */
+  void insert(const OrderedKeySet& other)
+  {
+    keys_.insert(keys_.end(), other.keys_.begin(), other.keys_.end());
+    compacted_ = false;
+  }
+
+  /** \brief Sort the column and remove duplicate keys. Must be called before keys() is
+   * iterated or subtract() is used. Calling it on an already compacted set is free. */
+  void compact()
+  {
+    if (compacted_)
+      return;
+    // a counting pass per digit only pays off once the column outgrows the digit histogram
+    if (keys_.size() < 4096)
+      std::sort(keys_.begin(), keys_.end());
+    else
+      radixSort();
+    keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+    compacted_ = true;
+  }
+
+  /** \brief Remove every key that is also contained in \e other.
+   * Both sets must be compacted. */
+  void subtract(const OrderedKeySet& other)
+  {
+    if (keys_.empty() || other.keys_.empty())
+      return;
+    std::size_t out = 0, j = 0;
+    for (std::size_t i = 0; i < keys_.size(); ++i)
+    {
+      while (j < other.keys_.size() && other.keys_[j] < keys_[i])
+        ++j;
+      if (j < other.keys_.size() && other.keys_[j] == keys_[i])
+        continue;
+      keys_[out++] = keys_[i];
+    }
+    keys_.resize(out);
+  }
+
+  /** \brief The packed keys, sorted and unique after compact() */
+  const std::vector<std::uint64_t>& keys() const
+  {
+    return keys_;
+  }
+
+private:
+  void radixSort()
+  {
+    scratch_.resize(keys_.size());
+    counts_.resize(1 << 16);
+    std::vector<std::uint64_t>* src = &keys_;
+    std::vector<std::uint64_t>* dst = &scratch_;
+    for (unsigned int shift = 0; shift < 48; shift += 16)
+    {
+      std::fill(counts_.begin(), counts_.end(), 0);
+      for (std::size_t i = 0; i < src->size(); ++i)
+        ++counts_[((*src)[i] >> shift) & 0xFFFF];
+      std::size_t sum = 0;
+      for (std::size_t d = 0; d < counts_.size(); ++d)
+      {
+        std::size_t c = counts_[d];
+        counts_[d] = sum;
+        sum += c;
+      }
+      for (std::size_t i = 0; i < src->size(); ++i)
+        (*dst)[counts_[((*src)[i] >> shift) & 0xFFFF]++] = (*src)[i];
+      std::swap(src, dst);
+    }
+    // three passes leave the sorted data in the scratch buffer
+    keys_.swap(scratch_);
+  }
+
+  std::vector<std::uint64_t> keys_;
+  std::vector<std::uint64_t> scratch_;
+  std::vector<std::size_t> counts_;
+  bool compacted_;
+};
+}
+
+#endif
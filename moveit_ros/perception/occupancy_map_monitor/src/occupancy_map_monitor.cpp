@@ -43,6 +43,8 @@
 
 namespace occupancy_map_monitor
 {
+const unsigned int OccupancyMapMonitor::PYRAMID_LEVELS;
+
 OccupancyMapMonitor::OccupancyMapMonitor(double map_resolution)
   : map_resolution_(map_resolution), debug_info_(false), mesh_handle_count_(0), nh_("~"), active_(false)
 {
@@ -94,6 +96,15 @@ void OccupancyMapMonitor::initialize()
 
   tree_.reset(new OccMapTree(map_resolution_));
   tree_const_ = tree_;
+  tree_->setUpdateCallback(boost::bind(&OccupancyMapMonitor::treeUpdated, this));
+
+  /* the resolution pyramid is maintained incrementally from the change set of the fine tree */
+  tree_->enableChangeDetection(true);
+  for (unsigned int i = 0; i < PYRAMID_LEVELS; ++i)
+  {
+    pyramid_tree_[i].reset(new OccMapTree(map_resolution_ * (1 << (i + 1))));
+    pyramid_tree_const_[i] = pyramid_tree_[i];
+  }
 
   XmlRpc::XmlRpcValue sensor_list;
   if (nh_.getParam("sensors", sensor_list))
@@ -214,6 +225,124 @@ void OccupancyMapMonitor::publishDebugInformation(bool flag)
     map_updaters_[i]->publishDebugInformation(debug_info_);
 }
 
+OccMapTreeConstPtr OccupancyMapMonitor::getOcTreeSnapshotPtr() const
+{
+  boost::mutex::scoped_lock _(snapshot_lock_);
+  return tree_snapshot_;
+}
+
+void OccupancyMapMonitor::updatePyramid()
+{
+  boost::mutex::scoped_lock _(pyramid_lock_);
+
+  /* the read lock keeps the updaters (which need the write lock) out, so the change set cannot
+     grow behind our back between reading it and resetting it */
+  tree_->lockRead();
+  changed_cells_.clear();
+  for (octomap::KeyBoolMap::const_iterator it = tree_->changedKeysBegin(), end = tree_->changedKeysEnd(); it != end;
+       ++it)
+    changed_cells_.insert(it->first);
+  changed_cells_.compact();
+
+  const unsigned int fine_depth = tree_->getTreeDepth();
+  for (unsigned int level = 1; level <= PYRAMID_LEVELS; ++level)
+  {
+    const unsigned int depth = fine_depth - level;
+
+    /* many changed fine cells fall into the same coarse cell; deduplicate before querying */
+    coarse_cells_.clear();
+    for (std::uint64_t packed : changed_cells_.keys())
+      coarse_cells_.insert(tree_->adjustKeyAtDepth(OrderedKeySet::unpack(packed), depth));
+    coarse_cells_.compact();
+
+    const OccMapTreePtr& coarse = pyramid_tree_[level - 1];
+    coarse->lockWrite();
+    for (std::uint64_t packed : coarse_cells_.keys())
+    {
+      const octomap::OcTreeKey key = OrderedKeySet::unpack(packed);
+      const octomap::point3d center = tree_->keyToCoord(key, depth);
+      /* the inner node of the fine tree at this depth aggregates the maximum occupancy of its
+         children, which is exactly the conservative value the coarse cell should hold */
+      const OccMapNode* node = tree_->search(key, depth);
+      if (node)
+        coarse->setNodeValue(center, node->getLogOdds());
+      else
+        coarse->deleteNode(center);
+    }
+    coarse->unlockWrite();
+  }
+
+  tree_->resetChangeDetection();
+  tree_->unlockRead();
+}
+
+void OccupancyMapMonitor::rebuildPyramid()
+{
+  boost::mutex::scoped_lock _(pyramid_lock_);
+
+  tree_->lockRead();
+  const unsigned int fine_depth = tree_->getTreeDepth();
+  for (unsigned int level = 1; level <= PYRAMID_LEVELS; ++level)
+  {
+    const unsigned int depth = fine_depth - level;
+    const unsigned int step = 1u << level;
+    const OccMapTreePtr& coarse = pyramid_tree_[level - 1];
+    coarse->lockWrite();
+    coarse->clear();
+    for (OccMapTree::leaf_iterator it = tree_->begin_leafs(), end = tree_->end_leafs(); it != end; ++it)
+    {
+      /* a leaf shallower than the pyramid depth covers several coarse cells; one deeper than it
+         shares its coarse cell with its siblings, so the cell keeps the maximum value */
+      const unsigned int span = 1u << (fine_depth - it.getDepth());
+      const octomap::OcTreeKey base = it.getIndexKey();
+      const float value = it->getLogOdds();
+      for (unsigned int dx = 0; dx < span; dx += step)
+        for (unsigned int dy = 0; dy < span; dy += step)
+          for (unsigned int dz = 0; dz < span; dz += step)
+          {
+            const octomap::OcTreeKey key(base[0] + dx, base[1] + dy, base[2] + dz);
+            const octomap::point3d center = tree_->keyToCoord(tree_->adjustKeyAtDepth(key, depth), depth);
+            OccMapNode* cell = coarse->search(center);
+            if (!cell || cell->getLogOdds() < value)
+              coarse->setNodeValue(center, value);
+          }
+    }
+    coarse->unlockWrite();
+  }
+  tree_->resetChangeDetection();
+  tree_->unlockRead();
+}
+
+void OccupancyMapMonitor::treeUpdated()
+{
+  /* fold the accumulated change set into the downsampled trees before anyone is notified */
+  updatePyramid();
+
+  /* refresh the read-only snapshot: copy the live tree under its read lock, then swap the
+     pointer in. Consumers holding the previous snapshot keep a valid (if older) tree, and
+     never need to lock the live tree the updaters write to. */
+  tree_->lockRead();
+  OccMapTreeConstPtr snapshot;
+  try
+  {
+    snapshot.reset(new OccMapTree(*tree_));
+  }
+  catch (...)
+  {
+    tree_->unlockRead();
+    throw;
+  }
+  tree_->unlockRead();
+
+  {
+    boost::mutex::scoped_lock _(snapshot_lock_);
+    tree_snapshot_.swap(snapshot);
+  }
+
+  if (update_callback_)
+    update_callback_();
+}
+
 void OccupancyMapMonitor::setMapFrame(const std::string& frame)
 {
   boost::mutex::scoped_lock _(parameters_lock_);  // we lock since an updater could specify a new frame for us
@@ -330,6 +459,10 @@ bool OccupancyMapMonitor::loadMapCallback(moveit_msgs::LoadMap::Request& request
   }
   tree_->unlockWrite();
 
+  /* the loaded data did not pass through the change set, so downsample it from scratch */
+  if (response.success)
+    rebuildPyramid();
+
   return true;
 }
 
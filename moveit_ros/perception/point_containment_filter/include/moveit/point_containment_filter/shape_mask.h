@@ -127,6 +127,15 @@ private:
   std::set<SeeShape, SortBodies> bodies_;
   std::map<ShapeHandle, std::set<SeeShape, SortBodies>::iterator> used_handles_;
   std::vector<bodies::BoundingSphere> bspheres_;
+
+  /** \brief The pose each body was last set to; bodies whose pose did not change between frames
+      keep their cached bounding sphere instead of recomputing it */
+  std::map<ShapeHandle, Eigen::Isometry3d, std::less<ShapeHandle>,
+           Eigen::aligned_allocator<std::pair<const ShapeHandle, Eigen::Isometry3d> > >
+      last_poses_;
+
+  /** \brief Cached bounding sphere of each body, valid for the pose in \e last_poses_ */
+  std::map<ShapeHandle, bodies::BoundingSphere> bsphere_cache_;
 };
 }
 
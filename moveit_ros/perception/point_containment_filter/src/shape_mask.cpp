@@ -38,6 +38,13 @@
 #include <geometric_shapes/body_operations.h>
 #include <ros/console.h>
 #include <sensor_msgs/point_cloud2_iterator.h>
+#include <limits>
+
+namespace
+{
+/* with fewer points than this, the scheduling overhead of the parallel mask loop outweighs the gain */
+const int MIN_PARALLEL_MASK_POINTS = 4096;
+}
 
 point_containment_filter::ShapeMask::ShapeMask(const TransformCallback& transform_callback)
   : transform_callback_(transform_callback), next_handle_(1), min_handle_(1)
@@ -104,6 +111,8 @@ void point_containment_filter::ShapeMask::removeShape(ShapeHandle handle)
     delete it->second->body;
     bodies_.erase(it->second);
     used_handles_.erase(it);
+    last_poses_.erase(handle);
+    bsphere_cache_.erase(handle);
     min_handle_ = handle;
   }
   else
@@ -125,6 +134,10 @@ void point_containment_filter::ShapeMask::maskContainment(const sensor_msgs::Poi
   {
     Eigen::Isometry3d tmp;
     bspheres_.resize(bodies_.size());
+    std::vector<const bodies::Body*> check_bodies;
+    std::vector<bodies::BoundingSphere> check_spheres;
+    check_bodies.reserve(bodies_.size());
+    check_spheres.reserve(bodies_.size());
     std::size_t j = 0;
     for (std::set<SeeShape>::const_iterator it = bodies_.begin(); it != bodies_.end(); ++it)
     {
@@ -136,11 +149,38 @@ void point_containment_filter::ShapeMask::maskContainment(const sensor_msgs::Poi
         else
           ROS_ERROR_STREAM_NAMED("shape_mask", "Missing transform for shape " << it->body->getType() << " with handle "
                                                                               << it->handle);
+        if (it->body)
+        {
+          // the body keeps its previous pose; use the cached sphere if we have one, otherwise
+          // an unbounded sphere so the point test below is not skipped
+          check_bodies.push_back(it->body);
+          std::map<ShapeHandle, bodies::BoundingSphere>::const_iterator cached = bsphere_cache_.find(it->handle);
+          if (cached != bsphere_cache_.end())
+            check_spheres.push_back(cached->second);
+          else
+          {
+            bodies::BoundingSphere unbounded;
+            unbounded.center = Eigen::Vector3d::Zero();
+            unbounded.radius = std::numeric_limits<double>::infinity();
+            check_spheres.push_back(unbounded);
+          }
+        }
       }
       else
       {
-        it->body->setPose(tmp);
-        it->body->computeBoundingSphere(bspheres_[j++]);
+        // only bodies that actually moved need their pose set and bounding sphere recomputed
+        std::map<ShapeHandle, Eigen::Isometry3d, std::less<ShapeHandle>,
+                 Eigen::aligned_allocator<std::pair<const ShapeHandle, Eigen::Isometry3d> > >::const_iterator
+            last_pose = last_poses_.find(it->handle);
+        if (last_pose == last_poses_.end() || !last_pose->second.isApprox(tmp))
+        {
+          it->body->setPose(tmp);
+          it->body->computeBoundingSphere(bsphere_cache_[it->handle]);
+          last_poses_[it->handle] = tmp;
+        }
+        bspheres_[j++] = bsphere_cache_[it->handle];
+        check_bodies.push_back(it->body);
+        check_spheres.push_back(bsphere_cache_[it->handle]);
       }
     }
 
@@ -154,9 +194,11 @@ void point_containment_filter::ShapeMask::maskContainment(const sensor_msgs::Poi
     sensor_msgs::PointCloud2ConstIterator<float> iter_y(data_in, "y");
     sensor_msgs::PointCloud2ConstIterator<float> iter_z(data_in, "z");
 
-    // Cloud iterators are not incremented in the for loop, because of the pragma
-    // Comment out below parallelization as it can result in very high CPU consumption
-    //#pragma omp parallel for schedule(dynamic)
+    const int num_bodies = static_cast<int>(check_bodies.size());
+    // Cloud iterators are not incremented in the for loop, because of the pragma.
+    // The if clause keeps small clouds on a single thread, where the scheduling overhead
+    // would dominate; containsPoint only reads the bodies, so the loop is safe to share.
+#pragma omp parallel for schedule(static) if ((int)np >= MIN_PARALLEL_MASK_POINTS)
     for (int i = 0; i < (int)np; ++i)
     {
       Eigen::Vector3d pt = Eigen::Vector3d(*(iter_x + i), *(iter_y + i), *(iter_z + i));
@@ -165,8 +207,10 @@ void point_containment_filter::ShapeMask::maskContainment(const sensor_msgs::Poi
       if (d < min_sensor_dist || d > max_sensor_dist)
         out = CLIP;
       else if ((bound.center - pt).squaredNorm() < radiusSquared)
-        for (std::set<SeeShape>::const_iterator it = bodies_.begin(); it != bodies_.end() && out == OUTSIDE; ++it)
-          if (it->body->containsPoint(pt))
+        for (int b = 0; b < num_bodies && out == OUTSIDE; ++b)
+          // check the body's own bounding sphere before the (possibly expensive) containment test
+          if ((check_spheres[b].center - pt).squaredNorm() < check_spheres[b].radius * check_spheres[b].radius &&
+              check_bodies[b]->containsPoint(pt))
             out = INSIDE;
       mask[i] = out;
     }
@@ -43,6 +43,7 @@
 #include <message_filters/subscriber.h>
 #include <sensor_msgs/PointCloud2.h>
 #include <moveit/occupancy_map_monitor/occupancy_map_updater.h>
+#include <moveit/occupancy_map_monitor/ordered_key_set.h>
 #include <moveit/point_containment_filter/shape_mask.h>
 
 #include <memory>
@@ -99,6 +100,19 @@ private:
 
   std::unique_ptr<point_containment_filter::ShapeMask> shape_mask_;
   std::vector<int> mask_;
+
+  /* scratch buffers for cloudMsgCallback(). the valid points of a cloud are gathered into one
+     contiguous block so the transform into the map frame can run vectorized over whole blocks,
+     and the buffers are kept here to avoid re-allocating them for every cloud */
+  Eigen::Matrix3Xf points_;
+  Eigen::Matrix3Xf transformed_points_;
+  std::vector<unsigned int> point_indices_;
+
+  /* the per-cloud key sets, kept as columnar buffers that are reused from frame to frame */
+  OrderedKeySet free_cells_;
+  OrderedKeySet occupied_cells_;
+  OrderedKeySet model_cells_;
+  OrderedKeySet clip_cells_;
 };
 }
 
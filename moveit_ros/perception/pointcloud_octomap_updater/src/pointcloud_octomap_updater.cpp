@@ -47,6 +47,12 @@
 
 namespace occupancy_map_monitor
 {
+namespace
+{
+/* with fewer rays than this, the scheduling overhead of parallel raycasting outweighs the gain */
+const int MIN_PARALLEL_RAYCAST_CELLS = 64;
+}
+
 PointCloudOctomapUpdater::PointCloudOctomapUpdater()
   : OccupancyMapUpdater("PointCloudUpdater")
   , private_nh_("~")
@@ -213,6 +219,19 @@ void PointCloudOctomapUpdater::cloudMsgCallback(const sensor_msgs::PointCloud2::
   octomap::point3d sensor_origin(sensor_origin_tf.getX(), sensor_origin_tf.getY(), sensor_origin_tf.getZ());
   Eigen::Vector3d sensor_origin_eigen(sensor_origin_tf.getX(), sensor_origin_tf.getY(), sensor_origin_tf.getZ());
 
+  /* the same transform in Eigen form, for transforming whole blocks of points at once */
+  Eigen::Isometry3f map_h_sensor_eigen = Eigen::Isometry3f::Identity();
+  const tf2::Matrix3x3& sensor_basis = map_H_sensor.getBasis();
+  for (int i = 0; i < 3; ++i)
+  {
+    const tf2::Vector3& basis_row = sensor_basis[i];
+    map_h_sensor_eigen(i, 0) = basis_row.getX();
+    map_h_sensor_eigen(i, 1) = basis_row.getY();
+    map_h_sensor_eigen(i, 2) = basis_row.getZ();
+  }
+  map_h_sensor_eigen.translation() =
+      Eigen::Vector3f(sensor_origin_tf.getX(), sensor_origin_tf.getY(), sensor_origin_tf.getZ());
+
   if (!updateTransformCache(cloud_msg->header.frame_id, cloud_msg->header.stamp))
   {
     ROS_ERROR_THROTTLE(1, "Transform cache was not updated. Self-filtering may fail.");
@@ -223,7 +242,10 @@ void PointCloudOctomapUpdater::cloudMsgCallback(const sensor_msgs::PointCloud2::
   shape_mask_->maskContainment(*cloud_msg, sensor_origin_eigen, 0.0, max_range_, mask_);
   updateMask(*cloud_msg, sensor_origin_eigen, mask_);
 
-  octomap::KeySet free_cells, occupied_cells, model_cells, clip_cells;
+  free_cells_.clear();
+  occupied_cells_.clear();
+  model_cells_.clear();
+  clip_cells_.clear();
   std::unique_ptr<sensor_msgs::PointCloud2> filtered_cloud;
 
   // We only use these iterators if we are creating a filtered_cloud for
@@ -252,8 +274,19 @@ void PointCloudOctomapUpdater::cloudMsgCallback(const sensor_msgs::PointCloud2::
 
   try
   {
-    /* do ray tracing to find which cells this point cloud indicates should be free, and which it indicates
-     * should be occupied */
+    /* gather the (possibly subsampled) valid points of the cloud into one contiguous block, so
+       the transform into the map frame below runs vectorized over the whole block instead of
+       going through tf2 one point at a time */
+    const std::size_t max_points = ((cloud_msg->height + point_subsample_ - 1) / point_subsample_) *
+                                   ((cloud_msg->width + point_subsample_ - 1) / point_subsample_);
+    if (static_cast<std::size_t>(points_.cols()) < max_points)
+    {
+      points_.resize(Eigen::NoChange, max_points);
+      transformed_points_.resize(Eigen::NoChange, max_points);
+      point_indices_.resize(max_points);
+    }
+
+    std::size_t num_points = 0;
     for (unsigned int row = 0; row < cloud_msg->height; row += point_subsample_)
     {
       unsigned int row_c = row * cloud_msg->width;
@@ -269,48 +302,82 @@ void PointCloudOctomapUpdater::cloudMsgCallback(const sensor_msgs::PointCloud2::
         /* check for NaN */
         if (!std::isnan(pt_iter[0]) && !std::isnan(pt_iter[1]) && !std::isnan(pt_iter[2]))
         {
-          /* transform to map frame */
-          tf2::Vector3 point_tf = map_H_sensor * tf2::Vector3(pt_iter[0], pt_iter[1], pt_iter[2]);
-
-          /* occupied cell at ray endpoint if ray is shorter than max range and this point
-             isn't on a part of the robot*/
-          if (mask_[row_c + col] == point_containment_filter::ShapeMask::INSIDE)
-            model_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
-          else if (mask_[row_c + col] == point_containment_filter::ShapeMask::CLIP)
-            clip_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
-          else
-          {
-            occupied_cells.insert(tree_->coordToKey(point_tf.getX(), point_tf.getY(), point_tf.getZ()));
-            // build list of valid points if we want to publish them
-            if (filtered_cloud)
-            {
-              **iter_filtered_x = pt_iter[0];
-              **iter_filtered_y = pt_iter[1];
-              **iter_filtered_z = pt_iter[2];
-              ++filtered_cloud_size;
-              ++*iter_filtered_x;
-              ++*iter_filtered_y;
-              ++*iter_filtered_z;
-            }
-          }
+          points_.col(num_points) = Eigen::Vector3f(pt_iter[0], pt_iter[1], pt_iter[2]);
+          point_indices_[num_points] = row_c + col;
+          ++num_points;
         }
       }
     }
 
-    /* compute the free cells along each ray that ends at an occupied cell */
-    for (octomap::KeySet::iterator it = occupied_cells.begin(), end = occupied_cells.end(); it != end; ++it)
-      if (tree_->computeRayKeys(sensor_origin, tree_->keyToCoord(*it), key_ray_))
-        free_cells.insert(key_ray_.begin(), key_ray_.end());
+    /* transform all points to the map frame at once */
+    transformed_points_.leftCols(num_points).noalias() = map_h_sensor_eigen * points_.leftCols(num_points);
 
-    /* compute the free cells along each ray that ends at a model cell */
-    for (octomap::KeySet::iterator it = model_cells.begin(), end = model_cells.end(); it != end; ++it)
-      if (tree_->computeRayKeys(sensor_origin, tree_->keyToCoord(*it), key_ray_))
-        free_cells.insert(key_ray_.begin(), key_ray_.end());
+    /* find which cells this point cloud indicates should be occupied */
+    for (std::size_t i = 0; i < num_points; ++i)
+    {
+      const float x = transformed_points_(0, i);
+      const float y = transformed_points_(1, i);
+      const float z = transformed_points_(2, i);
+
+      /* occupied cell at ray endpoint if ray is shorter than max range and this point
+         isn't on a part of the robot*/
+      if (mask_[point_indices_[i]] == point_containment_filter::ShapeMask::INSIDE)
+        model_cells_.insert(tree_->coordToKey(x, y, z));
+      else if (mask_[point_indices_[i]] == point_containment_filter::ShapeMask::CLIP)
+        clip_cells_.insert(tree_->coordToKey(x, y, z));
+      else
+      {
+        occupied_cells_.insert(tree_->coordToKey(x, y, z));
+        // build list of valid points if we want to publish them
+        if (filtered_cloud)
+        {
+          **iter_filtered_x = points_(0, i);
+          **iter_filtered_y = points_(1, i);
+          **iter_filtered_z = points_(2, i);
+          ++filtered_cloud_size;
+          ++*iter_filtered_x;
+          ++*iter_filtered_y;
+          ++*iter_filtered_z;
+        }
+      }
+    }
 
-    /* compute the free cells along each ray that ends at a clipped cell */
-    for (octomap::KeySet::iterator it = clip_cells.begin(), end = clip_cells.end(); it != end; ++it)
-      if (tree_->computeRayKeys(sensor_origin, tree_->keyToCoord(*it), key_ray_))
-        free_cells.insert(key_ray_.begin(), key_ray_.end());
+    /* deduplicate the endpoint sets so each distinct cell is raycast only once */
+    occupied_cells_.compact();
+    model_cells_.compact();
+    clip_cells_.compact();
+
+    /* compute the free cells along each ray that ends at an occupied, model or clipped cell.
+       the rays are independent and only read the (read-locked) octree, so for larger clouds
+       they are cast in parallel, with each thread collecting its free cells locally first */
+    std::vector<octomap::OcTreeKey> ray_endpoints;
+    ray_endpoints.reserve(occupied_cells_.size() + model_cells_.size() + clip_cells_.size());
+    for (std::uint64_t key : occupied_cells_.keys())
+      ray_endpoints.push_back(OrderedKeySet::unpack(key));
+    for (std::uint64_t key : model_cells_.keys())
+      ray_endpoints.push_back(OrderedKeySet::unpack(key));
+    for (std::uint64_t key : clip_cells_.keys())
+      ray_endpoints.push_back(OrderedKeySet::unpack(key));
+    const int num_rays = static_cast<int>(ray_endpoints.size());
+
+    if (num_rays >= MIN_PARALLEL_RAYCAST_CELLS)
+    {
+#pragma omp parallel
+      {
+        octomap::KeyRay key_ray;
+        OrderedKeySet thread_free_cells;
+#pragma omp for nowait
+        for (int i = 0; i < num_rays; ++i)
+          if (tree_->computeRayKeys(sensor_origin, tree_->keyToCoord(ray_endpoints[i]), key_ray))
+            thread_free_cells.insert(key_ray.begin(), key_ray.end());
+#pragma omp critical(merge_free_cells)
+        free_cells_.insert(thread_free_cells);
+      }
+    }
+    else
+      for (int i = 0; i < num_rays; ++i)
+        if (tree_->computeRayKeys(sensor_origin, tree_->keyToCoord(ray_endpoints[i]), key_ray_))
+          free_cells_.insert(key_ray_.begin(), key_ray_.end());
   }
   catch (...)
   {
@@ -320,30 +387,33 @@ void PointCloudOctomapUpdater::cloudMsgCallback(const sensor_msgs::PointCloud2::
 
   tree_->unlockRead();
 
+  free_cells_.compact();
+
   /* cells that overlap with the model are not occupied */
-  for (octomap::KeySet::iterator it = model_cells.begin(), end = model_cells.end(); it != end; ++it)
-    occupied_cells.erase(*it);
+  occupied_cells_.subtract(model_cells_);
 
   /* occupied cells are not free */
-  for (octomap::KeySet::iterator it = occupied_cells.begin(), end = occupied_cells.end(); it != end; ++it)
-    free_cells.erase(*it);
+  free_cells_.subtract(occupied_cells_);
 
   tree_->lockWrite();
 
   try
   {
+    /* the compacted sets are in key order, so these batch insertions walk the octree with
+       good node locality instead of jumping around in hash order */
+
     /* mark free cells only if not seen occupied in this cloud */
-    for (octomap::KeySet::iterator it = free_cells.begin(), end = free_cells.end(); it != end; ++it)
-      tree_->updateNode(*it, false);
+    for (std::uint64_t key : free_cells_.keys())
+      tree_->updateNode(OrderedKeySet::unpack(key), false);
 
     /* now mark all occupied cells */
-    for (octomap::KeySet::iterator it = occupied_cells.begin(), end = occupied_cells.end(); it != end; ++it)
-      tree_->updateNode(*it, true);
+    for (std::uint64_t key : occupied_cells_.keys())
+      tree_->updateNode(OrderedKeySet::unpack(key), true);
 
     // set the logodds to the minimum for the cells that are part of the model
     const float lg = tree_->getClampingThresMinLog() - tree_->getClampingThresMaxLog();
-    for (octomap::KeySet::iterator it = model_cells.begin(), end = model_cells.end(); it != end; ++it)
-      tree_->updateNode(*it, lg);
+    for (std::uint64_t key : model_cells_.keys())
+      tree_->updateNode(OrderedKeySet::unpack(key), lg);
   }
   catch (...)
   {
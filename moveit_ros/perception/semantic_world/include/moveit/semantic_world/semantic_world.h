@@ -42,8 +42,10 @@
 #include <moveit/planning_scene/planning_scene.h>
 #include <object_recognition_msgs/TableArray.h>
 #include <moveit_msgs/CollisionObject.h>
+#include <shape_msgs/Mesh.h>
 #include <boost/thread/mutex.hpp>
 #include <moveit/macros/class_forward.h>
+#include <set>
 
 namespace shapes
 {
@@ -134,6 +136,17 @@ public:
                             double min_distance_from_edge = 0.0, double min_vertical_offset = 0.0) const;
 
 private:
+  /** @brief Build the solid collision mesh for a table from its convex hull.
+   * Returns false if the hull cannot be triangulated. */
+  bool makeTableMesh(const object_recognition_msgs::Table& table, shape_msgs::Mesh& mesh) const;
+
+  /** @brief Find the tracked table this detection corresponds to, by pose similarity.
+   * Tables whose id is in \e claimed are skipped (they were already associated with
+   * another detection of the same message). Returns an empty string if no tracked
+   * table is close enough. */
+  std::string matchTrackedTable(const object_recognition_msgs::Table& table,
+                                const std::set<std::string>& claimed) const;
+
   shapes::Mesh* createSolidMeshFromPlanarPolygon(const shapes::Mesh& polygon, double thickness) const;
 
   shapes::Mesh* orientPlanarPolygon(const shapes::Mesh& polygon) const;
@@ -152,6 +165,14 @@ private:
 
   std::map<std::string, object_recognition_msgs::Table> current_tables_in_collision_world_;
 
+  /* the collision meshes built for the tracked tables, so re-detections of an
+     unchanged hull do not re-triangulate the surface */
+  std::map<std::string, shape_msgs::Mesh> table_mesh_cache_;
+
+  /* monotonically increasing suffix for naming newly tracked tables; ids stay
+     stable for as long as a table is tracked */
+  std::size_t next_table_id_;
+
   //  boost::mutex table_lock_;
 
   ros::Subscriber table_subscriber_;
@@ -54,8 +54,38 @@ namespace moveit
 {
 namespace semantic_world
 {
+namespace
+{
+/* thresholds for associating table detections across frames */
+const double TABLE_MATCH_POSITION_TOLERANCE = 0.5;  // meters
+const double TABLE_MATCH_ANGLE_TOLERANCE = 0.5;     // radians
+/* below these, a pose update is considered sensor noise and ignored */
+const double TABLE_POSE_CHANGE_TOLERANCE = 1e-3;  // meters / radians
+/* hull vertices that moved less than this do not force a mesh rebuild */
+const double TABLE_HULL_VERTEX_TOLERANCE = 0.005;  // meters
+
+double poseDistance(const geometry_msgs::Pose& a, const geometry_msgs::Pose& b, double& angle)
+{
+  Eigen::Quaterniond qa(a.orientation.w, a.orientation.x, a.orientation.y, a.orientation.z);
+  Eigen::Quaterniond qb(b.orientation.w, b.orientation.x, b.orientation.y, b.orientation.z);
+  angle = qa.angularDistance(qb);
+  return Eigen::Vector3d(a.position.x - b.position.x, a.position.y - b.position.y, a.position.z - b.position.z).norm();
+}
+
+bool hullsMatch(const std::vector<geometry_msgs::Point>& a, const std::vector<geometry_msgs::Point>& b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (std::size_t i = 0; i < a.size(); ++i)
+    if (fabs(a[i].x - b[i].x) > TABLE_HULL_VERTEX_TOLERANCE || fabs(a[i].y - b[i].y) > TABLE_HULL_VERTEX_TOLERANCE ||
+        fabs(a[i].z - b[i].z) > TABLE_HULL_VERTEX_TOLERANCE)
+      return false;
+  return true;
+}
+}
+
 SemanticWorld::SemanticWorld(const planning_scene::PlanningSceneConstPtr& planning_scene)
-  : planning_scene_(planning_scene)
+  : planning_scene_(planning_scene), next_table_id_(0)
 {
   table_subscriber_ = node_handle_.subscribe("table_array", 1, &SemanticWorld::tableCallback, this);
   visualization_publisher_ = node_handle_.advertise<visualization_msgs::MarkerArray>("visualize_place", 20, true);
@@ -96,78 +126,148 @@ bool SemanticWorld::addTablesToCollisionWorld()
   moveit_msgs::PlanningScene planning_scene;
   planning_scene.is_diff = true;
 
-  // Remove the existing tables
-  std::map<std::string, object_recognition_msgs::Table>::iterator it;
-  for (it = current_tables_in_collision_world_.begin(); it != current_tables_in_collision_world_.end(); ++it)
-  {
-    moveit_msgs::CollisionObject co;
-    co.id = it->first;
-    co.operation = moveit_msgs::CollisionObject::REMOVE;
-    planning_scene.world.collision_objects.push_back(co);
-    //    collision_object_publisher_.publish(co);
-  }
-
-  planning_scene_diff_publisher_.publish(planning_scene);
-  planning_scene.world.collision_objects.clear();
-  current_tables_in_collision_world_.clear();
-  // Add the new tables
+  // Associate the incoming detections with the tables already in the collision world, so a
+  // re-scan of a surface updates only what actually changed instead of removing and
+  // re-adding every table
+  std::map<std::string, object_recognition_msgs::Table> updated_tables;
+  std::set<std::string> claimed_ids;
   for (std::size_t i = 0; i < table_array_.tables.size(); ++i)
   {
-    moveit_msgs::CollisionObject co;
-    std::stringstream ss;
-    ss << "table_" << i;
-    co.id = ss.str();
-    current_tables_in_collision_world_[co.id] = table_array_.tables[i];
-    co.operation = moveit_msgs::CollisionObject::ADD;
+    const object_recognition_msgs::Table& table = table_array_.tables[i];
 
-    const std::vector<geometry_msgs::Point>& convex_hull = table_array_.tables[i].convex_hull;
+    std::string id = matchTrackedTable(table, claimed_ids);
+    bool is_new = id.empty();
+    if (is_new)
+    {
+      std::stringstream ss;
+      ss << "table_" << next_table_id_++;
+      id = ss.str();
+    }
+    claimed_ids.insert(id);
 
-    EigenSTL::vector_Vector3d vertices(convex_hull.size());
-    std::vector<unsigned int> triangles((vertices.size() - 2) * 3);
-    for (unsigned int j = 0; j < convex_hull.size(); ++j)
-      vertices[j] = Eigen::Vector3d(convex_hull[j].x, convex_hull[j].y, convex_hull[j].z);
-    for (unsigned int j = 1; j < triangles.size() - 1; ++j)
+    if (!is_new)
     {
-      unsigned int i3 = j * 3;
-      triangles[i3++] = 0;
-      triangles[i3++] = j;
-      triangles[i3] = j + 1;
+      const object_recognition_msgs::Table& tracked = current_tables_in_collision_world_[id];
+      bool have_mesh = table_mesh_cache_.find(id) != table_mesh_cache_.end();
+      if (have_mesh && hullsMatch(tracked.convex_hull, table.convex_hull))
+      {
+        double angle;
+        double distance = poseDistance(tracked.pose, table.pose, angle);
+        if (distance > TABLE_POSE_CHANGE_TOLERANCE || angle > TABLE_POSE_CHANGE_TOLERANCE)
+        {
+          // the surface itself is unchanged; move the existing collision object instead
+          // of rebuilding its mesh
+          moveit_msgs::CollisionObject co;
+          co.id = id;
+          co.header = table.header;
+          co.operation = moveit_msgs::CollisionObject::MOVE;
+          co.mesh_poses.push_back(table.pose);
+          planning_scene.world.collision_objects.push_back(co);
+        }
+        updated_tables[id] = table;
+        continue;
+      }
     }
 
-    shapes::Shape* table_shape = shapes::createMeshFromVertices(vertices, triangles);
-    if (!table_shape)
+    // new table or changed hull: (re)build the mesh; an ADD with an existing id replaces it
+    shape_msgs::Mesh mesh;
+    if (!makeTableMesh(table, mesh))
       continue;
+    table_mesh_cache_[id] = mesh;
 
-    shapes::Mesh* table_mesh = static_cast<shapes::Mesh*>(table_shape);
-    shapes::Mesh* table_mesh_solid = orientPlanarPolygon(*table_mesh);
-    if (!table_mesh_solid)
-    {
-      delete table_shape;
-      continue;
-    }
+    moveit_msgs::CollisionObject co;
+    co.id = id;
+    co.header = table.header;
+    co.operation = moveit_msgs::CollisionObject::ADD;
+    co.meshes.push_back(mesh);
+    co.mesh_poses.push_back(table.pose);
+    planning_scene.world.collision_objects.push_back(co);
+    updated_tables[id] = table;
+  }
 
-    shapes::ShapeMsg table_shape_msg;
-    if (!shapes::constructMsgFromShape(table_mesh_solid, table_shape_msg))
+  // tables that no detection claimed are gone from the latest scan; remove them
+  for (std::map<std::string, object_recognition_msgs::Table>::iterator it = current_tables_in_collision_world_.begin();
+       it != current_tables_in_collision_world_.end(); ++it)
+    if (updated_tables.find(it->first) == updated_tables.end())
     {
-      delete table_shape;
-      delete table_mesh_solid;
-      continue;
+      moveit_msgs::CollisionObject co;
+      co.id = it->first;
+      co.operation = moveit_msgs::CollisionObject::REMOVE;
+      planning_scene.world.collision_objects.push_back(co);
+      table_mesh_cache_.erase(it->first);
     }
 
-    const shape_msgs::Mesh& table_shape_msg_mesh = boost::get<shape_msgs::Mesh>(table_shape_msg);
+  current_tables_in_collision_world_.swap(updated_tables);
+  if (!planning_scene.world.collision_objects.empty())
+    planning_scene_diff_publisher_.publish(planning_scene);
+  return true;
+}
+
+bool SemanticWorld::makeTableMesh(const object_recognition_msgs::Table& table, shape_msgs::Mesh& mesh) const
+{
+  const std::vector<geometry_msgs::Point>& convex_hull = table.convex_hull;
+  if (convex_hull.size() < 3)
+    return false;
 
-    co.meshes.push_back(table_shape_msg_mesh);
-    co.mesh_poses.push_back(table_array_.tables[i].pose);
-    co.header = table_array_.tables[i].header;
-    planning_scene.world.collision_objects.push_back(co);
-    //    collision_object_publisher_.publish(co);
+  EigenSTL::vector_Vector3d vertices(convex_hull.size());
+  std::vector<unsigned int> triangles((vertices.size() - 2) * 3);
+  for (unsigned int j = 0; j < convex_hull.size(); ++j)
+    vertices[j] = Eigen::Vector3d(convex_hull[j].x, convex_hull[j].y, convex_hull[j].z);
+  for (unsigned int j = 1; j < triangles.size() - 1; ++j)
+  {
+    unsigned int i3 = j * 3;
+    triangles[i3++] = 0;
+    triangles[i3++] = j;
+    triangles[i3] = j + 1;
+  }
+
+  shapes::Shape* table_shape = shapes::createMeshFromVertices(vertices, triangles);
+  if (!table_shape)
+    return false;
+
+  shapes::Mesh* table_mesh = static_cast<shapes::Mesh*>(table_shape);
+  shapes::Mesh* table_mesh_solid = orientPlanarPolygon(*table_mesh);
+  if (!table_mesh_solid)
+  {
+    delete table_shape;
+    return false;
+  }
+
+  shapes::ShapeMsg table_shape_msg;
+  if (!shapes::constructMsgFromShape(table_mesh_solid, table_shape_msg))
+  {
     delete table_shape;
     delete table_mesh_solid;
+    return false;
   }
-  planning_scene_diff_publisher_.publish(planning_scene);
+
+  mesh = boost::get<shape_msgs::Mesh>(table_shape_msg);
+  delete table_shape;
+  delete table_mesh_solid;
   return true;
 }
 
+std::string SemanticWorld::matchTrackedTable(const object_recognition_msgs::Table& table,
+                                             const std::set<std::string>& claimed) const
+{
+  std::string best_id;
+  double best_distance = TABLE_MATCH_POSITION_TOLERANCE;
+  std::map<std::string, object_recognition_msgs::Table>::const_iterator it;
+  for (it = current_tables_in_collision_world_.begin(); it != current_tables_in_collision_world_.end(); ++it)
+  {
+    if (claimed.find(it->first) != claimed.end())
+      continue;
+    double angle;
+    double distance = poseDistance(it->second.pose, table.pose, angle);
+    if (distance < best_distance && angle < TABLE_MATCH_ANGLE_TOLERANCE)
+    {
+      best_distance = distance;
+      best_id = it->first;
+    }
+  }
+  return best_id;
+}
+
 object_recognition_msgs::TableArray SemanticWorld::getTablesInROI(double minx, double miny, double minz, double maxx,
                                                                   double maxy, double maxz) const
 {
@@ -206,6 +306,7 @@ void SemanticWorld::clear()
 {
   table_array_.tables.clear();
   current_tables_in_collision_world_.clear();
+  table_mesh_cache_.clear();
 }
 
 std::vector<geometry_msgs::PoseStamped>
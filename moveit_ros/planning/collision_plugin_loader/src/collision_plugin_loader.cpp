@@ -33,6 +33,7 @@
  *********************************************************************/
 
 #include <moveit/collision_plugin_loader/collision_plugin_loader.h>
+#include <moveit/utils/plugin_prefetch.h>
 #include <pluginlib/class_loader.hpp>
 #include <memory>
 
@@ -46,6 +47,14 @@ public:
     try
     {
       loader_.reset(new pluginlib::ClassLoader<CollisionPlugin>("moveit_core", "collision_detection::CollisionPlugin"));
+      // start paging in the plugin libraries now, so the dlopen in load() does not
+      // fault them in from disk serially
+      const std::vector<std::string>& classes = loader_->getDeclaredClasses();
+      std::vector<std::string> libraries;
+      libraries.reserve(classes.size());
+      for (std::size_t i = 0; i < classes.size(); ++i)
+        libraries.push_back(loader_->getClassLibraryPath(classes[i]));
+      moveit::tools::prefetchPluginLibraries(libraries);
     }
     catch (pluginlib::PluginlibException& e)
     {
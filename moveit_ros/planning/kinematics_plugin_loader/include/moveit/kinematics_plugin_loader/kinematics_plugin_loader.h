@@ -87,6 +87,13 @@ public:
    * function reads ROS parameters for the groups defined in the SRDF. */
   robot_model::SolverAllocatorFn getLoaderFunction(const srdf::ModelSharedPtr& srdf_model);
 
+  /** \brief Eagerly instantiate and pool \e count kinematics solver instances for every group of \e
+      model this loader knows about. The groups are processed in parallel and subsequent solver
+      allocations pop instances from the pool instead of going through pluginlib, moving the solver
+      construction cost off the first IK call. One of the getLoaderFunction() variants must have
+      been called before. */
+  void preloadSolvers(const robot_model::RobotModelConstPtr& model, unsigned int count = 1);
+
   /** \brief Get the groups for which the function pointer returned by getLoaderFunction() can allocate a solver */
   const std::vector<std::string>& getKnownGroups() const
   {
@@ -38,6 +38,7 @@
 #include <moveit/rdf_loader/rdf_loader.h>
 #include <pluginlib/class_loader.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <sstream>
 #include <vector>
 #include <map>
@@ -145,6 +146,20 @@ public:
       return result;
     }
 
+    // use a pre-instantiated solver if one is pooled for this group
+    {
+      boost::mutex::scoped_lock slock(pool_lock_);
+      std::map<const robot_model::JointModelGroup*, std::vector<kinematics::KinematicsBasePtr> >::iterator pool_it =
+          solver_pool_.find(jmg);
+      if (pool_it != solver_pool_.end() && !pool_it->second.empty())
+      {
+        result = pool_it->second.back();
+        pool_it->second.pop_back();
+        ROS_DEBUG_NAMED(LOGNAME, "Using pre-instantiated kinematics solver for group '%s'", jmg->getName().c_str());
+        return result;
+      }
+    }
+
     ROS_DEBUG_NAMED(LOGNAME, "Trying to allocate kinematics solver for group '%s'", jmg->getName().c_str());
 
     std::map<std::string, std::vector<std::string> >::const_iterator it =
@@ -159,45 +174,45 @@ public:
                                   links.front()->getParentJointModel()->getParentLinkModel()->getName() :
                                   jmg->getParentModel().getModelFrame();
 
-    // just to be sure, do not call the same pluginlib instance allocation function in parallel
-    boost::mutex::scoped_lock slock(lock_);
     for (std::size_t i = 0; !result && i < it->second.size(); ++i)
     {
       try
       {
+        // just to be sure, do not call the same pluginlib instance allocation function in parallel;
+        // initializing the instances, however, can proceed concurrently
+        boost::mutex::scoped_lock slock(lock_);
         result = kinematics_loader_->createUniqueInstance(it->second[i]);
-        if (result)
-        {
-          // choose the tip of the IK solver
-          const std::vector<std::string> tips = chooseTipFrames(jmg);
-
-          // choose search resolution
-          double search_res = search_res_.find(jmg->getName())->second[i];  // we know this exists, by construction
-
-          if (!result->initialize(jmg->getParentModel(), jmg->getName(),
-                                  (base.empty() || base[0] != '/') ? base : base.substr(1), tips, search_res) &&
-              // on failure: fallback to old method (TODO: remove in future)
-              !result->initialize(robot_description_, jmg->getName(),
-                                  (base.empty() || base[0] != '/') ? base : base.substr(1), tips, search_res))
-          {
-            ROS_ERROR_NAMED(LOGNAME, "Kinematics solver of type '%s' could not be initialized for group '%s'",
-                            it->second[i].c_str(), jmg->getName().c_str());
-            result.reset();
-            continue;
-          }
-
-          result->setDefaultTimeout(jmg->getDefaultIKTimeout());
-          ROS_DEBUG_NAMED(LOGNAME,
-                          "Successfully allocated and initialized a kinematics solver of type '%s' with search "
-                          "resolution %lf for group '%s' at address %p",
-                          it->second[i].c_str(), search_res, jmg->getName().c_str(), result.get());
-          break;
-        }
       }
       catch (pluginlib::PluginlibException& e)
       {
         ROS_ERROR_NAMED(LOGNAME, "The kinematics plugin (%s) failed to load. Error: %s", it->first.c_str(), e.what());
       }
+      if (result)
+      {
+        // choose the tip of the IK solver
+        const std::vector<std::string> tips = chooseTipFrames(jmg);
+
+        // choose search resolution
+        double search_res = search_res_.find(jmg->getName())->second[i];  // we know this exists, by construction
+
+        if (!result->initialize(jmg->getParentModel(), jmg->getName(),
+                                (base.empty() || base[0] != '/') ? base : base.substr(1), tips, search_res) &&
+            // on failure: fallback to old method (TODO: remove in future)
+            !result->initialize(robot_description_, jmg->getName(),
+                                (base.empty() || base[0] != '/') ? base : base.substr(1), tips, search_res))
+        {
+          ROS_ERROR_NAMED(LOGNAME, "Kinematics solver of type '%s' could not be initialized for group '%s'",
+                          it->second[i].c_str(), jmg->getName().c_str());
+          result.reset();
+          continue;
+        }
+
+        result->setDefaultTimeout(jmg->getDefaultIKTimeout());
+        ROS_DEBUG_NAMED(LOGNAME,
+                        "Successfully allocated and initialized a kinematics solver of type '%s' with search "
+                        "resolution %lf for group '%s' at address %p",
+                        it->second[i].c_str(), search_res, jmg->getName().c_str(), result.get());
+      }
     }
 
     if (!result)
@@ -223,6 +238,18 @@ public:
     return cached;
   }
 
+  void preloadSolvers(const robot_model::RobotModelConstPtr& model, unsigned int count)
+  {
+    std::vector<std::unique_ptr<boost::thread> > threads;
+    for (std::map<std::string, std::vector<std::string> >::const_iterator it = possible_kinematics_solvers_.begin();
+         it != possible_kinematics_solvers_.end(); ++it)
+      if (model->hasJointModelGroup(it->first))
+        threads.emplace_back(new boost::thread(boost::bind(&KinematicsLoaderImpl::poolSolversForGroup, this,
+                                                           model->getJointModelGroup(it->first), count)));
+    for (std::size_t i = 0; i < threads.size(); ++i)
+      threads[i]->join();
+  }
+
   void status() const
   {
     for (std::map<std::string, std::vector<std::string> >::const_iterator it = possible_kinematics_solvers_.begin();
@@ -233,6 +260,21 @@ public:
   }
 
 private:
+  void poolSolversForGroup(const robot_model::JointModelGroup* jmg, unsigned int count)
+  {
+    std::vector<kinematics::KinematicsBasePtr> solvers;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      kinematics::KinematicsBasePtr solver = allocKinematicsSolver(jmg);
+      if (!solver)
+        break;
+      solvers.push_back(solver);
+    }
+    boost::mutex::scoped_lock slock(pool_lock_);
+    std::vector<kinematics::KinematicsBasePtr>& pool = solver_pool_[jmg];
+    pool.insert(pool.end(), solvers.begin(), solvers.end());
+  }
+
   std::string robot_description_;
   std::map<std::string, std::vector<std::string> > possible_kinematics_solvers_;
   std::map<std::string, std::vector<double> > search_res_;
@@ -240,10 +282,22 @@ private:
                                                                             // of custom-specified tip link(s)
   std::shared_ptr<pluginlib::ClassLoader<kinematics::KinematicsBase> > kinematics_loader_;
   std::map<const robot_model::JointModelGroup*, kinematics::KinematicsBasePtr> instances_;
+  // pre-instantiated solvers filled in by preloadSolvers(); allocKinematicsSolver() pops from here
+  // before going through pluginlib
+  std::map<const robot_model::JointModelGroup*, std::vector<kinematics::KinematicsBasePtr> > solver_pool_;
   boost::mutex lock_;
   boost::mutex cache_lock_;
+  boost::mutex pool_lock_;
 };
 
+void KinematicsPluginLoader::preloadSolvers(const robot_model::RobotModelConstPtr& model, unsigned int count)
+{
+  if (loader_)
+    loader_->preloadSolvers(model, count);
+  else
+    ROS_ERROR_NAMED(LOGNAME, "Cannot preload kinematics solvers before a loader function was requested");
+}
+
 void KinematicsPluginLoader::status() const
 {
   if (loader_)
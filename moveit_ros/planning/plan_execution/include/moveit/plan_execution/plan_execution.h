@@ -43,7 +43,10 @@
 #include <moveit/planning_scene_monitor/planning_scene_monitor.h>
 #include <moveit/planning_scene_monitor/trajectory_monitor.h>
 #include <moveit/sensor_manager/sensor_manager.h>
+#include <moveit/collision_detection/world_diff.h>
+#include <moveit/robot_trajectory/trajectory_fingerprint.h>
 #include <pluginlib/class_loader.hpp>
+#include <boost/thread/mutex.hpp>
 
 /** \brief This namespace includes functionality specific to the execution and monitoring of motion plans */
 namespace plan_execution
@@ -136,6 +139,12 @@ public:
       start of the method. They are then used to monitor the execution. */
   moveit_msgs::MoveItErrorCodes executeAndMonitor(ExecutableMotionPlan& plan);
 
+  /** \brief If a plan with the same quantized joint-space signature as \e plan is currently being
+      executed (e.g. a duplicate request raced this one), wait for that execution to finish and
+      report its outcome in \e result instead of executing a second copy. Returns true when a
+      matching in-flight execution was found and the requests were merged. */
+  bool waitForIdenticalExecution(const ExecutableMotionPlan& plan, moveit_msgs::MoveItErrorCodes& result);
+
   void stop();
 
   std::string getErrorCodeString(const moveit_msgs::MoveItErrorCodes& error_code);
@@ -145,6 +154,13 @@ private:
   bool isRemainingPathValid(const ExecutableMotionPlan& plan);
   bool isRemainingPathValid(const ExecutableMotionPlan& plan, const std::pair<int, int>& path_segment);
 
+  /** \brief Compute an axis-aligned bounding box for the volume the trajectories in \e plan sweep through */
+  void computePathAabb(const ExecutableMotionPlan& plan);
+
+  /** \brief Check whether any of the world changes recorded since the last call can interfere with the path
+      being executed; returns true (and the path must be re-validated) when in doubt */
+  bool worldChangesInterfereWithPath(const ExecutableMotionPlan& plan);
+
   void planningSceneUpdatedCallback(const planning_scene_monitor::PlanningSceneMonitor::SceneUpdateType update_type);
   void doneWithTrajectoryExecution(const moveit_controller_manager::ExecutionStatus& status);
   void successfulTrajectorySegmentExecution(const ExecutableMotionPlan* plan, std::size_t index);
@@ -162,6 +178,19 @@ private:
   bool execution_complete_;
   bool path_became_invalid_;
 
+  // fingerprint index used to merge duplicate requests: the signature of the plan currently in
+  // flight and the signature + outcome of the execution that completed last
+  mutable boost::mutex plan_fingerprint_mutex_;
+  robot_trajectory::TrajectoryFingerprint active_plan_fingerprint_;
+  robot_trajectory::TrajectoryFingerprint last_completed_fingerprint_;
+  moveit_msgs::MoveItErrorCodes last_completed_result_;
+
+  // changes to the world since execution started; used to discard scene updates that cannot
+  // possibly invalidate the path being executed
+  collision_detection::WorldDiffPtr world_diff_;
+  // bounding box of the volume swept by the executed path: (minx, maxx, miny, maxy, minz, maxz)
+  std::vector<double> path_aabb_;
+
   class DynamicReconfigureImpl;
   DynamicReconfigureImpl* reconfigure_impl_;
 };
@@ -38,6 +38,7 @@
 #include <moveit/robot_state/conversions.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <moveit/collision_detection/collision_tools.h>
+#include <geometric_shapes/shape_operations.h>
 #include <boost/algorithm/string/join.hpp>
 
 #include <dynamic_reconfigure/server.h>
@@ -47,6 +48,20 @@ namespace plan_execution
 {
 using namespace moveit_ros_planning;
 
+// padding added to the bounding box of an executed path, to account for motion in between waypoints
+static const double PATH_AABB_MARGIN = 0.1;
+
+// combined joint-space signature of all trajectories in a plan; 0 when the plan holds no waypoints
+static robot_trajectory::TrajectoryFingerprint planFingerprint(const ExecutableMotionPlan& plan)
+{
+  robot_trajectory::TrajectoryFingerprint fingerprint = 0;
+  for (std::size_t i = 0; i < plan.plan_components_.size(); ++i)
+    if (plan.plan_components_[i].trajectory_ && !plan.plan_components_[i].trajectory_->empty())
+      fingerprint = fingerprint * 1099511628211ULL ^
+                    robot_trajectory::computeTrajectoryFingerprint(*plan.plan_components_[i].trajectory_);
+  return fingerprint;
+}
+
 class PlanExecution::DynamicReconfigureImpl
 {
 public:
@@ -85,6 +100,9 @@ plan_execution::PlanExecution::PlanExecution(
   preempt_requested_ = false;
   new_scene_update_ = false;
 
+  active_plan_fingerprint_ = 0;
+  last_completed_fingerprint_ = 0;
+
   // we want to be notified when new information is available
   planning_scene_monitor_->addUpdateCallback(boost::bind(&PlanExecution::planningSceneUpdatedCallback, this, _1));
 
@@ -220,8 +238,10 @@ void plan_execution::PlanExecution::planAndExecuteHelper(ExecutableMotionPlan& p
       if (preempt_requested_)
         break;
 
-      // execute the trajectory, and monitor its executionm
-      plan.error_code_ = executeAndMonitor(plan);
+      // execute the trajectory, and monitor its executionm; if an identical trajectory is already
+      // in flight (e.g. a duplicate request raced us), merge with that execution instead
+      if (!waitForIdenticalExecution(plan, plan.error_code_))
+        plan.error_code_ = executeAndMonitor(plan);
     }
 
     // if we are done, then we exit the loop
@@ -314,6 +334,79 @@ bool plan_execution::PlanExecution::isRemainingPathValid(const ExecutableMotionP
   return true;
 }
 
+void plan_execution::PlanExecution::computePathAabb(const ExecutableMotionPlan& plan)
+{
+  path_aabb_.clear();
+  std::vector<double> aabb;
+  for (std::size_t i = 0; i < plan.plan_components_.size(); ++i)
+  {
+    const robot_trajectory::RobotTrajectoryPtr& t = plan.plan_components_[i].trajectory_;
+    if (!t)
+      continue;
+    for (std::size_t j = 0; j < t->getWayPointCount(); ++j)
+    {
+      t->getWayPointPtr(j)->computeAABB(aabb);
+      if (path_aabb_.empty())
+        path_aabb_ = aabb;
+      else
+        for (std::size_t k = 0; k < 6; k += 2)
+        {
+          path_aabb_[k] = std::min(path_aabb_[k], aabb[k]);
+          path_aabb_[k + 1] = std::max(path_aabb_[k + 1], aabb[k + 1]);
+        }
+    }
+  }
+
+  // grow the box to account for motion in between waypoints
+  for (std::size_t k = 0; k < path_aabb_.size(); k += 2)
+  {
+    path_aabb_[k] -= PATH_AABB_MARGIN;
+    path_aabb_[k + 1] += PATH_AABB_MARGIN;
+  }
+}
+
+bool plan_execution::PlanExecution::worldChangesInterfereWithPath(const ExecutableMotionPlan& plan)
+{
+  // without change tracking or a path bound we have to assume interference
+  if (!world_diff_ || path_aabb_.size() != 6)
+    return true;
+
+  planning_scene_monitor::LockedPlanningSceneRO lscene(plan.planning_scene_monitor_);
+
+  // an update that left no trace in the world (e.g. attached bodies, transforms) cannot be classified here
+  if (world_diff_->size() == 0)
+    return true;
+
+  bool interference = false;
+  for (collision_detection::WorldDiff::const_iterator it = world_diff_->begin();
+       !interference && it != world_diff_->end(); ++it)
+  {
+    // objects that were only removed cannot invalidate the path
+    if (!(it->second & (collision_detection::World::CREATE | collision_detection::World::ADD_SHAPE |
+                        collision_detection::World::MOVE_SHAPE)))
+      continue;
+    collision_detection::World::ObjectConstPtr obj = plan.planning_scene_->getWorld()->getObject(it->first);
+    if (!obj)
+      continue;
+    for (std::size_t i = 0; i < obj->shapes_.size() && !interference; ++i)
+    {
+      // a sphere around the shape gives a conservative axis-aligned bound regardless of the
+      // orientation of the shape
+      const Eigen::Vector3d extents = shapes::computeShapeExtents(obj->shapes_[i].get());
+      const double radius = 0.5 * extents.norm();
+      const Eigen::Vector3d center = obj->shape_poses_[i].translation();
+      interference = center.x() + radius >= path_aabb_[0] && center.x() - radius <= path_aabb_[1] &&
+                     center.y() + radius >= path_aabb_[2] && center.y() - radius <= path_aabb_[3] &&
+                     center.z() + radius >= path_aabb_[4] && center.z() - radius <= path_aabb_[5];
+    }
+  }
+  world_diff_->clearChanges();
+
+  if (!interference)
+    ROS_DEBUG_NAMED("plan_execution", "Ignoring scene update: no changed object intersects the path being executed");
+  return interference;
+}
+
 moveit_msgs::MoveItErrorCodes plan_execution::PlanExecution::executeAndMonitor(ExecutableMotionPlan& plan)
 {
   if (!plan.planning_scene_monitor_)
@@ -341,6 +434,10 @@ moveit_msgs::MoveItErrorCodes plan_execution::PlanExecution::executeAndMonitor(E
 
   execution_complete_ = false;
 
+  // signature of what is about to be executed, computed before unwinding modifies the waypoints so
+  // it is comparable with what waitForIdenticalExecution() computes for a candidate duplicate
+  const robot_trajectory::TrajectoryFingerprint plan_fingerprint = planFingerprint(plan);
+
   // push the trajectories we have slated for execution to the trajectory execution manager
   int prev = -1;
   for (std::size_t i = 0; i < plan.plan_components_.size(); ++i)
@@ -390,6 +487,23 @@ moveit_msgs::MoveItErrorCodes plan_execution::PlanExecution::executeAndMonitor(E
     }
   }
 
+  // record the signature of what is now in flight, so duplicate requests can merge with this
+  // execution instead of executing a copy
+  {
+    boost::mutex::scoped_lock lock(plan_fingerprint_mutex_);
+    active_plan_fingerprint_ = plan_fingerprint;
+  }
+
+  // bound the volume the path sweeps through and start recording changes to the world, so that
+  // scene updates that cannot interfere with the path can be discarded without re-validating
+  // every remaining waypoint
+  computePathAabb(plan);
+  {
+    planning_scene_monitor::LockedPlanningSceneRW lscene(plan.planning_scene_monitor_);
+    world_diff_.reset(new collision_detection::WorldDiff(plan.planning_scene_->getWorldNonConst()));
+    world_diff_->clearChanges();  // the constructor records all existing objects as created
+  }
+
   if (!trajectory_monitor_ && planning_scene_monitor_->getStateMonitor())
     trajectory_monitor_.reset(
         new planning_scene_monitor::TrajectoryMonitor(planning_scene_monitor_->getStateMonitor()));
@@ -412,7 +526,7 @@ moveit_msgs::MoveItErrorCodes plan_execution::PlanExecution::executeAndMonitor(E
     if (new_scene_update_)
     {
       new_scene_update_ = false;
-      if (!isRemainingPathValid(plan))
+      if (worldChangesInterfereWithPath(plan) && !isRemainingPathValid(plan))
       {
         path_became_invalid_ = true;
         break;
@@ -439,6 +553,12 @@ moveit_msgs::MoveItErrorCodes plan_execution::PlanExecution::executeAndMonitor(E
     trajectory_execution_manager_->stopExecution();
   }
 
+  // stop recording world changes
+  {
+    planning_scene_monitor::LockedPlanningSceneRW lscene(plan.planning_scene_monitor_);
+    world_diff_.reset();
+  }
+
   // stop recording trajectory states
   if (trajectory_monitor_)
     trajectory_monitor_->stopTrajectoryMonitor();
@@ -464,9 +584,56 @@ moveit_msgs::MoveItErrorCodes plan_execution::PlanExecution::executeAndMonitor(E
         result.val = moveit_msgs::MoveItErrorCodes::CONTROL_FAILED;
     }
   }
+
+  {
+    boost::mutex::scoped_lock lock(plan_fingerprint_mutex_);
+    active_plan_fingerprint_ = 0;
+    last_completed_fingerprint_ = plan_fingerprint;
+    last_completed_result_ = result;
+  }
   return result;
 }
 
+bool plan_execution::PlanExecution::waitForIdenticalExecution(const ExecutableMotionPlan& plan,
+                                                              moveit_msgs::MoveItErrorCodes& result)
+{
+  const robot_trajectory::TrajectoryFingerprint fingerprint = planFingerprint(plan);
+  if (!fingerprint)
+    return false;
+  {
+    boost::mutex::scoped_lock lock(plan_fingerprint_mutex_);
+    if (active_plan_fingerprint_ != fingerprint)
+      return false;
+  }
+  ROS_INFO_NAMED("plan_execution", "An identical trajectory is already executing; merging with that execution");
+
+  ros::WallDuration wait_interval(0.01);
+  while (node_handle_.ok())
+  {
+    {
+      boost::mutex::scoped_lock lock(plan_fingerprint_mutex_);
+      if (active_plan_fingerprint_ != fingerprint)
+      {
+        if (last_completed_fingerprint_ == fingerprint)
+        {
+          result = last_completed_result_;
+          return true;
+        }
+        // the execution we were waiting on was replaced before completing; execute ourselves
+        return false;
+      }
+    }
+    if (preempt_requested_)
+    {
+      result.val = moveit_msgs::MoveItErrorCodes::PREEMPTED;
+      return true;
+    }
+    wait_interval.sleep();
+  }
+  result.val = moveit_msgs::MoveItErrorCodes::FAILURE;
+  return true;
+}
+
 void plan_execution::PlanExecution::planningSceneUpdatedCallback(
     const planning_scene_monitor::PlanningSceneMonitor::SceneUpdateType update_type)
 {
@@ -41,7 +41,9 @@
 #include <moveit/planning_request_adapter/planning_request_adapter.h>
 #include <pluginlib/class_loader.hpp>
 #include <ros/ros.h>
+#include <boost/thread.hpp>
 
+#include <deque>
 #include <memory>
 
 /** \brief Planning pipeline */
@@ -68,6 +70,11 @@ public:
    * this topic (visualization_msgs::MarkerArray) */
   static const std::string MOTION_CONTACTS_TOPIC;
 
+  /** \brief When the ~compressed_display_path_resolution parameter is set to a positive value, computed motion plans
+   * are additionally published on this topic as delta-encoded buffers (std_msgs::UInt8MultiArray, see
+   * robot_trajectory::encodeJointTrajectoryDeltas()), intended for logging infrastructure that records every plan */
+  static const std::string COMPRESSED_DISPLAY_PATH_TOPIC;
+
   /** \brief Given a robot model (\e model), a node handle (\e nh), initialize the planning pipeline.
       \param model The robot model for which this pipeline is initialized.
       \param nh The ROS node handle that should be used for reading parameters needed for configuration
@@ -89,6 +96,8 @@ public:
   PlanningPipeline(const robot_model::RobotModelConstPtr& model, const ros::NodeHandle& nh,
                    const std::string& planning_plugin_name, const std::vector<std::string>& adapter_plugin_names);
 
+  ~PlanningPipeline();
+
   /** \brief Pass a flag telling the pipeline whether or not to publish the computed motion plans on DISPLAY_PATH_TOPIC.
    * Default is true. */
   void displayComputedMotionPlans(bool flag);
@@ -101,6 +110,13 @@ public:
    * This is true by default.  */
   void checkSolutionPaths(bool flag);
 
+  /** \brief Pass a flag telling the pipeline whether or not to plan against a scene narrowed to the world objects
+   * the request's planning group can reach (see PlanningScene::createNarrowedScene()). In large scenes this keeps
+   * the collision broadphase from considering objects that can never collide with the group. Solution paths are
+   * still validated against the full scene. Default is false; can also be enabled with the
+   * ~narrow_scene_to_group_reach parameter. */
+  void narrowSceneToGroupReach(bool flag);
+
   /** \brief Get the flag set by displayComputedMotionPlans() */
   bool getDisplayComputedMotionPlans() const
   {
@@ -119,6 +135,12 @@ public:
     return check_solution_paths_;
   }
 
+  /** \brief Get the flag set by narrowSceneToGroupReach() */
+  bool getNarrowSceneToGroupReach() const
+  {
+    return narrow_scene_to_group_reach_;
+  }
+
   /** \brief Call the motion planner plugin and the sequence of planning request adapters (if any).
       \param planning_scene The planning scene where motion planning is to be done
       \param req The request for motion planning
@@ -139,6 +161,31 @@ public:
                     const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res,
                     std::vector<std::size_t>& adapter_added_state_index) const;
 
+  /// Callback invoked when a planning request queued with generatePlanAsync() completes. The second
+  /// argument is the value generatePlan() would have returned for this request.
+  typedef boost::function<void(const planning_interface::MotionPlanResponse& res, bool success)> PlanCompletionCallback;
+
+  /** \brief Queue a motion planning request for asynchronous processing. Worker threads run the full
+      pipeline (request adapters, planner, solution checking) for queued requests and invoke \e callback
+      when done; when more than one planning thread is configured, multiple requests are processed
+      concurrently. The callback is invoked from a planning thread.
+      \param planning_scene The planning scene where motion planning is to be done
+      \param req The request for motion planning
+      \param callback The callback to invoke when the request has been processed */
+  void generatePlanAsync(const planning_scene::PlanningSceneConstPtr& planning_scene,
+                         const planning_interface::MotionPlanRequest& req, const PlanCompletionCallback& callback);
+
+  /** \brief Set the number of threads used to process requests queued with generatePlanAsync(). The
+      default is 1; values larger than 1 require the loaded planning plugin to support concurrent
+      planning contexts. This takes effect the next time the planning threads are started. */
+  void setPlanningThreadCount(unsigned int count);
+
+  /** \brief Get the number of threads used to process requests queued with generatePlanAsync() */
+  unsigned int getPlanningThreadCount() const
+  {
+    return planning_thread_count_;
+  }
+
   /** \brief Request termination, if a generatePlan() function is currently computing plans */
   void terminate() const;
 
@@ -167,7 +214,17 @@ public:
   }
 
 private:
+  /// A planning request queued with generatePlanAsync(), waiting to be picked up by a planning thread
+  struct QueuedMotionPlanRequest
+  {
+    planning_scene::PlanningSceneConstPtr planning_scene_;
+    planning_interface::MotionPlanRequest request_;
+    PlanCompletionCallback callback_;
+  };
+
   void configure();
+  void planningThread();
+  void stopPlanningThreads();
 
   ros::NodeHandle nh_;
 
@@ -175,6 +232,10 @@ private:
   bool display_computed_motion_plans_;
   ros::Publisher display_path_publisher_;
 
+  /// Position quantization of the delta-encoded plan publication; 0 disables the publication
+  double compressed_display_path_resolution_;
+  ros::Publisher compressed_path_publisher_;
+
   /// Flag indicating whether received requests should be published just before beginning processing (useful for
   /// debugging)
   bool publish_received_requests_;
@@ -193,6 +254,24 @@ private:
   /// Flag indicating whether the reported plans should be checked once again, by the planning pipeline itself
   bool check_solution_paths_;
   ros::Publisher contacts_publisher_;
+
+  /// Flag indicating whether planning runs against a scene narrowed to the group's reachable workspace
+  bool narrow_scene_to_group_reach_;
+
+  /// Flag indicating whether the memory each request costs (peak RSS, heap growth) is reported when it completes
+  bool report_memory_usage_;
+
+  /// File individual allocations are traced to while a request is planned; empty disables tracing
+  std::string allocation_trace_file_;
+
+  /// Requests queued with generatePlanAsync(); the planning threads are started lazily, when the
+  /// first request is queued
+  std::deque<QueuedMotionPlanRequest> planning_request_queue_;
+  boost::mutex planning_queue_mutex_;
+  boost::condition_variable planning_queue_condition_;
+  std::vector<std::unique_ptr<boost::thread> > planning_threads_;
+  bool run_planning_threads_;
+  unsigned int planning_thread_count_;
 };
 
 MOVEIT_CLASS_FORWARD(PlanningPipeline);
@@ -35,18 +35,26 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/planning_pipeline/planning_pipeline.h>
+#include <moveit/profiler/profiler.h>
+#include <moveit/utils/memory_usage.h>
+#include <moveit/utils/plugin_prefetch.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/collision_detection/collision_tools.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
+#include <moveit/robot_trajectory/trajectory_delta_codec.h>
 #include <moveit_msgs/DisplayTrajectory.h>
+#include <std_msgs/UInt8MultiArray.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string/join.hpp>
 #include <sstream>
+#include <thread>
 
 const std::string planning_pipeline::PlanningPipeline::DISPLAY_PATH_TOPIC = "display_planned_path";
 const std::string planning_pipeline::PlanningPipeline::MOTION_PLAN_REQUEST_TOPIC = "motion_plan_request";
 const std::string planning_pipeline::PlanningPipeline::MOTION_CONTACTS_TOPIC = "display_contacts";
+const std::string planning_pipeline::PlanningPipeline::COMPRESSED_DISPLAY_PATH_TOPIC = "display_planned_path_"
+                                                                                       "compressed";
 
 planning_pipeline::PlanningPipeline::PlanningPipeline(const robot_model::RobotModelConstPtr& model,
                                                       const ros::NodeHandle& nh,
@@ -78,11 +86,24 @@ planning_pipeline::PlanningPipeline::PlanningPipeline(const robot_model::RobotMo
   configure();
 }
 
+planning_pipeline::PlanningPipeline::~PlanningPipeline()
+{
+  stopPlanningThreads();
+}
+
 void planning_pipeline::PlanningPipeline::configure()
 {
   check_solution_paths_ = false;  // this is set to true below
   publish_received_requests_ = false;
   display_computed_motion_plans_ = false;  // this is set to true below
+  run_planning_threads_ = false;
+  planning_thread_count_ = 1;
+  nh_.param("narrow_scene_to_group_reach", narrow_scene_to_group_reach_, false);
+  nh_.param("report_memory_usage", report_memory_usage_, false);
+  nh_.param("allocation_trace_file", allocation_trace_file_, std::string());
+  nh_.param("compressed_display_path_resolution", compressed_display_path_resolution_, 0.0);
+  if (compressed_display_path_resolution_ > 0.0)
+    compressed_path_publisher_ = nh_.advertise<std_msgs::UInt8MultiArray>(COMPRESSED_DISPLAY_PATH_TOPIC, 10, true);
 
   // load the planning plugin
   try
@@ -111,24 +132,10 @@ void planning_pipeline::PlanningPipeline::configure()
              "now.",
              planner_plugin_name_.c_str());
   }
-  try
-  {
-    planner_instance_ = planner_plugin_loader_->createUniqueInstance(planner_plugin_name_);
-    if (!planner_instance_->initialize(robot_model_, nh_.getNamespace()))
-      throw std::runtime_error("Unable to initialize planning plugin");
-    ROS_INFO_STREAM("Using planning interface '" << planner_instance_->getDescription() << "'");
-  }
-  catch (pluginlib::PluginlibException& ex)
-  {
-    ROS_ERROR_STREAM("Exception while loading planner '"
-                     << planner_plugin_name_ << "': " << ex.what() << std::endl
-                     << "Available plugins: " << boost::algorithm::join(classes, ", "));
-  }
-
-  // load the planner request adapters
+  // create the adapter loader up front so the library paths of everything we are about
+  // to dlopen are known before the first load
   if (!adapter_plugin_names_.empty())
   {
-    std::vector<planning_request_adapter::PlanningRequestAdapterConstPtr> ads;
     try
     {
       adapter_plugin_loader_.reset(new pluginlib::ClassLoader<planning_request_adapter::PlanningRequestAdapter>(
@@ -138,8 +145,32 @@ void planning_pipeline::PlanningPipeline::configure()
     {
       ROS_ERROR_STREAM("Exception while creating planning plugin loader " << ex.what());
     }
+  }
 
+  // hint the kernel to start paging in all the plugin libraries, so the dlopen calls
+  // below map cached pages instead of faulting each library in from disk serially
+  try
+  {
+    std::vector<std::string> plugin_libraries;
+    if (planner_plugin_loader_ && !planner_plugin_name_.empty())
+      plugin_libraries.push_back(planner_plugin_loader_->getClassLibraryPath(planner_plugin_name_));
     if (adapter_plugin_loader_)
+      for (std::size_t i = 0; i < adapter_plugin_names_.size(); ++i)
+        plugin_libraries.push_back(adapter_plugin_loader_->getClassLibraryPath(adapter_plugin_names_[i]));
+    moveit::tools::prefetchPluginLibraries(plugin_libraries);
+  }
+  catch (pluginlib::PluginlibException& ex)
+  {
+    ROS_DEBUG_STREAM("Could not resolve plugin library paths for prefetching: " << ex.what());
+  }
+
+  // load the planner request adapters on a side thread, overlapping their dlopen with
+  // the planner plugin load and initialization below; the adapter instances are not
+  // touched until after the join
+  std::vector<planning_request_adapter::PlanningRequestAdapterConstPtr> ads;
+  std::thread adapter_load_thread;
+  if (adapter_plugin_loader_)
+    adapter_load_thread = std::thread([this, &ads] {
       for (std::size_t i = 0; i < adapter_plugin_names_.size(); ++i)
       {
         planning_request_adapter::PlanningRequestAdapterConstPtr ad;
@@ -155,14 +186,37 @@ void planning_pipeline::PlanningPipeline::configure()
         if (ad)
           ads.push_back(ad);
       }
-    if (!ads.empty())
+    });
+
+  try
+  {
+    planner_instance_ = planner_plugin_loader_->createUniqueInstance(planner_plugin_name_);
+    if (!planner_instance_->initialize(robot_model_, nh_.getNamespace()))
+      throw std::runtime_error("Unable to initialize planning plugin");
+    ROS_INFO_STREAM("Using planning interface '" << planner_instance_->getDescription() << "'");
+  }
+  catch (pluginlib::PluginlibException& ex)
+  {
+    ROS_ERROR_STREAM("Exception while loading planner '"
+                     << planner_plugin_name_ << "': " << ex.what() << std::endl
+                     << "Available plugins: " << boost::algorithm::join(classes, ", "));
+  }
+  catch (...)
+  {
+    if (adapter_load_thread.joinable())
+      adapter_load_thread.join();
+    throw;
+  }
+
+  if (adapter_load_thread.joinable())
+    adapter_load_thread.join();
+  if (!ads.empty())
+  {
+    adapter_chain_.reset(new planning_request_adapter::PlanningRequestAdapterChain());
+    for (std::size_t i = 0; i < ads.size(); ++i)
     {
-      adapter_chain_.reset(new planning_request_adapter::PlanningRequestAdapterChain());
-      for (std::size_t i = 0; i < ads.size(); ++i)
-      {
-        ROS_INFO_STREAM("Using planning request adapter '" << ads[i]->getDescription() << "'");
-        adapter_chain_->addAdapter(ads[i]);
-      }
+      ROS_INFO_STREAM("Using planning request adapter '" << ads[i]->getDescription() << "'");
+      adapter_chain_->addAdapter(ads[i]);
     }
   }
   displayComputedMotionPlans(true);
@@ -196,6 +250,31 @@ void planning_pipeline::PlanningPipeline::checkSolutionPaths(bool flag)
   check_solution_paths_ = flag;
 }
 
+void planning_pipeline::PlanningPipeline::narrowSceneToGroupReach(bool flag)
+{
+  narrow_scene_to_group_reach_ = flag;
+}
+
+namespace
+{
+// Log what the request that just completed cost in memory and stop a possibly
+// active allocation trace; a NULL tracker means accounting was not requested
+void reportMemoryUsage(const moveit::tools::ScopedMemoryTracker* tracker)
+{
+  if (!tracker)
+    return;
+  moveit::tools::stopAllocationTrace();
+  const double mib = 1024.0 * 1024.0;
+  ROS_INFO("Planning request memory usage: peak RSS %.1f MiB (%+.1f MiB over the %.1f MiB at request start), heap "
+           "delta %+ld KiB",
+           tracker->peakResidentSetSize() / mib,
+           (static_cast<double>(tracker->peakResidentSetSize()) -
+            static_cast<double>(tracker->initialResidentSetSize())) /
+               mib,
+           tracker->initialResidentSetSize() / mib, tracker->heapUsedDelta() / 1024);
+}
+}
+
 bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::PlanningSceneConstPtr& planning_scene,
                                                        const planning_interface::MotionPlanRequest& req,
                                                        planning_interface::MotionPlanResponse& res) const
@@ -209,6 +288,8 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
                                                        planning_interface::MotionPlanResponse& res,
                                                        std::vector<std::size_t>& adapter_added_state_index) const
 {
+  moveit::tools::Profiler::ScopedBlock prof_block("PlanningPipeline::generatePlan");
+
   // broadcast the request we are about to work on, if needed
   if (publish_received_requests_)
     received_request_publisher_.publish(req);
@@ -220,12 +301,27 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
     return false;
   }
 
+  // optionally account the memory this request costs; the figures are reported when the request completes
+  std::unique_ptr<moveit::tools::ScopedMemoryTracker> memory_tracker;
+  if (report_memory_usage_)
+  {
+    if (!allocation_trace_file_.empty() && moveit::tools::startAllocationTrace(allocation_trace_file_))
+      ROS_INFO("Tracing allocations of this planning request to '%s'", allocation_trace_file_.c_str());
+    memory_tracker.reset(new moveit::tools::ScopedMemoryTracker());
+  }
+
+  // optionally plan against a scene narrowed to what the group can reach; the solution path is
+  // still validated against the full scene below
+  planning_scene::PlanningSceneConstPtr scene = planning_scene;
+  if (narrow_scene_to_group_reach_ && !req.group_name.empty())
+    scene = planning_scene->createNarrowedScene(req.group_name);
+
   bool solved = false;
   try
   {
     if (adapter_chain_)
     {
-      solved = adapter_chain_->adaptAndPlan(planner_instance_, planning_scene, req, res, adapter_added_state_index);
+      solved = adapter_chain_->adaptAndPlan(planner_instance_, scene, req, res, adapter_added_state_index);
       if (!adapter_added_state_index.empty())
       {
         std::stringstream ss;
@@ -237,15 +333,17 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
     else
     {
       planning_interface::PlanningContextPtr context =
-          planner_instance_->getPlanningContext(planning_scene, req, res.error_code_);
+          planner_instance_->getPlanningContext(scene, req, res.error_code_);
       solved = context ? context->solve(res) : false;
     }
   }
   catch (std::exception& ex)
   {
     ROS_ERROR("Exception caught: '%s'", ex.what());
+    reportMemoryUsage(memory_tracker.get());
     return false;
   }
+  reportMemoryUsage(memory_tracker.get());
   bool valid = true;
 
   if (solved && res.trajectory_)
@@ -339,9 +437,79 @@ bool planning_pipeline::PlanningPipeline::generatePlan(const planning_scene::Pla
     display_path_publisher_.publish(disp);
   }
 
+  // publish a delta-encoded copy of the plan for logging infrastructure if configured
+  if (compressed_display_path_resolution_ > 0.0 && solved)
+  {
+    moveit_msgs::RobotTrajectory trajectory_msg;
+    res.trajectory_->getRobotTrajectoryMsg(trajectory_msg);
+    std_msgs::UInt8MultiArray compressed;
+    robot_trajectory::encodeJointTrajectoryDeltas(trajectory_msg.joint_trajectory, compressed_display_path_resolution_,
+                                                  compressed.data);
+    compressed_path_publisher_.publish(compressed);
+  }
+
   return solved && valid;
 }
 
+void planning_pipeline::PlanningPipeline::generatePlanAsync(
+    const planning_scene::PlanningSceneConstPtr& planning_scene, const planning_interface::MotionPlanRequest& req,
+    const PlanCompletionCallback& callback)
+{
+  boost::mutex::scoped_lock slock(planning_queue_mutex_);
+  if (planning_threads_.empty())
+  {
+    run_planning_threads_ = true;
+    for (unsigned int i = 0; i < planning_thread_count_; ++i)
+      planning_threads_.emplace_back(new boost::thread(boost::bind(&PlanningPipeline::planningThread, this)));
+  }
+  QueuedMotionPlanRequest queued;
+  queued.planning_scene_ = planning_scene;
+  queued.request_ = req;
+  queued.callback_ = callback;
+  planning_request_queue_.push_back(queued);
+  planning_queue_condition_.notify_one();
+}
+
+void planning_pipeline::PlanningPipeline::setPlanningThreadCount(unsigned int count)
+{
+  stopPlanningThreads();
+  planning_thread_count_ = count > 0 ? count : 1;
+}
+
+void planning_pipeline::PlanningPipeline::planningThread()
+{
+  while (run_planning_threads_)
+  {
+    QueuedMotionPlanRequest queued;
+    {
+      boost::unique_lock<boost::mutex> ulock(planning_queue_mutex_);
+      while (planning_request_queue_.empty() && run_planning_threads_)
+        planning_queue_condition_.wait(ulock);
+      if (!run_planning_threads_)
+        break;
+      queued = planning_request_queue_.front();
+      planning_request_queue_.pop_front();
+    }
+    planning_interface::MotionPlanResponse res;
+    bool success = generatePlan(queued.planning_scene_, queued.request_, res);
+    if (queued.callback_)
+      queued.callback_(res, success);
+  }
+}
+
+void planning_pipeline::PlanningPipeline::stopPlanningThreads()
+{
+  {
+    boost::mutex::scoped_lock slock(planning_queue_mutex_);
+    run_planning_threads_ = false;
+    planning_queue_condition_.notify_all();
+  }
+  for (std::size_t i = 0; i < planning_threads_.size(); ++i)
+    planning_threads_[i]->join();
+  planning_threads_.clear();
+  planning_request_queue_.clear();
+}
+
 void planning_pipeline::PlanningPipeline::terminate() const
 {
   if (planner_instance_)
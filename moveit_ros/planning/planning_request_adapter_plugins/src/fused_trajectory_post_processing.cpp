@@ -0,0 +1,122 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/planning_request_adapter/planning_request_adapter.h>
+#include <moveit/trajectory_processing/iterative_time_parameterization.h>
+#include <class_loader/class_loader.hpp>
+#include <ros/ros.h>
+
+namespace default_planner_request_adapters
+{
+/** @brief Post-process the solution path in a single stage: every waypoint is checked against the
+ *  joint bounds and fixed if it is only marginally outside of them, and the trajectory is then
+ *  time-parameterized. Use this instead of stacking separate post-processing adapters, each of
+ *  which traverses the whole trajectory on its own. */
+class FusedTrajectoryPostProcessing : public planning_request_adapter::PlanningRequestAdapter
+{
+public:
+  static const std::string BOUNDS_PARAM_NAME;
+
+  FusedTrajectoryPostProcessing() : planning_request_adapter::PlanningRequestAdapter(), nh_("~")
+  {
+    if (!nh_.getParam(BOUNDS_PARAM_NAME, bounds_dist_))
+    {
+      bounds_dist_ = 0.05;
+      ROS_INFO_STREAM("Param '" << BOUNDS_PARAM_NAME << "' was not set. Using default value: " << bounds_dist_);
+    }
+    else
+      ROS_INFO_STREAM("Param '" << BOUNDS_PARAM_NAME << "' was set to " << bounds_dist_);
+  }
+
+  std::string getDescription() const override
+  {
+    return "Fused Trajectory Post Processing";
+  }
+
+  bool adaptAndPlan(const PlannerFn& planner, const planning_scene::PlanningSceneConstPtr& planning_scene,
+                    const planning_interface::MotionPlanRequest& req, planning_interface::MotionPlanResponse& res,
+                    std::vector<std::size_t>& added_path_index) const override
+  {
+    bool result = planner(planning_scene, req, res);
+    if (result && res.trajectory_ && !res.trajectory_->empty())
+    {
+      ROS_DEBUG("Running '%s'", getDescription().c_str());
+
+      const robot_model::JointModelGroup* jmg = res.trajectory_->getGroup();
+      const std::vector<const robot_model::JointModel*>& jmodels =
+          jmg ? jmg->getJointModels() : res.trajectory_->getRobotModel()->getJointModels();
+
+      // fix and validate all waypoints in one pass over the trajectory
+      for (std::size_t i = 0; i < res.trajectory_->getWayPointCount(); ++i)
+      {
+        robot_state::RobotState& wp = *res.trajectory_->getWayPointPtr(i);
+        for (std::size_t j = 0; j < jmodels.size(); ++j)
+        {
+          if (wp.satisfiesBounds(jmodels[j]))
+            continue;
+          if (wp.satisfiesBounds(jmodels[j], bounds_dist_))
+          {
+            // waypoints just outside bounds (e.g. due to numeric drift in interpolation) are moved back in
+            wp.enforceBounds(jmodels[j]);
+          }
+          else
+          {
+            ROS_WARN("Waypoint %zu of the solution path is outside bounds for joint '%s' by more than the ~%s "
+                     "parameter (currently set to %lf)",
+                     i, jmodels[j]->getName().c_str(), BOUNDS_PARAM_NAME.c_str(), bounds_dist_);
+            res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
+            return false;
+          }
+        }
+      }
+
+      if (!time_param_.computeTimeStamps(*res.trajectory_, req.max_velocity_scaling_factor,
+                                         req.max_acceleration_scaling_factor))
+        ROS_WARN("Time parametrization for the solution path failed.");
+    }
+
+    return result;
+  }
+
+private:
+  ros::NodeHandle nh_;
+  double bounds_dist_;
+  trajectory_processing::IterativeParabolicTimeParameterization time_param_;
+};
+
+const std::string FusedTrajectoryPostProcessing::BOUNDS_PARAM_NAME = "trajectory_max_bounds_error";
+}
+
+CLASS_LOADER_REGISTER_CLASS(default_planner_request_adapters::FusedTrajectoryPostProcessing,
+                            planning_request_adapter::PlanningRequestAdapter);
@@ -45,6 +45,9 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
 
+#include <atomic>
+#include <cstdint>
+
 namespace planning_scene_monitor
 {
 typedef boost::function<void(const sensor_msgs::JointStateConstPtr& joint_state)> JointStateUpdateCallback;
@@ -125,6 +128,27 @@ public:
    *  @return Returns the current state */
   robot_state::RobotStatePtr getCurrentState() const;
 
+  /** @brief Get a shared snapshot of the current state without copying it on every call.
+   *  The snapshot is an immutable copy of the monitored state that is rebuilt only when the state
+   *  has actually changed since the previous call; repeated calls between updates return the same
+   *  instance. Use this instead of getCurrentState() in high-rate readers.
+   *  @return Returns a shared pointer to an immutable copy of the current state */
+  robot_state::RobotStateConstPtr getCurrentStateNoCopy() const;
+
+  /** @brief Copy the most recently received joint variable positions into a caller-provided
+   *  buffer without taking the monitor mutex and without allocating, for use from realtime
+   *  threads (e.g. servo loops). The callback thread publishes each state change into a rotation
+   *  of three preallocated slots guarded by sequence counters (a seqlock), so a reader never
+   *  blocks and never observes a torn state; it simply retries against the newest slot if a
+   *  write overlapped the copy. Values are raw variable positions in the robot model's variable
+   *  order; multi-dof joint values updated from TF are included. Updates queued in batched
+   *  update mode (see enableBatchedUpdates()) are published only when some reader drains them.
+   *  @param variable_positions Preallocated buffer for the copy
+   *  @param count Size of the buffer; must equal getRobotModel()->getVariableCount()
+   *  @param stamp Set to the receive time of the copied state, for staleness checks
+   *  @return False if no state has been received yet or \e count does not match */
+  bool copyCurrentStateRealtime(double* variable_positions, std::size_t count, ros::Time& stamp) const;
+
   /** @brief Set the state \e upd to the current state maintained by this class. */
   void setToCurrentState(robot_state::RobotState& upd) const;
 
@@ -190,26 +214,78 @@ public:
     copy_dynamics_ = enabled;
   }
 
+  /** @brief Enable (or disable) batched state updates. When enabled, incoming joint state messages
+   *  are queued in a lock-free ring buffer instead of locking and updating the maintained state in
+   *  the subscriber callback; all pending messages are applied in one batch the next time the state
+   *  is read. This keeps the subscriber callback from contending with readers when many publishers
+   *  produce bursts of messages. Update callbacks are then invoked from the reader thread, once per
+   *  queued message that changed the state. Call this before startStateMonitor(). */
+  void enableBatchedUpdates(bool enabled);
+
 private:
   void jointStateCallback(const sensor_msgs::JointStateConstPtr& joint_state);
   void tfCallback();
 
+  /** @brief Apply one joint state message to the maintained state; state_update_lock_ must be held.
+   *  @return True if any joint value changed */
+  bool applyJointState(const sensor_msgs::JointState& joint_state) const;
+
+  /** @brief Publish the maintained state into the next realtime slot; state_update_lock_
+   *  must be held. Called whenever the state actually changed. */
+  void publishRealtimeState() const;
+
+  /** @brief Apply all joint state messages queued in the ring buffer; \e lock must own
+   *  state_update_lock_. The lock is briefly released to invoke update callbacks. No-op unless
+   *  batched updates are enabled. */
+  void processPendingStates(boost::mutex::scoped_lock& lock) const;
+
   ros::NodeHandle nh_;
   std::shared_ptr<tf2_ros::Buffer> tf_buffer_;
   robot_model::RobotModelConstPtr robot_model_;
-  robot_state::RobotState robot_state_;
-  std::map<const moveit::core::JointModel*, ros::Time> joint_time_;
+  // the maintained state and its bookkeeping are mutable so that const accessors can lazily apply
+  // messages queued in batched update mode; all of them are guarded by state_update_lock_
+  mutable robot_state::RobotState robot_state_;
+  mutable std::map<const moveit::core::JointModel*, ros::Time> joint_time_;
   bool state_monitor_started_;
   bool copy_dynamics_;  // Copy velocity and effort from joint_state
   ros::Time monitor_start_time_;
   double error_;
   ros::Subscriber joint_state_subscriber_;
-  ros::Time current_state_time_;
+  mutable ros::Time current_state_time_;
 
   mutable boost::mutex state_update_lock_;
   mutable boost::condition_variable state_update_condition_;
   std::vector<JointStateUpdateCallback> update_callbacks_;
 
+  // single-producer/single-consumer ring buffer for batched update mode; the subscriber callback
+  // is the only producer, consumers are serialized by state_update_lock_. The indices grow
+  // monotonically and are reduced modulo the capacity when accessing slots.
+  static const std::size_t STATE_RING_CAPACITY = 1024;
+  bool batched_updates_;
+  mutable std::vector<sensor_msgs::JointStateConstPtr> state_ring_;
+  std::atomic<std::size_t> ring_head_;          // next slot the producer writes
+  mutable std::atomic<std::size_t> ring_tail_;  // next slot the consumer reads
+
+  // triple-buffered slots behind copyCurrentStateRealtime(). The callback thread cycles
+  // through the slots, bumping the slot's sequence counter to an odd value while writing and
+  // back to even when done, then publishes the slot index. Readers validate their copy
+  // against the sequence counter and retry on overlap; with three slots, the writer never
+  // touches the published slot or its predecessor, so a reader that keeps up never retries.
+  struct RealtimeStateSlot
+  {
+    std::atomic<std::uint64_t> sequence;
+    std::vector<double> positions;
+    ros::Time stamp;
+  };
+  mutable RealtimeStateSlot realtime_slots_[3];
+  mutable std::atomic<int> realtime_latest_slot_;  // -1 until the first state is published
+
+  // version counter bumped on every state modification; used to rebuild the shared snapshot
+  // returned by getCurrentStateNoCopy() only when the state actually changed
+  mutable std::uint64_t state_version_;
+  mutable std::uint64_t snapshot_version_;
+  mutable robot_state::RobotStateConstPtr state_snapshot_;
+
   std::shared_ptr<TFConnection> tf_connection_;
 };
 
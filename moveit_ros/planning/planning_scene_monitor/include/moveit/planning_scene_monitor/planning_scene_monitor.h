@@ -47,10 +47,14 @@
 #include <moveit/robot_model_loader/robot_model_loader.h>
 #include <moveit/occupancy_map_monitor/occupancy_map_monitor.h>
 #include <moveit/planning_scene_monitor/current_state_monitor.h>
+#include <moveit/planning_scene_monitor/shared_scene_segment.h>
 #include <moveit/collision_plugin_loader/collision_plugin_loader.h>
 #include <boost/noncopyable.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <memory>
 
 namespace planning_scene_monitor
@@ -204,6 +208,14 @@ public:
     return scene_const_;
   }
 
+  /** @brief Get an immutable snapshot of the current planning scene without holding the scene
+   *         lock for the duration of its use. The snapshot is cloned lazily on the first call
+   *         after a scene update and then cached, so repeated calls between updates only copy a
+   *         shared pointer and never contend with writers. The returned scene is not modified by
+   *         the monitor, so a planner can pin it for an entire solve while updates continue to
+   *         flow into the monitored scene. */
+  planning_scene::PlanningSceneConstPtr getSceneSnapshot();
+
   /** @brief Return true if the scene \e scene can be updated directly
       or indirectly by this monitor. This function will return true if
       the pointer of the scene is the same as the one maintained,
@@ -278,6 +290,19 @@ public:
     return publish_planning_scene_frequency_;
   }
 
+  /** \brief Publish a full planning scene (a keyframe) after every \e interval diff publications,
+      so that subscribers on lossy links can resynchronize without requesting the scene. 0 (the
+      default) disables periodic keyframes; the full scene is then only published on full scene
+      updates and when publishing starts. */
+  void setFullSceneKeyframeInterval(unsigned int interval);
+
+  /** \brief Get the number of diff publications between full planning scene publications (0 if
+      periodic keyframes are disabled) */
+  unsigned int getFullSceneKeyframeInterval() const
+  {
+    return full_scene_keyframe_interval_;
+  }
+
   /** @brief Get the stored instance of the stored current state monitor
    *  @return An instance of the stored current state monitor*/
   const CurrentStateMonitorPtr& getStateMonitor() const
@@ -327,6 +352,20 @@ public:
       return 0.0;
   }
 
+  /** @brief Enable or disable the low-latency fast path for robot state updates. When enabled,
+      every joint state update bypasses the throttling configured with setStateUpdateFrequency()
+      and patches the joint positions of the scene's robot state in place, instead of copying the
+      full monitored state. Only joint positions are patched; velocities, effort and multi-DOF
+      joints are still integrated by the regular (throttled) updates. Enable this only if the
+      readers of the scene can keep up with the joint states topic. Disabled by default. */
+  void setLowLatencyStateUpdates(bool flag);
+
+  /** @brief Whether the low-latency fast path for robot state updates is enabled */
+  bool getLowLatencyStateUpdates() const
+  {
+    return low_latency_state_updates_;
+  }
+
   /** @brief Start the scene monitor
    *  @param scene_topic The name of the planning scene topic
    */
@@ -452,6 +491,14 @@ protected:
   void excludeAttachedBodyFromOctree(const robot_state::AttachedBody* attached_body);
   void includeAttachedBodyInOctree(const robot_state::AttachedBody* attached_body);
 
+  /** @brief Queue a body for (re-)exclusion from the monitored octomap; bodies closer to the robot are
+      queued ahead of farther ones. Does nothing if the body is already queued. */
+  void queueOctreeExclusion(bool attached_body, const std::string& id, double distance);
+
+  /** @brief Process queued octomap exclusions, closest bodies first, stopping once the per-cycle time
+      budget is spent; leftover entries are picked up again on the next octomap update cycle */
+  void processPendingOctreeExclusions();
+
   bool getShapeTransformCache(const std::string& target_frame, const ros::Time& target_time,
                               occupancy_map_monitor::ShapeTransformCache& cache) const;
 
@@ -462,6 +509,13 @@ protected:
   planning_scene::PlanningSceneConstPtr scene_const_;
   planning_scene::PlanningScenePtr parent_scene_;  /// if diffs are monitored, this is the pointer to the parent scene
   boost::shared_mutex scene_update_mutex_;         /// mutex for stored scene
+
+  // lazily cloned read-only snapshot of the scene, see getSceneSnapshot()
+  std::atomic<std::uint64_t> scene_version_{ 1 };  /// incremented on every scene update event
+  boost::mutex scene_snapshot_lock_;
+  planning_scene::PlanningSceneConstPtr scene_snapshot_;
+  std::uint64_t scene_snapshot_version_ = 0;  /// scene_version_ the cached snapshot was cloned at
+
   ros::Time last_update_time_;                     /// Last time the state was updated
   ros::Time last_robot_motion_time_;               /// Last time the robot has moved
 
@@ -491,6 +545,8 @@ protected:
   ros::Publisher planning_scene_publisher_;
   std::unique_ptr<boost::thread> publish_planning_scene_;
   double publish_planning_scene_frequency_;
+  /// number of diff publications between full scene publications (0 = no periodic keyframes)
+  unsigned int full_scene_keyframe_interval_;
   SceneUpdateType publish_update_types_;
   SceneUpdateType new_scene_update_;
   boost::condition_variable_any new_scene_update_condition_;
@@ -522,6 +578,31 @@ protected:
   LinkShapeHandles link_shape_handles_;
   AttachedBodyShapeHandles attached_body_shape_handles_;
   CollisionBodyShapeHandles collision_body_shape_handles_;
+
+  /// Bookkeeping for a body excluded from the monitored octomap. Keyed by body name / object id rather
+  /// than by pointer, so it stays valid across scene diff pushes that recreate the underlying objects;
+  /// the stored shapes detect when a body changed and its exclusion must be redone.
+  struct ExcludedBodyShapes
+  {
+    std::vector<std::pair<occupancy_map_monitor::ShapeHandle, std::size_t> > handles;  // shape handle + shape index
+    std::vector<shapes::ShapeConstPtr> shapes;
+  };
+  std::map<std::string, ExcludedBodyShapes> excluded_attached_bodies_;
+  std::map<std::string, ExcludedBodyShapes> excluded_world_objects_;
+
+  /// A queued (re-)exclusion of a body from the monitored octomap, referenced by name so the entry
+  /// survives the underlying object being recreated before it is processed
+  struct PendingOctreeExclusion
+  {
+    bool attached_body;  // attached body (true) or world object (false)
+    std::string id;      // body name or object id
+    double distance;     // squared distance to the robot; closer bodies are processed first
+  };
+  std::deque<PendingOctreeExclusion> pending_octree_exclusions_;
+
+  /// Seconds of octomap exclusion processing allowed per update cycle; 0 processes everything immediately
+  double octomap_exclusion_budget_;
+
   mutable boost::recursive_mutex shape_handles_lock_;
 
   /// lock access to update_callbacks_
@@ -538,9 +619,16 @@ private:
   // called by current_state_monitor_ when robot state (as monitored on joint state topic) changes
   void onStateUpdate(const sensor_msgs::JointStateConstPtr& joint_state);
 
+  // patch the joint positions of a joint state message directly into the scene state
+  // (the low-latency alternative to updateSceneWithCurrentState())
+  void updateSceneWithJointStates(const sensor_msgs::JointState& joint_state);
+
   // called by state_update_timer_ when a state update it pending
   void stateUpdateTimerCallback(const ros::WallTimerEvent& event);
 
+  // called by shared_scene_read_timer_ to pick up updates from the shared scene segment
+  void sharedSceneReadTimerCallback(const ros::WallTimerEvent& event);
+
   // Callback for a new planning scene msg
   void newPlanningSceneCallback(const moveit_msgs::PlanningSceneConstPtr& scene);
 
@@ -555,6 +643,9 @@ private:
   // This field is protected by state_pending_mutex_
   ros::WallDuration dt_state_update_;
 
+  /// when true, joint state updates are patched into the scene state directly, without throttling
+  bool low_latency_state_updates_;
+
   /// the amount of time to wait when looking up transforms
   // Setting this to a non-zero value resolves issues when the sensor data is
   // arriving so fast that it is preceding the transform state.
@@ -565,6 +656,13 @@ private:
   // Not safe to access from callback functions.
   ros::WallTimer state_update_timer_;
 
+  /// optional shared-memory mirror of the scene for co-located processes; as a writer the segment is
+  /// refreshed on every scene update event, as a reader it is polled by shared_scene_read_timer_
+  SharedSceneSegmentPtr shared_scene_segment_;
+  std::string shared_scene_name_;
+  bool shared_scene_writer_;
+  ros::WallTimer shared_scene_read_timer_;
+
   /// Last time the state was updated from current_state_monitor_
   // Only access this from callback functions (and constructor)
   ros::WallTime last_robot_state_update_wall_time_;
@@ -0,0 +1,142 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_PLANNING_SCENE_MONITOR_SHARED_SCENE_SEGMENT_
+#define MOVEIT_PLANNING_SCENE_MONITOR_SHARED_SCENE_SEGMENT_
+
+#include <moveit/macros/class_forward.h>
+#include <moveit/planning_scene/planning_scene.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace planning_scene_monitor
+{
+MOVEIT_CLASS_FORWARD(SharedSceneSegment)
+
+/** @brief A shared-memory mirror of the monitored planning scene for co-located processes.
+ *
+ *  One writer process (typically move_group) publishes the robot state variables and the poses of the
+ *  world object shapes into a POSIX shared memory segment; reader processes on the same machine map the
+ *  segment read-only and patch the mirrored values into their local scene, instead of each maintaining a
+ *  full PlanningSceneMonitor copy driven by diff messages. Snapshot consistency is provided by a seqlock
+ *  epoch counter: the writer makes the epoch odd while it updates the segment and readers retry until
+ *  they observe the same even epoch before and after copying.
+ *
+ *  Only poses and joint values travel through the segment. Shape geometry is identified by a fingerprint;
+ *  objects a reader does not know yet, or whose geometry changed, are skipped and still flow through the
+ *  regular planning scene diff topics. Writer and readers must be started with the same robot description
+ *  so that variable ordering and the planning frame agree.
+ */
+class SharedSceneSegment
+{
+public:
+  /** @brief Create (writer) or attach to (reader) the named segment.
+   *  @param name Segment name, e.g. "/moveit_scene"; must start with a slash
+   *  @param writer When true the segment is created and owned; it is unlinked again on destruction
+   *  @param variable_capacity Maximum number of robot state variables the segment can hold
+   *  @param shape_capacity Maximum number of world object shapes the segment can hold */
+  SharedSceneSegment(const std::string& name, bool writer, std::size_t variable_capacity = 1024,
+                     std::size_t shape_capacity = 1024);
+  ~SharedSceneSegment();
+
+  /** @brief False when the segment could not be created or attached (e.g. the writer is not up yet) */
+  bool isValid() const
+  {
+    return memory_ != NULL;
+  }
+
+  bool isWriter() const
+  {
+    return writer_;
+  }
+
+  /** @brief Publish the robot state variables and (optionally) the world object shape poses of \e scene.
+   *  Must only be called on a writer segment, with at least read access to the scene held. When
+   *  \e include_world is false the previously published shape records are left as they are, which keeps
+   *  state-only updates cheap. */
+  void writeScene(const planning_scene::PlanningScene& scene, bool include_world);
+
+  /** @brief Patch the most recent snapshot into \e scene. Returns false when the segment holds no newer
+   *  epoch than the last one applied or a consistent snapshot could not be obtained. Must be called with
+   *  write access to the scene held; \e robot_state_changed and \e geometry_changed report which parts of
+   *  the scene were actually modified. */
+  bool readScene(planning_scene::PlanningScene& scene, bool& robot_state_changed, bool& geometry_changed);
+
+private:
+  /// Fixed-size segment layout: Header, then \e variable_capacity doubles, then \e shape_capacity ShapeRecords
+  struct Header
+  {
+    std::uint32_t magic;
+    std::uint32_t layout_version;
+    std::atomic<std::uint64_t> epoch;  // seqlock: odd while the writer is mid-update
+    std::uint32_t variable_capacity;
+    std::uint32_t shape_capacity;
+    std::uint32_t variable_count;
+    std::uint32_t shape_count;
+  };
+
+  /// The pose of one shape of one world object
+  struct ShapeRecord
+  {
+    char object_id[56];          // null-terminated; objects with longer ids are not mirrored
+    std::uint32_t shape_index;   // index of the shape within the object
+    std::uint32_t reserved;
+    std::uint64_t shape_hash;    // geometry fingerprint; readers skip records whose local shape differs
+    double pose[7];              // translation xyz, quaternion xyzw, in the planning frame
+  };
+
+  Header* header() const;
+  double* variables() const;
+  ShapeRecord* shapeRecords() const;
+
+  /** @brief Copy a consistent snapshot out of the segment; returns the epoch it was taken at, 0 on failure */
+  std::uint64_t takeSnapshot(std::vector<double>& variables, std::vector<ShapeRecord>& records) const;
+
+  std::string name_;
+  bool writer_;
+  void* memory_;
+  std::size_t size_;
+
+  /// epoch of the last snapshot applied by readScene()
+  std::uint64_t last_applied_epoch_;
+
+  /// reusable snapshot buffers for readScene()
+  std::vector<double> snapshot_variables_;
+  std::vector<ShapeRecord> snapshot_records_;
+};
+}
+
+#endif
@@ -76,6 +76,29 @@ public:
 
   void setSamplingFrequency(double sampling_frequency);
 
+  std::size_t getSampleBufferCapacity() const
+  {
+    return sample_buffer_capacity_;
+  }
+
+  /** @brief Bound the recorded trajectory to the last \e capacity samples. When a capacity is set, the
+      monitor preallocates \e capacity state slots before recording starts and recycles them in a ring,
+      so steady-state recording performs no allocations; older waypoints are dropped as new ones arrive.
+      A capacity of 0 (the default) keeps the full trajectory and allocates one state per sample.
+      Takes effect the next time the monitor is started. */
+  void setSampleBufferCapacity(std::size_t capacity);
+
+  double getQuiescentSamplingFrequency() const
+  {
+    return quiescent_sampling_frequency_;
+  }
+
+  /** @brief Enable adaptive sampling: while no joint moves between samples, states are recorded at this
+      reduced frequency instead of the regular sampling frequency. The monitor still polls at the regular
+      rate, so recording resumes at full rate within one sampling period once motion is detected.
+      A frequency of 0 (the default) disables adaptive sampling. */
+  void setQuiescentSamplingFrequency(double frequency);
+
   /// Return the current maintained trajectory. This function is not thread safe (hence NOT const), because the
   /// trajectory could be modified.
   const robot_trajectory::RobotTrajectory& getTrajectory()
@@ -98,11 +121,19 @@ private:
 
   CurrentStateMonitorConstPtr current_state_monitor_;
   double sampling_frequency_;
+  std::size_t sample_buffer_capacity_;
+  double quiescent_sampling_frequency_;
 
   robot_trajectory::RobotTrajectory trajectory_;
   ros::Time trajectory_start_time_;
   ros::Time last_recorded_state_time_;
 
+  /// preallocated state slots recycled while recording with a bounded sample buffer
+  std::vector<robot_state::RobotStatePtr> state_pool_;
+  std::size_t state_pool_index_;
+  /// positions of the last recorded sample, used to detect quiescent phases
+  std::vector<double> last_recorded_positions_;
+
   std::unique_ptr<boost::thread> record_states_thread_;
   TrajectoryStateAddedCallback state_add_callback_;
 };
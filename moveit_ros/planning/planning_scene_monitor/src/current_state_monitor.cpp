@@ -39,6 +39,7 @@
 #include <tf2_eigen/tf2_eigen.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 
+#include <cstring>
 #include <limits>
 
 planning_scene_monitor::CurrentStateMonitor::CurrentStateMonitor(const robot_model::RobotModelConstPtr& robot_model,
@@ -57,8 +58,19 @@ planning_scene_monitor::CurrentStateMonitor::CurrentStateMonitor(const robot_mod
   , state_monitor_started_(false)
   , copy_dynamics_(false)
   , error_(std::numeric_limits<double>::epsilon())
+  , batched_updates_(false)
+  , ring_head_(0)
+  , ring_tail_(0)
+  , realtime_latest_slot_(-1)
+  , state_version_(0)
+  , snapshot_version_(0)
 {
   robot_state_.setToDefaultValues();
+  for (int i = 0; i < 3; ++i)
+  {
+    realtime_slots_[i].sequence.store(0);
+    realtime_slots_[i].positions.resize(robot_model_->getVariableCount());
+  }
 }
 
 planning_scene_monitor::CurrentStateMonitor::~CurrentStateMonitor()
@@ -69,13 +81,27 @@ planning_scene_monitor::CurrentStateMonitor::~CurrentStateMonitor()
 robot_state::RobotStatePtr planning_scene_monitor::CurrentStateMonitor::getCurrentState() const
 {
   boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
   robot_state::RobotState* result = new robot_state::RobotState(robot_state_);
   return robot_state::RobotStatePtr(result);
 }
 
+robot_state::RobotStateConstPtr planning_scene_monitor::CurrentStateMonitor::getCurrentStateNoCopy() const
+{
+  boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
+  if (!state_snapshot_ || snapshot_version_ != state_version_)
+  {
+    state_snapshot_.reset(new robot_state::RobotState(robot_state_));
+    snapshot_version_ = state_version_;
+  }
+  return state_snapshot_;
+}
+
 ros::Time planning_scene_monitor::CurrentStateMonitor::getCurrentStateTime() const
 {
   boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
   return current_state_time_;
 }
 
@@ -83,6 +109,7 @@ std::pair<robot_state::RobotStatePtr, ros::Time>
 planning_scene_monitor::CurrentStateMonitor::getCurrentStateAndTime() const
 {
   boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
   robot_state::RobotState* result = new robot_state::RobotState(robot_state_);
   return std::make_pair(robot_state::RobotStatePtr(result), current_state_time_);
 }
@@ -91,6 +118,7 @@ std::map<std::string, double> planning_scene_monitor::CurrentStateMonitor::getCu
 {
   std::map<std::string, double> m;
   boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
   const double* pos = robot_state_.getVariablePositions();
   const std::vector<std::string>& names = robot_state_.getVariableNames();
   for (std::size_t i = 0; i < names.size(); ++i)
@@ -101,6 +129,7 @@ std::map<std::string, double> planning_scene_monitor::CurrentStateMonitor::getCu
 void planning_scene_monitor::CurrentStateMonitor::setToCurrentState(robot_state::RobotState& upd) const
 {
   boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
   const double* pos = robot_state_.getVariablePositions();
   upd.setVariablePositions(pos);
   if (copy_dynamics_)
@@ -134,6 +163,26 @@ void planning_scene_monitor::CurrentStateMonitor::clearUpdateCallbacks()
   update_callbacks_.clear();
 }
 
+void planning_scene_monitor::CurrentStateMonitor::enableBatchedUpdates(bool enabled)
+{
+  boost::mutex::scoped_lock slock(state_update_lock_);
+  if (enabled == batched_updates_)
+    return;
+  if (enabled)
+  {
+    state_ring_.resize(STATE_RING_CAPACITY);
+    ring_head_.store(0);
+    ring_tail_.store(0);
+  }
+  else
+  {
+    // apply whatever is still queued before switching back to immediate updates
+    processPendingStates(slock);
+    state_ring_.clear();
+  }
+  batched_updates_ = enabled;
+}
+
 void planning_scene_monitor::CurrentStateMonitor::startStateMonitor(const std::string& joint_states_topic)
 {
   if (!state_monitor_started_ && robot_model_)
@@ -187,6 +236,7 @@ bool planning_scene_monitor::CurrentStateMonitor::haveCompleteState() const
   bool result = true;
   const std::vector<const moveit::core::JointModel*>& joints = robot_model_->getActiveJointModels();
   boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
   for (const moveit::core::JointModel* joint : joints)
     if (joint_time_.find(joint) == joint_time_.end())
     {
@@ -204,6 +254,7 @@ bool planning_scene_monitor::CurrentStateMonitor::haveCompleteState(std::vector<
   bool result = true;
   const std::vector<const moveit::core::JointModel*>& joints = robot_model_->getActiveJointModels();
   boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
   for (const moveit::core::JointModel* joint : joints)
     if (joint_time_.find(joint) == joint_time_.end())
       if (!joint->isPassive() && !joint->getMimic())
@@ -221,6 +272,7 @@ bool planning_scene_monitor::CurrentStateMonitor::haveCompleteState(const ros::D
   ros::Time now = ros::Time::now();
   ros::Time old = now - age;
   boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
   for (const moveit::core::JointModel* joint : joints)
   {
     if (joint->isPassive() || joint->getMimic())
@@ -249,6 +301,7 @@ bool planning_scene_monitor::CurrentStateMonitor::haveCompleteState(const ros::D
   ros::Time now = ros::Time::now();
   ros::Time old = now - age;
   boost::mutex::scoped_lock slock(state_update_lock_);
+  processPendingStates(slock);
   for (const moveit::core::JointModel* joint : joints)
   {
     if (joint->isPassive() || joint->getMimic())
@@ -278,9 +331,11 @@ bool planning_scene_monitor::CurrentStateMonitor::waitForCurrentState(const ros:
   ros::WallDuration timeout(wait_time);
 
   boost::mutex::scoped_lock lock(state_update_lock_);
+  processPendingStates(lock);
   while (current_state_time_ < t)
   {
     state_update_condition_.wait_for(lock, boost::chrono::nanoseconds((timeout - elapsed).toNSec()));
+    processPendingStates(lock);
     elapsed = ros::WallTime::now() - start;
     if (elapsed > timeout)
     {
@@ -333,70 +388,173 @@ bool planning_scene_monitor::CurrentStateMonitor::waitForCompleteState(const std
   return ok;
 }
 
-void planning_scene_monitor::CurrentStateMonitor::jointStateCallback(const sensor_msgs::JointStateConstPtr& joint_state)
+bool planning_scene_monitor::CurrentStateMonitor::applyJointState(const sensor_msgs::JointState& joint_state) const
 {
-  if (joint_state->name.size() != joint_state->position.size())
-  {
-    ROS_ERROR_THROTTLE(1, "State monitor received invalid joint state (number of joint names does not match number of "
-                          "positions)");
-    return;
-  }
   bool update = false;
 
+  // read the received values, and update their time stamps
+  std::size_t n = joint_state.name.size();
+  current_state_time_ = joint_state.header.stamp;
+  for (std::size_t i = 0; i < n; ++i)
   {
-    boost::mutex::scoped_lock _(state_update_lock_);
-    // read the received values, and update their time stamps
-    std::size_t n = joint_state->name.size();
-    current_state_time_ = joint_state->header.stamp;
-    for (std::size_t i = 0; i < n; ++i)
-    {
-      const moveit::core::JointModel* jm = robot_model_->getJointModel(joint_state->name[i]);
-      if (!jm)
-        continue;
-      // ignore fixed joints, multi-dof joints (they should not even be in the message)
-      if (jm->getVariableCount() != 1)
-        continue;
+    const moveit::core::JointModel* jm = robot_model_->getJointModel(joint_state.name[i]);
+    if (!jm)
+      continue;
+    // ignore fixed joints, multi-dof joints (they should not even be in the message)
+    if (jm->getVariableCount() != 1)
+      continue;
 
-      joint_time_[jm] = joint_state->header.stamp;
+    joint_time_[jm] = joint_state.header.stamp;
 
-      if (robot_state_.getJointPositions(jm)[0] != joint_state->position[i])
-      {
-        update = true;
-        robot_state_.setJointPositions(jm, &(joint_state->position[i]));
+    if (robot_state_.getJointPositions(jm)[0] != joint_state.position[i])
+    {
+      update = true;
+      robot_state_.setJointPositions(jm, &(joint_state.position[i]));
 
-        // optionally copy velocities and effort
-        if (copy_dynamics_)
+      // optionally copy velocities and effort
+      if (copy_dynamics_)
+      {
+        // check if velocities exist
+        if (joint_state.name.size() == joint_state.velocity.size())
         {
-          // check if velocities exist
-          if (joint_state->name.size() == joint_state->velocity.size())
-          {
-            robot_state_.setJointVelocities(jm, &(joint_state->velocity[i]));
+          robot_state_.setJointVelocities(jm, &(joint_state.velocity[i]));
 
-            // check if effort exist. assume they are not useful if no velocities were passed in
-            if (joint_state->name.size() == joint_state->effort.size())
-            {
-              robot_state_.setJointEfforts(jm, &(joint_state->effort[i]));
-            }
+          // check if effort exist. assume they are not useful if no velocities were passed in
+          if (joint_state.name.size() == joint_state.effort.size())
+          {
+            robot_state_.setJointEfforts(jm, &(joint_state.effort[i]));
           }
         }
+      }
 
-        // continuous joints wrap, so we don't modify them (even if they are outside bounds!)
-        if (jm->getType() == moveit::core::JointModel::REVOLUTE)
-          if (static_cast<const moveit::core::RevoluteJointModel*>(jm)->isContinuous())
-            continue;
+      // continuous joints wrap, so we don't modify them (even if they are outside bounds!)
+      if (jm->getType() == moveit::core::JointModel::REVOLUTE)
+        if (static_cast<const moveit::core::RevoluteJointModel*>(jm)->isContinuous())
+          continue;
 
-        const robot_model::VariableBounds& b =
-            jm->getVariableBounds()[0];  // only one variable in the joint, so we get its bounds
+      const robot_model::VariableBounds& b =
+          jm->getVariableBounds()[0];  // only one variable in the joint, so we get its bounds
 
-        // if the read variable is 'almost' within bounds (up to error_ difference), then consider it to be within
-        // bounds
-        if (joint_state->position[i] < b.min_position_ && joint_state->position[i] >= b.min_position_ - error_)
-          robot_state_.setJointPositions(jm, &b.min_position_);
-        else if (joint_state->position[i] > b.max_position_ && joint_state->position[i] <= b.max_position_ + error_)
-          robot_state_.setJointPositions(jm, &b.max_position_);
-      }
+      // if the read variable is 'almost' within bounds (up to error_ difference), then consider it to be within
+      // bounds
+      if (joint_state.position[i] < b.min_position_ && joint_state.position[i] >= b.min_position_ - error_)
+        robot_state_.setJointPositions(jm, &b.min_position_);
+      else if (joint_state.position[i] > b.max_position_ && joint_state.position[i] <= b.max_position_ + error_)
+        robot_state_.setJointPositions(jm, &b.max_position_);
     }
   }
+  if (update)
+  {
+    ++state_version_;
+    publishRealtimeState();
+  }
+  return update;
+}
+
+void planning_scene_monitor::CurrentStateMonitor::publishRealtimeState() const
+{
+  // state_update_lock_ is held, so we are the only writer; readers never
+  // block us. Write into the slot after the most recently published one.
+  const int latest = realtime_latest_slot_.load(std::memory_order_relaxed);
+  const int next = (latest + 1) % 3;
+  RealtimeStateSlot& slot = realtime_slots_[next];
+  const std::uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+  // odd sequence marks the slot as being written
+  slot.sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::memcpy(&slot.positions[0], robot_state_.getVariablePositions(), slot.positions.size() * sizeof(double));
+  slot.stamp = current_state_time_;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  slot.sequence.store(seq + 2, std::memory_order_relaxed);
+  realtime_latest_slot_.store(next, std::memory_order_release);
+}
+
+bool planning_scene_monitor::CurrentStateMonitor::copyCurrentStateRealtime(double* variable_positions,
+                                                                           std::size_t count, ros::Time& stamp) const
+{
+  if (count != robot_model_->getVariableCount())
+    return false;
+  // with three slots a reader that keeps up never observes a torn slot;
+  // the retry bound only guards against a reader stalled mid-copy for
+  // two or more full writer updates
+  for (int attempt = 0; attempt < 16; ++attempt)
+  {
+    const int latest = realtime_latest_slot_.load(std::memory_order_acquire);
+    if (latest < 0)
+      return false;  // no state received yet
+    const RealtimeStateSlot& slot = realtime_slots_[latest];
+    const std::uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+    if (seq & 1)
+      continue;
+    std::memcpy(variable_positions, &slot.positions[0], count * sizeof(double));
+    stamp = slot.stamp;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == seq)
+      return true;
+  }
+  return false;
+}
+
+void planning_scene_monitor::CurrentStateMonitor::processPendingStates(boost::mutex::scoped_lock& lock) const
+{
+  if (!batched_updates_)
+    return;
+  std::size_t tail = ring_tail_.load(std::memory_order_relaxed);
+  const std::size_t head = ring_head_.load(std::memory_order_acquire);
+  if (tail == head)
+    return;
+  std::vector<sensor_msgs::JointStateConstPtr> updated;
+  for (; tail != head; ++tail)
+  {
+    sensor_msgs::JointStateConstPtr joint_state;
+    joint_state.swap(state_ring_[tail % STATE_RING_CAPACITY]);
+    if (applyJointState(*joint_state) && !update_callbacks_.empty())
+      updated.push_back(joint_state);
+  }
+  ring_tail_.store(tail, std::memory_order_release);
+
+  // invoke update callbacks without holding the state lock, as they may read the state themselves
+  if (!updated.empty())
+  {
+    lock.unlock();
+    for (std::size_t i = 0; i < updated.size(); ++i)
+      for (std::size_t j = 0; j < update_callbacks_.size(); ++j)
+        update_callbacks_[j](updated[i]);
+    lock.lock();
+  }
+}
+
+void planning_scene_monitor::CurrentStateMonitor::jointStateCallback(const sensor_msgs::JointStateConstPtr& joint_state)
+{
+  if (joint_state->name.size() != joint_state->position.size())
+  {
+    ROS_ERROR_THROTTLE(1, "State monitor received invalid joint state (number of joint names does not match number of "
+                          "positions)");
+    return;
+  }
+
+  if (batched_updates_)
+  {
+    const std::size_t head = ring_head_.load(std::memory_order_relaxed);
+    if (head - ring_tail_.load(std::memory_order_acquire) < STATE_RING_CAPACITY)
+    {
+      state_ring_[head % STATE_RING_CAPACITY] = joint_state;
+      ring_head_.store(head + 1, std::memory_order_release);
+      // readers drain the ring themselves; just wake up waitForCurrentState()
+      state_update_condition_.notify_all();
+      return;
+    }
+    // the ring is full (no reader is keeping up), so fall through to the locked path below,
+    // which first drains the ring to preserve message order
+  }
+
+  bool update = false;
+
+  {
+    boost::mutex::scoped_lock lock(state_update_lock_);
+    processPendingStates(lock);
+    update = applyJointState(*joint_state);
+  }
 
   // callbacks, if needed
   if (update)
@@ -460,6 +618,11 @@ void planning_scene_monitor::CurrentStateMonitor::tfCallback()
       robot_state_.setJointPositions(joint, new_values);
       update = true;
     }
+    if (update)
+    {
+      ++state_version_;
+      publishRealtimeState();
+    }
   }
 
   // callbacks, if needed
@@ -237,11 +237,13 @@ void PlanningSceneMonitor::initialize(const planning_scene::PlanningScenePtr& sc
   }
 
   publish_planning_scene_frequency_ = 2.0;
+  full_scene_keyframe_interval_ = 0;
   new_scene_update_ = UPDATE_NONE;
 
   last_update_time_ = last_robot_motion_time_ = ros::Time::now();
   last_robot_state_update_wall_time_ = ros::WallTime::now();
   dt_state_update_ = ros::WallDuration(0.1);
+  low_latency_state_updates_ = false;
 
   double temp_wait_time = 0.05;
 
@@ -250,11 +252,39 @@ void PlanningSceneMonitor::initialize(const planning_scene::PlanningScenePtr& sc
 
   shape_transform_cache_lookup_wait_time_ = ros::Duration(temp_wait_time);
 
+  octomap_exclusion_budget_ = 0.0;
+  if (!robot_description_.empty())
+    nh_.param(robot_description_ + "_planning/octomap_exclusion_budget", octomap_exclusion_budget_,
+              octomap_exclusion_budget_);
+
   state_update_pending_ = false;
   state_update_timer_ = nh_.createWallTimer(dt_state_update_, &PlanningSceneMonitor::stateUpdateTimerCallback, this,
                                             false,   // not a oneshot timer
                                             false);  // do not start the timer yet
 
+  shared_scene_writer_ = false;
+  double shared_scene_poll_frequency = 30.0;
+  if (!robot_description_.empty())
+  {
+    nh_.param(robot_description_ + "_planning/shared_scene_segment", shared_scene_name_, std::string());
+    nh_.param(robot_description_ + "_planning/shared_scene_writer", shared_scene_writer_, false);
+    nh_.param(robot_description_ + "_planning/shared_scene_poll_frequency", shared_scene_poll_frequency,
+              shared_scene_poll_frequency);
+  }
+  if (!shared_scene_name_.empty())
+  {
+    if (shared_scene_writer_)
+    {
+      shared_scene_segment_.reset(new SharedSceneSegment(shared_scene_name_, true));
+      if (!shared_scene_segment_->isValid())
+        shared_scene_segment_.reset();
+    }
+    else if (shared_scene_poll_frequency > 0.0)
+      // the segment itself is attached lazily in the timer callback, since the writer may start later
+      shared_scene_read_timer_ = nh_.createWallTimer(ros::WallDuration(1.0 / shared_scene_poll_frequency),
+                                                     &PlanningSceneMonitor::sharedSceneReadTimerCallback, this);
+  }
+
   reconfigure_impl_ = new DynamicReconfigureImpl(this);
 }
 
@@ -337,18 +367,15 @@ void PlanningSceneMonitor::scenePublishingThread()
   ROS_DEBUG_NAMED(LOGNAME, "Started scene publishing thread ...");
 
   // publish the full planning scene once
+  // (the octree in the scene is an immutable snapshot, so it is not locked here)
   {
     moveit_msgs::PlanningScene msg;
-    {
-      occupancy_map_monitor::OccMapTree::ReadLock lock;
-      if (octomap_monitor_)
-        lock = octomap_monitor_->getOcTreePtr()->reading();
-      scene_->getPlanningSceneMsg(msg);
-    }
+    scene_->getPlanningSceneMsg(msg);
     planning_scene_publisher_.publish(msg);
     ROS_DEBUG_NAMED(LOGNAME, "Published the full planning scene: '%s'", msg.name.c_str());
   }
 
+  unsigned int diffs_since_full_scene = 0;
   do
   {
     moveit_msgs::PlanningScene msg;
@@ -363,15 +390,13 @@ void PlanningSceneMonitor::scenePublishingThread()
       {
         if ((publish_update_types_ & new_scene_update_) || new_scene_update_ == UPDATE_SCENE)
         {
-          if (new_scene_update_ == UPDATE_SCENE)
+          // periodically publish a keyframe (full scene), so subscribers on lossy links resync
+          if (new_scene_update_ == UPDATE_SCENE ||
+              (full_scene_keyframe_interval_ && diffs_since_full_scene >= full_scene_keyframe_interval_))
             is_full = true;
           else
-          {
-            occupancy_map_monitor::OccMapTree::ReadLock lock;
-            if (octomap_monitor_)
-              lock = octomap_monitor_->getOcTreePtr()->reading();
             scene_->getPlanningSceneDiffMsg(msg);
-          }
+          diffs_since_full_scene = is_full ? 0 : diffs_since_full_scene + 1;
           boost::recursive_mutex::scoped_lock prevent_shape_cache_updates(shape_handles_lock_);  // we don't want the
                                                                                                  // transform cache to
                                                                                                  // update while we are
@@ -391,12 +416,7 @@ void PlanningSceneMonitor::scenePublishingThread()
             excludeWorldObjectsFromOctree();    // in case updates have happened to the attached bodies, put them in
           }
           if (is_full)
-          {
-            occupancy_map_monitor::OccMapTree::ReadLock lock;
-            if (octomap_monitor_)
-              lock = octomap_monitor_->getOcTreePtr()->reading();
             scene_->getPlanningSceneMsg(msg);
-          }
           // also publish timestamp of this robot_state
           msg.robot_state.joint_state.header.stamp = last_robot_motion_time_;
           publish_msg = true;
@@ -455,11 +475,45 @@ bool PlanningSceneMonitor::updatesScene(const planning_scene::PlanningSceneConst
   return sceneIsParentOf(scene_const_, scene.get());
 }
 
+planning_scene::PlanningSceneConstPtr PlanningSceneMonitor::getSceneSnapshot()
+{
+  const std::uint64_t version = scene_version_.load(std::memory_order_acquire);
+  {
+    boost::mutex::scoped_lock slock(scene_snapshot_lock_);
+    if (scene_snapshot_ && scene_snapshot_version_ == version)
+      return scene_snapshot_;
+  }
+
+  // the cached snapshot is stale; clone the scene under the read lock. if an update races with the
+  // clone, the cached entry keeps the older version stamp and the next call re-clones.
+  planning_scene::PlanningSceneConstPtr snapshot;
+  {
+    lockSceneRead();
+    snapshot = planning_scene::PlanningScene::clone(scene_const_);
+    unlockSceneRead();
+  }
+
+  boost::mutex::scoped_lock slock(scene_snapshot_lock_);
+  scene_snapshot_ = snapshot;
+  scene_snapshot_version_ = version;
+  return snapshot;
+}
+
 void PlanningSceneMonitor::triggerSceneUpdateEvent(SceneUpdateType update_type)
 {
   // do not modify update functions while we are calling them
   boost::recursive_mutex::scoped_lock lock(update_lock_);
 
+  scene_version_.fetch_add(1, std::memory_order_release);
+
+  // refresh the shared-memory mirror of the scene; state-only updates skip the world sweep
+  if (shared_scene_segment_ && shared_scene_segment_->isWriter() && update_type != UPDATE_NONE)
+  {
+    lockSceneRead();
+    shared_scene_segment_->writeScene(*scene_, (update_type & UPDATE_GEOMETRY) != 0);
+    unlockSceneRead();
+  }
+
   for (std::size_t i = 0; i < update_callbacks_.size(); ++i)
     update_callbacks_[i](update_type);
   new_scene_update_ = (SceneUpdateType)((int)new_scene_update_ | (int)update_type);
@@ -508,6 +562,8 @@ void PlanningSceneMonitor::clearOctomap()
   octomap_monitor_->getOcTreePtr()->lockWrite();
   octomap_monitor_->getOcTreePtr()->clear();
   octomap_monitor_->getOcTreePtr()->unlockWrite();
+  // refresh the snapshot the scene reads from, so the cleared map is visible right away
+  octomap_monitor_->getOcTreePtr()->triggerUpdateCallback();
 }
 
 bool PlanningSceneMonitor::newPlanningSceneMessage(const moveit_msgs::PlanningScene& scene)
@@ -714,18 +770,59 @@ void PlanningSceneMonitor::includeAttachedBodiesInOctree()
     for (std::size_t k = 0; k < it->second.size(); ++k)
       octomap_monitor_->forgetShape(it->second[k].first);
   attached_body_shape_handles_.clear();
+  excluded_attached_bodies_.clear();
+  for (std::deque<PendingOctreeExclusion>::iterator it = pending_octree_exclusions_.begin();
+       it != pending_octree_exclusions_.end();)
+    if (it->attached_body)
+      it = pending_octree_exclusions_.erase(it);
+    else
+      ++it;
 }
 
 void PlanningSceneMonitor::excludeAttachedBodiesFromOctree()
 {
+  if (!octomap_monitor_)
+    return;
+
   boost::recursive_mutex::scoped_lock _(shape_handles_lock_);
 
-  includeAttachedBodiesInOctree();
-  // add attached objects again
   std::vector<const robot_state::AttachedBody*> ab;
   scene_->getCurrentState().getAttachedBodies(ab);
+  std::map<std::string, const robot_state::AttachedBody*> current;
   for (std::size_t i = 0; i < ab.size(); ++i)
-    excludeAttachedBodyFromOctree(ab[i]);
+    current[ab[i]->getName()] = ab[i];
+
+  // drop the exclusions of bodies that are gone or whose shapes changed; bodies that merely moved keep
+  // their handles, since poses are looked up through the transform cache at filtering time
+  for (std::map<std::string, ExcludedBodyShapes>::iterator it = excluded_attached_bodies_.begin();
+       it != excluded_attached_bodies_.end();)
+  {
+    std::map<std::string, const robot_state::AttachedBody*>::const_iterator body = current.find(it->first);
+    if (body == current.end() || body->second->getShapes() != it->second.shapes)
+    {
+      for (std::size_t k = 0; k < it->second.handles.size(); ++k)
+        octomap_monitor_->forgetShape(it->second.handles[k].first);
+      excluded_attached_bodies_.erase(it++);
+    }
+    else
+      ++it;
+  }
+
+  // queue the bodies that still need excluding; attached bodies are at the robot, so they sort ahead of
+  // any queued world objects
+  for (std::map<std::string, const robot_state::AttachedBody*>::const_iterator it = current.begin();
+       it != current.end(); ++it)
+    if (excluded_attached_bodies_.find(it->first) == excluded_attached_bodies_.end())
+      queueOctreeExclusion(true, it->first, 0.0);
+
+  // the transform cache refers to attached bodies by pointer; re-key the handle map to the current
+  // instances, since a scene diff push may have recreated the bodies
+  attached_body_shape_handles_.clear();
+  for (std::map<std::string, ExcludedBodyShapes>::const_iterator it = excluded_attached_bodies_.begin();
+       it != excluded_attached_bodies_.end(); ++it)
+    attached_body_shape_handles_[current[it->first]] = it->second.handles;
+
+  processPendingOctreeExclusions();
 }
 
 void PlanningSceneMonitor::includeWorldObjectsInOctree()
@@ -741,16 +838,63 @@ void PlanningSceneMonitor::includeWorldObjectsInOctree()
     for (std::size_t k = 0; k < it->second.size(); ++k)
       octomap_monitor_->forgetShape(it->second[k].first);
   collision_body_shape_handles_.clear();
+  excluded_world_objects_.clear();
+  for (std::deque<PendingOctreeExclusion>::iterator it = pending_octree_exclusions_.begin();
+       it != pending_octree_exclusions_.end();)
+    if (it->attached_body)
+      ++it;
+    else
+      it = pending_octree_exclusions_.erase(it);
 }
 
 void PlanningSceneMonitor::excludeWorldObjectsFromOctree()
 {
+  if (!octomap_monitor_)
+    return;
+
   boost::recursive_mutex::scoped_lock _(shape_handles_lock_);
 
-  includeWorldObjectsInOctree();
-  for (collision_detection::World::const_iterator it = scene_->getWorld()->begin(); it != scene_->getWorld()->end();
-       ++it)
-    excludeWorldObjectFromOctree(it->second);
+  const collision_detection::WorldConstPtr& world = scene_->getWorld();
+
+  // drop the exclusions of objects that are gone or whose shapes changed
+  for (std::map<std::string, ExcludedBodyShapes>::iterator it = excluded_world_objects_.begin();
+       it != excluded_world_objects_.end();)
+  {
+    collision_detection::World::ObjectConstPtr obj = world->getObject(it->first);
+    if (!obj || obj->shapes_ != it->second.shapes)
+    {
+      for (std::size_t k = 0; k < it->second.handles.size(); ++k)
+        octomap_monitor_->forgetShape(it->second.handles[k].first);
+      excluded_world_objects_.erase(it++);
+    }
+    else
+      ++it;
+  }
+
+  // queue the objects that still need excluding, closest to the robot first; the planning frame origin
+  // is the robot base, which is close enough for ordering purposes
+  for (collision_detection::World::const_iterator it = world->begin(); it != world->end(); ++it)
+    if (excluded_world_objects_.find(it->first) == excluded_world_objects_.end())
+    {
+      double distance = 0.0;
+      if (!it->second->shape_poses_.empty())
+        distance = it->second->shape_poses_[0].translation().squaredNorm();
+      queueOctreeExclusion(false, it->first, distance);
+    }
+
+  // the transform cache refers to the objects' pose storage by pointer; refresh those pointers, since a
+  // scene diff push may have recreated the objects
+  collision_body_shape_handles_.clear();
+  for (std::map<std::string, ExcludedBodyShapes>::const_iterator it = excluded_world_objects_.begin();
+       it != excluded_world_objects_.end(); ++it)
+  {
+    collision_detection::World::ObjectConstPtr obj = world->getObject(it->first);
+    for (std::size_t k = 0; k < it->second.handles.size(); ++k)
+      collision_body_shape_handles_[it->first].push_back(
+          std::make_pair(it->second.handles[k].first, &obj->shape_poses_[it->second.handles[k].second]));
+  }
+
+  processPendingOctreeExclusions();
 }
 
 void PlanningSceneMonitor::excludeAttachedBodyFromOctree(const robot_state::AttachedBody* attached_body)
@@ -759,6 +903,24 @@ void PlanningSceneMonitor::excludeAttachedBodyFromOctree(const robot_state::Atta
     return;
 
   boost::recursive_mutex::scoped_lock _(shape_handles_lock_);
+
+  std::map<std::string, ExcludedBodyShapes>::iterator old = excluded_attached_bodies_.find(attached_body->getName());
+  if (old != excluded_attached_bodies_.end())
+  {
+    if (old->second.shapes == attached_body->getShapes())
+    {
+      // already excluded (e.g. both queued and updated directly); just make sure the transform cache
+      // maps the current body instance
+      attached_body_shape_handles_[attached_body] = old->second.handles;
+      return;
+    }
+    for (std::size_t k = 0; k < old->second.handles.size(); ++k)
+      octomap_monitor_->forgetShape(old->second.handles[k].first);
+    excluded_attached_bodies_.erase(old);
+  }
+
+  ExcludedBodyShapes& record = excluded_attached_bodies_[attached_body->getName()];
+  record.shapes = attached_body->getShapes();
   bool found = false;
   for (std::size_t i = 0; i < attached_body->getShapes().size(); ++i)
   {
@@ -768,6 +930,7 @@ void PlanningSceneMonitor::excludeAttachedBodyFromOctree(const robot_state::Atta
     if (h)
     {
       found = true;
+      record.handles.push_back(std::make_pair(h, i));
       attached_body_shape_handles_[attached_body].push_back(std::make_pair(h, i));
     }
   }
@@ -790,6 +953,14 @@ void PlanningSceneMonitor::includeAttachedBodyInOctree(const robot_state::Attach
     ROS_DEBUG_NAMED(LOGNAME, "Including attached body '%s' in monitored octomap", attached_body->getName().c_str());
     attached_body_shape_handles_.erase(it);
   }
+  excluded_attached_bodies_.erase(attached_body->getName());
+  for (std::deque<PendingOctreeExclusion>::iterator pending = pending_octree_exclusions_.begin();
+       pending != pending_octree_exclusions_.end(); ++pending)
+    if (pending->attached_body && pending->id == attached_body->getName())
+    {
+      pending_octree_exclusions_.erase(pending);
+      break;
+    }
 }
 
 void PlanningSceneMonitor::excludeWorldObjectFromOctree(const collision_detection::World::ObjectConstPtr& obj)
@@ -799,6 +970,26 @@ void PlanningSceneMonitor::excludeWorldObjectFromOctree(const collision_detectio
 
   boost::recursive_mutex::scoped_lock _(shape_handles_lock_);
 
+  std::map<std::string, ExcludedBodyShapes>::iterator old = excluded_world_objects_.find(obj->id_);
+  if (old != excluded_world_objects_.end())
+  {
+    if (old->second.shapes == obj->shapes_)
+    {
+      // already excluded; just refresh the pose pointers the transform cache reads, since the object
+      // instance may have been recreated
+      collision_body_shape_handles_.erase(obj->id_);
+      for (std::size_t k = 0; k < old->second.handles.size(); ++k)
+        collision_body_shape_handles_[obj->id_].push_back(
+            std::make_pair(old->second.handles[k].first, &obj->shape_poses_[old->second.handles[k].second]));
+      return;
+    }
+    for (std::size_t k = 0; k < old->second.handles.size(); ++k)
+      octomap_monitor_->forgetShape(old->second.handles[k].first);
+    excluded_world_objects_.erase(old);
+  }
+
+  ExcludedBodyShapes& record = excluded_world_objects_[obj->id_];
+  record.shapes = obj->shapes_;
   bool found = false;
   for (std::size_t i = 0; i < obj->shapes_.size(); ++i)
   {
@@ -807,6 +998,7 @@ void PlanningSceneMonitor::excludeWorldObjectFromOctree(const collision_detectio
     occupancy_map_monitor::ShapeHandle h = octomap_monitor_->excludeShape(obj->shapes_[i]);
     if (h)
     {
+      record.handles.push_back(std::make_pair(h, i));
       collision_body_shape_handles_[obj->id_].push_back(std::make_pair(h, &obj->shape_poses_[i]));
       found = true;
     }
@@ -830,6 +1022,67 @@ void PlanningSceneMonitor::includeWorldObjectInOctree(const collision_detection:
     ROS_DEBUG_NAMED(LOGNAME, "Including collision object '%s' in monitored octomap", obj->id_.c_str());
     collision_body_shape_handles_.erase(it);
   }
+  excluded_world_objects_.erase(obj->id_);
+  for (std::deque<PendingOctreeExclusion>::iterator pending = pending_octree_exclusions_.begin();
+       pending != pending_octree_exclusions_.end(); ++pending)
+    if (!pending->attached_body && pending->id == obj->id_)
+    {
+      pending_octree_exclusions_.erase(pending);
+      break;
+    }
+}
+
+void PlanningSceneMonitor::queueOctreeExclusion(bool attached_body, const std::string& id, double distance)
+{
+  boost::recursive_mutex::scoped_lock _(shape_handles_lock_);
+
+  for (std::deque<PendingOctreeExclusion>::const_iterator it = pending_octree_exclusions_.begin();
+       it != pending_octree_exclusions_.end(); ++it)
+    if (it->attached_body == attached_body && it->id == id)
+      return;
+
+  PendingOctreeExclusion pending;
+  pending.attached_body = attached_body;
+  pending.id = id;
+  pending.distance = distance;
+  std::deque<PendingOctreeExclusion>::iterator pos = pending_octree_exclusions_.begin();
+  while (pos != pending_octree_exclusions_.end() && pos->distance <= distance)
+    ++pos;
+  pending_octree_exclusions_.insert(pos, pending);
+}
+
+void PlanningSceneMonitor::processPendingOctreeExclusions()
+{
+  if (!octomap_monitor_)
+    return;
+
+  boost::recursive_mutex::scoped_lock _(shape_handles_lock_);
+
+  ros::WallTime start = ros::WallTime::now();
+  while (!pending_octree_exclusions_.empty())
+  {
+    PendingOctreeExclusion pending = pending_octree_exclusions_.front();
+    pending_octree_exclusions_.pop_front();
+    if (pending.attached_body)
+    {
+      // bodies that went away between queueing and processing are simply dropped
+      if (scene_->getCurrentState().hasAttachedBody(pending.id))
+        excludeAttachedBodyFromOctree(scene_->getCurrentState().getAttachedBody(pending.id));
+    }
+    else
+    {
+      collision_detection::World::ObjectConstPtr obj = scene_->getWorld()->getObject(pending.id);
+      if (obj)
+        excludeWorldObjectFromOctree(obj);
+    }
+    if (octomap_exclusion_budget_ > 0.0 && !pending_octree_exclusions_.empty() &&
+        (ros::WallTime::now() - start).toSec() > octomap_exclusion_budget_)
+    {
+      ROS_DEBUG_NAMED(LOGNAME, "Octomap exclusion budget spent; %zu bodies deferred to the next update cycle",
+                      pending_octree_exclusions_.size());
+      break;
+    }
+  }
 }
 
 void PlanningSceneMonitor::currentStateAttachedBodyUpdateCallback(robot_state::AttachedBody* attached_body,
@@ -922,29 +1175,23 @@ bool PlanningSceneMonitor::waitForCurrentRobotState(const ros::Time& t, double w
 
 void PlanningSceneMonitor::lockSceneRead()
 {
+  // the octree referenced by the scene is an immutable snapshot (see octomapUpdateCallback),
+  // so the live tree of the octomap monitor does not need to be locked along with the scene
   scene_update_mutex_.lock_shared();
-  if (octomap_monitor_)
-    octomap_monitor_->getOcTreePtr()->lockRead();
 }
 
 void PlanningSceneMonitor::unlockSceneRead()
 {
-  if (octomap_monitor_)
-    octomap_monitor_->getOcTreePtr()->unlockRead();
   scene_update_mutex_.unlock_shared();
 }
 
 void PlanningSceneMonitor::lockSceneWrite()
 {
   scene_update_mutex_.lock();
-  if (octomap_monitor_)
-    octomap_monitor_->getOcTreePtr()->lockWrite();
 }
 
 void PlanningSceneMonitor::unlockSceneWrite()
 {
-  if (octomap_monitor_)
-    octomap_monitor_->getOcTreePtr()->unlockWrite();
   scene_update_mutex_.unlock();
 }
 
@@ -1139,8 +1386,18 @@ void PlanningSceneMonitor::stopStateMonitor()
   }
 }
 
-void PlanningSceneMonitor::onStateUpdate(const sensor_msgs::JointStateConstPtr& /* joint_state */)
+void PlanningSceneMonitor::onStateUpdate(const sensor_msgs::JointStateConstPtr& joint_state)
 {
+  // fast path: patch the joint positions of the message directly into the scene state, without
+  // throttling and without copying the full monitored state. Messages that carry no joint values
+  // (e.g. the stub messages generated for multi-DOF joint updates) take the regular path below.
+  if (low_latency_state_updates_ && joint_state && !joint_state->name.empty() &&
+      joint_state->name.size() == joint_state->position.size())
+  {
+    updateSceneWithJointStates(*joint_state);
+    return;
+  }
+
   const ros::WallTime& n = ros::WallTime::now();
   ros::WallDuration dt = n - last_robot_state_update_wall_time_;
 
@@ -1195,26 +1452,58 @@ void PlanningSceneMonitor::stateUpdateTimerCallback(const ros::WallTimerEvent& e
   }
 }
 
+void PlanningSceneMonitor::sharedSceneReadTimerCallback(const ros::WallTimerEvent& /*event*/)
+{
+  if (!shared_scene_segment_)
+  {
+    // the writer may not have created the segment yet; keep trying
+    SharedSceneSegmentPtr segment(new SharedSceneSegment(shared_scene_name_, false));
+    if (!segment->isValid())
+      return;
+    shared_scene_segment_ = segment;
+    ROS_INFO_NAMED(LOGNAME, "Attached to shared scene segment '%s'", shared_scene_name_.c_str());
+  }
+
+  bool robot_state_changed = false;
+  bool geometry_changed = false;
+  {
+    boost::unique_lock<boost::shared_mutex> ulock(scene_update_mutex_);
+    if (shared_scene_segment_->readScene(*scene_, robot_state_changed, geometry_changed))
+    {
+      last_update_time_ = ros::Time::now();
+      if (robot_state_changed)
+        last_robot_motion_time_ = last_update_time_;
+    }
+  }
+
+  SceneUpdateType update_type = UPDATE_NONE;
+  if (robot_state_changed)
+    update_type = UPDATE_STATE;
+  if (geometry_changed)
+    update_type = (SceneUpdateType)((int)update_type | (int)UPDATE_GEOMETRY);
+  if (update_type != UPDATE_NONE)
+    triggerSceneUpdateEvent(update_type);
+}
+
 void PlanningSceneMonitor::octomapUpdateCallback()
 {
   if (!octomap_monitor_)
     return;
 
+  // continue any exclusion work deferred when the per-cycle budget ran out
+  processPendingOctreeExclusions();
+
   updateFrameTransforms();
+  // hand the scene the latest read-only snapshot of the octree; the snapshot is never written
+  // to again, so neither the scene nor its readers need to lock the live tree the sensor
+  // updaters write to
+  occupancy_map_monitor::OccMapTreeConstPtr snapshot = octomap_monitor_->getOcTreeSnapshotPtr();
+  if (!snapshot)
+    return;
   {
     boost::unique_lock<boost::shared_mutex> ulock(scene_update_mutex_);
     last_update_time_ = ros::Time::now();
-    octomap_monitor_->getOcTreePtr()->lockRead();
-    try
-    {
-      scene_->processOctomapPtr(octomap_monitor_->getOcTreePtr(), Eigen::Isometry3d::Identity());
-      octomap_monitor_->getOcTreePtr()->unlockRead();
-    }
-    catch (...)
-    {
-      octomap_monitor_->getOcTreePtr()->unlockRead();  // unlock and rethrow
-      throw;
-    }
+    scene_->processOctomapPtr(snapshot, Eigen::Isometry3d::Identity());
   }
   triggerSceneUpdateEvent(UPDATE_GEOMETRY);
 }
@@ -1270,6 +1559,48 @@ void PlanningSceneMonitor::updateSceneWithCurrentState()
     ROS_ERROR_THROTTLE_NAMED(1, LOGNAME, "State monitor is not active. Unable to set the planning scene state");
 }
 
+void PlanningSceneMonitor::setLowLatencyStateUpdates(bool flag)
+{
+  low_latency_state_updates_ = flag;
+  ROS_INFO_NAMED(LOGNAME, "%s low-latency robot state updates", flag ? "Enabled" : "Disabled");
+}
+
+void PlanningSceneMonitor::updateSceneWithJointStates(const sensor_msgs::JointState& joint_state)
+{
+  const double error = current_state_monitor_ ? current_state_monitor_->getBoundsError() : 0.0;
+  {
+    boost::unique_lock<boost::shared_mutex> ulock(scene_update_mutex_);
+    last_update_time_ = last_robot_motion_time_ = joint_state.header.stamp;
+    robot_state::RobotState& state = scene_->getCurrentStateNonConst();
+    for (std::size_t i = 0; i < joint_state.name.size(); ++i)
+    {
+      const moveit::core::JointModel* jm = getRobotModel()->getJointModel(joint_state.name[i]);
+      if (!jm)
+        continue;
+      // ignore fixed joints, multi-dof joints (they should not even be in the message)
+      if (jm->getVariableCount() != 1)
+        continue;
+
+      state.setJointPositions(jm, &joint_state.position[i]);
+
+      // continuous joints wrap, so we don't modify them (even if they are outside bounds!)
+      if (jm->getType() == moveit::core::JointModel::REVOLUTE)
+        if (static_cast<const moveit::core::RevoluteJointModel*>(jm)->isContinuous())
+          continue;
+
+      // mirror the bounds handling of CurrentStateMonitor: a value that is 'almost' within
+      // bounds (up to the monitor's bounds error) is clamped to the bound
+      const robot_model::VariableBounds& b = jm->getVariableBounds()[0];
+      if (joint_state.position[i] < b.min_position_ && joint_state.position[i] >= b.min_position_ - error)
+        state.setJointPositions(jm, &b.min_position_);
+      else if (joint_state.position[i] > b.max_position_ && joint_state.position[i] <= b.max_position_ + error)
+        state.setJointPositions(jm, &b.max_position_);
+    }
+    state.update();  // compute all transforms
+  }
+  triggerSceneUpdateEvent(UPDATE_STATE);
+}
+
 void PlanningSceneMonitor::addUpdateCallback(const boost::function<void(SceneUpdateType)>& fn)
 {
   boost::recursive_mutex::scoped_lock lock(update_lock_);
@@ -1290,6 +1621,15 @@ void PlanningSceneMonitor::setPlanningScenePublishingFrequency(double hz)
                   publish_planning_scene_frequency_);
 }
 
+void PlanningSceneMonitor::setFullSceneKeyframeInterval(unsigned int interval)
+{
+  full_scene_keyframe_interval_ = interval;
+  if (interval)
+    ROS_DEBUG_NAMED(LOGNAME, "Publishing a full planning scene after every %u diffs", interval);
+  else
+    ROS_DEBUG_NAMED(LOGNAME, "Periodic full planning scene publication is disabled");
+}
+
 void PlanningSceneMonitor::getUpdatedFrameTransforms(std::vector<geometry_msgs::TransformStamped>& transforms)
 {
   const std::string& target = getRobotModel()->getModelFrame();
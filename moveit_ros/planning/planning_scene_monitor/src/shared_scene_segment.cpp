@@ -0,0 +1,326 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/planning_scene_monitor/shared_scene_segment.h>
+#include <geometric_shapes/shape_operations.h>
+#include <ros/console.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace planning_scene_monitor
+{
+static const std::string LOGNAME = "shared_scene_segment";
+
+namespace
+{
+const std::uint32_t SEGMENT_MAGIC = 0x4d565353;  // "MVSS"
+const std::uint32_t SEGMENT_LAYOUT_VERSION = 1;
+const int SNAPSHOT_RETRIES = 16;
+
+/// Cheap pointer-independent fingerprint of a shape, so readers can tell whether their local copy of an
+/// object still has the geometry the writer published poses for
+std::uint64_t shapeFingerprint(const shapes::ShapeConstPtr& shape)
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  const int type = shape->type;
+  const char* bytes = reinterpret_cast<const char*>(&type);
+  for (std::size_t i = 0; i < sizeof(type); ++i)
+    hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 1099511628211ULL;
+  const Eigen::Vector3d extents = shapes::computeShapeExtents(shape.get());
+  bytes = reinterpret_cast<const char*>(extents.data());
+  for (std::size_t i = 0; i < 3 * sizeof(double); ++i)
+    hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 1099511628211ULL;
+  return hash;
+}
+}
+
+SharedSceneSegment::SharedSceneSegment(const std::string& name, bool writer, std::size_t variable_capacity,
+                                       std::size_t shape_capacity)
+  : name_(name), writer_(writer), memory_(NULL), size_(0), last_applied_epoch_(0)
+{
+  if (writer_)
+  {
+    // Remove a possibly stale segment from a previous run before creating ours
+    shm_unlink(name_.c_str());
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Unable to create shared scene segment '%s': %s", name_.c_str(), strerror(errno));
+      return;
+    }
+    size_ = sizeof(Header) + variable_capacity * sizeof(double) + shape_capacity * sizeof(ShapeRecord);
+    if (ftruncate(fd, size_) != 0)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Unable to size shared scene segment '%s': %s", name_.c_str(), strerror(errno));
+      close(fd);
+      shm_unlink(name_.c_str());
+      return;
+    }
+    void* mem = mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Unable to map shared scene segment '%s': %s", name_.c_str(), strerror(errno));
+      shm_unlink(name_.c_str());
+      return;
+    }
+    memset(mem, 0, sizeof(Header));
+    Header* h = static_cast<Header*>(mem);
+    new (&h->epoch) std::atomic<std::uint64_t>(0);
+    h->variable_capacity = variable_capacity;
+    h->shape_capacity = shape_capacity;
+    h->layout_version = SEGMENT_LAYOUT_VERSION;
+    // the magic is published last, so readers never accept a partially initialized segment
+    h->magic = SEGMENT_MAGIC;
+    memory_ = mem;
+    ROS_INFO_NAMED(LOGNAME, "Created shared scene segment '%s' (%zu bytes)", name_.c_str(), size_);
+  }
+  else
+  {
+    int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+      return;  // the writer may simply not be up yet; the caller can retry later
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header))
+    {
+      close(fd);
+      return;
+    }
+    size_ = st.st_size;
+    void* mem = mmap(NULL, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Unable to map shared scene segment '%s': %s", name_.c_str(), strerror(errno));
+      return;
+    }
+    const Header* h = static_cast<const Header*>(mem);
+    if (h->magic != SEGMENT_MAGIC || h->layout_version != SEGMENT_LAYOUT_VERSION ||
+        size_ < sizeof(Header) + h->variable_capacity * sizeof(double) + h->shape_capacity * sizeof(ShapeRecord))
+    {
+      ROS_ERROR_NAMED(LOGNAME, "Shared scene segment '%s' has an incompatible layout", name_.c_str());
+      munmap(mem, size_);
+      return;
+    }
+    memory_ = mem;
+  }
+}
+
+SharedSceneSegment::~SharedSceneSegment()
+{
+  if (memory_)
+    munmap(memory_, size_);
+  if (writer_)
+    shm_unlink(name_.c_str());
+}
+
+SharedSceneSegment::Header* SharedSceneSegment::header() const
+{
+  return static_cast<Header*>(memory_);
+}
+
+double* SharedSceneSegment::variables() const
+{
+  return reinterpret_cast<double*>(static_cast<char*>(memory_) + sizeof(Header));
+}
+
+SharedSceneSegment::ShapeRecord* SharedSceneSegment::shapeRecords() const
+{
+  return reinterpret_cast<ShapeRecord*>(static_cast<char*>(memory_) + sizeof(Header) +
+                                        header()->variable_capacity * sizeof(double));
+}
+
+void SharedSceneSegment::writeScene(const planning_scene::PlanningScene& scene, bool include_world)
+{
+  if (!memory_ || !writer_)
+    return;
+
+  Header* h = header();
+  const std::uint64_t epoch = h->epoch.load(std::memory_order_relaxed);
+
+  // seqlock write: epoch is odd while the data is inconsistent
+  h->epoch.store(epoch + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  const robot_state::RobotState& state = scene.getCurrentState();
+  std::uint32_t variable_count = state.getVariableCount();
+  if (variable_count > h->variable_capacity)
+  {
+    ROS_WARN_ONCE_NAMED(LOGNAME, "Robot state (%u variables) does not fit the shared scene segment (capacity %u); "
+                                 "the robot state will not be mirrored",
+                        variable_count, h->variable_capacity);
+    variable_count = 0;
+  }
+  h->variable_count = variable_count;
+  if (variable_count > 0)
+    memcpy(variables(), state.getVariablePositions(), variable_count * sizeof(double));
+
+  if (include_world)
+  {
+    ShapeRecord* records = shapeRecords();
+    std::uint32_t count = 0;
+    const collision_detection::WorldConstPtr& world = scene.getWorld();
+    for (collision_detection::World::const_iterator it = world->begin(); it != world->end(); ++it)
+    {
+      // the octomap is distributed through its own topic and is not mirrored
+      if (it->first == planning_scene::PlanningScene::OCTOMAP_NS)
+        continue;
+      if (it->first.size() >= sizeof(records->object_id))
+      {
+        ROS_WARN_ONCE_NAMED(LOGNAME, "Object id '%s' is too long for the shared scene segment; not mirrored",
+                            it->first.c_str());
+        continue;
+      }
+      const collision_detection::World::ObjectConstPtr& obj = it->second;
+      for (std::size_t i = 0; i < obj->shapes_.size(); ++i)
+      {
+        if (count == h->shape_capacity)
+        {
+          ROS_WARN_ONCE_NAMED(LOGNAME, "World does not fit the shared scene segment (capacity %u shapes); "
+                                       "some object poses will not be mirrored",
+                              h->shape_capacity);
+          break;
+        }
+        ShapeRecord& record = records[count++];
+        memset(record.object_id, 0, sizeof(record.object_id));
+        memcpy(record.object_id, it->first.c_str(), it->first.size());
+        record.shape_index = i;
+        record.reserved = 0;
+        record.shape_hash = shapeFingerprint(obj->shapes_[i]);
+        const Eigen::Isometry3d& pose = obj->shape_poses_[i];
+        record.pose[0] = pose.translation().x();
+        record.pose[1] = pose.translation().y();
+        record.pose[2] = pose.translation().z();
+        const Eigen::Quaterniond q(pose.linear());
+        record.pose[3] = q.x();
+        record.pose[4] = q.y();
+        record.pose[5] = q.z();
+        record.pose[6] = q.w();
+      }
+    }
+    h->shape_count = count;
+  }
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  h->epoch.store(epoch + 2, std::memory_order_release);
+}
+
+std::uint64_t SharedSceneSegment::takeSnapshot(std::vector<double>& variables_out,
+                                               std::vector<ShapeRecord>& records_out) const
+{
+  const Header* h = header();
+  for (int attempt = 0; attempt < SNAPSHOT_RETRIES; ++attempt)
+  {
+    const std::uint64_t before = h->epoch.load(std::memory_order_acquire);
+    if (before & 1)
+      continue;  // the writer is mid-update
+
+    const std::uint32_t variable_count = std::min(h->variable_count, h->variable_capacity);
+    const std::uint32_t shape_count = std::min(h->shape_count, h->shape_capacity);
+    variables_out.resize(variable_count);
+    records_out.resize(shape_count);
+    if (variable_count > 0)
+      memcpy(&variables_out[0], variables(), variable_count * sizeof(double));
+    if (shape_count > 0)
+      memcpy(&records_out[0], shapeRecords(), shape_count * sizeof(ShapeRecord));
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (h->epoch.load(std::memory_order_relaxed) == before)
+      return before;
+  }
+  return 0;
+}
+
+bool SharedSceneSegment::readScene(planning_scene::PlanningScene& scene, bool& robot_state_changed,
+                                   bool& geometry_changed)
+{
+  robot_state_changed = false;
+  geometry_changed = false;
+  if (!memory_ || writer_)
+    return false;
+
+  const std::uint64_t epoch = takeSnapshot(snapshot_variables_, snapshot_records_);
+  if (epoch == 0 || epoch == last_applied_epoch_)
+    return false;
+  last_applied_epoch_ = epoch;
+
+  robot_state::RobotState& state = scene.getCurrentStateNonConst();
+  if (snapshot_variables_.size() == state.getVariableCount())
+  {
+    if (memcmp(state.getVariablePositions(), &snapshot_variables_[0],
+               snapshot_variables_.size() * sizeof(double)) != 0)
+    {
+      state.setVariablePositions(&snapshot_variables_[0]);
+      robot_state_changed = true;
+    }
+  }
+  else if (!snapshot_variables_.empty())
+    ROS_WARN_ONCE_NAMED(LOGNAME, "Shared scene segment robot state has %zu variables, local robot model has %zu; "
+                                 "the robot state will not be mirrored",
+                        snapshot_variables_.size(), static_cast<std::size_t>(state.getVariableCount()));
+
+  const collision_detection::WorldPtr& world = scene.getWorldNonConst();
+  for (std::size_t r = 0; r < snapshot_records_.size(); ++r)
+  {
+    const ShapeRecord& record = snapshot_records_[r];
+    // guarantee termination even if the record was written by a misbehaving writer
+    if (memchr(record.object_id, '\0', sizeof(record.object_id)) == NULL)
+      continue;
+    const std::string object_id(record.object_id);
+    collision_detection::World::ObjectConstPtr obj = world->getObject(object_id);
+    // objects the reader has not received yet (or whose geometry changed) still arrive via the
+    // regular planning scene diff topics; only poses of known, matching shapes are patched in
+    if (!obj || record.shape_index >= obj->shapes_.size() ||
+        shapeFingerprint(obj->shapes_[record.shape_index]) != record.shape_hash)
+      continue;
+    Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+    pose.translation() = Eigen::Vector3d(record.pose[0], record.pose[1], record.pose[2]);
+    pose.linear() =
+        Eigen::Quaterniond(record.pose[6], record.pose[3], record.pose[4], record.pose[5]).toRotationMatrix();
+    if (obj->shape_poses_[record.shape_index].isApprox(pose, 1e-10))
+      continue;
+    world->moveShapeInObject(object_id, obj->shapes_[record.shape_index], pose);
+    geometry_changed = true;
+  }
+
+  return robot_state_changed || geometry_changed;
+}
+}
@@ -37,6 +37,7 @@
 #include <moveit/planning_scene_monitor/trajectory_monitor.h>
 #include <moveit/trajectory_processing/trajectory_tools.h>
 #include <ros/rate.h>
+#include <cmath>
 #include <limits>
 #include <memory>
 
@@ -44,7 +45,10 @@ planning_scene_monitor::TrajectoryMonitor::TrajectoryMonitor(const CurrentStateM
                                                              double sampling_frequency)
   : current_state_monitor_(state_monitor)
   , sampling_frequency_(5.0)
+  , sample_buffer_capacity_(0)
+  , quiescent_sampling_frequency_(0.0)
   , trajectory_(current_state_monitor_->getRobotModel(), "")
+  , state_pool_index_(0)
 {
   setSamplingFrequency(sampling_frequency);
 }
@@ -62,6 +66,19 @@ void planning_scene_monitor::TrajectoryMonitor::setSamplingFrequency(double samp
     sampling_frequency_ = sampling_frequency;
 }
 
+void planning_scene_monitor::TrajectoryMonitor::setSampleBufferCapacity(std::size_t capacity)
+{
+  sample_buffer_capacity_ = capacity;
+}
+
+void planning_scene_monitor::TrajectoryMonitor::setQuiescentSamplingFrequency(double frequency)
+{
+  if (frequency < 0.0)
+    ROS_ERROR("The quiescent sampling frequency for trajectory states should not be negative");
+  else
+    quiescent_sampling_frequency_ = frequency;
+}
+
 bool planning_scene_monitor::TrajectoryMonitor::isActive() const
 {
   return static_cast<bool>(record_states_thread_);
@@ -102,12 +119,68 @@ void planning_scene_monitor::TrajectoryMonitor::recordStates()
   if (!current_state_monitor_)
     return;
 
+  // positions closer than this to the last recorded sample count as "not moving"
+  static const double QUIESCENT_MOTION_EPSILON = 1e-5;
+
   ros::Rate rate(sampling_frequency_);
+  const robot_model::RobotModelConstPtr& model = current_state_monitor_->getRobotModel();
+  const std::size_t variable_count = model->getVariableCount();
+  const double min_quiescent_period =
+      quiescent_sampling_frequency_ > 0.0 ? 1.0 / quiescent_sampling_frequency_ : 0.0;
+
+  // preallocate the recycled state slots; one more than the buffer capacity so that a full
+  // ring still has a free slot to write into before the oldest waypoint is dropped
+  state_pool_.clear();
+  state_pool_index_ = 0;
+  if (sample_buffer_capacity_ > 0)
+  {
+    state_pool_.reserve(sample_buffer_capacity_ + 1);
+    for (std::size_t i = 0; i <= sample_buffer_capacity_; ++i)
+      state_pool_.push_back(robot_state::RobotStatePtr(new robot_state::RobotState(model)));
+  }
+  last_recorded_positions_.clear();
 
   while (record_states_thread_)
   {
     rate.sleep();
-    std::pair<robot_state::RobotStatePtr, ros::Time> state = current_state_monitor_->getCurrentStateAndTime();
+
+    if (min_quiescent_period > 0.0 && !last_recorded_positions_.empty())
+    {
+      // peek at the monitored state without copying it; skip this sample if nothing moved
+      // since the last recorded one and the reduced quiescent rate is not due yet
+      robot_state::RobotStateConstPtr current = current_state_monitor_->getCurrentStateNoCopy();
+      const double* positions = current->getVariablePositions();
+      bool moving = false;
+      for (std::size_t i = 0; i < variable_count; ++i)
+        if (fabs(positions[i] - last_recorded_positions_[i]) > QUIESCENT_MOTION_EPSILON)
+        {
+          moving = true;
+          break;
+        }
+      if (!moving &&
+          (current_state_monitor_->getCurrentStateTime() - last_recorded_state_time_).toSec() < min_quiescent_period)
+        continue;
+    }
+
+    std::pair<robot_state::RobotStatePtr, ros::Time> state;
+    if (!state_pool_.empty())
+    {
+      robot_state::RobotStatePtr& slot = state_pool_[state_pool_index_];
+      if (slot.use_count() > 1)  // still referenced by the trajectory or by a consumer; replace it
+        slot.reset(new robot_state::RobotState(model));
+      state.second = current_state_monitor_->getCurrentStateTime();
+      current_state_monitor_->setToCurrentState(*slot);
+      state.first = slot;
+      state_pool_index_ = (state_pool_index_ + 1) % state_pool_.size();
+    }
+    else
+      state = current_state_monitor_->getCurrentStateAndTime();
+
+    // with a bounded sample buffer, drop the oldest waypoint; this releases its pooled slot
+    // for reuse as the ring wraps around
+    if (sample_buffer_capacity_ > 0 && trajectory_.getWayPointCount() >= sample_buffer_capacity_)
+      trajectory_.removeWayPoint(0);
+
     if (trajectory_.empty())
     {
       trajectory_.addSuffixWayPoint(state.first, 0.0);
@@ -119,6 +192,8 @@ void planning_scene_monitor::TrajectoryMonitor::recordStates()
       trajectory_.addSuffixWayPoint(state.first, (state.second - last_recorded_state_time_).toSec());
       last_recorded_state_time_ = state.second;
     }
+    const double* recorded = state.first->getVariablePositions();
+    last_recorded_positions_.assign(recorded, recorded + variable_count);
     if (state_add_callback_)
       state_add_callback_(state.first, state.second);
   }
@@ -40,6 +40,7 @@
 #include <moveit/macros/class_forward.h>
 #include <urdf/model.h>
 #include <srdfdom/model.h>
+#include <future>
 
 namespace rdf_loader
 {
@@ -59,6 +60,11 @@ public:
   /** \brief Initialize the robot model from a string representation of the URDF and SRDF documents */
   RDFLoader(const std::string& urdf_string, const std::string& srdf_string);
 
+  /** @brief Begin loading the robot description on a background thread. The returned future yields
+   * the constructed loader, so the parameter server fetches and the URDF/SRDF parsing can overlap
+   * other startup work */
+  static std::future<RDFLoaderPtr> loadAsync(const std::string& robot_description = "robot_description");
+
   /** @brief Get the resolved parameter name for the robot description */
   const std::string& getRobotDescription() const
   {
@@ -77,6 +83,18 @@ public:
     return srdf_;
   }
 
+  /** @brief Get the URDF document the model was parsed from */
+  const std::string& getURDFString() const
+  {
+    return urdf_string_;
+  }
+
+  /** @brief Get the SRDF document the model was parsed from */
+  const std::string& getSRDFString() const
+  {
+    return srdf_string_;
+  }
+
   /** @brief determine if given path points to a xacro file */
   static bool isXacroFile(const std::string& path);
 
@@ -98,6 +116,8 @@ public:
 
 private:
   std::string robot_description_;
+  std::string urdf_string_;
+  std::string srdf_string_;
   srdf::ModelSharedPtr srdf_;
   urdf::ModelInterfaceSharedPtr urdf_;
 };
@@ -50,6 +50,20 @@
 #include <streambuf>
 #include <algorithm>
 
+namespace
+{
+bool getParamToString(const std::string& name, std::string* value)
+{
+  ros::NodeHandle nh("~");
+  return nh.getParam(name, *value);
+}
+
+rdf_loader::RDFLoaderPtr constructLoader(const std::string& robot_description)
+{
+  return rdf_loader::RDFLoaderPtr(new rdf_loader::RDFLoader(robot_description));
+}
+}
+
 rdf_loader::RDFLoader::RDFLoader(const std::string& robot_description)
 {
   moveit::tools::Profiler::ScopedStart prof_start;
@@ -57,9 +71,21 @@ rdf_loader::RDFLoader::RDFLoader(const std::string& robot_description)
 
   ros::WallTime start = ros::WallTime::now();
   ros::NodeHandle nh("~");
-  std::string content;
 
-  if (!nh.searchParam(robot_description, robot_description_) || !nh.getParam(robot_description_, content))
+  if (!nh.searchParam(robot_description, robot_description_))
+  {
+    ROS_ERROR_NAMED("rdf_loader", "Robot model parameter not found! Did you remap '%s'?", robot_description.c_str());
+    return;
+  }
+
+  // fetch the SRDF document in the background; each fetch is a blocking round trip to the
+  // parameter server, so the URDF can be fetched and parsed while the SRDF is still in transit
+  const std::string srdf_description(robot_description_ + "_semantic");
+  std::string scontent;
+  std::future<bool> srdf_fetched = std::async(std::launch::async, &getParamToString, srdf_description, &scontent);
+
+  std::string content;
+  if (!nh.getParam(robot_description_, content))
   {
     ROS_ERROR_NAMED("rdf_loader", "Robot model parameter not found! Did you remap '%s'?", robot_description.c_str());
     return;
@@ -72,10 +98,9 @@ rdf_loader::RDFLoader::RDFLoader(const std::string& robot_description)
     return;
   }
   urdf_.reset(umodel);
+  urdf_string_ = content;
 
-  const std::string srdf_description(robot_description_ + "_semantic");
-  std::string scontent;
-  if (!nh.getParam(srdf_description, scontent))
+  if (!srdf_fetched.get())
   {
     ROS_ERROR_NAMED("rdf_loader", "Robot semantic description not found. Did you forget to define or remap '%s'?",
                     srdf_description.c_str());
@@ -89,6 +114,7 @@ rdf_loader::RDFLoader::RDFLoader(const std::string& robot_description)
     srdf_.reset();
     return;
   }
+  srdf_string_ = scontent;
 
   ROS_DEBUG_STREAM_NAMED("rdf", "Loaded robot model in " << (ros::WallTime::now() - start).toSec() << " seconds");
 }
@@ -102,12 +128,15 @@ rdf_loader::RDFLoader::RDFLoader(const std::string& urdf_string, const std::stri
   urdf_.reset(umodel);
   if (umodel->initString(urdf_string))
   {
+    urdf_string_ = urdf_string;
     srdf_.reset(new srdf::Model());
     if (!srdf_->initString(*urdf_, srdf_string))
     {
       ROS_ERROR_NAMED("rdf_loader", "Unable to parse SRDF");
       srdf_.reset();
     }
+    else
+      srdf_string_ = srdf_string;
   }
   else
   {
@@ -116,6 +145,11 @@ rdf_loader::RDFLoader::RDFLoader(const std::string& urdf_string, const std::stri
   }
 }
 
+std::future<rdf_loader::RDFLoaderPtr> rdf_loader::RDFLoader::loadAsync(const std::string& robot_description)
+{
+  return std::async(std::launch::async, &constructLoader, robot_description);
+}
+
 bool rdf_loader::RDFLoader::isXacroFile(const std::string& path)
 {
   std::string lower_path = path;
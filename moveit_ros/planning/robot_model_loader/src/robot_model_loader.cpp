@@ -37,6 +37,9 @@
 #include <moveit/robot_model_loader/robot_model_loader.h>
 #include <moveit/profiler/profiler.h>
 #include <ros/ros.h>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
 #include <typeinfo>
 
 namespace robot_model_loader
@@ -81,6 +84,14 @@ bool canSpecifyPosition(const robot_model::JointModel* jmodel, const unsigned in
     ok = true;
   return ok;
 }
+
+// Process-wide cache of constructed robot models, keyed by a hash of the URDF and SRDF documents.
+// Building a RobotModel for a large robot can take seconds; processes that create several loaders
+// for the same robot description (e.g., monitoring and visualization components) then share a
+// single instance instead of rebuilding it. Weak pointers are stored so that models are freed once
+// all loaders using them are gone.
+static std::map<std::size_t, std::weak_ptr<robot_model::RobotModel> > robot_model_cache;
+static boost::mutex robot_model_cache_mutex;
 }
 
 void RobotModelLoader::configure(const Options& opt)
@@ -97,7 +108,24 @@ void RobotModelLoader::configure(const Options& opt)
   {
     const srdf::ModelSharedPtr& srdf =
         rdf_loader_->getSRDF() ? rdf_loader_->getSRDF() : srdf::ModelSharedPtr(new srdf::Model());
-    model_.reset(new robot_model::RobotModel(rdf_loader_->getURDF(), srdf));
+
+    std::size_t model_hash = 0;
+    boost::hash_combine(model_hash, rdf_loader_->getURDFString());
+    boost::hash_combine(model_hash, rdf_loader_->getSRDFString());
+    {
+      boost::mutex::scoped_lock slock(robot_model_cache_mutex);
+      std::map<std::size_t, std::weak_ptr<robot_model::RobotModel> >::iterator it =
+          robot_model_cache.find(model_hash);
+      if (it != robot_model_cache.end())
+        model_ = it->second.lock();
+      if (model_)
+        ROS_DEBUG_NAMED("robot_model_loader", "Reusing cached robot model for identical URDF and SRDF documents");
+      else
+      {
+        model_.reset(new robot_model::RobotModel(rdf_loader_->getURDF(), srdf));
+        robot_model_cache[model_hash] = model_;
+      }
+    }
   }
 
   if (model_ && !rdf_loader_->getRobotDescription().empty())
@@ -234,6 +262,14 @@ void RobotModelLoader::loadKinematicsSolvers(const kinematics_plugin_loader::Kin
       robot_model::JointModelGroup* jmg = model_->getJointModelGroup(it->first);
       jmg->setDefaultIKAttempts(it->second);
     }
+
+    // eagerly instantiate kinematics solvers for all groups, if configured to do so; this moves
+    // the solver construction cost off the first IK call
+    int preload_count = 0;
+    ros::NodeHandle nh("~");
+    nh.param("preload_kinematics_solvers", preload_count, 0);
+    if (preload_count > 0)
+      kinematics_loader_->preloadSolvers(model_, preload_count);
   }
 }
 }
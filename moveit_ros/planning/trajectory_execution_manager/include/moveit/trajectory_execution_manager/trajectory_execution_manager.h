@@ -48,6 +48,7 @@
 #include <boost/thread.hpp>
 #include <pluginlib/class_loader.hpp>
 
+#include <atomic>
 #include <memory>
 
 namespace trajectory_execution_manager
@@ -70,6 +71,11 @@ public:
   /// successfully.
   typedef boost::function<void(std::size_t)> PathSegmentCompleteCallback;
 
+  /// Definition of the function signature that is called when a trajectory being executed first reaches the
+  /// path fraction configured with setPathProgressCallback(). The first argument is the index of the trajectory
+  /// (in the order push() was called), the second the fraction actually covered when the callback fired.
+  typedef boost::function<void(std::size_t, double)> PathProgressCallback;
+
   /// Data structure that represents information necessary to execute a trajectory
   struct TrajectoryExecutionContext
   {
@@ -79,8 +85,46 @@ public:
     // The trajectory to execute, split in different parts (by joints), each set of joints corresponding to one
     // controller
     std::vector<moveit_msgs::RobotTrajectory> trajectory_parts_;
+
+    // The execution velocity scaling the trajectory parts were generated with; online scaling
+    // requests arriving while this context executes are expressed relative to it
+    double velocity_scaling_ = 1.0;
   };
 
+  /// Immutable snapshot of all dynamically tunable execution parameters. The active snapshot is
+  /// replaced as a whole when parameters change (dynamic reconfigure events or the setters below),
+  /// so the execution threads obtain a consistent set of values with a single pointer load instead
+  /// of reading members that may be mid-update or going back to the parameter server.
+  struct ExecutionParameters
+  {
+    ExecutionParameters()
+      : version(0)
+      , execution_duration_monitoring(true)
+      , allowed_execution_duration_scaling(1.0)
+      , allowed_goal_duration_margin(0.0)
+      , execution_velocity_scaling(1.0)
+      , allowed_start_tolerance(0.01)
+      , wait_for_trajectory_completion(true)
+    {
+    }
+
+    /// Incremented every time a new snapshot is installed
+    unsigned int version;
+    /// Whether a controller taking longer than expected causes the trajectory to be canceled
+    bool execution_duration_monitoring;
+    /// Multiplicative factor applied to the expected duration of a trajectory to get the allowed duration
+    double allowed_execution_duration_scaling;
+    /// Extra time (seconds) allowed beyond the scaled expected duration before a cancel is triggered
+    double allowed_goal_duration_margin;
+    /// Factor the velocities of a trajectory are scaled by before it is sent to a controller
+    double execution_velocity_scaling;
+    /// Joint-value tolerance for validating a trajectory's start point against the current robot state
+    double allowed_start_tolerance;
+    /// Whether execution waits for the robot to come to a stop after the trajectory completes
+    bool wait_for_trajectory_completion;
+  };
+  typedef std::shared_ptr<const ExecutionParameters> ExecutionParametersConstPtr;
+
   /// Load the controller manager plugin, start listening for events on a topic.
   TrajectoryExecutionManager(const robot_model::RobotModelConstPtr& robot_model,
                              const planning_scene_monitor::CurrentStateMonitorPtr& csm);
@@ -215,12 +259,25 @@ public:
   /// Return the controller status for the last attempted execution
   moveit_controller_manager::ExecutionStatus getLastExecutionStatus() const;
 
+  /// Return the wall-clock duration (seconds) measured for each trajectory segment of the last
+  /// call to execute(). A segment's entry is appended as soon as that segment completes, so this
+  /// can also be queried while execution is in progress.
+  std::vector<double> getLastSegmentDurations() const;
+
   /// Stop whatever executions are active, if any
   void stopExecution(bool auto_clear = true);
 
   /// Clear the trajectories to execute
   void clear();
 
+  /// Get the active parameter snapshot; a single pointer load, safe to call from any thread.
+  /// The returned snapshot never changes; parameter updates install a new one
+  ExecutionParametersConstPtr getExecutionParameters() const;
+
+  /// Atomically replace the active parameter snapshot with \e params; its version is assigned
+  /// automatically. The setters below perform the same swap for a single value
+  void setExecutionParameters(const ExecutionParameters& params);
+
   /// Enable or disable the monitoring of trajectory execution duration. If a controller takes
   /// longer than expected, the trajectory is canceled
   void enableExecutionDurationMonitoring(bool flag);
@@ -234,15 +291,41 @@ public:
   void setAllowedGoalDurationMargin(double margin);
 
   /// Before sending a trajectory to a controller, scale the velocities by the factor specified.
-  /// By default, this is 1.0
+  /// By default, this is 1.0. When called while a trajectory is executing, the change is also
+  /// forwarded to the active controller handles, which re-time the remaining part of that
+  /// trajectory in flight if they support it (see MoveItControllerHandle::setVelocityScaling()),
+  /// so speed override changes do not require a stop / re-parameterize / resend cycle.
   void setExecutionVelocityScaling(double scaling);
 
+  /// Request \e callback to be called when each executed trajectory first reaches \e fraction (in [0, 1]) of its
+  /// time parameterization. The callback fires from the thread processing controller feedback, as soon as the
+  /// controller reports crossing the fraction; controllers that provide no progress feedback never fire it.
+  /// Useful to overlap planning of the next motion with the tail of the current one. Pass an empty callback to
+  /// disable. Takes effect for trajectories dispatched after the call.
+  void setPathProgressCallback(const PathProgressCallback& callback, double fraction);
+
   /// Set joint-value tolerance for validating trajectory's start point against current robot state
   void setAllowedStartTolerance(double tolerance);
 
   /// Enable or disable waiting for trajectory completion
   void setWaitForTrajectoryCompletion(bool flag);
 
+  /// Enable or disable pipelined segment dispatch. When enabled, continuity of consecutive
+  /// trajectories is validated once, before execution starts, and a trajectory that reuses
+  /// the controllers of its predecessor skips the controller activation checks at the segment
+  /// boundary, shortening the gap between segments. This can also be set with the
+  /// ~pipeline_segment_dispatch parameter.
+  void enablePipelineLookahead(bool flag);
+
+  /// Enable or disable blending of trajectories pushed while another one executes. When enabled,
+  /// push() no longer refuses such trajectories: the live state (position, velocity) is sampled
+  /// from the executing trajectory a short lookahead ahead of now, a C2-continuous quintic blend
+  /// from that state into the new path is computed, and the blend plus the new path replace the
+  /// remainder of the active controller goal, so the robot transitions without stopping. Requires
+  /// the new trajectory to use the controllers of the executing one. This can also be set with
+  /// the ~blend_consecutive_trajectories parameter; ~blend_lookahead (seconds) sets the window.
+  void enableTrajectoryBlending(bool flag);
+
 private:
   struct ControllerInformation
   {
@@ -266,6 +349,11 @@ private:
 
   /// Validate first point of trajectory matches current robot state
   bool validate(const TrajectoryExecutionContext& context) const;
+
+  /// Validate that the first point of the next trajectory matches the end of the previous one;
+  /// used to check whole sequences up front when pipelined segment dispatch is enabled
+  bool validateContinuity(const TrajectoryExecutionContext& context,
+                          const TrajectoryExecutionContext& next_context) const;
   bool configure(TrajectoryExecutionContext& context, const moveit_msgs::RobotTrajectory& trajectory,
                  const std::vector<std::string>& controllers);
 
@@ -292,6 +380,14 @@ private:
   void executeThread(const ExecutionCompleteCallback& callback, const PathSegmentCompleteCallback& part_callback,
                      bool auto_clear);
   bool executePart(std::size_t part_index);
+
+  /// Splice \e context into the currently executing trajectory: sample the live state a blend
+  /// lookahead ahead of now, build a quintic blend from it into the first point of each part of
+  /// \e context and replace the active controller goals with blend + new path. Returns false
+  /// (without disturbing the active execution) when the context cannot be spliced, e.g. when it
+  /// uses different controllers, contains multi-dof parts, or the active trajectory is about to
+  /// finish.
+  bool spliceWithActiveTrajectory(const TrajectoryExecutionContext& context);
   bool waitForRobotToStop(const TrajectoryExecutionContext& context, double wait_time = 1.0);
   void continuousExecutionThread();
 
@@ -329,13 +425,36 @@ private:
 
   moveit_controller_manager::ExecutionStatus last_execution_status_;
   std::vector<moveit_controller_manager::MoveItControllerHandlePtr> active_handles_;
+  // controllers last verified to be active by executePart(); lets pipelined executions skip
+  // the controller manager queries between segments that use the same controllers
+  std::vector<std::string> last_ensured_controllers_;
   int current_context_;
   std::vector<ros::Time> time_index_;  // used to find current expected trajectory location
+  // reference time the current context's time_from_start values are relative to; used by
+  // spliceWithActiveTrajectory() to locate the live state within the executing trajectory
+  ros::Time current_context_dispatch_time_;
   mutable boost::mutex time_index_mutex_;
-  bool execution_complete_;
-
-  bool stop_continuous_execution_;
-  bool run_continuous_execution_thread_;
+  // wall-clock duration of each completed segment of the current / last execute() call
+  std::vector<double> segment_durations_;
+  mutable boost::mutex segment_durations_mutex_;
+
+  // these state words are polled at segment boundaries by the execution threads and flipped by
+  // other threads (e.g. stopExecution()); keeping them atomic makes that propagation safe without
+  // taking execution_state_mutex_ on the fast path. Threads that block on the condition variables
+  // above still set them while holding the corresponding mutex, so no wakeup can be missed.
+  std::atomic<bool> execution_complete_;
+
+  // velocity scaling applied in flight to the currently dispatched segment, relative to the
+  // scaling it was dispatched with; the duration monitor in executePart() stretches its
+  // deadline by this factor when the segment is slowed down
+  std::atomic<double> in_flight_velocity_scaling_;
+
+  // extra seconds granted to the duration monitor of the current segment when a trajectory was
+  // spliced into it; reset when the next segment is dispatched
+  std::atomic<double> splice_deadline_extension_;
+
+  std::atomic<bool> stop_continuous_execution_;
+  std::atomic<bool> run_continuous_execution_thread_;
   std::vector<TrajectoryExecutionContext*> trajectories_;
   std::deque<TrajectoryExecutionContext*> continuous_execution_queue_;
 
@@ -348,18 +467,24 @@ private:
   class DynamicReconfigureImpl;
   DynamicReconfigureImpl* reconfigure_impl_;
 
-  bool execution_duration_monitoring_;
-  // 'global' values
-  double allowed_execution_duration_scaling_;
-  double allowed_goal_duration_margin_;
+  // the active parameter snapshot; replaced as a whole (never mutated in place) under
+  // execution_parameters_mutex_, so readers only copy the shared pointer
+  ExecutionParametersConstPtr execution_parameters_;
+  mutable boost::mutex execution_parameters_mutex_;
+
   // controller-specific values
-  // override the 'global' values
+  // override the 'global' values from the parameter snapshot
   std::map<std::string, double> controller_allowed_execution_duration_scaling_;
   std::map<std::string, double> controller_allowed_goal_duration_margin_;
 
-  double allowed_start_tolerance_;  // joint tolerance for validate(): radians for revolute joints
-  double execution_velocity_scaling_;
-  bool wait_for_trajectory_completion_;
+  // callback fired (from the controller feedback thread) when an executed trajectory crosses
+  // path_progress_fraction_ of its time parameterization
+  PathProgressCallback path_progress_callback_;
+  double path_progress_fraction_;
+
+  bool pipeline_lookahead_;
+  bool blend_consecutive_trajectories_;
+  double blend_lookahead_;  // seconds between sampling the live state and the splice taking effect
 };
 }
 
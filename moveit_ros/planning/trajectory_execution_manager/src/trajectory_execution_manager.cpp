@@ -35,10 +35,12 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/trajectory_execution_manager/trajectory_execution_manager.h>
+#include <moveit/profiler/profiler.h>
 #include <moveit/robot_state/robot_state.h>
 #include <moveit_ros_planning/TrajectoryExecutionDynamicReconfigureConfig.h>
 #include <dynamic_reconfigure/server.h>
 #include <tf2_eigen/tf2_eigen.h>
+#include <limits>
 
 namespace trajectory_execution_manager
 {
@@ -66,12 +68,17 @@ public:
 private:
   void dynamicReconfigureCallback(TrajectoryExecutionDynamicReconfigureConfig& config, uint32_t level)
   {
-    owner_->enableExecutionDurationMonitoring(config.execution_duration_monitoring);
-    owner_->setAllowedExecutionDurationScaling(config.allowed_execution_duration_scaling);
-    owner_->setAllowedGoalDurationMargin(config.allowed_goal_duration_margin);
+    // resolve all tunables into one snapshot and install it with a single swap, so concurrently
+    // executing trajectories never observe a half-applied reconfiguration
+    TrajectoryExecutionManager::ExecutionParameters params = *owner_->getExecutionParameters();
+    params.execution_duration_monitoring = config.execution_duration_monitoring;
+    params.allowed_execution_duration_scaling = config.allowed_execution_duration_scaling;
+    params.allowed_goal_duration_margin = config.allowed_goal_duration_margin;
+    params.allowed_start_tolerance = config.allowed_start_tolerance;
+    params.wait_for_trajectory_completion = config.wait_for_trajectory_completion;
+    owner_->setExecutionParameters(params);
+    // velocity scaling is applied separately so a change can also re-time an executing trajectory
     owner_->setExecutionVelocityScaling(config.execution_velocity_scaling);
-    owner_->setAllowedStartTolerance(config.allowed_start_tolerance);
-    owner_->setWaitForTrajectoryCompletion(config.wait_for_trajectory_completion);
   }
 
   TrajectoryExecutionManager* owner_;
@@ -112,12 +119,18 @@ void TrajectoryExecutionManager::initialize()
   current_context_ = -1;
   last_execution_status_ = moveit_controller_manager::ExecutionStatus::SUCCEEDED;
   run_continuous_execution_thread_ = true;
-  execution_duration_monitoring_ = true;
-  execution_velocity_scaling_ = 1.0;
-  allowed_start_tolerance_ = 0.01;
-
-  allowed_execution_duration_scaling_ = DEFAULT_CONTROLLER_GOAL_DURATION_SCALING;
-  allowed_goal_duration_margin_ = DEFAULT_CONTROLLER_GOAL_DURATION_MARGIN;
+  in_flight_velocity_scaling_ = 1.0;
+  path_progress_fraction_ = 1.0;
+  splice_deadline_extension_ = 0.0;
+  node_handle_.param("pipeline_segment_dispatch", pipeline_lookahead_, false);
+  node_handle_.param("blend_consecutive_trajectories", blend_consecutive_trajectories_, false);
+  node_handle_.param("blend_lookahead", blend_lookahead_, 0.25);
+
+  // resolve all tunables once into the initial parameter snapshot
+  ExecutionParameters initial_params;
+  initial_params.allowed_execution_duration_scaling = DEFAULT_CONTROLLER_GOAL_DURATION_SCALING;
+  initial_params.allowed_goal_duration_margin = DEFAULT_CONTROLLER_GOAL_DURATION_MARGIN;
+  execution_parameters_.reset(new ExecutionParameters(initial_params));
 
   // load controller-specific values for allowed_execution_duration_scaling and allowed_goal_duration_margin
   loadControllerParams();
@@ -179,34 +192,114 @@ void TrajectoryExecutionManager::initialize()
     ROS_INFO_NAMED(name_, "Trajectory execution is not managing controllers");
 }
 
+TrajectoryExecutionManager::ExecutionParametersConstPtr TrajectoryExecutionManager::getExecutionParameters() const
+{
+  boost::mutex::scoped_lock slock(execution_parameters_mutex_);
+  return execution_parameters_;
+}
+
+void TrajectoryExecutionManager::setExecutionParameters(const ExecutionParameters& params)
+{
+  boost::mutex::scoped_lock slock(execution_parameters_mutex_);
+  ExecutionParameters* next = new ExecutionParameters(params);
+  next->version = execution_parameters_ ? execution_parameters_->version + 1 : 0;
+  execution_parameters_.reset(next);
+}
+
 void TrajectoryExecutionManager::enableExecutionDurationMonitoring(bool flag)
 {
-  execution_duration_monitoring_ = flag;
+  ExecutionParameters params = *getExecutionParameters();
+  params.execution_duration_monitoring = flag;
+  setExecutionParameters(params);
 }
 
 void TrajectoryExecutionManager::setAllowedExecutionDurationScaling(double scaling)
 {
-  allowed_execution_duration_scaling_ = scaling;
+  ExecutionParameters params = *getExecutionParameters();
+  params.allowed_execution_duration_scaling = scaling;
+  setExecutionParameters(params);
 }
 
 void TrajectoryExecutionManager::setAllowedGoalDurationMargin(double margin)
 {
-  allowed_goal_duration_margin_ = margin;
+  ExecutionParameters params = *getExecutionParameters();
+  params.allowed_goal_duration_margin = margin;
+  setExecutionParameters(params);
 }
 
 void TrajectoryExecutionManager::setExecutionVelocityScaling(double scaling)
 {
-  execution_velocity_scaling_ = scaling;
+  if (scaling <= std::numeric_limits<double>::epsilon())
+  {
+    ROS_ERROR_NAMED(name_, "Execution velocity scaling must be positive (got %lf); ignoring", scaling);
+    return;
+  }
+  ExecutionParameters params = *getExecutionParameters();
+  if (params.execution_velocity_scaling != scaling)
+  {
+    params.execution_velocity_scaling = scaling;
+    setExecutionParameters(params);
+  }
+
+  // when a trajectory is already executing, have the controller handles re-time its remainder in
+  // flight instead of requiring a stop / re-parameterize / resend cycle
+  boost::mutex::scoped_lock slock(execution_state_mutex_);
+  if (execution_complete_ || active_handles_.empty())
+    return;
+  double dispatched_scaling = 1.0;
+  {
+    boost::mutex::scoped_lock tlock(time_index_mutex_);
+    if (current_context_ >= 0 && current_context_ < static_cast<int>(trajectories_.size()))
+      dispatched_scaling = trajectories_[current_context_]->velocity_scaling_;
+  }
+  const double target = scaling / dispatched_scaling;
+  bool applied = false;
+  for (std::size_t i = 0; i < active_handles_.size(); ++i)
+    try
+    {
+      if (active_handles_[i]->setVelocityScaling(target))
+        applied = true;
+      else
+        ROS_WARN_ONCE_NAMED(name_, "Controller handle '%s' does not support online velocity scaling; the new "
+                                   "scaling only affects trajectories sent after the current one.",
+                            active_handles_[i]->getName().c_str());
+    }
+    catch (std::exception& ex)
+    {
+      ROS_ERROR_NAMED(name_, "Caught %s when changing the velocity scaling of the executed trajectory", ex.what());
+    }
+  if (applied)
+    in_flight_velocity_scaling_ = target;
+}
+
+void TrajectoryExecutionManager::setPathProgressCallback(const PathProgressCallback& callback, double fraction)
+{
+  path_progress_callback_ = callback;
+  path_progress_fraction_ = std::min(1.0, std::max(0.0, fraction));
 }
 
 void TrajectoryExecutionManager::setAllowedStartTolerance(double tolerance)
 {
-  allowed_start_tolerance_ = tolerance;
+  ExecutionParameters params = *getExecutionParameters();
+  params.allowed_start_tolerance = tolerance;
+  setExecutionParameters(params);
 }
 
 void TrajectoryExecutionManager::setWaitForTrajectoryCompletion(bool flag)
 {
-  wait_for_trajectory_completion_ = flag;
+  ExecutionParameters params = *getExecutionParameters();
+  params.wait_for_trajectory_completion = flag;
+  setExecutionParameters(params);
+}
+
+void TrajectoryExecutionManager::enablePipelineLookahead(bool flag)
+{
+  pipeline_lookahead_ = flag;
+}
+
+void TrajectoryExecutionManager::enableTrajectoryBlending(bool flag)
+{
+  blend_consecutive_trajectories_ = flag;
 }
 
 bool TrajectoryExecutionManager::isManagingControllers() const
@@ -262,6 +355,14 @@ bool TrajectoryExecutionManager::push(const moveit_msgs::RobotTrajectory& trajec
 {
   if (!execution_complete_)
   {
+    if (blend_consecutive_trajectories_)
+    {
+      TrajectoryExecutionContext splice_context;
+      if (configure(splice_context, trajectory, controllers) && spliceWithActiveTrajectory(splice_context))
+        return true;
+      ROS_ERROR_NAMED(name_, "Cannot blend the new trajectory into the one being executed");
+      return false;
+    }
     ROS_ERROR_NAMED(name_, "Cannot push a new trajectory while another is being executed");
     return false;
   }
@@ -292,6 +393,237 @@ bool TrajectoryExecutionManager::push(const moveit_msgs::RobotTrajectory& trajec
   return false;
 }
 
+namespace
+{
+// Sample position, velocity and acceleration of a joint trajectory at a time offset, using cubic
+// Hermite interpolation between the bracketing points when both carry velocities
+bool sampleJointTrajectory(const trajectory_msgs::JointTrajectory& trajectory, double time,
+                           std::vector<double>& positions, std::vector<double>& velocities,
+                           std::vector<double>& accelerations)
+{
+  if (trajectory.points.empty() || trajectory.joint_names.empty())
+    return false;
+  const std::size_t n = trajectory.joint_names.size();
+  velocities.assign(n, 0.0);
+  accelerations.assign(n, 0.0);
+
+  std::size_t after = 0;
+  while (after < trajectory.points.size() && trajectory.points[after].time_from_start.toSec() <= time)
+    ++after;
+  if (after == 0 || after == trajectory.points.size())
+  {
+    const trajectory_msgs::JointTrajectoryPoint& pt = after == 0 ? trajectory.points.front() : trajectory.points.back();
+    if (pt.positions.size() != n)
+      return false;
+    positions = pt.positions;
+    if (pt.velocities.size() == n)
+      velocities = pt.velocities;
+    return true;
+  }
+
+  const trajectory_msgs::JointTrajectoryPoint& before_pt = trajectory.points[after - 1];
+  const trajectory_msgs::JointTrajectoryPoint& after_pt = trajectory.points[after];
+  if (before_pt.positions.size() != n || after_pt.positions.size() != n)
+    return false;
+  const double h = (after_pt.time_from_start - before_pt.time_from_start).toSec();
+  const double s = h > std::numeric_limits<double>::epsilon() ?
+                       (time - before_pt.time_from_start.toSec()) / h :
+                       1.0;
+  positions.resize(n);
+  const bool cubic = before_pt.velocities.size() == n && after_pt.velocities.size() == n;
+  for (std::size_t j = 0; j < n; ++j)
+  {
+    const double p0 = before_pt.positions[j], p1 = after_pt.positions[j];
+    if (cubic)
+    {
+      const double v0 = before_pt.velocities[j], v1 = after_pt.velocities[j];
+      const double s2 = s * s, s3 = s2 * s;
+      positions[j] = (2 * s3 - 3 * s2 + 1) * p0 + (s3 - 2 * s2 + s) * h * v0 + (-2 * s3 + 3 * s2) * p1 +
+                     (s3 - s2) * h * v1;
+      velocities[j] = ((6 * s2 - 6 * s) * p0 + (3 * s2 - 4 * s + 1) * h * v0 + (-6 * s2 + 6 * s) * p1 +
+                       (3 * s2 - 2 * s) * h * v1) /
+                      h;
+      accelerations[j] =
+          ((12 * s - 6) * p0 + (6 * s - 4) * h * v0 + (-12 * s + 6) * p1 + (6 * s - 2) * h * v1) / (h * h);
+    }
+    else
+    {
+      positions[j] = p0 + (p1 - p0) * s;
+      velocities[j] = h > std::numeric_limits<double>::epsilon() ? (p1 - p0) / h : 0.0;
+    }
+  }
+  return true;
+}
+
+// Append a C2-continuous quintic blend from (p0, v0, a0) to the target point over the given
+// duration, sampled at a fixed number of points with matching velocities and accelerations
+void appendQuinticBlend(const std::vector<double>& p0, const std::vector<double>& v0, const std::vector<double>& a0,
+                        const trajectory_msgs::JointTrajectoryPoint& target, double duration, unsigned int samples,
+                        trajectory_msgs::JointTrajectory& out)
+{
+  const std::size_t n = p0.size();
+  const double T = duration, T2 = T * T, T3 = T2 * T, T4 = T3 * T, T5 = T4 * T;
+  std::vector<double> c3(n), c4(n), c5(n), v1(n, 0.0), a1(n, 0.0);
+  if (target.velocities.size() == n)
+    v1 = target.velocities;
+  if (target.accelerations.size() == n)
+    a1 = target.accelerations;
+  for (std::size_t j = 0; j < n; ++j)
+  {
+    const double dp = target.positions[j] - p0[j];
+    c3[j] = (20 * dp - (8 * v1[j] + 12 * v0[j]) * T - (3 * a0[j] - a1[j]) * T2) / (2 * T3);
+    c4[j] = (-30 * dp + (14 * v1[j] + 16 * v0[j]) * T + (3 * a0[j] - 2 * a1[j]) * T2) / (2 * T4);
+    c5[j] = (12 * dp - 6 * (v1[j] + v0[j]) * T - (a0[j] - a1[j]) * T2) / (2 * T5);
+  }
+  for (unsigned int s = 1; s <= samples; ++s)
+  {
+    const double t = T * s / samples, t2 = t * t, t3 = t2 * t, t4 = t3 * t, t5 = t4 * t;
+    trajectory_msgs::JointTrajectoryPoint pt;
+    pt.positions.resize(n);
+    pt.velocities.resize(n);
+    pt.accelerations.resize(n);
+    for (std::size_t j = 0; j < n; ++j)
+    {
+      pt.positions[j] = p0[j] + v0[j] * t + 0.5 * a0[j] * t2 + c3[j] * t3 + c4[j] * t4 + c5[j] * t5;
+      pt.velocities[j] = v0[j] + a0[j] * t + 3 * c3[j] * t2 + 4 * c4[j] * t3 + 5 * c5[j] * t4;
+      pt.accelerations[j] = a0[j] + 6 * c3[j] * t + 12 * c4[j] * t2 + 20 * c5[j] * t3;
+    }
+    pt.time_from_start = ros::Duration(t);
+    out.points.push_back(pt);
+  }
+}
+}  // namespace
+
+bool TrajectoryExecutionManager::spliceWithActiveTrajectory(const TrajectoryExecutionContext& context)
+{
+  boost::mutex::scoped_lock slock(execution_state_mutex_);
+  if (execution_complete_ || active_handles_.empty())
+    return false;
+
+  int current;
+  ros::Time dispatch_time;
+  {
+    boost::mutex::scoped_lock tlock(time_index_mutex_);
+    current = current_context_;
+    dispatch_time = current_context_dispatch_time_;
+  }
+  if (current < 0 || static_cast<std::size_t>(current) >= trajectories_.size())
+    return false;
+  TrajectoryExecutionContext& active = *trajectories_[current];
+  if (context.controllers_ != active.controllers_ ||
+      context.trajectory_parts_.size() != active.trajectory_parts_.size() ||
+      active_handles_.size() != active.trajectory_parts_.size())
+  {
+    ROS_DEBUG_NAMED(name_, "New trajectory does not use the controllers of the executing one; cannot splice");
+    return false;
+  }
+
+  const ros::Time splice_time = ros::Time::now() + ros::Duration(blend_lookahead_);
+  double extension = 0.0;
+  double max_blend_duration = 0.0;
+
+  std::vector<moveit_msgs::RobotTrajectory> spliced(context.trajectory_parts_.size());
+  for (std::size_t i = 0; i < context.trajectory_parts_.size(); ++i)
+  {
+    const trajectory_msgs::JointTrajectory& active_part = active.trajectory_parts_[i].joint_trajectory;
+    const trajectory_msgs::JointTrajectory& new_part = context.trajectory_parts_[i].joint_trajectory;
+    if (!context.trajectory_parts_[i].multi_dof_joint_trajectory.points.empty() ||
+        !active.trajectory_parts_[i].multi_dof_joint_trajectory.points.empty())
+    {
+      ROS_DEBUG_NAMED(name_, "Trajectory blending does not support multi-dof trajectories");
+      return false;
+    }
+    if (new_part.joint_names != active_part.joint_names || new_part.points.empty() || active_part.points.empty())
+      return false;
+
+    const ros::Time part_start = active_part.header.stamp > dispatch_time ? active_part.header.stamp : dispatch_time;
+    const double t_live = (splice_time - part_start).toSec();
+    if (t_live >= active_part.points.back().time_from_start.toSec())
+    {
+      ROS_DEBUG_NAMED(name_, "Executing trajectory ends within the blend lookahead; too late to splice");
+      return false;
+    }
+
+    // the state the robot is expected to be at when the spliced goal takes effect
+    std::vector<double> p0, v0, a0;
+    if (!sampleJointTrajectory(active_part, std::max(t_live, 0.0), p0, v0, a0))
+      return false;
+
+    // blend long enough that no joint needs to exceed its velocity limit to reach the new path
+    const trajectory_msgs::JointTrajectoryPoint& target = new_part.points.front();
+    if (target.positions.size() != new_part.joint_names.size())
+      return false;
+    double blend_duration = blend_lookahead_;
+    for (std::size_t j = 0; j < new_part.joint_names.size(); ++j)
+    {
+      double max_velocity = 1.0;
+      const robot_model::JointModel* jm = robot_model_->getJointModel(new_part.joint_names[j]);
+      if (jm && !jm->getVariableBounds().empty() && jm->getVariableBounds()[0].velocity_bounded_)
+        max_velocity = std::max(fabs(jm->getVariableBounds()[0].max_velocity_), 1e-3);
+      blend_duration = std::max(blend_duration, 1.5 * fabs(target.positions[j] - p0[j]) / max_velocity);
+    }
+    max_blend_duration = std::max(max_blend_duration, blend_duration);
+
+    trajectory_msgs::JointTrajectory& result = spliced[i].joint_trajectory;
+    result.joint_names = new_part.joint_names;
+    result.header.stamp = splice_time;
+    appendQuinticBlend(p0, v0, a0, target, blend_duration, 8, result);
+    const double first_point_offset = new_part.points.front().time_from_start.toSec();
+    for (std::size_t j = 1; j < new_part.points.size(); ++j)
+    {
+      result.points.push_back(new_part.points[j]);
+      result.points.back().time_from_start =
+          ros::Duration(blend_duration + new_part.points[j].time_from_start.toSec() - first_point_offset);
+    }
+    extension = std::max(extension, (splice_time - dispatch_time).toSec() + result.points.back().time_from_start.toSec());
+  }
+
+  // replace the active controller goals; action-based controller handles preempt the previous
+  // goal when a new one is sent, so motion continues without a stop
+  for (std::size_t i = 0; i < spliced.size(); ++i)
+  {
+    bool ok = false;
+    try
+    {
+      ok = active_handles_[i]->sendTrajectory(spliced[i]);
+    }
+    catch (std::exception& ex)
+    {
+      ROS_ERROR_NAMED(name_, "Caught %s when splicing trajectory", ex.what());
+    }
+    if (!ok)
+    {
+      // some goals may already have been replaced; the only consistent way out is to stop
+      ROS_ERROR_NAMED(name_, "Failed to splice trajectory part %zu; stopping execution", i + 1);
+      stopExecutionInternal();
+      last_execution_status_ = moveit_controller_manager::ExecutionStatus::ABORTED;
+      return false;
+    }
+  }
+
+  // grant the duration monitor the time the spliced goal needs beyond the original estimate
+  const ExecutionParametersConstPtr exec_params = getExecutionParameters();
+  splice_deadline_extension_ = splice_deadline_extension_ + extension * exec_params->allowed_execution_duration_scaling +
+                               exec_params->allowed_goal_duration_margin;
+
+  // point the expected-state bookkeeping at the spliced goal
+  active.trajectory_parts_ = spliced;
+  {
+    boost::mutex::scoped_lock tlock(time_index_mutex_);
+    time_index_.clear();
+    std::size_t longest = 0;
+    for (std::size_t i = 1; i < spliced.size(); ++i)
+      if (spliced[i].joint_trajectory.points.size() > spliced[longest].joint_trajectory.points.size())
+        longest = i;
+    for (std::size_t j = 0; j < spliced[longest].joint_trajectory.points.size(); ++j)
+      time_index_.push_back(splice_time + spliced[longest].joint_trajectory.points[j].time_from_start);
+    current_context_dispatch_time_ = splice_time;
+  }
+
+  ROS_INFO_NAMED(name_, "Blended the new trajectory into the executing one (%.3f s blend)", max_blend_duration);
+  return true;
+}
+
 bool TrajectoryExecutionManager::pushAndExecute(const moveit_msgs::RobotTrajectory& trajectory,
                                                 const std::string& controller)
 {
@@ -802,6 +1134,8 @@ bool TrajectoryExecutionManager::distributeTrajectory(const moveit_msgs::RobotTr
   parts.clear();
   parts.resize(controllers.size());
 
+  const double execution_velocity_scaling = getExecutionParameters()->execution_velocity_scaling;
+
   std::set<std::string> actuated_joints_mdof;
   actuated_joints_mdof.insert(trajectory.multi_dof_joint_trajectory.joint_names.begin(),
                               trajectory.multi_dof_joint_trajectory.joint_names.end());
@@ -861,22 +1195,22 @@ bool TrajectoryExecutionManager::distributeTrajectory(const moveit_msgs::RobotTr
               parts[i].multi_dof_joint_trajectory.points[j].velocities.resize(bijection.size());
 
               parts[i].multi_dof_joint_trajectory.points[j].velocities[0].linear.x =
-                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].linear.x * execution_velocity_scaling_;
+                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].linear.x * execution_velocity_scaling;
 
               parts[i].multi_dof_joint_trajectory.points[j].velocities[0].linear.y =
-                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].linear.y * execution_velocity_scaling_;
+                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].linear.y * execution_velocity_scaling;
 
               parts[i].multi_dof_joint_trajectory.points[j].velocities[0].linear.z =
-                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].linear.z * execution_velocity_scaling_;
+                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].linear.z * execution_velocity_scaling;
 
               parts[i].multi_dof_joint_trajectory.points[j].velocities[0].angular.x =
-                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].angular.x * execution_velocity_scaling_;
+                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].angular.x * execution_velocity_scaling;
 
               parts[i].multi_dof_joint_trajectory.points[j].velocities[0].angular.y =
-                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].angular.y * execution_velocity_scaling_;
+                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].angular.y * execution_velocity_scaling;
 
               parts[i].multi_dof_joint_trajectory.points[j].velocities[0].angular.z =
-                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].angular.z * execution_velocity_scaling_;
+                  trajectory.multi_dof_joint_trajectory.points[j].velocities[0].angular.z * execution_velocity_scaling;
             }
           }
         }
@@ -908,7 +1242,7 @@ bool TrajectoryExecutionManager::distributeTrajectory(const moveit_msgs::RobotTr
             parts[i].joint_trajectory.points[j].velocities.resize(bijection.size());
             for (std::size_t k = 0; k < bijection.size(); ++k)
               parts[i].joint_trajectory.points[j].velocities[k] =
-                  trajectory.joint_trajectory.points[j].velocities[bijection[k]] * execution_velocity_scaling_;
+                  trajectory.joint_trajectory.points[j].velocities[bijection[k]] * execution_velocity_scaling;
           }
           if (!trajectory.joint_trajectory.points[j].accelerations.empty())
           {
@@ -933,10 +1267,11 @@ bool TrajectoryExecutionManager::distributeTrajectory(const moveit_msgs::RobotTr
 
 bool TrajectoryExecutionManager::validate(const TrajectoryExecutionContext& context) const
 {
-  if (allowed_start_tolerance_ == 0)  // skip validation on this magic number
+  const double allowed_start_tolerance = getExecutionParameters()->allowed_start_tolerance;
+  if (allowed_start_tolerance == 0)  // skip validation on this magic number
     return true;
 
-  ROS_DEBUG_NAMED(name_, "Validating trajectory with allowed_start_tolerance %g", allowed_start_tolerance_);
+  ROS_DEBUG_NAMED(name_, "Validating trajectory with allowed_start_tolerance %g", allowed_start_tolerance);
 
   robot_state::RobotStatePtr current_state;
   if (!csm_->waitForCurrentState(ros::Time::now()) || !(current_state = csm_->getCurrentState()))
@@ -973,11 +1308,11 @@ bool TrajectoryExecutionManager::validate(const TrajectoryExecutionContext& cont
         // normalize positions and compare
         jm->enforcePositionBounds(&cur_position);
         jm->enforcePositionBounds(&traj_position);
-        if (fabs(cur_position - traj_position) > allowed_start_tolerance_)
+        if (fabs(cur_position - traj_position) > allowed_start_tolerance)
         {
           ROS_ERROR_NAMED(name_, "\nInvalid Trajectory: start point deviates from current robot state more than %g"
                                  "\njoint '%s': expected: %g, current: %g",
-                          allowed_start_tolerance_, joint_names[i].c_str(), traj_position, cur_position);
+                          allowed_start_tolerance, joint_names[i].c_str(), traj_position, cur_position);
           return false;
         }
       }
@@ -1012,10 +1347,10 @@ bool TrajectoryExecutionManager::validate(const TrajectoryExecutionContext& cont
         Eigen::Vector3d offset = cur_transform.translation() - start_transform.translation();
         Eigen::AngleAxisd rotation;
         rotation.fromRotationMatrix(cur_transform.rotation().transpose() * start_transform.rotation());
-        if ((offset.array() > allowed_start_tolerance_).any() || rotation.angle() > allowed_start_tolerance_)
+        if ((offset.array() > allowed_start_tolerance).any() || rotation.angle() > allowed_start_tolerance)
         {
           ROS_ERROR_STREAM_NAMED(name_, "\nInvalid Trajectory: start point deviates from current robot state more than "
-                                            << allowed_start_tolerance_ << "\nmulti-dof joint '" << joint_names[i]
+                                            << allowed_start_tolerance << "\nmulti-dof joint '" << joint_names[i]
                                             << "': pos delta: " << offset.transpose()
                                             << " rot delta: " << rotation.angle());
           return false;
@@ -1026,6 +1361,59 @@ bool TrajectoryExecutionManager::validate(const TrajectoryExecutionContext& cont
   return true;
 }
 
+bool TrajectoryExecutionManager::validateContinuity(const TrajectoryExecutionContext& context,
+                                                    const TrajectoryExecutionContext& next_context) const
+{
+  const double allowed_start_tolerance = getExecutionParameters()->allowed_start_tolerance;
+  if (allowed_start_tolerance == 0)  // skip validation on this magic number
+    return true;
+
+  // gather the final single-dof positions commanded by the first context
+  std::map<std::string, double> final_positions;
+  for (const auto& trajectory : context.trajectory_parts_)
+  {
+    const trajectory_msgs::JointTrajectory& t = trajectory.joint_trajectory;
+    if (t.points.empty())
+      continue;
+    for (std::size_t i = 0; i < t.joint_names.size() && i < t.points.back().positions.size(); ++i)
+      final_positions[t.joint_names[i]] = t.points.back().positions[i];
+  }
+
+  for (const auto& trajectory : next_context.trajectory_parts_)
+  {
+    const trajectory_msgs::JointTrajectory& t = trajectory.joint_trajectory;
+    if (t.points.empty())
+      continue;
+    for (std::size_t i = 0; i < t.joint_names.size() && i < t.points.front().positions.size(); ++i)
+    {
+      std::map<std::string, double>::const_iterator it = final_positions.find(t.joint_names[i]);
+      if (it == final_positions.end())
+        continue;
+
+      const robot_model::JointModel* jm = robot_model_->getJointModel(t.joint_names[i]);
+      if (!jm)
+      {
+        ROS_ERROR_STREAM_NAMED(name_, "Unknown joint in trajectory: " << t.joint_names[i]);
+        return false;
+      }
+
+      double end_position = it->second;
+      double start_position = t.points.front().positions[i];
+      // normalize positions and compare
+      jm->enforcePositionBounds(&end_position);
+      jm->enforcePositionBounds(&start_position);
+      if (fabs(end_position - start_position) > allowed_start_tolerance)
+      {
+        ROS_ERROR_NAMED(name_, "\nInvalid Trajectory: consecutive trajectories deviate by more than %g"
+                               "\njoint '%s': previous trajectory ends at: %g, next trajectory starts at: %g",
+                        allowed_start_tolerance, t.joint_names[i].c_str(), end_position, start_position);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool TrajectoryExecutionManager::configure(TrajectoryExecutionContext& context,
                                            const moveit_msgs::RobotTrajectory& trajectory,
                                            const std::vector<std::string>& controllers)
@@ -1035,6 +1423,11 @@ bool TrajectoryExecutionManager::configure(TrajectoryExecutionContext& context,
     // empty trajectories don't need to configure anything
     return true;
   }
+
+  // remember the scaling the parts are generated with, so that online scaling requests arriving
+  // while this context executes can be expressed relative to it
+  context.velocity_scaling_ = getExecutionParameters()->execution_velocity_scaling;
+
   std::set<std::string> actuated_joints;
 
   auto isActuated = [this](const std::string& joint_name) -> bool {
@@ -1210,7 +1603,22 @@ void TrajectoryExecutionManager::execute(const ExecutionCompleteCallback& callba
     return;
   }
 
+  // with pipelined dispatch there is no per-segment validation against the robot state at
+  // segment boundaries, so verify up front that consecutive trajectories are continuous
+  if (pipeline_lookahead_)
+    for (std::size_t i = 0; i + 1 < trajectories_.size(); ++i)
+      if (!validateContinuity(*trajectories_[i], *trajectories_[i + 1]))
+      {
+        last_execution_status_ = moveit_controller_manager::ExecutionStatus::ABORTED;
+        if (auto_clear)
+          clear();
+        if (callback)
+          callback(last_execution_status_);
+        return;
+      }
+
   // start the execution thread
+  last_ensured_controllers_.clear();
   execution_complete_ = false;
   execution_thread_.reset(
       new boost::thread(&TrajectoryExecutionManager::executeThread, this, callback, part_callback, auto_clear));
@@ -1271,12 +1679,24 @@ void TrajectoryExecutionManager::executeThread(const ExecutionCompleteCallback&
   // assume everything will be OK
   last_execution_status_ = moveit_controller_manager::ExecutionStatus::SUCCEEDED;
 
+  {
+    boost::mutex::scoped_lock slock(segment_durations_mutex_);
+    segment_durations_.clear();
+  }
+
   // execute each trajectory, one after the other (executePart() is blocking) or until one fails.
   // on failure, the status is set by executePart(). Otherwise, it will remain as set above (success)
   std::size_t i = 0;
   for (; i < trajectories_.size(); ++i)
   {
+    ros::WallTime segment_start = ros::WallTime::now();
     bool epart = executePart(i);
+    const double segment_duration = (ros::WallTime::now() - segment_start).toSec();
+    {
+      boost::mutex::scoped_lock slock(segment_durations_mutex_);
+      segment_durations_.push_back(segment_duration);
+    }
+    ROS_DEBUG_NAMED(name_, "Executed trajectory segment %zu in %lf s", i, segment_duration);
     if (epart && part_callback)
       part_callback(i);
     if (!epart || execution_complete_)
@@ -1309,10 +1729,21 @@ void TrajectoryExecutionManager::executeThread(const ExecutionCompleteCallback&
 
 bool TrajectoryExecutionManager::executePart(std::size_t part_index)
 {
+  moveit::tools::Profiler::ScopedBlock prof_block("TrajectoryExecutionManager::executePart");
+
   TrajectoryExecutionContext& context = *trajectories_[part_index];
 
-  // first make sure desired controllers are active
-  if (ensureActiveControllers(context.controllers_))
+  // first make sure desired controllers are active. with pipelined dispatch, a segment that
+  // uses the same controllers as its predecessor skips this step, so the controller manager
+  // is not queried in the middle of a multi-segment execution
+  bool controllers_active = pipeline_lookahead_ && context.controllers_ == last_ensured_controllers_;
+  if (!controllers_active)
+  {
+    controllers_active = ensureActiveControllers(context.controllers_);
+    if (controllers_active)
+      last_ensured_controllers_ = context.controllers_;
+  }
+  if (controllers_active)
   {
     // stop if we are already asked to do so
     if (execution_complete_)
@@ -1327,6 +1758,8 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
         time_index_mutex_.lock();
         current_context_ = part_index;
         time_index_mutex_.unlock();
+        in_flight_velocity_scaling_ = 1.0;
+        splice_deadline_extension_ = 0.0;
         active_handles_.resize(context.controllers_.size());
         for (std::size_t i = 0; i < context.controllers_.size(); ++i)
         {
@@ -1382,12 +1815,24 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
             last_execution_status_ = moveit_controller_manager::ExecutionStatus::ABORTED;
             return false;
           }
+          if (path_progress_callback_ &&
+              !active_handles_[i]->registerProgressCallback(path_progress_fraction_,
+                                                            boost::bind(path_progress_callback_, part_index, _1)))
+            ROS_DEBUG_NAMED(name_, "Controller handle '%s' does not report execution progress; the path progress "
+                                   "callback will not fire for this trajectory part.",
+                            active_handles_[i]->getName().c_str());
         }
       }
     }
 
     // compute the expected duration of the trajectory and find the part of the trajectory that takes longest to execute
     ros::Time current_time = ros::Time::now();
+    {
+      boost::mutex::scoped_lock slock(time_index_mutex_);
+      current_context_dispatch_time_ = current_time;
+    }
+    // one consistent snapshot of the tunables for the whole monitoring loop
+    const ExecutionParametersConstPtr exec_params = getExecutionParameters();
     ros::Duration expected_trajectory_duration(0.0);
     int longest_part = -1;
     for (std::size_t i = 0; i < context.trajectory_parts_.size(); ++i)
@@ -1422,13 +1867,13 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
           controller_allowed_execution_duration_scaling_.find(context.controllers_[i]);
       const double current_scaling = scaling_it != controller_allowed_execution_duration_scaling_.end() ?
                                          scaling_it->second :
-                                         allowed_execution_duration_scaling_;
+                                         exec_params->allowed_execution_duration_scaling;
 
       std::map<std::string, double>::const_iterator margin_it =
           controller_allowed_goal_duration_margin_.find(context.controllers_[i]);
       const double current_margin = margin_it != controller_allowed_goal_duration_margin_.end() ?
                                         margin_it->second :
-                                        allowed_goal_duration_margin_;
+                                        exec_params->allowed_goal_duration_margin;
 
       // expected duration is the duration of the longest part
       expected_trajectory_duration =
@@ -1466,14 +1911,43 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
     bool result = true;
     for (std::size_t i = 0; i < handles.size(); ++i)
     {
-      if (execution_duration_monitoring_)
+      if (exec_params->execution_duration_monitoring)
       {
-        if (!handles[i]->waitForExecution(expected_trajectory_duration))
-          if (!execution_complete_ && ros::Time::now() - current_time > expected_trajectory_duration)
+        // the deadline stretches if the in-flight trajectory is slowed down via
+        // setExecutionVelocityScaling(), so re-evaluate it whenever a wait times out
+        double last_progress = -1.0;
+        ros::Duration progress_extension(0.0);
+        while (result)
+        {
+          ros::Duration allowed_duration = expected_trajectory_duration;
+          const double in_flight_scaling = in_flight_velocity_scaling_;
+          if (in_flight_scaling > std::numeric_limits<double>::epsilon() && in_flight_scaling < 1.0)
+            allowed_duration *= 1.0 / in_flight_scaling;
+          allowed_duration += progress_extension;
+          allowed_duration += ros::Duration(splice_deadline_extension_.load());
+          const ros::Duration time_left = current_time + allowed_duration - ros::Time::now();
+          if (time_left > ros::Duration(0.0) && handles[i]->waitForExecution(time_left))
+            break;
+          if (execution_complete_)
+            break;
+          if (ros::Time::now() - current_time > allowed_duration)
           {
+            // a controller that reports progress through feedback overrides the coarse duration
+            // estimate: while it keeps advancing along its profile, extend the deadline instead
+            // of cancelling what is merely a slow, but healthy execution
+            const double progress = handles[i]->getExecutionProgress();
+            if (progress >= 0.0 && progress > last_progress + 1e-3)
+            {
+              last_progress = progress;
+              progress_extension += ros::Duration(std::max(exec_params->allowed_goal_duration_margin, 0.1));
+              ROS_WARN_NAMED(name_, "Trajectory execution exceeded its expected duration, but the controller "
+                                    "reports progress (%.0f%% complete); extending the deadline.",
+                            progress * 100.0);
+              continue;
+            }
             ROS_ERROR_NAMED(name_, "Controller is taking too long to execute trajectory (the expected upper "
                                    "bound for the trajectory execution was %lf seconds). Stopping trajectory.",
-                            expected_trajectory_duration.toSec());
+                            allowed_duration.toSec());
             {
               boost::mutex::scoped_lock slock(execution_state_mutex_);
               stopExecutionInternal();  // this is really tricky. we can't call stopExecution() here, so we call the
@@ -1481,8 +1955,11 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
             }
             last_execution_status_ = moveit_controller_manager::ExecutionStatus::TIMED_OUT;
             result = false;
-            break;
           }
+          // otherwise the allowed duration grew while we waited; wait for the remainder
+        }
+        if (!result)
+          break;
       }
       else
         handles[i]->waitForExecution();
@@ -1524,8 +2001,9 @@ bool TrajectoryExecutionManager::executePart(std::size_t part_index)
 
 bool TrajectoryExecutionManager::waitForRobotToStop(const TrajectoryExecutionContext& context, double wait_time)
 {
+  const ExecutionParametersConstPtr exec_params = getExecutionParameters();
   // skip waiting for convergence?
-  if (allowed_start_tolerance_ == 0 || !wait_for_trajectory_completion_)
+  if (exec_params->allowed_start_tolerance == 0 || !exec_params->wait_for_trajectory_completion)
   {
     ROS_DEBUG_NAMED(name_, "Not waiting for trajectory completion");
     return true;
@@ -1563,7 +2041,8 @@ bool TrajectoryExecutionManager::waitForRobotToStop(const TrajectoryExecutionCon
         if (!jm)
           continue;  // joint vanished from robot state (shouldn't happen), but we don't care
 
-        if (fabs(cur_state->getJointPositions(jm)[0] - prev_state->getJointPositions(jm)[0]) > allowed_start_tolerance_)
+        if (fabs(cur_state->getJointPositions(jm)[0] - prev_state->getJointPositions(jm)[0]) >
+            exec_params->allowed_start_tolerance)
         {
           moved = true;
           no_motion_count = 0;
@@ -1605,6 +2084,12 @@ moveit_controller_manager::ExecutionStatus TrajectoryExecutionManager::getLastEx
   return last_execution_status_;
 }
 
+std::vector<double> TrajectoryExecutionManager::getLastSegmentDurations() const
+{
+  boost::mutex::scoped_lock slock(segment_durations_mutex_);
+  return segment_durations_;
+}
+
 bool TrajectoryExecutionManager::ensureActiveControllersForGroup(const std::string& group)
 {
   const robot_model::JointModelGroup* joint_model_group = robot_model_->getJointModelGroup(group);
@@ -706,6 +706,19 @@ public:
       target. No execution is performed. The resulting plan is stored in \e plan*/
   MoveItErrorCode plan(Plan& plan);
 
+  /** \brief Compute a motion plan to any one of the \e goal_alternatives, submitted to move_group in a single
+      request. The planner returns a plan to the first alternative it reaches; this is much cheaper than calling
+      plan() once per candidate goal when any of them is acceptable. The resulting plan is stored in \e plan */
+  MoveItErrorCode planBatch(const std::vector<moveit_msgs::Constraints>& goal_alternatives, Plan& plan);
+
+  /** \brief Enable or disable session mode. In session mode plan() and planBatch() are submitted over a
+      persistent connection to the planning service instead of the move_group action, avoiding the per-goal
+      actionlib round trip; useful for task planner loops that issue many planning requests */
+  void setSessionMode(bool flag);
+
+  /** \brief Check whether session mode is enabled (see setSessionMode()) */
+  bool getSessionMode() const;
+
   /** \brief Given a \e plan, execute it without waiting for completion. Return true on success. */
   MoveItErrorCode asyncExecute(const Plan& plan);
 
@@ -39,7 +39,9 @@
 #include <stdexcept>
 #include <sstream>
 #include <memory>
+#ifndef MOVEIT_MINIMAL_RUNTIME
 #include <moveit/warehouse/constraints_storage.h>
+#endif
 #include <moveit/kinematic_constraints/utils.h>
 #include <moveit/move_group/capability_names.h>
 #include <moveit/move_group_pick_place_capability/capability_names.h>
@@ -57,6 +59,7 @@
 #include <moveit_msgs/QueryPlannerInterfaces.h>
 #include <moveit_msgs/GetCartesianPath.h>
 #include <moveit_msgs/GraspPlanning.h>
+#include <moveit_msgs/GetMotionPlan.h>
 #include <moveit_msgs/GetPlannerParams.h>
 #include <moveit_msgs/SetPlannerParams.h>
 
@@ -117,6 +120,7 @@ public:
     joint_state_target_->setToDefaultValues();
     active_target_ = JOINT;
     can_look_ = false;
+    session_mode_ = false;
     can_replan_ = false;
     replan_delay_ = 2.0;
     goal_joint_tolerance_ = 1e-4;
@@ -139,6 +143,7 @@ public:
 
     current_state_monitor_ = getSharedStateMonitor(robot_model_, tf_buffer_, node_handle_);
 
+    wait_for_servers_ = wait_for_servers;
     ros::WallTime timeout_for_servers = ros::WallTime::now() + wait_for_servers;
     if (wait_for_servers == ros::WallDuration())
       timeout_for_servers = ros::WallTime();  // wait for ever
@@ -148,13 +153,8 @@ public:
         new actionlib::SimpleActionClient<moveit_msgs::MoveGroupAction>(node_handle_, move_group::MOVE_ACTION, false));
     waitForAction(move_action_client_, move_group::MOVE_ACTION, timeout_for_servers, allotted_time);
 
-    pick_action_client_.reset(
-        new actionlib::SimpleActionClient<moveit_msgs::PickupAction>(node_handle_, move_group::PICKUP_ACTION, false));
-    waitForAction(pick_action_client_, move_group::PICKUP_ACTION, timeout_for_servers, allotted_time);
-
-    place_action_client_.reset(
-        new actionlib::SimpleActionClient<moveit_msgs::PlaceAction>(node_handle_, move_group::PLACE_ACTION, false));
-    waitForAction(place_action_client_, move_group::PLACE_ACTION, timeout_for_servers, allotted_time);
+    // the pick and place action clients are constructed lazily on first use; most instances
+    // never issue pick/place goals and should not pay for connecting to those servers
 
     execute_action_client_.reset(new actionlib::SimpleActionClient<moveit_msgs::ExecuteTrajectoryAction>(
         node_handle_, move_group::EXECUTE_ACTION_NAME, false));
@@ -232,10 +232,50 @@ public:
     }
   }
 
+  void ensurePickActionClient()
+  {
+    if (pick_action_client_)
+      return;
+    ros::WallTime timeout_for_servers = ros::WallTime::now() + wait_for_servers_;
+    if (wait_for_servers_ == ros::WallDuration())
+      timeout_for_servers = ros::WallTime();  // wait for ever
+    pick_action_client_.reset(
+        new actionlib::SimpleActionClient<moveit_msgs::PickupAction>(node_handle_, move_group::PICKUP_ACTION, false));
+    try
+    {
+      waitForAction(pick_action_client_, move_group::PICKUP_ACTION, timeout_for_servers, wait_for_servers_.toSec());
+    }
+    catch (const std::runtime_error& ex)
+    {
+      ROS_ERROR_NAMED("move_group_interface", "%s", ex.what());
+    }
+  }
+
+  void ensurePlaceActionClient()
+  {
+    if (place_action_client_)
+      return;
+    ros::WallTime timeout_for_servers = ros::WallTime::now() + wait_for_servers_;
+    if (wait_for_servers_ == ros::WallDuration())
+      timeout_for_servers = ros::WallTime();  // wait for ever
+    place_action_client_.reset(
+        new actionlib::SimpleActionClient<moveit_msgs::PlaceAction>(node_handle_, move_group::PLACE_ACTION, false));
+    try
+    {
+      waitForAction(place_action_client_, move_group::PLACE_ACTION, timeout_for_servers, wait_for_servers_.toSec());
+    }
+    catch (const std::runtime_error& ex)
+    {
+      ROS_ERROR_NAMED("move_group_interface", "%s", ex.what());
+    }
+  }
+
   ~MoveGroupInterfaceImpl()
   {
+#ifndef MOVEIT_MINIMAL_RUNTIME
     if (constraints_init_thread_)
       constraints_init_thread_->join();
+#endif
   }
 
   const std::shared_ptr<tf2_ros::Buffer>& getTF() const
@@ -606,6 +646,7 @@ public:
   MoveItErrorCode place(const std::string& object, const std::vector<moveit_msgs::PlaceLocation>& locations,
                         bool plan_only = false)
   {
+    ensurePlaceActionClient();
     if (!place_action_client_)
     {
       ROS_ERROR_STREAM_NAMED("move_group_interface", "Place action client not found");
@@ -646,6 +687,7 @@ public:
 
   MoveItErrorCode pick(const std::string& object, const std::vector<moveit_msgs::Grasp>& grasps, bool plan_only = false)
   {
+    ensurePickActionClient();
     if (!pick_action_client_)
     {
       ROS_ERROR_STREAM_NAMED("move_group_interface", "Pick action client not found");
@@ -732,8 +774,64 @@ public:
     return pick(object.id, response.grasps, plan_only);
   }
 
+  void setSessionMode(bool flag)
+  {
+    session_mode_ = flag;
+    if (flag && !plan_service_.isValid())
+      plan_service_ = node_handle_.serviceClient<moveit_msgs::GetMotionPlan>(move_group::PLANNER_SERVICE_NAME, true);
+  }
+
+  bool getSessionMode() const
+  {
+    return session_mode_;
+  }
+
+  /** Submit a planning request over the persistent planning service connection; in session
+      mode this avoids the per-goal actionlib round trip of plan() */
+  MoveItErrorCode planViaService(moveit_msgs::MotionPlanRequest& request, Plan& plan)
+  {
+    if (!plan_service_.isValid())  // reconnect if move_group was restarted
+      plan_service_ = node_handle_.serviceClient<moveit_msgs::GetMotionPlan>(move_group::PLANNER_SERVICE_NAME, true);
+
+    moveit_msgs::GetMotionPlan::Request req;
+    moveit_msgs::GetMotionPlan::Response res;
+    req.motion_plan_request = request;
+    if (!plan_service_.call(req, res))
+    {
+      ROS_WARN_STREAM_NAMED("move_group_interface", "Fail: planning service call failed");
+      return MoveItErrorCode(moveit_msgs::MoveItErrorCodes::FAILURE);
+    }
+    plan.trajectory_ = res.motion_plan_response.trajectory;
+    plan.start_state_ = res.motion_plan_response.trajectory_start;
+    plan.planning_time_ = res.motion_plan_response.planning_time;
+    return MoveItErrorCode(res.motion_plan_response.error_code);
+  }
+
+  MoveItErrorCode planBatch(const std::vector<moveit_msgs::Constraints>& goal_alternatives, Plan& plan)
+  {
+    if (goal_alternatives.empty())
+    {
+      ROS_ERROR_NAMED("move_group_interface", "No goal alternatives specified");
+      return MoveItErrorCode(moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS);
+    }
+    // multiple entries in goal_constraints are treated as alternative goals by the planning
+    // pipeline, so all alternatives are submitted in a single request and the first one the
+    // planner reaches produces the returned plan
+    moveit_msgs::MotionPlanRequest request;
+    constructMotionPlanRequest(request);
+    request.goal_constraints = goal_alternatives;
+    return planViaService(request, plan);
+  }
+
   MoveItErrorCode plan(Plan& plan)
   {
+    if (session_mode_)
+    {
+      moveit_msgs::MotionPlanRequest request;
+      constructMotionPlanRequest(request);
+      return planViaService(request, plan);
+    }
+
     if (!move_action_client_)
     {
       return MoveItErrorCode(moveit_msgs::MoveItErrorCodes::FAILURE);
@@ -1117,6 +1215,7 @@ public:
 
   bool setPathConstraints(const std::string& constraint)
   {
+#ifndef MOVEIT_MINIMAL_RUNTIME
     if (constraints_storage_)
     {
       moveit_warehouse::ConstraintsWithMetadata msg_m;
@@ -1125,11 +1224,11 @@ public:
         path_constraints_.reset(new moveit_msgs::Constraints(static_cast<moveit_msgs::Constraints>(*msg_m)));
         return true;
       }
-      else
-        return false;
     }
-    else
-      return false;
+#else
+    (void)constraint;
+#endif
+    return false;
   }
 
   void clearPathConstraints()
@@ -1149,16 +1248,17 @@ public:
 
   std::vector<std::string> getKnownConstraints() const
   {
+    std::vector<std::string> c;
+#ifndef MOVEIT_MINIMAL_RUNTIME
     while (initializing_constraints_)
     {
       static ros::WallDuration d(0.01);
       d.sleep();
     }
 
-    std::vector<std::string> c;
     if (constraints_storage_)
       constraints_storage_->getKnownConstraints(c, robot_model_->getName(), opt_.group_name_);
-
+#endif
     return c;
   }
 
@@ -1180,11 +1280,18 @@ public:
 
   void initializeConstraintsStorage(const std::string& host, unsigned int port)
   {
+#ifndef MOVEIT_MINIMAL_RUNTIME
     initializing_constraints_ = true;
     if (constraints_init_thread_)
       constraints_init_thread_->join();
     constraints_init_thread_.reset(
         new boost::thread(boost::bind(&MoveGroupInterfaceImpl::initializeConstraintsStorageThread, this, host, port)));
+#else
+    (void)host;
+    (void)port;
+    ROS_WARN_NAMED("move_group_interface",
+                   "Built with MOVEIT_MINIMAL_RUNTIME; warehouse constraints storage is not available");
+#endif
   }
 
   void setWorkspace(double minx, double miny, double minz, double maxx, double maxy, double maxz)
@@ -1200,6 +1307,7 @@ public:
   }
 
 private:
+#ifndef MOVEIT_MINIMAL_RUNTIME
   void initializeConstraintsStorageThread(const std::string& host, unsigned int port)
   {
     // Set up db
@@ -1218,6 +1326,7 @@ private:
     }
     initializing_constraints_ = false;
   }
+#endif
 
   Options opt_;
   ros::NodeHandle node_handle_;
@@ -1268,8 +1377,13 @@ private:
   ros::ServiceClient set_params_service_;
   ros::ServiceClient cartesian_path_service_;
   ros::ServiceClient plan_grasps_service_;
+  ros::ServiceClient plan_service_;  // persistent connection, used in session mode
+  ros::WallDuration wait_for_servers_;
+  bool session_mode_;
+#ifndef MOVEIT_MINIMAL_RUNTIME
   std::unique_ptr<moveit_warehouse::ConstraintsStorage> constraints_storage_;
   std::unique_ptr<boost::thread> constraints_init_thread_;
+#endif
   bool initializing_constraints_;
 };
 }
@@ -1443,6 +1557,22 @@ moveit::planning_interface::MoveItErrorCode moveit::planning_interface::MoveGrou
   return impl_->plan(plan);
 }
 
+moveit::planning_interface::MoveItErrorCode moveit::planning_interface::MoveGroupInterface::planBatch(
+    const std::vector<moveit_msgs::Constraints>& goal_alternatives, Plan& plan)
+{
+  return impl_->planBatch(goal_alternatives, plan);
+}
+
+void moveit::planning_interface::MoveGroupInterface::setSessionMode(bool flag)
+{
+  impl_->setSessionMode(flag);
+}
+
+bool moveit::planning_interface::MoveGroupInterface::getSessionMode() const
+{
+  return impl_->getSessionMode();
+}
+
 moveit::planning_interface::MoveItErrorCode
 moveit::planning_interface::MoveGroupInterface::pick(const std::string& object, bool plan_only)
 {
@@ -37,6 +37,7 @@
 #include <moveit/move_group_interface/move_group_interface.h>
 #include <moveit/py_bindings_tools/roscpp_initializer.h>
 #include <moveit/py_bindings_tools/py_conversions.h>
+#include <moveit/py_bindings_tools/py_buffer.h>
 #include <moveit/py_bindings_tools/serialize_msg.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit/robot_trajectory/robot_trajectory.h>
@@ -130,6 +131,13 @@ public:
     return l;
   }
 
+  bp::object getJointValueTargetBuffer()
+  {
+    const robot_state::RobotState& values = moveit::planning_interface::MoveGroupInterface::getJointValueTarget();
+    std::vector<double> v(values.getVariablePositions(), values.getVariablePositions() + getVariableCount());
+    return py_bindings_tools::bufferFromDouble(v);
+  }
+
   std::string getJointValueTarget()
   {
     moveit_msgs::RobotState msg;
@@ -170,6 +178,12 @@ public:
     return py_bindings_tools::listFromDouble(getCurrentJointValues());
   }
 
+  bp::object getCurrentJointValuesBuffer()
+  {
+    std::vector<double> v = getCurrentJointValues();
+    return py_bindings_tools::bufferFromDouble(v);
+  }
+
   bp::list getRandomJointValuesList()
   {
     return py_bindings_tools::listFromDouble(getRandomJointValues());
@@ -432,6 +446,38 @@ public:
     return py_bindings_tools::serializeMsg(plan.trajectory_);
   }
 
+  /** Flatten the joint trajectory of \e traj into (joint_names, times, positions) where times and
+      positions are read-only buffers; positions holds the waypoints row by row, so
+      numpy.frombuffer(positions).reshape(-1, len(joint_names)) views them without a copy */
+  bp::tuple trajectoryToArrays(const moveit_msgs::RobotTrajectory& traj)
+  {
+    const trajectory_msgs::JointTrajectory& jt = traj.joint_trajectory;
+    std::vector<double> times(jt.points.size());
+    std::vector<double> positions;
+    positions.reserve(jt.points.size() * jt.joint_names.size());
+    for (std::size_t i = 0; i < jt.points.size(); ++i)
+    {
+      times[i] = jt.points[i].time_from_start.toSec();
+      positions.insert(positions.end(), jt.points[i].positions.begin(), jt.points[i].positions.end());
+    }
+    return bp::make_tuple(py_bindings_tools::listFromString(jt.joint_names), py_bindings_tools::bufferFromDouble(times),
+                          py_bindings_tools::bufferFromDouble(positions));
+  }
+
+  bp::tuple getPlanBufferPython()
+  {
+    MoveGroupInterface::Plan plan;
+    MoveGroupInterface::plan(plan);
+    return trajectoryToArrays(plan.trajectory_);
+  }
+
+  bp::tuple convertTrajectoryToBuffers(const std::string& traj_str)
+  {
+    moveit_msgs::RobotTrajectory traj;
+    py_bindings_tools::deserializeMsg(traj_str, traj);
+    return trajectoryToArrays(traj);
+  }
+
   bp::tuple computeCartesianPathPython(const bp::list& waypoints, double eef_step, double jump_threshold,
                                        bool avoid_collisions)
   {
@@ -592,6 +638,7 @@ static void wrap_move_group_interface()
                               &MoveGroupInterfaceWrapper::setJointValueTargetFromJointStatePython);
 
   MoveGroupInterfaceClass.def("get_joint_value_target", &MoveGroupInterfaceWrapper::getJointValueTargetPythonList);
+  MoveGroupInterfaceClass.def("get_joint_value_target_buffer", &MoveGroupInterfaceWrapper::getJointValueTargetBuffer);
 
   MoveGroupInterfaceClass.def("set_named_target", &MoveGroupInterfaceWrapper::setNamedTarget);
   MoveGroupInterfaceClass.def("set_random_target", &MoveGroupInterfaceWrapper::setRandomTarget);
@@ -604,6 +651,8 @@ static void wrap_move_group_interface()
 
   MoveGroupInterfaceClass.def("start_state_monitor", &MoveGroupInterfaceWrapper::startStateMonitor);
   MoveGroupInterfaceClass.def("get_current_joint_values", &MoveGroupInterfaceWrapper::getCurrentJointValuesList);
+  MoveGroupInterfaceClass.def("get_current_joint_values_buffer",
+                              &MoveGroupInterfaceWrapper::getCurrentJointValuesBuffer);
   MoveGroupInterfaceClass.def("get_random_joint_values", &MoveGroupInterfaceWrapper::getRandomJointValuesList);
   MoveGroupInterfaceClass.def("get_remembered_joint_values",
                               &MoveGroupInterfaceWrapper::getRememberedJointValuesPython);
@@ -643,6 +692,8 @@ static void wrap_move_group_interface()
   MoveGroupInterfaceClass.def("set_planner_id", &MoveGroupInterfaceWrapper::setPlannerId);
   MoveGroupInterfaceClass.def("set_num_planning_attempts", &MoveGroupInterfaceWrapper::setNumPlanningAttempts);
   MoveGroupInterfaceClass.def("compute_plan", &MoveGroupInterfaceWrapper::getPlanPython);
+  MoveGroupInterfaceClass.def("compute_plan_buffer", &MoveGroupInterfaceWrapper::getPlanBufferPython);
+  MoveGroupInterfaceClass.def("convert_trajectory_to_buffers", &MoveGroupInterfaceWrapper::convertTrajectoryToBuffers);
   MoveGroupInterfaceClass.def("compute_cartesian_path", &MoveGroupInterfaceWrapper::computeCartesianPathPython);
   MoveGroupInterfaceClass.def("compute_cartesian_path",
                               &MoveGroupInterfaceWrapper::computeCartesianPathConstrainedPython);
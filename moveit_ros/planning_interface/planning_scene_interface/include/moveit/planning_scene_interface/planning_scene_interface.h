@@ -84,6 +84,19 @@ public:
   /** \brief Get the poses from the objects identified by the given object ids list. */
   std::map<std::string, geometry_msgs::Pose> getObjectPoses(const std::vector<std::string>& object_ids);
 
+  /** \brief Maintain a local mirror of the world and attached objects by listening to the scene updates
+      move_group publishes on \e monitored_scene_topic, so that the get*() calls above are answered locally
+      instead of performing a service round trip each time. The mirror is seeded with a full download and
+      then updated incrementally from the published diffs. Useful when object poses are polled at a high rate. */
+  void startObjectMirror(const std::string& monitored_scene_topic = "move_group/monitored_planning_scene");
+
+  /** \brief Stop mirroring the planning scene; the get*() calls go back to using the service. */
+  void stopObjectMirror();
+
+  /** \brief Replace the contents of the object mirror with a full download from the planning scene service.
+      Returns false if the service call fails. Only meaningful while the mirror is active. */
+  bool refreshObjectMirror();
+
   /** \brief Get the objects identified by the given object ids list. If no ids are provided, return all the known
    * objects. */
   std::map<std::string, moveit_msgs::CollisionObject>
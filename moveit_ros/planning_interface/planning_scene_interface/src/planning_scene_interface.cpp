@@ -39,7 +39,10 @@
 #include <moveit_msgs/GetPlanningScene.h>
 #include <moveit_msgs/ApplyPlanningScene.h>
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <boost/thread/mutex.hpp>
 #include <algorithm>
+#include <memory>
 
 namespace moveit
 {
@@ -48,7 +51,7 @@ namespace planning_interface
 class PlanningSceneInterface::PlanningSceneInterfaceImpl
 {
 public:
-  explicit PlanningSceneInterfaceImpl(const std::string& ns = "")
+  explicit PlanningSceneInterfaceImpl(const std::string& ns = "") : mirror_active_(false)
   {
     node_handle_ = ros::NodeHandle(ns);
     planning_scene_service_ =
@@ -58,11 +61,71 @@ public:
     planning_scene_diff_publisher_ = node_handle_.advertise<moveit_msgs::PlanningScene>("planning_scene", 1);
   }
 
-  std::vector<std::string> getKnownObjectNames(bool with_type)
+  void startObjectMirror(const std::string& monitored_scene_topic)
+  {
+    if (mirror_active_)
+      return;
+    // the subscription gets its own queue and spinner so the mirror is updated even if the
+    // process does not service the global callback queue
+    ros::SubscribeOptions ops = ros::SubscribeOptions::create<moveit_msgs::PlanningScene>(
+        monitored_scene_topic, 100, boost::bind(&PlanningSceneInterfaceImpl::monitoredSceneCallback, this, _1),
+        ros::VoidConstPtr(), &mirror_queue_);
+    monitored_scene_subscriber_ = node_handle_.subscribe(ops);
+    mirror_spinner_.reset(new ros::AsyncSpinner(1, &mirror_queue_));
+    mirror_spinner_->start();
+    mirror_active_ = true;
+    if (!refreshObjectMirror())
+      ROS_WARN_NAMED("planning_scene_interface", "Could not seed the object mirror from the planning scene service");
+  }
+
+  void stopObjectMirror()
+  {
+    if (!mirror_active_)
+      return;
+    mirror_active_ = false;
+    monitored_scene_subscriber_.shutdown();
+    mirror_spinner_.reset();
+    boost::mutex::scoped_lock slock(mirror_lock_);
+    mirror_objects_.clear();
+    mirror_attached_objects_.clear();
+  }
+
+  bool refreshObjectMirror()
   {
     moveit_msgs::GetPlanningScene::Request request;
     moveit_msgs::GetPlanningScene::Response response;
+    request.components.components =
+        request.components.WORLD_OBJECT_GEOMETRY | request.components.ROBOT_STATE_ATTACHED_OBJECTS;
+    if (!planning_scene_service_.call(request, response))
+    {
+      ROS_WARN_NAMED("planning_scene_interface", "Could not call planning scene service to refresh the object mirror");
+      return false;
+    }
+    boost::mutex::scoped_lock slock(mirror_lock_);
+    mirror_objects_.clear();
+    mirror_attached_objects_.clear();
+    for (std::size_t i = 0; i < response.scene.world.collision_objects.size(); ++i)
+      mirror_objects_[response.scene.world.collision_objects[i].id] = response.scene.world.collision_objects[i];
+    for (std::size_t i = 0; i < response.scene.robot_state.attached_collision_objects.size(); ++i)
+      mirror_attached_objects_[response.scene.robot_state.attached_collision_objects[i].object.id] =
+          response.scene.robot_state.attached_collision_objects[i];
+    return true;
+  }
+
+  std::vector<std::string> getKnownObjectNames(bool with_type)
+  {
     std::vector<std::string> result;
+    if (mirror_active_)
+    {
+      boost::mutex::scoped_lock slock(mirror_lock_);
+      for (std::map<std::string, moveit_msgs::CollisionObject>::const_iterator it = mirror_objects_.begin();
+           it != mirror_objects_.end(); ++it)
+        if (!with_type || !it->second.type.key.empty())
+          result.push_back(it->first);
+      return result;
+    }
+    moveit_msgs::GetPlanningScene::Request request;
+    moveit_msgs::GetPlanningScene::Response response;
     request.components.components = request.components.WORLD_OBJECT_NAMES;
     if (!planning_scene_service_.call(request, response))
       return result;
@@ -83,51 +146,42 @@ public:
   std::vector<std::string> getKnownObjectNamesInROI(double minx, double miny, double minz, double maxx, double maxy,
                                                     double maxz, bool with_type, std::vector<std::string>& types)
   {
-    moveit_msgs::GetPlanningScene::Request request;
-    moveit_msgs::GetPlanningScene::Response response;
     std::vector<std::string> result;
-    request.components.components = request.components.WORLD_OBJECT_GEOMETRY;
-    if (!planning_scene_service_.call(request, response))
+    std::vector<moveit_msgs::CollisionObject> objects;
+    if (!getWorldObjects(objects))
     {
       ROS_WARN_NAMED("planning_scene_interface", "Could not call planning scene service to get object names");
       return result;
     }
 
-    for (std::size_t i = 0; i < response.scene.world.collision_objects.size(); ++i)
+    for (std::size_t i = 0; i < objects.size(); ++i)
     {
-      if (with_type && response.scene.world.collision_objects[i].type.key.empty())
+      if (with_type && objects[i].type.key.empty())
         continue;
-      if (response.scene.world.collision_objects[i].mesh_poses.empty() &&
-          response.scene.world.collision_objects[i].primitive_poses.empty())
+      if (objects[i].mesh_poses.empty() && objects[i].primitive_poses.empty())
         continue;
       bool good = true;
-      for (std::size_t j = 0; j < response.scene.world.collision_objects[i].mesh_poses.size(); ++j)
-        if (!(response.scene.world.collision_objects[i].mesh_poses[j].position.x >= minx &&
-              response.scene.world.collision_objects[i].mesh_poses[j].position.x <= maxx &&
-              response.scene.world.collision_objects[i].mesh_poses[j].position.y >= miny &&
-              response.scene.world.collision_objects[i].mesh_poses[j].position.y <= maxy &&
-              response.scene.world.collision_objects[i].mesh_poses[j].position.z >= minz &&
-              response.scene.world.collision_objects[i].mesh_poses[j].position.z <= maxz))
+      for (std::size_t j = 0; j < objects[i].mesh_poses.size(); ++j)
+        if (!(objects[i].mesh_poses[j].position.x >= minx && objects[i].mesh_poses[j].position.x <= maxx &&
+              objects[i].mesh_poses[j].position.y >= miny && objects[i].mesh_poses[j].position.y <= maxy &&
+              objects[i].mesh_poses[j].position.z >= minz && objects[i].mesh_poses[j].position.z <= maxz))
         {
           good = false;
           break;
         }
-      for (std::size_t j = 0; j < response.scene.world.collision_objects[i].primitive_poses.size(); ++j)
-        if (!(response.scene.world.collision_objects[i].primitive_poses[j].position.x >= minx &&
-              response.scene.world.collision_objects[i].primitive_poses[j].position.x <= maxx &&
-              response.scene.world.collision_objects[i].primitive_poses[j].position.y >= miny &&
-              response.scene.world.collision_objects[i].primitive_poses[j].position.y <= maxy &&
-              response.scene.world.collision_objects[i].primitive_poses[j].position.z >= minz &&
-              response.scene.world.collision_objects[i].primitive_poses[j].position.z <= maxz))
+      for (std::size_t j = 0; j < objects[i].primitive_poses.size(); ++j)
+        if (!(objects[i].primitive_poses[j].position.x >= minx && objects[i].primitive_poses[j].position.x <= maxx &&
+              objects[i].primitive_poses[j].position.y >= miny && objects[i].primitive_poses[j].position.y <= maxy &&
+              objects[i].primitive_poses[j].position.z >= minz && objects[i].primitive_poses[j].position.z <= maxz))
         {
           good = false;
           break;
         }
       if (good)
       {
-        result.push_back(response.scene.world.collision_objects[i].id);
+        result.push_back(objects[i].id);
         if (with_type)
-          types.push_back(response.scene.world.collision_objects[i].type.key);
+          types.push_back(objects[i].type.key);
       }
     }
     return result;
@@ -135,30 +189,24 @@ public:
 
   std::map<std::string, geometry_msgs::Pose> getObjectPoses(const std::vector<std::string>& object_ids)
   {
-    moveit_msgs::GetPlanningScene::Request request;
-    moveit_msgs::GetPlanningScene::Response response;
     std::map<std::string, geometry_msgs::Pose> result;
-    request.components.components = request.components.WORLD_OBJECT_GEOMETRY;
-    if (!planning_scene_service_.call(request, response))
+    std::vector<moveit_msgs::CollisionObject> objects;
+    if (!getWorldObjects(objects))
     {
       ROS_WARN_NAMED("planning_scene_interface", "Could not call planning scene service to get object names");
       return result;
     }
 
-    for (std::size_t i = 0; i < response.scene.world.collision_objects.size(); ++i)
+    for (std::size_t i = 0; i < objects.size(); ++i)
     {
-      if (std::find(object_ids.begin(), object_ids.end(), response.scene.world.collision_objects[i].id) !=
-          object_ids.end())
+      if (std::find(object_ids.begin(), object_ids.end(), objects[i].id) != object_ids.end())
       {
-        if (response.scene.world.collision_objects[i].mesh_poses.empty() &&
-            response.scene.world.collision_objects[i].primitive_poses.empty())
+        if (objects[i].mesh_poses.empty() && objects[i].primitive_poses.empty())
           continue;
-        if (!response.scene.world.collision_objects[i].mesh_poses.empty())
-          result[response.scene.world.collision_objects[i].id] =
-              response.scene.world.collision_objects[i].mesh_poses[0];
+        if (!objects[i].mesh_poses.empty())
+          result[objects[i].id] = objects[i].mesh_poses[0];
         else
-          result[response.scene.world.collision_objects[i].id] =
-              response.scene.world.collision_objects[i].primitive_poses[0];
+          result[objects[i].id] = objects[i].primitive_poses[0];
       }
     }
     return result;
@@ -166,24 +214,18 @@ public:
 
   std::map<std::string, moveit_msgs::CollisionObject> getObjects(const std::vector<std::string>& object_ids)
   {
-    moveit_msgs::GetPlanningScene::Request request;
-    moveit_msgs::GetPlanningScene::Response response;
     std::map<std::string, moveit_msgs::CollisionObject> result;
-    request.components.components = request.components.WORLD_OBJECT_GEOMETRY;
-    if (!planning_scene_service_.call(request, response))
+    std::vector<moveit_msgs::CollisionObject> objects;
+    if (!getWorldObjects(objects))
     {
       ROS_WARN_NAMED("planning_scene_interface", "Could not call planning scene service to get object geometries");
       return result;
     }
 
-    for (std::size_t i = 0; i < response.scene.world.collision_objects.size(); ++i)
+    for (std::size_t i = 0; i < objects.size(); ++i)
     {
-      if (object_ids.empty() ||
-          std::find(object_ids.begin(), object_ids.end(), response.scene.world.collision_objects[i].id) !=
-              object_ids.end())
-      {
-        result[response.scene.world.collision_objects[i].id] = response.scene.world.collision_objects[i];
-      }
+      if (object_ids.empty() || std::find(object_ids.begin(), object_ids.end(), objects[i].id) != object_ids.end())
+        result[objects[i].id] = objects[i];
     }
     return result;
   }
@@ -191,9 +233,20 @@ public:
   std::map<std::string, moveit_msgs::AttachedCollisionObject>
   getAttachedObjects(const std::vector<std::string>& object_ids)
   {
+    std::map<std::string, moveit_msgs::AttachedCollisionObject> result;
+    if (mirror_active_)
+    {
+      boost::mutex::scoped_lock slock(mirror_lock_);
+      for (std::map<std::string, moveit_msgs::AttachedCollisionObject>::const_iterator it =
+               mirror_attached_objects_.begin();
+           it != mirror_attached_objects_.end(); ++it)
+        if (object_ids.empty() || std::find(object_ids.begin(), object_ids.end(), it->first) != object_ids.end())
+          result[it->first] = it->second;
+      return result;
+    }
+
     moveit_msgs::GetPlanningScene::Request request;
     moveit_msgs::GetPlanningScene::Response response;
-    std::map<std::string, moveit_msgs::AttachedCollisionObject> result;
     request.components.components = request.components.ROBOT_STATE_ATTACHED_OBJECTS;
     if (!planning_scene_service_.call(request, response))
     {
@@ -262,11 +315,105 @@ public:
   }
 
 private:
+  /** Get the world objects either from the local mirror (no communication) or with a service call */
+  bool getWorldObjects(std::vector<moveit_msgs::CollisionObject>& objects)
+  {
+    if (mirror_active_)
+    {
+      boost::mutex::scoped_lock slock(mirror_lock_);
+      for (std::map<std::string, moveit_msgs::CollisionObject>::const_iterator it = mirror_objects_.begin();
+           it != mirror_objects_.end(); ++it)
+        objects.push_back(it->second);
+      return true;
+    }
+    moveit_msgs::GetPlanningScene::Request request;
+    moveit_msgs::GetPlanningScene::Response response;
+    request.components.components = request.components.WORLD_OBJECT_GEOMETRY;
+    if (!planning_scene_service_.call(request, response))
+      return false;
+    objects.swap(response.scene.world.collision_objects);
+    return true;
+  }
+
+  void monitoredSceneCallback(const moveit_msgs::PlanningSceneConstPtr& scene)
+  {
+    boost::mutex::scoped_lock slock(mirror_lock_);
+    if (!scene->is_diff)
+    {
+      mirror_objects_.clear();
+      mirror_attached_objects_.clear();
+    }
+    for (std::size_t i = 0; i < scene->world.collision_objects.size(); ++i)
+      applyObjectDiff(scene->world.collision_objects[i]);
+    for (std::size_t i = 0; i < scene->robot_state.attached_collision_objects.size(); ++i)
+    {
+      const moveit_msgs::AttachedCollisionObject& aco = scene->robot_state.attached_collision_objects[i];
+      if (aco.object.operation == moveit_msgs::CollisionObject::REMOVE)
+      {
+        if (aco.object.id.empty())
+          mirror_attached_objects_.clear();
+        else
+          mirror_attached_objects_.erase(aco.object.id);
+      }
+      else
+        mirror_attached_objects_[aco.object.id] = aco;
+    }
+  }
+
+  void applyObjectDiff(const moveit_msgs::CollisionObject& object)
+  {
+    if (object.operation == moveit_msgs::CollisionObject::ADD)
+      mirror_objects_[object.id] = object;
+    else if (object.operation == moveit_msgs::CollisionObject::REMOVE)
+    {
+      // an unnamed REMOVE clears the world
+      if (object.id.empty())
+        mirror_objects_.clear();
+      else
+        mirror_objects_.erase(object.id);
+    }
+    else if (object.operation == moveit_msgs::CollisionObject::APPEND)
+    {
+      moveit_msgs::CollisionObject& target = mirror_objects_[object.id];
+      target.id = object.id;
+      target.header = object.header;
+      target.primitives.insert(target.primitives.end(), object.primitives.begin(), object.primitives.end());
+      target.primitive_poses.insert(target.primitive_poses.end(), object.primitive_poses.begin(),
+                                    object.primitive_poses.end());
+      target.meshes.insert(target.meshes.end(), object.meshes.begin(), object.meshes.end());
+      target.mesh_poses.insert(target.mesh_poses.end(), object.mesh_poses.begin(), object.mesh_poses.end());
+      target.planes.insert(target.planes.end(), object.planes.begin(), object.planes.end());
+      target.plane_poses.insert(target.plane_poses.end(), object.plane_poses.begin(), object.plane_poses.end());
+    }
+    else if (object.operation == moveit_msgs::CollisionObject::MOVE)
+    {
+      std::map<std::string, moveit_msgs::CollisionObject>::iterator it = mirror_objects_.find(object.id);
+      if (it != mirror_objects_.end())
+      {
+        it->second.header = object.header;
+        if (!object.primitive_poses.empty())
+          it->second.primitive_poses = object.primitive_poses;
+        if (!object.mesh_poses.empty())
+          it->second.mesh_poses = object.mesh_poses;
+        if (!object.plane_poses.empty())
+          it->second.plane_poses = object.plane_poses;
+      }
+    }
+  }
+
   ros::NodeHandle node_handle_;
   ros::ServiceClient planning_scene_service_;
   ros::ServiceClient apply_planning_scene_service_;
   ros::Publisher planning_scene_diff_publisher_;
   robot_model::RobotModelConstPtr robot_model_;
+
+  ros::Subscriber monitored_scene_subscriber_;
+  ros::CallbackQueue mirror_queue_;
+  std::unique_ptr<ros::AsyncSpinner> mirror_spinner_;
+  bool mirror_active_;
+  boost::mutex mirror_lock_;
+  std::map<std::string, moveit_msgs::CollisionObject> mirror_objects_;
+  std::map<std::string, moveit_msgs::AttachedCollisionObject> mirror_attached_objects_;
 };
 
 PlanningSceneInterface::PlanningSceneInterface(const std::string& ns)
@@ -298,6 +445,21 @@ PlanningSceneInterface::getObjectPoses(const std::vector<std::string>& object_id
   return impl_->getObjectPoses(object_ids);
 }
 
+void PlanningSceneInterface::startObjectMirror(const std::string& monitored_scene_topic)
+{
+  impl_->startObjectMirror(monitored_scene_topic);
+}
+
+void PlanningSceneInterface::stopObjectMirror()
+{
+  impl_->stopObjectMirror();
+}
+
+bool PlanningSceneInterface::refreshObjectMirror()
+{
+  return impl_->refreshObjectMirror();
+}
+
 std::map<std::string, moveit_msgs::CollisionObject>
 PlanningSceneInterface::getObjects(const std::vector<std::string>& object_ids)
 {
@@ -110,6 +110,11 @@ public:
     py_bindings_tools::deserializeMsg(ps_str, ps_msg);
     return applyPlanningScene(ps_msg);
   }
+
+  void startObjectMirrorPython()
+  {
+    startObjectMirror();
+  }
 };
 
 static void wrap_planning_scene_interface()
@@ -124,6 +129,9 @@ static void wrap_planning_scene_interface()
   PlanningSceneClass.def("get_objects", &PlanningSceneInterfaceWrapper::getObjectsPython);
   PlanningSceneClass.def("get_attached_objects", &PlanningSceneInterfaceWrapper::getAttachedObjectsPython);
   PlanningSceneClass.def("apply_planning_scene", &PlanningSceneInterfaceWrapper::applyPlanningScenePython);
+  PlanningSceneClass.def("start_object_mirror", &PlanningSceneInterfaceWrapper::startObjectMirrorPython);
+  PlanningSceneClass.def("stop_object_mirror", &PlanningSceneInterfaceWrapper::stopObjectMirror);
+  PlanningSceneClass.def("refresh_object_mirror", &PlanningSceneInterfaceWrapper::refreshObjectMirror);
 }
 }
 }
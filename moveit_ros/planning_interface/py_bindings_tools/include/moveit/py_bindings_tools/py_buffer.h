@@ -0,0 +1,99 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_PY_BINDINGS_TOOLS_PY_BUFFER_
+#define MOVEIT_PY_BINDINGS_TOOLS_PY_BUFFER_
+
+#include <boost/python.hpp>
+#include <Python.h>
+#include <vector>
+
+namespace moveit
+{
+namespace py_bindings_tools
+{
+namespace detail
+{
+static const char* DOUBLE_BUFFER_CAPSULE_NAME = "moveit.py_bindings_tools.double_buffer";
+
+inline void deleteDoubleBuffer(PyObject* capsule)
+{
+  delete reinterpret_cast<std::vector<double>*>(PyCapsule_GetPointer(capsule, DOUBLE_BUFFER_CAPSULE_NAME));
+}
+}
+
+/** \brief Expose a vector of doubles to Python as a read-only memoryview, without copying the data
+    element by element through a Python list.
+
+    The vector contents are moved into a heap-allocated holder whose lifetime is tied to the returned
+    memoryview (via a capsule), so the view stays valid for as long as Python holds a reference to it.
+    The view uses format 'd'; numpy.frombuffer(view) yields a zero-copy float64 array over the same
+    memory. The input vector is left empty. */
+inline boost::python::object bufferFromDouble(std::vector<double>& v)
+{
+  std::vector<double>* holder = new std::vector<double>();
+  holder->swap(v);
+
+  PyObject* capsule = PyCapsule_New(holder, detail::DOUBLE_BUFFER_CAPSULE_NAME, &detail::deleteDoubleBuffer);
+  if (!capsule)
+  {
+    delete holder;
+    boost::python::throw_error_already_set();
+  }
+
+  // the buffer must point at valid memory even for an empty vector
+  static double empty_buffer_sentinel = 0.0;
+  double* data = holder->empty() ? &empty_buffer_sentinel : &(*holder)[0];
+
+  Py_buffer view;
+  if (PyBuffer_FillInfo(&view, capsule, data, holder->size() * sizeof(double), 1 /* read-only */, PyBUF_CONTIG_RO) != 0)
+  {
+    Py_DECREF(capsule);
+    boost::python::throw_error_already_set();
+  }
+
+  // the memoryview takes over the Py_buffer (and with it the reference FillInfo took on the capsule)
+  PyObject* memory_view = PyMemoryView_FromBuffer(&view);
+  Py_DECREF(capsule);
+  if (!memory_view)
+    boost::python::throw_error_already_set();
+
+  // PyBuffer_FillInfo describes raw bytes; re-type the view as an array of doubles
+  boost::python::object byte_view((boost::python::handle<>(memory_view)));
+  return byte_view.attr("cast")("d");
+}
+}
+}
+
+#endif
@@ -73,6 +73,9 @@ public:
   // it.
   //
   // The transforms in the returned state will always be up to date.
+  //
+  // This returns the last published state and never waits for a modify
+  // function (e.g. an IK solve) that is still running.
   robot_state::RobotStateConstPtr getState() const;
 
   /// Set the state to the new value.
@@ -107,6 +110,21 @@ private:
   // When a modify function is being called this is NULL.
   // PROTECTED BY state_lock_
   robot_state::RobotStatePtr state_;
+
+  // The last fully updated state, handed out to readers. Never modified in
+  // place once published; only replaced wholesale, so readers see a
+  // consistent snapshot without contending on state_lock_.
+  // PROTECTED BY publish_lock_
+  robot_state::RobotStatePtr published_state_;
+
+  // Retired publication buffer; reused for the next modification once all
+  // readers have released it, so steady-state dragging does not allocate.
+  // PROTECTED BY publish_lock_
+  robot_state::RobotStatePtr spare_state_;
+
+  // Guards the publication buffers. Acquired after state_lock_, never the
+  // other way around.
+  mutable boost::mutex publish_lock_;
 };
 }
 
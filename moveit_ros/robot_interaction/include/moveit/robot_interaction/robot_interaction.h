@@ -47,6 +47,7 @@
 #include <boost/function.hpp>
 #include <boost/thread.hpp>
 #include <memory>
+#include <set>
 
 // This is needed for legacy code that includes robot_interaction.h but not
 // interaction_handler.h
@@ -77,7 +78,12 @@ public:
   /// The topic name on which the internal Interactive Marker Server operates
   static const std::string INTERACTIVE_MARKER_TOPIC;
 
-  RobotInteraction(const robot_model::RobotModelConstPtr& robot_model, const std::string& ns = "");
+  /// \param processing_threads Number of threads processing marker feedback. With more than one
+  /// thread, feedback for different interaction handlers is processed concurrently; feedback for any
+  /// single handler is always serialized, and only the latest pose per marker is kept. Callbacks
+  /// registered with the handlers must be thread-safe when more than one thread is requested.
+  RobotInteraction(const robot_model::RobotModelConstPtr& robot_model, const std::string& ns = "",
+                   unsigned int processing_threads = 1);
   virtual ~RobotInteraction();
 
   const std::string& getServerTopic(void) const
@@ -188,11 +194,14 @@ private:
   void processingThread();
   void clearInteractiveMarkersUnsafe();
 
-  std::unique_ptr<boost::thread> processing_thread_;
+  std::vector<std::unique_ptr<boost::thread> > processing_threads_;
   bool run_processing_thread_;
 
   boost::condition_variable new_feedback_condition_;
   std::map<std::string, visualization_msgs::InteractiveMarkerFeedbackConstPtr> feedback_map_;
+  // handlers whose feedback is currently being processed by one of the
+  // processing threads; PROTECTED BY marker_access_lock_
+  std::set<std::string> handlers_in_process_;
 
   robot_model::RobotModelConstPtr robot_model_;
 
@@ -42,6 +42,7 @@ robot_interaction::LockedRobotState::LockedRobotState(const robot_state::RobotSt
   : state_(new robot_state::RobotState(state))
 {
   state_->update();
+  published_state_ = state_;
 }
 
 robot_interaction::LockedRobotState::LockedRobotState(const robot_model::RobotModelPtr& model)
@@ -49,6 +50,7 @@ robot_interaction::LockedRobotState::LockedRobotState(const robot_model::RobotMo
 {
   state_->setToDefaultValues();
   state_->update();
+  published_state_ = state_;
 }
 
 robot_interaction::LockedRobotState::~LockedRobotState()
@@ -57,8 +59,10 @@ robot_interaction::LockedRobotState::~LockedRobotState()
 
 robot_state::RobotStateConstPtr robot_interaction::LockedRobotState::getState() const
 {
-  boost::mutex::scoped_lock lock(state_lock_);
-  return state_;
+  // readers get the last published snapshot; they do not wait for a modify
+  // function that may be running under state_lock_
+  boost::mutex::scoped_lock lock(publish_lock_);
+  return published_state_;
 }
 
 void robot_interaction::LockedRobotState::setState(const robot_state::RobotState& state)
@@ -66,14 +70,28 @@ void robot_interaction::LockedRobotState::setState(const robot_state::RobotState
   {
     boost::mutex::scoped_lock lock(state_lock_);
 
-    // If someone else has a reference to the state, then make a new copy.
-    // The old state is orphaned (does not change, but is now out of date).
+    // If the published state (or another reader) still references this buffer,
+    // write into a different one. The old state is orphaned (does not change,
+    // but is now out of date).
     if (state_.unique())
       *state_ = state;
     else
-      state_.reset(new robot_state::RobotState(state));
+    {
+      boost::mutex::scoped_lock plock(publish_lock_);
+      if (spare_state_ && spare_state_.unique())
+      {
+        state_.swap(spare_state_);
+        *state_ = state;
+      }
+      else
+        state_.reset(new robot_state::RobotState(state));
+    }
 
     state_->update();
+
+    boost::mutex::scoped_lock plock(publish_lock_);
+    spare_state_ = published_state_;
+    published_state_ = state_;
   }
   robotStateChanged();
 }
@@ -83,13 +101,27 @@ void robot_interaction::LockedRobotState::modifyState(const ModifyStateFunction&
   {
     boost::mutex::scoped_lock lock(state_lock_);
 
-    // If someone else has a reference to the state, then make a copy.
-    // The old state is orphaned (does not change, but is now out of date).
+    // If the published state (or another reader) still references this buffer,
+    // modify a different one. The old state is orphaned (does not change, but
+    // is now out of date).
     if (!state_.unique())
-      state_.reset(new robot_state::RobotState(*state_));
+    {
+      boost::mutex::scoped_lock plock(publish_lock_);
+      if (spare_state_ && spare_state_.unique())
+      {
+        *spare_state_ = *state_;
+        state_.swap(spare_state_);
+      }
+      else
+        state_.reset(new robot_state::RobotState(*state_));
+    }
 
     modify(state_.get());
     state_->update();
+
+    boost::mutex::scoped_lock plock(publish_lock_);
+    spare_state_ = published_state_;
+    published_state_ = state_;
   }
   robotStateChanged();
 }
@@ -62,22 +62,28 @@ static const float END_EFFECTOR_REACHABLE_COLOR[4] = { 0.2, 1.0, 0.2, 1.0 };
 
 const std::string RobotInteraction::INTERACTIVE_MARKER_TOPIC = "robot_interaction_interactive_marker_topic";
 
-RobotInteraction::RobotInteraction(const robot_model::RobotModelConstPtr& robot_model, const std::string& ns)
+RobotInteraction::RobotInteraction(const robot_model::RobotModelConstPtr& robot_model, const std::string& ns,
+                                   unsigned int processing_threads)
   : robot_model_(robot_model), kinematic_options_map_(new KinematicOptionsMap)
 {
   topic_ = ns.empty() ? INTERACTIVE_MARKER_TOPIC : ns + "/" + INTERACTIVE_MARKER_TOPIC;
   int_marker_server_ = new interactive_markers::InteractiveMarkerServer(topic_);
 
-  // spin a thread that will process feedback events
+  // spin threads that will process feedback events
   run_processing_thread_ = true;
-  processing_thread_.reset(new boost::thread(boost::bind(&RobotInteraction::processingThread, this)));
+  if (processing_threads == 0)
+    processing_threads = 1;
+  for (unsigned int i = 0; i < processing_threads; ++i)
+    processing_threads_.push_back(
+        std::unique_ptr<boost::thread>(new boost::thread(boost::bind(&RobotInteraction::processingThread, this))));
 }
 
 RobotInteraction::~RobotInteraction()
 {
   run_processing_thread_ = false;
   new_feedback_condition_.notify_all();
-  processing_thread_->join();
+  for (std::size_t i = 0; i < processing_threads_.size(); ++i)
+    processing_threads_[i]->join();
 
   clear();
   delete int_marker_server_;
@@ -742,30 +748,53 @@ void RobotInteraction::processingThread()
 
   while (run_processing_thread_ && ros::ok())
   {
-    while (feedback_map_.empty() && run_processing_thread_ && ros::ok())
-      new_feedback_condition_.wait(ulock);
+    // Claim the first pending feedback whose handler is not already being processed by another
+    // thread. Feedback is coalesced at insertion (the map keeps only the latest pose per marker),
+    // so a backlog of stale drag poses is never replayed.
+    visualization_msgs::InteractiveMarkerFeedbackConstPtr feedback;
+    std::string claimed_handler;
+    for (std::map<std::string, visualization_msgs::InteractiveMarkerFeedbackConstPtr>::iterator fit =
+             feedback_map_.begin();
+         fit != feedback_map_.end(); ++fit)
+    {
+      std::size_t u = fit->first.find_first_of("_");
+      const std::string handler_name = (u == std::string::npos || u < 4) ? "" : fit->first.substr(3, u - 3);
+      if (handlers_in_process_.find(handler_name) == handlers_in_process_.end())
+      {
+        feedback = fit->second;
+        feedback_map_.erase(fit);
+        claimed_handler = handler_name;
+        handlers_in_process_.insert(handler_name);
+        break;
+      }
+    }
 
-    while (!feedback_map_.empty() && ros::ok())
+    if (!feedback)
     {
-      visualization_msgs::InteractiveMarkerFeedbackConstPtr feedback = feedback_map_.begin()->second;
-      feedback_map_.erase(feedback_map_.begin());
-      ROS_DEBUG_NAMED("robot_interaction", "Processing feedback from map for marker [%s]",
-                      feedback->marker_name.c_str());
+      // nothing claimable: either no feedback is pending or it all belongs to busy handlers
+      if (run_processing_thread_ && ros::ok())
+        new_feedback_condition_.wait(ulock);
+      continue;
+    }
+
+    ROS_DEBUG_NAMED("robot_interaction", "Processing feedback from map for marker [%s]", feedback->marker_name.c_str());
 
+    do  // single iteration; allows the error paths below to break out to the handler release
+    {
       std::map<std::string, std::size_t>::const_iterator it = shown_markers_.find(feedback->marker_name);
       if (it == shown_markers_.end())
       {
         ROS_ERROR("Unknown marker name: '%s' (not published by RobotInteraction class) "
                   "(should never have ended up in the feedback_map!)",
                   feedback->marker_name.c_str());
-        continue;
+        break;
       }
       std::size_t u = feedback->marker_name.find_first_of("_");
       if (u == std::string::npos || u < 4)
       {
         ROS_ERROR("Invalid marker name: '%s' (should never have ended up in the feedback_map!)",
                   feedback->marker_name.c_str());
-        continue;
+        break;
       }
       std::string marker_class = feedback->marker_name.substr(0, 2);
       std::string handler_name = feedback->marker_name.substr(3, u - 3);  // skip the ":"
@@ -773,7 +802,7 @@ void RobotInteraction::processingThread()
       if (jt == handlers_.end())
       {
         ROS_ERROR("Interactive Marker Handler '%s' is not known.", handler_name.c_str());
-        continue;
+        break;
       }
 
       // we put this in a try-catch because user specified callbacks may be triggered
@@ -833,7 +862,11 @@ void RobotInteraction::processingThread()
       {
         ROS_ERROR("Exception caught while processing event: %s", ex.what());
       }
-    }
+    } while (false);
+
+    // release the handler; feedback for it may have queued up while we were processing
+    handlers_in_process_.erase(claimed_handler);
+    new_feedback_condition_.notify_all();
   }
 }
 
@@ -210,10 +210,12 @@ protected:
   bool isIKSolutionCollisionFree(robot_state::RobotState* state, const robot_state::JointModelGroup* group,
                                  const double* ik_solution) const;
 
-  void computeMetrics(bool start, const std::string& group, double payload);
+  void scheduleComputeMetricsJobs(bool start);
+  void computeMetricsJob(bool start, const robot_interaction::EndEffectorInteraction& eef, double payload);
   void computeMetricsInternal(std::map<std::string, double>& metrics,
                               const robot_interaction::EndEffectorInteraction& eef,
                               const robot_state::RobotState& state, double payload);
+  void displayMetricsIfVisible(bool start);
   void updateStateExceptModified(robot_state::RobotState& dest, const robot_state::RobotState& src);
   void updateBackgroundJobProgressBar();
   void backgroundJobUpdate(moveit::tools::BackgroundProcessing::JobEvent event, const std::string& jobname);
@@ -270,6 +272,11 @@ protected:
   std::map<std::string, dynamics_solver::DynamicsSolverPtr> dynamics_solver_;
   boost::mutex update_metrics_lock_;
 
+  /// Tokens of the metrics jobs that are still queued for the start (index 0) and goal (index 1)
+  /// query states; a newer query state cancels the computations queued for the older one
+  std::vector<moveit::tools::BackgroundProcessing::JobTokenPtr> metrics_job_tokens_[2];
+  boost::mutex metrics_jobs_lock_;
+
   // The trajectory playback component
   TrajectoryVisualizationPtr trajectory_visual_;
 
@@ -471,19 +471,51 @@ void MotionPlanningDisplay::renderWorkspaceBox()
   workspace_box_->setPosition(center);
 }
 
-void MotionPlanningDisplay::computeMetrics(bool start, const std::string& group, double payload)
+void MotionPlanningDisplay::scheduleComputeMetricsJobs(bool start)
 {
   if (!robot_interaction_)
     return;
+  std::string group = planning_group_property_->getStdString();
+  if (group.empty())
+    return;
   const std::vector<robot_interaction::EndEffectorInteraction>& eef = robot_interaction_->getActiveEndEffectors();
   if (eef.empty())
     return;
-  boost::mutex::scoped_lock slock(update_metrics_lock_);
-
-  robot_state::RobotStateConstPtr state = start ? getQueryStartState() : getQueryGoalState();
+  double payload = metrics_set_payload_property_->getFloat();
+
+  // dragging a marker triggers this for every feedback message; cancel the computations still
+  // queued for this query state, since only the newest one can make it to the screen, and queue
+  // one low-priority job per end effector so marker publication is never stuck behind them
+  boost::mutex::scoped_lock slock(metrics_jobs_lock_);
+  std::vector<moveit::tools::BackgroundProcessing::JobTokenPtr>& tokens = metrics_job_tokens_[start ? 0 : 1];
+  for (std::size_t i = 0; i < tokens.size(); ++i)
+    if (tokens[i])
+      tokens[i]->cancel();
+  tokens.clear();
   for (std::size_t i = 0; i < eef.size(); ++i)
     if (eef[i].parent_group == group)
-      computeMetricsInternal(computed_metrics_[std::make_pair(start, group)], eef[i], *state, payload);
+      tokens.push_back(
+          background_process_.addJob(boost::bind(&MotionPlanningDisplay::computeMetricsJob, this, start, eef[i], payload),
+                                     "computeMetrics", moveit::tools::BackgroundProcessing::PRIORITY_LOW));
+}
+
+void MotionPlanningDisplay::computeMetricsJob(bool start, const robot_interaction::EndEffectorInteraction& eef,
+                                              double payload)
+{
+  {
+    boost::mutex::scoped_lock slock(update_metrics_lock_);
+    robot_state::RobotStateConstPtr state = start ? getQueryStartState() : getQueryGoalState();
+    computeMetricsInternal(computed_metrics_[std::make_pair(start, eef.parent_group)], eef, *state, payload);
+  }
+  // refresh the on-screen table with the new numbers
+  addMainLoopJob(boost::bind(&MotionPlanningDisplay::displayMetricsIfVisible, this, start));
+  context_->queueRender();
+}
+
+void MotionPlanningDisplay::displayMetricsIfVisible(bool start)
+{
+  if (start ? query_start_state_property_->getBool() : query_goal_state_property_->getBool())
+    displayMetrics(start);
 }
 
 void MotionPlanningDisplay::computeMetricsInternal(std::map<std::string, double>& metrics,
@@ -691,16 +723,12 @@ void MotionPlanningDisplay::addStatusText(const std::vector<std::string>& text)
 
 void MotionPlanningDisplay::recomputeQueryStartStateMetrics()
 {
-  std::string group = planning_group_property_->getStdString();
-  if (!group.empty())
-    computeMetrics(true, group, metrics_set_payload_property_->getFloat());
+  scheduleComputeMetricsJobs(true);
 }
 
 void MotionPlanningDisplay::recomputeQueryGoalStateMetrics()
 {
-  std::string group = planning_group_property_->getStdString();
-  if (!group.empty())
-    computeMetrics(false, group, metrics_set_payload_property_->getFloat());
+  scheduleComputeMetricsJobs(false);
 }
 
 void MotionPlanningDisplay::changedQueryStartState()
@@ -711,7 +739,7 @@ void MotionPlanningDisplay::changedQueryStartState()
   addStatusText("Changed start state");
   drawQueryStartState();
   addBackgroundJob(boost::bind(&MotionPlanningDisplay::publishInteractiveMarkers, this, true),
-                   "publishInteractiveMarkers");
+                   "publishInteractiveMarkers", moveit::tools::BackgroundProcessing::PRIORITY_HIGH);
 }
 
 void MotionPlanningDisplay::changedQueryGoalState()
@@ -722,7 +750,7 @@ void MotionPlanningDisplay::changedQueryGoalState()
   addStatusText("Changed goal state");
   drawQueryGoalState();
   addBackgroundJob(boost::bind(&MotionPlanningDisplay::publishInteractiveMarkers, this, true),
-                   "publishInteractiveMarkers");
+                   "publishInteractiveMarkers", moveit::tools::BackgroundProcessing::PRIORITY_HIGH);
 }
 
 void MotionPlanningDisplay::drawQueryGoalState()
@@ -795,7 +823,7 @@ void MotionPlanningDisplay::resetInteractiveMarkers()
   query_start_state_->clearError();
   query_goal_state_->clearError();
   addBackgroundJob(boost::bind(&MotionPlanningDisplay::publishInteractiveMarkers, this, false),
-                   "publishInteractiveMarkers");
+                   "publishInteractiveMarkers", moveit::tools::BackgroundProcessing::PRIORITY_HIGH);
 }
 
 void MotionPlanningDisplay::publishInteractiveMarkers(bool pose_update)
@@ -901,7 +929,7 @@ void MotionPlanningDisplay::scheduleDrawQueryStartState(robot_interaction::Inter
   if (!planning_scene_monitor_)
     return;
   addBackgroundJob(boost::bind(&MotionPlanningDisplay::publishInteractiveMarkers, this, !error_state_changed),
-                   "publishInteractiveMarkers");
+                   "publishInteractiveMarkers", moveit::tools::BackgroundProcessing::PRIORITY_HIGH);
   recomputeQueryStartStateMetrics();
   addMainLoopJob(boost::bind(&MotionPlanningDisplay::drawQueryStartState, this));
   context_->queueRender();
@@ -912,7 +940,7 @@ void MotionPlanningDisplay::scheduleDrawQueryGoalState(robot_interaction::Intera
   if (!planning_scene_monitor_)
     return;
   addBackgroundJob(boost::bind(&MotionPlanningDisplay::publishInteractiveMarkers, this, !error_state_changed),
-                   "publishInteractiveMarkers");
+                   "publishInteractiveMarkers", moveit::tools::BackgroundProcessing::PRIORITY_HIGH);
   recomputeQueryGoalStateMetrics();
   addMainLoopJob(boost::bind(&MotionPlanningDisplay::drawQueryGoalState, this));
   context_->queueRender();
@@ -1034,7 +1062,7 @@ void MotionPlanningDisplay::changedPlanningGroup()
   if (frame_)
     frame_->changePlanningGroup();
   addBackgroundJob(boost::bind(&MotionPlanningDisplay::publishInteractiveMarkers, this, false),
-                   "publishInteractiveMarkers");
+                   "publishInteractiveMarkers", moveit::tools::BackgroundProcessing::PRIORITY_HIGH);
 }
 
 void MotionPlanningDisplay::changedWorkspace()
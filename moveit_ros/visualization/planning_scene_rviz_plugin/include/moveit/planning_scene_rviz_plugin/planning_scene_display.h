@@ -46,6 +46,8 @@
 #include <ros/ros.h>
 #endif
 
+#include <set>
+
 namespace Ogre
 {
 class SceneNode;
@@ -85,8 +87,11 @@ public:
   void queueRenderSceneGeometry();
 
   /** Queue this function call for execution within the background thread
-      All jobs are queued and processed in order by a single background thread. */
-  void addBackgroundJob(const boost::function<void()>& job, const std::string& name);
+      All jobs are queued and processed in order by a single background thread;
+      jobs queued at a higher priority run before queued lower-priority ones. */
+  void addBackgroundJob(const boost::function<void()>& job, const std::string& name,
+                        moveit::tools::BackgroundProcessing::JobPriority priority =
+                            moveit::tools::BackgroundProcessing::PRIORITY_DEFAULT);
 
   /** Directly spawn a (detached) background thread for execution of this function call
       Should be used, when order of processing is not relevant / job can run in parallel.
@@ -159,6 +164,12 @@ protected:
   void executeMainLoopJobs();
   void sceneMonitorReceivedUpdate(planning_scene_monitor::PlanningSceneMonitor::SceneUpdateType update_type);
   void renderPlanningScene();
+  /// called on the planning scene monitor thread whenever a world object
+  /// changes; records the object for incremental re-rendering
+  void worldObjectChanged(const collision_detection::World::ObjectConstPtr& object,
+                          collision_detection::World::Action action);
+  /// re-render only the world objects recorded by worldObjectChanged()
+  void renderWorldObjectChanges();
   void setLinkColor(rviz::Robot* robot, const std::string& link_name, const QColor& color);
   void unsetLinkColor(rviz::Robot* robot, const std::string& link_name);
   void setGroupColor(rviz::Robot* robot, const std::string& group_name, const QColor& color);
@@ -193,6 +204,13 @@ protected:
   bool planning_scene_needs_render_;
   float current_scene_time_;
 
+  // ids of world objects that changed, recorded on the monitor thread and
+  // drained by the render thread in updateInternal()
+  // PROTECTED BY world_changes_lock_
+  std::set<std::string> world_changes_;
+  boost::mutex world_changes_lock_;
+  collision_detection::World::ObserverHandle world_observer_handle_;
+
   rviz::Property* scene_category_;
   rviz::Property* robot_category_;
 
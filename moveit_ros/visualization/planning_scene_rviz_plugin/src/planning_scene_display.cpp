@@ -60,6 +60,10 @@
 
 namespace moveit_rviz_plugin
 {
+// Number of octree leaves decoded per frame when rendering octomap geometry;
+// spreads the cost of very large octomaps over multiple display updates
+static const std::size_t OCTREE_RENDER_LEAF_BUDGET = 100000;
+
 // ******************************************************************************************
 // Base class contructor
 // ******************************************************************************************
@@ -213,9 +217,10 @@ void PlanningSceneDisplay::reset()
   }
 }
 
-void PlanningSceneDisplay::addBackgroundJob(const boost::function<void()>& job, const std::string& name)
+void PlanningSceneDisplay::addBackgroundJob(const boost::function<void()>& job, const std::string& name,
+                                            moveit::tools::BackgroundProcessing::JobPriority priority)
 {
-  background_process_.addJob(job, name);
+  background_process_.addJob(job, name, priority);
 }
 
 void PlanningSceneDisplay::spawnBackgroundJob(const boost::function<void()>& job)
@@ -325,8 +330,51 @@ void PlanningSceneDisplay::changedSceneName()
     ps->setName(scene_name_property_->getStdString());
 }
 
+void PlanningSceneDisplay::worldObjectChanged(const collision_detection::World::ObjectConstPtr& object,
+                                              collision_detection::World::Action /*action*/)
+{
+  // called on the monitor thread, possibly while the scene is locked; only
+  // record the change here and let the render thread do the actual work
+  boost::mutex::scoped_lock lock(world_changes_lock_);
+  world_changes_.insert(object->id_);
+}
+
+void PlanningSceneDisplay::renderWorldObjectChanges()
+{
+  std::set<std::string> changes;
+  {
+    boost::mutex::scoped_lock lock(world_changes_lock_);
+    changes.swap(world_changes_);
+  }
+  if (changes.empty())
+    return;
+
+  QColor color = scene_color_property_->getColor();
+  rviz::Color env_color(color.redF(), color.greenF(), color.blueF());
+
+  try
+  {
+    const planning_scene_monitor::LockedPlanningSceneRO& ps = getPlanningSceneRO();
+    for (std::set<std::string>::const_iterator it = changes.begin(); it != changes.end(); ++it)
+      planning_scene_render_->renderWorldObject(
+          ps, *it, env_color, static_cast<OctreeVoxelRenderMode>(octree_render_property_->getOptionInt()),
+          static_cast<OctreeVoxelColorMode>(octree_coloring_property_->getOptionInt()),
+          scene_alpha_property_->getFloat());
+  }
+  catch (std::exception& ex)
+  {
+    ROS_ERROR("Caught %s while re-rendering changed world objects", ex.what());
+  }
+}
+
 void PlanningSceneDisplay::renderPlanningScene()
 {
+  // a full render covers any pending per-object changes
+  {
+    boost::mutex::scoped_lock lock(world_changes_lock_);
+    world_changes_.clear();
+  }
+
   QColor color = scene_color_property_->getColor();
   rviz::Color env_color(color.redF(), color.greenF(), color.blueF());
   if (attached_body_color_property_)
@@ -499,6 +547,8 @@ void PlanningSceneDisplay::clearRobotModel()
   planning_scene_render_.reset();
   planning_scene_monitor_.reset();  // this so that the destructor of the PlanningSceneMonitor gets called before a new
                                     // instance of a scene monitor is constructed
+  boost::mutex::scoped_lock lock(world_changes_lock_);
+  world_changes_.clear();
 }
 
 void PlanningSceneDisplay::loadRobotModel()
@@ -528,8 +578,14 @@ void PlanningSceneDisplay::loadRobotModel()
   }
 
   if (planning_scene_monitor_)
+  {
+    // record world diffs on the monitor thread, so geometry-only updates can
+    // be re-rendered per object instead of walking the whole world
+    world_observer_handle_ = getPlanningSceneRW()->getWorldNonConst()->addObserver(
+        boost::bind(&PlanningSceneDisplay::worldObjectChanged, this, _1, _2));
     planning_scene_monitor_->addUpdateCallback(
         boost::bind(&PlanningSceneDisplay::sceneMonitorReceivedUpdate, this, _1));
+  }
 
   model_is_loading_ = false;
 }
@@ -537,7 +593,8 @@ void PlanningSceneDisplay::loadRobotModel()
 void PlanningSceneDisplay::onRobotModelLoaded()
 {
   changedPlanningSceneTopic();
-  planning_scene_render_.reset(new PlanningSceneRender(planning_scene_node_, context_, planning_scene_robot_));
+  planning_scene_render_.reset(
+      new PlanningSceneRender(planning_scene_node_, context_, planning_scene_robot_, OCTREE_RENDER_LEAF_BUDGET));
   planning_scene_render_->getGeometryNode()->setVisible(scene_enabled_property_->getBool());
 
   const planning_scene_monitor::LockedPlanningSceneRO& ps = getPlanningSceneRO();
@@ -568,7 +625,10 @@ void PlanningSceneDisplay::onSceneMonitorReceivedUpdate(
   scene_name_property_->setStdString(getPlanningSceneRO()->getName());
   scene_name_property_->blockSignals(oldState);
 
-  planning_scene_needs_render_ = true;
+  // pure geometry updates were recorded per object by the world observer and
+  // are re-rendered incrementally; everything else needs a full re-render
+  if (update_type != planning_scene_monitor::PlanningSceneMonitor::UPDATE_GEOMETRY || !planning_scene_render_)
+    planning_scene_needs_render_ = true;
 }
 
 void PlanningSceneDisplay::onEnable()
@@ -632,6 +692,10 @@ void PlanningSceneDisplay::updateInternal(float wall_dt, float ros_dt)
     current_scene_time_ = 0.0f;
     planning_scene_needs_render_ = false;
   }
+  else if (planning_scene_render_)
+    renderWorldObjectChanges();
+  if (planning_scene_render_)
+    planning_scene_render_->update();  // advance budgeted octomap decoding
 }
 
 void PlanningSceneDisplay::load(const rviz::Config& config)
@@ -74,11 +74,21 @@ enum OctreeVoxelColorMode
 class OcTreeRender
 {
 public:
+  /** \brief Construct a render for \e octree.
+      When \e leaf_budget is 0 the entire tree is decoded into render batches
+      at construction. A non-zero budget only decodes that many leaves per
+      call to update(), spreading the cost of large octrees over several
+      frames; the point clouds remain empty until the decode completes. */
   OcTreeRender(const std::shared_ptr<const octomap::OcTree>& octree, OctreeVoxelRenderMode octree_voxel_rendering,
                OctreeVoxelColorMode octree_color_mode, std::size_t max_octree_depth, Ogre::SceneManager* scene_manager,
-               Ogre::SceneNode* parent_node);
+               Ogre::SceneNode* parent_node, std::size_t leaf_budget = 0);
   virtual ~OcTreeRender();
 
+  /** \brief Advance any pending voxel decoding work by up to the leaf budget
+      configured at construction. Call once per frame; this is a no-op when
+      the displayed batches are up to date. */
+  void update();
+
   void setPosition(const Ogre::Vector3& position);
   void setOrientation(const Ogre::Quaternion& orientation);
 
@@ -86,8 +96,7 @@ private:
   void setColor(double z_pos, double min_z, double max_z, double color_factor, rviz::PointCloud::Point* point);
   void setProbColor(double prob, rviz::PointCloud::Point* point);
 
-  void octreeDecoding(const std::shared_ptr<const octomap::OcTree>& octree,
-                      OctreeVoxelRenderMode octree_voxel_rendering, OctreeVoxelColorMode octree_color_mode);
+  void beginDecoding();
 
   // Ogre-rviz point clouds
   std::vector<rviz::PointCloud*> cloud_;
@@ -98,6 +107,14 @@ private:
 
   double colorFactor_;
   std::size_t octree_depth_;
+
+  OctreeVoxelRenderMode octree_voxel_rendering_;
+  OctreeVoxelColorMode octree_color_mode_;
+  // number of leaves decoded per update() call; 0 decodes everything at once
+  std::size_t leaf_budget_;
+  // decode in progress; NULL when the displayed batches are up to date
+  struct DecodeState;
+  std::unique_ptr<DecodeState> decode_state_;
 };
 }
 #endif
@@ -62,10 +62,15 @@ MOVEIT_CLASS_FORWARD(PlanningSceneRender);
 class PlanningSceneRender
 {
 public:
+  /** \brief A non-zero \e octree_leaf_budget spreads the decoding of octomap
+      geometry over multiple frames; see RenderShapes */
   PlanningSceneRender(Ogre::SceneNode* root_node, rviz::DisplayContext* context,
-                      const RobotStateVisualizationPtr& robot);
+                      const RobotStateVisualizationPtr& robot, std::size_t octree_leaf_budget = 0);
   ~PlanningSceneRender();
 
+  /** \brief Advance budgeted octree decoding; call once per frame */
+  void update();
+
   Ogre::SceneNode* getGeometryNode()
   {
     return planning_scene_geometry_node_;
@@ -79,6 +84,17 @@ public:
   void renderPlanningScene(const planning_scene::PlanningSceneConstPtr& scene, const rviz::Color& default_scene_color,
                            const rviz::Color& default_attached_color, OctreeVoxelRenderMode voxel_render_mode,
                            OctreeVoxelColorMode voxel_color_mode, float default_scene_alpha);
+
+  /** \brief Render (or re-render) a single world object, replacing any
+      existing render of it. If \e object_id is no longer in the world, its
+      render is removed. */
+  void renderWorldObject(const planning_scene::PlanningSceneConstPtr& scene, const std::string& object_id,
+                         const rviz::Color& default_scene_color, OctreeVoxelRenderMode voxel_render_mode,
+                         OctreeVoxelColorMode voxel_color_mode, float default_scene_alpha);
+
+  /** \brief Remove the render of a single world object */
+  void removeWorldObject(const std::string& object_id);
+
   void clear();
 
 private:
@@ -86,6 +102,10 @@ private:
   rviz::DisplayContext* context_;
   RenderShapesPtr render_shapes_;
   RobotStateVisualizationPtr scene_robot_;
+  // per-object renders, so individual world objects can be refreshed or
+  // removed without re-rendering the entire world
+  std::map<std::string, RenderShapesPtr> object_render_shapes_;
+  std::size_t octree_leaf_budget_;
 };
 }
 
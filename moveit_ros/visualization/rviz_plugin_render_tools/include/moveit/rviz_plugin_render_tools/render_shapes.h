@@ -64,7 +64,10 @@ MOVEIT_CLASS_FORWARD(RenderShapes);
 class RenderShapes
 {
 public:
-  RenderShapes(rviz::DisplayContext* context);
+  /** \brief A non-zero \e octree_leaf_budget spreads the decoding of rendered
+      octrees over multiple frames, \e octree_leaf_budget leaves per call to
+      update(). The default decodes octrees entirely when they are rendered. */
+  RenderShapes(rviz::DisplayContext* context, std::size_t octree_leaf_budget = 0);
   ~RenderShapes();
 
   void renderShape(Ogre::SceneNode* node, const shapes::Shape* s, const Eigen::Isometry3d& p,
@@ -72,8 +75,12 @@ public:
                    const rviz::Color& color, float alpha);
   void clear();
 
+  /** \brief Advance budgeted octree decoding; call once per frame */
+  void update();
+
 private:
   rviz::DisplayContext* context_;
+  std::size_t octree_leaf_budget_;
 
   std::vector<std::unique_ptr<rviz::Shape> > scene_shapes_;
   std::vector<OcTreeRenderPtr> octree_voxel_grids_;
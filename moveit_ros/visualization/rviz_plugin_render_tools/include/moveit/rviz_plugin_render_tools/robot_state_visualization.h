@@ -94,12 +94,45 @@ private:
   void updateHelper(const robot_state::RobotStateConstPtr& kinematic_state,
                     const std_msgs::ColorRGBA& default_attached_object_color,
                     const std::map<std::string, std_msgs::ColorRGBA>* color_map);
+
+  /// reposition only the links whose global transform changed since the last
+  /// displayed state
+  void updateLinkTransforms(const robot_state::RobotStateConstPtr& kinematic_state);
+
+  void updateAttachedBodies(const robot_state::RobotStateConstPtr& kinematic_state,
+                            const std_msgs::ColorRGBA& default_attached_object_color,
+                            const std::map<std::string, std_msgs::ColorRGBA>* color_map);
+
+  // render of one attached body; the geometry is built once in the frame of
+  // the attached link and only the scene nodes are repositioned afterwards
+  struct AttachedBodyRender
+  {
+    AttachedBodyRender() : visual_node(NULL), collision_node(NULL), alpha(0.0f)
+    {
+    }
+    Ogre::SceneNode* visual_node;
+    Ogre::SceneNode* collision_node;
+    RenderShapesPtr shapes_render;
+    // what the render was built from, to detect when a rebuild is needed
+    std::vector<shapes::ShapeConstPtr> shapes;
+    EigenSTL::vector_Isometry3d fixed_transforms;
+    std_msgs::ColorRGBA color;
+    float alpha;
+  };
+  void destroyAttachedBodyRender(AttachedBodyRender& render);
+
   rviz::Robot robot_;
-  RenderShapesPtr render_shapes_;
+  rviz::DisplayContext* context_;
+  std::map<std::string, AttachedBodyRender> attached_body_renders_;
   std_msgs::ColorRGBA default_attached_object_color_;
   OctreeVoxelRenderMode octree_voxel_render_mode_;
   OctreeVoxelColorMode octree_voxel_color_mode_;
 
+  // global link transforms of the last displayed state, indexed by link
+  // index; empty until the first update after load()
+  robot_model::RobotModelConstPtr last_model_;
+  EigenSTL::vector_Isometry3d last_link_transforms_;
+
   bool visible_;
   bool visual_visible_;
   bool collision_visible_;
@@ -112,6 +112,7 @@ private Q_SLOTS:
   void changedLoopDisplay();
   void changedShowTrail();
   void changedTrailStepSize();
+  void changedTrailMaxStates();
   void changedTrajectoryTopic();
   void changedStateDisplayTime();
   void changedRobotColor();
@@ -125,6 +126,7 @@ protected:
   void incomingDisplayTrajectory(const moveit_msgs::DisplayTrajectory::ConstPtr& msg);
   float getStateDisplayTime();
   void clearTrajectoryTrail();
+  void destroyTrajectoryTrail();
 
   // Handles actually drawing the robot along motion plans
   RobotStateVisualizationPtr display_path_robot_;
@@ -136,6 +138,15 @@ protected:
   robot_trajectory::RobotTrajectoryPtr displaying_trajectory_message_;
   robot_trajectory::RobotTrajectoryPtr trajectory_message_to_display_;
   std::vector<rviz::Robot*> trajectory_trail_;
+  // Trail robots retired by clearTrajectoryTrail(); their per-link render
+  // geometry only depends on the URDF, so they are reused by the next trail
+  // instead of being rebuilt. Destroyed when the robot model changes.
+  std::vector<rviz::Robot*> trail_robot_pool_;
+  // Effective step size the current trail was built with (after decimation)
+  int trail_step_size_;
+  // Number of leading trail robots currently visible; lets update() toggle
+  // only the robots whose visibility changed since the last display update
+  std::size_t trail_visible_count_;
   ros::Subscriber trajectory_topic_sub_;
   bool animating_path_;
   bool drop_displaying_trajectory_;
@@ -167,6 +178,7 @@ protected:
   rviz::ColorProperty* robot_color_property_;
   rviz::BoolProperty* enable_robot_color_property_;
   rviz::IntProperty* trail_step_size_property_;
+  rviz::IntProperty* trail_max_states_property_;
 };
 
 }  // namespace moveit_rviz_plugin
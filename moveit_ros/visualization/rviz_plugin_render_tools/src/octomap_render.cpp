@@ -49,11 +49,25 @@ namespace moveit_rviz_plugin
 typedef std::vector<rviz::PointCloud::Point> VPoint;
 typedef std::vector<VPoint> VVPoint;
 
+// State of a decode that is spread over several update() calls
+struct OcTreeRender::DecodeState
+{
+  octomap::OcTree::iterator it;
+  octomap::OcTree::iterator end;
+  VVPoint point_buf;
+  double min_z;
+  double max_z;
+};
+
 OcTreeRender::OcTreeRender(const std::shared_ptr<const octomap::OcTree>& octree,
                            OctreeVoxelRenderMode octree_voxel_rendering, OctreeVoxelColorMode octree_color_mode,
                            std::size_t max_octree_depth, Ogre::SceneManager* scene_manager,
-                           Ogre::SceneNode* parent_node = NULL)
-  : octree_(octree), colorFactor_(0.8)
+                           Ogre::SceneNode* parent_node = NULL, std::size_t leaf_budget)
+  : octree_(octree)
+  , colorFactor_(0.8)
+  , octree_voxel_rendering_(octree_voxel_rendering)
+  , octree_color_mode_(octree_color_mode)
+  , leaf_budget_(leaf_budget)
 {
   if (!parent_node)
   {
@@ -83,7 +97,10 @@ OcTreeRender::OcTreeRender(const std::shared_ptr<const octomap::OcTree>& octree,
     scene_node_->attachObject(cloud_[i]);
   }
 
-  octreeDecoding(octree, octree_voxel_rendering, octree_color_mode);
+  // decode the whole tree now, or only the first budgeted chunk; in the
+  // latter case subsequent update() calls complete the decode
+  beginDecoding();
+  update();
 }
 
 OcTreeRender::~OcTreeRender()
@@ -154,28 +171,42 @@ void OcTreeRender::setColor(double z_pos, double min_z, double max_z, double col
   }
 }
 
-void OcTreeRender::octreeDecoding(const std::shared_ptr<const octomap::OcTree>& octree,
-                                  OctreeVoxelRenderMode octree_voxel_rendering, OctreeVoxelColorMode octree_color_mode)
+void OcTreeRender::beginDecoding()
 {
-  VVPoint pointBuf_;
-  pointBuf_.resize(octree_depth_);
+  decode_state_.reset(new DecodeState);
+  decode_state_->point_buf.resize(octree_depth_);
 
   // get dimensions of octree
   double minX, minY, minZ, maxX, maxY, maxZ;
-  octree->getMetricMin(minX, minY, minZ);
-  octree->getMetricMax(maxX, maxY, maxZ);
+  octree_->getMetricMin(minX, minY, minZ);
+  octree_->getMetricMax(maxX, maxY, maxZ);
+  decode_state_->min_z = minZ;
+  decode_state_->max_z = maxZ;
+
+  decode_state_->it = octree_->begin(octree_depth_);
+  decode_state_->end = octree_->end();
+}
 
-  unsigned int render_mode_mask = static_cast<unsigned int>(octree_voxel_rendering);
+void OcTreeRender::update()
+{
+  if (!decode_state_)
+    return;
+
+  unsigned int render_mode_mask = static_cast<unsigned int>(octree_voxel_rendering_);
 
-  size_t pointCount = 0;
+  size_t leafCount = 0;
   {
-    // traverse all leafs in the tree:
-    for (octomap::OcTree::iterator it = octree->begin(octree_depth_), end = octree->end(); it != end; ++it)
+    // traverse the leafs in the tree, resuming where the last call stopped:
+    for (octomap::OcTree::iterator &it = decode_state_->it, &end = decode_state_->end; it != end; ++it)
     {
+      if (leaf_budget_ && leafCount >= leaf_budget_)
+        return;  // budget exhausted; resume from here on the next update
+      ++leafCount;
+
       bool display_voxel = false;
 
       // the left part evaluates to 1 for free voxels and 2 for occupied voxels
-      if (((int)octree->isNodeOccupied(*it) + 1) & render_mode_mask)
+      if (((int)octree_->isNodeOccupied(*it) + 1) & render_mode_mask)
       {
         // check if current voxel has neighbors on all sides -> no need to be displayed
         bool allNeighborsFound = true;
@@ -191,10 +222,10 @@ void OcTreeRender::octreeDecoding(const std::shared_ptr<const octomap::OcTree>&
             {
               if (key != nKey)
               {
-                octomap::OcTreeNode* node = octree->search(key);
+                octomap::OcTreeNode* node = octree_->search(key);
 
                 // the left part evaluates to 1 for free voxels and 2 for occupied voxels
-                if (!(node && (((int)octree->isNodeOccupied(node)) + 1) & render_mode_mask))
+                if (!(node && (((int)octree_->isNodeOccupied(node)) + 1) & render_mode_mask))
                 {
                   // we do not have a neighbor => break!
                   allNeighborsFound = false;
@@ -217,10 +248,10 @@ void OcTreeRender::octreeDecoding(const std::shared_ptr<const octomap::OcTree>&
 
         float cell_probability;
 
-        switch (octree_color_mode)
+        switch (octree_color_mode_)
         {
           case OCTOMAP_Z_AXIS_COLOR:
-            setColor(newPoint.position.z, minZ, maxZ, colorFactor_, &newPoint);
+            setColor(newPoint.position.z, decode_state_->min_z, decode_state_->max_z, colorFactor_, &newPoint);
             break;
           case OCTOMAP_PROBABLILTY_COLOR:
             cell_probability = it->getOccupancy();
@@ -232,22 +263,22 @@ void OcTreeRender::octreeDecoding(const std::shared_ptr<const octomap::OcTree>&
 
         // push to point vectors
         unsigned int depth = it.getDepth();
-        pointBuf_[depth - 1].push_back(newPoint);
-
-        ++pointCount;
+        decode_state_->point_buf[depth - 1].push_back(newPoint);
       }
     }
   }
 
+  // the traversal finished: publish the per-depth batches
   for (size_t i = 0; i < octree_depth_; ++i)
   {
-    double size = octree->getNodeSize(i + 1);
+    double size = octree_->getNodeSize(i + 1);
 
     cloud_[i]->clear();
     cloud_[i]->setDimensions(size, size, size);
 
-    cloud_[i]->addPoints(&pointBuf_[i].front(), pointBuf_[i].size());
-    pointBuf_[i].clear();
+    if (!decode_state_->point_buf[i].empty())
+      cloud_[i]->addPoints(&decode_state_->point_buf[i].front(), decode_state_->point_buf[i].size());
   }
+  decode_state_.reset();
 }
 }
@@ -45,10 +45,13 @@
 namespace moveit_rviz_plugin
 {
 PlanningSceneRender::PlanningSceneRender(Ogre::SceneNode* node, rviz::DisplayContext* context,
-                                         const RobotStateVisualizationPtr& robot)
-  : planning_scene_geometry_node_(node->createChildSceneNode()), context_(context), scene_robot_(robot)
+                                         const RobotStateVisualizationPtr& robot, std::size_t octree_leaf_budget)
+  : planning_scene_geometry_node_(node->createChildSceneNode())
+  , context_(context)
+  , scene_robot_(robot)
+  , octree_leaf_budget_(octree_leaf_budget)
 {
-  render_shapes_.reset(new RenderShapes(context));
+  render_shapes_.reset(new RenderShapes(context, octree_leaf_budget));
 }
 
 PlanningSceneRender::~PlanningSceneRender()
@@ -59,6 +62,53 @@ PlanningSceneRender::~PlanningSceneRender()
 void PlanningSceneRender::clear()
 {
   render_shapes_->clear();
+  object_render_shapes_.clear();
+}
+
+void PlanningSceneRender::update()
+{
+  render_shapes_->update();
+  for (std::map<std::string, RenderShapesPtr>::iterator it = object_render_shapes_.begin();
+       it != object_render_shapes_.end(); ++it)
+    it->second->update();
+}
+
+void PlanningSceneRender::renderWorldObject(const planning_scene::PlanningSceneConstPtr& scene,
+                                            const std::string& object_id, const rviz::Color& default_scene_color,
+                                            OctreeVoxelRenderMode octree_voxel_rendering,
+                                            OctreeVoxelColorMode octree_color_mode, float default_scene_alpha)
+{
+  collision_detection::CollisionWorld::ObjectConstPtr o = scene->getWorld()->getObject(object_id);
+  if (!o)
+  {
+    removeWorldObject(object_id);
+    return;
+  }
+
+  RenderShapesPtr& rs = object_render_shapes_[object_id];
+  if (rs)
+    rs->clear();
+  else
+    rs.reset(new RenderShapes(context_, octree_leaf_budget_));
+
+  rviz::Color color = default_scene_color;
+  float alpha = default_scene_alpha;
+  if (scene->hasObjectColor(object_id))
+  {
+    const std_msgs::ColorRGBA& c = scene->getObjectColor(object_id);
+    color.r_ = c.r;
+    color.g_ = c.g;
+    color.b_ = c.b;
+    alpha = c.a;
+  }
+  for (std::size_t j = 0; j < o->shapes_.size(); ++j)
+    rs->renderShape(planning_scene_geometry_node_, o->shapes_[j].get(), o->shape_poses_[j], octree_voxel_rendering,
+                    octree_color_mode, color, alpha);
+}
+
+void PlanningSceneRender::removeWorldObject(const std::string& object_id)
+{
+  object_render_shapes_.erase(object_id);
 }
 
 void PlanningSceneRender::renderPlanningScene(const planning_scene::PlanningSceneConstPtr& scene,
@@ -89,21 +139,7 @@ void PlanningSceneRender::renderPlanningScene(const planning_scene::PlanningScen
 
   const std::vector<std::string>& ids = scene->getWorld()->getObjectIds();
   for (std::size_t i = 0; i < ids.size(); ++i)
-  {
-    collision_detection::CollisionWorld::ObjectConstPtr o = scene->getWorld()->getObject(ids[i]);
-    rviz::Color color = default_env_color;
-    float alpha = default_scene_alpha;
-    if (scene->hasObjectColor(ids[i]))
-    {
-      const std_msgs::ColorRGBA& c = scene->getObjectColor(ids[i]);
-      color.r_ = c.r;
-      color.g_ = c.g;
-      color.b_ = c.b;
-      alpha = c.a;
-    }
-    for (std::size_t j = 0; j < o->shapes_.size(); ++j)
-      render_shapes_->renderShape(planning_scene_geometry_node_, o->shapes_[j].get(), o->shape_poses_[j],
-                                  octree_voxel_rendering, octree_color_mode, color, alpha);
-  }
+    renderWorldObject(scene, ids[i], default_env_color, octree_voxel_rendering, octree_color_mode,
+                      default_scene_alpha);
 }
 }
@@ -56,7 +56,8 @@
 
 namespace moveit_rviz_plugin
 {
-RenderShapes::RenderShapes(rviz::DisplayContext* context) : context_(context)
+RenderShapes::RenderShapes(rviz::DisplayContext* context, std::size_t octree_leaf_budget)
+  : context_(context), octree_leaf_budget_(octree_leaf_budget)
 {
 }
 
@@ -71,6 +72,12 @@ void RenderShapes::clear()
   octree_voxel_grids_.clear();
 }
 
+void RenderShapes::update()
+{
+  for (std::size_t i = 0; i < octree_voxel_grids_.size(); ++i)
+    octree_voxel_grids_[i]->update();
+}
+
 void RenderShapes::renderShape(Ogre::SceneNode* node, const shapes::Shape* s, const Eigen::Isometry3d& p,
                                OctreeVoxelRenderMode octree_voxel_rendering, OctreeVoxelColorMode octree_color_mode,
                                const rviz::Color& color, float alpha)
@@ -157,7 +164,8 @@ void RenderShapes::renderShape(Ogre::SceneNode* node, const shapes::Shape* s, co
     case shapes::OCTREE:
     {
       OcTreeRenderPtr octree(new OcTreeRender(static_cast<const shapes::OcTree*>(s)->octree, octree_voxel_rendering,
-                                              octree_color_mode, 0u, context_->getSceneManager(), node));
+                                              octree_color_mode, 0u, context_->getSceneManager(), node,
+                                              octree_leaf_budget_));
       octree->setPosition(position);
       octree->setOrientation(orientation);
       octree_voxel_grids_.push_back(octree);
@@ -37,13 +37,19 @@
 #include <moveit/rviz_plugin_render_tools/robot_state_visualization.h>
 #include <moveit/rviz_plugin_render_tools/planning_link_updater.h>
 #include <moveit/rviz_plugin_render_tools/render_shapes.h>
+#include <rviz/display_context.h>
+#include <rviz/robot/robot_link.h>
+#include <OgreSceneNode.h>
+#include <OgreSceneManager.h>
 #include <QApplication>
+#include <set>
 
 namespace moveit_rviz_plugin
 {
 RobotStateVisualization::RobotStateVisualization(Ogre::SceneNode* root_node, rviz::DisplayContext* context,
                                                  const std::string& name, rviz::Property* parent_property)
   : robot_(root_node, context, name, parent_property)
+  , context_(context)
   , octree_voxel_render_mode_(OCTOMAP_OCCUPIED_VOXELS)
   , octree_voxel_color_mode_(OCTOMAP_Z_AXIS_COLOR)
   , visible_(true)
@@ -54,7 +60,6 @@ RobotStateVisualization::RobotStateVisualization(Ogre::SceneNode* root_node, rvi
   default_attached_object_color_.g = 0.7f;
   default_attached_object_color_.b = 0.0f;
   default_attached_object_color_.a = 1.0f;
-  render_shapes_.reset(new RenderShapes(context));
 }
 
 void RobotStateVisualization::load(const urdf::ModelInterface& descr, bool visual, bool collision)
@@ -71,10 +76,27 @@ void RobotStateVisualization::load(const urdf::ModelInterface& descr, bool visua
 
 void RobotStateVisualization::clear()
 {
-  render_shapes_->clear();
+  for (std::map<std::string, AttachedBodyRender>::iterator it = attached_body_renders_.begin();
+       it != attached_body_renders_.end(); ++it)
+    destroyAttachedBodyRender(it->second);
+  attached_body_renders_.clear();
+  last_model_.reset();
+  last_link_transforms_.clear();
   robot_.clear();
 }
 
+void RobotStateVisualization::destroyAttachedBodyRender(AttachedBodyRender& render)
+{
+  // destroy the rendered shapes before the scene nodes they are attached to
+  render.shapes_render.reset();
+  if (render.visual_node)
+    context_->getSceneManager()->destroySceneNode(render.visual_node->getName());
+  if (render.collision_node)
+    context_->getSceneManager()->destroySceneNode(render.collision_node->getName());
+  render.visual_node = NULL;
+  render.collision_node = NULL;
+}
+
 void RobotStateVisualization::setDefaultAttachedObjectColor(const std_msgs::ColorRGBA& default_attached_object_color)
 {
   default_attached_object_color_ = default_attached_object_color;
@@ -102,18 +124,67 @@ void RobotStateVisualization::updateHelper(const robot_state::RobotStateConstPtr
                                            const std_msgs::ColorRGBA& default_attached_object_color,
                                            const std::map<std::string, std_msgs::ColorRGBA>* color_map)
 {
-  robot_.update(PlanningLinkUpdater(kinematic_state));
-  render_shapes_->clear();
+  updateLinkTransforms(kinematic_state);
+  updateAttachedBodies(kinematic_state, default_attached_object_color, color_map);
+  robot_.setVisualVisible(visual_visible_);
+  robot_.setCollisionVisible(collision_visible_);
+  robot_.setVisible(visible_);
+}
+
+void RobotStateVisualization::updateLinkTransforms(const robot_state::RobotStateConstPtr& kinematic_state)
+{
+  const robot_model::RobotModelConstPtr& model = kinematic_state->getRobotModel();
+  const std::vector<const robot_model::LinkModel*>& links = model->getLinkModels();
+
+  if (model != last_model_ || last_link_transforms_.size() != links.size())
+  {
+    // first update with this model: position every link
+    robot_.update(PlanningLinkUpdater(kinematic_state));
+    last_model_ = model;
+    last_link_transforms_.resize(links.size());
+    for (std::size_t i = 0; i < links.size(); ++i)
+      last_link_transforms_[i] = kinematic_state->getGlobalLinkTransform(links[i]);
+    return;
+  }
+
+  // only touch the Ogre nodes of links whose global transform changed
+  for (std::size_t i = 0; i < links.size(); ++i)
+  {
+    const Eigen::Isometry3d& t = kinematic_state->getGlobalLinkTransform(links[i]);
+    if ((t.matrix().array() == last_link_transforms_[i].matrix().array()).all())
+      continue;
+    last_link_transforms_[i] = t;
+
+    rviz::RobotLink* link = robot_.getLink(links[i]->getName());
+    if (!link)
+      continue;
+    const Eigen::Vector3d& p = t.translation();
+    Eigen::Quaterniond q(t.rotation());
+    Ogre::Vector3 position(p.x(), p.y(), p.z());
+    Ogre::Quaternion orientation(q.w(), q.x(), q.y(), q.z());
+    link->setToNormalMaterial();
+    link->setTransforms(position, orientation, position, orientation);
+  }
+}
 
+void RobotStateVisualization::updateAttachedBodies(const robot_state::RobotStateConstPtr& kinematic_state,
+                                                   const std_msgs::ColorRGBA& default_attached_object_color,
+                                                   const std::map<std::string, std_msgs::ColorRGBA>* color_map)
+{
   std::vector<const robot_state::AttachedBody*> attached_bodies;
   kinematic_state->getAttachedBodies(attached_bodies);
+
+  std::set<std::string> current_bodies;
   for (std::size_t i = 0; i < attached_bodies.size(); ++i)
   {
+    const robot_state::AttachedBody* ab = attached_bodies[i];
+    current_bodies.insert(ab->getName());
+
     std_msgs::ColorRGBA color = default_attached_object_color;
     float alpha = robot_.getAlpha();
     if (color_map)
     {
-      std::map<std::string, std_msgs::ColorRGBA>::const_iterator it = color_map->find(attached_bodies[i]->getName());
+      std::map<std::string, std_msgs::ColorRGBA>::const_iterator it = color_map->find(ab->getName());
       if (it != color_map->end())
       {  // render attached bodies with a color that is a bit different
         color.r = std::max(1.0f, it->second.r * 1.05f);
@@ -122,20 +193,62 @@ void RobotStateVisualization::updateHelper(const robot_state::RobotStateConstPtr
         alpha = color.a = it->second.a;
       }
     }
-    rviz::Color rcolor(color.r, color.g, color.b);
-    const EigenSTL::vector_Isometry3d& ab_t = attached_bodies[i]->getGlobalCollisionBodyTransforms();
-    const std::vector<shapes::ShapeConstPtr>& ab_shapes = attached_bodies[i]->getShapes();
-    for (std::size_t j = 0; j < ab_shapes.size(); ++j)
+
+    const EigenSTL::vector_Isometry3d& ab_t = ab->getFixedTransforms();
+    AttachedBodyRender& render = attached_body_renders_[ab->getName()];
+
+    bool same_geometry = render.shapes_render && render.shapes == ab->getShapes() && render.color.r == color.r &&
+                         render.color.g == color.g && render.color.b == color.b && render.color.a == color.a &&
+                         render.alpha == alpha && render.fixed_transforms.size() == ab_t.size();
+    for (std::size_t j = 0; same_geometry && j < ab_t.size(); ++j)
+      same_geometry = (render.fixed_transforms[j].matrix().array() == ab_t[j].matrix().array()).all();
+
+    if (!same_geometry)
     {
-      render_shapes_->renderShape(robot_.getVisualNode(), ab_shapes[j].get(), ab_t[j], octree_voxel_render_mode_,
-                                  octree_voxel_color_mode_, rcolor, alpha);
-      render_shapes_->renderShape(robot_.getCollisionNode(), ab_shapes[j].get(), ab_t[j], octree_voxel_render_mode_,
-                                  octree_voxel_color_mode_, rcolor, alpha);
+      destroyAttachedBodyRender(render);
+      render.visual_node = robot_.getVisualNode()->createChildSceneNode();
+      render.collision_node = robot_.getCollisionNode()->createChildSceneNode();
+      render.shapes_render.reset(new RenderShapes(context_));
+      render.shapes = ab->getShapes();
+      render.fixed_transforms = ab_t;
+      render.color = color;
+      render.alpha = alpha;
+
+      // render in the frame of the attached link, so later updates only need
+      // to reposition the body's scene nodes
+      rviz::Color rcolor(color.r, color.g, color.b);
+      for (std::size_t j = 0; j < render.shapes.size(); ++j)
+      {
+        render.shapes_render->renderShape(render.visual_node, render.shapes[j].get(), ab_t[j],
+                                          octree_voxel_render_mode_, octree_voxel_color_mode_, rcolor, alpha);
+        render.shapes_render->renderShape(render.collision_node, render.shapes[j].get(), ab_t[j],
+                                          octree_voxel_render_mode_, octree_voxel_color_mode_, rcolor, alpha);
+      }
     }
+
+    const Eigen::Isometry3d& t = kinematic_state->getGlobalLinkTransform(ab->getAttachedLink());
+    const Eigen::Vector3d& p = t.translation();
+    Eigen::Quaterniond q(t.rotation());
+    Ogre::Vector3 position(p.x(), p.y(), p.z());
+    Ogre::Quaternion orientation(q.w(), q.x(), q.y(), q.z());
+    render.visual_node->setPosition(position);
+    render.visual_node->setOrientation(orientation);
+    render.collision_node->setPosition(position);
+    render.collision_node->setOrientation(orientation);
+  }
+
+  // drop renders of bodies that are no longer attached
+  for (std::map<std::string, AttachedBodyRender>::iterator it = attached_body_renders_.begin();
+       it != attached_body_renders_.end();)
+  {
+    if (current_bodies.find(it->first) == current_bodies.end())
+    {
+      destroyAttachedBodyRender(it->second);
+      attached_body_renders_.erase(it++);
+    }
+    else
+      ++it;
   }
-  robot_.setVisualVisible(visual_visible_);
-  robot_.setCollisionVisible(collision_visible_);
-  robot_.setVisible(visible_);
 }
 
 void RobotStateVisualization::setVisible(bool visible)
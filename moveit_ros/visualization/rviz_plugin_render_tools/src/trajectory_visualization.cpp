@@ -59,7 +59,9 @@
 namespace moveit_rviz_plugin
 {
 TrajectoryVisualization::TrajectoryVisualization(rviz::Property* widget, rviz::Display* display)
-  : animating_path_(false)
+  : trail_step_size_(1)
+  , trail_visible_count_(0)
+  , animating_path_(false)
   , drop_displaying_trajectory_(false)
   , current_state_(-1)
   , display_(display)
@@ -109,6 +111,13 @@ TrajectoryVisualization::TrajectoryVisualization(rviz::Property* widget, rviz::D
                                                     widget, SLOT(changedTrailStepSize()), this);
   trail_step_size_property_->setMin(1);
 
+  trail_max_states_property_ =
+      new rviz::IntProperty("Max Trail States", 100, "Limits the number of states shown in the trajectory trail; "
+                                                     "longer trajectories are decimated to at most this many "
+                                                     "samples (0 means no limit).",
+                            widget, SLOT(changedTrailMaxStates()), this);
+  trail_max_states_property_->setMin(0);
+
   interrupt_display_property_ = new rviz::BoolProperty(
       "Interrupt Display", false,
       "Immediately show newly planned trajectory, interrupting the currently displayed one.", widget);
@@ -122,7 +131,7 @@ TrajectoryVisualization::TrajectoryVisualization(rviz::Property* widget, rviz::D
 
 TrajectoryVisualization::~TrajectoryVisualization()
 {
-  clearTrajectoryTrail();
+  destroyTrajectoryTrail();
   trajectory_message_to_display_.reset();
   displaying_trajectory_message_.reset();
 
@@ -175,6 +184,9 @@ void TrajectoryVisualization::onRobotModelLoaded(robot_model::RobotModelConstPtr
     return;
   }
 
+  // any pooled trail robots were built from the previous model's URDF
+  destroyTrajectoryTrail();
+
   // Load robot state
   robot_state_.reset(new robot_state::RobotState(robot_model_));
   robot_state_->setToDefaultValues();
@@ -201,9 +213,24 @@ void TrajectoryVisualization::reset()
 
 void TrajectoryVisualization::clearTrajectoryTrail()
 {
+  // retire the trail robots into the pool instead of destroying them; loading
+  // the render geometry from the URDF is by far the most expensive part of
+  // building a trail, so the next trail reuses these robots
   for (std::size_t i = 0; i < trajectory_trail_.size(); ++i)
-    delete trajectory_trail_[i];
+  {
+    trajectory_trail_[i]->setVisible(false);
+    trail_robot_pool_.push_back(trajectory_trail_[i]);
+  }
   trajectory_trail_.clear();
+  trail_visible_count_ = 0;
+}
+
+void TrajectoryVisualization::destroyTrajectoryTrail()
+{
+  clearTrajectoryTrail();
+  for (std::size_t i = 0; i < trail_robot_pool_.size(); ++i)
+    delete trail_robot_pool_[i];
+  trail_robot_pool_.clear();
 }
 
 void TrajectoryVisualization::changedLoopDisplay()
@@ -226,24 +253,50 @@ void TrajectoryVisualization::changedShowTrail()
     return;
 
   int stepsize = trail_step_size_property_->getInt();
+  // decimate long trajectories so the trail stays at a bounded level of detail
+  int max_states = trail_max_states_property_->getInt();
+  if (max_states > 0)
+    stepsize = std::max(stepsize, (int)std::ceil(t->getWayPointCount() / (float)max_states));
+  trail_step_size_ = stepsize;
   // always include last trajectory point
   trajectory_trail_.resize((int)std::ceil((t->getWayPointCount() + stepsize - 1) / (float)stepsize));
+  trail_visible_count_ = 0;
   for (std::size_t i = 0; i < trajectory_trail_.size(); i++)
   {
     int waypoint_i = std::min(i * stepsize, t->getWayPointCount() - 1);  // limit to last trajectory point
-    rviz::Robot* r = new rviz::Robot(scene_node_, context_, "Trail Robot " + boost::lexical_cast<std::string>(i), NULL);
-    r->load(*robot_model_->getURDF());
+    rviz::Robot* r;
+    if (!trail_robot_pool_.empty())
+    {  // reuse a retired trail robot; only its link poses need updating
+      r = trail_robot_pool_.back();
+      trail_robot_pool_.pop_back();
+    }
+    else
+    {
+      r = new rviz::Robot(scene_node_, context_, "Trail Robot " + boost::lexical_cast<std::string>(i), NULL);
+      r->load(*robot_model_->getURDF());
+    }
     r->setVisualVisible(display_path_visual_enabled_property_->getBool());
     r->setCollisionVisible(display_path_collision_enabled_property_->getBool());
     r->setAlpha(robot_path_alpha_property_->getFloat());
     r->update(PlanningLinkUpdater(t->getWayPointPtr(waypoint_i)));
     if (enable_robot_color_property_->getBool())
       setRobotColor(r, robot_color_property_->getColor());
-    r->setVisible(display_->isEnabled() && (!animating_path_ || waypoint_i <= current_state_));
+    else
+      unsetRobotColor(r);  // a pooled robot may still carry a color
+    bool visible = display_->isEnabled() && (!animating_path_ || waypoint_i <= current_state_);
+    r->setVisible(visible);
+    if (visible)
+      trail_visible_count_ = i + 1;
     trajectory_trail_[i] = r;
   }
 }
 
+void TrajectoryVisualization::changedTrailMaxStates()
+{
+  if (trail_display_property_->getBool())
+    changedShowTrail();
+}
+
 void TrajectoryVisualization::changedTrailStepSize()
 {
   if (trail_display_property_->getBool())
@@ -307,6 +360,7 @@ void TrajectoryVisualization::onEnable()
     trajectory_trail_[i]->setCollisionVisible(display_path_collision_enabled_property_->getBool());
     trajectory_trail_[i]->setVisible(true);
   }
+  trail_visible_count_ = trajectory_trail_.size();
 
   changedTrajectoryTopic();  // load topic at startup if default used
 }
@@ -316,6 +370,7 @@ void TrajectoryVisualization::onDisable()
   display_path_robot_->setVisible(false);
   for (std::size_t i = 0; i < trajectory_trail_.size(); ++i)
     trajectory_trail_[i]->setVisible(false);
+  trail_visible_count_ = 0;
   displaying_trajectory_message_.reset();
   animating_path_ = false;
   if (trajectory_slider_panel_)
@@ -442,9 +497,16 @@ void TrajectoryVisualization::update(float wall_dt, float ros_dt)
       if (trajectory_slider_panel_)
         trajectory_slider_panel_->setSliderPosition(current_state_);
       display_path_robot_->update(displaying_trajectory_message_->getWayPointPtr(current_state_));
-      for (std::size_t i = 0; i < trajectory_trail_.size(); ++i)
-        trajectory_trail_[i]->setVisible(
-            std::min(waypoint_count - 1, static_cast<int>(i) * trail_step_size_property_->getInt()) <= current_state_);
+      // only toggle the trail robots whose visibility threshold was crossed
+      // since the last update, instead of touching every trail robot
+      std::size_t visible_count = trajectory_trail_.size();
+      if (current_state_ < waypoint_count - 1)
+        visible_count = std::min(visible_count, static_cast<std::size_t>(current_state_ / trail_step_size_ + 1));
+      for (std::size_t i = trail_visible_count_; i < visible_count; ++i)
+        trajectory_trail_[i]->setVisible(true);
+      for (std::size_t i = visible_count; i < trail_visible_count_; ++i)
+        trajectory_trail_[i]->setVisible(false);
+      trail_visible_count_ = visible_count;
     }
     else
     {
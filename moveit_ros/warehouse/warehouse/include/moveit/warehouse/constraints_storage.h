@@ -40,6 +40,9 @@
 #include "moveit/warehouse/moveit_message_storage.h"
 #include <moveit/macros/class_forward.h>
 #include <moveit_msgs/Constraints.h>
+#include <geometry_msgs/Point.h>
+#include <boost/thread/mutex.hpp>
+#include <map>
 
 namespace moveit_warehouse
 {
@@ -78,10 +81,52 @@ public:
 
   void reset();
 
+  /** \brief Load all constraints (optionally restricted to \e robot and \e group) into an in-memory index,
+      so that subsequent lookups are resolved without a database round trip. Mutations made through this
+      class keep the index up to date; calling this again refreshes it. */
+  void loadConstraintsIndex(const std::string& robot = "", const std::string& group = "");
+
+  /** \brief Drop the in-memory index; lookups go back to querying the database */
+  void clearConstraintsIndex();
+
+  bool constraintsIndexLoaded() const;
+
+  /** \brief Get the names of indexed constraints whose position constraint regions may intersect the
+      axis-aligned box spanned by \e min_corner and \e max_corner. The bounds kept per constraint are
+      conservative (orientation of the constraint regions is ignored) and expressed in the frame of the
+      position constraints. Only constraints that have position constraints are considered. The index
+      must be loaded. */
+  void getIndexedConstraintsInBox(const geometry_msgs::Point& min_corner, const geometry_msgs::Point& max_corner,
+                                  std::vector<std::string>& names) const;
+
 private:
+  /// An index entry: the deserialized constraints plus a conservative bound on its position constraint regions
+  struct IndexedConstraints
+  {
+    ConstraintsWithMetadata constraints_;
+    bool has_position_bounds_;
+    double position_min_[3];
+    double position_max_[3];
+  };
+
   void createCollections();
 
+  /// True if a lookup restricted to \e robot and \e group can be answered from the loaded index
+  bool indexCovers(const std::string& robot, const std::string& group) const;
+
+  /// Re-query the database for \e name and rebuild the corresponding index bucket (index lock must not be held)
+  void refreshIndexEntry(const std::string& name);
+
+  /// Compute the position bounds of \e constraints and add them to the index (index lock must be held)
+  void indexConstraints(const ConstraintsWithMetadata& constraints);
+
   ConstraintsCollection constraints_collection_;
+
+  mutable boost::mutex index_lock_;
+  bool index_loaded_;
+  std::string index_robot_;
+  std::string index_group_;
+  std::map<std::string, std::vector<IndexedConstraints> > constraints_index_;
 };
 }
 
@@ -0,0 +1,88 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_MOVEIT_WAREHOUSE_MESSAGE_BLOB_
+#define MOVEIT_MOVEIT_WAREHOUSE_MESSAGE_BLOB_
+
+#include <ros/serialization.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace moveit_warehouse
+{
+/** \brief A flat byte buffer holding the concatenation of length-prefixed ROS message serializations.
+    Storing a batch of messages as one such buffer (compressed) costs one database round trip instead
+    of one per message. */
+typedef std::vector<std::uint8_t> MessageBlob;
+
+/// \brief Append the serialization of \e msg to \e blob, prefixed by its serialized length
+template <typename M>
+void appendMessageToBlob(const M& msg, MessageBlob& blob)
+{
+  const std::uint32_t serial_size = ros::serialization::serializationLength(msg);
+  std::size_t offset = blob.size();
+  blob.resize(offset + sizeof(serial_size) + serial_size);
+  memcpy(&blob[offset], &serial_size, sizeof(serial_size));
+  ros::serialization::OStream stream(&blob[offset + sizeof(serial_size)], serial_size);
+  ros::serialization::serialize(stream, msg);
+}
+
+/** \brief Read the next length-prefixed message from \e blob, starting at \e offset, into \e msg.
+    On success \e offset is advanced past the message. Returns false when \e offset is at the end of
+    the blob or the blob is truncated. */
+template <typename M>
+bool readMessageFromBlob(const MessageBlob& blob, std::size_t& offset, M& msg)
+{
+  std::uint32_t serial_size;
+  if (offset + sizeof(serial_size) > blob.size())
+    return false;
+  memcpy(&serial_size, &blob[offset], sizeof(serial_size));
+  if (offset + sizeof(serial_size) + serial_size > blob.size())
+    return false;
+  offset += sizeof(serial_size);
+  ros::serialization::IStream stream(const_cast<std::uint8_t*>(&blob[offset]), serial_size);
+  ros::serialization::deserialize(stream, msg);
+  offset += serial_size;
+  return true;
+}
+
+/// \brief Compress \e blob (zlib) into \e compressed; the uncompressed size is stored in the payload
+void compressBlob(const MessageBlob& blob, MessageBlob& compressed);
+
+/// \brief Inverse of compressBlob(); returns false (and logs an error) if the payload is corrupt
+bool decompressBlob(const MessageBlob& compressed, MessageBlob& blob);
+}
+
+#endif
@@ -42,16 +42,20 @@
 #include <moveit_msgs/PlanningScene.h>
 #include <moveit_msgs/MotionPlanRequest.h>
 #include <moveit_msgs/RobotTrajectory.h>
+#include <std_msgs/UInt8MultiArray.h>
+#include <boost/function.hpp>
 
 namespace moveit_warehouse
 {
 typedef warehouse_ros::MessageWithMetadata<moveit_msgs::PlanningScene>::ConstPtr PlanningSceneWithMetadata;
 typedef warehouse_ros::MessageWithMetadata<moveit_msgs::MotionPlanRequest>::ConstPtr MotionPlanRequestWithMetadata;
 typedef warehouse_ros::MessageWithMetadata<moveit_msgs::RobotTrajectory>::ConstPtr RobotTrajectoryWithMetadata;
+typedef warehouse_ros::MessageWithMetadata<std_msgs::UInt8MultiArray>::ConstPtr TrajectoryBlobWithMetadata;
 
 typedef warehouse_ros::MessageCollection<moveit_msgs::PlanningScene>::Ptr PlanningSceneCollection;
 typedef warehouse_ros::MessageCollection<moveit_msgs::MotionPlanRequest>::Ptr MotionPlanRequestCollection;
 typedef warehouse_ros::MessageCollection<moveit_msgs::RobotTrajectory>::Ptr RobotTrajectoryCollection;
+typedef warehouse_ros::MessageCollection<std_msgs::UInt8MultiArray>::Ptr TrajectoryBlobCollection;
 
 MOVEIT_CLASS_FORWARD(PlanningSceneStorage);
 
@@ -62,15 +66,31 @@ public:
 
   static const std::string PLANNING_SCENE_ID_NAME;
   static const std::string MOTION_PLAN_REQUEST_ID_NAME;
+  static const std::string TRAJECTORY_COUNT_NAME;
 
   PlanningSceneStorage(warehouse_ros::DatabaseConnection::Ptr conn);
 
   void addPlanningScene(const moveit_msgs::PlanningScene& scene);
+
+  /** \brief Add a batch of planning scenes; the names already in the database are looked up once for the
+      whole batch instead of once per scene */
+  void addPlanningScenes(const std::vector<moveit_msgs::PlanningScene>& scenes);
   void addPlanningQuery(const moveit_msgs::MotionPlanRequest& planning_query, const std::string& scene_name,
                         const std::string& query_name = "");
   void addPlanningResult(const moveit_msgs::MotionPlanRequest& planning_query,
                          const moveit_msgs::RobotTrajectory& result, const std::string& scene_name);
 
+  /** \brief Add a batch of planning results for the same query; the query is matched against the stored
+      requests once for the whole batch instead of once per result */
+  void addPlanningResults(const moveit_msgs::MotionPlanRequest& planning_query,
+                          const std::vector<moveit_msgs::RobotTrajectory>& results, const std::string& scene_name);
+
+  /** \brief Store a batch of planning results for the same query as a single compressed blob document.
+      This is the fast path for bulk writers (benchmarks); blobs are kept in a separate collection and are
+      only visible through getPlanningResultsBlob() / streamPlanningResultsBlob(), not getPlanningResults() */
+  void addPlanningResultsBlob(const moveit_msgs::MotionPlanRequest& planning_query,
+                              const std::vector<moveit_msgs::RobotTrajectory>& results, const std::string& scene_name);
+
   bool hasPlanningScene(const std::string& name) const;
   void getPlanningSceneNames(std::vector<std::string>& names) const;
   void getPlanningSceneNames(const std::string& regex, std::vector<std::string>& names) const;
@@ -95,6 +115,16 @@ public:
   void getPlanningResults(std::vector<RobotTrajectoryWithMetadata>& planning_results, const std::string& scene_name,
                           const std::string& query_name) const;
 
+  /** \brief Retrieve all planning results stored in blob form for a query (see addPlanningResultsBlob()).
+      Returns false if a blob could not be decoded */
+  bool getPlanningResultsBlob(std::vector<moveit_msgs::RobotTrajectory>& planning_results,
+                              const std::string& scene_name, const std::string& query_name) const;
+
+  /** \brief Call \e callback for every planning result stored in blob form for a query, decoding one
+      message at a time; at most one uncompressed batch is resident in memory at any point */
+  bool streamPlanningResultsBlob(const boost::function<void(const moveit_msgs::RobotTrajectory&)>& callback,
+                                 const std::string& scene_name, const std::string& query_name) const;
+
   void renamePlanningScene(const std::string& old_scene_name, const std::string& new_scene_name);
   void renamePlanningQuery(const std::string& scene_name, const std::string& old_query_name,
                            const std::string& new_query_name);
@@ -118,6 +148,7 @@ private:
   PlanningSceneCollection planning_scene_collection_;
   MotionPlanRequestCollection motion_plan_request_collection_;
   RobotTrajectoryCollection robot_trajectory_collection_;
+  TrajectoryBlobCollection robot_trajectory_blob_collection_;
 };
 }
 
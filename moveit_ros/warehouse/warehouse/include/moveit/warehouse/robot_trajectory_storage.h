@@ -0,0 +1,109 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef MOVEIT_MOVEIT_WAREHOUSE_ROBOT_TRAJECTORY_STORAGE_
+#define MOVEIT_MOVEIT_WAREHOUSE_ROBOT_TRAJECTORY_STORAGE_
+
+#include "moveit/warehouse/moveit_message_storage.h"
+#include <moveit/macros/class_forward.h>
+#include <moveit_msgs/RobotTrajectory.h>
+
+namespace moveit_warehouse
+{
+typedef warehouse_ros::MessageWithMetadata<moveit_msgs::RobotTrajectory>::ConstPtr RobotTrajectoryWithMetadata;
+typedef warehouse_ros::MessageCollection<moveit_msgs::RobotTrajectory>::Ptr RobotTrajectoryCollection;
+
+MOVEIT_CLASS_FORWARD(RobotTrajectoryStorage);
+
+/** \brief Storage for previously computed trajectories, indexed by quantized start and goal
+    states so that solutions of earlier, nearby requests can be retrieved and reused as seeds
+    when planning repetitive motions. */
+class RobotTrajectoryStorage : public MoveItMessageStorage
+{
+public:
+  static const std::string DATABASE_NAME;
+
+  static const std::string TRAJECTORY_ID_NAME;
+  static const std::string TRAJECTORY_GROUP_NAME;
+  static const std::string ROBOT_NAME;
+  static const std::string START_STATE_KEY_NAME;
+  static const std::string GOAL_STATE_KEY_NAME;
+
+  /// The joint-space resolution (in radians or meters, per joint) used by computeStateKey() by default
+  static const double DEFAULT_KEY_RESOLUTION;
+
+  RobotTrajectoryStorage(warehouse_ros::DatabaseConnection::Ptr conn);
+
+  /** \brief Compute the lookup key for a joint state: each value is quantized to \e resolution and
+      the quantized values are concatenated. States within the same quantization cell map to the
+      same key, so trajectories stored under the key of one request are found by all nearby ones. */
+  static std::string computeStateKey(const std::vector<double>& joint_values,
+                                     double resolution = DEFAULT_KEY_RESOLUTION);
+
+  void addTrajectory(const moveit_msgs::RobotTrajectory& msg, const std::string& name, const std::string& robot = "",
+                     const std::string& group = "", const std::string& start_state_key = "",
+                     const std::string& goal_state_key = "");
+  bool hasTrajectory(const std::string& name, const std::string& robot = "", const std::string& group = "") const;
+  void getKnownTrajectories(std::vector<std::string>& names, const std::string& robot = "",
+                            const std::string& group = "") const;
+  void getKnownTrajectories(const std::string& regex, std::vector<std::string>& names, const std::string& robot = "",
+                            const std::string& group = "") const;
+
+  /** \brief Get the trajectory named \e name. Return false on failure. */
+  bool getTrajectory(RobotTrajectoryWithMetadata& msg_m, const std::string& name, const std::string& robot = "",
+                     const std::string& group = "") const;
+
+  /** \brief Get up to \e k trajectories stored for \e group whose start and goal states were
+      quantized to \e start_state_key and \e goal_state_key (see computeStateKey()). An empty key
+      matches any stored value, so passing only the goal key retrieves all trajectories that end
+      near the requested goal. */
+  void getMatchingTrajectories(std::vector<RobotTrajectoryWithMetadata>& msgs, const std::string& group,
+                               const std::string& start_state_key, const std::string& goal_state_key,
+                               std::size_t k = 5, const std::string& robot = "") const;
+
+  void renameTrajectory(const std::string& old_name, const std::string& new_name, const std::string& robot = "",
+                        const std::string& group = "");
+
+  void removeTrajectory(const std::string& name, const std::string& robot = "", const std::string& group = "");
+
+  void reset();
+
+private:
+  void createCollections();
+
+  RobotTrajectoryCollection trajectory_collection_;
+};
+}
+
+#endif
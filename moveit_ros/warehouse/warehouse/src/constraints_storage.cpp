@@ -35,6 +35,9 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/warehouse/constraints_storage.h>
+#include <shape_msgs/SolidPrimitive.h>
+#include <algorithm>
+#include <cmath>
 
 const std::string moveit_warehouse::ConstraintsStorage::DATABASE_NAME = "moveit_constraints";
 
@@ -45,8 +48,52 @@ const std::string moveit_warehouse::ConstraintsStorage::ROBOT_NAME = "robot_id";
 using warehouse_ros::Metadata;
 using warehouse_ros::Query;
 
+namespace
+{
+// true if the metadata of an entry passes the (possibly empty) robot and group filters
+bool metadataMatches(const moveit_warehouse::ConstraintsWithMetadata& entry, const std::string& robot,
+                     const std::string& group)
+{
+  if (!robot.empty() &&
+      (!entry->lookupField(moveit_warehouse::ConstraintsStorage::ROBOT_NAME) ||
+       entry->lookupString(moveit_warehouse::ConstraintsStorage::ROBOT_NAME) != robot))
+    return false;
+  if (!group.empty() &&
+      (!entry->lookupField(moveit_warehouse::ConstraintsStorage::CONSTRAINTS_GROUP_NAME) ||
+       entry->lookupString(moveit_warehouse::ConstraintsStorage::CONSTRAINTS_GROUP_NAME) != group))
+    return false;
+  return true;
+}
+
+// radius of a sphere centered at the primitive pose that is guaranteed to contain the primitive,
+// regardless of its orientation
+double primitiveBoundRadius(const shape_msgs::SolidPrimitive& primitive)
+{
+  switch (primitive.type)
+  {
+    case shape_msgs::SolidPrimitive::BOX:
+      if (primitive.dimensions.size() >= 3)
+        return 0.5 * sqrt(primitive.dimensions[0] * primitive.dimensions[0] +
+                          primitive.dimensions[1] * primitive.dimensions[1] +
+                          primitive.dimensions[2] * primitive.dimensions[2]);
+      break;
+    case shape_msgs::SolidPrimitive::SPHERE:
+      if (primitive.dimensions.size() >= 1)
+        return primitive.dimensions[0];
+      break;
+    case shape_msgs::SolidPrimitive::CYLINDER:
+    case shape_msgs::SolidPrimitive::CONE:
+      if (primitive.dimensions.size() >= 2)
+        return sqrt(0.25 * primitive.dimensions[0] * primitive.dimensions[0] +
+                    primitive.dimensions[1] * primitive.dimensions[1]);
+      break;
+  }
+  return 0.0;
+}
+}
+
 moveit_warehouse::ConstraintsStorage::ConstraintsStorage(warehouse_ros::DatabaseConnection::Ptr conn)
-  : MoveItMessageStorage(conn)
+  : MoveItMessageStorage(conn), index_loaded_(false)
 {
   createCollections();
 }
@@ -58,6 +105,7 @@ void moveit_warehouse::ConstraintsStorage::createCollections()
 
 void moveit_warehouse::ConstraintsStorage::reset()
 {
+  clearConstraintsIndex();
   constraints_collection_.reset();
   conn_->dropDatabase(DATABASE_NAME);
   createCollections();
@@ -78,11 +126,26 @@ void moveit_warehouse::ConstraintsStorage::addConstraints(const moveit_msgs::Con
   metadata->append(CONSTRAINTS_GROUP_NAME, group);
   constraints_collection_->insert(msg, metadata);
   ROS_DEBUG("%s constraints '%s'", replace ? "Replaced" : "Added", msg.name.c_str());
+  if (constraintsIndexLoaded())
+    refreshIndexEntry(msg.name);
 }
 
 bool moveit_warehouse::ConstraintsStorage::hasConstraints(const std::string& name, const std::string& robot,
                                                           const std::string& group) const
 {
+  {
+    boost::mutex::scoped_lock slock(index_lock_);
+    if (index_loaded_ && indexCovers(robot, group))
+    {
+      std::map<std::string, std::vector<IndexedConstraints> >::const_iterator it = constraints_index_.find(name);
+      if (it == constraints_index_.end())
+        return false;
+      for (std::size_t i = 0; i < it->second.size(); ++i)
+        if (metadataMatches(it->second[i].constraints_, robot, group))
+          return true;
+      return false;
+    }
+  }
   Query::Ptr q = constraints_collection_->createQuery();
   q->append(CONSTRAINTS_ID_NAME, name);
   if (!robot.empty())
@@ -105,6 +168,22 @@ void moveit_warehouse::ConstraintsStorage::getKnownConstraints(std::vector<std::
                                                                const std::string& robot, const std::string& group) const
 {
   names.clear();
+  {
+    boost::mutex::scoped_lock slock(index_lock_);
+    if (index_loaded_ && indexCovers(robot, group))
+    {
+      // the map is ordered by name, so this matches the sorted database query below
+      for (std::map<std::string, std::vector<IndexedConstraints> >::const_iterator it = constraints_index_.begin();
+           it != constraints_index_.end(); ++it)
+        for (std::size_t i = 0; i < it->second.size(); ++i)
+          if (metadataMatches(it->second[i].constraints_, robot, group))
+          {
+            names.push_back(it->first);
+            break;
+          }
+      return;
+    }
+  }
   Query::Ptr q = constraints_collection_->createQuery();
   if (!robot.empty())
     q->append(ROBOT_NAME, robot);
@@ -119,6 +198,22 @@ void moveit_warehouse::ConstraintsStorage::getKnownConstraints(std::vector<std::
 bool moveit_warehouse::ConstraintsStorage::getConstraints(ConstraintsWithMetadata& msg_m, const std::string& name,
                                                           const std::string& robot, const std::string& group) const
 {
+  {
+    boost::mutex::scoped_lock slock(index_lock_);
+    if (index_loaded_ && indexCovers(robot, group))
+    {
+      std::map<std::string, std::vector<IndexedConstraints> >::const_iterator it = constraints_index_.find(name);
+      if (it == constraints_index_.end())
+        return false;
+      for (std::size_t i = it->second.size(); i > 0; --i)
+        if (metadataMatches(it->second[i - 1].constraints_, robot, group))
+        {
+          msg_m = it->second[i - 1].constraints_;
+          return true;
+        }
+      return false;
+    }
+  }
   Query::Ptr q = constraints_collection_->createQuery();
   q->append(CONSTRAINTS_ID_NAME, name);
   if (!robot.empty())
@@ -150,6 +245,11 @@ void moveit_warehouse::ConstraintsStorage::renameConstraints(const std::string&
   m->append(CONSTRAINTS_ID_NAME, new_name);
   constraints_collection_->modifyMetadata(q, m);
   ROS_DEBUG("Renamed constraints from '%s' to '%s'", old_name.c_str(), new_name.c_str());
+  if (constraintsIndexLoaded())
+  {
+    refreshIndexEntry(old_name);
+    refreshIndexEntry(new_name);
+  }
 }
 
 void moveit_warehouse::ConstraintsStorage::removeConstraints(const std::string& name, const std::string& robot,
@@ -163,4 +263,145 @@ void moveit_warehouse::ConstraintsStorage::removeConstraints(const std::string&
     q->append(CONSTRAINTS_GROUP_NAME, group);
   unsigned int rem = constraints_collection_->removeMessages(q);
   ROS_DEBUG("Removed %u Constraints messages (named '%s')", rem, name.c_str());
+  boost::mutex::scoped_lock slock(index_lock_);
+  if (index_loaded_)
+  {
+    std::map<std::string, std::vector<IndexedConstraints> >::iterator it = constraints_index_.find(name);
+    if (it != constraints_index_.end())
+    {
+      std::vector<IndexedConstraints> remaining;
+      for (std::size_t i = 0; i < it->second.size(); ++i)
+        if (!metadataMatches(it->second[i].constraints_, robot, group))
+          remaining.push_back(it->second[i]);
+      if (remaining.empty())
+        constraints_index_.erase(it);
+      else
+        it->second.swap(remaining);
+    }
+  }
+}
+
+void moveit_warehouse::ConstraintsStorage::loadConstraintsIndex(const std::string& robot, const std::string& group)
+{
+  Query::Ptr q = constraints_collection_->createQuery();
+  if (!robot.empty())
+    q->append(ROBOT_NAME, robot);
+  if (!group.empty())
+    q->append(CONSTRAINTS_GROUP_NAME, group);
+  std::vector<ConstraintsWithMetadata> constr = constraints_collection_->queryList(q, false);
+  boost::mutex::scoped_lock slock(index_lock_);
+  constraints_index_.clear();
+  index_robot_ = robot;
+  index_group_ = group;
+  index_loaded_ = true;
+  for (std::size_t i = 0; i < constr.size(); ++i)
+    indexConstraints(constr[i]);
+  ROS_DEBUG("Loaded %u constraints into the in-memory index", (unsigned int)constr.size());
+}
+
+void moveit_warehouse::ConstraintsStorage::clearConstraintsIndex()
+{
+  boost::mutex::scoped_lock slock(index_lock_);
+  index_loaded_ = false;
+  index_robot_.clear();
+  index_group_.clear();
+  constraints_index_.clear();
+}
+
+bool moveit_warehouse::ConstraintsStorage::constraintsIndexLoaded() const
+{
+  boost::mutex::scoped_lock slock(index_lock_);
+  return index_loaded_;
+}
+
+bool moveit_warehouse::ConstraintsStorage::indexCovers(const std::string& robot, const std::string& group) const
+{
+  // a lookup with an empty filter spans all robots (groups), so it can only be answered from the
+  // index if the index was loaded without the corresponding restriction
+  return (index_robot_.empty() || robot == index_robot_) && (index_group_.empty() || group == index_group_);
+}
+
+void moveit_warehouse::ConstraintsStorage::refreshIndexEntry(const std::string& name)
+{
+  Query::Ptr q = constraints_collection_->createQuery();
+  q->append(CONSTRAINTS_ID_NAME, name);
+  if (!index_robot_.empty())
+    q->append(ROBOT_NAME, index_robot_);
+  if (!index_group_.empty())
+    q->append(CONSTRAINTS_GROUP_NAME, index_group_);
+  std::vector<ConstraintsWithMetadata> constr = constraints_collection_->queryList(q, false);
+  boost::mutex::scoped_lock slock(index_lock_);
+  if (!index_loaded_)
+    return;
+  constraints_index_.erase(name);
+  for (std::size_t i = 0; i < constr.size(); ++i)
+    indexConstraints(constr[i]);
+}
+
+void moveit_warehouse::ConstraintsStorage::indexConstraints(const ConstraintsWithMetadata& constraints)
+{
+  if (!constraints->lookupField(CONSTRAINTS_ID_NAME))
+    return;
+  const std::string name = constraints->lookupString(CONSTRAINTS_ID_NAME);
+  // in case the constraints were renamed, the name in the message may be out of date
+  const_cast<moveit_msgs::Constraints*>(static_cast<const moveit_msgs::Constraints*>(constraints.get()))->name = name;
+
+  IndexedConstraints entry;
+  entry.constraints_ = constraints;
+  entry.has_position_bounds_ = false;
+  entry.position_min_[0] = entry.position_min_[1] = entry.position_min_[2] = 0.0;
+  entry.position_max_[0] = entry.position_max_[1] = entry.position_max_[2] = 0.0;
+  const std::vector<moveit_msgs::PositionConstraint>& pcs = constraints->position_constraints;
+  for (std::size_t i = 0; i < pcs.size(); ++i)
+  {
+    std::size_t np = std::min(pcs[i].constraint_region.primitives.size(),
+                              pcs[i].constraint_region.primitive_poses.size());
+    for (std::size_t j = 0; j < np; ++j)
+    {
+      const geometry_msgs::Point& center = pcs[i].constraint_region.primitive_poses[j].position;
+      double radius = primitiveBoundRadius(pcs[i].constraint_region.primitives[j]);
+      double region_min[3] = { center.x - radius, center.y - radius, center.z - radius };
+      double region_max[3] = { center.x + radius, center.y + radius, center.z + radius };
+      for (int k = 0; k < 3; ++k)
+        if (entry.has_position_bounds_)
+        {
+          entry.position_min_[k] = std::min(entry.position_min_[k], region_min[k]);
+          entry.position_max_[k] = std::max(entry.position_max_[k], region_max[k]);
+        }
+        else
+        {
+          entry.position_min_[k] = region_min[k];
+          entry.position_max_[k] = region_max[k];
+        }
+      entry.has_position_bounds_ = true;
+    }
+  }
+  constraints_index_[name].push_back(entry);
+}
+
+void moveit_warehouse::ConstraintsStorage::getIndexedConstraintsInBox(const geometry_msgs::Point& min_corner,
+                                                                      const geometry_msgs::Point& max_corner,
+                                                                      std::vector<std::string>& names) const
+{
+  names.clear();
+  boost::mutex::scoped_lock slock(index_lock_);
+  if (!index_loaded_)
+  {
+    ROS_WARN("The constraints index is not loaded; getIndexedConstraintsInBox() returns no results");
+    return;
+  }
+  for (std::map<std::string, std::vector<IndexedConstraints> >::const_iterator it = constraints_index_.begin();
+       it != constraints_index_.end(); ++it)
+    for (std::size_t i = 0; i < it->second.size(); ++i)
+    {
+      const IndexedConstraints& entry = it->second[i];
+      if (entry.has_position_bounds_ && entry.position_min_[0] <= max_corner.x &&
+          entry.position_max_[0] >= min_corner.x && entry.position_min_[1] <= max_corner.y &&
+          entry.position_max_[1] >= min_corner.y && entry.position_min_[2] <= max_corner.z &&
+          entry.position_max_[2] >= min_corner.z)
+      {
+        names.push_back(it->first);
+        break;
+      }
+    }
 }
@@ -0,0 +1,83 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/warehouse/message_blob.h>
+#include <ros/console.h>
+#include <zlib.h>
+
+void moveit_warehouse::compressBlob(const MessageBlob& blob, MessageBlob& compressed)
+{
+  const std::uint64_t blob_size = blob.size();
+  uLongf compressed_size = compressBound(blob_size);
+  compressed.resize(sizeof(blob_size) + compressed_size);
+  memcpy(&compressed[0], &blob_size, sizeof(blob_size));
+  if (blob_size == 0)
+  {
+    compressed.resize(sizeof(blob_size));
+    return;
+  }
+  // favor speed over ratio; the blobs are large and the database round trip dominates anyway
+  if (compress2(&compressed[sizeof(blob_size)], &compressed_size, &blob[0], blob_size, Z_BEST_SPEED) != Z_OK)
+  {
+    // compressBound() guarantees enough space, so this can only mean a broken zlib setup
+    ROS_ERROR("Unable to compress %lu byte message blob", (unsigned long)blob_size);
+    compressed.clear();
+    return;
+  }
+  compressed.resize(sizeof(blob_size) + compressed_size);
+}
+
+bool moveit_warehouse::decompressBlob(const MessageBlob& compressed, MessageBlob& blob)
+{
+  std::uint64_t blob_size;
+  if (compressed.size() < sizeof(blob_size))
+  {
+    ROS_ERROR("Compressed message blob is too short (%lu bytes)", (unsigned long)compressed.size());
+    return false;
+  }
+  memcpy(&blob_size, &compressed[0], sizeof(blob_size));
+  blob.resize(blob_size);
+  if (blob_size == 0)
+    return true;
+  uLongf decompressed_size = blob_size;
+  if (uncompress(&blob[0], &decompressed_size, &compressed[sizeof(blob_size)],
+                 compressed.size() - sizeof(blob_size)) != Z_OK ||
+      decompressed_size != blob_size)
+  {
+    ROS_ERROR("Unable to decompress message blob (expected %lu bytes)", (unsigned long)blob_size);
+    blob.clear();
+    return false;
+  }
+  return true;
+}
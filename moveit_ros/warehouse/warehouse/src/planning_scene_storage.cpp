@@ -35,12 +35,16 @@
 /* Author: Ioan Sucan */
 
 #include <moveit/warehouse/planning_scene_storage.h>
+#include <moveit/warehouse/message_blob.h>
+#include <boost/bind.hpp>
 #include <boost/regex.hpp>
+#include <set>
 
 const std::string moveit_warehouse::PlanningSceneStorage::DATABASE_NAME = "moveit_planning_scenes";
 
 const std::string moveit_warehouse::PlanningSceneStorage::PLANNING_SCENE_ID_NAME = "planning_scene_id";
 const std::string moveit_warehouse::PlanningSceneStorage::MOTION_PLAN_REQUEST_ID_NAME = "motion_request_id";
+const std::string moveit_warehouse::PlanningSceneStorage::TRAJECTORY_COUNT_NAME = "trajectory_count";
 
 using warehouse_ros::Metadata;
 using warehouse_ros::Query;
@@ -58,6 +62,8 @@ void moveit_warehouse::PlanningSceneStorage::createCollections()
       conn_->openCollectionPtr<moveit_msgs::MotionPlanRequest>(DATABASE_NAME, "motion_plan_request");
   robot_trajectory_collection_ =
       conn_->openCollectionPtr<moveit_msgs::RobotTrajectory>(DATABASE_NAME, "robot_trajectory");
+  robot_trajectory_blob_collection_ =
+      conn_->openCollectionPtr<std_msgs::UInt8MultiArray>(DATABASE_NAME, "robot_trajectory_blob");
 }
 
 void moveit_warehouse::PlanningSceneStorage::reset()
@@ -65,6 +71,7 @@ void moveit_warehouse::PlanningSceneStorage::reset()
   planning_scene_collection_.reset();
   motion_plan_request_collection_.reset();
   robot_trajectory_collection_.reset();
+  robot_trajectory_blob_collection_.reset();
   conn_->dropDatabase(DATABASE_NAME);
   createCollections();
 }
@@ -83,6 +90,25 @@ void moveit_warehouse::PlanningSceneStorage::addPlanningScene(const moveit_msgs:
   ROS_DEBUG("%s scene '%s'", replace ? "Replaced" : "Added", scene.name.c_str());
 }
 
+void moveit_warehouse::PlanningSceneStorage::addPlanningScenes(const std::vector<moveit_msgs::PlanningScene>& scenes)
+{
+  // fetch the names already in the database once, rather than issuing one existence query per scene
+  std::vector<std::string> names;
+  getPlanningSceneNames(names);
+  std::set<std::string> existing(names.begin(), names.end());
+  for (std::size_t i = 0; i < scenes.size(); ++i)
+  {
+    if (existing.find(scenes[i].name) != existing.end())
+      removePlanningScene(scenes[i].name);
+    else
+      existing.insert(scenes[i].name);
+    Metadata::Ptr metadata = planning_scene_collection_->createMetadata();
+    metadata->append(PLANNING_SCENE_ID_NAME, scenes[i].name);
+    planning_scene_collection_->insert(scenes[i], metadata);
+  }
+  ROS_DEBUG("Added %u scenes", (unsigned int)scenes.size());
+}
+
 bool moveit_warehouse::PlanningSceneStorage::hasPlanningScene(const std::string& name) const
 {
   Query::Ptr q = planning_scene_collection_->createQuery();
@@ -181,6 +207,48 @@ void moveit_warehouse::PlanningSceneStorage::addPlanningResult(const moveit_msgs
   robot_trajectory_collection_->insert(result, metadata);
 }
 
+void moveit_warehouse::PlanningSceneStorage::addPlanningResults(
+    const moveit_msgs::MotionPlanRequest& planning_query, const std::vector<moveit_msgs::RobotTrajectory>& results,
+    const std::string& scene_name)
+{
+  // matching the query against the stored requests serializes and compares every stored request,
+  // so do it once for the whole batch
+  std::string id = getMotionPlanRequestName(planning_query, scene_name);
+  if (id.empty())
+    id = addNewPlanningRequest(planning_query, scene_name, "");
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    Metadata::Ptr metadata = robot_trajectory_collection_->createMetadata();
+    metadata->append(PLANNING_SCENE_ID_NAME, scene_name);
+    metadata->append(MOTION_PLAN_REQUEST_ID_NAME, id);
+    robot_trajectory_collection_->insert(results[i], metadata);
+  }
+  ROS_DEBUG("Added %u planning results for query '%s' in scene '%s'", (unsigned int)results.size(), id.c_str(),
+            scene_name.c_str());
+}
+
+void moveit_warehouse::PlanningSceneStorage::addPlanningResultsBlob(
+    const moveit_msgs::MotionPlanRequest& planning_query, const std::vector<moveit_msgs::RobotTrajectory>& results,
+    const std::string& scene_name)
+{
+  std::string id = getMotionPlanRequestName(planning_query, scene_name);
+  if (id.empty())
+    id = addNewPlanningRequest(planning_query, scene_name, "");
+  MessageBlob blob;
+  for (std::size_t i = 0; i < results.size(); ++i)
+    appendMessageToBlob(results[i], blob);
+  std_msgs::UInt8MultiArray payload;
+  compressBlob(blob, payload.data);
+  Metadata::Ptr metadata = robot_trajectory_blob_collection_->createMetadata();
+  metadata->append(PLANNING_SCENE_ID_NAME, scene_name);
+  metadata->append(MOTION_PLAN_REQUEST_ID_NAME, id);
+  metadata->append(TRAJECTORY_COUNT_NAME, (int)results.size());
+  robot_trajectory_blob_collection_->insert(payload, metadata);
+  ROS_DEBUG("Added blob of %u planning results for query '%s' in scene '%s' (%u bytes, %u uncompressed)",
+            (unsigned int)results.size(), id.c_str(), scene_name.c_str(), (unsigned int)payload.data.size(),
+            (unsigned int)blob.size());
+}
+
 void moveit_warehouse::PlanningSceneStorage::getPlanningSceneNames(std::vector<std::string>& names) const
 {
   names.clear();
@@ -328,6 +396,48 @@ void moveit_warehouse::PlanningSceneStorage::getPlanningResults(
   planning_results = robot_trajectory_collection_->queryList(q, false);
 }
 
+namespace
+{
+void collectTrajectory(std::vector<moveit_msgs::RobotTrajectory>* results,
+                       const moveit_msgs::RobotTrajectory& trajectory)
+{
+  results->push_back(trajectory);
+}
+}
+
+bool moveit_warehouse::PlanningSceneStorage::getPlanningResultsBlob(
+    std::vector<moveit_msgs::RobotTrajectory>& planning_results, const std::string& scene_name,
+    const std::string& query_name) const
+{
+  planning_results.clear();
+  return streamPlanningResultsBlob(boost::bind(&collectTrajectory, &planning_results, _1), scene_name, query_name);
+}
+
+bool moveit_warehouse::PlanningSceneStorage::streamPlanningResultsBlob(
+    const boost::function<void(const moveit_msgs::RobotTrajectory&)>& callback, const std::string& scene_name,
+    const std::string& query_name) const
+{
+  Query::Ptr q = robot_trajectory_blob_collection_->createQuery();
+  q->append(PLANNING_SCENE_ID_NAME, scene_name);
+  q->append(MOTION_PLAN_REQUEST_ID_NAME, query_name);
+  std::vector<TrajectoryBlobWithMetadata> blobs = robot_trajectory_blob_collection_->queryList(q, false);
+  for (std::size_t i = 0; i < blobs.size(); ++i)
+  {
+    MessageBlob blob;
+    if (!decompressBlob(static_cast<const std_msgs::UInt8MultiArray&>(*blobs[i]).data, blob))
+    {
+      ROS_ERROR("Unable to decode trajectory blob for scene '%s', query '%s'", scene_name.c_str(),
+                query_name.c_str());
+      return false;
+    }
+    std::size_t offset = 0;
+    moveit_msgs::RobotTrajectory trajectory;
+    while (readMessageFromBlob(blob, offset, trajectory))
+      callback(trajectory);
+  }
+  return true;
+}
+
 bool moveit_warehouse::PlanningSceneStorage::hasPlanningQuery(const std::string& scene_name,
                                                               const std::string& query_name) const
 {
@@ -399,6 +509,10 @@ void moveit_warehouse::PlanningSceneStorage::removePlanningResults(const std::st
   q->append(PLANNING_SCENE_ID_NAME, scene_name);
   unsigned int rem = robot_trajectory_collection_->removeMessages(q);
   ROS_DEBUG("Removed %u RobotTrajectory messages for scene '%s'", rem, scene_name.c_str());
+  Query::Ptr qb = robot_trajectory_blob_collection_->createQuery();
+  qb->append(PLANNING_SCENE_ID_NAME, scene_name);
+  rem = robot_trajectory_blob_collection_->removeMessages(qb);
+  ROS_DEBUG("Removed %u trajectory blobs for scene '%s'", rem, scene_name.c_str());
 }
 
 void moveit_warehouse::PlanningSceneStorage::removePlanningResults(const std::string& scene_name,
@@ -410,4 +524,9 @@ void moveit_warehouse::PlanningSceneStorage::removePlanningResults(const std::st
   unsigned int rem = robot_trajectory_collection_->removeMessages(q);
   ROS_DEBUG("Removed %u RobotTrajectory messages for scene '%s', query '%s'", rem, scene_name.c_str(),
             query_name.c_str());
+  Query::Ptr qb = robot_trajectory_blob_collection_->createQuery();
+  qb->append(PLANNING_SCENE_ID_NAME, scene_name);
+  qb->append(MOTION_PLAN_REQUEST_ID_NAME, query_name);
+  rem = robot_trajectory_blob_collection_->removeMessages(qb);
+  ROS_DEBUG("Removed %u trajectory blobs for scene '%s', query '%s'", rem, scene_name.c_str(), query_name.c_str());
 }
@@ -0,0 +1,209 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <moveit/warehouse/robot_trajectory_storage.h>
+#include <cmath>
+#include <cstdio>
+
+const std::string moveit_warehouse::RobotTrajectoryStorage::DATABASE_NAME = "moveit_robot_trajectories";
+
+const std::string moveit_warehouse::RobotTrajectoryStorage::TRAJECTORY_ID_NAME = "trajectory_id";
+const std::string moveit_warehouse::RobotTrajectoryStorage::TRAJECTORY_GROUP_NAME = "group_id";
+const std::string moveit_warehouse::RobotTrajectoryStorage::ROBOT_NAME = "robot_id";
+const std::string moveit_warehouse::RobotTrajectoryStorage::START_STATE_KEY_NAME = "start_state_key";
+const std::string moveit_warehouse::RobotTrajectoryStorage::GOAL_STATE_KEY_NAME = "goal_state_key";
+
+const double moveit_warehouse::RobotTrajectoryStorage::DEFAULT_KEY_RESOLUTION = 0.1;
+
+using warehouse_ros::Metadata;
+using warehouse_ros::Query;
+
+moveit_warehouse::RobotTrajectoryStorage::RobotTrajectoryStorage(warehouse_ros::DatabaseConnection::Ptr conn)
+  : MoveItMessageStorage(conn)
+{
+  createCollections();
+}
+
+void moveit_warehouse::RobotTrajectoryStorage::createCollections()
+{
+  trajectory_collection_ = conn_->openCollectionPtr<moveit_msgs::RobotTrajectory>(DATABASE_NAME, "robot_trajectories");
+}
+
+void moveit_warehouse::RobotTrajectoryStorage::reset()
+{
+  trajectory_collection_.reset();
+  conn_->dropDatabase(DATABASE_NAME);
+  createCollections();
+}
+
+std::string moveit_warehouse::RobotTrajectoryStorage::computeStateKey(const std::vector<double>& joint_values,
+                                                                      double resolution)
+{
+  std::string key;
+  char buffer[32];
+  for (std::size_t i = 0; i < joint_values.size(); ++i)
+  {
+    long cell = resolution > 0.0 ? lround(joint_values[i] / resolution) : 0;
+    snprintf(buffer, sizeof(buffer), i == 0 ? "%ld" : "_%ld", cell);
+    key += buffer;
+  }
+  return key;
+}
+
+void moveit_warehouse::RobotTrajectoryStorage::addTrajectory(const moveit_msgs::RobotTrajectory& msg,
+                                                             const std::string& name, const std::string& robot,
+                                                             const std::string& group,
+                                                             const std::string& start_state_key,
+                                                             const std::string& goal_state_key)
+{
+  bool replace = false;
+  if (hasTrajectory(name, robot, group))
+  {
+    removeTrajectory(name, robot, group);
+    replace = true;
+  }
+  Metadata::Ptr metadata = trajectory_collection_->createMetadata();
+  metadata->append(TRAJECTORY_ID_NAME, name);
+  metadata->append(ROBOT_NAME, robot);
+  metadata->append(TRAJECTORY_GROUP_NAME, group);
+  metadata->append(START_STATE_KEY_NAME, start_state_key);
+  metadata->append(GOAL_STATE_KEY_NAME, goal_state_key);
+  trajectory_collection_->insert(msg, metadata);
+  ROS_DEBUG("%s robot trajectory '%s'", replace ? "Replaced" : "Added", name.c_str());
+}
+
+bool moveit_warehouse::RobotTrajectoryStorage::hasTrajectory(const std::string& name, const std::string& robot,
+                                                             const std::string& group) const
+{
+  Query::Ptr q = trajectory_collection_->createQuery();
+  q->append(TRAJECTORY_ID_NAME, name);
+  if (!robot.empty())
+    q->append(ROBOT_NAME, robot);
+  if (!group.empty())
+    q->append(TRAJECTORY_GROUP_NAME, group);
+  std::vector<RobotTrajectoryWithMetadata> traj = trajectory_collection_->queryList(q, true);
+  return !traj.empty();
+}
+
+void moveit_warehouse::RobotTrajectoryStorage::getKnownTrajectories(const std::string& regex,
+                                                                    std::vector<std::string>& names,
+                                                                    const std::string& robot,
+                                                                    const std::string& group) const
+{
+  getKnownTrajectories(names, robot, group);
+  filterNames(regex, names);
+}
+
+void moveit_warehouse::RobotTrajectoryStorage::getKnownTrajectories(std::vector<std::string>& names,
+                                                                    const std::string& robot,
+                                                                    const std::string& group) const
+{
+  names.clear();
+  Query::Ptr q = trajectory_collection_->createQuery();
+  if (!robot.empty())
+    q->append(ROBOT_NAME, robot);
+  if (!group.empty())
+    q->append(TRAJECTORY_GROUP_NAME, group);
+  std::vector<RobotTrajectoryWithMetadata> traj = trajectory_collection_->queryList(q, true, TRAJECTORY_ID_NAME, true);
+  for (std::size_t i = 0; i < traj.size(); ++i)
+    if (traj[i]->lookupField(TRAJECTORY_ID_NAME))
+      names.push_back(traj[i]->lookupString(TRAJECTORY_ID_NAME));
+}
+
+bool moveit_warehouse::RobotTrajectoryStorage::getTrajectory(RobotTrajectoryWithMetadata& msg_m,
+                                                             const std::string& name, const std::string& robot,
+                                                             const std::string& group) const
+{
+  Query::Ptr q = trajectory_collection_->createQuery();
+  q->append(TRAJECTORY_ID_NAME, name);
+  if (!robot.empty())
+    q->append(ROBOT_NAME, robot);
+  if (!group.empty())
+    q->append(TRAJECTORY_GROUP_NAME, group);
+  std::vector<RobotTrajectoryWithMetadata> traj = trajectory_collection_->queryList(q, false);
+  if (traj.empty())
+    return false;
+  msg_m = traj.back();
+  return true;
+}
+
+void moveit_warehouse::RobotTrajectoryStorage::getMatchingTrajectories(std::vector<RobotTrajectoryWithMetadata>& msgs,
+                                                                       const std::string& group,
+                                                                       const std::string& start_state_key,
+                                                                       const std::string& goal_state_key, std::size_t k,
+                                                                       const std::string& robot) const
+{
+  msgs.clear();
+  Query::Ptr q = trajectory_collection_->createQuery();
+  if (!robot.empty())
+    q->append(ROBOT_NAME, robot);
+  if (!group.empty())
+    q->append(TRAJECTORY_GROUP_NAME, group);
+  if (!start_state_key.empty())
+    q->append(START_STATE_KEY_NAME, start_state_key);
+  if (!goal_state_key.empty())
+    q->append(GOAL_STATE_KEY_NAME, goal_state_key);
+  msgs = trajectory_collection_->queryList(q, false);
+  if (msgs.size() > k)
+    msgs.resize(k);
+}
+
+void moveit_warehouse::RobotTrajectoryStorage::renameTrajectory(const std::string& old_name,
+                                                                const std::string& new_name, const std::string& robot,
+                                                                const std::string& group)
+{
+  Query::Ptr q = trajectory_collection_->createQuery();
+  q->append(TRAJECTORY_ID_NAME, old_name);
+  if (!robot.empty())
+    q->append(ROBOT_NAME, robot);
+  if (!group.empty())
+    q->append(TRAJECTORY_GROUP_NAME, group);
+  Metadata::Ptr m = trajectory_collection_->createMetadata();
+  m->append(TRAJECTORY_ID_NAME, new_name);
+  trajectory_collection_->modifyMetadata(q, m);
+  ROS_DEBUG("Renamed robot trajectory from '%s' to '%s'", old_name.c_str(), new_name.c_str());
+}
+
+void moveit_warehouse::RobotTrajectoryStorage::removeTrajectory(const std::string& name, const std::string& robot,
+                                                                const std::string& group)
+{
+  Query::Ptr q = trajectory_collection_->createQuery();
+  q->append(TRAJECTORY_ID_NAME, name);
+  if (!robot.empty())
+    q->append(ROBOT_NAME, robot);
+  if (!group.empty())
+    q->append(TRAJECTORY_GROUP_NAME, group);
+  unsigned int rem = trajectory_collection_->removeMessages(q);
+  ROS_DEBUG("Removed %u RobotTrajectory messages (named '%s')", rem, name.c_str());
+}
@@ -38,6 +38,7 @@
 #define MOVEIT_MOVEIT_SETUP_ASSISTANT_TOOLS_COMPUTE_DEFAULT_COLLISIONS_
 
 #include <map>
+#include <string>
 #include <moveit/macros/class_forward.h>
 namespace planning_scene
 {
@@ -83,11 +84,15 @@ typedef std::map<std::pair<std::string, std::string>, LinkPairData> LinkPairMap;
  * \param trials Set the number random collision checks that are made. Increase the probability of correctness
  * \param min_collision_fraction If collisions are found between a pair of links >= this fraction, the are assumed
  * "always" in collision
+ * \param checkpoint_file Optional path for resumable sampling. If the file exists, the link pairs seen colliding
+ * and the number of trials performed by previous runs are loaded and counted towards \e trials; the merged
+ * evidence is written back after sampling. Pass an empty string to disable checkpointing.
  * \return Adj List of unique set of pairs of links in string-based form
  */
 LinkPairMap computeDefaultCollisions(const planning_scene::PlanningSceneConstPtr& parent_scene, unsigned int* progress,
                                      const bool include_never_colliding, const unsigned int trials,
-                                     const double min_collision_faction, const bool verbose);
+                                     const double min_collision_faction, const bool verbose,
+                                     const std::string& checkpoint_file = "");
 
 /**
  * \brief Generate a list of unique link pairs for all links with geometry. Order pairs alphabetically. n choose 2 pairs
@@ -43,6 +43,7 @@
 #include <yaml-cpp/yaml.h>                                            // outputing yaml config files
 #include <urdf/model.h>                                               // to share throughout app
 #include <srdfdom/srdf_writer.h>                                      // for writing srdf data
+#include <boost/thread.hpp>                                           // for the background model build
 
 namespace moveit_setup_assistant
 {
@@ -288,6 +289,15 @@ public:
   /// Update the Kinematic Model with latest SRDF modifications
   void updateRobotModel();
 
+  /// Start building the kinematic model and planning scene on a background thread, so the GUI stays
+  /// responsive while a large model compiles. getRobotModel() / getPlanningScene() wait for the
+  /// build to finish instead of re-building; calling this is optional.
+  void prefetchRobotModel();
+
+  /// Check whether the shared kinematic model is built, without blocking. Widgets can poll this to
+  /// enable themselves as soon as the (possibly background) build completes.
+  bool isRobotModelReady();
+
   /// Provide a shared planning scene
   planning_scene::PlanningScenePtr getPlanningScene();
 
@@ -514,6 +524,18 @@ private:
 
   /// Shared planning scene
   planning_scene::PlanningScenePtr planning_scene_;
+
+  /// Entry point of the background model build started by prefetchRobotModel()
+  void backgroundModelBuild();
+
+  /// Block until no background model build is in flight. Must be called with model_build_lock_ held.
+  void waitForModelBuild(boost::mutex::scoped_lock& slock);
+
+  /// Guards robot_model_ / planning_scene_ against the background build thread
+  boost::mutex model_build_lock_;
+  boost::condition_variable model_build_cond_;
+  bool model_build_in_progress_;
+  boost::thread model_build_thread_;
 };
 
 }  // namespace
@@ -104,12 +104,14 @@ bool setup(moveit_setup_assistant::MoveItConfigData& config_data, bool keep_old,
 }
 
 moveit_setup_assistant::LinkPairMap compute(moveit_setup_assistant::MoveItConfigData& config_data, uint32_t trials,
-                                            double min_collision_fraction, bool verbose)
+                                            double min_collision_fraction, bool verbose,
+                                            const std::string& checkpoint_file)
 {
   // TODO: spin thread and print progess if verbose
   unsigned int collision_progress;
   return moveit_setup_assistant::computeDefaultCollisions(config_data.getPlanningScene(), &collision_progress,
-                                                          trials > 0, trials, min_collision_fraction, verbose);
+                                                          trials > 0, trials, min_collision_fraction, verbose,
+                                                          checkpoint_file);
 }
 
 int main(int argc, char* argv[])
@@ -119,6 +121,7 @@ int main(int argc, char* argv[])
   std::string srdf_path;
 
   std::string output_path;
+  std::string checkpoint_path;
 
   bool include_default = false, include_always = false, keep_old = false, verbose = false;
 
@@ -142,7 +145,9 @@ int main(int argc, char* argv[])
 
                   ("trials", po::value(&never_trials), "number of trials for searching never colliding pairs")(
                       "min-collision-fraction", po::value(&min_collision_fraction),
-                      "fraction of small sample size to determine links that are alwas colliding");
+                      "fraction of small sample size to determine links that are alwas colliding")(
+                      "checkpoint", po::value(&checkpoint_path),
+                      "path to a checkpoint file for resuming the never-colliding sampling across runs");
 
   po::positional_options_description pos_desc;
   pos_desc.add("xacro-args", -1);
@@ -194,7 +199,8 @@ int main(int argc, char* argv[])
     return 1;
   }
 
-  moveit_setup_assistant::LinkPairMap link_pairs = compute(config_data, never_trials, min_collision_fraction, verbose);
+  moveit_setup_assistant::LinkPairMap link_pairs =
+      compute(config_data, never_trials, min_collision_fraction, verbose, checkpoint_path);
 
   size_t skip_mask = 0;
   if (!include_default)
@@ -41,6 +41,9 @@
 #include <boost/unordered_map.hpp>
 #include <boost/assign.hpp>
 #include <ros/console.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
 
 namespace moveit_setup_assistant
 {
@@ -62,8 +65,10 @@ typedef std::set<std::pair<std::string, std::string> > StringPairSet;
 struct ThreadComputation
 {
   ThreadComputation(planning_scene::PlanningScene& scene, const collision_detection::CollisionRequest& req,
-                    int thread_id, int num_trials, StringPairSet* links_seen_colliding, boost::mutex* lock,
-                    unsigned int* progress)
+                    int thread_id, unsigned int num_trials, StringPairSet* links_seen_colliding, boost::mutex* lock,
+                    unsigned int* progress, std::atomic<unsigned int>* next_trial,
+                    std::atomic<unsigned int>* trials_completed, std::atomic<unsigned int>* last_discovery_trial,
+                    unsigned int min_trials, unsigned int no_discovery_window)
     : scene_(scene)
     , req_(req)
     , thread_id_(thread_id)
@@ -71,15 +76,25 @@ struct ThreadComputation
     , links_seen_colliding_(links_seen_colliding)
     , lock_(lock)
     , progress_(progress)
+    , next_trial_(next_trial)
+    , trials_completed_(trials_completed)
+    , last_discovery_trial_(last_discovery_trial)
+    , min_trials_(min_trials)
+    , no_discovery_window_(no_discovery_window)
   {
   }
   planning_scene::PlanningScene& scene_;
   const collision_detection::CollisionRequest& req_;
   int thread_id_;
-  unsigned int num_trials_;
+  unsigned int num_trials_;  // total trial budget, including trials reloaded from a checkpoint
   StringPairSet* links_seen_colliding_;
   boost::mutex* lock_;
   unsigned int* progress_;  // only to be updated by thread 0
+  std::atomic<unsigned int>* next_trial_;            // shared counter the threads pull trial indices from
+  std::atomic<unsigned int>* trials_completed_;      // number of trials actually checked, for checkpointing
+  std::atomic<unsigned int>* last_discovery_trial_;  // trial index at which a new colliding pair was last seen
+  unsigned int min_trials_;                          // do not stop adaptively before this many trials
+  unsigned int no_discovery_window_;                 // stop once this many trials pass without a new pair
 };
 
 // LinkGraph defines a Link's model and a set of unique links it connects
@@ -154,11 +169,14 @@ static unsigned int disableAlwaysInCollision(planning_scene::PlanningScene& scen
  * \param link_pairs List of all unique link pairs and each pair's properties
  * \param req A reference to a collision request that is already initialized
  * \param links_seen_colliding Set of links that have at some point been seen in collision
+ * \param prior_trials Number of trials already performed by previous (checkpointed) runs; counted towards num_trials
+ * \param trials_performed Filled with the number of trials checked by this run, for checkpointing
  * \return number of never in collision links found and disabled
  */
 static unsigned int disableNeverInCollision(const unsigned int num_trials, planning_scene::PlanningScene& scene,
                                             LinkPairMap& link_pairs, const collision_detection::CollisionRequest& req,
-                                            StringPairSet& links_seen_colliding, unsigned int* progress);
+                                            StringPairSet& links_seen_colliding, unsigned int* progress,
+                                            unsigned int prior_trials, unsigned int* trials_performed);
 
 /**
  * \brief Thread for getting the pairs of links that are never in collision
@@ -166,12 +184,26 @@ static unsigned int disableNeverInCollision(const unsigned int num_trials, plann
  */
 static void disableNeverInCollisionThread(ThreadComputation tc);
 
+/**
+ * \brief Load the sampling evidence (trials performed, link pairs seen colliding) saved by a previous run
+ * \return true if the checkpoint file existed and was parsed
+ */
+static bool loadCollisionCheckpoint(const std::string& checkpoint_file, unsigned int& prior_trials,
+                                    StringPairSet& links_seen_colliding);
+
+/**
+ * \brief Save the accumulated sampling evidence so a future run can resume from it
+ */
+static void saveCollisionCheckpoint(const std::string& checkpoint_file, unsigned int trials,
+                                    const StringPairSet& links_seen_colliding);
+
 // ******************************************************************************************
 // Generates an adjacency list of links that are always and never in collision, to speed up collision detection
 // ******************************************************************************************
 LinkPairMap computeDefaultCollisions(const planning_scene::PlanningSceneConstPtr& parent_scene, unsigned int* progress,
                                      const bool include_never_colliding, const unsigned int num_trials,
-                                     const double min_collision_fraction, const bool verbose)
+                                     const double min_collision_fraction, const bool verbose,
+                                     const std::string& checkpoint_file)
 {
   // Create new instance of planning scene using pointer
   planning_scene::PlanningScenePtr scene = parent_scene->diff();
@@ -236,7 +268,26 @@ LinkPairMap computeDefaultCollisions(const planning_scene::PlanningSceneConstPtr
   unsigned int num_never = 0;
   if (include_never_colliding)  // option of function
   {
-    num_never = disableNeverInCollision(num_trials, *scene, link_pairs, req, links_seen_colliding, progress);
+    // Resume from evidence accumulated by previous runs, if a checkpoint is available. Pairs that
+    // no longer exist after a URDF edit simply never match and are ignored.
+    unsigned int prior_trials = 0;
+    if (!checkpoint_file.empty() && loadCollisionCheckpoint(checkpoint_file, prior_trials, links_seen_colliding))
+    {
+      ROS_INFO("Resuming collision sampling from '%s': %u prior trials, %d pairs seen colliding",
+               checkpoint_file.c_str(), prior_trials, int(links_seen_colliding.size()));
+      // skip re-checking the pairs we already have evidence for
+      for (StringPairSet::const_iterator pair_it = links_seen_colliding.begin(); pair_it != links_seen_colliding.end();
+           ++pair_it)
+        scene->getAllowedCollisionMatrixNonConst().setEntry(pair_it->first, pair_it->second, true);
+    }
+
+    unsigned int trials_performed = 0;
+    num_never =
+        disableNeverInCollision(num_trials, *scene, link_pairs, req, links_seen_colliding, progress, prior_trials,
+                                &trials_performed);
+
+    if (!checkpoint_file.empty())
+      saveCollisionCheckpoint(checkpoint_file, prior_trials + trials_performed, links_seen_colliding);
   }
 
   // ROS_INFO("Link pairs seen colliding ever: %d", int(links_seen_colliding.size()));
@@ -550,33 +601,56 @@ unsigned int disableAlwaysInCollision(planning_scene::PlanningScene& scene, Link
 // ******************************************************************************************
 unsigned int disableNeverInCollision(const unsigned int num_trials, planning_scene::PlanningScene& scene,
                                      LinkPairMap& link_pairs, const collision_detection::CollisionRequest& req,
-                                     StringPairSet& links_seen_colliding, unsigned int* progress)
+                                     StringPairSet& links_seen_colliding, unsigned int* progress,
+                                     unsigned int prior_trials, unsigned int* trials_performed)
 {
   unsigned int num_disabled = 0;
+  *trials_performed = 0;
 
-  boost::thread_group bgroup;  // create a group of threads
-  boost::mutex lock;           // used for sharing the same data structures
-
-  int num_threads = boost::thread::hardware_concurrency();  // how many cores does this computer have?
-  // ROS_INFO_STREAM("Performing " << num_trials << " trials for 'always in collision' checking on " <<
-  //   num_threads << " threads...");
-
-  for (int i = 0; i < num_threads; ++i)
+  if (prior_trials < num_trials)  // a checkpoint may already cover the whole trial budget
   {
-    ThreadComputation tc(scene, req, i, num_trials / num_threads, &links_seen_colliding, &lock, progress);
-    bgroup.create_thread(boost::bind(&disableNeverInCollisionThread, tc));
-  }
+    boost::thread_group bgroup;  // create a group of threads
+    boost::mutex lock;           // used for sharing the same data structures
+
+    int num_threads = boost::thread::hardware_concurrency();  // how many cores does this computer have?
+    // ROS_INFO_STREAM("Performing " << num_trials << " trials for 'always in collision' checking on " <<
+    //   num_threads << " threads...");
+
+    // Threads pull trial indices from a shared counter instead of working on a fixed share, so a thread
+    // that draws expensive states does not become the straggler. Sampling stops early once a minimum
+    // number of trials is done and no new colliding pair has been discovered for a whole window of
+    // trials: by the rule of three, W discovery-free trials bound the remaining discovery rate to
+    // roughly 3/W with 95% confidence.
+    std::atomic<unsigned int> next_trial(prior_trials);
+    std::atomic<unsigned int> trials_completed(0);
+    std::atomic<unsigned int> last_discovery_trial(prior_trials);
+    const unsigned int min_trials = std::max(1000u, num_trials / 10);
+    const unsigned int no_discovery_window = std::max(1000u, num_trials / 5);
+
+    for (int i = 0; i < num_threads; ++i)
+    {
+      ThreadComputation tc(scene, req, i, num_trials, &links_seen_colliding, &lock, progress, &next_trial,
+                           &trials_completed, &last_discovery_trial, min_trials, no_discovery_window);
+      bgroup.create_thread(boost::bind(&disableNeverInCollisionThread, tc));
+    }
 
-  try
-  {
-    bgroup.join_all();  // wait for all threads to finish
-  }
-  catch (boost::thread_interrupted)
-  {
-    ROS_WARN("disableNeverInCollision interrupted");
-    bgroup.interrupt_all();
-    bgroup.join_all();  // wait for all threads to interrupt
-    throw;
+    try
+    {
+      bgroup.join_all();  // wait for all threads to finish
+    }
+    catch (boost::thread_interrupted)
+    {
+      ROS_WARN("disableNeverInCollision interrupted");
+      bgroup.interrupt_all();
+      bgroup.join_all();  // wait for all threads to interrupt
+      throw;
+    }
+
+    *trials_performed = trials_completed;
+    if (prior_trials + *trials_performed < num_trials)
+      ROS_INFO("Collision sampling stopped adaptively after %u of %u trials: no new colliding pair "
+               "discovered in the last %u trials",
+               prior_trials + *trials_performed, num_trials, no_discovery_window);
   }
 
   // Loop through every possible link pair and check if it has ever been seen in collision
@@ -607,23 +681,26 @@ unsigned int disableNeverInCollision(const unsigned int num_trials, planning_sce
 // ******************************************************************************************
 void disableNeverInCollisionThread(ThreadComputation tc)
 {
-  // ROS_INFO_STREAM("Thread " << tc.thread_id_ << " running " << tc.num_trials_ << " trials");
-
-  // User feedback vars
-  const unsigned int progress_interval = tc.num_trials_ / 20;  // show progress update every 5%
-
   // Create a new kinematic state for this thread to work on
   robot_state::RobotState robot_state(tc.scene_.getRobotModel());
 
-  // Do a large number of tests
-  for (unsigned int i = 0; i < tc.num_trials_; ++i)
+  // Pull trial indices from the shared counter until the budget is exhausted or sampling converged
+  while (true)
   {
     boost::this_thread::interruption_point();
 
-    // Status update at intervals and only for 0 thread
-    if (i % progress_interval == 0 && tc.thread_id_ == 0)
+    const unsigned int trial = tc.next_trial_->fetch_add(1);
+    if (trial >= tc.num_trials_)
+      break;
+
+    // Adaptive stop: enough evidence collected and the discovery-free window has passed
+    if (trial >= tc.min_trials_ && trial - tc.last_discovery_trial_->load() >= tc.no_discovery_window_)
+      break;
+
+    // Status update and only for 0 thread
+    if (tc.thread_id_ == 0)
     {
-      (*tc.progress_) = i * 92 / tc.num_trials_ + 8;  // 8 is the amount of progress already completed in prev steps
+      (*tc.progress_) = trial * 92 / tc.num_trials_ + 8;  // 8 is the amount of progress already completed in prev steps
     }
 
     collision_detection::CollisionResult res;
@@ -644,11 +721,75 @@ void disableNeverInCollisionThread(ThreadComputation tc)
 
         tc.scene_.getAllowedCollisionMatrixNonConst().setEntry(it->first.first, it->first.second,
                                                                true);  // disable link checking in the collision matrix
+
+        // a new pair resets the discovery-free window
+        unsigned int last = tc.last_discovery_trial_->load();
+        while (last < trial && !tc.last_discovery_trial_->compare_exchange_weak(last, trial))
+          ;
       }
     }
+
+    tc.trials_completed_->fetch_add(1);
   }
 }
 
+// ******************************************************************************************
+// Load the sampling evidence (trials performed, link pairs seen colliding) saved by a previous run
+// ******************************************************************************************
+bool loadCollisionCheckpoint(const std::string& checkpoint_file, unsigned int& prior_trials,
+                             StringPairSet& links_seen_colliding)
+{
+  std::ifstream in(checkpoint_file.c_str());
+  if (!in.good())
+    return false;
+
+  prior_trials = 0;
+  std::string keyword;
+  while (in >> keyword)
+  {
+    if (keyword == "trials")
+    {
+      if (!(in >> prior_trials))
+      {
+        ROS_WARN("Malformed collision checkpoint '%s'; ignoring it", checkpoint_file.c_str());
+        prior_trials = 0;
+        return false;
+      }
+    }
+    else  // a link pair: the first link name was already consumed as the keyword
+    {
+      std::string linkB;
+      if (!(in >> linkB))
+      {
+        ROS_WARN("Malformed collision checkpoint '%s'; ignoring it", checkpoint_file.c_str());
+        prior_trials = 0;
+        return false;
+      }
+      links_seen_colliding.insert(std::make_pair(keyword, linkB));
+    }
+  }
+  return true;
+}
+
+// ******************************************************************************************
+// Save the accumulated sampling evidence so a future run can resume from it
+// ******************************************************************************************
+void saveCollisionCheckpoint(const std::string& checkpoint_file, unsigned int trials,
+                             const StringPairSet& links_seen_colliding)
+{
+  std::ofstream out(checkpoint_file.c_str());
+  if (!out.good())
+  {
+    ROS_ERROR("Unable to write collision checkpoint to '%s'", checkpoint_file.c_str());
+    return;
+  }
+
+  out << "trials " << trials << "\n";
+  for (StringPairSet::const_iterator pair_it = links_seen_colliding.begin(); pair_it != links_seen_colliding.end();
+       ++pair_it)
+    out << pair_it->first << " " << pair_it->second << "\n";
+}
+
 // ******************************************************************************************
 // Converts a reason for disabling a link pair into a string
 // ******************************************************************************************
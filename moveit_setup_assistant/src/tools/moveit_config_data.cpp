@@ -54,7 +54,7 @@ namespace fs = boost::filesystem;
 // ******************************************************************************************
 // Constructor
 // ******************************************************************************************
-MoveItConfigData::MoveItConfigData() : config_pkg_generated_timestamp_(0)
+MoveItConfigData::MoveItConfigData() : config_pkg_generated_timestamp_(0), model_build_in_progress_(false)
 {
   // Create an instance of SRDF writer and URDF model for all widgets to share
   srdf_.reset(new srdf::SRDFWriter());
@@ -76,6 +76,9 @@ MoveItConfigData::MoveItConfigData() : config_pkg_generated_timestamp_(0)
 // ******************************************************************************************
 MoveItConfigData::~MoveItConfigData()
 {
+  // let an in-flight background build finish before its target members are destroyed
+  if (model_build_thread_.joinable())
+    model_build_thread_.join();
 }
 
 // ******************************************************************************************
@@ -83,6 +86,8 @@ MoveItConfigData::~MoveItConfigData()
 // ******************************************************************************************
 void MoveItConfigData::setRobotModel(robot_model::RobotModelPtr robot_model)
 {
+  boost::mutex::scoped_lock slock(model_build_lock_);
+  waitForModelBuild(slock);
   robot_model_ = robot_model;
 }
 
@@ -91,6 +96,9 @@ void MoveItConfigData::setRobotModel(robot_model::RobotModelPtr robot_model)
 // ******************************************************************************************
 robot_model::RobotModelConstPtr MoveItConfigData::getRobotModel()
 {
+  boost::mutex::scoped_lock slock(model_build_lock_);
+  waitForModelBuild(slock);
+
   if (!robot_model_)
   {
     // Initialize with a URDF Model Interface and a SRDF Model
@@ -100,6 +108,55 @@ robot_model::RobotModelConstPtr MoveItConfigData::getRobotModel()
   return robot_model_;
 }
 
+// ******************************************************************************************
+// Start building the kinematic model on a background thread
+// ******************************************************************************************
+void MoveItConfigData::prefetchRobotModel()
+{
+  boost::mutex::scoped_lock slock(model_build_lock_);
+  if (robot_model_ || model_build_in_progress_)  // already built or building
+    return;
+
+  model_build_in_progress_ = true;
+  if (model_build_thread_.joinable())
+    model_build_thread_.join();  // reclaim a previously finished thread
+  model_build_thread_ = boost::thread(&MoveItConfigData::backgroundModelBuild, this);
+}
+
+// ******************************************************************************************
+// Check whether the shared kinematic model is built, without blocking
+// ******************************************************************************************
+bool MoveItConfigData::isRobotModelReady()
+{
+  boost::mutex::scoped_lock slock(model_build_lock_);
+  return robot_model_ != nullptr;
+}
+
+// ******************************************************************************************
+// Entry point of the background model build
+// ******************************************************************************************
+void MoveItConfigData::backgroundModelBuild()
+{
+  // build outside the lock; the URDF/SRDF models are not modified while a build is in flight
+  robot_model::RobotModelPtr robot_model(new robot_model::RobotModel(urdf_model_, srdf_->srdf_model_));
+  planning_scene::PlanningScenePtr planning_scene(new planning_scene::PlanningScene(robot_model));
+
+  boost::mutex::scoped_lock slock(model_build_lock_);
+  robot_model_ = robot_model;
+  planning_scene_ = planning_scene;
+  model_build_in_progress_ = false;
+  model_build_cond_.notify_all();
+}
+
+// ******************************************************************************************
+// Block until no background model build is in flight
+// ******************************************************************************************
+void MoveItConfigData::waitForModelBuild(boost::mutex::scoped_lock& slock)
+{
+  while (model_build_in_progress_)
+    model_build_cond_.wait(slock);
+}
+
 // ******************************************************************************************
 // Update the Kinematic Model with latest SRDF modifications
 // ******************************************************************************************
@@ -107,6 +164,9 @@ void MoveItConfigData::updateRobotModel()
 {
   ROS_INFO("Updating kinematic model");
 
+  boost::mutex::scoped_lock slock(model_build_lock_);
+  waitForModelBuild(slock);  // results of an in-flight build would be stale
+
   // Tell SRDF Writer to create new SRDF Model, use original URDF model
   srdf_->updateSRDFModel(*urdf_model_);
 
@@ -122,10 +182,14 @@ void MoveItConfigData::updateRobotModel()
 // ******************************************************************************************
 planning_scene::PlanningScenePtr MoveItConfigData::getPlanningScene()
 {
+  boost::mutex::scoped_lock slock(model_build_lock_);
+  waitForModelBuild(slock);
+
   if (!planning_scene_)
   {
     // make sure kinematic model exists
-    getRobotModel();
+    if (!robot_model_)
+      robot_model_.reset(new robot_model::RobotModel(urdf_model_, srdf_->srdf_model_));
 
     // Allocate an empty planning scene
     planning_scene_.reset(new planning_scene::PlanningScene(robot_model_));
@@ -393,6 +393,10 @@ bool StartScreenWidget::loadExistingFiles()
   progress_bar_->setValue(60);
   QApplication::processEvents();
 
+  // Start compiling the kinematic model in the background; the remaining config files parse and the
+  // GUI becomes responsive while large models build
+  config_data_->prefetchRobotModel();
+
   // Load the allowed collision matrix
   config_data_->loadAllowedCollisionMatrix();
 
@@ -503,6 +507,9 @@ bool StartScreenWidget::loadNewFiles()
   progress_bar_->setValue(60);
   QApplication::processEvents();
 
+  // Start compiling the kinematic model in the background while RViz loads
+  config_data_->prefetchRobotModel();
+
   // DONE LOADING --------------------------------------------------------------------------
 
   // Call a function that enables navigation